@@ -23,6 +23,7 @@
 #include "AstVisitor.h"
 #include "build.h"
 #include "codegen.h"
+#include "driver.h"
 #include "ForLoop.h"
 
 #include <algorithm>
@@ -81,6 +82,8 @@ CForLoop* CForLoop::buildWithBodyFrom(ForLoop* forLoop)
   retval->mBreakLabel    = forLoop->breakLabelGet();
   retval->mContinueLabel = forLoop->continueLabelGet();
 
+  retval->mOrderIndependent = forLoop->isOrderIndependent();
+
   for_alist(expr, forLoop->body)
     retval->insertAtTail(expr->copy(&map, true));
 
@@ -138,6 +141,8 @@ CForLoop* CForLoop::copy(SymbolMap* mapRef, bool internal)
   retval->mBreakLabel    = mBreakLabel;
   retval->mContinueLabel = mContinueLabel;
 
+  retval->mOrderIndependent = mOrderIndependent;
+
   if (initBlockGet() != 0 && testBlockGet() != 0 && incrBlockGet() != 0)
     retval->loopHeaderSet(initBlockGet()->copy(map, true),
                           testBlockGet()->copy(map, true),
@@ -277,6 +282,11 @@ GenRet CForLoop::codegen()
     std::string incr      = codegenCForLoopHeader(incrBlock->copy());
     std::string hdr       = "for (" + init + "; " + test + "; " + incr + ") ";
 
+    // The iterations of an order-independent loop do not depend on each
+    // other, so the back-end compiler may vectorize it without proving so.
+    if (fVectorize == true && isOrderIndependent() == true)
+      info->cStatements.push_back("CHPL_PRAGMA_IVDEP\n");
+
     info->cStatements.push_back(hdr);
 
     if (this != getFunction()->body)
@@ -127,6 +127,8 @@ ForLoop* ForLoop::copy(SymbolMap* mapRef, bool internal)
   retval->mBreakLabel    = mBreakLabel;
   retval->mContinueLabel = mContinueLabel;
 
+  retval->mOrderIndependent = mOrderIndependent;
+
   retval->mIndex         = mIndex->copy(map, true),
   retval->mIterator      = mIterator->copy(map, true);
 
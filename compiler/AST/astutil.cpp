@@ -535,13 +535,17 @@ void insert_help(BaseAST* ast,
 
 void remove_help(BaseAST* ast, int trace_flag) {
   trace_remove(ast, trace_flag);
+  note_removed(ast);
   AST_CHILDREN_CALL(ast, remove_help, trace_flag);
   if (Expr* expr = toExpr(ast)) {
     expr->parentSymbol = NULL;
     expr->parentExpr = NULL;
   } else if (LabelSymbol* labsym = toLabelSymbol(ast)) {
-    if (labsym->iterResumeGoto)
+    if (labsym->iterResumeGoto) {
+      lockCompilerThreads();
       removedIterResumeLabels.add(labsym);
+      unlockCompilerThreads();
+    }
   }
 }
 
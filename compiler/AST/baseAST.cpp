@@ -21,6 +21,7 @@
 
 #include "astutil.h"
 #include "CForLoop.h"
+#include "compilerThreads.h"
 #include "expr.h"
 #include "ForLoop.h"
 #include "log.h"
@@ -34,7 +35,11 @@
 #include "WhileStmt.h"
 #include "yy.h"
 
+#include <algorithm>
+#include <vector>
+
 static void cleanModuleList();
+static void clearDeadTypeBackPointers();
 
 //
 // declare global vectors gSymExprs, gCallExprs, gFnSymbols, ...
@@ -146,17 +151,129 @@ void trace_remove(BaseAST* ast, char flag) {
     INT_FATAL(ast, "Unexpected attempt to eviscerate a global type symbol.");
 }
 
-#define clean_gvec(type)                        \
-  int i##type = 0;                              \
-  forv_Vec(type, ast, g##type##s) {             \
-    if (isAlive(ast) || isRootModuleWithType(ast, type)) { \
-      g##type##s.v[i##type++] = ast;            \
-    } else {                                    \
-      trace_remove(ast, 'x');                   \
-      delete ast; ast = 0;                      \
-    }                                           \
-  }                                             \
-  g##type##s.n = i##type
+//
+// Nodes can only die by being created and never inserted into the tree,
+// or by being taken out of it with remove_help.  cleanAst therefore
+// examines the nodes created since it last ran, which are at the end of
+// each global vector because the vectors are ordered by id, and the
+// nodes that note_removed has recorded.
+//
+static const int numAstTags = E_AggregateType + 1;
+
+static int              firstUncleanedId = 1;
+static std::vector<int> removedIds[numAstTags];
+static std::vector<int> deadIndices[numAstTags];
+
+void note_removed(BaseAST* ast) {
+  if (ast->id < firstUncleanedId) {
+    lockCompilerThreads();
+    removedIds[ast->astTag].push_back(ast->id);
+    unlockCompilerThreads();
+  }
+}
+
+// return the index of the first node in gvec at or after index start
+// whose id is at least id, searching outward from start
+template <class T>
+static int lowerBoundId(Vec<T*>& gvec, int start, int id) {
+  int lo = start, hi = start + 1;
+  while (hi < gvec.n && gvec.v[hi]->id < id) {
+    lo = hi;
+    hi = start + 2 * (hi - start);
+  }
+  if (hi > gvec.n)
+    hi = gvec.n;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (gvec.v[mid]->id < id)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+template <class T>
+static bool isDead(T* ast) {
+  return !isAlive(ast) && (BaseAST*)ast != (BaseAST*)rootModule;
+}
+
+// sort ids and drop duplicates, using a bitmap indexed by id
+static void sortRemovedIds(std::vector<int>& ids) {
+  static std::vector<unsigned long long> bits;
+
+  if (ids.size() < 2)
+    return;
+
+  int maxId = 0;
+  for (size_t i = 0; i < ids.size(); i++)
+    maxId = std::max(maxId, ids[i]);
+
+  bits.resize(maxId / 64 + 1, 0);
+
+  for (size_t i = 0; i < ids.size(); i++)
+    bits[ids[i] / 64] |= 1ULL << (ids[i] % 64);
+
+  ids.clear();
+
+  for (size_t word = 0; word < bits.size(); word++) {
+    for (unsigned long long w = bits[word]; w != 0; w &= w - 1)
+      ids.push_back(word * 64 + __builtin_ctzll(w));
+    bits[word] = 0;
+  }
+}
+
+template <class T>
+static void findDeadAsts(Vec<T*>& gvec,
+                         std::vector<int>& removed,
+                         std::vector<int>& dead) {
+  int firstNew = lowerBoundId(gvec, 0, firstUncleanedId);
+  int index    = 0;
+
+  sortRemovedIds(removed);
+
+  for (size_t i = 0; i < removed.size() && index < firstNew; i++) {
+    index = lowerBoundId(gvec, index, removed[i]);
+    if (index < firstNew && gvec.v[index]->id == removed[i] &&
+        isDead(gvec.v[index]))
+      dead.push_back(index);
+  }
+
+  for (index = firstNew; index < gvec.n; index++) {
+    if (isDead(gvec.v[index]))
+      dead.push_back(index);
+  }
+
+  removed.clear();
+}
+
+template <class T>
+static void deleteDeadAsts(Vec<T*>& gvec, std::vector<int>& dead) {
+  if (dead.size() == 0)
+    return;
+
+  size_t next = 0;
+  int    keep = dead[0];
+
+  for (int index = dead[0]; index < gvec.n; index++) {
+    if (next < dead.size() && dead[next] == index) {
+      trace_remove(gvec.v[index], 'x');
+      delete gvec.v[index];
+      next++;
+    } else {
+      gvec.v[keep++] = gvec.v[index];
+    }
+  }
+
+  gvec.n = keep;
+  dead.clear();
+}
+
+#define find_dead_gvec(type)                                    \
+  findDeadAsts(g##type##s, removedIds[E_##type], deadIndices[E_##type])
+
+#define clean_gvec(type)                                        \
+  deleteDeadAsts(g##type##s, deadIndices[E_##type])
 
 
 static void clean_modvec(Vec<ModuleSymbol*>& modvec) {
@@ -171,9 +288,94 @@ static void clean_modvec(Vec<ModuleSymbol*>& modvec) {
 
 void cleanAst() {
   cleanModuleList();
+
+  foreach_ast(find_dead_gvec);
+  firstUncleanedId = uid;
+
   //
   // clear back pointers to dead ast instances
   //
+  if (deadIndices[E_FnSymbol].size()      > 0 ||
+      deadIndices[E_PrimitiveType].size() > 0 ||
+      deadIndices[E_EnumType].size()      > 0 ||
+      deadIndices[E_AggregateType].size() > 0) {
+    clearDeadTypeBackPointers();
+  }
+
+  // check iterator-resume-label/goto data before nodes are free'd
+  verifyNcleanRemovedIterResumeGotos();
+  verifyNcleanCopiedIterResumeGotos();
+
+  // clean the other module vectors, without deleting the ast instances (they
+  // will be deleted with the clean_gvec call for ModuleSymbols.) 
+  clean_modvec(allModules);
+  clean_modvec(userModules);
+  clean_modvec(mainModules);
+ 
+  //
+  // clean global vectors and delete dead ast instances
+  //
+  foreach_ast(clean_gvec);
+}
+
+
+//
+// Nodes created on several compiler threads are numbered, and added to
+// the global vectors, in whatever order the threads create them.  Each
+// task keeps a list of the nodes it created.  When the tasks are done,
+// the nodes are renumbered task by task, giving them the ids a serial
+// run would have, and the global vectors are put back in id order,
+// which cleanAst and verify rely on.
+//
+static int                                          firstThreadedId = 1;
+static std::vector<std::vector<BaseAST*> >          threadedAsts;
+static COMPILER_THREAD_LOCAL std::vector<BaseAST*>* taskAsts        = NULL;
+
+void startAstThreads(int numTasks) {
+  firstThreadedId = uid;
+  threadedAsts.resize(numTasks);
+}
+
+void startAstTask(int task) {
+  taskAsts = (task >= 0) ? &threadedAsts[task] : NULL;
+}
+
+static void renumberThreadedAsts() {
+  int id = firstThreadedId;
+
+  for (size_t i = 0; i < threadedAsts.size(); i++) {
+    for (size_t j = 0; j < threadedAsts[i].size(); j++) {
+      threadedAsts[i][j]->id = id++;
+    }
+  }
+
+  INT_ASSERT(id == uid);
+
+  threadedAsts.clear();
+}
+
+template <class T>
+static bool lessId(T* a, T* b) {
+  return a->id < b->id;
+}
+
+template <class T>
+static void sortThreadedAsts(Vec<T*>& gvec) {
+  int first = lowerBoundId(gvec, 0, firstThreadedId);
+
+  std::sort(gvec.v + first, gvec.v + gvec.n, lessId<T>);
+}
+
+#define sort_threaded_gvec(type) sortThreadedAsts(g##type##s)
+
+void finishAstThreads() {
+  renumberThreadedAsts();
+
+  foreach_ast(sort_threaded_gvec);
+}
+
+
+static void clearDeadTypeBackPointers() {
   forv_Vec(TypeSymbol, ts, gTypeSymbols) {
     for(int i = 0; i < ts->type->methods.n; i++) {
       FnSymbol* method = ts->type->methods.v[i];
@@ -192,21 +394,6 @@ void cleanAst() {
         ts->type->dispatchChildren.v[i] = NULL;
     }
   }
-
-  // check iterator-resume-label/goto data before nodes are free'd
-  verifyNcleanRemovedIterResumeGotos();
-  verifyNcleanCopiedIterResumeGotos();
-
-  // clean the other module vectors, without deleting the ast instances (they
-  // will be deleted with the clean_gvec call for ModuleSymbols.) 
-  clean_modvec(allModules);
-  clean_modvec(userModules);
-  clean_modvec(mainModules);
- 
-  //
-  // clean global vectors and delete dead ast instances
-  //
-  foreach_ast(clean_gvec);
 }
 
 
@@ -236,9 +423,14 @@ void destroyAst() {
 
 void
 verify() {
-  #define verify_gvec(type)                       \
-    forv_Vec(type, ast, g##type##s) {             \
-      ast->verify();                              \
+  #define verify_gvec(type)                                         \
+    for (int i = 0; i < g##type##s.n; i++) {                        \
+      type* ast = g##type##s.v[i];                                  \
+      if (i > 0 && g##type##s.v[i-1]->id >= ast->id)                \
+        INT_FATAL(ast, "g%ss is not ordered by id", #type);         \
+      if (isDead(ast))                                              \
+        INT_FATAL(ast, "dead node was not removed from g%ss", #type); \
+      ast->verify();                                                \
     }
   foreach_ast(verify_gvec);
 }
@@ -261,12 +453,94 @@ static void checkid(int id) {
 }
 
 
+//
+// AST nodes are carved out of large chunks, with a free list for each
+// size (in units of astPoolGrain bytes) so that deleted nodes are reused
+// by nodes of the same size.  Chunks are never returned to the system.
+//
+static const size_t astPoolGrain     = 16;
+static const size_t astPoolMaxSize   = 1024;
+static const size_t astPoolChunkSize = 256 * 1024;
+
+struct AstPoolFree {
+  AstPoolFree* next;
+};
+
+static AstPoolFree* astPoolFreeLists[astPoolMaxSize / astPoolGrain + 1];
+static char*        astPoolChunk     = NULL;
+static size_t       astPoolChunkLeft = 0;
+
+void* BaseAST::operator new(size_t size) {
+  if (size > astPoolMaxSize)
+    return ::operator new(size);
+
+  size_t bin = (size + astPoolGrain - 1) / astPoolGrain;
+  void*  mem = NULL;
+
+  lockCompilerThreads();
+
+  if (AstPoolFree* node = astPoolFreeLists[bin]) {
+    astPoolFreeLists[bin] = node->next;
+    mem = node;
+
+  } else {
+    size_t rounded = bin * astPoolGrain;
+
+    if (astPoolChunkLeft < rounded) {
+      astPoolChunk     = (char*)::operator new(astPoolChunkSize);
+      astPoolChunkLeft = astPoolChunkSize;
+    }
+
+    mem = astPoolChunk;
+
+    astPoolChunk     += rounded;
+    astPoolChunkLeft -= rounded;
+  }
+
+  unlockCompilerThreads();
+
+  return mem;
+}
+
+void BaseAST::operator delete(void* ptr, size_t size) {
+  if (!ptr)
+    return;
+
+  if (size > astPoolMaxSize) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  size_t       bin  = (size + astPoolGrain - 1) / astPoolGrain;
+  AstPoolFree* node = (AstPoolFree*)ptr;
+
+  lockCompilerThreads();
+
+  node->next            = astPoolFreeLists[bin];
+  astPoolFreeLists[bin] = node;
+
+  unlockCompilerThreads();
+}
+
+
+// Only pay for an atomic increment while several threads are
+// creating nodes.
+static inline int nextId() {
+#ifdef HAVE_COMPILER_THREADS
+  if (onCompilerThreads())
+    return __sync_fetch_and_add(&uid, 1);
+#endif
+  return uid++;
+}
+
 BaseAST::BaseAST(AstTag type) :
   astTag(type),
-  id(uid++),
-  astloc(yystartlineno, yyfilename)
+  id(nextId()),
+  astloc(makeAstloc(yystartlineno, yyfilename))
 {
   checkid(id);
+  if (taskAsts)
+    taskAsts->push_back(this);
   if (astloc.filename) {
     // OK, set from yyfilename
   } else {
@@ -453,7 +727,8 @@ const char* BaseAST::astTagAsString() const {
 }
 
 
-astlocT currentAstLoc(0,NULL);
+// Each compiler thread has its own current location (see compilerThreads.h).
+COMPILER_THREAD_LOCAL astlocT currentAstLoc = { NULL, 0 };
 
 Vec<ModuleSymbol*> mainModules; // Contains main modules
 Vec<ModuleSymbol*> userModules; // Contains user + main modules
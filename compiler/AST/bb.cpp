@@ -29,25 +29,29 @@
 #include "view.h"
 #include "WhileDoStmt.h"
 
-int                                          BasicBlock::nextID     = 0;
-BasicBlock*                                  BasicBlock::basicBlock = NULL;
-Map<LabelSymbol*, std::vector<BasicBlock*>*> BasicBlock::gotoMaps;
-Map<LabelSymbol*, BasicBlock*>               BasicBlock::labelMaps;
+struct BasicBlock::Builder {
+  int                                          nextID;
+  BasicBlock*                                  basicBlock;
+  Map<LabelSymbol*, std::vector<BasicBlock*>*> gotoMaps;
+  Map<LabelSymbol*, BasicBlock*>               labelMaps;
+};
+
+COMPILER_THREAD_LOCAL BasicBlock::Builder* BasicBlock::builder = NULL;
 
 BasicBlock::BasicBlock() {
-  id = nextID++;
+  id = builder->nextID++;
 }
 
-// Reset the shared statics.
+// Reset the builder state.
 void BasicBlock::reset(FnSymbol* fn) {
   clear(fn);
 
-  gotoMaps.clear();
-  labelMaps.clear();
+  builder->gotoMaps.clear();
+  builder->labelMaps.clear();
 
   fn->basicBlocks = new std::vector<BasicBlock*>();
 
-  nextID = 0;
+  builder->nextID = 0;
 }
 
 void BasicBlock::clear(FnSymbol* fn) {
@@ -63,21 +67,27 @@ void BasicBlock::clear(FnSymbol* fn) {
 
 // This is the top-level (public) builder function.
 void BasicBlock::buildBasicBlocks(FnSymbol* fn) {
+  Builder state;
+
+  builder = &state;
+
   reset(fn);
 
-  basicBlock = new BasicBlock();
+  builder->basicBlock = new BasicBlock();
 
   buildBasicBlocks(fn, fn->body, false);
 
   fn->basicBlocks->push_back(BasicBlock::steal());
 
+  builder = NULL;
+
   INT_ASSERT(verifyBasicBlocks(fn));
 }
 
 BasicBlock* BasicBlock::steal() {
-  BasicBlock* temp = basicBlock;
+  BasicBlock* temp = builder->basicBlock;
 
-  basicBlock = 0;
+  builder->basicBlock = 0;
 
   return temp;
 }
@@ -96,7 +106,7 @@ void BasicBlock::buildBasicBlocks(FnSymbol* fn, Expr* stmt, bool mark) {
       }
 
       // mark the top of the loop
-      BasicBlock* top = basicBlock;
+      BasicBlock* top = builder->basicBlock;
 
       restart(fn);
 
@@ -128,7 +138,7 @@ void BasicBlock::buildBasicBlocks(FnSymbol* fn, Expr* stmt, bool mark) {
         append(info, true);
       }
 
-      BasicBlock* loopTop = basicBlock;
+      BasicBlock* loopTop = builder->basicBlock;
 
       for_alist(bodyStmt, s->body) {
         buildBasicBlocks(fn, bodyStmt, mark);
@@ -148,11 +158,11 @@ void BasicBlock::buildBasicBlocks(FnSymbol* fn, Expr* stmt, bool mark) {
         append(condExpr, true);
       }
 
-      BasicBlock* loopBottom = basicBlock;
+      BasicBlock* loopBottom = builder->basicBlock;
 
       restart(fn);
 
-      BasicBlock* bottom = basicBlock;
+      BasicBlock* bottom = builder->basicBlock;
 
       // thread the basic blocks of the pre-loop, loop, and post-loop together
       thread(top,        loopTop);
@@ -171,48 +181,48 @@ void BasicBlock::buildBasicBlocks(FnSymbol* fn, Expr* stmt, bool mark) {
     // Mark the conditional expression
     append(s->condExpr, true);
 
-    BasicBlock* top = basicBlock;
+    BasicBlock* top = builder->basicBlock;
 
     restart(fn);
-    thread(top, basicBlock);
+    thread(top, builder->basicBlock);
     buildBasicBlocks(fn, s->thenStmt, mark);
 
-    BasicBlock* thenBottom = basicBlock;
+    BasicBlock* thenBottom = builder->basicBlock;
 
     restart(fn);
 
     if (s->elseStmt) {
-      thread(top, basicBlock);
+      thread(top, builder->basicBlock);
 
       buildBasicBlocks(fn, s->elseStmt, mark);
 
-      BasicBlock* elseBottom = basicBlock;
+      BasicBlock* elseBottom = builder->basicBlock;
 
       restart(fn);
 
-      thread(elseBottom, basicBlock);
+      thread(elseBottom, builder->basicBlock);
 
     } else {
-      thread(top, basicBlock);
+      thread(top, builder->basicBlock);
     }
 
-    thread(thenBottom, basicBlock);
+    thread(thenBottom, builder->basicBlock);
 
   } else if (GotoStmt* s = toGotoStmt(stmt)) {
     LabelSymbol* label = toLabelSymbol(toSymExpr(s->label)->var);
 
-    if (BasicBlock* bb = labelMaps.get(label)) {
-      thread(basicBlock, bb);
+    if (BasicBlock* bb = builder->labelMaps.get(label)) {
+      thread(builder->basicBlock, bb);
 
     } else {
-      std::vector<BasicBlock*>* vbb = gotoMaps.get(label);
+      std::vector<BasicBlock*>* vbb = builder->gotoMaps.get(label);
 
       if (!vbb)
         vbb = new std::vector<BasicBlock*>();
 
-      vbb->push_back(basicBlock);
+      vbb->push_back(builder->basicBlock);
 
-      gotoMaps.put(label, vbb);
+      builder->gotoMaps.put(label, vbb);
     }
 
     append(s, mark); // Put the goto at the end of its block.
@@ -247,11 +257,11 @@ void BasicBlock::buildBasicBlocks(FnSymbol* fn, Expr* stmt, bool mark) {
     if (def && toLabelSymbol(def->sym)) {
       // If a label appears in the middle of a block,
       // we start a new block.
-      if (basicBlock->exprs.size() > 0) {
-        BasicBlock* top = basicBlock;
+      if (builder->basicBlock->exprs.size() > 0) {
+        BasicBlock* top = builder->basicBlock;
 
         restart(fn);
-        thread(top, basicBlock);
+        thread(top, builder->basicBlock);
       }
 
       append(def, mark); // Put the label def at the start of its block.
@@ -261,13 +271,13 @@ void BasicBlock::buildBasicBlocks(FnSymbol* fn, Expr* stmt, bool mark) {
 
       // See if we have any unresolved references to this label,
       // and resolve them.
-      if (std::vector<BasicBlock*>* vbb = gotoMaps.get(label)) {
+      if (std::vector<BasicBlock*>* vbb = builder->gotoMaps.get(label)) {
         for_vector(BasicBlock, bb, *vbb) {
-          thread(bb, basicBlock);
+          thread(bb, builder->basicBlock);
         }
       }
 
-      labelMaps.put(label, basicBlock);
+      builder->labelMaps.put(label, builder->basicBlock);
     } else {
       append(stmt, mark);
     }
@@ -276,14 +286,14 @@ void BasicBlock::buildBasicBlocks(FnSymbol* fn, Expr* stmt, bool mark) {
 
 void BasicBlock::restart(FnSymbol* fn) {
   fn->basicBlocks->push_back(steal());
-  basicBlock = new BasicBlock();
+  builder->basicBlock = new BasicBlock();
 }
 
 void BasicBlock::append(Expr* expr, bool mark) {
   INT_ASSERT(expr);
 
-  basicBlock->exprs.push_back(expr);
-  basicBlock->marks.push_back(mark);
+  builder->basicBlock->exprs.push_back(expr);
+  builder->basicBlock->marks.push_back(mark);
 }
 
 void BasicBlock::thread(BasicBlock* src, BasicBlock* dst) {
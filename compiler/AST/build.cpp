@@ -31,6 +31,15 @@
 #include "symbol.h"
 #include "type.h"
 
+int genFnCounters[NUM_GEN_FN_COUNTERS] = {
+  1, // GEN_FN_IF
+  1, // GEN_FN_LET
+  1, // GEN_FN_LOOPEXPR
+  1, // GEN_FN_REDUCE
+  1, // GEN_FN_SCAN
+  0  // GEN_FN_LAMBDA
+};
+
 static void
 checkControlFlow(Expr* expr, const char* context) {
   Vec<const char*> labelSet; // all labels in expr argument
@@ -485,12 +494,10 @@ CallExpr* buildPrimitiveExpr(CallExpr* exprs) {
 
 
 FnSymbol* buildIfExpr(Expr* e, Expr* e1, Expr* e2) {
-  static int uid = 1;
-
   if (!e2)
     USR_FATAL("if-then expressions currently require an else-clause");
 
-  FnSymbol* ifFn = new FnSymbol(astr("_if_fn", istr(uid++)));
+  FnSymbol* ifFn = new FnSymbol(astr("_if_fn", istr(genFnCounters[GEN_FN_IF]++)));
   ifFn->addFlag(FLAG_COMPILER_NESTED_FUNCTION);
   ifFn->addFlag(FLAG_INLINE);
   VarSymbol* tmp1 = newTemp();
@@ -521,8 +528,7 @@ FnSymbol* buildIfExpr(Expr* e, Expr* e1, Expr* e2) {
 
 
 CallExpr* buildLetExpr(BlockStmt* decls, Expr* expr) {
-  static int uid = 1;
-  FnSymbol* fn = new FnSymbol(astr("_let_fn", istr(uid++)));
+  FnSymbol* fn = new FnSymbol(astr("_let_fn", istr(genFnCounters[GEN_FN_LET]++)));
   fn->addFlag(FLAG_COMPILER_NESTED_FUNCTION);
   fn->addFlag(FLAG_INLINE);
   fn->insertAtTail(decls);
@@ -684,12 +690,10 @@ handleArrayTypeCase(FnSymbol* fn, Expr* indices, Expr* iteratorExpr, Expr* expr)
 }
 
 
-static int loopexpr_uid = 1;
-
 // builds body of for expression iterator
 CallExpr*
 buildForLoopExpr(Expr* indices, Expr* iteratorExpr, Expr* expr, Expr* cond, bool maybeArrayType, bool zippered) {
-  FnSymbol* fn = new FnSymbol(astr("_seqloopexpr", istr(loopexpr_uid++)));
+  FnSymbol* fn = new FnSymbol(astr("_seqloopexpr", istr(genFnCounters[GEN_FN_LOOPEXPR]++)));
   fn->addFlag(FLAG_COMPILER_NESTED_FUNCTION);
   BlockStmt* block = fn->body;
 
@@ -702,7 +706,7 @@ buildForLoopExpr(Expr* indices, Expr* iteratorExpr, Expr* expr, Expr* cond, bool
   iterator->addFlag(FLAG_EXPR_TEMP);
   block->insertAtTail(new DefExpr(iterator));
   block->insertAtTail(new CallExpr(PRIM_MOVE, iterator, new CallExpr("_checkIterator", iteratorExpr)));
-  const char* iteratorName = astr("_iterator_for_loopexpr", istr(loopexpr_uid-1));
+  const char* iteratorName = astr("_iterator_for_loopexpr", istr(genFnCounters[GEN_FN_LOOPEXPR]-1));
   block->insertAtTail(new CallExpr(PRIM_RETURN, new CallExpr(iteratorName, iterator)));
 
   //
@@ -810,7 +814,7 @@ static FnSymbol* buildFollowerIteratorFn(FnSymbol* fn, const char* iteratorName,
 
 CallExpr*
 buildForallLoopExpr(Expr* indices, Expr* iteratorExpr, Expr* expr, Expr* cond, bool maybeArrayType, bool zippered) {
-  FnSymbol* fn = new FnSymbol(astr("_parloopexpr", istr(loopexpr_uid++)));
+  FnSymbol* fn = new FnSymbol(astr("_parloopexpr", istr(genFnCounters[GEN_FN_LOOPEXPR]++)));
   fn->addFlag(FLAG_COMPILER_NESTED_FUNCTION);
   BlockStmt* block = fn->body;
 
@@ -823,7 +827,7 @@ buildForallLoopExpr(Expr* indices, Expr* iteratorExpr, Expr* expr, Expr* cond, b
   iterator->addFlag(FLAG_EXPR_TEMP);
   block->insertAtTail(new DefExpr(iterator));
   block->insertAtTail(new CallExpr(PRIM_MOVE, iterator, new CallExpr("_checkIterator", iteratorExpr)));
-  const char* iteratorName = astr("_iterator_for_loopexpr", istr(loopexpr_uid-1));
+  const char* iteratorName = astr("_iterator_for_loopexpr", istr(genFnCounters[GEN_FN_LOOPEXPR]-1));
   block->insertAtTail(new CallExpr(PRIM_RETURN, new CallExpr(iteratorName, iterator)));
 
   Expr* stmt; // Initialized by buildSerialIteratorFn.
@@ -892,6 +896,9 @@ buildFollowLoop(VarSymbol* iter,
   BlockStmt* followBlock = new BlockStmt();
   ForLoop*   followBody  = new ForLoop(followIdx, followIter, loopBody);
 
+  // The iterations of a forall may be run in any order
+  followBody->orderIndependentSet(true);
+
   destructureIndices(followBody, indices, new SymExpr(followIdx), false);
 
   followBlock->insertAtTail(new DefExpr(followIter));
@@ -949,6 +956,9 @@ buildStandaloneForallLoopStmt(Expr* indices,
   SABlock->insertAtTail("{TYPE 'move'(%S, iteratorIndex(%S)) }", idx, iter);
 
   ForLoop* SABody = new ForLoop(idx, iter, NULL);
+
+  SABody->orderIndependentSet(true);
+
   SABody->insertAtTail(new DefExpr(idxCopy));
   SABody->insertAtTail("'move'(%S, %S)", idxCopy, idx);
   if (UnresolvedSymExpr* sym = toUnresolvedSymExpr(indices)) {
@@ -1159,6 +1169,23 @@ addByrefVars(BlockStmt* target, CallExpr* byrefVarsSource) {
   // will be automatically resolved in resolve().
 }
 
+//
+// Is onBlock, with the evaluation of its locale that buildOnStmt puts in
+// front of it, all that block does?
+//
+static bool isOnlyOnStmt(BlockStmt* block, BlockStmt* onBlock) {
+  if (block->body.head == onBlock)
+    return true;
+
+  SymExpr*  target = toSymExpr(onBlock->blockInfoGet()->get(1));
+  DefExpr*  def    = toDefExpr(block->body.head);
+  CallExpr* move   = def ? toCallExpr(def->next) : NULL;
+
+  return target && def && def->sym == target->var &&
+         move && move->isPrimitive(PRIM_MOVE) && move->next == onBlock;
+}
+
+
 BlockStmt* buildCoforallLoopStmt(Expr* indices,
                                  Expr* iterator,
                                  CallExpr* byref_vars,
@@ -1179,11 +1206,13 @@ BlockStmt* buildCoforallLoopStmt(Expr* indices,
   // detect on-statement directly inside coforall-loop
   //
   BlockStmt* onBlock = NULL;
+  bool       onBlockAlone = false; // the on-statement is the whole body
   BlockStmt* tmp = body;
   while (tmp) {
     if (BlockStmt* b = toBlockStmt(tmp->body.tail)) {
       if (b->blockInfoGet() && b->blockInfoGet()->isPrimitive(PRIM_BLOCK_ON)) {
         onBlock = b;
+        onBlockAlone = isOnlyOnStmt(tmp, onBlock);
         break;
       }
     }
@@ -1205,11 +1234,20 @@ BlockStmt* buildCoforallLoopStmt(Expr* indices,
     //   wasting threads that would do nothing other than wait on the
     //   on-statement.
     //
+    //   If the on-statement is all the loop body does, the remote
+    //   tasks are also batched, so that the comm layer can start them
+    //   with a few messages sent down a tree of locales instead of
+    //   one message per task from this locale.
+    //
     VarSymbol* coforallCount = newTemp("_coforallCount");
     BlockStmt* block = ForLoop::buildForLoop(indices, iterator, body, true, zippered);
+    if (onBlockAlone)
+      block->insertAtHead(new CallExpr("_startForkBatch"));
     block->insertAtHead(new CallExpr(PRIM_MOVE, coforallCount, new CallExpr("_endCountAlloc")));
     block->insertAtHead(new DefExpr(coforallCount));
     body->insertAtHead(new CallExpr("_upEndCount", coforallCount));
+    if (onBlockAlone)
+      block->insertAtTail(new CallExpr("_finishForkBatch"));
     block->insertAtTail(new CallExpr("_waitEndCount", coforallCount));
     block->insertAtTail(new CallExpr("_endCountFree", coforallCount));
     onBlock->blockInfoGet()->primitive = primitives[PRIM_BLOCK_COFORALL_ON];
@@ -1415,9 +1453,7 @@ buildReduceScanPreface(FnSymbol* fn, Symbol* data, Symbol* eltType, Symbol* glob
 
 
 CallExpr* buildReduceExpr(Expr* opExpr, Expr* dataExpr, bool zippered) {
-  static int uid = 1;
-
-  FnSymbol* fn = new FnSymbol(astr("chpl__reduce", istr(uid++)));
+  FnSymbol* fn = new FnSymbol(astr("chpl__reduce", istr(genFnCounters[GEN_FN_REDUCE]++)));
   fn->addFlag(FLAG_COMPILER_NESTED_FUNCTION);
   fn->addFlag(FLAG_DONT_DISABLE_REMOTE_VALUE_FORWARDING);
   fn->addFlag(FLAG_INLINE);
@@ -1503,9 +1539,7 @@ CallExpr* buildReduceExpr(Expr* opExpr, Expr* dataExpr, bool zippered) {
 
 
 CallExpr* buildScanExpr(Expr* opExpr, Expr* dataExpr, bool zippered) {
-  static int uid = 1;
-
-  FnSymbol* fn = new FnSymbol(astr("chpl__scan", istr(uid++)));
+  FnSymbol* fn = new FnSymbol(astr("chpl__scan", istr(genFnCounters[GEN_FN_SCAN]++)));
   fn->addFlag(FLAG_COMPILER_NESTED_FUNCTION);
 
   VarSymbol* data = newTemp();
@@ -1714,7 +1748,6 @@ destructureTupleGroupedArgs(FnSymbol* fn, BlockStmt* tuple, Expr* base) {
 }
 
 FnSymbol* buildLambda(FnSymbol *fn) {
-  static unsigned int nextId = 0;
   char buffer[100];
 
   /*
@@ -1724,7 +1757,7 @@ FnSymbol* buildLambda(FnSymbol *fn) {
    * is better to guard against this behavior then leaving someone wondering
    * why we didn't.
    */ 
-  if (snprintf(buffer, 100, "_chpl_lambda_%i", nextId++) >= 100) {
+  if (snprintf(buffer, 100, "_chpl_lambda_%i", genFnCounters[GEN_FN_LAMBDA]++) >= 100) {
     INT_FATAL("Too many lambdas.");
   }
   
@@ -384,7 +384,7 @@ SymExpr::SymExpr(Symbol* init_var) :
 {
   if (!init_var)
     INT_FATAL(this, "Bad call to SymExpr");
-  gSymExprs.add(this);
+  registerAst(gSymExprs, this);
 }
 
 bool SymExpr::isNoInitExpr() const {
@@ -485,7 +485,7 @@ UnresolvedSymExpr::UnresolvedSymExpr(const char* i_unresolved) :
 {
   if (!i_unresolved)
     INT_FATAL(this, "bad call to UnresolvedSymExpr");
-  gUnresolvedSymExprs.add(this);
+  registerAst(gUnresolvedSymExprs, this);
 }
 
 void
@@ -573,7 +573,7 @@ DefExpr::DefExpr(Symbol* initSym, BaseAST* initInit, BaseAST* initExprType) :
   if (isArgSymbol(sym) && (exprType || init))
     INT_FATAL(this, "DefExpr of ArgSymbol cannot have either exprType or init");
 
-  gDefExprs.add(this);
+  registerAst(gDefExprs, this);
 }
 
 Expr* DefExpr::getFirstExpr() {
@@ -3408,7 +3408,7 @@ CallExpr::CallExpr(BaseAST* base, BaseAST* arg1, BaseAST* arg2,
   callExprHelper(this, arg3);
   callExprHelper(this, arg4);
   argList.parent = this;
-  gCallExprs.add(this);
+  registerAst(gCallExprs, this);
 }
 
 
@@ -3427,7 +3427,7 @@ CallExpr::CallExpr(PrimitiveOp *prim, BaseAST* arg1, BaseAST* arg2,
   callExprHelper(this, arg3);
   callExprHelper(this, arg4);
   argList.parent = this;
-  gCallExprs.add(this);
+  registerAst(gCallExprs, this);
 }
 
 CallExpr::CallExpr(PrimitiveTag prim, BaseAST* arg1, BaseAST* arg2,
@@ -3445,7 +3445,7 @@ CallExpr::CallExpr(PrimitiveTag prim, BaseAST* arg1, BaseAST* arg2,
   callExprHelper(this, arg3);
   callExprHelper(this, arg4);
   argList.parent = this;
-  gCallExprs.add(this);
+  registerAst(gCallExprs, this);
 }
 
 
@@ -3464,7 +3464,7 @@ CallExpr::CallExpr(const char* name, BaseAST* arg1, BaseAST* arg2,
   callExprHelper(this, arg3);
   callExprHelper(this, arg4);
   argList.parent = this;
-  gCallExprs.add(this);
+  registerAst(gCallExprs, this);
 }
 
 
@@ -5675,7 +5675,7 @@ NamedExpr::NamedExpr(const char* init_name, Expr* init_actual) :
   name(init_name),
   actual(init_actual)
 {
-  gNamedExprs.add(this);
+  registerAst(gNamedExprs, this);
 }
 
 
@@ -214,7 +214,7 @@ VarSymbol::VarSymbol(const char *init_name,
   immediate(NULL),
   doc(NULL)
 {
-  gVarSymbols.add(this);
+  registerAst(gVarSymbols, this);
 }
 
 
@@ -641,7 +641,7 @@ GenRet VarSymbol::codegen() {
 }
 
 
-void VarSymbol::codegenDefC(bool global) {
+void VarSymbol::codegenDefC(bool global, bool isHeader) {
   GenInfo* info = gGenInfo;
   if (this->hasFlag(FLAG_EXTERN))
     return;
@@ -656,11 +656,16 @@ void VarSymbol::codegenDefC(bool global) {
 
   //
   // a variable can be codegen'd as static if it is global and neither
-  // exported nor external.
+  // exported nor external.  When the generated code is split into
+  // several translation units, globals are shared between them: the
+  // header gets an extern declaration and _main.c the definition.
   //
-  bool isStatic =  global && !hasFlag(FLAG_EXPORT) && !hasFlag(FLAG_EXTERN);
+  bool isStatic =  global && !hasFlag(FLAG_EXPORT) && !hasFlag(FLAG_EXTERN) &&
+                   !codegenSeparateUnits();
+  bool isExtern =  global && isHeader;
 
-  std::string str = (isStatic ? "static " : "") + typestr + " " + cname;
+  std::string str = (isStatic ? "static " : isExtern ? "extern " : "") +
+                    typestr + " " + cname;
   if (ct) {
     if (ct->isClass()) {
       if (isFnSymbol(defPoint->parentSymbol)) {
@@ -685,7 +690,7 @@ void VarSymbol::codegenDefC(bool global) {
   info->cLocalDecls.push_back(str);
 }
 
-void VarSymbol::codegenGlobalDef() {
+void VarSymbol::codegenGlobalDef(bool isHeader) {
   GenInfo* info = gGenInfo;
 
   if( breakOnCodegenCname[0] &&
@@ -694,7 +699,7 @@ void VarSymbol::codegenGlobalDef() {
   }
 
   if( info->cfile ) {
-    codegenDefC(/*global=*/true);
+    codegenDefC(/*global=*/true, isHeader);
   } else {
 #ifdef HAVE_LLVM
     if(type == dtVoid) {
@@ -859,7 +864,7 @@ ArgSymbol::ArgSymbol(IntentTag iIntent, const char* iName,
     variableExpr = block;
   else
     variableExpr = new BlockStmt(iVariableExpr, BLOCK_SCOPELESS);
-  gArgSymbols.add(this);
+  registerAst(gArgSymbols, this);
 }
 
 
@@ -1052,7 +1057,7 @@ TypeSymbol::TypeSymbol(const char* init_name, Type* init_type) :
   if (!type)
     INT_FATAL(this, "TypeSymbol constructor called without type");
   type->addSymbol(this);
-  gTypeSymbols.add(this);
+  registerAst(gTypeSymbols, this);
 }
 
 
@@ -1304,7 +1309,7 @@ FnSymbol::FnSymbol(const char* initName) :
   retSymbol(NULL)
 {
   substitutions.clear();
-  gFnSymbols.add(this);
+  registerAst(gFnSymbols, this);
   formals.parent = this;
 }
 
@@ -1712,9 +1717,11 @@ void FnSymbol::codegenHeaderC(void) {
 
   //
   // A function prototype can be labeled static if it is neither
-  // exported nor external
+  // exported nor external, and all of the generated code is in one
+  // translation unit
   //
-  if (!hasFlag(FLAG_EXPORT) && !hasFlag(FLAG_EXTERN)) {
+  if (!hasFlag(FLAG_EXPORT) && !hasFlag(FLAG_EXTERN) &&
+      !codegenSeparateUnits()) {
     fprintf(outfile, "static ");
   }
   fprintf(outfile, "%s", codegenFunctionType(true).c.c_str());
@@ -2187,7 +2194,7 @@ void FnSymbol::accept(AstVisitor* visitor) {
 EnumSymbol::EnumSymbol(const char* init_name) :
   Symbol(E_EnumSymbol, init_name)
 {
-  gEnumSymbols.add(this);
+  registerAst(gEnumSymbols, this);
 }
 
 
@@ -2245,7 +2252,7 @@ ModuleSymbol::ModuleSymbol(const char* iName,
 
   block->parentSymbol = this;
   registerModule(this);
-  gModuleSymbols.add(this);
+  registerAst(gModuleSymbols, this);
 }
 
 
@@ -2553,7 +2560,7 @@ LabelSymbol::LabelSymbol(const char* init_name) :
   Symbol(E_LabelSymbol, init_name, NULL),
   iterResumeGoto(NULL)
 {
-  gLabelSymbols.add(this);
+  registerAst(gLabelSymbols, this);
 }
 
 
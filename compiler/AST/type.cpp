@@ -107,7 +107,7 @@ PrimitiveType::PrimitiveType(Symbol *init, bool internalType) :
   Type(E_PrimitiveType, init)
 {
   isInternalType = internalType;
-  gPrimitiveTypes.add(this);
+  registerAst(gPrimitiveTypes, this);
 }
 
 
@@ -152,7 +152,7 @@ EnumType::EnumType() :
   Type(E_EnumType, NULL),
   constants(), integerType(NULL)
 {
-  gEnumTypes.add(this);
+  registerAst(gEnumTypes, this);
   constants.parent = this;
 }
 
@@ -472,7 +472,7 @@ AggregateType::AggregateType(AggregateTag initTag) :
   methods.clear();
   fields.parent = this;
   inherits.parent = this;
-  gAggregateTypes.add(this);
+  registerAst(gAggregateTypes, this);
 }
 
 
@@ -41,6 +41,7 @@ public:
   // Instance Interface
   //
 public:
+                         CForLoop(BlockStmt* body);
   virtual               ~CForLoop();
 
   virtual CForLoop*      copy(SymbolMap* map = NULL, bool internal = false);
@@ -70,8 +71,6 @@ public:
 private:
                          CForLoop();
 
-                         CForLoop(BlockStmt* body);
-
   std::string            codegenCForLoopHeader   (BlockStmt* block);
   GenRet                 codegenCForLoopCondition(BlockStmt* block);
 
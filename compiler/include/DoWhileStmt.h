@@ -35,6 +35,8 @@ public:
   // Instance interface
   //
 public:
+                         DoWhileStmt(VarSymbol* var,
+                                     BlockStmt* initBody);
   virtual               ~DoWhileStmt();
 
   virtual DoWhileStmt*   copy(SymbolMap* map = NULL, bool internal = false);
@@ -49,9 +51,6 @@ public:
 
 private:
                          DoWhileStmt();
-
-                         DoWhileStmt(VarSymbol* var,
-                                     BlockStmt* initBody);
 };
 
 #endif
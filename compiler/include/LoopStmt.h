@@ -33,6 +33,9 @@ public:
   LabelSymbol*           continueLabelGet()                           const;
   void                   continueLabelSet(LabelSymbol* sym);
 
+  bool                   isOrderIndependent()                         const;
+  void                   orderIndependentSet(bool orderIndependent);
+
 protected:
                          LoopStmt(BlockStmt* initBody);
   virtual               ~LoopStmt();
@@ -40,6 +43,10 @@ protected:
   LabelSymbol*           mBreakLabel;
   LabelSymbol*           mContinueLabel;
 
+  // True if the iterations of the loop may be run in any order, as for
+  // the follower loop of a forall.  Used to emit vectorization hints.
+  bool                   mOrderIndependent;
+
 private:
                          LoopStmt();
 };
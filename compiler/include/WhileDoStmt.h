@@ -38,6 +38,8 @@ private:
   // Instance interface
   //
 public:
+                         WhileDoStmt(VarSymbol* var,
+                                     BlockStmt* initBody);
   virtual               ~WhileDoStmt();
 
   virtual WhileDoStmt*   copy(SymbolMap* map = NULL, bool internal = false);
@@ -52,9 +54,6 @@ public:
 
 private:
                          WhileDoStmt();
-
-                         WhileDoStmt(VarSymbol* var,
-                                     BlockStmt* initBody);
 };
 
 #endif
@@ -33,6 +33,7 @@
 #ifndef _BASEAST_H_
 #define _BASEAST_H_
 
+#include "compilerThreads.h"
 #include "map.h"
 #include "vec.h"
 
@@ -96,6 +97,14 @@ foreach_ast(proto_classes);
 foreach_ast(decl_gvecs);
 #undef decl_gvecs
 
+// add a newly constructed node to the global vector for its type
+template <class T>
+static inline void registerAst(Vec<T*>& gvec, T* ast) {
+  lockCompilerThreads();
+  gvec.add(ast);
+  unlockCompilerThreads();
+}
+
 //
 // type definitions for common maps
 //
@@ -103,17 +112,18 @@ typedef Map<Symbol*,Symbol*>     SymbolMap;
 typedef MapElem<Symbol*,Symbol*> SymbolMapElem;
 
 // how an AST node knows its location in the source code
-// (assumed to get copied upon assignment and parameter passing)
-class astlocT {
-public:
-  astlocT(int linenoArg, const char* filenameArg) :
-    filename(filenameArg), lineno(linenoArg)
-    {}
-
+// (assumed to get copied upon assignment and parameter passing;
+// kept plain data so that currentAstLoc can be COMPILER_THREAD_LOCAL)
+struct astlocT {
   const char* filename;  // filename of location
   int         lineno;    // line number of location
 };
 
+static inline astlocT makeAstloc(int lineno, const char* filename) {
+  astlocT astloc = { filename, lineno };
+  return astloc;
+}
+
 //
 // enumerated type of all AST node types
 //
@@ -219,6 +229,10 @@ public:
   int               id;         // Unique ID
   astlocT           astloc;     // Location of this node in the source code
 
+  // AST nodes are allocated from pools segregated by size
+  static void*      operator new(size_t size);
+  static void       operator delete(void* ptr, size_t size);
+
 protected:
                     BaseAST(AstTag type);
   virtual          ~BaseAST();
@@ -240,6 +254,16 @@ int    lastNodeIDUsed();
 // trace various AST node removals
 void   trace_remove(BaseAST* ast, char flag);
 
+// record that a node has been taken out of the tree, for cleanAst
+void   note_removed(BaseAST* ast);
+
+// bracket code that may create nodes on several compiler threads,
+// running numTasks tasks; startAstTask(i) is called on the thread that
+// runs task i before it runs it, and startAstTask(-1) after
+void   startAstThreads(int numTasks);
+void   startAstTask(int task);
+void   finishAstThreads();
+
 
 //
 // macro to update the global line number used to set the line number
@@ -254,7 +278,7 @@ void   trace_remove(BaseAST* ast, char flag);
 //
 #define SET_LINENO(ast) astlocMarker markAstLoc(ast->astloc)
 
-extern astlocT currentAstLoc;
+extern COMPILER_THREAD_LOCAL astlocT currentAstLoc;
 
 class astlocMarker {
 public:
@@ -464,7 +488,8 @@ def_to_ast(ParamForLoop);
 //
 // clean IR between passes by clearing some back pointers to dead AST
 // nodes and removing dead AST nodes from the global vectors of AST
-// nodes. "dead" means !isAlive && !isRootModule.
+// nodes. "dead" means !isAlive && !isRootModule.  Only the nodes created
+// or removed from the tree since the previous call are examined.
 //
 void cleanAst(void);
 
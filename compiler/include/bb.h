@@ -28,6 +28,7 @@ class Stmt;
 class Symbol;
 class SymExpr;
 
+#include "compilerThreads.h"
 #include "map.h"
 
 #include <vector>
@@ -74,15 +75,14 @@ public:
 
   static void               printBitVectorSets(std::vector<BitVec*>& sets);
 
-  static BasicBlock*        basicBlock;
-
-  static Map<LabelSymbol*,
-             BasicBlock*>   labelMaps;
+private:
+  // The state of a buildBasicBlocks(fn) call.  It lives on the stack of
+  // that call, so that several compiler threads can build the basic
+  // blocks of different functions at once.
+  struct Builder;
 
-  static Map<LabelSymbol*,
-             std::vector<BasicBlock*>*> gotoMaps;
+  static COMPILER_THREAD_LOCAL Builder* builder;
 
-private:
   static void               buildBasicBlocks(FnSymbol* fn,
                                              Expr*     stmt,
                                              bool      mark);
@@ -96,8 +96,6 @@ private:
 
   static bool               verifyBasicBlocks(FnSymbol* fn);
 
-  static int                nextID;
-
   //
   // Instance methods/variables
   //
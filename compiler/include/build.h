@@ -35,6 +35,24 @@ class FnSymbol;
 class ModuleSymbol;
 class Type;
 
+//
+// Counters used to number the functions that the parser generates for
+// if-, let-, loop-, reduce- and scan-expressions and for lambdas
+// (_if_fn<n>, _let_fn<n>, ...).  The module cache consults and advances
+// them when it restores a file instead of parsing it.
+//
+enum GenFnCounter {
+  GEN_FN_IF,
+  GEN_FN_LET,
+  GEN_FN_LOOPEXPR,
+  GEN_FN_REDUCE,
+  GEN_FN_SCAN,
+  GEN_FN_LAMBDA,
+  NUM_GEN_FN_COUNTERS
+};
+
+extern int genFnCounters[NUM_GEN_FN_COUNTERS];
+
 BlockStmt* buildPragmaStmt(Vec<const char*>*, BlockStmt*);
 
 CallExpr* buildOneTuple(Expr* elem);
@@ -154,6 +154,9 @@ void setupClang(GenInfo* info, std::string rtmain);
 
 bool isBuiltinExternCFunction(const char* cname);
 
+// Is the generated C split across several translation units?
+bool codegenSeparateUnits(void);
+
 std::string numToString(int64_t num);
 std::string int64_to_string(int64_t i);
 std::string uint64_to_string(uint64_t i);
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2004-2014 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _COMPILER_THREADS_H_
+#define _COMPILER_THREADS_H_
+
+#include "vec.h"
+
+#include <pthread.h>
+
+class FnSymbol;
+
+//
+// Support for running the function-local parts of the optimization
+// passes on several threads (--compiler-threads).
+//
+// Work done by parallelFor and forEachFunction may run concurrently,
+// so it must only change the body of the function it is working on.
+// The global bookkeeping done when AST nodes are created or removed
+// (ids, the gvecs, the node pools, cleanAst's removed lists, and the
+// string table) is serialized with lockCompilerThreads.  Afterwards the
+// nodes that were created are given the ids they would have had if the
+// calls had run one after another in order, and the gvecs are put back
+// in id order.
+//
+// The state that each thread needs its own copy of is declared with
+// COMPILER_THREAD_LOCAL.  That is __thread where the C++ compiler has
+// it (it is a GNU extension, which unlike C++11 thread_local is only
+// allowed for plain data with constant initializers, and so costs no
+// more to use than a global).  Elsewhere it is empty, and
+// --compiler-threads is ignored.
+//
+#if defined(__GNUC__)
+#define HAVE_COMPILER_THREADS
+#define COMPILER_THREAD_LOCAL __thread
+#else
+#define COMPILER_THREAD_LOCAL
+#endif
+
+// Calls body(i, arg) for each 0 <= i < n, using up to fCompilerThreads
+// threads, and returns when all of the calls have finished.
+void parallelFor(int n, void (*body)(int i, void* arg), void* arg);
+
+// Calls body(fn) for each function in fns, as parallelFor does.
+void forEachFunction(Vec<FnSymbol*>& fns, void (*body)(FnSymbol* fn));
+
+// True while parallelFor is running calls on several threads.
+extern bool compilerThreadsActive;
+
+static inline bool onCompilerThreads() {
+  return compilerThreadsActive;
+}
+
+// Serialize updates to state that is shared by all compiler threads.
+// These do nothing unless parallelFor is running on several threads.
+extern pthread_mutex_t compilerThreadsMutex;
+
+static inline void lockCompilerThreads() {
+  if (compilerThreadsActive)
+    pthread_mutex_lock(&compilerThreadsMutex);
+}
+
+static inline void unlockCompilerThreads() {
+  if (compilerThreadsActive)
+    pthread_mutex_unlock(&compilerThreadsMutex);
+}
+
+#endif
@@ -22,11 +22,12 @@
 
 class Expr;
 
-void  checkConfigs(void);
-void  parseCmdLineConfig(const char *, const char *);
-Expr* getCmdLineConfig(const char *);
-void  useCmdLineConfig(const char *);
-bool  isUsedCmdLineConfig(const char *);
+void        checkConfigs(void);
+void        parseCmdLineConfig(const char *, const char *);
+Expr*       getCmdLineConfig(const char *);
+const char* getCmdLineConfigText(const char *);
+void        useCmdLineConfig(const char *);
+bool        isUsedCmdLineConfig(const char *);
 
 extern bool mainHasArgs;
 
@@ -107,6 +107,7 @@ extern const char* chpl_env_var_names[];
 
 extern bool  printPasses;
 extern FILE* printPassesFile; 
+extern char  fPrintPassStats[FILENAME_MAX+1];
 
 // Set true if CHPL_WIDE_POINTERS==struct.
 // In that case, the code generator emits structures
@@ -131,6 +132,7 @@ extern bool fGenIDS;
 extern bool fLocal;
 extern bool fHeterogeneous;
 extern bool fieeefloat;
+extern bool fVectorize;
 extern int  fMaxCIdentLen;
 
 extern bool llvmCodegen;
@@ -180,6 +182,11 @@ extern bool fReportDeadModules;
 
 extern bool debugCCode, optimizeCCode, specializeCCode;
 
+// Number of translation units to split the generated C into; the
+// backend make is run with this many jobs.  1 means a single unit.
+extern int fCodegenJobs;
+extern int fCompilerThreads;
+
 extern bool fEnableTimers;
 extern Timer timer1;
 extern Timer timer2;
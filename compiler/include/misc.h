@@ -62,6 +62,7 @@ void setupError(const char* filename, int lineno, int tag);
 void handleError(const char* fmt, ...);
 void handleError(BaseAST* ast, const char* fmt, ...);
 void handleError(FILE* file, BaseAST* ast, const char* fmt, ...);
+int  numUserDiagnostics(void);
 void exitIfFatalErrorsEncountered(void);
 void considerExitingEndOfPass(void);
 void printCallStack(bool force, bool shortModule, FILE* out);
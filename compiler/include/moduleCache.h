@@ -0,0 +1,49 @@
+/*
+ * Copyright 2004-2014 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MODULE_CACHE_H_
+#define _MODULE_CACHE_H_
+
+#include <cstdio>
+
+#include "symbol.h"
+
+//
+// The module cache saves the AST that parsing an internal or standard
+// module file produces, so that later compilations can restore it
+// instead of lexing and parsing the file again.  It is enabled by
+// --module-cache-dir (CHPL_MODULE_CACHE_DIR).
+//
+extern char moduleCacheDir[FILENAME_MAX+1];
+
+bool       moduleCacheEnabled(ModTag modType);
+
+// Returns the top-level block of the file restored from the cache, or
+// NULL if there is no usable cache entry for it.
+BlockStmt* loadCachedParse(const char* filename, ModTag modType);
+
+// Bracket the parse of a file that should be added to the cache.
+void       startCachingParse(const char* filename, ModTag modType);
+void       finishCachingParse(BlockStmt* block);
+
+// Side effects of parsing that the cache needs to reproduce or check.
+void       noteModuleUseForCache(const char* name, CallExpr* useExpr);
+void       noteConfigLookupForCache(const char* name);
+
+#endif
@@ -166,10 +166,10 @@ class VarSymbol : public Symbol {
   const char* doc;
 
   GenRet codegen();
-  void codegenDefC(bool global = false);
+  void codegenDefC(bool global = false, bool isHeader = false);
   void codegenDef();
   // global vars are different ...
-  void codegenGlobalDef();
+  void codegenGlobalDef(bool isHeader = false);
   
 };
 
@@ -21,11 +21,16 @@
 
 #include "baseAST.h"
 #include "driver.h"
+#include "misc.h"
+#include "symbol.h"
+#include "type.h"
 
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
 
+#include <sys/resource.h>
+
 // Used to collect the times as the program runs
 class Phase
 {
@@ -44,11 +49,22 @@ public:
   static void              ReportTime(const char* name, double secs);
   static void              ReportText(const char* text);
 
+  static void              MemoryUsage(unsigned long& rss,
+                                       unsigned long& maxRss);
+
   char*                    mName;       // Only set for kPrimary
   int                      mPassId;
   PhaseTracker::SubPhase   mSubPhase;
   unsigned long            mStartTime;  // Elapsed time from main() usecs
 
+  unsigned long            mRss;        // KB at the start of the phase
+  unsigned long            mMaxRss;     // KB high-water mark at the start
+
+  // Only set for kVerify with --print-pass-stats, i.e. just after cleanAst
+  std::vector<int>         mAstCounts;  // Live nodes of each AST type
+  int                      mInstantiatedFns;
+  int                      mInstantiatedTypes;
+
 private:
   Phase();
 };
@@ -76,12 +92,23 @@ public:
                        unsigned long accumTime, 
                        unsigned long totalTime)      const;
 
+  static void    StatsHeaderCSV(FILE* fp);
+  void           PrintCSV (FILE* fp)                 const;
+  void           PrintJSON(FILE* fp)                 const;
+
   char*          mName;
   int            mPassId;
   int            mIndex;
   unsigned long  mPrimary;          // usecs()
   unsigned long  mVerify;           // usecs()
   unsigned long  mCleanAst;         // usecs()
+
+  unsigned long  mRss;              // KB at the end of the pass
+  unsigned long  mMaxRss;           // KB high-water mark at the end
+
+  std::vector<int> mAstCounts;      // Empty outside of the pass list
+  int            mInstantiatedFns;
+  int            mInstantiatedTypes;
 };
 
 struct SortByTime
@@ -195,6 +222,9 @@ void PhaseTracker::PassesCollect(std::vector<Pass>& passes) const
       // Check if it's time to push an completed pass
       if (i > 0 && mPhases[i]->mSubPhase == PhaseTracker::kPrimary)
       {
+        pass.mRss    = mPhases[i]->mRss;
+        pass.mMaxRss = mPhases[i]->mMaxRss;
+
         passes.push_back(pass);
         pass.Reset();
       }
@@ -214,7 +244,10 @@ void PhaseTracker::PassesCollect(std::vector<Pass>& passes) const
           break;
 
         case PhaseTracker::kVerify:
-          pass.mVerify   = elapsed;
+          pass.mVerify            = elapsed;
+          pass.mAstCounts         = mPhases[i]->mAstCounts;
+          pass.mInstantiatedFns   = mPhases[i]->mInstantiatedFns;
+          pass.mInstantiatedTypes = mPhases[i]->mInstantiatedTypes;
           break;
 
         case PhaseTracker::kCleanAst:
@@ -223,10 +256,53 @@ void PhaseTracker::PassesCollect(std::vector<Pass>& passes) const
       }
     }
 
+    Phase::MemoryUsage(pass.mRss, pass.mMaxRss);
+
     passes.push_back(pass);
   }
 }
 
+void PhaseTracker::ReportStats(const char* fileName) const
+{
+  std::vector<Pass> passes;
+  size_t            len       = strlen(fileName);
+  bool              json      = len >= 5 && strcmp(fileName + len - 5, ".json") == 0;
+  FILE*             fp        = fopen(fileName, "w");
+
+  if (fp == 0)
+  {
+    USR_WARN("Error opening pass statistics file: %s.", fileName);
+    return;
+  }
+
+  PassesCollect(passes);
+
+  if (json == true)
+  {
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"total\": %.6f,\n", mTimer.elapsedUsecs() / 1e6);
+    fprintf(fp, "  \"passes\": [\n");
+
+    for (size_t i = 0; i < passes.size(); i++)
+    {
+      passes[i].PrintJSON(fp);
+      fprintf(fp, (i < passes.size() - 1) ? ",\n" : "\n");
+    }
+
+    fprintf(fp, "  ]\n");
+    fprintf(fp, "}\n");
+  }
+  else
+  {
+    Pass::StatsHeaderCSV(fp);
+
+    for (size_t i = 0; i < passes.size(); i++)
+      passes[i].PrintCSV(fp);
+  }
+
+  fclose(fp);
+}
+
 static void PassesSortByTime(std::vector<Pass>& passes)
 {
   std::sort(passes.begin(), passes.end(), SortByTime());
@@ -286,6 +362,31 @@ Phase::Phase(const char*            name,
   mPassId    = passId;
   mSubPhase  = subPhase;
   mStartTime = startTime;
+
+  MemoryUsage(mRss, mMaxRss);
+
+  mInstantiatedFns   = 0;
+  mInstantiatedTypes = 0;
+
+  // The AST has just been cleaned, so the vectors hold only live nodes
+  if (subPhase == PhaseTracker::kVerify && fPrintPassStats[0] != '\0')
+  {
+#define count_ast(type) mAstCounts.push_back(g##type##s.n)
+    foreach_ast(count_ast);
+#undef count_ast
+
+    forv_Vec(FnSymbol, fn, gFnSymbols)
+    {
+      if (fn->instantiatedFrom != 0)
+        mInstantiatedFns++;
+    }
+
+    forv_Vec(AggregateType, at, gAggregateTypes)
+    {
+      if (at->instantiatedFrom != 0)
+        mInstantiatedTypes++;
+    }
+  }
 }
 
 Phase::~Phase()
@@ -341,6 +442,47 @@ void Phase::ReportText(const char* text)
     fputs(text, printPassesFile);
 }
 
+// The current and the largest resident set size so far, in KB.  The
+// current size is only available where there is a /proc file system.
+// Both are read from the same snapshot there, so that they agree; the
+// high-water mark otherwise comes from getrusage(), which may have been
+// updated at a different time, so it is kept at least the current size.
+void Phase::MemoryUsage(unsigned long& rss, unsigned long& maxRss)
+{
+  FILE*         fp    = fopen("/proc/self/status", "r");
+  char          line[256];
+  struct rusage usage;
+
+  rss    = 0;
+  maxRss = 0;
+
+  if (fp != 0)
+  {
+    while (fgets(line, sizeof(line), fp) != 0)
+    {
+      if (strncmp(line, "VmRSS:", 6) == 0)
+        rss    = strtoul(line + 6, 0, 10);
+
+      else if (strncmp(line, "VmHWM:", 6) == 0)
+        maxRss = strtoul(line + 6, 0, 10);
+    }
+
+    fclose(fp);
+  }
+
+  if (maxRss == 0 && getrusage(RUSAGE_SELF, &usage) == 0)
+  {
+#ifdef __APPLE__
+    maxRss = usage.ru_maxrss / 1024;   // bytes rather than KB
+#else
+    maxRss = usage.ru_maxrss;
+#endif
+  }
+
+  if (maxRss < rss)
+    maxRss = rss;
+}
+
 /************************************* | **************************************
 *                                                                             *
 * Implementation of Pass                                                      *
@@ -365,6 +507,13 @@ void Pass::Reset()
   mPrimary  = 0;
   mVerify   = 0;
   mCleanAst = 0;
+
+  mRss      = 0;
+  mMaxRss   = 0;
+
+  mAstCounts.clear();
+  mInstantiatedFns   = 0;
+  mInstantiatedTypes = 0;
 }
 
 unsigned long Pass::TotalTime() const
@@ -453,5 +602,73 @@ void Pass::Footer(FILE*         fp,
           totalTime / 1e6);
 }
 
+static const char* sAstNames[] =
+{
+#define ast_name(type) #type,
+  foreach_ast_sep(ast_name, )
+#undef ast_name
+};
+
+void Pass::StatsHeaderCSV(FILE* fp)
+{
+  fprintf(fp, "pass,name,main,check,clean,rss_kb,max_rss_kb");
+  fprintf(fp, ",instantiated_fns,instantiated_types");
+
+  for (size_t i = 0; i < sizeof(sAstNames) / sizeof(sAstNames[0]); i++)
+    fprintf(fp, ",%s", sAstNames[i]);
+
+  fprintf(fp, "\n");
+}
+
+// Passes outside of the pass list have no AST statistics, so those
+// fields are left empty
+void Pass::PrintCSV(FILE* fp) const
+{
+  fprintf(fp, "%d,%s,%.6f,%.6f,%.6f,%lu,%lu",
+          mPassId,
+          mName,
+          mPrimary  / 1e6,
+          mVerify   / 1e6,
+          mCleanAst / 1e6,
+          mRss,
+          mMaxRss);
+
+  if (mAstCounts.size() > 0)
+  {
+    fprintf(fp, ",%d,%d", mInstantiatedFns, mInstantiatedTypes);
 
+    for (size_t i = 0; i < mAstCounts.size(); i++)
+      fprintf(fp, ",%d", mAstCounts[i]);
+  }
+  else
+  {
+    fprintf(fp, ",,");
 
+    for (size_t i = 0; i < sizeof(sAstNames) / sizeof(sAstNames[0]); i++)
+      fprintf(fp, ",");
+  }
+
+  fprintf(fp, "\n");
+}
+
+void Pass::PrintJSON(FILE* fp) const
+{
+  fprintf(fp, "    { \"pass\": %d, \"name\": \"%s\",", mPassId, mName);
+  fprintf(fp, " \"main\": %.6f, \"check\": %.6f, \"clean\": %.6f,",
+          mPrimary / 1e6, mVerify / 1e6, mCleanAst / 1e6);
+  fprintf(fp, " \"rss_kb\": %lu, \"max_rss_kb\": %lu", mRss, mMaxRss);
+
+  if (mAstCounts.size() > 0)
+  {
+    fprintf(fp, ",\n      \"instantiated_fns\": %d,", mInstantiatedFns);
+    fprintf(fp, " \"instantiated_types\": %d,", mInstantiatedTypes);
+    fprintf(fp, "\n      \"asts\": {");
+
+    for (size_t i = 0; i < mAstCounts.size(); i++)
+      fprintf(fp, "%s \"%s\": %d", (i > 0) ? "," : "", sAstNames[i], mAstCounts[i]);
+
+    fprintf(fp, " }");
+  }
+
+  fprintf(fp, " }");
+}
@@ -56,6 +56,11 @@
 * of these passes.  Phases that occur before and after the Passes ignore      *
 * the check and clean phases.                                                 *
 *                                                                             *
+* The tracker also records the compiler's memory use at the start of each     *
+* phase and, for --print-pass-stats, the number of live AST nodes of each     *
+* type and of instantiated functions and types at the end of each pass.       *
+* ReportStats() writes these along with the times as JSON or CSV.             *
+*                                                                             *
 ************************************** | *************************************/
 
 class Phase;
@@ -84,6 +89,8 @@ public:
 
   void                 ReportRollup()                                const;
 
+  void                 ReportStats (const char* fileName)            const;
+
 private:
   void                 PassesCollect(std::vector<Pass>& passes) const;
   
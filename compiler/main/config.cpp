@@ -21,11 +21,13 @@
 
 #include "chpl.h"
 #include "expr.h"
+#include "moduleCache.h"
 #include "stmt.h"
 
 #include "../parser/lexyacc.h"
 
 static Map<const char*, Expr*> configMap;
+static Map<const char*, const char*> configTextMap;
 static Vec<const char*>        usedConfigParams;
 
 bool                           mainHasArgs;
@@ -106,14 +108,22 @@ void parseCmdLineConfig(const char* name, const char* value) {
   }
 
   configMap.put(astr(name), newExpr);
+  configTextMap.put(astr(name), astr(value));
 
   INT_ASSERT(newExpr == configMap.get(astr(name)));
 }
 
 Expr* getCmdLineConfig(const char* name) {
+  noteConfigLookupForCache(name);
+
   return configMap.get(astr(name));
 }
 
+// The text that was given for a config on the command line, or NULL.
+const char* getCmdLineConfigText(const char* name) {
+  return configTextMap.get(astr(name));
+}
+
 void useCmdLineConfig(const char* name) {
   usedConfigParams.add(name);
 }
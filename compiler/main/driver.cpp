@@ -26,11 +26,13 @@
 
 #include "arg.h"
 #include "chpl.h"
+#include "compilerThreads.h"
 #include "config.h"
 #include "countTokens.h"
 #include "files.h"
 #include "log.h"
 #include "misc.h"
+#include "moduleCache.h"
 #include "mysystem.h"
 #include "PhaseTracker.h"
 #include "primitive.h"
@@ -44,6 +46,7 @@
 #include <inttypes.h>
 #include <string>
 #include <sstream>
+#include <unistd.h>
 
 const char* chplBinaryName = NULL;
 
@@ -121,6 +124,7 @@ bool fEnableTaskTracking = false;
 
 bool  printPasses     = false;
 FILE* printPassesFile = NULL;
+char  fPrintPassStats[FILENAME_MAX+1] = "";
 
 // flag for llvmWideOpt
 bool fLLVMWideOpt = false;
@@ -146,6 +150,7 @@ int fLinkStyle = LS_DEFAULT; // use backend compiler's default
 bool fLocal;   // initialized in setupOrderedGlobals() below
 bool fHeterogeneous = false; // re-initialized in setupOrderedGlobals() below
 bool fieeefloat = true;
+bool fVectorize = false;
 bool report_inlining = false;
 char fExplainCall[256] = "";
 int explainCallID = -1;
@@ -188,6 +193,8 @@ char breakOnCodegenCname[256] = "";
 bool debugCCode = false;
 bool optimizeCCode = false;
 bool specializeCCode = false;
+int fCodegenJobs = 1;
+int fCompilerThreads = 1;
 
 bool fEnableTimers = false;
 Timer timer1;
@@ -630,6 +637,7 @@ static void setBaselineFlag(const ArgumentState* state, const char* unused) {
   fNoTupleCopyOpt = true;
   fNoPrivatization = true;
   fNoOptimizeOnClauses = true;
+  fVectorize = false;
   fConditionalDynamicDispatchLimit = 0;
 }
 
@@ -700,6 +708,7 @@ static ArgumentDescription arg_desc[] = {
  {"", ' ', NULL, "Module Processing Options", NULL, NULL, NULL, NULL},
  {"count-tokens", ' ', NULL, "[Don't] count tokens in main modules", "N", &countTokens, "CHPL_COUNT_TOKENS", NULL},
  {"main-module", ' ', "<module>", "Specify entry point module", "S256", mainModuleName, NULL, NULL},
+ {"module-cache-dir", ' ', "<directory>", "Cache parsed modules in directory", "P", moduleCacheDir, "CHPL_MODULE_CACHE_DIR", NULL},
  {"module-dir", 'M', "<directory>", "Add directory to module search path", "P", moduleSearchPath, NULL, addModulePath},
  {"print-code-size", ' ', NULL, "[Don't] print code size of main modules", "N", &printTokens, "CHPL_PRINT_TOKENS", NULL},
  {"print-module-files", ' ', NULL, "Print module file locations", "F", &printModuleFiles, NULL, NULL},
@@ -711,6 +720,7 @@ static ArgumentDescription arg_desc[] = {
  {"", ' ', NULL, "Optimization Control Options", NULL, NULL, NULL, NULL},
  {"baseline", ' ', NULL, "Disable all Chapel optimizations", "F", &fBaseline, "CHPL_BASELINE", setBaselineFlag},
  {"cache-remote", ' ', NULL, "Enable cache for remote data (must be enabled specifically)", "F", &fCacheRemote, "CHPL_CACHE_REMOTE", setCacheEnable},
+ {"compiler-threads", ' ', "<n>", "Run per-function optimizations on <n> threads, 0 for one per processor", "I", &fCompilerThreads, "CHPL_COMPILER_THREADS", NULL},
  {"conditional-dynamic-dispatch-limit", ' ', "<limit>", "Set limit on # of inline conditionals used for dynamic dispatch", "I", &fConditionalDynamicDispatchLimit, "CHPL_CONDITIONAL_DYNAMIC_DISPATCH_LIMIT", NULL},
  {"copy-propagation", ' ', NULL, "Enable [disable] copy propagation", "n", &fNoCopyPropagation, "CHPL_DISABLE_COPY_PROPAGATION", NULL},
  {"dead-code-elimination", ' ', NULL, "Enable [disable] dead code elimination", "n", &fNoDeadCodeElimination, "CHPL_DISABLE_DEAD_CODE_ELIMINATION", NULL},
@@ -731,6 +741,7 @@ static ArgumentDescription arg_desc[] = {
  {"scalar-replace-limit", ' ', "<limit>", "Limit on the size of tuples being replaced during scalar replacement", "I", &scalar_replace_limit, "CHPL_SCALAR_REPLACE_TUPLE_LIMIT", NULL},
  {"tuple-copy-opt", ' ', NULL, "Enable [disable] tuple (memcpy) optimization", "n", &fNoTupleCopyOpt, "CHPL_DISABLE_TUPLE_COPY_OPT", NULL},
  {"tuple-copy-limit", ' ', "<limit>", "Limit on the size of tuples considered for optimization", "I", &tuple_copy_limit, "CHPL_TUPLE_COPY_LIMIT", NULL},
+ {"vectorize", ' ', NULL, "Enable [disable] vectorization hints for order-independent loops", "N", &fVectorize, "CHPL_VECTORIZE", NULL},
  
  {"", ' ', NULL, "Run-time Semantic Check Options", NULL, NULL, NULL, NULL},
  {"no-checks", ' ', NULL, "Disable all following run-time checks", "F", &fNoChecks, "CHPL_NO_CHECKS", turnOffChecks},
@@ -741,6 +752,7 @@ static ArgumentDescription arg_desc[] = {
 
  {"", ' ', NULL, "C Code Generation Options", NULL, NULL, NULL, NULL},
  {"codegen", ' ', NULL, "[Don't] Do code generation", "n", &no_codegen, "CHPL_NO_CODEGEN", NULL},
+ {"codegen-jobs", ' ', "<n>", "Split generated code into <n> translation units and compile them in parallel, 0 for one per processor", "I", &fCodegenJobs, "CHPL_CODEGEN_JOBS", NULL},
  {"cpp-lines", ' ', NULL, "[Don't] Generate #line annotations", "N", &printCppLineno, "CHPL_CG_CPP_LINES", noteCppLinesSet},
  {"max-c-ident-len", ' ', NULL, "Maximum length of identifiers in generated code, 0 for unlimited", "I", &fMaxCIdentLen, "CHPL_MAX_C_IDENT_LEN", NULL},
  {"savec", ' ', "<directory>", "Save generated C code in directory", "P", saveCDir, "CHPL_SAVEC_DIR", verifySaveCDir},
@@ -774,6 +786,7 @@ static ArgumentDescription arg_desc[] = {
  {"print-commands", ' ', NULL, "[Don't] print system commands", "N", &printSystemCommands, "CHPL_PRINT_COMMANDS", NULL},
  {"print-passes", ' ', NULL, "[Don't] print compiler passes", "N", &printPasses, "CHPL_PRINT_PASSES", NULL},
  {"print-passes-file", ' ', "<filename>", "Print compiler passes to <filename>", "S", NULL, "CHPL_PRINT_PASSES_FILE", setPrintPassesFile},
+ {"print-pass-stats", ' ', "<filename>", "Print per-pass statistics to <filename>", "P", fPrintPassStats, "CHPL_PRINT_PASS_STATS", NULL},
 
  {"", ' ', NULL, "Miscellaneous Options", NULL, NULL, NULL, NULL},
 // Support for extern { c-code-here } blocks could be toggled with this
@@ -874,6 +887,28 @@ static void setupDependentVars(void) {
     USR_FATAL("This compiler was built without LLVM support");
 #endif
 
+  if (fCodegenJobs < 0) {
+    USR_FATAL("--codegen-jobs must be non-negative");
+  } else if (fCodegenJobs == 0) {
+    long numProcs = sysconf(_SC_NPROCESSORS_ONLN);
+    fCodegenJobs = (numProcs > 0) ? (int)numProcs : 1;
+  }
+
+  if (fCompilerThreads < 0) {
+    USR_FATAL("--compiler-threads must be non-negative");
+  } else if (fCompilerThreads == 0) {
+    long numProcs = sysconf(_SC_NPROCESSORS_ONLN);
+    fCompilerThreads = (numProcs > 0) ? (int)numProcs : 1;
+  }
+
+#ifndef HAVE_COMPILER_THREADS
+  if (fCompilerThreads > 1) {
+    USR_WARN("This compiler was built without thread support, "
+             "ignoring --compiler-threads");
+    fCompilerThreads = 1;
+  }
+#endif
+
   if (specializeCCode && (strcmp(CHPL_TARGET_ARCH, "unknown") == 0)) {
     USR_WARN("--specialize was set, but CHPL_TARGET_ARCH is 'unknown'. If "
               "you want any specialization to occur please set CHPL_TARGET_ARCH "
@@ -1000,6 +1035,10 @@ int main(int argc, char* argv[]) {
     fclose(printPassesFile);
   }
 
+  if (fPrintPassStats[0] != '\0') {
+    tracker.ReportStats(fPrintPassStats);
+  }
+
   clean_exit(0);
 
   return 0;
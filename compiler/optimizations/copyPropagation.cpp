@@ -24,6 +24,7 @@
 #include "astutil.h"
 #include "bb.h"
 #include "bitVec.h"
+#include "compilerThreads.h"
 #include "expr.h"
 #include "passes.h"
 #include "stlUtil.h"
@@ -123,8 +124,10 @@
 //#############################################################################
 
 
-static size_t s_repl_count; ///< The number of pairs replaced by GCP this pass.
-static size_t s_ref_repl_count; ///< The number of references replaced this pass.
+// These are per thread because functions may be transformed on several
+// compiler threads at once.
+static COMPILER_THREAD_LOCAL size_t s_repl_count; ///< The number of pairs replaced by GCP this pass.
+static COMPILER_THREAD_LOCAL size_t s_ref_repl_count; ///< The number of references replaced this pass.
 
 
 //#############################################################################
@@ -1380,26 +1383,35 @@ size_t singleAssignmentRefPropagation(FnSymbol* fn) {
 }
 
 
+// This only changes the body of fn, so it can run on several functions at
+// once (see compilerThreads.h).
+static void copyPropagation(FnSymbol* fn) {
+  localCopyPropagation(fn);
+  if (!fNoDeadCodeElimination)
+    deadVariableElimination(fn);
+
+  // Iterate GCP with dead code elimination.
+  while (globalCopyPropagation(fn) > 0)
+  {
+    if (!fNoDeadCodeElimination)
+      deadVariableElimination(fn);
+  }
+}
+
+
 void copyPropagation(void) {
   if (!fNoCopyPropagation) {
+    Vec<FnSymbol*> fns;
+
     forv_Vec(FnSymbol, fn, gFnSymbols)
     {
       // This test is necessary because extern function stubs may contain
       // _construct_tuple calls that are unresolved.
-      if (fn->hasFlag(FLAG_EXTERN))
-        continue;
-
-      localCopyPropagation(fn);
-      if (!fNoDeadCodeElimination)
-        deadVariableElimination(fn);
-
-      // Iterate GCP with dead code elimination.
-      while (globalCopyPropagation(fn) > 0)
-      {
-        if (!fNoDeadCodeElimination)
-          deadVariableElimination(fn);
-      }
+      if (!fn->hasFlag(FLAG_EXTERN))
+        fns.add(fn);
     }
+
+    forEachFunction(fns, copyPropagation);
   }
 }
 
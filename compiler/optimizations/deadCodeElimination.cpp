@@ -22,6 +22,7 @@
 
 #include "astutil.h"
 #include "bb.h"
+#include "compilerThreads.h"
 #include "expr.h"
 #include "passes.h"
 #include "stlUtil.h"
@@ -171,7 +172,10 @@ void deadExpressionElimination(FnSymbol* fn) {
         }
 
         // NOAKES 2014/11/14 Testing suggests this is always a NOP
-        removeDeadIterResumeGotos();
+        // The gotos may be in other functions, so on several compiler
+        // threads deadCodeElimination() does this when they are done.
+        if (!onCompilerThreads())
+          removeDeadIterResumeGotos();
       }
     }
   }
@@ -327,32 +331,37 @@ static void deadModuleElimination() {
 }
 
 
-void deadCodeElimination() {
-  if (!fNoDeadCodeElimination) {
+// This only changes the body of fn, so it can run on several functions at
+// once (see compilerThreads.h).
+static void eliminateDeadCode(FnSymbol* fn) {
+  deadBlockElimination(fn);
 
-    deadBlockCount  = 0;
-    deadModuleCount = 0;
+  // 2014/10/17   Noakes and Elliot
+  // Dead Block Elimination may convert valid loops to "malformed" loops.
+  // Some of these will break BasicBlock construction. Clean them up.
+  cleanupLoopBlocks(fn);
 
-    forv_Vec(FnSymbol, fn, gFnSymbols) {
-      deadBlockElimination(fn);
+  deadCodeElimination(fn);
 
-      // 2014/10/17   Noakes and Elliot
-      // Dead Block Elimination may convert valid loops to "malformed" loops.
-      // Some of these will break BasicBlock construction. Clean them up.
-      cleanupLoopBlocks(fn);
+  deadVariableElimination(fn);
 
-      deadCodeElimination(fn);
+  // 2014/10/17   Noakes and Elliot
+  // Dead Variable Elimination may convert some "uninteresting" loops
+  // that were left behind by DeadBlockElimination and turn them in to
+  // "malformed" loops.  Cleanup again.
+  cleanupLoopBlocks(fn);
 
-      deadVariableElimination(fn);
+  deadExpressionElimination(fn);
+}
 
-      // 2014/10/17   Noakes and Elliot
-      // Dead Variable Elimination may convert some "uninteresting" loops
-      // that were left behind by DeadBlockElimination and turn them in to
-      // "malformed" loops.  Cleanup again.
-      cleanupLoopBlocks(fn);
+void deadCodeElimination() {
+  if (!fNoDeadCodeElimination) {
+    deadBlockCount  = 0;
+    deadModuleCount = 0;
 
-      deadExpressionElimination(fn);
-    }
+    forEachFunction(gFnSymbols, eliminateDeadCode);
+
+    removeDeadIterResumeGotos();
 
     deadModuleElimination();
 
@@ -407,7 +416,7 @@ static void deadBlockElimination(FnSymbol* fn)
     if (reachable.count(bb))
       continue;
 
-    ++deadBlockCount;
+    __sync_fetch_and_add(&deadBlockCount, 1);
 
     // Remove all of its expressions.
     for_vector(Expr, expr, bb->exprs)
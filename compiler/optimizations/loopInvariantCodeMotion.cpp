@@ -23,6 +23,7 @@
 #include "bb.h"
 #include "bitVec.h"
 #include "CForLoop.h"
+#include "compilerThreads.h"
 #include "dominator.h"
 #include "expr.h"
 #include "ForLoop.h"
@@ -63,9 +64,9 @@ Timer allOperandsAreLoopInvariantTimer;
 Timer computeAliasTimer;
 Timer collectSymExprAndDefTimer;
 Timer calculateActualDefsTimer;
-Timer buildBBTimer;
-Timer computeDominatorTimer;
-Timer collectNaturalLoopsTimer;
+double buildBBSecs;
+double computeDominatorSecs;
+double collectNaturalLoopsSecs;
 Timer canPerformCodeMotionTimer;
 Timer buildLocalDefMapsTimer;
 Timer computeLoopInvariantsTimer;
@@ -1124,6 +1125,66 @@ static bool canPerformCodeMotion(Loop* loop) {
  * hoisted before the loop(into a preheader of sorts) so long as they definition dominates
  * all uses in the loop, and the block that the definition is located in dominates all exits. 
  */
+//
+// The dominators and natural loops of a function, which are found from
+// its basic blocks before any code in it is moved.
+//
+struct FunctionLoops {
+  std::vector<BitVec*> dominators;
+  std::vector<Loop*>   loops;
+
+#ifdef detailedTiming
+  // Each function is timed on its own, since this is done on several
+  // threads, and the times are summed afterwards.
+  Timer                buildBBTimer;
+  Timer                computeDominatorTimer;
+  Timer                collectNaturalLoopsTimer;
+#endif
+};
+
+// Finding the loops only reads the function, so it is done for several
+// functions at once (see compilerThreads.h).  The code motion itself is
+// done on one thread because canPerformCodeMotion looks into the bodies
+// of the functions that a loop calls.
+static const int findLoopsBatchSize = 256;
+
+struct FindLoopsBatch {
+  int            first;
+  FunctionLoops* results;
+};
+
+static void findLoops(int index, void* arg) {
+  FindLoopsBatch* batch  = (FindLoopsBatch*)arg;
+  FnSymbol*       fn     = gFnSymbols.v[batch->first + index];
+  FunctionLoops&  result = batch->results[index];
+
+  //build the basic blocks, where the first bb is the entry block 
+  startTimer(result.buildBBTimer);
+
+  BasicBlock::buildBasicBlocks(fn);
+
+  std::vector<BasicBlock*> basicBlocks = *fn->basicBlocks;
+
+  BasicBlock* entryBlock = basicBlocks[0];
+
+  unsigned nBlocks = basicBlocks.size();
+
+  stopTimer(result.buildBBTimer);
+
+  //compute the dominators 
+  startTimer(result.computeDominatorTimer);
+  for(unsigned i = 0; i < nBlocks; i++) {
+    result.dominators.push_back(new BitVec(nBlocks));
+  }    
+  computeDominators(result.dominators, basicBlocks);
+  stopTimer(result.computeDominatorTimer);
+
+  //Collect all of the loops 
+  startTimer(result.collectNaturalLoopsTimer);
+  collectNaturalLoops(result.loops, basicBlocks, entryBlock, result.dominators);
+  stopTimer(result.collectNaturalLoopsTimer);
+}
+
 void loopInvariantCodeMotion(void) {
 
   if(fNoloopInvariantCodeMotion) {
@@ -1132,87 +1193,76 @@ void loopInvariantCodeMotion(void) {
   
   startTimer(overallTimer);
   long numLoops = 0;
-    
-  //TODO use stl routine here
-  forv_Vec(FnSymbol, fn, gFnSymbols) {
 
-    //build the basic blocks, where the first bb is the entry block 
-    startTimer(buildBBTimer);
+  for (int first = 0; first < gFnSymbols.n; first += findLoopsBatchSize) {
+    int                        n = std::min(findLoopsBatchSize,
+                                            gFnSymbols.n - first);
+    std::vector<FunctionLoops> results(n);
+    FindLoopsBatch             batch = { first, &results[0] };
 
-    BasicBlock::buildBasicBlocks(fn);
+    parallelFor(n, findLoops, &batch);
 
-    std::vector<BasicBlock*> basicBlocks = *fn->basicBlocks;
+    for (int i = 0; i < n; i++) {
+      FnSymbol*             fn         = gFnSymbols.v[first + i];
+      std::vector<BitVec*>& dominators = results[i].dominators;
+      std::vector<Loop*>&   loops      = results[i].loops;
 
-    BasicBlock* entryBlock = basicBlocks[0];
+#ifdef detailedTiming
+      buildBBSecs             += results[i].buildBBTimer.elapsedSecs();
+      computeDominatorSecs    += results[i].computeDominatorTimer.elapsedSecs();
+      collectNaturalLoopsSecs += results[i].collectNaturalLoopsTimer.elapsedSecs();
+#endif
 
-    unsigned nBlocks = basicBlocks.size();
+      //For each loop found 
+      for_vector(Loop, curLoop, loops) {
 
-    stopTimer(buildBBTimer);
-    
-    //compute the dominators 
-    startTimer(computeDominatorTimer);
-    std::vector<BitVec*> dominators;
-    for(unsigned i = 0; i < nBlocks; i++) {
-      dominators.push_back(new BitVec(nBlocks));
-    }    
-    computeDominators(dominators, basicBlocks);
-    stopTimer(computeDominatorTimer);
-
-    //Collect all of the loops 
-    startTimer(collectNaturalLoopsTimer);
-    std::vector<Loop*> loops;
-    collectNaturalLoops(loops, basicBlocks, entryBlock, dominators);
-    stopTimer(collectNaturalLoopsTimer);
-    
-    //For each loop found 
-    for_vector(Loop, curLoop, loops) {
-
-      //check that this loop doesn't have anything that 
-      //would prevent code motion from occurring
-      startTimer(canPerformCodeMotionTimer);
-      bool performCodeMotion = canPerformCodeMotion(curLoop);
-      stopTimer(canPerformCodeMotionTimer);
-      if(performCodeMotion == false) {
-        continue;
-      }
+        //check that this loop doesn't have anything that 
+        //would prevent code motion from occurring
+        startTimer(canPerformCodeMotionTimer);
+        bool performCodeMotion = canPerformCodeMotion(curLoop);
+        stopTimer(canPerformCodeMotionTimer);
+        if(performCodeMotion == false) {
+          continue;
+        }
       
-      //build the defUseMaps 
-      startTimer(buildLocalDefMapsTimer);
-      symToVecSymExprMap localDefMap;
-      symToVecSymExprMap localUseMap;
-      std::map<SymExpr*, int> localMap;
-      buildLocalDefUseMaps(curLoop, localDefMap, localUseMap, localMap);
-      stopTimer(buildLocalDefMapsTimer);
-
-      //and use the defUseMaps to compute loop invariants 
-      startTimer(computeLoopInvariantsTimer);
-      std::vector<SymExpr*> loopInvariants;
-      computeLoopInvariants(loopInvariants, curLoop, localDefMap, fn);
-      stopTimer(computeLoopInvariantsTimer);
-
-      //For each invariant, only move it if its def, dominates all uses and all exits 
-      for_vector(SymExpr, symExpr, loopInvariants) {
-        if(CallExpr* call = toCallExpr(symExpr->parentExpr)) {
-          if(defDominatesAllUses(curLoop, symExpr, dominators, localMap, localUseMap)) {
-            if(defDominatesAllExits(curLoop, symExpr, dominators, localMap)) {
-              curLoop->insertBefore(call);
-            }
-          }   
+        //build the defUseMaps 
+        startTimer(buildLocalDefMapsTimer);
+        symToVecSymExprMap localDefMap;
+        symToVecSymExprMap localUseMap;
+        std::map<SymExpr*, int> localMap;
+        buildLocalDefUseMaps(curLoop, localDefMap, localUseMap, localMap);
+        stopTimer(buildLocalDefMapsTimer);
+
+        //and use the defUseMaps to compute loop invariants 
+        startTimer(computeLoopInvariantsTimer);
+        std::vector<SymExpr*> loopInvariants;
+        computeLoopInvariants(loopInvariants, curLoop, localDefMap, fn);
+        stopTimer(computeLoopInvariantsTimer);
+
+        //For each invariant, only move it if its def, dominates all uses and all exits 
+        for_vector(SymExpr, symExpr, loopInvariants) {
+          if(CallExpr* call = toCallExpr(symExpr->parentExpr)) {
+            if(defDominatesAllUses(curLoop, symExpr, dominators, localMap, localUseMap)) {
+              if(defDominatesAllExits(curLoop, symExpr, dominators, localMap)) {
+                curLoop->insertBefore(call);
+              }
+            }   
+          }
         }
-      }
                 
-      freeLocalDefUseMaps(localDefMap, localUseMap);
-    }
-    numLoops += loops.size();
+        freeLocalDefUseMaps(localDefMap, localUseMap);
+      }
+      numLoops += loops.size();
     
-    for_vector(Loop, loop, loops) {
-      delete loop;
-      loop = 0;
-    }
+      for_vector(Loop, loop, loops) {
+        delete loop;
+        loop = 0;
+      }
     
-    for_vector(BitVec, bitVec, dominators) {
-      delete bitVec;
-      bitVec = 0;
+      for_vector(BitVec, bitVec, dominators) {
+        delete bitVec;
+        bitVec = 0;
+      }
     }
   }
 
@@ -1225,14 +1275,14 @@ void loopInvariantCodeMotion(void) {
   maxTimeFile = fopen(astr(CHPL_HOME,"/LICMmaxTime.txt"), "a");
 
   fprintf(timingFile, "For compilation of %s:                         \n", compileCommand );
-  fprintf(timingFile, "Spent %2.3f seconds building basic blocks      \n", buildBBTimer.elapsedSecs()); 
-  fprintf(timingFile, "Spent %2.3f seconds computing dominators       \n", computeDominatorTimer.elapsedSecs()); 
-  fprintf(timingFile, "Spent %2.3f seconds collecting natural loops   \n", collectNaturalLoopsTimer.elapsedSecs()); 
+  fprintf(timingFile, "Spent %2.3f seconds building basic blocks      \n", buildBBSecs); 
+  fprintf(timingFile, "Spent %2.3f seconds computing dominators       \n", computeDominatorSecs); 
+  fprintf(timingFile, "Spent %2.3f seconds collecting natural loops   \n", collectNaturalLoopsSecs); 
   fprintf(timingFile, "Spent %2.3f seconds building local def maps    \n", buildLocalDefMapsTimer.elapsedSecs()); 
   fprintf(timingFile, "Spent %2.3f seconds on can perform code motion \n", canPerformCodeMotionTimer.elapsedSecs());
   fprintf(timingFile, "Spent %2.3f seconds computing loop invariants  \n", computeLoopInvariantsTimer.elapsedSecs()); 
    
-  double estimateOverall = buildBBTimer.elapsedSecs() + computeDominatorTimer.elapsedSecs() + collectNaturalLoopsTimer.elapsedSecs() + \
+  double estimateOverall = buildBBSecs + computeDominatorSecs + collectNaturalLoopsSecs + \
   buildLocalDefMapsTimer.elapsedSecs() + canPerformCodeMotionTimer.elapsedSecs() + computeLoopInvariantsTimer.elapsedSecs();
   
   
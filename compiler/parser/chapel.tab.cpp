@@ -0,0 +1,6616 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 31 "chapel.ypp"
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include "lexyacc.h" // all #includes here, for make depend
+#include "driver.h"
+
+  static int query_uid = 1;
+  int captureTokens;
+  char captureString[1024];
+
+ 
+#define YYLLOC_DEFAULT(Current, Rhs, N)                                 \
+  if (N) {                                                              \
+        (Current).first_line   = (Rhs)[1].first_line;                   \
+        if ((Current).first_line) yystartlineno = (Current).first_line; \
+        (Current).first_column = (Rhs)[1].first_column;                 \
+        (Current).last_line    = (Rhs)[N].last_line;                    \
+        (Current).last_column  = (Rhs)[N].last_column;                  \
+        (Current).comment = NULL;                                       \
+  } else  {                                                             \
+    (Current) = yylloc;                                                 \
+  }                                                                     \
+
+
+#line 99 "chapel.tab.cpp"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+#include "chapel.tab.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_TIDENT = 3,                     /* TIDENT  */
+  YYSYMBOL_IMAGLITERAL = 4,                /* IMAGLITERAL  */
+  YYSYMBOL_INTLITERAL = 5,                 /* INTLITERAL  */
+  YYSYMBOL_REALLITERAL = 6,                /* REALLITERAL  */
+  YYSYMBOL_STRINGLITERAL = 7,              /* STRINGLITERAL  */
+  YYSYMBOL_EXTERNCODE = 8,                 /* EXTERNCODE  */
+  YYSYMBOL_TALIGN = 9,                     /* TALIGN  */
+  YYSYMBOL_TATOMIC = 10,                   /* TATOMIC  */
+  YYSYMBOL_TBEGIN = 11,                    /* TBEGIN  */
+  YYSYMBOL_TBREAK = 12,                    /* TBREAK  */
+  YYSYMBOL_TBY = 13,                       /* TBY  */
+  YYSYMBOL_TCLASS = 14,                    /* TCLASS  */
+  YYSYMBOL_TCOBEGIN = 15,                  /* TCOBEGIN  */
+  YYSYMBOL_TCOFORALL = 16,                 /* TCOFORALL  */
+  YYSYMBOL_TCONFIG = 17,                   /* TCONFIG  */
+  YYSYMBOL_TCONST = 18,                    /* TCONST  */
+  YYSYMBOL_TCONTINUE = 19,                 /* TCONTINUE  */
+  YYSYMBOL_TDELETE = 20,                   /* TDELETE  */
+  YYSYMBOL_TDMAPPED = 21,                  /* TDMAPPED  */
+  YYSYMBOL_TDO = 22,                       /* TDO  */
+  YYSYMBOL_TDOMAIN = 23,                   /* TDOMAIN  */
+  YYSYMBOL_TELSE = 24,                     /* TELSE  */
+  YYSYMBOL_TENUM = 25,                     /* TENUM  */
+  YYSYMBOL_TEXPORT = 26,                   /* TEXPORT  */
+  YYSYMBOL_TEXTERN = 27,                   /* TEXTERN  */
+  YYSYMBOL_TFOR = 28,                      /* TFOR  */
+  YYSYMBOL_TFORALL = 29,                   /* TFORALL  */
+  YYSYMBOL_TIF = 30,                       /* TIF  */
+  YYSYMBOL_TIN = 31,                       /* TIN  */
+  YYSYMBOL_TINDEX = 32,                    /* TINDEX  */
+  YYSYMBOL_TINLINE = 33,                   /* TINLINE  */
+  YYSYMBOL_TINOUT = 34,                    /* TINOUT  */
+  YYSYMBOL_TITER = 35,                     /* TITER  */
+  YYSYMBOL_TLABEL = 36,                    /* TLABEL  */
+  YYSYMBOL_TLAMBDA = 37,                   /* TLAMBDA  */
+  YYSYMBOL_TLET = 38,                      /* TLET  */
+  YYSYMBOL_TLOCAL = 39,                    /* TLOCAL  */
+  YYSYMBOL_TMINUSMINUS = 40,               /* TMINUSMINUS  */
+  YYSYMBOL_TMODULE = 41,                   /* TMODULE  */
+  YYSYMBOL_TNEW = 42,                      /* TNEW  */
+  YYSYMBOL_TNIL = 43,                      /* TNIL  */
+  YYSYMBOL_TNOINIT = 44,                   /* TNOINIT  */
+  YYSYMBOL_TON = 45,                       /* TON  */
+  YYSYMBOL_TOTHERWISE = 46,                /* TOTHERWISE  */
+  YYSYMBOL_TOUT = 47,                      /* TOUT  */
+  YYSYMBOL_TPARAM = 48,                    /* TPARAM  */
+  YYSYMBOL_TPLUSPLUS = 49,                 /* TPLUSPLUS  */
+  YYSYMBOL_TPRAGMA = 50,                   /* TPRAGMA  */
+  YYSYMBOL_TPRIMITIVE = 51,                /* TPRIMITIVE  */
+  YYSYMBOL_TPROC = 52,                     /* TPROC  */
+  YYSYMBOL_TRECORD = 53,                   /* TRECORD  */
+  YYSYMBOL_TREDUCE = 54,                   /* TREDUCE  */
+  YYSYMBOL_TREF = 55,                      /* TREF  */
+  YYSYMBOL_TRETURN = 56,                   /* TRETURN  */
+  YYSYMBOL_TSCAN = 57,                     /* TSCAN  */
+  YYSYMBOL_TSELECT = 58,                   /* TSELECT  */
+  YYSYMBOL_TSERIAL = 59,                   /* TSERIAL  */
+  YYSYMBOL_TSINGLE = 60,                   /* TSINGLE  */
+  YYSYMBOL_TSPARSE = 61,                   /* TSPARSE  */
+  YYSYMBOL_TSUBDOMAIN = 62,                /* TSUBDOMAIN  */
+  YYSYMBOL_TSYNC = 63,                     /* TSYNC  */
+  YYSYMBOL_TTHEN = 64,                     /* TTHEN  */
+  YYSYMBOL_TTYPE = 65,                     /* TTYPE  */
+  YYSYMBOL_TUNDERSCORE = 66,               /* TUNDERSCORE  */
+  YYSYMBOL_TUNION = 67,                    /* TUNION  */
+  YYSYMBOL_TUSE = 68,                      /* TUSE  */
+  YYSYMBOL_TVAR = 69,                      /* TVAR  */
+  YYSYMBOL_TWHEN = 70,                     /* TWHEN  */
+  YYSYMBOL_TWHERE = 71,                    /* TWHERE  */
+  YYSYMBOL_TWHILE = 72,                    /* TWHILE  */
+  YYSYMBOL_TWITH = 73,                     /* TWITH  */
+  YYSYMBOL_TYIELD = 74,                    /* TYIELD  */
+  YYSYMBOL_TZIP = 75,                      /* TZIP  */
+  YYSYMBOL_TALIAS = 76,                    /* TALIAS  */
+  YYSYMBOL_TAND = 77,                      /* TAND  */
+  YYSYMBOL_TASSIGN = 78,                   /* TASSIGN  */
+  YYSYMBOL_TASSIGNBAND = 79,               /* TASSIGNBAND  */
+  YYSYMBOL_TASSIGNBOR = 80,                /* TASSIGNBOR  */
+  YYSYMBOL_TASSIGNBXOR = 81,               /* TASSIGNBXOR  */
+  YYSYMBOL_TASSIGNDIVIDE = 82,             /* TASSIGNDIVIDE  */
+  YYSYMBOL_TASSIGNEXP = 83,                /* TASSIGNEXP  */
+  YYSYMBOL_TASSIGNLAND = 84,               /* TASSIGNLAND  */
+  YYSYMBOL_TASSIGNLOR = 85,                /* TASSIGNLOR  */
+  YYSYMBOL_TASSIGNMINUS = 86,              /* TASSIGNMINUS  */
+  YYSYMBOL_TASSIGNMOD = 87,                /* TASSIGNMOD  */
+  YYSYMBOL_TASSIGNMULTIPLY = 88,           /* TASSIGNMULTIPLY  */
+  YYSYMBOL_TASSIGNPLUS = 89,               /* TASSIGNPLUS  */
+  YYSYMBOL_TASSIGNSL = 90,                 /* TASSIGNSL  */
+  YYSYMBOL_TASSIGNSR = 91,                 /* TASSIGNSR  */
+  YYSYMBOL_TBAND = 92,                     /* TBAND  */
+  YYSYMBOL_TBNOT = 93,                     /* TBNOT  */
+  YYSYMBOL_TBOR = 94,                      /* TBOR  */
+  YYSYMBOL_TBXOR = 95,                     /* TBXOR  */
+  YYSYMBOL_TCOLON = 96,                    /* TCOLON  */
+  YYSYMBOL_TCOMMA = 97,                    /* TCOMMA  */
+  YYSYMBOL_TDIVIDE = 98,                   /* TDIVIDE  */
+  YYSYMBOL_TDOT = 99,                      /* TDOT  */
+  YYSYMBOL_TDOTDOT = 100,                  /* TDOTDOT  */
+  YYSYMBOL_TDOTDOTDOT = 101,               /* TDOTDOTDOT  */
+  YYSYMBOL_TEQUAL = 102,                   /* TEQUAL  */
+  YYSYMBOL_TEXP = 103,                     /* TEXP  */
+  YYSYMBOL_TGREATER = 104,                 /* TGREATER  */
+  YYSYMBOL_TGREATEREQUAL = 105,            /* TGREATEREQUAL  */
+  YYSYMBOL_THASH = 106,                    /* THASH  */
+  YYSYMBOL_TLESS = 107,                    /* TLESS  */
+  YYSYMBOL_TLESSEQUAL = 108,               /* TLESSEQUAL  */
+  YYSYMBOL_TMINUS = 109,                   /* TMINUS  */
+  YYSYMBOL_TMOD = 110,                     /* TMOD  */
+  YYSYMBOL_TNOT = 111,                     /* TNOT  */
+  YYSYMBOL_TNOTEQUAL = 112,                /* TNOTEQUAL  */
+  YYSYMBOL_TOR = 113,                      /* TOR  */
+  YYSYMBOL_TPLUS = 114,                    /* TPLUS  */
+  YYSYMBOL_TQUESTION = 115,                /* TQUESTION  */
+  YYSYMBOL_TSEMI = 116,                    /* TSEMI  */
+  YYSYMBOL_TSHIFTLEFT = 117,               /* TSHIFTLEFT  */
+  YYSYMBOL_TSHIFTRIGHT = 118,              /* TSHIFTRIGHT  */
+  YYSYMBOL_TSTAR = 119,                    /* TSTAR  */
+  YYSYMBOL_TSWAP = 120,                    /* TSWAP  */
+  YYSYMBOL_TIO = 121,                      /* TIO  */
+  YYSYMBOL_TLCBR = 122,                    /* TLCBR  */
+  YYSYMBOL_TRCBR = 123,                    /* TRCBR  */
+  YYSYMBOL_TLP = 124,                      /* TLP  */
+  YYSYMBOL_TRP = 125,                      /* TRP  */
+  YYSYMBOL_TLSBR = 126,                    /* TLSBR  */
+  YYSYMBOL_TRSBR = 127,                    /* TRSBR  */
+  YYSYMBOL_TNOELSE = 128,                  /* TNOELSE  */
+  YYSYMBOL_TUPLUS = 129,                   /* TUPLUS  */
+  YYSYMBOL_TUMINUS = 130,                  /* TUMINUS  */
+  YYSYMBOL_YYACCEPT = 131,                 /* $accept  */
+  YYSYMBOL_program = 132,                  /* program  */
+  YYSYMBOL_toplevel_stmt_ls = 133,         /* toplevel_stmt_ls  */
+  YYSYMBOL_toplevel_stmt = 134,            /* toplevel_stmt  */
+  YYSYMBOL_pragma_ls = 135,                /* pragma_ls  */
+  YYSYMBOL_stmt = 136,                     /* stmt  */
+  YYSYMBOL_module_decl_stmt = 137,         /* module_decl_stmt  */
+  YYSYMBOL_module = 138,                   /* module  */
+  YYSYMBOL_block_stmt = 139,               /* block_stmt  */
+  YYSYMBOL_stmt_ls = 140,                  /* stmt_ls  */
+  YYSYMBOL_use_stmt = 141,                 /* use_stmt  */
+  YYSYMBOL_assignment_stmt = 142,          /* assignment_stmt  */
+  YYSYMBOL_opt_ident = 143,                /* opt_ident  */
+  YYSYMBOL_ident = 144,                    /* ident  */
+  YYSYMBOL_do_stmt = 145,                  /* do_stmt  */
+  YYSYMBOL_return_stmt = 146,              /* return_stmt  */
+  YYSYMBOL_class_level_stmt = 147,         /* class_level_stmt  */
+  YYSYMBOL_extern_block_stmt = 148,        /* extern_block_stmt  */
+  YYSYMBOL_loop_stmt = 149,                /* loop_stmt  */
+  YYSYMBOL_zippered_iterator = 150,        /* zippered_iterator  */
+  YYSYMBOL_if_stmt = 151,                  /* if_stmt  */
+  YYSYMBOL_select_stmt = 152,              /* select_stmt  */
+  YYSYMBOL_when_stmt_ls = 153,             /* when_stmt_ls  */
+  YYSYMBOL_when_stmt = 154,                /* when_stmt  */
+  YYSYMBOL_type_select_stmt = 155,         /* type_select_stmt  */
+  YYSYMBOL_class_decl_stmt = 156,          /* class_decl_stmt  */
+  YYSYMBOL_opt_extern = 157,               /* opt_extern  */
+  YYSYMBOL_class_tag = 158,                /* class_tag  */
+  YYSYMBOL_opt_inherit = 159,              /* opt_inherit  */
+  YYSYMBOL_class_level_stmt_ls = 160,      /* class_level_stmt_ls  */
+  YYSYMBOL_enum_decl_stmt = 161,           /* enum_decl_stmt  */
+  YYSYMBOL_enum_ls = 162,                  /* enum_ls  */
+  YYSYMBOL_enum_item = 163,                /* enum_item  */
+  YYSYMBOL_lambda_decl_expr = 164,         /* lambda_decl_expr  */
+  YYSYMBOL_165_1 = 165,                    /* $@1  */
+  YYSYMBOL_166_2 = 166,                    /* $@2  */
+  YYSYMBOL_linkage_spec = 167,             /* linkage_spec  */
+  YYSYMBOL_fn_decl_stmt = 168,             /* fn_decl_stmt  */
+  YYSYMBOL_169_3 = 169,                    /* $@3  */
+  YYSYMBOL_170_4 = 170,                    /* $@4  */
+  YYSYMBOL_fn_decl_stmt_inner = 171,       /* fn_decl_stmt_inner  */
+  YYSYMBOL_fn_ident = 172,                 /* fn_ident  */
+  YYSYMBOL_assignop_ident = 173,           /* assignop_ident  */
+  YYSYMBOL_opt_formal_ls = 174,            /* opt_formal_ls  */
+  YYSYMBOL_req_formal_ls = 175,            /* req_formal_ls  */
+  YYSYMBOL_formal_ls = 176,                /* formal_ls  */
+  YYSYMBOL_formal = 177,                   /* formal  */
+  YYSYMBOL_opt_intent_tag = 178,           /* opt_intent_tag  */
+  YYSYMBOL_opt_this_intent_tag = 179,      /* opt_this_intent_tag  */
+  YYSYMBOL_proc_or_iter = 180,             /* proc_or_iter  */
+  YYSYMBOL_opt_ret_tag = 181,              /* opt_ret_tag  */
+  YYSYMBOL_opt_function_body_stmt = 182,   /* opt_function_body_stmt  */
+  YYSYMBOL_function_body_stmt = 183,       /* function_body_stmt  */
+  YYSYMBOL_query_expr = 184,               /* query_expr  */
+  YYSYMBOL_opt_query_expr = 185,           /* opt_query_expr  */
+  YYSYMBOL_var_arg_expr = 186,             /* var_arg_expr  */
+  YYSYMBOL_opt_where_part = 187,           /* opt_where_part  */
+  YYSYMBOL_type_alias_decl_stmt = 188,     /* type_alias_decl_stmt  */
+  YYSYMBOL_type_alias_decl_stmt_inner = 189, /* type_alias_decl_stmt_inner  */
+  YYSYMBOL_opt_init_type = 190,            /* opt_init_type  */
+  YYSYMBOL_var_decl_stmt = 191,            /* var_decl_stmt  */
+  YYSYMBOL_opt_config = 192,               /* opt_config  */
+  YYSYMBOL_var_decl_stmt_inner_ls = 193,   /* var_decl_stmt_inner_ls  */
+  YYSYMBOL_var_decl_stmt_inner = 194,      /* var_decl_stmt_inner  */
+  YYSYMBOL_tuple_var_decl_component = 195, /* tuple_var_decl_component  */
+  YYSYMBOL_tuple_var_decl_stmt_inner_ls = 196, /* tuple_var_decl_stmt_inner_ls  */
+  YYSYMBOL_opt_init_expr = 197,            /* opt_init_expr  */
+  YYSYMBOL_opt_reindex_expr = 198,         /* opt_reindex_expr  */
+  YYSYMBOL_opt_type = 199,                 /* opt_type  */
+  YYSYMBOL_array_type = 200,               /* array_type  */
+  YYSYMBOL_opt_formal_array_elt_type = 201, /* opt_formal_array_elt_type  */
+  YYSYMBOL_formal_array_type = 202,        /* formal_array_type  */
+  YYSYMBOL_opt_formal_type = 203,          /* opt_formal_type  */
+  YYSYMBOL_expr_ls = 204,                  /* expr_ls  */
+  YYSYMBOL_tuple_component = 205,          /* tuple_component  */
+  YYSYMBOL_tuple_expr_ls = 206,            /* tuple_expr_ls  */
+  YYSYMBOL_opt_actual_ls = 207,            /* opt_actual_ls  */
+  YYSYMBOL_actual_ls = 208,                /* actual_ls  */
+  YYSYMBOL_actual_expr = 209,              /* actual_expr  */
+  YYSYMBOL_ident_expr = 210,               /* ident_expr  */
+  YYSYMBOL_type_level_expr = 211,          /* type_level_expr  */
+  YYSYMBOL_for_expr = 212,                 /* for_expr  */
+  YYSYMBOL_cond_expr = 213,                /* cond_expr  */
+  YYSYMBOL_nil_expr = 214,                 /* nil_expr  */
+  YYSYMBOL_stmt_level_expr = 215,          /* stmt_level_expr  */
+  YYSYMBOL_opt_task_intent_ls = 216,       /* opt_task_intent_ls  */
+  YYSYMBOL_task_intent_clause = 217,       /* task_intent_clause  */
+  YYSYMBOL_task_intent_ls = 218,           /* task_intent_ls  */
+  YYSYMBOL_intent_expr = 219,              /* intent_expr  */
+  YYSYMBOL_io_expr = 220,                  /* io_expr  */
+  YYSYMBOL_new_expr = 221,                 /* new_expr  */
+  YYSYMBOL_let_expr = 222,                 /* let_expr  */
+  YYSYMBOL_expr = 223,                     /* expr  */
+  YYSYMBOL_lhs_expr = 224,                 /* lhs_expr  */
+  YYSYMBOL_fun_expr = 225,                 /* fun_expr  */
+  YYSYMBOL_call_expr = 226,                /* call_expr  */
+  YYSYMBOL_dot_expr = 227,                 /* dot_expr  */
+  YYSYMBOL_parenthesized_expr = 228,       /* parenthesized_expr  */
+  YYSYMBOL_literal_expr = 229,             /* literal_expr  */
+  YYSYMBOL_assoc_expr_ls = 230,            /* assoc_expr_ls  */
+  YYSYMBOL_binary_op_expr = 231,           /* binary_op_expr  */
+  YYSYMBOL_unary_op_expr = 232,            /* unary_op_expr  */
+  YYSYMBOL_reduce_expr = 233,              /* reduce_expr  */
+  YYSYMBOL_scan_expr = 234,                /* scan_expr  */
+  YYSYMBOL_reduce_scan_op_expr = 235       /* reduce_scan_op_expr  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int16 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL \
+             && defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+  YYLTYPE yyls_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
+      + 2 * YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  3
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   10720
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  131
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  105
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  422
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  798
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   385
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_uint8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    36,    37,    38,    39,    40,    41,    42,    43,    44,
+      45,    46,    47,    48,    49,    50,    51,    52,    53,    54,
+      55,    56,    57,    58,    59,    60,    61,    62,    63,    64,
+      65,    66,    67,    68,    69,    70,    71,    72,    73,    74,
+      75,    76,    77,    78,    79,    80,    81,    82,    83,    84,
+      85,    86,    87,    88,    89,    90,    91,    92,    93,    94,
+      95,    96,    97,    98,    99,   100,   101,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,   111,   112,   113,   114,
+     115,   116,   117,   118,   119,   120,   121,   122,   123,   124,
+     125,   126,   127,   128,   129,   130
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
+{
+       0,   218,   218,   223,   224,   230,   231,   236,   237,   242,
+     243,   244,   245,   246,   247,   248,   249,   250,   251,   252,
+     253,   254,   255,   256,   257,   258,   259,   260,   261,   262,
+     263,   264,   265,   266,   267,   271,   273,   278,   293,   294,
+     299,   300,   305,   309,   310,   311,   312,   313,   314,   315,
+     316,   317,   318,   319,   320,   321,   322,   323,   327,   328,
+     332,   336,   337,   341,   342,   346,   347,   348,   349,   350,
+     351,   355,   370,   371,   372,   373,   374,   375,   376,   377,
+     378,   379,   380,   381,   382,   383,   384,   385,   386,   392,
+     398,   404,   410,   417,   427,   431,   432,   433,   434,   438,
+     443,   444,   448,   450,   455,   462,   468,   469,   473,   475,
+     477,   482,   483,   488,   489,   491,   496,   506,   513,   517,
+     525,   526,   531,   536,   530,   561,   562,   564,   567,   570,
+     573,   579,   585,   578,   615,   619,   624,   628,   636,   637,
+     638,   639,   640,   641,   642,   643,   644,   645,   646,   647,
+     648,   649,   650,   651,   652,   653,   654,   655,   656,   657,
+     658,   659,   660,   661,   665,   666,   667,   668,   669,   670,
+     671,   672,   673,   674,   675,   676,   680,   681,   685,   689,
+     690,   691,   695,   697,   699,   701,   706,   707,   708,   709,
+     710,   711,   712,   713,   714,   715,   719,   720,   721,   725,
+     726,   730,   731,   732,   733,   734,   738,   739,   743,   744,
+     748,   750,   755,   756,   760,   761,   765,   766,   770,   772,
+     774,   779,   786,   797,   798,   800,   805,   812,   819,   826,
+     834,   843,   844,   845,   849,   850,   858,   860,   866,   871,
+     873,   875,   880,   882,   884,   891,   892,   893,   897,   898,
+     903,   904,   905,   906,   926,   930,   934,   942,   946,   947,
+     948,   952,   954,   960,   962,   964,   969,   970,   971,   972,
+     973,   974,   975,   981,   982,   983,   984,   988,   989,   990,
+     994,   995,   999,  1000,  1004,  1005,  1009,  1010,  1011,  1012,
+    1013,  1017,  1028,  1029,  1030,  1031,  1032,  1033,  1035,  1037,
+    1039,  1041,  1043,  1045,  1050,  1052,  1054,  1056,  1058,  1060,
+    1062,  1064,  1066,  1068,  1070,  1072,  1074,  1081,  1087,  1093,
+    1099,  1108,  1113,  1121,  1122,  1123,  1124,  1125,  1126,  1127,
+    1128,  1133,  1134,  1138,  1142,  1143,  1147,  1158,  1159,  1164,
+    1169,  1177,  1178,  1179,  1180,  1181,  1182,  1183,  1184,  1185,
+    1187,  1189,  1191,  1193,  1195,  1200,  1201,  1202,  1203,  1214,
+    1215,  1219,  1220,  1221,  1225,  1226,  1227,  1235,  1236,  1237,
+    1241,  1242,  1243,  1244,  1245,  1246,  1247,  1254,  1255,  1259,
+    1260,  1261,  1262,  1263,  1264,  1265,  1266,  1267,  1268,  1269,
+    1270,  1271,  1272,  1273,  1274,  1275,  1276,  1277,  1278,  1279,
+    1280,  1281,  1285,  1286,  1287,  1288,  1289,  1290,  1294,  1295,
+    1296,  1297,  1301,  1302,  1303,  1304,  1309,  1310,  1311,  1312,
+    1313,  1314,  1315
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "TIDENT",
+  "IMAGLITERAL", "INTLITERAL", "REALLITERAL", "STRINGLITERAL",
+  "EXTERNCODE", "TALIGN", "TATOMIC", "TBEGIN", "TBREAK", "TBY", "TCLASS",
+  "TCOBEGIN", "TCOFORALL", "TCONFIG", "TCONST", "TCONTINUE", "TDELETE",
+  "TDMAPPED", "TDO", "TDOMAIN", "TELSE", "TENUM", "TEXPORT", "TEXTERN",
+  "TFOR", "TFORALL", "TIF", "TIN", "TINDEX", "TINLINE", "TINOUT", "TITER",
+  "TLABEL", "TLAMBDA", "TLET", "TLOCAL", "TMINUSMINUS", "TMODULE", "TNEW",
+  "TNIL", "TNOINIT", "TON", "TOTHERWISE", "TOUT", "TPARAM", "TPLUSPLUS",
+  "TPRAGMA", "TPRIMITIVE", "TPROC", "TRECORD", "TREDUCE", "TREF",
+  "TRETURN", "TSCAN", "TSELECT", "TSERIAL", "TSINGLE", "TSPARSE",
+  "TSUBDOMAIN", "TSYNC", "TTHEN", "TTYPE", "TUNDERSCORE", "TUNION", "TUSE",
+  "TVAR", "TWHEN", "TWHERE", "TWHILE", "TWITH", "TYIELD", "TZIP", "TALIAS",
+  "TAND", "TASSIGN", "TASSIGNBAND", "TASSIGNBOR", "TASSIGNBXOR",
+  "TASSIGNDIVIDE", "TASSIGNEXP", "TASSIGNLAND", "TASSIGNLOR",
+  "TASSIGNMINUS", "TASSIGNMOD", "TASSIGNMULTIPLY", "TASSIGNPLUS",
+  "TASSIGNSL", "TASSIGNSR", "TBAND", "TBNOT", "TBOR", "TBXOR", "TCOLON",
+  "TCOMMA", "TDIVIDE", "TDOT", "TDOTDOT", "TDOTDOTDOT", "TEQUAL", "TEXP",
+  "TGREATER", "TGREATEREQUAL", "THASH", "TLESS", "TLESSEQUAL", "TMINUS",
+  "TMOD", "TNOT", "TNOTEQUAL", "TOR", "TPLUS", "TQUESTION", "TSEMI",
+  "TSHIFTLEFT", "TSHIFTRIGHT", "TSTAR", "TSWAP", "TIO", "TLCBR", "TRCBR",
+  "TLP", "TRP", "TLSBR", "TRSBR", "TNOELSE", "TUPLUS", "TUMINUS",
+  "$accept", "program", "toplevel_stmt_ls", "toplevel_stmt", "pragma_ls",
+  "stmt", "module_decl_stmt", "module", "block_stmt", "stmt_ls",
+  "use_stmt", "assignment_stmt", "opt_ident", "ident", "do_stmt",
+  "return_stmt", "class_level_stmt", "extern_block_stmt", "loop_stmt",
+  "zippered_iterator", "if_stmt", "select_stmt", "when_stmt_ls",
+  "when_stmt", "type_select_stmt", "class_decl_stmt", "opt_extern",
+  "class_tag", "opt_inherit", "class_level_stmt_ls", "enum_decl_stmt",
+  "enum_ls", "enum_item", "lambda_decl_expr", "$@1", "$@2", "linkage_spec",
+  "fn_decl_stmt", "$@3", "$@4", "fn_decl_stmt_inner", "fn_ident",
+  "assignop_ident", "opt_formal_ls", "req_formal_ls", "formal_ls",
+  "formal", "opt_intent_tag", "opt_this_intent_tag", "proc_or_iter",
+  "opt_ret_tag", "opt_function_body_stmt", "function_body_stmt",
+  "query_expr", "opt_query_expr", "var_arg_expr", "opt_where_part",
+  "type_alias_decl_stmt", "type_alias_decl_stmt_inner", "opt_init_type",
+  "var_decl_stmt", "opt_config", "var_decl_stmt_inner_ls",
+  "var_decl_stmt_inner", "tuple_var_decl_component",
+  "tuple_var_decl_stmt_inner_ls", "opt_init_expr", "opt_reindex_expr",
+  "opt_type", "array_type", "opt_formal_array_elt_type",
+  "formal_array_type", "opt_formal_type", "expr_ls", "tuple_component",
+  "tuple_expr_ls", "opt_actual_ls", "actual_ls", "actual_expr",
+  "ident_expr", "type_level_expr", "for_expr", "cond_expr", "nil_expr",
+  "stmt_level_expr", "opt_task_intent_ls", "task_intent_clause",
+  "task_intent_ls", "intent_expr", "io_expr", "new_expr", "let_expr",
+  "expr", "lhs_expr", "fun_expr", "call_expr", "dot_expr",
+  "parenthesized_expr", "literal_expr", "assoc_expr_ls", "binary_op_expr",
+  "unary_op_expr", "reduce_expr", "scan_expr", "reduce_scan_op_expr", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-688)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-376)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
+{
+    -688,    73,  2261,  -688,  -688,  -688,  -688,  -688,  -688,  -688,
+    3303,    11,   128,    11,  5957,    40,   128,  5957,  3303,   150,
+     128,   128,   480,  4999,  5957,  5957,   155,  -688,   128,  -688,
+       9,  3303,  5957,  -688,  5957,  -688,  5957,  5957,   273,   159,
+    5177,  5957,  5301,  5957,   245,   191,  3303,    64,  5379,  5957,
+    5957,  -688,  -688,  5957,  -688,  -688,  1241,  5957,  5957,  -688,
+    5957,  -688,  -688,  2559,  4799,  5379,  -688,  3179,  -688,  -688,
+     128,  -688,  -688,  -688,  -688,  -688,  -688,  -688,  -688,  -688,
+    -688,  -688,  -688,   103,  -688,   247,    50,  -688,  -688,  -688,
+     354,   197,  -688,  -688,  -688,   206,   223,   221,   227,   231,
+   10601,  1982,    80,   232,   243,  -688,  -688,  -688,  -688,  -688,
+    -688,   107,  -688, 10601,   240,  3303,  -688,   251,  -688,   248,
+    5957,  5957,  5957,  5957,  5957,  5379,  5379,   260,  -688,  -688,
+    -688,  -688,  8159,   268,  -688,  -688,   128,   265,  8357,   315,
+    5379,   271,  -688,  -688,   128,  -688,   128,   275,     1,  7133,
+    7099,  7301,  5379,  3303,   276,     8,   365,    48,  -688,  -688,
+     625,   304,  7367,   625,  -688,  5379,  -688,  8423,  8027,  3303,
+    -688,  -688,  7367, 10601,   280,  5379,  -688, 10601,  5379,   327,
+     290,   128,  -688,   162, 10601,  7367,  8489,   242,  1867,   625,
+     242,   625,  -688,  -688,  2683,   -81,  -688,  5957,  -688,    66,
+      77, 10601,   229,  8555,   -28,   400,  -688,   288,  -688,  -688,
+    -688,   128,  -688,  -688,  -688,    34,     9,     9,     9,  -688,
+    5957,  5957,  5957,  5957,  5479,  5479,  5957,  5957,  5957,  5957,
+    5957,  5957,    69,  1241,  5957,  5957,  5957,  5957,  5957,  5957,
+    5957,  5957,  5957,  5957,  5957,  5957,  5957,  5957,  5957,  5957,
+    5957,  5957,  5957,  5957,  5957,  5957,  5957,  5957,  5957,  5957,
+    5957,  5957,  5957,  5957,  5379,  5379,  5479,  5479,   574,  -688,
+    -688,  2807,  -688,  8225,  8291,  8621,    62,  5479,     1,   303,
+    -688,  -688,  5957,   102,  -688,   295,   332,  -688, 10601,   128,
+     314,   402,  5379,  -688,  3427,  5479,  -688,  3551,  5479,  -688,
+       1,  3303,   407,   310,  -688,   343,  -688,  -688,     8,  -688,
+     339,   321,  -688,  4543,   363,   362,  5957,     9,  -688,   323,
+    -688,  -688,  -688,  -688,  5379,   324,   176,  4621,   350,  -688,
+    -688,  5379,  -688,  -688,  -688,  -688,  -688,  -688,  6997,  4899,
+    -688,  5077,  -688,  5479,  2435,   325,  5957,  5957,  -688,  -688,
+    2931,   357,    -3,     9,   174,   179,   211,   214,  8093,   752,
+     752,   279,  -688,   279,  -688,   279,  2311,  1323,   938,  1043,
+     304,   242,  -688,  -688,  -688,  1867,  1483,   279,  1671,  1671,
+     752,  1671,  1671,  1921,   242,  1483,  1643,  1921,   625,   625,
+     242,  8687,  8753,  8819,  8885,  8951,  9017,  9083,  9149,  9215,
+    9281,  9347,  9413,  9479,  9545,  9611,   329,   330,  -688,   279,
+    -688,   279,   131,  -688,  -688,  -688,  -688,  -688,  -688,   128,
+      82,  -688,  6035,  5479,  6113,  5479,  5957,  5479,    58,    11,
+    9677,  -688,  -688,  9743,  5957,  5379,  -688,  5379,   372,   189,
+    -688,  -688,  5957,    84,  5957, 10601,    27,  7433,  5957, 10601,
+      54,  7235,  -688,   432,  9809,  3303,  -688,   172,  -688,    22,
+      88,   335,     8,   348,  -688,  5379,  -688,   441,  5957,  5579,
+    -688, 10601,  -688,  -688,   -26,   340,  -688,  -688,  5379,  -688,
+     219,   128,  -688, 10601,  -688,  -688,  -688,  -688,   -52,  6827,
+    -688, 10601,  3303, 10601,  9875,  -688,  3055,  5379,   344,  -688,
+    -688,  -688,  6714,   228,  -688,  -688,  -688,  -688,  -688,  -688,
+    -688,  -688,  -688,  -688,  -688,  -688,  -688,  -688,  -688,  -688,
+    -688,  -688,  -688,  -688,  -688,  -688,  -688,  -688,   574,  -688,
+    5957,   456,  9941,  5957,   458, 10007,   355,  1795,     1,     1,
+    -688, 10601,  -688, 10601,  -688,  5957,   128,  -688,  7367,  -688,
+    7499,  3675,  -688,  3799,  -688,  7565,  3923,  -688,     1,  4047,
+    -688,     1,  3303,  5957,  -688,   574,  -688,     8,   388,  -688,
+    -688,  -688,  -688,    79,  -688,  -688,  4621,   362,    95, 10601,
+    -688, 10601,  3303,  5379,  -688,  -688,  -688,    24,   165,  -688,
+    4171,   358,  4295,   366,  -688,  5957,  -688,   392,  -688,    88,
+    -688,  -688,  -688,  -688,  -688,  -688,  -688,  -688,  -688,  -688,
+    -688,  -688,  -688,  -688,  -688,   128,  -688,  -688,  -688,  -688,
+    -688,  -688,  -688,  -688,  -688,  -688,  -688,  -688,  -688,  -688,
+    -688,  -688,  -688,  -688,  -688,  -688,   397,   374,   374,  -688,
+    -688, 10073,  6191,  6269, 10139,  6347,  6425,  6503,  6581,  -688,
+    -688, 10601,  -688,  -688,  3303,  5957, 10601,  5957, 10601,  3303,
+    5957, 10601,  -688,  5957, 10601,  -688,  -688, 10601,  -688,   377,
+    5657,    47,   428,  -688,  5479,  2115,  -688,     7,  -688,  4419,
+    5957,  -688, 10601,  3303,  5957,  -688, 10601,  3303, 10601,   915,
+      81,  -688,  6714,   343,  -688,  -688,  5957,  5957,  5957,  5957,
+    5957,  5957,  5957,  5957,  9809,  7631,  7697,  9809,  7763,  7829,
+     388,   150,  5957,  5957,  4699,  -688,  -688,   180,  5379,  -688,
+    -688,  5957,    35,  6861,  -688,   649,  -688,  7895,  -688,  7961,
+    -688,   534,   128,  -688,  1171,  -688,   428,  -688,   374,   374,
+     178, 10205, 10271, 10337, 10403, 10469, 10535,  3303,  3303,  3303,
+    3303,    47,  5757,   167,  -688,  -688, 10601, 10601,  -688,  -688,
+    -688,  6581,  3303,  3303,  -688,    83,  -688,  -688,  -688,  5957,
+    5957,  5957,  5957,  5957,  5957,  9809,  9809,  9809,  9809,  -688,
+    -688,  -688,  -688,  -688,   192,  5479,  6659,   874,  9809,  9809,
+    -688,  -688,  -688,  6963,  -688,  -688,  5857,  -688
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int16 yydefact[] =
+{
+       3,     0,     0,     1,    34,    60,   372,   370,   371,   373,
+       0,   331,    58,   331,     0,   232,    58,     0,     0,     0,
+       0,   127,   233,     0,     0,     0,     0,   126,     0,   122,
+       0,     0,     0,    37,     0,   322,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,   418,   420,     0,   421,   422,   354,     0,     0,   419,
+     416,    65,   417,     0,     0,     0,     4,     0,     5,     9,
+       0,    10,    11,    13,   291,    19,    12,    14,    16,    15,
+      17,    18,    67,     0,    68,   346,     0,    66,    69,    70,
+       0,   355,   342,   343,   294,   292,     0,     0,   347,   348,
+       0,   293,     0,   356,   357,   358,   341,   296,   295,   344,
+     345,     0,    21,   302,     0,     0,   332,     0,    59,     0,
+       0,     0,     0,     0,     0,     0,     0,   346,   355,   292,
+     347,   348,   331,   293,   356,   357,     0,     0,     0,     0,
+     282,     0,   128,    71,     0,   130,     0,     0,     0,     0,
+       0,     0,   282,     0,     0,     0,     0,     0,   234,    28,
+     404,   339,     0,   405,     7,   282,    63,     0,     0,     0,
+      62,    31,     0,   297,     0,   282,    32,   303,     0,   223,
+       0,   211,   274,     0,   273,     0,     0,   407,   353,   403,
+     406,   402,    38,    40,     0,     0,   277,     0,   279,     0,
+       0,   278,     0,   273,     0,     0,     6,     0,   108,   109,
+     110,     0,   200,   199,   131,     0,     0,     0,     0,    20,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,   352,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   282,   282,     0,     0,   186,    22,
+      23,     0,    24,     0,     0,     0,     0,     0,     0,     0,
+      25,    26,     0,   291,   289,     0,   283,   284,   290,     0,
+       0,     0,     0,    80,     0,     0,    79,     0,     0,    86,
+       0,     0,    96,     0,    27,   179,   123,   239,     0,   240,
+     242,     0,   253,     0,     0,   245,     0,     0,    29,     0,
+      64,   100,    61,    30,   282,     0,     0,     0,   221,   218,
+     210,     0,    42,    73,    33,    39,    41,   374,     0,     0,
+     367,     0,   369,     0,     0,     0,     0,     0,   376,     8,
+       0,   111,   196,     0,     0,     0,     0,     0,   330,   399,
+     398,   401,   409,   408,   413,   412,   395,   392,   393,   394,
+     350,   382,   366,   365,   364,   351,   386,   397,   391,   389,
+     400,   390,   388,   380,   385,   387,   396,   379,   383,   384,
+     381,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   411,   410,
+     415,   414,   190,   187,   188,   189,   193,   194,   195,     0,
+       0,   334,     0,     0,     0,     0,     0,     0,   375,   331,
+     331,    76,   219,     0,     0,     0,   299,     0,   120,     0,
+     117,   220,     0,     0,     0,   306,     0,     0,     0,   312,
+       0,     0,    87,    95,     0,     0,   298,     0,   180,     0,
+     201,     0,   243,     0,   257,     0,   252,   342,     0,     0,
+     236,   340,   235,   363,     0,     0,   300,   100,     0,   225,
+     342,     0,   276,   275,   349,   368,   280,   281,     0,     0,
+      92,   316,     0,   377,     0,    35,     0,     0,     0,   197,
+     198,   132,     0,     0,   227,   226,   228,   230,    43,    50,
+      51,    52,    47,    49,    56,    57,    45,    48,    46,    44,
+      54,    53,    55,   361,   362,   191,   192,   336,   186,   333,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+      72,   288,   286,   287,   285,     0,   118,   116,     0,    94,
+       0,     0,    78,     0,    77,     0,     0,    84,     0,     0,
+      82,     0,     0,     0,    98,   186,   178,     0,   266,   202,
+     204,   203,   205,     0,   241,   244,     0,   245,     0,   237,
+     246,   247,     0,     0,    99,   101,   301,     0,     0,   222,
+       0,     0,     0,     0,    93,     0,    36,   112,   113,   201,
+     161,   159,   164,   171,   172,   173,   168,   170,   166,   169,
+     167,   165,   175,   174,   140,   143,   141,   142,   153,   144,
+     157,   149,   147,   160,   148,   146,   151,   156,   158,   145,
+     150,   154,   155,   152,   162,   163,   138,   176,   176,   229,
+     335,     0,     0,     0,     0,     0,     0,     0,     0,    75,
+      74,   121,   119,    81,     0,     0,   305,     0,   304,     0,
+       0,   311,    85,     0,   310,    83,    97,   321,   181,     0,
+       0,   245,   216,   238,     0,     0,   103,     0,   104,     0,
+       0,    90,   318,     0,     0,    88,   317,     0,   378,   231,
+       0,   139,     0,   179,   134,   135,     0,     0,     0,     0,
+       0,     0,     0,     0,   309,     0,     0,   315,     0,     0,
+     266,   269,   270,   271,     0,   268,   272,   342,   212,   183,
+     182,     0,     0,     0,   255,   342,   102,     0,    91,     0,
+      89,   233,     0,   105,   231,   114,   216,   138,   176,   176,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,   245,   258,     0,   213,   215,   214,   217,   208,   209,
+     124,     0,     0,     0,   115,     0,   136,   137,   177,     0,
+       0,     0,     0,     0,     0,   308,   307,   314,   313,   185,
+     184,   260,   261,   263,   342,     0,   375,   342,   320,   319,
+     206,   133,   207,     0,   262,   264,   258,   265
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int16 yypgoto[] =
+{
+    -688,  -688,  -688,    -1,  -186,   461,  -688,  -688,  1007,   154,
+    -688,  -688,   489,  1793,    23,  -687,  -606,  -688,  -688,    85,
+    -688,  -688,    29,  -688,  -688,  -688,  -688,  -688,  -688,  -688,
+    -688,  -688,   -35,   548,  -688,  -688,  -688,  -688,  -688,  -688,
+    -688,  -179,  -178,  -572,  -688,  -176,   -47,  -260,  -688,  -688,
+     -78,  -688,  -243,   236,  -688,  -226,  -210,  -688,  -126,  -688,
+    -688,  -688,  -159,   210,  -688,  -302,  -568,  -688,  -429,  -325,
+    -468,  -598,  -181,    12,    56,  -688,  -124,  -688,    93,   322,
+    -310,  -688,  -688,   764,  -688,    -8,  -131,  -688,     3,  -688,
+     822,   893,   -10,  1119,  -688,  1364,  1497,  -688,  -688,  -688,
+    -688,  -688,  -688,  -688,  -688
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int16 yydefgoto[] =
+{
+       0,     1,     2,   193,    67,   453,    69,    70,    71,   194,
+      72,    73,   117,    74,   171,    75,    76,    77,    78,   536,
+      79,    80,   474,   585,    81,    82,    83,   211,   498,   689,
+      84,   439,   440,   127,   154,   460,    86,    87,   352,   599,
+     501,   637,   638,   694,   306,   457,   458,   459,   502,   214,
+     573,   791,   760,   182,   755,   719,   722,    88,   180,   328,
+      89,    90,   157,   158,   310,   311,   470,   314,   315,   466,
+     782,   716,   671,   195,   199,   200,   285,   286,   287,   128,
+      92,    93,    94,   129,    96,   115,   116,   420,   421,    97,
+     130,   131,   100,   133,   102,   134,   135,   105,   106,   204,
+     107,   108,   109,   110,   111
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int16 yytable[] =
+{
+     113,    66,   479,   467,   132,   119,   461,   138,   419,   673,
+     279,     5,     5,   149,   150,   151,   331,   480,   290,   300,
+     582,   114,   160,   169,   161,     5,   162,   163,   303,   169,
+     167,   168,   172,   173,   577,   759,   177,     5,   184,   185,
+     186,   319,   337,   187,   583,   499,   188,   189,   190,   551,
+     191,   325,   500,   184,   201,   203,   354,   355,   356,   357,
+     183,     5,     6,     7,     8,     9,   695,     5,   120,   347,
+     582,   345,     5,     3,   307,   590,   556,   202,   759,   316,
+     312,    19,   312,   735,   114,   212,   121,   122,   123,   353,
+      26,    40,   372,   427,   583,    29,    30,   584,    32,   348,
+      34,    35,   213,   720,   331,   136,   569,    37,   148,    39,
+     113,   273,   274,   275,   177,   184,   203,   208,    43,    44,
+      45,   124,   178,   271,   278,   469,   674,   114,   764,   271,
+     288,     5,   308,   155,   373,  -250,   570,  -250,   276,    40,
+     406,   407,   288,   571,   672,   317,   567,   678,   718,   271,
+    -250,    53,  -250,   572,   783,   288,   209,   271,   155,   331,
+     575,   266,   525,   339,   267,   288,   766,   767,   184,    58,
+     210,   293,   296,   299,   341,   576,   271,   576,   434,   528,
+     435,   331,    64,   780,   126,   318,   526,   338,   795,   428,
+     326,   340,   331,   336,   503,   323,   674,  -250,   785,   790,
+     475,  -250,   342,  -250,   264,   271,   265,   529,   333,   549,
+     358,   359,   360,   361,   363,   365,   366,   367,   368,   369,
+     370,   371,   675,   375,   376,   377,   378,   379,   380,   381,
+     382,   383,   384,   385,   386,   387,   388,   389,   390,   391,
+     392,   393,   394,   395,   396,   397,   398,   399,   400,   401,
+     402,   403,   404,   405,   288,   288,   409,   411,  -267,   331,
+     343,   736,   331,   223,   331,   669,   467,   430,   419,   565,
+    -259,   317,   433,   331,   140,   565,   317,  -267,   332,   152,
+     164,  -267,   184,   165,   445,   447,   546,   449,   451,  -259,
+     504,   454,   679,  -259,   786,   505,   224,   566,   477,   225,
+     198,   431,   114,   768,   443,  -267,   471,   174,   317,   362,
+     364,   317,   547,  -324,   288,   175,  -224,  -259,   794,   558,
+     561,   483,  -323,   452,    91,   317,   331,   506,   797,   201,
+     507,   201,    91,   489,   491,  -224,   493,   494,   230,   219,
+      91,   232,   220,  -328,   639,   235,  -186,  -329,  -326,   312,
+     724,   408,   410,    91,   724,   589,   344,   591,   593,  -325,
+     717,   412,   429,  -327,   268,   725,   312,   270,    91,   725,
+     271,  -360,   215,  -360,   413,   230,   284,   414,   232,  -250,
+     446,   280,   235,   450,  -360,    91,  -360,   282,   284,    91,
+     415,   416,  -359,   289,  -359,   486,  -250,   487,   417,   292,
+     305,   284,   216,   232,   324,   327,   329,   349,   418,   217,
+     350,   284,   445,   532,   449,   535,   454,   537,   491,   432,
+     436,   538,   539,   218,   541,   543,  -250,   288,   488,   437,
+     441,   455,   548,   442,   550,   456,   462,    91,   555,   468,
+     469,  -248,   784,  -250,   576,  -250,   463,   481,   473,   476,
+     545,   787,   492,   497,   523,   203,   562,   524,   579,   581,
+     574,   313,  -250,    68,  -250,   586,   598,  -186,   203,   552,
+     554,   112,  -251,   557,   560,    91,   784,   578,   642,   139,
+     645,  -250,   647,     5,   670,   683,   784,   184,   143,   331,
+     588,    91,   159,   687,  -107,   336,   692,  -251,   693,   721,
+     284,   284,   710,   734,   496,   137,   587,   176,   531,   597,
+     534,   652,  -251,   738,   739,  -129,    91,   740,   668,  -251,
+     641,   690,   792,   644,    68,   779,   765,   472,   206,   751,
+     544,   640,  -129,  -107,     0,   651,     0,     5,  -251,     0,
+       0,   656,     0,   658,     0,   144,   661,  -107,  -107,   664,
+      85,     0,     0,   667,     0,     0,     0,  -251,    85,     0,
+     284,   649,   650,  -251,     0,     0,    85,   482,     0,  -129,
+       0,   653,     0,   184,     0,   198,   269,   198,     0,    85,
+     682,   662,   686,     0,   665,   688,  -129,  -107,     0,     0,
+       0,     0,   412,    91,    85,   677,     0,     0,     0,   144,
+       0,  -107,     0,     0,     0,   413,     0,     0,   414,     0,
+       0,    85,     0,     0,   304,    85,    91,     0,     0,    91,
+       0,   415,   416,    91,     0,     0,     0,     0,     0,   417,
+     322,     0,   656,   658,     0,   661,   664,   682,   686,   418,
+       0,     0,     0,     0,   704,   705,   223,   706,     0,   707,
+     708,     0,     0,   709,     0,    68,     0,     0,     0,     0,
+       0,     0,     0,    85,   723,   491,    91,     0,     0,   491,
+     727,   542,    91,   284,   729,     0,     0,     0,     0,   224,
+    -254,     0,   225,     0,     0,     0,   704,   741,   742,   707,
+     743,   744,   745,   746,     0,     0,     0,     0,     0,     0,
+     726,    85,   173,   177,   203,  -254,     0,     0,   756,     0,
+       0,   757,     0,     0,     0,     0,     0,    85,     0,     0,
+    -254,   230,     0,   231,   232,     0,   753,  -254,   235,     0,
+       0,     0,    68,     0,     0,   242,     0,   775,   776,   777,
+     778,   527,    85,     0,   248,     0,  -254,     0,     0,     0,
+       0,   686,   788,   789,     0,   322,     0,     0,   322,   775,
+     776,   777,   778,   788,   789,  -254,    95,     0,     0,     0,
+       0,  -254,     0,   223,    95,   793,   491,    91,     0,     0,
+       0,     0,    95,     0,     0,     0,   686,     0,     0,     0,
+       0,     0,     0,     0,     0,    95,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,   490,   224,     0,     0,   225,
+      95,    68,     0,     0,    91,     0,     0,     0,    91,    85,
+       0,     0,     0,     0,    98,     0,     0,    95,     0,   226,
+       0,    95,    98,     0,     0,     0,     0,     0,     0,     0,
+      98,     0,    85,     0,   227,    85,   228,   229,   230,    85,
+     231,   232,   233,    98,   234,   235,   236,   237,     0,   239,
+     240,   241,   242,     0,   243,   244,   245,     0,    98,   246,
+     247,   248,     0,    91,     0,    91,     0,     0,    91,    95,
+       0,    91,     0,     0,    91,    98,     0,     0,     0,    98,
+       0,     0,    85,     0,     0,    99,     0,     0,    85,     0,
+       0,     0,     0,    99,    91,  -256,   715,     0,     0,     0,
+       0,    99,    91,     0,    91,     0,   564,    95,     0,     0,
+       0,     0,     0,     0,    99,     0,     0,     0,     0,  -106,
+    -256,     0,    15,    95,     0,     0,     0,    98,     0,    99,
+      20,    21,   731,     0,     0,  -256,     0,     0,    27,     0,
+    -125,     0,  -256,   594,   754,     0,    99,    68,    95,   223,
+      99,     0,     0,     0,     0,    38,     0,  -125,  -106,     0,
+       0,  -256,     0,     0,     0,    98,    91,     0,     0,     0,
+     732,    91,  -106,     0,     0,     0,     0,     0,   781,     0,
+    -256,    98,   224,     0,     0,   225,  -256,     0,     0,     0,
+       0,     0,     0,    85,     0,    91,     0,     0,    99,    91,
+       0,     0,   322,     0,   322,     0,    98,   322,     0,     0,
+     322,     0,   781,   666,     0,     0,     0,     0,     0,     0,
+     227,    61,   781,   229,   230,    95,   231,   232,   733,     0,
+      85,   235,     0,   676,    85,     0,    99,     0,   242,   170,
+       0,   681,     0,   685,     0,   246,   247,   248,    95,     0,
+       0,    95,    99,     0,   223,    95,     0,     0,     0,    91,
+      91,    91,    91,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    91,    91,     0,    99,     0,     0,
+       0,     0,     0,    98,     0,     0,     0,   224,     0,    85,
+     225,    85,     0,     0,    85,     0,     0,    85,    95,     0,
+      85,     0,     0,     0,    95,     0,    98,     0,     0,    98,
+       0,   101,     0,    98,     0,     0,   272,     0,     0,   101,
+      85,     0,     0,     0,     0,   227,     0,   101,    85,   230,
+      85,   231,   232,     0,   728,     0,   235,     0,   730,     0,
+     101,     0,     0,   242,     0,   170,   170,   170,   302,     0,
+     246,   247,   248,     0,    99,   101,    98,     0,     0,   170,
+       0,     0,    98,     0,     0,     0,     0,     0,     0,   170,
+       0,     0,   101,     0,     0,  -106,   101,    99,    15,     0,
+      99,     0,   170,     0,    99,     0,    20,    21,   731,     0,
+       0,     0,    85,     0,    27,     0,  -125,    85,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    95,
+       0,   205,     0,  -125,  -106,     0,     0,     0,     0,     0,
+       0,    85,     0,     0,   101,    85,   732,    99,  -106,     0,
+       0,     0,     0,    99,     5,     6,     7,     8,     9,     0,
+       0,   120,     0,     0,     0,     0,    95,     0,     0,     0,
+      95,     0,     0,     0,    19,     0,     0,     0,     0,   121,
+     122,   123,   101,    26,     0,     0,     0,    98,    29,    30,
+       0,    32,     0,    34,    35,   170,     0,    61,   101,     0,
+      37,     0,    39,     0,     0,    85,    85,    85,    85,     0,
+       0,    43,    44,    45,   124,     0,     0,   170,     0,     0,
+      85,    85,     0,   101,    98,    95,     0,    95,    98,     0,
+      95,     0,     0,    95,     0,     0,    95,     0,     0,     0,
+       0,     0,     0,    52,    53,    54,    55,     0,     0,     0,
+       0,     0,     0,     0,   223,     0,    95,     0,    99,     0,
+      57,     0,    58,     0,    95,    60,    95,     0,     0,     0,
+      62,     0,     0,   125,     0,    64,   103,   126,     0,     0,
+       0,     0,     0,    98,   103,    98,     0,   224,    98,     0,
+     225,    98,   103,     0,    98,    99,     0,     0,     0,    99,
+     101,     0,     0,     0,     0,   103,     0,     0,     0,     0,
+       0,     0,     0,     0,    98,     0,     0,     0,     0,     0,
+     103,     0,    98,   101,    98,     0,   101,     0,    95,   230,
+     101,   231,   232,    95,     0,     0,   235,   103,     0,     0,
+       0,   103,     0,   242,     0,     0,     0,     0,     0,     0,
+     246,   247,   248,     0,    99,     0,    99,    95,     0,    99,
+       0,    95,    99,   170,   170,    99,     0,   170,   170,     0,
+       0,     0,     0,   101,     0,     0,     0,     0,     0,   101,
+       0,     0,     0,     0,     0,    99,    98,     0,     0,   103,
+       0,    98,     0,    99,     0,    99,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,   104,
+       0,     0,     0,     0,   223,    98,     0,   104,     0,    98,
+       0,    95,    95,    95,    95,   104,     0,   103,     0,     0,
+       0,     0,     0,     0,     0,     0,    95,    95,   104,     0,
+       0,     0,     0,   103,     0,     0,     0,   224,     0,     0,
+     225,     0,     0,   104,     0,   170,   170,    99,     0,     0,
+       0,     0,    99,     0,     0,   170,     0,   302,   103,     0,
+     104,     0,   302,     0,   104,   170,     0,     0,   170,    98,
+      98,    98,    98,     0,   101,   227,    99,   228,   229,   230,
+      99,   231,   232,   233,    98,    98,   235,   236,   237,     0,
+     239,   240,   241,   242,     0,     0,     0,   245,     0,     0,
+     246,   247,   248,     0,     0,     0,     0,     0,     0,     0,
+       0,   101,   104,     0,     0,   101,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,   103,     0,     0,     0,     0,
+      99,    99,    99,    99,     0,     0,     0,     0,     0,     0,
+     104,     0,     0,     0,     0,    99,    99,     0,   103,     0,
+       0,   103,     0,     0,   223,   103,   104,     0,     0,     0,
+     101,     0,   101,     0,     0,   101,     0,     0,   101,     0,
+       0,   101,     0,     0,   170,     0,     0,     0,     0,     0,
+       0,   104,   223,     0,     0,     0,     0,   224,     0,     0,
+     225,   101,     0,     0,     0,     0,     0,     0,   103,   101,
+       0,   101,   302,   302,   103,   302,   302,     0,     0,     0,
+     226,     0,     0,     0,     0,   224,     0,     0,   225,   758,
+       0,     0,     0,     0,   302,   227,   302,   228,   229,   230,
+       0,   231,   232,   233,     0,   234,   235,   236,   237,     0,
+     239,   240,   241,   242,     0,   243,     0,   245,     0,     0,
+     246,   247,   248,   227,     0,   228,   229,   230,   104,   231,
+     232,   233,   758,   101,   235,     0,     0,     0,   101,     0,
+     241,   242,     0,     0,     0,   245,     0,     0,   246,   247,
+     248,   104,     0,     0,   104,     0,     0,     0,   104,     0,
+       0,     0,   101,     0,   221,   118,   101,     0,   222,   118,
+       0,     0,     0,   141,   142,   145,   223,     0,     0,   103,
+       0,   153,     0,   156,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     179,   104,     0,     0,     0,     0,     0,   104,     0,   224,
+       0,     0,   225,     0,     0,     0,   103,     0,     0,     0,
+     103,     0,     0,   207,     0,     0,   101,   101,   101,   101,
+       0,     0,   226,     0,     0,     0,     0,     0,     0,     0,
+       0,   101,   101,     0,     0,     0,     0,   227,   223,   228,
+     229,   230,     0,   231,   232,   233,     0,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,     0,   243,   244,   245,
+       0,     0,   246,   247,   248,   103,     0,   103,     0,     0,
+     103,   224,   648,   103,   225,     0,   103,     0,     0,   179,
+       0,     0,     0,   283,     0,     0,     0,   179,     0,   291,
+       0,     0,   223,     0,     0,   283,   103,     0,   309,     0,
+       0,     0,   104,     0,   103,     0,   103,     0,   283,   227,
+       0,   228,   229,   230,     0,   231,   232,     0,   283,     0,
+     235,     0,     0,     0,   330,   224,   241,   242,   225,     0,
+       0,   245,     0,     0,   246,   247,   248,     0,     0,   104,
+       0,     0,     0,   104,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   351,     0,     0,     0,   156,   156,
+     156,   156,     0,   227,     0,   228,   229,   230,   103,   231,
+     232,     0,     0,   103,   235,   374,     0,     0,     0,     0,
+       0,   242,     0,     0,     0,     0,     0,     0,   246,   247,
+     248,     0,     0,     0,     0,     0,     0,   103,   104,     0,
+     104,   103,     0,   104,     0,     0,   104,   283,   283,   104,
+     249,   250,   251,   252,   253,   254,   255,   256,   257,   258,
+     259,   260,   261,   262,     0,     0,     0,     0,     0,   104,
+       0,     0,   438,     0,     0,     0,     0,   104,     0,   104,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,   309,   263,  -337,     0,     0,  -359,     0,  -359,     0,
+     156,   103,   103,   103,   103,     0,   464,   283,     5,     6,
+       7,     8,     9,     0,  -375,   120,   103,   103,  -375,     0,
+       0,     0,     0,     0,     0,     0,  -375,     0,    19,     0,
+       0,     0,     0,   121,   122,   123,   156,    26,     0,     0,
+       0,   104,    29,    30,     0,    32,   104,    34,    35,     0,
+       0,     0,     0,     0,    37,     0,    39,     0,     0,  -375,
+       0,     0,  -375,     0,     0,    43,    44,    45,   124,     0,
+     104,     0,     0,     0,   104,     0,     0,     0,     0,     0,
+       0,  -249,  -375,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,  -375,    53,  -375,
+    -375,  -375,     0,  -375,  -375,  -375,     0,  -375,  -375,  -375,
+    -375,  -375,  -375,  -375,  -375,  -375,    58,  -375,  -375,  -375,
+     283,     0,  -375,  -375,  -375,     0,     0,   125,     0,    64,
+       0,   478,     0,     0,   104,   104,   104,   104,     0,     0,
+       0,     0,   568,     0,     0,   309,     0,     0,     0,   104,
+     104,    -2,     4,     0,     5,     6,     7,     8,     9,     0,
+       0,    10,    11,    12,   179,  -106,    13,    14,    15,  -231,
+      16,    17,     0,    18,    19,     0,    20,    21,    22,    23,
+      24,    25,     0,    26,    27,   636,  -125,    28,    29,    30,
+      31,    32,    33,    34,    35,     0,    36,     0,     0,  -231,
+      37,    38,    39,  -125,  -106,     0,  -231,    40,     0,    41,
+      42,    43,    44,    45,    46,     0,    47,     0,  -106,    48,
+    -231,     0,   223,    49,     0,    50,     0,     0,    51,   438,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,    52,    53,    54,    55,     0,     0,     0,
+     309,    56,     0,     0,     0,   224,     0,     0,   225,     0,
+      57,     0,    58,     0,    59,    60,     0,    61,     0,     0,
+      62,     0,     0,    63,     0,    64,     0,    65,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,   227,     0,   228,   229,   230,   691,   231,
+     232,   233,     0,   234,   235,   236,   237,     0,   239,   240,
+     241,   242,     0,   243,     0,   245,     0,     0,   246,   247,
+     248,     0,     0,     0,     0,     0,     4,     0,     5,     6,
+       7,     8,     9,     0,  -375,    10,    11,    12,  -375,  -106,
+      13,    14,    15,  -231,    16,    17,  -375,    18,    19,  -375,
+      20,    21,    22,    23,    24,    25,     0,    26,    27,     0,
+    -125,    28,    29,    30,    31,    32,    33,    34,    35,     0,
+      36,     0,     0,  -231,    37,   737,    39,  -125,  -106,  -375,
+    -231,    40,  -375,    41,    42,    43,    44,    45,    46,     0,
+      47,     0,  -106,    48,  -231,     0,     0,    49,     0,    50,
+       0,     0,  -375,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   145,   179,     0,  -375,    53,  -375,
+    -375,  -375,  -375,  -375,  -375,  -375,     0,  -375,  -375,  -375,
+    -375,  -375,  -375,  -375,  -375,  -375,    58,  -375,  -375,  -375,
+       0,    61,  -375,  -375,  -375,     0,     0,    63,  -375,    64,
+       4,    65,     5,     6,     7,     8,     9,     0,     0,    10,
+      11,    12,     0,  -106,    13,    14,    15,  -231,    16,    17,
+       0,    18,    19,     0,    20,    21,    22,    23,    24,    25,
+       0,    26,    27,     0,  -125,    28,    29,    30,    31,    32,
+      33,    34,    35,     0,    36,     0,     0,  -231,    37,    38,
+      39,  -125,  -106,     0,  -231,    40,     0,    41,    42,    43,
+      44,    45,    46,     0,    47,     0,  -106,    48,  -231,     0,
+       0,    49,     0,    50,     0,     0,    51,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,    52,    53,    54,    55,     0,     0,     0,     0,    56,
+       0,     0,     0,     0,     0,     0,     0,     0,    57,     0,
+      58,     0,    59,    60,   181,    61,     0,     0,    62,     0,
+       0,    63,   192,    64,     4,    65,     5,     6,     7,     8,
+       9,     0,     0,    10,    11,    12,     0,  -106,    13,    14,
+      15,  -231,    16,    17,     0,    18,    19,     0,    20,    21,
+      22,    23,    24,    25,     0,    26,    27,     0,  -125,    28,
+      29,    30,    31,    32,    33,    34,    35,     0,    36,     0,
+       0,  -231,    37,    38,    39,  -125,  -106,     0,  -231,    40,
+       0,    41,    42,    43,    44,    45,    46,     0,    47,     0,
+    -106,    48,  -231,     0,     0,    49,     0,    50,     0,     0,
+      51,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,    52,    53,    54,    55,     0,
+       0,     0,     0,    56,     0,     0,     0,     0,     0,     0,
+       0,     0,    57,     0,    58,     0,    59,    60,     0,    61,
+       0,     0,    62,     0,     0,    63,   335,    64,     4,    65,
+       5,     6,     7,     8,     9,     0,     0,    10,    11,    12,
+       0,  -106,    13,    14,    15,  -231,    16,    17,     0,    18,
+      19,     0,    20,    21,    22,    23,    24,    25,     0,    26,
+      27,     0,  -125,    28,    29,    30,    31,    32,    33,    34,
+      35,     0,    36,     0,     0,  -231,    37,    38,    39,  -125,
+    -106,     0,  -231,    40,     0,    41,    42,    43,    44,    45,
+      46,     0,    47,     0,  -106,    48,  -231,     0,     0,    49,
+       0,    50,     0,     0,    51,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    52,
+      53,    54,    55,     0,     0,     0,     0,    56,     0,     0,
+       0,     0,     0,     0,     0,     0,    57,     0,    58,     0,
+      59,    60,     0,    61,     0,     0,    62,     0,     0,    63,
+     192,    64,     4,    65,     5,     6,     7,     8,     9,     0,
+       0,    10,    11,    12,     0,  -106,    13,    14,    15,  -231,
+      16,    17,     0,    18,    19,     0,    20,    21,    22,    23,
+      24,    25,     0,    26,    27,     0,  -125,    28,    29,    30,
+      31,    32,    33,    34,    35,     0,    36,     0,     0,  -231,
+      37,    38,    39,  -125,  -106,     0,  -231,    40,     0,    41,
+      42,    43,    44,    45,    46,     0,    47,     0,  -106,    48,
+    -231,     0,     0,    49,     0,    50,     0,     0,    51,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,    52,    53,    54,    55,     0,     0,     0,
+       0,    56,     0,     0,     0,     0,     0,     0,     0,     0,
+      57,     0,    58,     0,    59,    60,     0,    61,     0,     0,
+      62,     0,     0,    63,   495,    64,     4,    65,     5,     6,
+       7,     8,     9,     0,     0,    10,    11,    12,     0,  -106,
+      13,    14,    15,  -231,    16,    17,     0,    18,    19,     0,
+      20,    21,    22,    23,    24,    25,     0,    26,    27,     0,
+    -125,    28,    29,    30,    31,    32,    33,    34,    35,     0,
+      36,     0,     0,  -231,    37,    38,    39,  -125,  -106,     0,
+    -231,    40,     0,    41,    42,    43,    44,    45,    46,     0,
+      47,     0,  -106,    48,  -231,     0,     0,    49,     0,    50,
+       0,     0,    51,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,    52,    53,    54,
+      55,     0,     0,     0,     0,    56,     0,     0,     0,     0,
+       0,     0,     0,     0,    57,     0,    58,     0,    59,    60,
+       0,    61,     0,     0,    62,     0,     0,    63,   596,    64,
+       4,    65,     5,     6,     7,     8,     9,     0,     0,    10,
+      11,    12,     0,  -106,    13,    14,    15,  -231,    16,    17,
+       0,    18,    19,     0,    20,    21,    22,    23,    24,    25,
+       0,    26,    27,     0,  -125,    28,    29,    30,    31,    32,
+      33,    34,    35,     0,    36,     0,     0,  -231,    37,   205,
+      39,  -125,  -106,     0,  -231,    40,     0,    41,    42,    43,
+      44,    45,    46,     0,    47,     0,  -106,    48,  -231,     0,
+       0,    49,     0,    50,     0,     0,    51,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,    52,    53,    54,    55,     0,     0,     0,     0,    56,
+       0,     0,     0,     0,     0,     0,     0,     0,    57,     0,
+      58,     0,    59,    60,     0,    61,     0,     0,    62,     0,
+       0,    63,     0,    64,     4,    65,     5,     6,     7,     8,
+       9,     0,     0,    10,    11,    12,     0,  -106,    13,    14,
+      15,  -231,    16,    17,     0,    18,    19,     0,    20,    21,
+      22,    23,    24,    25,     0,    26,    27,     0,  -125,    28,
+      29,    30,    31,    32,    33,    34,    35,     0,    36,     0,
+       0,  -231,    37,     0,    39,  -125,  -106,     0,  -231,    40,
+       0,    41,    42,    43,    44,    45,    46,     0,    47,     0,
+    -106,    48,  -231,     0,     0,    49,     0,    50,     0,     0,
+      51,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,    52,    53,    54,    55,     0,
+       0,     0,     0,    56,     0,     0,     0,     0,     0,     0,
+       0,     0,    57,     0,    58,     0,    59,    60,     0,    61,
+       0,     0,    62,     0,     0,    63,     0,    64,     4,    65,
+       5,     6,     7,     8,     9,     0,     0,    10,    11,    12,
+       0,  -106,    13,    14,    15,  -231,    16,    17,     0,    18,
+      19,     0,    20,    21,    22,    23,    24,   444,     0,    26,
+      27,     0,  -125,    28,    29,    30,    31,    32,    33,    34,
+      35,     0,    36,     0,     0,  -231,    37,     0,    39,  -125,
+    -106,     0,  -231,    40,     0,    41,    42,    43,    44,    45,
+      46,     0,    47,     0,  -106,    48,  -231,     0,     0,    49,
+       0,    50,     0,     0,    51,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    52,
+      53,    54,    55,     0,     0,     0,     0,    56,     0,     0,
+       0,     0,     0,     0,     0,     0,    57,     0,    58,     0,
+      59,    60,     0,    61,     0,     0,    62,     0,     0,    63,
+       0,    64,     4,    65,     5,     6,     7,     8,     9,     0,
+       0,    10,    11,    12,     0,  -106,    13,    14,    15,  -231,
+      16,    17,     0,    18,    19,     0,    20,    21,    22,    23,
+      24,   448,     0,    26,    27,     0,  -125,    28,    29,    30,
+      31,    32,    33,    34,    35,     0,    36,     0,     0,  -231,
+      37,     0,    39,  -125,  -106,     0,  -231,    40,     0,    41,
+      42,    43,    44,    45,    46,     0,    47,     0,  -106,    48,
+    -231,     0,     0,    49,     0,    50,     0,     0,    51,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,    52,    53,    54,    55,     0,     0,     0,
+       0,    56,     0,     0,     0,     0,     0,     0,     0,     0,
+      57,     0,    58,     0,    59,    60,     0,    61,     0,     0,
+      62,     0,     0,    63,     0,    64,     4,    65,     5,     6,
+       7,     8,     9,     0,     0,    10,    11,    12,     0,  -106,
+      13,    14,    15,  -231,    16,    17,     0,    18,    19,     0,
+      20,    21,    22,    23,    24,   655,     0,    26,    27,     0,
+    -125,    28,    29,    30,    31,    32,    33,    34,    35,     0,
+      36,     0,     0,  -231,    37,     0,    39,  -125,  -106,     0,
+    -231,    40,     0,    41,    42,    43,    44,    45,    46,     0,
+      47,     0,  -106,    48,  -231,     0,     0,    49,     0,    50,
+       0,     0,    51,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,    52,    53,    54,
+      55,     0,     0,     0,     0,    56,     0,     0,     0,     0,
+       0,     0,     0,     0,    57,     0,    58,     0,    59,    60,
+       0,    61,     0,     0,    62,     0,     0,    63,     0,    64,
+       4,    65,     5,     6,     7,     8,     9,     0,     0,    10,
+      11,    12,     0,  -106,    13,    14,    15,  -231,    16,    17,
+       0,    18,    19,     0,    20,    21,    22,    23,    24,   657,
+       0,    26,    27,     0,  -125,    28,    29,    30,    31,    32,
+      33,    34,    35,     0,    36,     0,     0,  -231,    37,     0,
+      39,  -125,  -106,     0,  -231,    40,     0,    41,    42,    43,
+      44,    45,    46,     0,    47,     0,  -106,    48,  -231,     0,
+       0,    49,     0,    50,     0,     0,    51,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,    52,    53,    54,    55,     0,     0,     0,     0,    56,
+       0,     0,     0,     0,     0,     0,     0,     0,    57,     0,
+      58,     0,    59,    60,     0,    61,     0,     0,    62,     0,
+       0,    63,     0,    64,     4,    65,     5,     6,     7,     8,
+       9,     0,     0,    10,    11,    12,     0,  -106,    13,    14,
+      15,  -231,    16,    17,     0,    18,    19,     0,    20,    21,
+      22,    23,    24,   660,     0,    26,    27,     0,  -125,    28,
+      29,    30,    31,    32,    33,    34,    35,     0,    36,     0,
+       0,  -231,    37,     0,    39,  -125,  -106,     0,  -231,    40,
+       0,    41,    42,    43,    44,    45,    46,     0,    47,     0,
+    -106,    48,  -231,     0,     0,    49,     0,    50,     0,     0,
+      51,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,    52,    53,    54,    55,     0,
+       0,     0,     0,    56,     0,     0,     0,     0,     0,     0,
+       0,     0,    57,     0,    58,     0,    59,    60,     0,    61,
+       0,     0,    62,     0,     0,    63,     0,    64,     4,    65,
+       5,     6,     7,     8,     9,     0,     0,    10,    11,    12,
+       0,  -106,    13,    14,    15,  -231,    16,    17,     0,    18,
+      19,     0,    20,    21,    22,    23,    24,   663,     0,    26,
+      27,     0,  -125,    28,    29,    30,    31,    32,    33,    34,
+      35,     0,    36,     0,     0,  -231,    37,     0,    39,  -125,
+    -106,     0,  -231,    40,     0,    41,    42,    43,    44,    45,
+      46,     0,    47,     0,  -106,    48,  -231,     0,     0,    49,
+       0,    50,     0,     0,    51,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    52,
+      53,    54,    55,     0,     0,     0,     0,    56,     0,     0,
+       0,     0,     0,     0,     0,     0,    57,     0,    58,     0,
+      59,    60,     0,    61,     0,     0,    62,     0,     0,    63,
+       0,    64,     4,    65,     5,     6,     7,     8,     9,     0,
+       0,    10,    11,    12,     0,  -106,    13,    14,    15,  -231,
+      16,    17,     0,    18,    19,     0,    20,    21,    22,    23,
+      24,   680,     0,    26,    27,     0,  -125,    28,    29,    30,
+      31,    32,    33,    34,    35,     0,    36,     0,     0,  -231,
+      37,     0,    39,  -125,  -106,     0,  -231,    40,     0,    41,
+      42,    43,    44,    45,    46,     0,    47,     0,  -106,    48,
+    -231,     0,     0,    49,     0,    50,     0,     0,    51,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,    52,    53,    54,    55,     0,     0,     0,
+       0,    56,     0,     0,     0,     0,     0,     0,     0,     0,
+      57,     0,    58,     0,    59,    60,     0,    61,     0,     0,
+      62,     0,     0,    63,     0,    64,     4,    65,     5,     6,
+       7,     8,     9,     0,     0,    10,    11,    12,     0,  -106,
+      13,    14,    15,  -231,    16,    17,     0,    18,    19,     0,
+      20,    21,    22,    23,    24,   684,     0,    26,    27,     0,
+    -125,    28,    29,    30,    31,    32,    33,    34,    35,     0,
+      36,     0,     0,  -231,    37,     0,    39,  -125,  -106,     0,
+    -231,    40,     0,    41,    42,    43,    44,    45,    46,     0,
+      47,     0,  -106,    48,  -231,     0,     0,    49,     0,    50,
+       0,     0,    51,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,    52,    53,    54,
+      55,     0,     0,     0,     0,    56,     0,     0,     0,     0,
+       0,     0,     0,     0,    57,     0,    58,     0,    59,    60,
+       0,    61,     0,     0,    62,     0,     0,    63,     0,    64,
+     464,    65,     5,     6,     7,     8,     9,     0,  -375,   120,
+       0,     0,  -375,     0,     0,     0,     0,     0,     0,     0,
+    -375,     0,    19,     0,     0,     0,     0,   121,   122,   123,
+       0,    26,     0,     0,     0,     0,    29,    30,     0,    32,
+       0,    34,    35,     0,     0,     0,     0,     0,    37,     0,
+      39,     0,     0,  -375,     0,     0,  -375,     0,     0,    43,
+      44,    45,   124,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,  -375,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,  -375,    53,  -375,  -375,  -375,     0,  -375,  -375,  -375,
+       0,  -375,  -375,  -375,  -375,  -375,  -375,  -375,  -375,  -375,
+      58,  -375,  -375,  -375,     0,     0,  -375,  -375,  -375,     0,
+       0,   125,     0,    64,   464,   478,     5,     6,     7,     8,
+       9,     0,     0,   120,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,    19,     0,     0,     0,
+       0,   121,   122,   123,     0,    26,     0,     0,     0,     0,
+      29,    30,     0,    32,     0,    34,    35,     0,     0,     0,
+       0,     0,    37,     0,    39,     0,     0,     0,     0,     0,
+       0,     0,     0,    43,    44,    45,   124,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+      51,     0,   464,     0,     5,     6,     7,     8,     9,     0,
+       0,   120,     0,     0,     0,    52,    53,    54,    55,     0,
+       0,     0,     0,    56,    19,     0,     0,     0,     0,   121,
+     122,   123,    57,    26,    58,     0,    59,    60,    29,    30,
+       0,    32,    62,    34,    35,   125,     0,    64,     0,   465,
+      37,     0,    39,     0,     0,     0,     0,     0,     0,     0,
+       0,    43,    44,    45,   124,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,    51,     0,
+       0,     0,     5,     6,     7,     8,     9,     0,     0,   120,
+       0,     0,     0,    52,    53,    54,    55,     0,     0,     0,
+       0,    56,    19,     0,     0,     0,     0,   121,   122,   123,
+      57,    26,    58,     0,    59,    60,    29,    30,     0,    32,
+      62,    34,    35,   125,     0,    64,     0,   478,    37,     0,
+      39,     0,     0,     0,     0,     0,     0,     0,     0,    43,
+      44,    45,   124,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,    51,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,    52,    53,    54,    55,     0,     0,     0,     0,    56,
+       0,     0,     5,     6,     7,     8,     9,     0,    57,   120,
+      58,     0,    59,    60,   181,     0,     0,     0,    62,     0,
+       0,   125,    19,    64,     0,   126,   752,   121,   122,   123,
+       0,    26,     0,     0,     0,     0,    29,    30,     0,    32,
+       0,    34,    35,     0,     0,     0,     0,     0,    37,     0,
+      39,     0,     0,     0,     0,     0,     0,     0,     0,    43,
+      44,    45,   124,     0,     0,   196,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,    51,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,    52,    53,    54,    55,     0,     0,     0,     0,    56,
+     197,     0,     5,     6,     7,     8,     9,     0,    57,   120,
+      58,     0,    59,    60,   181,     0,     0,     0,    62,     0,
+       0,   125,    19,    64,     0,   126,     0,   121,   122,   123,
+       0,    26,     0,     0,     0,     0,    29,    30,     0,    32,
+       0,    34,    35,     0,     0,     0,     0,     0,    37,     0,
+      39,     0,     0,     0,     0,     0,     0,     0,     0,    43,
+      44,    45,   124,     0,     0,   196,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,    51,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,    52,    53,    54,    55,     0,     0,     0,     0,    56,
+       0,     0,     5,     6,     7,     8,     9,     0,    57,   120,
+      58,     0,    59,    60,   181,     0,     0,     0,    62,     0,
+       0,   125,    19,    64,   485,   126,     0,   121,   122,   123,
+       0,    26,     0,     0,     0,     0,    29,    30,     0,    32,
+       0,    34,    35,     0,     0,     0,     0,   146,    37,     0,
+      39,     0,     0,     0,     0,     0,     0,     0,     0,    43,
+      44,    45,   124,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   147,     0,    51,     0,     0,     0,
+       5,     6,     7,     8,     9,     0,     0,   120,     0,     0,
+       0,    52,    53,    54,    55,     0,     0,     0,     0,    56,
+      19,     0,     0,     0,     0,   121,   122,   123,    57,    26,
+      58,     0,    59,    60,    29,    30,     0,    32,    62,    34,
+      35,   125,     0,    64,     0,   126,    37,     0,    39,     0,
+       0,     0,     0,     0,     0,     0,     0,    43,    44,    45,
+     124,     0,     0,   196,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    51,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    52,
+      53,    54,    55,     0,     0,     0,     0,    56,     0,     0,
+       5,     6,     7,     8,     9,     0,    57,   120,    58,     0,
+      59,    60,   181,     0,     0,     0,    62,     0,     0,   125,
+      19,    64,     0,   126,     0,   121,   122,   123,     0,    26,
+       0,     0,     0,     0,    29,    30,     0,    32,     0,    34,
+      35,     0,     0,     0,     0,     0,    37,     0,    39,     0,
+       0,     0,     0,     0,     0,     0,     0,    43,    44,    45,
+     124,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    51,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    52,
+      53,    54,    55,     0,     0,     0,     0,    56,     0,     0,
+       0,     0,     0,     0,     0,     0,    57,     0,    58,     0,
+      59,    60,     0,   166,     0,     0,    62,     0,     0,   125,
+       0,    64,     0,   126,     5,     6,     7,     8,     9,     0,
+       0,   120,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,   169,    19,     0,     0,     0,     0,   121,
+     122,   123,     0,    26,     0,     0,     0,     0,    29,    30,
+       0,    32,     0,    34,    35,     0,     0,     0,     0,     0,
+      37,     0,    39,     0,     0,     0,     0,     0,     0,     0,
+       0,    43,    44,    45,   124,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,    51,     0,
+       0,     0,     5,     6,     7,     8,     9,     0,     0,   120,
+       0,     0,     0,    52,    53,    54,    55,     0,     0,     0,
+       0,    56,    19,     0,     0,     0,     0,   121,   122,   123,
+      57,    26,    58,     0,    59,    60,    29,    30,     0,    32,
+      62,    34,    35,    63,     0,    64,     0,   126,    37,     0,
+      39,     0,     0,     0,     0,     0,     0,     0,     0,    43,
+      44,    45,   124,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,    51,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,    52,    53,    54,    55,     0,     0,     0,     0,    56,
+       0,     0,     5,     6,     7,     8,     9,     0,    57,   120,
+      58,     0,    59,    60,   181,     0,     0,     0,    62,     0,
+       0,   125,    19,    64,     0,   126,     0,   121,   122,   123,
+       0,    26,     0,     0,     0,     0,    29,    30,     0,    32,
+       0,    34,    35,     0,     0,     0,     0,     0,    37,     0,
+      39,     0,     0,     0,     0,     0,     0,     0,     0,    43,
+      44,    45,   124,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   147,     0,    51,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,    52,    53,    54,    55,     0,     0,     0,     0,    56,
+       0,     0,     5,     6,     7,     8,     9,     0,    57,   120,
+      58,     0,    59,    60,     0,     0,     0,     0,    62,     0,
+       0,   125,    19,    64,     0,   126,     0,   121,   122,   123,
+       0,    26,     0,     0,     0,     0,    29,    30,     0,    32,
+       0,    34,    35,   580,     0,     0,     0,     0,    37,     0,
+      39,     0,     0,     0,     0,     0,     0,     0,     0,    43,
+      44,    45,   124,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,    51,     0,     0,     0,
+       5,     6,     7,     8,     9,     0,     0,   120,     0,     0,
+       0,    52,    53,    54,    55,     0,     0,     0,     0,    56,
+     711,     0,     0,     0,     0,   121,   122,   123,    57,    26,
+      58,     0,    59,    60,    29,    30,     0,    32,    62,    34,
+      35,   125,     0,    64,     0,   126,    37,     0,    39,     0,
+       0,     0,     0,     0,     0,     0,     0,   712,    44,    45,
+     713,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    51,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    52,
+      53,    54,    55,     0,     0,     0,     0,    56,     0,     0,
+       5,     6,     7,     8,     9,     0,    57,   120,    58,     0,
+      59,    60,   181,     0,     0,     0,    62,     0,     0,   125,
+      19,    64,     0,   714,     0,   121,   122,   123,     0,    26,
+       0,     0,     0,     0,    29,    30,     0,    32,     0,    34,
+      35,     0,     0,     0,     0,     0,    37,     0,    39,     0,
+       0,     0,     0,     0,     0,     0,     0,    43,    44,    45,
+     124,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    51,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    52,
+      53,    54,    55,     0,     0,     0,     0,    56,     0,     0,
+       5,     6,     7,     8,     9,     0,    57,   120,    58,     0,
+      59,    60,   181,     0,     0,     0,    62,     0,     0,   125,
+      19,    64,     0,   714,     0,   121,   122,   703,     0,    26,
+       0,     0,     0,     0,    29,    30,     0,    32,     0,    34,
+      35,     0,     0,     0,     0,     0,    37,     0,    39,     0,
+       0,     0,     0,     0,     0,     0,     0,    43,    44,    45,
+     124,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    51,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    52,
+      53,    54,    55,     0,     0,     0,     0,    56,     0,     0,
+       5,     6,     7,     8,     9,     0,    57,   120,    58,     0,
+      59,    60,   181,     0,     0,     0,    62,     0,     0,   125,
+      19,    64,     0,   126,     0,   121,   122,   123,     0,    26,
+       0,     0,     0,     0,    29,    30,     0,    32,     0,    34,
+      35,     0,     0,     0,     0,     0,    37,     0,    39,     0,
+       0,     0,     0,     0,     0,     0,     0,    43,    44,    45,
+     124,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    51,     0,     0,     0,     5,     6,
+       7,     8,     9,     0,     0,   120,     0,     0,     0,    52,
+      53,    54,    55,     0,     0,     0,     0,    56,    19,     0,
+       0,     0,     0,   121,   122,   530,    57,    26,    58,     0,
+      59,    60,    29,    30,     0,    32,    62,    34,    35,   125,
+       0,    64,     0,   126,    37,     0,    39,     0,     0,     0,
+       0,     0,     0,     0,     0,    43,    44,    45,   124,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,    51,     0,     0,     0,     5,     6,     7,     8,
+       9,     0,     0,   120,     0,     0,     0,    52,    53,    54,
+      55,     0,     0,     0,     0,    56,    19,     0,     0,     0,
+       0,   121,   122,   533,    57,    26,    58,     0,    59,    60,
+      29,    30,     0,    32,    62,    34,    35,   125,     0,    64,
+       0,   126,    37,     0,    39,     0,     0,     0,     0,     0,
+       0,     0,     0,    43,    44,    45,   124,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+      51,     0,     0,     0,     5,     6,     7,     8,     9,     0,
+       0,   120,     0,     0,     0,    52,    53,    54,    55,     0,
+       0,     0,     0,    56,    19,     0,     0,     0,     0,   121,
+     122,   697,    57,    26,    58,     0,    59,    60,    29,    30,
+       0,    32,    62,    34,    35,   125,     0,    64,     0,   126,
+      37,     0,    39,     0,     0,     0,     0,     0,     0,     0,
+       0,    43,    44,    45,   124,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,    51,     0,
+       0,     0,     5,     6,     7,     8,     9,     0,     0,   120,
+       0,     0,     0,    52,    53,    54,    55,     0,     0,     0,
+       0,    56,    19,     0,     0,     0,     0,   121,   122,   698,
+      57,    26,    58,     0,    59,    60,    29,    30,     0,    32,
+      62,    34,    35,   125,     0,    64,     0,   126,    37,     0,
+      39,     0,     0,     0,     0,     0,     0,     0,     0,    43,
+      44,    45,   124,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,    51,     0,     0,     0,
+       5,     6,     7,     8,     9,     0,     0,   120,     0,     0,
+       0,    52,    53,    54,    55,     0,     0,     0,     0,    56,
+      19,     0,     0,     0,     0,   121,   122,   700,    57,    26,
+      58,     0,    59,    60,    29,    30,     0,    32,    62,    34,
+      35,   125,     0,    64,     0,   126,    37,     0,    39,     0,
+       0,     0,     0,     0,     0,     0,     0,    43,    44,    45,
+     124,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    51,     0,     0,     0,     5,     6,
+       7,     8,     9,     0,     0,   120,     0,     0,     0,    52,
+      53,    54,    55,     0,     0,     0,     0,    56,    19,     0,
+       0,     0,     0,   121,   122,   701,    57,    26,    58,     0,
+      59,    60,    29,    30,     0,    32,    62,    34,    35,   125,
+       0,    64,     0,   126,    37,     0,    39,     0,     0,     0,
+       0,     0,     0,     0,     0,    43,    44,    45,   124,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,    51,     0,     0,     0,     5,     6,     7,     8,
+       9,     0,     0,   120,     0,     0,     0,    52,    53,    54,
+      55,     0,     0,     0,     0,    56,    19,     0,     0,     0,
+       0,   121,   122,   702,    57,    26,    58,     0,    59,    60,
+      29,    30,     0,    32,    62,    34,    35,   125,     0,    64,
+       0,   126,    37,     0,    39,     0,     0,     0,     0,     0,
+       0,     0,     0,    43,    44,    45,   124,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+      51,     0,     0,     0,     5,     6,     7,     8,     9,     0,
+       0,   120,     0,     0,     0,    52,    53,    54,    55,     0,
+       0,     0,     0,    56,    19,     0,     0,     0,     0,   121,
+     122,   703,    57,    26,    58,     0,    59,    60,    29,    30,
+       0,    32,    62,    34,    35,   125,     0,    64,     0,   126,
+      37,     0,    39,     0,     0,     0,     0,     0,     0,     0,
+       0,    43,    44,    45,   124,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,    51,     0,
+       0,     0,     5,     6,     7,     8,     9,     0,     0,   120,
+       0,     0,     0,    52,    53,    54,    55,     0,     0,     0,
+       0,    56,    19,     0,     0,     0,     0,   121,   122,   123,
+      57,    26,    58,     0,    59,    60,    29,    30,     0,    32,
+      62,    34,    35,   125,     0,    64,     0,   126,    37,     0,
+      39,     0,     0,     0,     0,     0,     0,     5,     0,    43,
+      44,    45,   124,   600,     0,     0,     0,   601,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,  -258,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,    53,     0,     0,     0,  -258,     0,     0,     0,
+    -258,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+      58,     0,     0,     0,   181,     0,     0,     0,     0,     0,
+       0,   125,     0,    64,  -258,   714,     0,     0,     0,     0,
+       0,     0,   602,   603,   604,   605,   606,   607,     0,     0,
+     608,   609,   610,   611,   612,   613,   614,   615,   616,   617,
+       0,     0,   618,     0,     0,     0,   619,   620,   621,   622,
+     623,   624,   625,   626,   627,   628,   629,     0,   630,     0,
+       0,   631,   632,   633,   634,   635,   221,     0,     0,     0,
+     222,     0,     0,     0,     0,     0,     0,     0,   223,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     221,     0,     0,     0,   222,     0,     0,     0,     0,     0,
+       0,   224,   223,     0,   225,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     114,     0,     0,     0,   226,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,   224,     0,     0,   225,   227,
+       0,   228,   229,   230,     0,   231,   232,   233,     0,   234,
+     235,   236,   237,   238,   239,   240,   241,   242,   226,   243,
+     244,   245,     0,     0,   246,   247,   248,     0,     0,     0,
+       0,     0,     0,   227,   592,   228,   229,   230,     0,   231,
+     232,   233,     0,   234,   235,   236,   237,   238,   239,   240,
+     241,   242,   221,   243,   244,   245,   222,     0,   246,   247,
+     248,     0,     0,     0,   223,     0,     0,     0,   761,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,   221,     0,     0,     0,
+     222,     0,     0,     0,     0,     0,     0,   224,   223,     0,
+     225,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     226,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,   224,     0,     0,   225,   227,     0,   228,   229,   230,
+       0,   231,   232,   233,     0,   234,   235,   236,   237,   238,
+     239,   240,   241,   242,   226,   243,   244,   245,     0,     0,
+     246,   247,   248,     0,     0,     0,     0,     0,     0,   227,
+     796,   228,   229,   230,     0,   231,   232,   233,     0,   234,
+     235,   236,   237,   238,   239,   240,   241,   242,   221,   243,
+     244,   245,   222,     0,   246,   247,   248,     0,     0,     0,
+     223,   297,   484,     0,     0,     0,     0,     0,     0,     0,
+     298,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,   221,     0,     0,     0,   222,     0,     0,     0,
+       0,     0,     0,   224,   223,   294,   225,     0,     0,     0,
+       0,     0,     0,     0,   295,     0,     0,     0,     0,     0,
+       0,     0,   114,     0,     0,     0,   226,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,   224,     0,     0,
+     225,   227,     0,   228,   229,   230,     0,   231,   232,   233,
+       0,   234,   235,   236,   237,   238,   239,   240,   241,   242,
+     226,   243,   244,   245,     0,     0,   246,   247,   248,     0,
+       0,   271,     0,     0,     0,   227,     0,   228,   229,   230,
+       0,   231,   232,   233,     0,   234,   235,   236,   237,   238,
+     239,   240,   241,   242,   221,   243,   244,   245,   222,     0,
+     246,   247,   248,     0,     0,   271,   223,   559,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,   224,
+       0,     0,   225,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   114,     0,
+     221,     0,   226,     0,   222,     0,     0,     0,     0,     0,
+       0,     0,   223,     0,     0,     0,     0,   227,     0,   228,
+     229,   230,     0,   231,   232,   233,     0,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,     0,   243,   244,   245,
+       0,     0,   246,   247,   248,   224,     0,   271,   225,     0,
+       0,     0,     0,     0,     0,   301,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,   221,     0,   226,     0,
+     222,     0,     0,     0,     0,     0,     0,     0,   223,   169,
+       0,     0,     0,   227,     0,   228,   229,   230,     0,   231,
+     232,   233,     0,   234,   235,   236,   237,   238,   239,   240,
+     241,   242,     0,   243,   244,   245,     0,     0,   246,   247,
+     248,   224,     0,   271,   225,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,   221,     0,   226,     0,   222,     0,     0,     0,
+       0,     0,     0,     0,   223,   553,     0,     0,     0,   227,
+       0,   228,   229,   230,     0,   231,   232,   233,     0,   234,
+     235,   236,   237,   238,   239,   240,   241,   242,     0,   243,
+     244,   245,     0,     0,   246,   247,   248,   224,     0,   271,
+     225,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   221,     0,
+     226,     0,   222,     0,     0,     0,     0,     0,     0,     0,
+     223,     0,     0,     0,     0,   227,     0,   228,   229,   230,
+       0,   231,   232,   233,     0,   234,   235,   236,   237,   238,
+     239,   240,   241,   242,     0,   243,   244,   245,     0,     0,
+     246,   247,   248,   224,     0,   271,   225,     0,     0,     0,
+       0,     0,     0,   654,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   221,     0,   226,     0,   222,     0,
+       0,     0,     0,     0,     0,     0,   223,     0,     0,     0,
+       0,   227,     0,   228,   229,   230,     0,   231,   232,   233,
+       0,   234,   235,   236,   237,   238,   239,   240,   241,   242,
+       0,   243,   244,   245,     0,     0,   246,   247,   248,   224,
+       0,   271,   225,     0,     0,     0,     0,     0,     0,   659,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     221,     0,   226,     0,   222,     0,     0,     0,     0,     0,
+       0,     0,   223,     0,     0,     0,     0,   227,     0,   228,
+     229,   230,     0,   231,   232,   233,     0,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,     0,   243,   244,   245,
+       0,     0,   246,   247,   248,   224,     0,   271,   225,     0,
+       0,     0,     0,     0,     0,   747,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,   221,     0,   226,     0,
+     222,     0,     0,     0,     0,     0,     0,     0,   223,     0,
+       0,     0,     0,   227,     0,   228,   229,   230,     0,   231,
+     232,   233,     0,   234,   235,   236,   237,   238,   239,   240,
+     241,   242,     0,   243,   244,   245,     0,     0,   246,   247,
+     248,   224,     0,   271,   225,     0,     0,     0,     0,     0,
+       0,   748,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,   221,     0,   226,     0,   222,     0,     0,     0,
+       0,     0,     0,     0,   223,     0,     0,     0,     0,   227,
+       0,   228,   229,   230,     0,   231,   232,   233,     0,   234,
+     235,   236,   237,   238,   239,   240,   241,   242,     0,   243,
+     244,   245,     0,     0,   246,   247,   248,   224,     0,   271,
+     225,     0,     0,     0,     0,     0,     0,   749,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   221,     0,
+     226,     0,   222,     0,     0,     0,     0,     0,     0,     0,
+     223,     0,     0,     0,     0,   227,     0,   228,   229,   230,
+       0,   231,   232,   233,     0,   234,   235,   236,   237,   238,
+     239,   240,   241,   242,     0,   243,   244,   245,     0,     0,
+     246,   247,   248,   224,     0,   271,   225,     0,     0,     0,
+       0,     0,     0,   750,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   221,     0,   226,     0,   222,     0,
+       0,     0,     0,     0,     0,     0,   223,     0,     0,     0,
+       0,   227,     0,   228,   229,   230,     0,   231,   232,   233,
+       0,   234,   235,   236,   237,   238,   239,   240,   241,   242,
+       0,   243,   244,   245,     0,     0,   246,   247,   248,   224,
+       0,   271,   225,     0,     0,     0,     0,     0,     0,   762,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     221,     0,   226,     0,   222,     0,     0,     0,     0,     0,
+       0,     0,   223,     0,     0,     0,     0,   227,     0,   228,
+     229,   230,     0,   231,   232,   233,     0,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,     0,   243,   244,   245,
+       0,     0,   246,   247,   248,   224,     0,   271,   225,     0,
+       0,     0,     0,     0,     0,   763,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,   221,     0,   226,     0,
+     222,     0,     0,     0,     0,     0,     0,     0,   223,     0,
+       0,     0,     0,   227,     0,   228,   229,   230,     0,   231,
+     232,   233,     0,   234,   235,   236,   237,   238,   239,   240,
+     241,   242,     0,   243,   244,   245,     0,     0,   246,   247,
+     248,   224,     0,   271,   225,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,   221,     0,   226,     0,   222,     0,     0,     0,
+       0,     0,     0,     0,   223,     0,     0,     0,     0,   227,
+       0,   228,   229,   230,     0,   231,   232,   233,     0,   234,
+     235,   236,   237,   238,   239,   240,   241,   242,     0,   243,
+     244,   245,     0,     0,   246,   247,   248,   224,     0,   321,
+     225,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   221,     0,
+     226,     0,   222,     0,     0,     0,     0,     0,     0,     0,
+     223,     0,     0,     0,     0,   227,     0,   228,   229,   230,
+     277,   231,   232,   233,     0,   234,   235,   236,   237,   238,
+     239,   240,   241,   242,     0,   243,   244,   245,     0,     0,
+     246,   247,   248,   224,  -338,     0,   225,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,   114,     0,   221,     0,   226,     0,   222,     0,
+       0,     0,     0,     0,     0,     0,   223,   422,     0,     0,
+       0,   227,     0,   228,   229,   230,   423,   231,   232,   233,
+       0,   234,   235,   236,   237,   238,   239,   240,   241,   242,
+       0,   243,   244,   245,     0,     0,   246,   247,   248,   224,
+       0,     0,   225,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     221,     0,   226,     0,   222,     0,     0,     0,     0,     0,
+       0,     0,   223,   424,     0,     0,     0,   227,     0,   228,
+     229,   230,   425,   231,   232,   233,     0,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,     0,   243,   244,   245,
+       0,     0,   246,   247,   248,   224,     0,     0,   225,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,   221,     0,   226,     0,
+     222,     0,     0,     0,     0,     0,     0,     0,   223,     0,
+       0,     0,     0,   227,     0,   228,   229,   230,     0,   231,
+     232,   233,     0,   234,   235,   236,   237,   238,   239,   240,
+     241,   242,     0,   243,   244,   245,     0,     0,   246,   247,
+     248,   224,     0,     0,   225,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,   221,     0,   226,     0,   222,     0,     0,     0,
+       0,     0,     0,     0,   223,     0,     0,     0,     0,   227,
+       0,   228,   229,   230,     0,   231,   232,   233,     0,   234,
+     235,   236,   237,   238,   239,   240,   241,   242,     0,   243,
+     244,   245,     0,   281,   246,   247,   248,   224,     0,     0,
+     225,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   221,     0,
+     226,     0,   222,     0,     0,     0,     0,     0,     0,     0,
+     223,     0,     0,     0,     0,   227,     0,   228,   229,   230,
+       0,   231,   232,   233,     0,   234,   235,   236,   237,   238,
+     239,   240,   241,   242,     0,   243,   244,   245,     0,   320,
+     246,   247,   248,   224,     0,     0,   225,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   221,     0,   226,     0,   222,     0,
+       0,     0,     0,     0,     0,     0,   223,     0,     0,     0,
+       0,   227,     0,   228,   229,   230,     0,   231,   232,   233,
+       0,   234,   235,   236,   237,   238,   239,   240,   241,   242,
+       0,   243,   244,   245,     0,   334,   246,   247,   248,   224,
+       0,     0,   225,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     221,   346,   226,     0,   222,     0,     0,     0,     0,     0,
+       0,     0,   223,     0,     0,     0,     0,   227,     0,   228,
+     229,   230,     0,   231,   232,   233,     0,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,     0,   243,   244,   245,
+       0,     0,   246,   247,   248,   224,     0,     0,   225,     0,
+       0,     0,     0,     0,     0,   426,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,   221,     0,   226,     0,
+     222,     0,     0,     0,     0,     0,     0,     0,   223,     0,
+       0,     0,     0,   227,     0,   228,   229,   230,     0,   231,
+     232,   233,     0,   234,   235,   236,   237,   238,   239,   240,
+     241,   242,     0,   243,   244,   245,     0,     0,   246,   247,
+     248,   224,     0,     0,   225,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,   221,     0,   226,     0,   222,     0,     0,     0,
+       0,     0,     0,     0,   223,     0,     0,     0,     0,   227,
+       0,   228,   229,   230,     0,   231,   232,   233,     0,   234,
+     235,   236,   237,   238,   239,   240,   241,   242,     0,   243,
+     244,   245,     0,   508,   246,   247,   248,   224,     0,     0,
+     225,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   221,     0,
+     226,     0,   222,     0,     0,     0,     0,     0,     0,     0,
+     223,     0,     0,     0,     0,   227,     0,   228,   229,   230,
+       0,   231,   232,   233,     0,   234,   235,   236,   237,   238,
+     239,   240,   241,   242,     0,   243,   244,   245,     0,   509,
+     246,   247,   248,   224,     0,     0,   225,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   221,     0,   226,     0,   222,     0,
+       0,     0,     0,     0,     0,     0,   223,     0,     0,     0,
+       0,   227,     0,   228,   229,   230,     0,   231,   232,   233,
+       0,   234,   235,   236,   237,   238,   239,   240,   241,   242,
+       0,   243,   244,   245,     0,   510,   246,   247,   248,   224,
+       0,     0,   225,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     221,     0,   226,     0,   222,     0,     0,     0,     0,     0,
+       0,     0,   223,     0,     0,     0,     0,   227,     0,   228,
+     229,   230,     0,   231,   232,   233,     0,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,     0,   243,   244,   245,
+       0,   511,   246,   247,   248,   224,     0,     0,   225,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,   221,     0,   226,     0,
+     222,     0,     0,     0,     0,     0,     0,     0,   223,     0,
+       0,     0,     0,   227,     0,   228,   229,   230,     0,   231,
+     232,   233,     0,   234,   235,   236,   237,   238,   239,   240,
+     241,   242,     0,   243,   244,   245,     0,   512,   246,   247,
+     248,   224,     0,     0,   225,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,   221,     0,   226,     0,   222,     0,     0,     0,
+       0,     0,     0,     0,   223,     0,     0,     0,     0,   227,
+       0,   228,   229,   230,     0,   231,   232,   233,     0,   234,
+     235,   236,   237,   238,   239,   240,   241,   242,     0,   243,
+     244,   245,     0,   513,   246,   247,   248,   224,     0,     0,
+     225,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   221,     0,
+     226,     0,   222,     0,     0,     0,     0,     0,     0,     0,
+     223,     0,     0,     0,     0,   227,     0,   228,   229,   230,
+       0,   231,   232,   233,     0,   234,   235,   236,   237,   238,
+     239,   240,   241,   242,     0,   243,   244,   245,     0,   514,
+     246,   247,   248,   224,     0,     0,   225,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   221,     0,   226,     0,   222,     0,
+       0,     0,     0,     0,     0,     0,   223,     0,     0,     0,
+       0,   227,     0,   228,   229,   230,     0,   231,   232,   233,
+       0,   234,   235,   236,   237,   238,   239,   240,   241,   242,
+       0,   243,   244,   245,     0,   515,   246,   247,   248,   224,
+       0,     0,   225,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     221,     0,   226,     0,   222,     0,     0,     0,     0,     0,
+       0,     0,   223,     0,     0,     0,     0,   227,     0,   228,
+     229,   230,     0,   231,   232,   233,     0,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,     0,   243,   244,   245,
+       0,   516,   246,   247,   248,   224,     0,     0,   225,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,   221,     0,   226,     0,
+     222,     0,     0,     0,     0,     0,     0,     0,   223,     0,
+       0,     0,     0,   227,     0,   228,   229,   230,     0,   231,
+     232,   233,     0,   234,   235,   236,   237,   238,   239,   240,
+     241,   242,     0,   243,   244,   245,     0,   517,   246,   247,
+     248,   224,     0,     0,   225,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,   221,     0,   226,     0,   222,     0,     0,     0,
+       0,     0,     0,     0,   223,     0,     0,     0,     0,   227,
+       0,   228,   229,   230,     0,   231,   232,   233,     0,   234,
+     235,   236,   237,   238,   239,   240,   241,   242,     0,   243,
+     244,   245,     0,   518,   246,   247,   248,   224,     0,     0,
+     225,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   221,     0,
+     226,     0,   222,     0,     0,     0,     0,     0,     0,     0,
+     223,     0,     0,     0,     0,   227,     0,   228,   229,   230,
+       0,   231,   232,   233,     0,   234,   235,   236,   237,   238,
+     239,   240,   241,   242,     0,   243,   244,   245,     0,   519,
+     246,   247,   248,   224,     0,     0,   225,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   221,     0,   226,     0,   222,     0,
+       0,     0,     0,     0,     0,     0,   223,     0,     0,     0,
+       0,   227,     0,   228,   229,   230,     0,   231,   232,   233,
+       0,   234,   235,   236,   237,   238,   239,   240,   241,   242,
+       0,   243,   244,   245,     0,   520,   246,   247,   248,   224,
+       0,     0,   225,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     221,     0,   226,     0,   222,     0,     0,     0,     0,     0,
+       0,     0,   223,     0,     0,     0,     0,   227,     0,   228,
+     229,   230,     0,   231,   232,   233,     0,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,     0,   243,   244,   245,
+       0,   521,   246,   247,   248,   224,     0,     0,   225,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,   221,     0,   226,     0,
+     222,     0,     0,     0,     0,     0,     0,     0,   223,     0,
+       0,     0,     0,   227,     0,   228,   229,   230,     0,   231,
+     232,   233,     0,   234,   235,   236,   237,   238,   239,   240,
+     241,   242,     0,   243,   244,   245,     0,   522,   246,   247,
+     248,   224,     0,     0,   225,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     114,     0,   221,     0,   226,     0,   222,     0,     0,     0,
+       0,     0,     0,     0,   223,     0,     0,     0,     0,   227,
+       0,   228,   229,   230,     0,   231,   232,   233,     0,   234,
+     235,   236,   237,   238,   239,   240,   241,   242,     0,   243,
+     244,   245,     0,     0,   246,   247,   248,   224,     0,     0,
+     225,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   221,     0,
+     226,     0,   222,     0,     0,     0,     0,     0,     0,     0,
+     223,     0,     0,   563,     0,   227,     0,   228,   229,   230,
+       0,   231,   232,   233,     0,   234,   235,   236,   237,   238,
+     239,   240,   241,   242,     0,   243,   244,   245,     0,   540,
+     246,   247,   248,   224,     0,     0,   225,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   221,     0,   226,     0,   222,     0,
+       0,     0,     0,     0,     0,     0,   223,     0,     0,     0,
+       0,   227,     0,   228,   229,   230,     0,   231,   232,   233,
+       0,   234,   235,   236,   237,   238,   239,   240,   241,   242,
+       0,   243,   244,   245,     0,     0,   246,   247,   248,   224,
+       0,     0,   225,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     221,   595,   226,     0,   222,     0,     0,     0,     0,     0,
+       0,     0,   223,   643,     0,     0,     0,   227,     0,   228,
+     229,   230,     0,   231,   232,   233,     0,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,     0,   243,   244,   245,
+       0,     0,   246,   247,   248,   224,     0,     0,   225,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,   221,     0,   226,     0,
+     222,     0,     0,     0,     0,     0,     0,     0,   223,   646,
+       0,     0,     0,   227,     0,   228,   229,   230,     0,   231,
+     232,   233,     0,   234,   235,   236,   237,   238,   239,   240,
+     241,   242,     0,   243,   244,   245,     0,     0,   246,   247,
+     248,   224,     0,     0,   225,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,   221,     0,   226,     0,   222,     0,     0,     0,
+       0,     0,     0,     0,   223,     0,     0,     0,     0,   227,
+       0,   228,   229,   230,     0,   231,   232,   233,     0,   234,
+     235,   236,   237,   238,   239,   240,   241,   242,     0,   243,
+     244,   245,     0,     0,   246,   247,   248,   224,     0,     0,
+     225,     0,     0,     0,     0,     0,     0,   696,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   221,     0,
+     226,     0,   222,     0,     0,     0,     0,     0,     0,     0,
+     223,     0,     0,     0,     0,   227,     0,   228,   229,   230,
+       0,   231,   232,   233,     0,   234,   235,   236,   237,   238,
+     239,   240,   241,   242,     0,   243,   244,   245,     0,     0,
+     246,   247,   248,   224,     0,     0,   225,     0,     0,     0,
+       0,     0,     0,   699,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   221,     0,   226,     0,   222,     0,
+       0,     0,     0,     0,     0,     0,   223,     0,     0,     0,
+       0,   227,     0,   228,   229,   230,     0,   231,   232,   233,
+       0,   234,   235,   236,   237,   238,   239,   240,   241,   242,
+       0,   243,   244,   245,     0,     0,   246,   247,   248,   224,
+       0,     0,   225,     0,     0,     0,     0,     0,     0,   769,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     221,     0,   226,     0,   222,     0,     0,     0,     0,     0,
+       0,     0,   223,     0,     0,     0,     0,   227,     0,   228,
+     229,   230,     0,   231,   232,   233,     0,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,     0,   243,   244,   245,
+       0,     0,   246,   247,   248,   224,     0,     0,   225,     0,
+       0,     0,     0,     0,     0,   770,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,   221,     0,   226,     0,
+     222,     0,     0,     0,     0,     0,     0,     0,   223,     0,
+       0,     0,     0,   227,     0,   228,   229,   230,     0,   231,
+     232,   233,     0,   234,   235,   236,   237,   238,   239,   240,
+     241,   242,     0,   243,   244,   245,     0,     0,   246,   247,
+     248,   224,     0,     0,   225,     0,     0,     0,     0,     0,
+       0,   771,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,   221,     0,   226,     0,   222,     0,     0,     0,
+       0,     0,     0,     0,   223,     0,     0,     0,     0,   227,
+       0,   228,   229,   230,     0,   231,   232,   233,     0,   234,
+     235,   236,   237,   238,   239,   240,   241,   242,     0,   243,
+     244,   245,     0,     0,   246,   247,   248,   224,     0,     0,
+     225,     0,     0,     0,     0,     0,     0,   772,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   221,     0,
+     226,     0,   222,     0,     0,     0,     0,     0,     0,     0,
+     223,     0,     0,     0,     0,   227,     0,   228,   229,   230,
+       0,   231,   232,   233,     0,   234,   235,   236,   237,   238,
+     239,   240,   241,   242,     0,   243,   244,   245,     0,     0,
+     246,   247,   248,   224,     0,     0,   225,     0,     0,     0,
+       0,     0,     0,   773,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   221,     0,   226,     0,   222,     0,
+       0,     0,     0,     0,     0,     0,   223,     0,     0,     0,
+       0,   227,     0,   228,   229,   230,     0,   231,   232,   233,
+       0,   234,   235,   236,   237,   238,   239,   240,   241,   242,
+       0,   243,   244,   245,     0,     0,   246,   247,   248,   224,
+       0,     0,   225,     0,     0,     0,     0,     0,     0,   774,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+     221,     0,   226,     0,   222,     0,     0,     0,     0,     0,
+       0,     0,   223,     0,     0,     0,     0,   227,     0,   228,
+     229,   230,     0,   231,   232,   233,     0,   234,   235,   236,
+     237,   238,   239,   240,   241,   242,     0,   243,   244,   245,
+       0,     0,   246,   247,   248,   224,     0,     0,   225,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   226,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,   227,     0,   228,   229,   230,     0,   231,
+     232,   233,     0,   234,   235,   236,   237,   238,   239,   240,
+     241,   242,     0,   243,   244,   245,     0,     0,   246,   247,
+     248
+};
+
+static const yytype_int16 yycheck[] =
+{
+      10,     2,   327,   313,    14,    13,   308,    17,   268,   577,
+     136,     3,     3,    23,    24,    25,    97,   327,   144,   150,
+      46,    73,    32,    22,    34,     3,    36,    37,   152,    22,
+      40,    41,    42,    43,   463,   722,    46,     3,    48,    49,
+      50,   165,   123,    53,    70,    48,    56,    57,    58,    22,
+      60,   175,    55,    63,    64,    65,   215,   216,   217,   218,
+      48,     3,     4,     5,     6,     7,   638,     3,    10,    97,
+      46,   202,     3,     0,    66,   127,    22,    65,   765,    31,
+       1,    23,     1,   689,    73,    35,    28,    29,    30,    55,
+      32,    56,    23,    31,    70,    37,    38,   123,    40,   127,
+      42,    43,    52,   671,    97,    65,    18,    49,    23,    51,
+     120,   121,   122,   123,   124,   125,   126,    14,    60,    61,
+      62,    63,    58,   122,   132,    78,    31,    73,   734,   122,
+     140,     3,   124,   124,    65,    56,    48,    56,   126,    56,
+     264,   265,   152,    55,   573,    97,   124,   123,   101,   122,
+      71,    93,    71,    65,   752,   165,    53,   122,   124,    97,
+     462,    54,    31,    97,    57,   175,   738,   739,   178,   111,
+      67,   148,   149,   150,    97,    96,   122,    96,    76,    97,
+      78,    97,   124,   751,   126,   162,    55,   197,   786,   127,
+     178,   125,    97,   194,   353,   172,    31,   116,    31,   116,
+     324,   122,   125,   122,   124,   122,   126,   125,   185,   125,
+     220,   221,   222,   223,   224,   225,   226,   227,   228,   229,
+     230,   231,   127,   233,   234,   235,   236,   237,   238,   239,
+     240,   241,   242,   243,   244,   245,   246,   247,   248,   249,
+     250,   251,   252,   253,   254,   255,   256,   257,   258,   259,
+     260,   261,   262,   263,   264,   265,   266,   267,    78,    97,
+      31,   690,    97,    21,    97,   567,   576,   277,   528,    97,
+      78,    97,   282,    97,   124,    97,    97,    97,   116,   124,
+       7,   101,   292,   124,   294,   295,    97,   297,   298,    97,
+     116,   301,   127,   101,   127,   116,    54,   125,   122,    57,
+      64,   278,    73,   125,   292,   125,   316,    62,    97,   224,
+     225,    97,   123,   116,   324,   124,    97,   125,   786,   450,
+     451,   331,   116,   300,     2,    97,    97,   116,   796,   339,
+     116,   341,    10,   343,   344,   116,   346,   347,    96,   116,
+      18,    99,   121,   116,   116,   103,     3,   116,   116,     1,
+     675,   266,   267,    31,   679,   481,   127,   488,   489,   116,
+     670,    18,   277,   116,   124,   675,     1,   116,    46,   679,
+     122,   124,    18,   126,    31,    96,   140,    34,    99,    31,
+     295,   116,   103,   298,   124,    63,   126,    72,   152,    67,
+      47,    48,   124,   122,   126,   339,    31,   341,    55,   124,
+     124,   165,    48,    99,   124,    78,   116,     7,    65,    55,
+     122,   175,   422,   423,   424,   425,   426,   427,   428,   116,
+     125,   429,   430,    69,   434,   435,    78,   437,   343,    97,
+     116,    24,   442,    31,   444,   125,    97,   115,   448,    76,
+      78,    76,   752,    78,    96,    97,   125,    97,   125,   125,
+      78,   761,   127,    96,   125,   465,    24,   127,   468,   469,
+     125,    96,    97,     2,   116,   125,   122,   124,   478,   446,
+     447,    10,    31,   450,   451,   153,   786,   465,    22,    18,
+      22,   116,   127,     3,    96,   127,   796,   497,     8,    97,
+     478,   169,    31,   127,    14,   496,    99,    56,   124,    71,
+     264,   265,   125,   689,   350,    16,   477,    46,   423,   497,
+     425,   546,    71,   692,   692,    35,   194,   693,   565,    78,
+     530,   599,   765,   533,    63,   751,   736,   317,    67,   710,
+     437,   528,    52,    53,    -1,   545,    -1,     3,    97,    -1,
+      -1,   551,    -1,   553,    -1,    65,   556,    67,    14,   559,
+       2,    -1,    -1,   563,    -1,    -1,    -1,   116,    10,    -1,
+     324,   538,   539,   122,    -1,    -1,    18,   331,    -1,    35,
+      -1,   548,    -1,   583,    -1,   339,   115,   341,    -1,    31,
+     590,   558,   592,    -1,   561,   595,    52,    53,    -1,    -1,
+      -1,    -1,    18,   271,    46,   583,    -1,    -1,    -1,    65,
+      -1,    67,    -1,    -1,    -1,    31,    -1,    -1,    34,    -1,
+      -1,    63,    -1,    -1,   153,    67,   294,    -1,    -1,   297,
+      -1,    47,    48,   301,    -1,    -1,    -1,    -1,    -1,    55,
+     169,    -1,   642,   643,    -1,   645,   646,   647,   648,    65,
+      -1,    -1,    -1,    -1,   654,   655,    21,   657,    -1,   659,
+     660,    -1,    -1,   663,    -1,   194,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,   115,   674,   675,   344,    -1,    -1,   679,
+     680,   435,   350,   437,   684,    -1,    -1,    -1,    -1,    54,
+      31,    -1,    57,    -1,    -1,    -1,   696,   697,   698,   699,
+     700,   701,   702,   703,    -1,    -1,    -1,    -1,    -1,    -1,
+     677,   153,   712,   713,   714,    56,    -1,    -1,   718,    -1,
+      -1,   721,    -1,    -1,    -1,    -1,    -1,   169,    -1,    -1,
+      71,    96,    -1,    98,    99,    -1,   714,    78,   103,    -1,
+      -1,    -1,   271,    -1,    -1,   110,    -1,   747,   748,   749,
+     750,   419,   194,    -1,   119,    -1,    97,    -1,    -1,    -1,
+      -1,   761,   762,   763,    -1,   294,    -1,    -1,   297,   769,
+     770,   771,   772,   773,   774,   116,     2,    -1,    -1,    -1,
+      -1,   122,    -1,    21,    10,   785,   786,   455,    -1,    -1,
+      -1,    -1,    18,    -1,    -1,    -1,   796,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    31,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,   344,    54,    -1,    -1,    57,
+      46,   350,    -1,    -1,   492,    -1,    -1,    -1,   496,   271,
+      -1,    -1,    -1,    -1,     2,    -1,    -1,    63,    -1,    77,
+      -1,    67,    10,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      18,    -1,   294,    -1,    92,   297,    94,    95,    96,   301,
+      98,    99,   100,    31,   102,   103,   104,   105,    -1,   107,
+     108,   109,   110,    -1,   112,   113,   114,    -1,    46,   117,
+     118,   119,    -1,   551,    -1,   553,    -1,    -1,   556,   115,
+      -1,   559,    -1,    -1,   562,    63,    -1,    -1,    -1,    67,
+      -1,    -1,   344,    -1,    -1,     2,    -1,    -1,   350,    -1,
+      -1,    -1,    -1,    10,   582,    31,   670,    -1,    -1,    -1,
+      -1,    18,   590,    -1,   592,    -1,   455,   153,    -1,    -1,
+      -1,    -1,    -1,    -1,    31,    -1,    -1,    -1,    -1,    14,
+      56,    -1,    17,   169,    -1,    -1,    -1,   115,    -1,    46,
+      25,    26,    27,    -1,    -1,    71,    -1,    -1,    33,    -1,
+      35,    -1,    78,   492,   718,    -1,    63,   496,   194,    21,
+      67,    -1,    -1,    -1,    -1,    50,    -1,    52,    53,    -1,
+      -1,    97,    -1,    -1,    -1,   153,   654,    -1,    -1,    -1,
+      65,   659,    67,    -1,    -1,    -1,    -1,    -1,   752,    -1,
+     116,   169,    54,    -1,    -1,    57,   122,    -1,    -1,    -1,
+      -1,    -1,    -1,   455,    -1,   683,    -1,    -1,   115,   687,
+      -1,    -1,   551,    -1,   553,    -1,   194,   556,    -1,    -1,
+     559,    -1,   786,   562,    -1,    -1,    -1,    -1,    -1,    -1,
+      92,   116,   796,    95,    96,   271,    98,    99,   123,    -1,
+     492,   103,    -1,   582,   496,    -1,   153,    -1,   110,    42,
+      -1,   590,    -1,   592,    -1,   117,   118,   119,   294,    -1,
+      -1,   297,   169,    -1,    21,   301,    -1,    -1,    -1,   747,
+     748,   749,   750,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,   762,   763,    -1,   194,    -1,    -1,
+      -1,    -1,    -1,   271,    -1,    -1,    -1,    54,    -1,   551,
+      57,   553,    -1,    -1,   556,    -1,    -1,   559,   344,    -1,
+     562,    -1,    -1,    -1,   350,    -1,   294,    -1,    -1,   297,
+      -1,     2,    -1,   301,    -1,    -1,   119,    -1,    -1,    10,
+     582,    -1,    -1,    -1,    -1,    92,    -1,    18,   590,    96,
+     592,    98,    99,    -1,   683,    -1,   103,    -1,   687,    -1,
+      31,    -1,    -1,   110,    -1,   148,   149,   150,   151,    -1,
+     117,   118,   119,    -1,   271,    46,   344,    -1,    -1,   162,
+      -1,    -1,   350,    -1,    -1,    -1,    -1,    -1,    -1,   172,
+      -1,    -1,    63,    -1,    -1,    14,    67,   294,    17,    -1,
+     297,    -1,   185,    -1,   301,    -1,    25,    26,    27,    -1,
+      -1,    -1,   654,    -1,    33,    -1,    35,   659,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,   455,
+      -1,    50,    -1,    52,    53,    -1,    -1,    -1,    -1,    -1,
+      -1,   683,    -1,    -1,   115,   687,    65,   344,    67,    -1,
+      -1,    -1,    -1,   350,     3,     4,     5,     6,     7,    -1,
+      -1,    10,    -1,    -1,    -1,    -1,   492,    -1,    -1,    -1,
+     496,    -1,    -1,    -1,    23,    -1,    -1,    -1,    -1,    28,
+      29,    30,   153,    32,    -1,    -1,    -1,   455,    37,    38,
+      -1,    40,    -1,    42,    43,   278,    -1,   116,   169,    -1,
+      49,    -1,    51,    -1,    -1,   747,   748,   749,   750,    -1,
+      -1,    60,    61,    62,    63,    -1,    -1,   300,    -1,    -1,
+     762,   763,    -1,   194,   492,   551,    -1,   553,   496,    -1,
+     556,    -1,    -1,   559,    -1,    -1,   562,    -1,    -1,    -1,
+      -1,    -1,    -1,    92,    93,    94,    95,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    21,    -1,   582,    -1,   455,    -1,
+     109,    -1,   111,    -1,   590,   114,   592,    -1,    -1,    -1,
+     119,    -1,    -1,   122,    -1,   124,     2,   126,    -1,    -1,
+      -1,    -1,    -1,   551,    10,   553,    -1,    54,   556,    -1,
+      57,   559,    18,    -1,   562,   492,    -1,    -1,    -1,   496,
+     271,    -1,    -1,    -1,    -1,    31,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,   582,    -1,    -1,    -1,    -1,    -1,
+      46,    -1,   590,   294,   592,    -1,   297,    -1,   654,    96,
+     301,    98,    99,   659,    -1,    -1,   103,    63,    -1,    -1,
+      -1,    67,    -1,   110,    -1,    -1,    -1,    -1,    -1,    -1,
+     117,   118,   119,    -1,   551,    -1,   553,   683,    -1,   556,
+      -1,   687,   559,   446,   447,   562,    -1,   450,   451,    -1,
+      -1,    -1,    -1,   344,    -1,    -1,    -1,    -1,    -1,   350,
+      -1,    -1,    -1,    -1,    -1,   582,   654,    -1,    -1,   115,
+      -1,   659,    -1,   590,    -1,   592,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,     2,
+      -1,    -1,    -1,    -1,    21,   683,    -1,    10,    -1,   687,
+      -1,   747,   748,   749,   750,    18,    -1,   153,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,   762,   763,    31,    -1,
+      -1,    -1,    -1,   169,    -1,    -1,    -1,    54,    -1,    -1,
+      57,    -1,    -1,    46,    -1,   538,   539,   654,    -1,    -1,
+      -1,    -1,   659,    -1,    -1,   548,    -1,   550,   194,    -1,
+      63,    -1,   555,    -1,    67,   558,    -1,    -1,   561,   747,
+     748,   749,   750,    -1,   455,    92,   683,    94,    95,    96,
+     687,    98,    99,   100,   762,   763,   103,   104,   105,    -1,
+     107,   108,   109,   110,    -1,    -1,    -1,   114,    -1,    -1,
+     117,   118,   119,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,   492,   115,    -1,    -1,   496,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,   271,    -1,    -1,    -1,    -1,
+     747,   748,   749,   750,    -1,    -1,    -1,    -1,    -1,    -1,
+     153,    -1,    -1,    -1,    -1,   762,   763,    -1,   294,    -1,
+      -1,   297,    -1,    -1,    21,   301,   169,    -1,    -1,    -1,
+     551,    -1,   553,    -1,    -1,   556,    -1,    -1,   559,    -1,
+      -1,   562,    -1,    -1,   677,    -1,    -1,    -1,    -1,    -1,
+      -1,   194,    21,    -1,    -1,    -1,    -1,    54,    -1,    -1,
+      57,   582,    -1,    -1,    -1,    -1,    -1,    -1,   344,   590,
+      -1,   592,   705,   706,   350,   708,   709,    -1,    -1,    -1,
+      77,    -1,    -1,    -1,    -1,    54,    -1,    -1,    57,   722,
+      -1,    -1,    -1,    -1,   727,    92,   729,    94,    95,    96,
+      -1,    98,    99,   100,    -1,   102,   103,   104,   105,    -1,
+     107,   108,   109,   110,    -1,   112,    -1,   114,    -1,    -1,
+     117,   118,   119,    92,    -1,    94,    95,    96,   271,    98,
+      99,   100,   765,   654,   103,    -1,    -1,    -1,   659,    -1,
+     109,   110,    -1,    -1,    -1,   114,    -1,    -1,   117,   118,
+     119,   294,    -1,    -1,   297,    -1,    -1,    -1,   301,    -1,
+      -1,    -1,   683,    -1,     9,    12,   687,    -1,    13,    16,
+      -1,    -1,    -1,    20,    21,    22,    21,    -1,    -1,   455,
+      -1,    28,    -1,    30,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      47,   344,    -1,    -1,    -1,    -1,    -1,   350,    -1,    54,
+      -1,    -1,    57,    -1,    -1,    -1,   492,    -1,    -1,    -1,
+     496,    -1,    -1,    70,    -1,    -1,   747,   748,   749,   750,
+      -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,   762,   763,    -1,    -1,    -1,    -1,    92,    21,    94,
+      95,    96,    -1,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,    -1,   112,   113,   114,
+      -1,    -1,   117,   118,   119,   551,    -1,   553,    -1,    -1,
+     556,    54,   127,   559,    57,    -1,   562,    -1,    -1,   136,
+      -1,    -1,    -1,   140,    -1,    -1,    -1,   144,    -1,   146,
+      -1,    -1,    21,    -1,    -1,   152,   582,    -1,   155,    -1,
+      -1,    -1,   455,    -1,   590,    -1,   592,    -1,   165,    92,
+      -1,    94,    95,    96,    -1,    98,    99,    -1,   175,    -1,
+     103,    -1,    -1,    -1,   181,    54,   109,   110,    57,    -1,
+      -1,   114,    -1,    -1,   117,   118,   119,    -1,    -1,   492,
+      -1,    -1,    -1,   496,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,   211,    -1,    -1,    -1,   215,   216,
+     217,   218,    -1,    92,    -1,    94,    95,    96,   654,    98,
+      99,    -1,    -1,   659,   103,   232,    -1,    -1,    -1,    -1,
+      -1,   110,    -1,    -1,    -1,    -1,    -1,    -1,   117,   118,
+     119,    -1,    -1,    -1,    -1,    -1,    -1,   683,   551,    -1,
+     553,   687,    -1,   556,    -1,    -1,   559,   264,   265,   562,
+      78,    79,    80,    81,    82,    83,    84,    85,    86,    87,
+      88,    89,    90,    91,    -1,    -1,    -1,    -1,    -1,   582,
+      -1,    -1,   289,    -1,    -1,    -1,    -1,   590,    -1,   592,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,   308,   120,   121,    -1,    -1,   124,    -1,   126,    -1,
+     317,   747,   748,   749,   750,    -1,     1,   324,     3,     4,
+       5,     6,     7,    -1,     9,    10,   762,   763,    13,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,    23,    -1,
+      -1,    -1,    -1,    28,    29,    30,   353,    32,    -1,    -1,
+      -1,   654,    37,    38,    -1,    40,   659,    42,    43,    -1,
+      -1,    -1,    -1,    -1,    49,    -1,    51,    -1,    -1,    54,
+      -1,    -1,    57,    -1,    -1,    60,    61,    62,    63,    -1,
+     683,    -1,    -1,    -1,   687,    -1,    -1,    -1,    -1,    -1,
+      -1,    76,    77,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    92,    93,    94,
+      95,    96,    -1,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,   111,   112,   113,   114,
+     437,    -1,   117,   118,   119,    -1,    -1,   122,    -1,   124,
+      -1,   126,    -1,    -1,   747,   748,   749,   750,    -1,    -1,
+      -1,    -1,   459,    -1,    -1,   462,    -1,    -1,    -1,   762,
+     763,     0,     1,    -1,     3,     4,     5,     6,     7,    -1,
+      -1,    10,    11,    12,   481,    14,    15,    16,    17,    18,
+      19,    20,    -1,    22,    23,    -1,    25,    26,    27,    28,
+      29,    30,    -1,    32,    33,   502,    35,    36,    37,    38,
+      39,    40,    41,    42,    43,    -1,    45,    -1,    -1,    48,
+      49,    50,    51,    52,    53,    -1,    55,    56,    -1,    58,
+      59,    60,    61,    62,    63,    -1,    65,    -1,    67,    68,
+      69,    -1,    21,    72,    -1,    74,    -1,    -1,    77,   546,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    92,    93,    94,    95,    -1,    -1,    -1,
+     567,   100,    -1,    -1,    -1,    54,    -1,    -1,    57,    -1,
+     109,    -1,   111,    -1,   113,   114,    -1,   116,    -1,    -1,
+     119,    -1,    -1,   122,    -1,   124,    -1,   126,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    92,    -1,    94,    95,    96,   615,    98,
+      99,   100,    -1,   102,   103,   104,   105,    -1,   107,   108,
+     109,   110,    -1,   112,    -1,   114,    -1,    -1,   117,   118,
+     119,    -1,    -1,    -1,    -1,    -1,     1,    -1,     3,     4,
+       5,     6,     7,    -1,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    -1,    32,    33,    -1,
+      35,    36,    37,    38,    39,    40,    41,    42,    43,    -1,
+      45,    -1,    -1,    48,    49,   692,    51,    52,    53,    54,
+      55,    56,    57,    58,    59,    60,    61,    62,    63,    -1,
+      65,    -1,    67,    68,    69,    -1,    -1,    72,    -1,    74,
+      -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,   731,   732,    -1,    92,    93,    94,
+      95,    96,    97,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,   111,   112,   113,   114,
+      -1,   116,   117,   118,   119,    -1,    -1,   122,   123,   124,
+       1,   126,     3,     4,     5,     6,     7,    -1,    -1,    10,
+      11,    12,    -1,    14,    15,    16,    17,    18,    19,    20,
+      -1,    22,    23,    -1,    25,    26,    27,    28,    29,    30,
+      -1,    32,    33,    -1,    35,    36,    37,    38,    39,    40,
+      41,    42,    43,    -1,    45,    -1,    -1,    48,    49,    50,
+      51,    52,    53,    -1,    55,    56,    -1,    58,    59,    60,
+      61,    62,    63,    -1,    65,    -1,    67,    68,    69,    -1,
+      -1,    72,    -1,    74,    -1,    -1,    77,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    92,    93,    94,    95,    -1,    -1,    -1,    -1,   100,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,   109,    -1,
+     111,    -1,   113,   114,   115,   116,    -1,    -1,   119,    -1,
+      -1,   122,   123,   124,     1,   126,     3,     4,     5,     6,
+       7,    -1,    -1,    10,    11,    12,    -1,    14,    15,    16,
+      17,    18,    19,    20,    -1,    22,    23,    -1,    25,    26,
+      27,    28,    29,    30,    -1,    32,    33,    -1,    35,    36,
+      37,    38,    39,    40,    41,    42,    43,    -1,    45,    -1,
+      -1,    48,    49,    50,    51,    52,    53,    -1,    55,    56,
+      -1,    58,    59,    60,    61,    62,    63,    -1,    65,    -1,
+      67,    68,    69,    -1,    -1,    72,    -1,    74,    -1,    -1,
+      77,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    92,    93,    94,    95,    -1,
+      -1,    -1,    -1,   100,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,   109,    -1,   111,    -1,   113,   114,    -1,   116,
+      -1,    -1,   119,    -1,    -1,   122,   123,   124,     1,   126,
+       3,     4,     5,     6,     7,    -1,    -1,    10,    11,    12,
+      -1,    14,    15,    16,    17,    18,    19,    20,    -1,    22,
+      23,    -1,    25,    26,    27,    28,    29,    30,    -1,    32,
+      33,    -1,    35,    36,    37,    38,    39,    40,    41,    42,
+      43,    -1,    45,    -1,    -1,    48,    49,    50,    51,    52,
+      53,    -1,    55,    56,    -1,    58,    59,    60,    61,    62,
+      63,    -1,    65,    -1,    67,    68,    69,    -1,    -1,    72,
+      -1,    74,    -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    92,
+      93,    94,    95,    -1,    -1,    -1,    -1,   100,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,   109,    -1,   111,    -1,
+     113,   114,    -1,   116,    -1,    -1,   119,    -1,    -1,   122,
+     123,   124,     1,   126,     3,     4,     5,     6,     7,    -1,
+      -1,    10,    11,    12,    -1,    14,    15,    16,    17,    18,
+      19,    20,    -1,    22,    23,    -1,    25,    26,    27,    28,
+      29,    30,    -1,    32,    33,    -1,    35,    36,    37,    38,
+      39,    40,    41,    42,    43,    -1,    45,    -1,    -1,    48,
+      49,    50,    51,    52,    53,    -1,    55,    56,    -1,    58,
+      59,    60,    61,    62,    63,    -1,    65,    -1,    67,    68,
+      69,    -1,    -1,    72,    -1,    74,    -1,    -1,    77,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    92,    93,    94,    95,    -1,    -1,    -1,
+      -1,   100,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+     109,    -1,   111,    -1,   113,   114,    -1,   116,    -1,    -1,
+     119,    -1,    -1,   122,   123,   124,     1,   126,     3,     4,
+       5,     6,     7,    -1,    -1,    10,    11,    12,    -1,    14,
+      15,    16,    17,    18,    19,    20,    -1,    22,    23,    -1,
+      25,    26,    27,    28,    29,    30,    -1,    32,    33,    -1,
+      35,    36,    37,    38,    39,    40,    41,    42,    43,    -1,
+      45,    -1,    -1,    48,    49,    50,    51,    52,    53,    -1,
+      55,    56,    -1,    58,    59,    60,    61,    62,    63,    -1,
+      65,    -1,    67,    68,    69,    -1,    -1,    72,    -1,    74,
+      -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    92,    93,    94,
+      95,    -1,    -1,    -1,    -1,   100,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,   109,    -1,   111,    -1,   113,   114,
+      -1,   116,    -1,    -1,   119,    -1,    -1,   122,   123,   124,
+       1,   126,     3,     4,     5,     6,     7,    -1,    -1,    10,
+      11,    12,    -1,    14,    15,    16,    17,    18,    19,    20,
+      -1,    22,    23,    -1,    25,    26,    27,    28,    29,    30,
+      -1,    32,    33,    -1,    35,    36,    37,    38,    39,    40,
+      41,    42,    43,    -1,    45,    -1,    -1,    48,    49,    50,
+      51,    52,    53,    -1,    55,    56,    -1,    58,    59,    60,
+      61,    62,    63,    -1,    65,    -1,    67,    68,    69,    -1,
+      -1,    72,    -1,    74,    -1,    -1,    77,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    92,    93,    94,    95,    -1,    -1,    -1,    -1,   100,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,   109,    -1,
+     111,    -1,   113,   114,    -1,   116,    -1,    -1,   119,    -1,
+      -1,   122,    -1,   124,     1,   126,     3,     4,     5,     6,
+       7,    -1,    -1,    10,    11,    12,    -1,    14,    15,    16,
+      17,    18,    19,    20,    -1,    22,    23,    -1,    25,    26,
+      27,    28,    29,    30,    -1,    32,    33,    -1,    35,    36,
+      37,    38,    39,    40,    41,    42,    43,    -1,    45,    -1,
+      -1,    48,    49,    -1,    51,    52,    53,    -1,    55,    56,
+      -1,    58,    59,    60,    61,    62,    63,    -1,    65,    -1,
+      67,    68,    69,    -1,    -1,    72,    -1,    74,    -1,    -1,
+      77,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    92,    93,    94,    95,    -1,
+      -1,    -1,    -1,   100,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,   109,    -1,   111,    -1,   113,   114,    -1,   116,
+      -1,    -1,   119,    -1,    -1,   122,    -1,   124,     1,   126,
+       3,     4,     5,     6,     7,    -1,    -1,    10,    11,    12,
+      -1,    14,    15,    16,    17,    18,    19,    20,    -1,    22,
+      23,    -1,    25,    26,    27,    28,    29,    30,    -1,    32,
+      33,    -1,    35,    36,    37,    38,    39,    40,    41,    42,
+      43,    -1,    45,    -1,    -1,    48,    49,    -1,    51,    52,
+      53,    -1,    55,    56,    -1,    58,    59,    60,    61,    62,
+      63,    -1,    65,    -1,    67,    68,    69,    -1,    -1,    72,
+      -1,    74,    -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    92,
+      93,    94,    95,    -1,    -1,    -1,    -1,   100,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,   109,    -1,   111,    -1,
+     113,   114,    -1,   116,    -1,    -1,   119,    -1,    -1,   122,
+      -1,   124,     1,   126,     3,     4,     5,     6,     7,    -1,
+      -1,    10,    11,    12,    -1,    14,    15,    16,    17,    18,
+      19,    20,    -1,    22,    23,    -1,    25,    26,    27,    28,
+      29,    30,    -1,    32,    33,    -1,    35,    36,    37,    38,
+      39,    40,    41,    42,    43,    -1,    45,    -1,    -1,    48,
+      49,    -1,    51,    52,    53,    -1,    55,    56,    -1,    58,
+      59,    60,    61,    62,    63,    -1,    65,    -1,    67,    68,
+      69,    -1,    -1,    72,    -1,    74,    -1,    -1,    77,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    92,    93,    94,    95,    -1,    -1,    -1,
+      -1,   100,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+     109,    -1,   111,    -1,   113,   114,    -1,   116,    -1,    -1,
+     119,    -1,    -1,   122,    -1,   124,     1,   126,     3,     4,
+       5,     6,     7,    -1,    -1,    10,    11,    12,    -1,    14,
+      15,    16,    17,    18,    19,    20,    -1,    22,    23,    -1,
+      25,    26,    27,    28,    29,    30,    -1,    32,    33,    -1,
+      35,    36,    37,    38,    39,    40,    41,    42,    43,    -1,
+      45,    -1,    -1,    48,    49,    -1,    51,    52,    53,    -1,
+      55,    56,    -1,    58,    59,    60,    61,    62,    63,    -1,
+      65,    -1,    67,    68,    69,    -1,    -1,    72,    -1,    74,
+      -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    92,    93,    94,
+      95,    -1,    -1,    -1,    -1,   100,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,   109,    -1,   111,    -1,   113,   114,
+      -1,   116,    -1,    -1,   119,    -1,    -1,   122,    -1,   124,
+       1,   126,     3,     4,     5,     6,     7,    -1,    -1,    10,
+      11,    12,    -1,    14,    15,    16,    17,    18,    19,    20,
+      -1,    22,    23,    -1,    25,    26,    27,    28,    29,    30,
+      -1,    32,    33,    -1,    35,    36,    37,    38,    39,    40,
+      41,    42,    43,    -1,    45,    -1,    -1,    48,    49,    -1,
+      51,    52,    53,    -1,    55,    56,    -1,    58,    59,    60,
+      61,    62,    63,    -1,    65,    -1,    67,    68,    69,    -1,
+      -1,    72,    -1,    74,    -1,    -1,    77,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    92,    93,    94,    95,    -1,    -1,    -1,    -1,   100,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,   109,    -1,
+     111,    -1,   113,   114,    -1,   116,    -1,    -1,   119,    -1,
+      -1,   122,    -1,   124,     1,   126,     3,     4,     5,     6,
+       7,    -1,    -1,    10,    11,    12,    -1,    14,    15,    16,
+      17,    18,    19,    20,    -1,    22,    23,    -1,    25,    26,
+      27,    28,    29,    30,    -1,    32,    33,    -1,    35,    36,
+      37,    38,    39,    40,    41,    42,    43,    -1,    45,    -1,
+      -1,    48,    49,    -1,    51,    52,    53,    -1,    55,    56,
+      -1,    58,    59,    60,    61,    62,    63,    -1,    65,    -1,
+      67,    68,    69,    -1,    -1,    72,    -1,    74,    -1,    -1,
+      77,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    92,    93,    94,    95,    -1,
+      -1,    -1,    -1,   100,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,   109,    -1,   111,    -1,   113,   114,    -1,   116,
+      -1,    -1,   119,    -1,    -1,   122,    -1,   124,     1,   126,
+       3,     4,     5,     6,     7,    -1,    -1,    10,    11,    12,
+      -1,    14,    15,    16,    17,    18,    19,    20,    -1,    22,
+      23,    -1,    25,    26,    27,    28,    29,    30,    -1,    32,
+      33,    -1,    35,    36,    37,    38,    39,    40,    41,    42,
+      43,    -1,    45,    -1,    -1,    48,    49,    -1,    51,    52,
+      53,    -1,    55,    56,    -1,    58,    59,    60,    61,    62,
+      63,    -1,    65,    -1,    67,    68,    69,    -1,    -1,    72,
+      -1,    74,    -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    92,
+      93,    94,    95,    -1,    -1,    -1,    -1,   100,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,   109,    -1,   111,    -1,
+     113,   114,    -1,   116,    -1,    -1,   119,    -1,    -1,   122,
+      -1,   124,     1,   126,     3,     4,     5,     6,     7,    -1,
+      -1,    10,    11,    12,    -1,    14,    15,    16,    17,    18,
+      19,    20,    -1,    22,    23,    -1,    25,    26,    27,    28,
+      29,    30,    -1,    32,    33,    -1,    35,    36,    37,    38,
+      39,    40,    41,    42,    43,    -1,    45,    -1,    -1,    48,
+      49,    -1,    51,    52,    53,    -1,    55,    56,    -1,    58,
+      59,    60,    61,    62,    63,    -1,    65,    -1,    67,    68,
+      69,    -1,    -1,    72,    -1,    74,    -1,    -1,    77,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    92,    93,    94,    95,    -1,    -1,    -1,
+      -1,   100,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+     109,    -1,   111,    -1,   113,   114,    -1,   116,    -1,    -1,
+     119,    -1,    -1,   122,    -1,   124,     1,   126,     3,     4,
+       5,     6,     7,    -1,    -1,    10,    11,    12,    -1,    14,
+      15,    16,    17,    18,    19,    20,    -1,    22,    23,    -1,
+      25,    26,    27,    28,    29,    30,    -1,    32,    33,    -1,
+      35,    36,    37,    38,    39,    40,    41,    42,    43,    -1,
+      45,    -1,    -1,    48,    49,    -1,    51,    52,    53,    -1,
+      55,    56,    -1,    58,    59,    60,    61,    62,    63,    -1,
+      65,    -1,    67,    68,    69,    -1,    -1,    72,    -1,    74,
+      -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    92,    93,    94,
+      95,    -1,    -1,    -1,    -1,   100,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,   109,    -1,   111,    -1,   113,   114,
+      -1,   116,    -1,    -1,   119,    -1,    -1,   122,    -1,   124,
+       1,   126,     3,     4,     5,     6,     7,    -1,     9,    10,
+      -1,    -1,    13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      21,    -1,    23,    -1,    -1,    -1,    -1,    28,    29,    30,
+      -1,    32,    -1,    -1,    -1,    -1,    37,    38,    -1,    40,
+      -1,    42,    43,    -1,    -1,    -1,    -1,    -1,    49,    -1,
+      51,    -1,    -1,    54,    -1,    -1,    57,    -1,    -1,    60,
+      61,    62,    63,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    92,    93,    94,    95,    96,    -1,    98,    99,   100,
+      -1,   102,   103,   104,   105,   106,   107,   108,   109,   110,
+     111,   112,   113,   114,    -1,    -1,   117,   118,   119,    -1,
+      -1,   122,    -1,   124,     1,   126,     3,     4,     5,     6,
+       7,    -1,    -1,    10,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    23,    -1,    -1,    -1,
+      -1,    28,    29,    30,    -1,    32,    -1,    -1,    -1,    -1,
+      37,    38,    -1,    40,    -1,    42,    43,    -1,    -1,    -1,
+      -1,    -1,    49,    -1,    51,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    60,    61,    62,    63,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      77,    -1,     1,    -1,     3,     4,     5,     6,     7,    -1,
+      -1,    10,    -1,    -1,    -1,    92,    93,    94,    95,    -1,
+      -1,    -1,    -1,   100,    23,    -1,    -1,    -1,    -1,    28,
+      29,    30,   109,    32,   111,    -1,   113,   114,    37,    38,
+      -1,    40,   119,    42,    43,   122,    -1,   124,    -1,   126,
+      49,    -1,    51,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    60,    61,    62,    63,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    77,    -1,
+      -1,    -1,     3,     4,     5,     6,     7,    -1,    -1,    10,
+      -1,    -1,    -1,    92,    93,    94,    95,    -1,    -1,    -1,
+      -1,   100,    23,    -1,    -1,    -1,    -1,    28,    29,    30,
+     109,    32,   111,    -1,   113,   114,    37,    38,    -1,    40,
+     119,    42,    43,   122,    -1,   124,    -1,   126,    49,    -1,
+      51,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,
+      61,    62,    63,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    92,    93,    94,    95,    -1,    -1,    -1,    -1,   100,
+      -1,    -1,     3,     4,     5,     6,     7,    -1,   109,    10,
+     111,    -1,   113,   114,   115,    -1,    -1,    -1,   119,    -1,
+      -1,   122,    23,   124,    -1,   126,   127,    28,    29,    30,
+      -1,    32,    -1,    -1,    -1,    -1,    37,    38,    -1,    40,
+      -1,    42,    43,    -1,    -1,    -1,    -1,    -1,    49,    -1,
+      51,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,
+      61,    62,    63,    -1,    -1,    66,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    92,    93,    94,    95,    -1,    -1,    -1,    -1,   100,
+     101,    -1,     3,     4,     5,     6,     7,    -1,   109,    10,
+     111,    -1,   113,   114,   115,    -1,    -1,    -1,   119,    -1,
+      -1,   122,    23,   124,    -1,   126,    -1,    28,    29,    30,
+      -1,    32,    -1,    -1,    -1,    -1,    37,    38,    -1,    40,
+      -1,    42,    43,    -1,    -1,    -1,    -1,    -1,    49,    -1,
+      51,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,
+      61,    62,    63,    -1,    -1,    66,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    92,    93,    94,    95,    -1,    -1,    -1,    -1,   100,
+      -1,    -1,     3,     4,     5,     6,     7,    -1,   109,    10,
+     111,    -1,   113,   114,   115,    -1,    -1,    -1,   119,    -1,
+      -1,   122,    23,   124,   125,   126,    -1,    28,    29,    30,
+      -1,    32,    -1,    -1,    -1,    -1,    37,    38,    -1,    40,
+      -1,    42,    43,    -1,    -1,    -1,    -1,    48,    49,    -1,
+      51,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,
+      61,    62,    63,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    75,    -1,    77,    -1,    -1,    -1,
+       3,     4,     5,     6,     7,    -1,    -1,    10,    -1,    -1,
+      -1,    92,    93,    94,    95,    -1,    -1,    -1,    -1,   100,
+      23,    -1,    -1,    -1,    -1,    28,    29,    30,   109,    32,
+     111,    -1,   113,   114,    37,    38,    -1,    40,   119,    42,
+      43,   122,    -1,   124,    -1,   126,    49,    -1,    51,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,    61,    62,
+      63,    -1,    -1,    66,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    92,
+      93,    94,    95,    -1,    -1,    -1,    -1,   100,    -1,    -1,
+       3,     4,     5,     6,     7,    -1,   109,    10,   111,    -1,
+     113,   114,   115,    -1,    -1,    -1,   119,    -1,    -1,   122,
+      23,   124,    -1,   126,    -1,    28,    29,    30,    -1,    32,
+      -1,    -1,    -1,    -1,    37,    38,    -1,    40,    -1,    42,
+      43,    -1,    -1,    -1,    -1,    -1,    49,    -1,    51,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,    61,    62,
+      63,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    92,
+      93,    94,    95,    -1,    -1,    -1,    -1,   100,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,   109,    -1,   111,    -1,
+     113,   114,    -1,   116,    -1,    -1,   119,    -1,    -1,   122,
+      -1,   124,    -1,   126,     3,     4,     5,     6,     7,    -1,
+      -1,    10,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    22,    23,    -1,    -1,    -1,    -1,    28,
+      29,    30,    -1,    32,    -1,    -1,    -1,    -1,    37,    38,
+      -1,    40,    -1,    42,    43,    -1,    -1,    -1,    -1,    -1,
+      49,    -1,    51,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    60,    61,    62,    63,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    77,    -1,
+      -1,    -1,     3,     4,     5,     6,     7,    -1,    -1,    10,
+      -1,    -1,    -1,    92,    93,    94,    95,    -1,    -1,    -1,
+      -1,   100,    23,    -1,    -1,    -1,    -1,    28,    29,    30,
+     109,    32,   111,    -1,   113,   114,    37,    38,    -1,    40,
+     119,    42,    43,   122,    -1,   124,    -1,   126,    49,    -1,
+      51,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,
+      61,    62,    63,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    92,    93,    94,    95,    -1,    -1,    -1,    -1,   100,
+      -1,    -1,     3,     4,     5,     6,     7,    -1,   109,    10,
+     111,    -1,   113,   114,   115,    -1,    -1,    -1,   119,    -1,
+      -1,   122,    23,   124,    -1,   126,    -1,    28,    29,    30,
+      -1,    32,    -1,    -1,    -1,    -1,    37,    38,    -1,    40,
+      -1,    42,    43,    -1,    -1,    -1,    -1,    -1,    49,    -1,
+      51,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,
+      61,    62,    63,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    75,    -1,    77,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    92,    93,    94,    95,    -1,    -1,    -1,    -1,   100,
+      -1,    -1,     3,     4,     5,     6,     7,    -1,   109,    10,
+     111,    -1,   113,   114,    -1,    -1,    -1,    -1,   119,    -1,
+      -1,   122,    23,   124,    -1,   126,    -1,    28,    29,    30,
+      -1,    32,    -1,    -1,    -1,    -1,    37,    38,    -1,    40,
+      -1,    42,    43,    44,    -1,    -1,    -1,    -1,    49,    -1,
+      51,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,
+      61,    62,    63,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,
+       3,     4,     5,     6,     7,    -1,    -1,    10,    -1,    -1,
+      -1,    92,    93,    94,    95,    -1,    -1,    -1,    -1,   100,
+      23,    -1,    -1,    -1,    -1,    28,    29,    30,   109,    32,
+     111,    -1,   113,   114,    37,    38,    -1,    40,   119,    42,
+      43,   122,    -1,   124,    -1,   126,    49,    -1,    51,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,    61,    62,
+      63,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    92,
+      93,    94,    95,    -1,    -1,    -1,    -1,   100,    -1,    -1,
+       3,     4,     5,     6,     7,    -1,   109,    10,   111,    -1,
+     113,   114,   115,    -1,    -1,    -1,   119,    -1,    -1,   122,
+      23,   124,    -1,   126,    -1,    28,    29,    30,    -1,    32,
+      -1,    -1,    -1,    -1,    37,    38,    -1,    40,    -1,    42,
+      43,    -1,    -1,    -1,    -1,    -1,    49,    -1,    51,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,    61,    62,
+      63,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    92,
+      93,    94,    95,    -1,    -1,    -1,    -1,   100,    -1,    -1,
+       3,     4,     5,     6,     7,    -1,   109,    10,   111,    -1,
+     113,   114,   115,    -1,    -1,    -1,   119,    -1,    -1,   122,
+      23,   124,    -1,   126,    -1,    28,    29,    30,    -1,    32,
+      -1,    -1,    -1,    -1,    37,    38,    -1,    40,    -1,    42,
+      43,    -1,    -1,    -1,    -1,    -1,    49,    -1,    51,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,    61,    62,
+      63,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    92,
+      93,    94,    95,    -1,    -1,    -1,    -1,   100,    -1,    -1,
+       3,     4,     5,     6,     7,    -1,   109,    10,   111,    -1,
+     113,   114,   115,    -1,    -1,    -1,   119,    -1,    -1,   122,
+      23,   124,    -1,   126,    -1,    28,    29,    30,    -1,    32,
+      -1,    -1,    -1,    -1,    37,    38,    -1,    40,    -1,    42,
+      43,    -1,    -1,    -1,    -1,    -1,    49,    -1,    51,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,    61,    62,
+      63,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,     3,     4,
+       5,     6,     7,    -1,    -1,    10,    -1,    -1,    -1,    92,
+      93,    94,    95,    -1,    -1,    -1,    -1,   100,    23,    -1,
+      -1,    -1,    -1,    28,    29,    30,   109,    32,   111,    -1,
+     113,   114,    37,    38,    -1,    40,   119,    42,    43,   122,
+      -1,   124,    -1,   126,    49,    -1,    51,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    60,    61,    62,    63,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    77,    -1,    -1,    -1,     3,     4,     5,     6,
+       7,    -1,    -1,    10,    -1,    -1,    -1,    92,    93,    94,
+      95,    -1,    -1,    -1,    -1,   100,    23,    -1,    -1,    -1,
+      -1,    28,    29,    30,   109,    32,   111,    -1,   113,   114,
+      37,    38,    -1,    40,   119,    42,    43,   122,    -1,   124,
+      -1,   126,    49,    -1,    51,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    60,    61,    62,    63,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      77,    -1,    -1,    -1,     3,     4,     5,     6,     7,    -1,
+      -1,    10,    -1,    -1,    -1,    92,    93,    94,    95,    -1,
+      -1,    -1,    -1,   100,    23,    -1,    -1,    -1,    -1,    28,
+      29,    30,   109,    32,   111,    -1,   113,   114,    37,    38,
+      -1,    40,   119,    42,    43,   122,    -1,   124,    -1,   126,
+      49,    -1,    51,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    60,    61,    62,    63,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    77,    -1,
+      -1,    -1,     3,     4,     5,     6,     7,    -1,    -1,    10,
+      -1,    -1,    -1,    92,    93,    94,    95,    -1,    -1,    -1,
+      -1,   100,    23,    -1,    -1,    -1,    -1,    28,    29,    30,
+     109,    32,   111,    -1,   113,   114,    37,    38,    -1,    40,
+     119,    42,    43,   122,    -1,   124,    -1,   126,    49,    -1,
+      51,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,
+      61,    62,    63,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,
+       3,     4,     5,     6,     7,    -1,    -1,    10,    -1,    -1,
+      -1,    92,    93,    94,    95,    -1,    -1,    -1,    -1,   100,
+      23,    -1,    -1,    -1,    -1,    28,    29,    30,   109,    32,
+     111,    -1,   113,   114,    37,    38,    -1,    40,   119,    42,
+      43,   122,    -1,   124,    -1,   126,    49,    -1,    51,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    60,    61,    62,
+      63,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    77,    -1,    -1,    -1,     3,     4,
+       5,     6,     7,    -1,    -1,    10,    -1,    -1,    -1,    92,
+      93,    94,    95,    -1,    -1,    -1,    -1,   100,    23,    -1,
+      -1,    -1,    -1,    28,    29,    30,   109,    32,   111,    -1,
+     113,   114,    37,    38,    -1,    40,   119,    42,    43,   122,
+      -1,   124,    -1,   126,    49,    -1,    51,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    60,    61,    62,    63,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    77,    -1,    -1,    -1,     3,     4,     5,     6,
+       7,    -1,    -1,    10,    -1,    -1,    -1,    92,    93,    94,
+      95,    -1,    -1,    -1,    -1,   100,    23,    -1,    -1,    -1,
+      -1,    28,    29,    30,   109,    32,   111,    -1,   113,   114,
+      37,    38,    -1,    40,   119,    42,    43,   122,    -1,   124,
+      -1,   126,    49,    -1,    51,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    60,    61,    62,    63,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      77,    -1,    -1,    -1,     3,     4,     5,     6,     7,    -1,
+      -1,    10,    -1,    -1,    -1,    92,    93,    94,    95,    -1,
+      -1,    -1,    -1,   100,    23,    -1,    -1,    -1,    -1,    28,
+      29,    30,   109,    32,   111,    -1,   113,   114,    37,    38,
+      -1,    40,   119,    42,    43,   122,    -1,   124,    -1,   126,
+      49,    -1,    51,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    60,    61,    62,    63,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    77,    -1,
+      -1,    -1,     3,     4,     5,     6,     7,    -1,    -1,    10,
+      -1,    -1,    -1,    92,    93,    94,    95,    -1,    -1,    -1,
+      -1,   100,    23,    -1,    -1,    -1,    -1,    28,    29,    30,
+     109,    32,   111,    -1,   113,   114,    37,    38,    -1,    40,
+     119,    42,    43,   122,    -1,   124,    -1,   126,    49,    -1,
+      51,    -1,    -1,    -1,    -1,    -1,    -1,     3,    -1,    60,
+      61,    62,    63,     9,    -1,    -1,    -1,    13,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    78,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    93,    -1,    -1,    -1,    97,    -1,    -1,    -1,
+     101,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+     111,    -1,    -1,    -1,   115,    -1,    -1,    -1,    -1,    -1,
+      -1,   122,    -1,   124,   125,   126,    -1,    -1,    -1,    -1,
+      -1,    -1,    78,    79,    80,    81,    82,    83,    -1,    -1,
+      86,    87,    88,    89,    90,    91,    92,    93,    94,    95,
+      -1,    -1,    98,    -1,    -1,    -1,   102,   103,   104,   105,
+     106,   107,   108,   109,   110,   111,   112,    -1,   114,    -1,
+      -1,   117,   118,   119,   120,   121,     9,    -1,    -1,    -1,
+      13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+       9,    -1,    -1,    -1,    13,    -1,    -1,    -1,    -1,    -1,
+      -1,    54,    21,    -1,    57,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      73,    -1,    -1,    -1,    77,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    54,    -1,    -1,    57,    92,
+      -1,    94,    95,    96,    -1,    98,    99,   100,    -1,   102,
+     103,   104,   105,   106,   107,   108,   109,   110,    77,   112,
+     113,   114,    -1,    -1,   117,   118,   119,    -1,    -1,    -1,
+      -1,    -1,    -1,    92,   127,    94,    95,    96,    -1,    98,
+      99,   100,    -1,   102,   103,   104,   105,   106,   107,   108,
+     109,   110,     9,   112,   113,   114,    13,    -1,   117,   118,
+     119,    -1,    -1,    -1,    21,    -1,    -1,    -1,   127,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,    -1,    -1,
+      13,    -1,    -1,    -1,    -1,    -1,    -1,    54,    21,    -1,
+      57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      77,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    54,    -1,    -1,    57,    92,    -1,    94,    95,    96,
+      -1,    98,    99,   100,    -1,   102,   103,   104,   105,   106,
+     107,   108,   109,   110,    77,   112,   113,   114,    -1,    -1,
+     117,   118,   119,    -1,    -1,    -1,    -1,    -1,    -1,    92,
+     127,    94,    95,    96,    -1,    98,    99,   100,    -1,   102,
+     103,   104,   105,   106,   107,   108,   109,   110,     9,   112,
+     113,   114,    13,    -1,   117,   118,   119,    -1,    -1,    -1,
+      21,    22,   125,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      31,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,     9,    -1,    -1,    -1,    13,    -1,    -1,    -1,
+      -1,    -1,    -1,    54,    21,    22,    57,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    31,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    73,    -1,    -1,    -1,    77,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    54,    -1,    -1,
+      57,    92,    -1,    94,    95,    96,    -1,    98,    99,   100,
+      -1,   102,   103,   104,   105,   106,   107,   108,   109,   110,
+      77,   112,   113,   114,    -1,    -1,   117,   118,   119,    -1,
+      -1,   122,    -1,    -1,    -1,    92,    -1,    94,    95,    96,
+      -1,    98,    99,   100,    -1,   102,   103,   104,   105,   106,
+     107,   108,   109,   110,     9,   112,   113,   114,    13,    -1,
+     117,   118,   119,    -1,    -1,   122,    21,    22,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    54,
+      -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    73,    -1,
+       9,    -1,    77,    -1,    13,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    21,    -1,    -1,    -1,    -1,    92,    -1,    94,
+      95,    96,    -1,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,    -1,   112,   113,   114,
+      -1,    -1,   117,   118,   119,    54,    -1,   122,    57,    -1,
+      -1,    -1,    -1,    -1,    -1,    64,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,    77,    -1,
+      13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    21,    22,
+      -1,    -1,    -1,    92,    -1,    94,    95,    96,    -1,    98,
+      99,   100,    -1,   102,   103,   104,   105,   106,   107,   108,
+     109,   110,    -1,   112,   113,   114,    -1,    -1,   117,   118,
+     119,    54,    -1,   122,    57,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,     9,    -1,    77,    -1,    13,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    21,    22,    -1,    -1,    -1,    92,
+      -1,    94,    95,    96,    -1,    98,    99,   100,    -1,   102,
+     103,   104,   105,   106,   107,   108,   109,   110,    -1,   112,
+     113,   114,    -1,    -1,   117,   118,   119,    54,    -1,   122,
+      57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,
+      77,    -1,    13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      21,    -1,    -1,    -1,    -1,    92,    -1,    94,    95,    96,
+      -1,    98,    99,   100,    -1,   102,   103,   104,   105,   106,
+     107,   108,   109,   110,    -1,   112,   113,   114,    -1,    -1,
+     117,   118,   119,    54,    -1,   122,    57,    -1,    -1,    -1,
+      -1,    -1,    -1,    64,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,     9,    -1,    77,    -1,    13,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,
+      -1,    92,    -1,    94,    95,    96,    -1,    98,    99,   100,
+      -1,   102,   103,   104,   105,   106,   107,   108,   109,   110,
+      -1,   112,   113,   114,    -1,    -1,   117,   118,   119,    54,
+      -1,   122,    57,    -1,    -1,    -1,    -1,    -1,    -1,    64,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+       9,    -1,    77,    -1,    13,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    21,    -1,    -1,    -1,    -1,    92,    -1,    94,
+      95,    96,    -1,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,    -1,   112,   113,   114,
+      -1,    -1,   117,   118,   119,    54,    -1,   122,    57,    -1,
+      -1,    -1,    -1,    -1,    -1,    64,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,    77,    -1,
+      13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,
+      -1,    -1,    -1,    92,    -1,    94,    95,    96,    -1,    98,
+      99,   100,    -1,   102,   103,   104,   105,   106,   107,   108,
+     109,   110,    -1,   112,   113,   114,    -1,    -1,   117,   118,
+     119,    54,    -1,   122,    57,    -1,    -1,    -1,    -1,    -1,
+      -1,    64,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,     9,    -1,    77,    -1,    13,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,    -1,    92,
+      -1,    94,    95,    96,    -1,    98,    99,   100,    -1,   102,
+     103,   104,   105,   106,   107,   108,   109,   110,    -1,   112,
+     113,   114,    -1,    -1,   117,   118,   119,    54,    -1,   122,
+      57,    -1,    -1,    -1,    -1,    -1,    -1,    64,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,
+      77,    -1,    13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      21,    -1,    -1,    -1,    -1,    92,    -1,    94,    95,    96,
+      -1,    98,    99,   100,    -1,   102,   103,   104,   105,   106,
+     107,   108,   109,   110,    -1,   112,   113,   114,    -1,    -1,
+     117,   118,   119,    54,    -1,   122,    57,    -1,    -1,    -1,
+      -1,    -1,    -1,    64,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,     9,    -1,    77,    -1,    13,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,
+      -1,    92,    -1,    94,    95,    96,    -1,    98,    99,   100,
+      -1,   102,   103,   104,   105,   106,   107,   108,   109,   110,
+      -1,   112,   113,   114,    -1,    -1,   117,   118,   119,    54,
+      -1,   122,    57,    -1,    -1,    -1,    -1,    -1,    -1,    64,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+       9,    -1,    77,    -1,    13,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    21,    -1,    -1,    -1,    -1,    92,    -1,    94,
+      95,    96,    -1,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,    -1,   112,   113,   114,
+      -1,    -1,   117,   118,   119,    54,    -1,   122,    57,    -1,
+      -1,    -1,    -1,    -1,    -1,    64,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,    77,    -1,
+      13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,
+      -1,    -1,    -1,    92,    -1,    94,    95,    96,    -1,    98,
+      99,   100,    -1,   102,   103,   104,   105,   106,   107,   108,
+     109,   110,    -1,   112,   113,   114,    -1,    -1,   117,   118,
+     119,    54,    -1,   122,    57,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,     9,    -1,    77,    -1,    13,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,    -1,    92,
+      -1,    94,    95,    96,    -1,    98,    99,   100,    -1,   102,
+     103,   104,   105,   106,   107,   108,   109,   110,    -1,   112,
+     113,   114,    -1,    -1,   117,   118,   119,    54,    -1,   122,
+      57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,
+      77,    -1,    13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      21,    -1,    -1,    -1,    -1,    92,    -1,    94,    95,    96,
+      31,    98,    99,   100,    -1,   102,   103,   104,   105,   106,
+     107,   108,   109,   110,    -1,   112,   113,   114,    -1,    -1,
+     117,   118,   119,    54,   121,    -1,    57,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    73,    -1,     9,    -1,    77,    -1,    13,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    21,    22,    -1,    -1,
+      -1,    92,    -1,    94,    95,    96,    31,    98,    99,   100,
+      -1,   102,   103,   104,   105,   106,   107,   108,   109,   110,
+      -1,   112,   113,   114,    -1,    -1,   117,   118,   119,    54,
+      -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+       9,    -1,    77,    -1,    13,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    21,    22,    -1,    -1,    -1,    92,    -1,    94,
+      95,    96,    31,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,    -1,   112,   113,   114,
+      -1,    -1,   117,   118,   119,    54,    -1,    -1,    57,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,    77,    -1,
+      13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,
+      -1,    -1,    -1,    92,    -1,    94,    95,    96,    -1,    98,
+      99,   100,    -1,   102,   103,   104,   105,   106,   107,   108,
+     109,   110,    -1,   112,   113,   114,    -1,    -1,   117,   118,
+     119,    54,    -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,     9,    -1,    77,    -1,    13,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,    -1,    92,
+      -1,    94,    95,    96,    -1,    98,    99,   100,    -1,   102,
+     103,   104,   105,   106,   107,   108,   109,   110,    -1,   112,
+     113,   114,    -1,   116,   117,   118,   119,    54,    -1,    -1,
+      57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,
+      77,    -1,    13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      21,    -1,    -1,    -1,    -1,    92,    -1,    94,    95,    96,
+      -1,    98,    99,   100,    -1,   102,   103,   104,   105,   106,
+     107,   108,   109,   110,    -1,   112,   113,   114,    -1,   116,
+     117,   118,   119,    54,    -1,    -1,    57,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,     9,    -1,    77,    -1,    13,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,
+      -1,    92,    -1,    94,    95,    96,    -1,    98,    99,   100,
+      -1,   102,   103,   104,   105,   106,   107,   108,   109,   110,
+      -1,   112,   113,   114,    -1,   116,   117,   118,   119,    54,
+      -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+       9,    76,    77,    -1,    13,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    21,    -1,    -1,    -1,    -1,    92,    -1,    94,
+      95,    96,    -1,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,    -1,   112,   113,   114,
+      -1,    -1,   117,   118,   119,    54,    -1,    -1,    57,    -1,
+      -1,    -1,    -1,    -1,    -1,    64,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,    77,    -1,
+      13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,
+      -1,    -1,    -1,    92,    -1,    94,    95,    96,    -1,    98,
+      99,   100,    -1,   102,   103,   104,   105,   106,   107,   108,
+     109,   110,    -1,   112,   113,   114,    -1,    -1,   117,   118,
+     119,    54,    -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,     9,    -1,    77,    -1,    13,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,    -1,    92,
+      -1,    94,    95,    96,    -1,    98,    99,   100,    -1,   102,
+     103,   104,   105,   106,   107,   108,   109,   110,    -1,   112,
+     113,   114,    -1,   116,   117,   118,   119,    54,    -1,    -1,
+      57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,
+      77,    -1,    13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      21,    -1,    -1,    -1,    -1,    92,    -1,    94,    95,    96,
+      -1,    98,    99,   100,    -1,   102,   103,   104,   105,   106,
+     107,   108,   109,   110,    -1,   112,   113,   114,    -1,   116,
+     117,   118,   119,    54,    -1,    -1,    57,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,     9,    -1,    77,    -1,    13,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,
+      -1,    92,    -1,    94,    95,    96,    -1,    98,    99,   100,
+      -1,   102,   103,   104,   105,   106,   107,   108,   109,   110,
+      -1,   112,   113,   114,    -1,   116,   117,   118,   119,    54,
+      -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+       9,    -1,    77,    -1,    13,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    21,    -1,    -1,    -1,    -1,    92,    -1,    94,
+      95,    96,    -1,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,    -1,   112,   113,   114,
+      -1,   116,   117,   118,   119,    54,    -1,    -1,    57,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,    77,    -1,
+      13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,
+      -1,    -1,    -1,    92,    -1,    94,    95,    96,    -1,    98,
+      99,   100,    -1,   102,   103,   104,   105,   106,   107,   108,
+     109,   110,    -1,   112,   113,   114,    -1,   116,   117,   118,
+     119,    54,    -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,     9,    -1,    77,    -1,    13,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,    -1,    92,
+      -1,    94,    95,    96,    -1,    98,    99,   100,    -1,   102,
+     103,   104,   105,   106,   107,   108,   109,   110,    -1,   112,
+     113,   114,    -1,   116,   117,   118,   119,    54,    -1,    -1,
+      57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,
+      77,    -1,    13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      21,    -1,    -1,    -1,    -1,    92,    -1,    94,    95,    96,
+      -1,    98,    99,   100,    -1,   102,   103,   104,   105,   106,
+     107,   108,   109,   110,    -1,   112,   113,   114,    -1,   116,
+     117,   118,   119,    54,    -1,    -1,    57,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,     9,    -1,    77,    -1,    13,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,
+      -1,    92,    -1,    94,    95,    96,    -1,    98,    99,   100,
+      -1,   102,   103,   104,   105,   106,   107,   108,   109,   110,
+      -1,   112,   113,   114,    -1,   116,   117,   118,   119,    54,
+      -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+       9,    -1,    77,    -1,    13,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    21,    -1,    -1,    -1,    -1,    92,    -1,    94,
+      95,    96,    -1,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,    -1,   112,   113,   114,
+      -1,   116,   117,   118,   119,    54,    -1,    -1,    57,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,    77,    -1,
+      13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,
+      -1,    -1,    -1,    92,    -1,    94,    95,    96,    -1,    98,
+      99,   100,    -1,   102,   103,   104,   105,   106,   107,   108,
+     109,   110,    -1,   112,   113,   114,    -1,   116,   117,   118,
+     119,    54,    -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,     9,    -1,    77,    -1,    13,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,    -1,    92,
+      -1,    94,    95,    96,    -1,    98,    99,   100,    -1,   102,
+     103,   104,   105,   106,   107,   108,   109,   110,    -1,   112,
+     113,   114,    -1,   116,   117,   118,   119,    54,    -1,    -1,
+      57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,
+      77,    -1,    13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      21,    -1,    -1,    -1,    -1,    92,    -1,    94,    95,    96,
+      -1,    98,    99,   100,    -1,   102,   103,   104,   105,   106,
+     107,   108,   109,   110,    -1,   112,   113,   114,    -1,   116,
+     117,   118,   119,    54,    -1,    -1,    57,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,     9,    -1,    77,    -1,    13,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,
+      -1,    92,    -1,    94,    95,    96,    -1,    98,    99,   100,
+      -1,   102,   103,   104,   105,   106,   107,   108,   109,   110,
+      -1,   112,   113,   114,    -1,   116,   117,   118,   119,    54,
+      -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+       9,    -1,    77,    -1,    13,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    21,    -1,    -1,    -1,    -1,    92,    -1,    94,
+      95,    96,    -1,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,    -1,   112,   113,   114,
+      -1,   116,   117,   118,   119,    54,    -1,    -1,    57,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,    77,    -1,
+      13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,
+      -1,    -1,    -1,    92,    -1,    94,    95,    96,    -1,    98,
+      99,   100,    -1,   102,   103,   104,   105,   106,   107,   108,
+     109,   110,    -1,   112,   113,   114,    -1,   116,   117,   118,
+     119,    54,    -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      73,    -1,     9,    -1,    77,    -1,    13,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,    -1,    92,
+      -1,    94,    95,    96,    -1,    98,    99,   100,    -1,   102,
+     103,   104,   105,   106,   107,   108,   109,   110,    -1,   112,
+     113,   114,    -1,    -1,   117,   118,   119,    54,    -1,    -1,
+      57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,
+      77,    -1,    13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      21,    -1,    -1,    24,    -1,    92,    -1,    94,    95,    96,
+      -1,    98,    99,   100,    -1,   102,   103,   104,   105,   106,
+     107,   108,   109,   110,    -1,   112,   113,   114,    -1,   116,
+     117,   118,   119,    54,    -1,    -1,    57,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,     9,    -1,    77,    -1,    13,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,
+      -1,    92,    -1,    94,    95,    96,    -1,    98,    99,   100,
+      -1,   102,   103,   104,   105,   106,   107,   108,   109,   110,
+      -1,   112,   113,   114,    -1,    -1,   117,   118,   119,    54,
+      -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+       9,    76,    77,    -1,    13,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    21,    22,    -1,    -1,    -1,    92,    -1,    94,
+      95,    96,    -1,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,    -1,   112,   113,   114,
+      -1,    -1,   117,   118,   119,    54,    -1,    -1,    57,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,    77,    -1,
+      13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    21,    22,
+      -1,    -1,    -1,    92,    -1,    94,    95,    96,    -1,    98,
+      99,   100,    -1,   102,   103,   104,   105,   106,   107,   108,
+     109,   110,    -1,   112,   113,   114,    -1,    -1,   117,   118,
+     119,    54,    -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,     9,    -1,    77,    -1,    13,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,    -1,    92,
+      -1,    94,    95,    96,    -1,    98,    99,   100,    -1,   102,
+     103,   104,   105,   106,   107,   108,   109,   110,    -1,   112,
+     113,   114,    -1,    -1,   117,   118,   119,    54,    -1,    -1,
+      57,    -1,    -1,    -1,    -1,    -1,    -1,    64,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,
+      77,    -1,    13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      21,    -1,    -1,    -1,    -1,    92,    -1,    94,    95,    96,
+      -1,    98,    99,   100,    -1,   102,   103,   104,   105,   106,
+     107,   108,   109,   110,    -1,   112,   113,   114,    -1,    -1,
+     117,   118,   119,    54,    -1,    -1,    57,    -1,    -1,    -1,
+      -1,    -1,    -1,    64,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,     9,    -1,    77,    -1,    13,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,
+      -1,    92,    -1,    94,    95,    96,    -1,    98,    99,   100,
+      -1,   102,   103,   104,   105,   106,   107,   108,   109,   110,
+      -1,   112,   113,   114,    -1,    -1,   117,   118,   119,    54,
+      -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,    -1,    64,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+       9,    -1,    77,    -1,    13,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    21,    -1,    -1,    -1,    -1,    92,    -1,    94,
+      95,    96,    -1,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,    -1,   112,   113,   114,
+      -1,    -1,   117,   118,   119,    54,    -1,    -1,    57,    -1,
+      -1,    -1,    -1,    -1,    -1,    64,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,    77,    -1,
+      13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,
+      -1,    -1,    -1,    92,    -1,    94,    95,    96,    -1,    98,
+      99,   100,    -1,   102,   103,   104,   105,   106,   107,   108,
+     109,   110,    -1,   112,   113,   114,    -1,    -1,   117,   118,
+     119,    54,    -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,
+      -1,    64,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,     9,    -1,    77,    -1,    13,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,    -1,    92,
+      -1,    94,    95,    96,    -1,    98,    99,   100,    -1,   102,
+     103,   104,   105,   106,   107,   108,   109,   110,    -1,   112,
+     113,   114,    -1,    -1,   117,   118,   119,    54,    -1,    -1,
+      57,    -1,    -1,    -1,    -1,    -1,    -1,    64,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,     9,    -1,
+      77,    -1,    13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      21,    -1,    -1,    -1,    -1,    92,    -1,    94,    95,    96,
+      -1,    98,    99,   100,    -1,   102,   103,   104,   105,   106,
+     107,   108,   109,   110,    -1,   112,   113,   114,    -1,    -1,
+     117,   118,   119,    54,    -1,    -1,    57,    -1,    -1,    -1,
+      -1,    -1,    -1,    64,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,     9,    -1,    77,    -1,    13,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    21,    -1,    -1,    -1,
+      -1,    92,    -1,    94,    95,    96,    -1,    98,    99,   100,
+      -1,   102,   103,   104,   105,   106,   107,   108,   109,   110,
+      -1,   112,   113,   114,    -1,    -1,   117,   118,   119,    54,
+      -1,    -1,    57,    -1,    -1,    -1,    -1,    -1,    -1,    64,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+       9,    -1,    77,    -1,    13,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    21,    -1,    -1,    -1,    -1,    92,    -1,    94,
+      95,    96,    -1,    98,    99,   100,    -1,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,    -1,   112,   113,   114,
+      -1,    -1,   117,   118,   119,    54,    -1,    -1,    57,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    77,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    92,    -1,    94,    95,    96,    -1,    98,
+      99,   100,    -1,   102,   103,   104,   105,   106,   107,   108,
+     109,   110,    -1,   112,   113,   114,    -1,    -1,   117,   118,
+     119
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_uint8 yystos[] =
+{
+       0,   132,   133,     0,     1,     3,     4,     5,     6,     7,
+      10,    11,    12,    15,    16,    17,    19,    20,    22,    23,
+      25,    26,    27,    28,    29,    30,    32,    33,    36,    37,
+      38,    39,    40,    41,    42,    43,    45,    49,    50,    51,
+      56,    58,    59,    60,    61,    62,    63,    65,    68,    72,
+      74,    77,    92,    93,    94,    95,   100,   109,   111,   113,
+     114,   116,   119,   122,   124,   126,   134,   135,   136,   137,
+     138,   139,   141,   142,   144,   146,   147,   148,   149,   151,
+     152,   155,   156,   157,   161,   164,   167,   168,   188,   191,
+     192,   210,   211,   212,   213,   214,   215,   220,   221,   222,
+     223,   224,   225,   226,   227,   228,   229,   231,   232,   233,
+     234,   235,   136,   223,    73,   216,   217,   143,   144,   216,
+      10,    28,    29,    30,    63,   122,   126,   164,   210,   214,
+     221,   222,   223,   224,   226,   227,    65,   143,   223,   136,
+     124,   144,   144,     8,    65,   144,    48,    75,   150,   223,
+     223,   223,   124,   144,   165,   124,   144,   193,   194,   136,
+     223,   223,   223,   223,     7,   124,   116,   223,   223,    22,
+     139,   145,   223,   223,    62,   124,   136,   223,    58,   144,
+     189,   115,   184,   204,   223,   223,   223,   223,   223,   223,
+     223,   223,   123,   134,   140,   204,    66,   101,   184,   205,
+     206,   223,   204,   223,   230,    50,   136,   144,    14,    53,
+      67,   158,    35,    52,   180,    18,    48,    55,    69,   116,
+     121,     9,    13,    21,    54,    57,    77,    92,    94,    95,
+      96,    98,    99,   100,   102,   103,   104,   105,   106,   107,
+     108,   109,   110,   112,   113,   114,   117,   118,   119,    78,
+      79,    80,    81,    82,    83,    84,    85,    86,    87,    88,
+      89,    90,    91,   120,   124,   126,    54,    57,   124,   136,
+     116,   122,   139,   223,   223,   223,   204,    31,   216,   189,
+     116,   116,    72,   144,   184,   207,   208,   209,   223,   122,
+     189,   144,   124,   145,    22,    31,   145,    22,    31,   145,
+     217,    64,   139,   207,   136,   124,   175,    66,   124,   144,
+     195,   196,     1,    96,   198,   199,    31,    97,   145,   207,
+     116,   122,   136,   145,   124,   207,   204,    78,   190,   116,
+     144,    97,   116,   145,   116,   123,   134,   123,   223,    97,
+     125,    97,   125,    31,   127,   217,    76,    97,   127,     7,
+     122,   144,   169,    55,   193,   193,   193,   193,   223,   223,
+     223,   223,   150,   223,   150,   223,   223,   223,   223,   223,
+     223,   223,    23,    65,   144,   223,   223,   223,   223,   223,
+     223,   223,   223,   223,   223,   223,   223,   223,   223,   223,
+     223,   223,   223,   223,   223,   223,   223,   223,   223,   223,
+     223,   223,   223,   223,   223,   223,   207,   207,   150,   223,
+     150,   223,    18,    31,    34,    47,    48,    55,    65,   178,
+     218,   219,    22,    31,    22,    31,    64,    31,   127,   150,
+     223,   145,   116,   223,    76,    78,   125,    97,   144,   162,
+     163,   116,    31,   204,    30,   223,   150,   223,    30,   223,
+     150,   223,   145,   136,   223,    24,   125,   176,   177,   178,
+     166,   196,    97,   125,     1,   126,   200,   211,    76,    78,
+     197,   223,   194,   125,   153,   207,   125,   122,   126,   200,
+     211,    97,   184,   223,   125,   125,   205,   205,   150,   223,
+     136,   223,   127,   223,   223,   123,   140,    96,   159,    48,
+      55,   171,   179,   193,   116,   116,   116,   116,   116,   116,
+     116,   116,   116,   116,   116,   116,   116,   116,   116,   116,
+     116,   116,   116,   125,   127,    31,    55,   210,    97,   125,
+      30,   150,   223,    30,   150,   223,   150,   223,   216,   216,
+     116,   223,   184,   223,   209,    78,    97,   123,   223,   125,
+     223,    22,   145,    22,   145,   223,    22,   145,   217,    22,
+     145,   217,    24,    24,   136,    97,   125,   124,   144,    18,
+      48,    55,    65,   181,   125,   196,    96,   199,   204,   223,
+      44,   223,    46,    70,   123,   154,   125,   153,   204,   189,
+     127,   217,   127,   217,   136,    76,   123,   204,   122,   170,
+       9,    13,    78,    79,    80,    81,    82,    83,    86,    87,
+      88,    89,    90,    91,    92,    93,    94,    95,    98,   102,
+     103,   104,   105,   106,   107,   108,   109,   110,   111,   112,
+     114,   117,   118,   119,   120,   121,   144,   172,   173,   116,
+     219,   223,    22,    22,   223,    22,    22,   127,   127,   145,
+     145,   223,   163,   145,    64,    30,   223,    30,   223,    64,
+      30,   223,   145,    30,   223,   145,   136,   223,   177,   196,
+      96,   203,   199,   197,    31,   127,   136,   204,   123,   127,
+      30,   136,   223,   127,    30,   136,   223,   127,   223,   160,
+     181,   144,    99,   124,   174,   174,    64,    30,    30,    64,
+      30,    30,    30,    30,   223,   223,   223,   223,   223,   223,
+     125,    23,    60,    63,   126,   184,   202,   211,   101,   186,
+     197,    71,   187,   223,   200,   211,   145,   223,   136,   223,
+     136,    27,    65,   123,   135,   147,   199,   144,   172,   173,
+     176,   223,   223,   223,   223,   223,   223,    64,    64,    64,
+      64,   203,   127,   204,   184,   185,   223,   223,   139,   146,
+     183,   127,    64,    64,   147,   187,   174,   174,   125,    64,
+      64,    64,    64,    64,    64,   223,   223,   223,   223,   186,
+     197,   184,   201,   202,   211,    31,   127,   211,   223,   223,
+     116,   182,   183,   223,   201,   202,   127,   201
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_uint8 yyr1[] =
+{
+       0,   131,   132,   133,   133,   134,   134,   135,   135,   136,
+     136,   136,   136,   136,   136,   136,   136,   136,   136,   136,
+     136,   136,   136,   136,   136,   136,   136,   136,   136,   136,
+     136,   136,   136,   136,   136,   137,   137,   138,   139,   139,
+     140,   140,   141,   142,   142,   142,   142,   142,   142,   142,
+     142,   142,   142,   142,   142,   142,   142,   142,   143,   143,
+     144,   145,   145,   146,   146,   147,   147,   147,   147,   147,
+     147,   148,   149,   149,   149,   149,   149,   149,   149,   149,
+     149,   149,   149,   149,   149,   149,   149,   149,   149,   149,
+     149,   149,   149,   149,   150,   151,   151,   151,   151,   152,
+     153,   153,   154,   154,   155,   156,   157,   157,   158,   158,
+     158,   159,   159,   160,   160,   160,   161,   162,   162,   162,
+     163,   163,   165,   166,   164,   167,   167,   167,   167,   167,
+     167,   169,   170,   168,   171,   171,   171,   171,   172,   172,
+     172,   172,   172,   172,   172,   172,   172,   172,   172,   172,
+     172,   172,   172,   172,   172,   172,   172,   172,   172,   172,
+     172,   172,   172,   172,   173,   173,   173,   173,   173,   173,
+     173,   173,   173,   173,   173,   173,   174,   174,   175,   176,
+     176,   176,   177,   177,   177,   177,   178,   178,   178,   178,
+     178,   178,   178,   178,   178,   178,   179,   179,   179,   180,
+     180,   181,   181,   181,   181,   181,   182,   182,   183,   183,
+     184,   184,   185,   185,   186,   186,   187,   187,   188,   188,
+     188,   189,   189,   190,   190,   190,   191,   191,   191,   191,
+     191,   192,   192,   192,   193,   193,   194,   194,   194,   195,
+     195,   195,   196,   196,   196,   197,   197,   197,   198,   198,
+     199,   199,   199,   199,   200,   200,   200,   200,   201,   201,
+     201,   202,   202,   202,   202,   202,   203,   203,   203,   203,
+     203,   203,   203,   204,   204,   204,   204,   205,   205,   205,
+     206,   206,   207,   207,   208,   208,   209,   209,   209,   209,
+     209,   210,   211,   211,   211,   211,   211,   211,   211,   211,
+     211,   211,   211,   211,   212,   212,   212,   212,   212,   212,
+     212,   212,   212,   212,   212,   212,   212,   212,   212,   212,
+     212,   213,   214,   215,   215,   215,   215,   215,   215,   215,
+     215,   216,   216,   217,   218,   218,   219,   220,   220,   221,
+     222,   223,   223,   223,   223,   223,   223,   223,   223,   223,
+     223,   223,   223,   223,   223,   224,   224,   224,   224,   225,
+     225,   226,   226,   226,   227,   227,   227,   228,   228,   228,
+     229,   229,   229,   229,   229,   229,   229,   230,   230,   231,
+     231,   231,   231,   231,   231,   231,   231,   231,   231,   231,
+     231,   231,   231,   231,   231,   231,   231,   231,   231,   231,
+     231,   231,   232,   232,   232,   232,   232,   232,   233,   233,
+     233,   233,   234,   234,   234,   234,   235,   235,   235,   235,
+     235,   235,   235
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     0,     2,     1,     2,     2,     3,     1,
+       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       2,     2,     3,     3,     3,     3,     3,     3,     2,     3,
+       3,     2,     2,     3,     1,     4,     5,     1,     2,     3,
+       1,     2,     3,     4,     4,     4,     4,     4,     4,     4,
+       4,     4,     4,     4,     4,     4,     4,     4,     0,     1,
+       1,     2,     1,     2,     3,     1,     1,     1,     1,     1,
+       1,     2,     5,     3,     6,     6,     4,     5,     5,     3,
+       3,     6,     5,     6,     5,     6,     3,     4,     6,     7,
+       6,     7,     4,     5,     4,     4,     3,     6,     5,     5,
+       0,     2,     3,     2,     6,     7,     0,     1,     1,     1,
+       1,     0,     2,     0,     2,     3,     5,     1,     2,     3,
+       1,     3,     0,     0,     8,     0,     1,     1,     2,     1,
+       2,     0,     0,     9,     3,     3,     5,     5,     1,     2,
+       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       1,     1,     1,     1,     1,     1,     0,     3,     3,     0,
+       1,     3,     4,     4,     6,     6,     0,     1,     1,     1,
+       1,     2,     2,     1,     1,     1,     0,     1,     1,     1,
+       1,     0,     1,     1,     1,     1,     1,     1,     1,     1,
+       2,     1,     0,     1,     2,     2,     0,     2,     3,     4,
+       4,     2,     4,     0,     2,     2,     4,     4,     4,     5,
+       4,     0,     1,     1,     1,     3,     3,     4,     5,     1,
+       1,     3,     1,     2,     3,     0,     2,     2,     0,     4,
+       0,     2,     2,     1,     4,     4,     6,     1,     0,     1,
+       1,     3,     4,     3,     4,     6,     0,     2,     2,     2,
+       2,     2,     2,     1,     1,     3,     3,     1,     1,     1,
+       3,     3,     0,     1,     1,     3,     3,     3,     3,     1,
+       1,     1,     1,     1,     1,     1,     1,     2,     4,     4,
+       4,     5,     2,     2,     6,     6,     4,     9,     9,     7,
+       6,     6,     4,     9,     9,     7,     4,     6,     6,     9,
+       9,     6,     1,     1,     1,     1,     1,     1,     1,     1,
+       3,     0,     1,     4,     1,     3,     2,     1,     3,     2,
+       4,     1,     1,     1,     1,     1,     1,     1,     1,     4,
+       3,     3,     2,     2,     1,     1,     1,     1,     1,     1,
+       1,     4,     4,     4,     3,     3,     3,     3,     4,     3,
+       1,     1,     1,     1,     3,     3,     3,     3,     5,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       3,     3,     2,     2,     2,     2,     2,     2,     3,     3,
+       3,     3,     3,     3,     3,     3,     1,     1,     1,     1,
+       1,     1,     1
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
+   If N is 0, then set CURRENT to the empty location which ends
+   the previous symbol: RHS[0] (always defined).  */
+
+#ifndef YYLLOC_DEFAULT
+# define YYLLOC_DEFAULT(Current, Rhs, N)                                \
+    do                                                                  \
+      if (N)                                                            \
+        {                                                               \
+          (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;        \
+          (Current).first_column = YYRHSLOC (Rhs, 1).first_column;      \
+          (Current).last_line    = YYRHSLOC (Rhs, N).last_line;         \
+          (Current).last_column  = YYRHSLOC (Rhs, N).last_column;       \
+        }                                                               \
+      else                                                              \
+        {                                                               \
+          (Current).first_line   = (Current).last_line   =              \
+            YYRHSLOC (Rhs, 0).last_line;                                \
+          (Current).first_column = (Current).last_column =              \
+            YYRHSLOC (Rhs, 0).last_column;                              \
+        }                                                               \
+    while (0)
+#endif
+
+#define YYRHSLOC(Rhs, K) ((Rhs)[K])
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+/* YYLOCATION_PRINT -- Print the location on the stream.
+   This macro was not mandated originally: define only if we know
+   we won't break user code: when these are the locations we know.  */
+
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+
+/* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
+
+YY_ATTRIBUTE_UNUSED
+static int
+yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
+{
+  int res = 0;
+  int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
+  if (0 <= yylocp->first_line)
+    {
+      res += YYFPRINTF (yyo, "%d", yylocp->first_line);
+      if (0 <= yylocp->first_column)
+        res += YYFPRINTF (yyo, ".%d", yylocp->first_column);
+    }
+  if (0 <= yylocp->last_line)
+    {
+      if (yylocp->first_line < yylocp->last_line)
+        {
+          res += YYFPRINTF (yyo, "-%d", yylocp->last_line);
+          if (0 <= end_col)
+            res += YYFPRINTF (yyo, ".%d", end_col);
+        }
+      else if (0 <= end_col && yylocp->first_column < end_col)
+        res += YYFPRINTF (yyo, "-%d", end_col);
+    }
+  return res;
+}
+
+#   define YYLOCATION_PRINT  yy_location_print_
+
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, Location); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  YYLOCATION_PRINT (yyo, yylocationp);
+  YYFPRINTF (yyo, ": ");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]));
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, yylsp, Rule); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp)
+{
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Location data for the lookahead symbol.  */
+YYLTYPE yylloc
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+  = { 1, 1, 1, 1 }
+# endif
+;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (void)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+    /* The location stack: array, bottom, top.  */
+    YYLTYPE yylsa[YYINITDEPTH];
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+  YYLTYPE yyloc;
+
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  yylsp[0] = yylloc;
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+        YYLTYPE *yyls1 = yyls;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+        yyls = yyls1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        YYSTACK_RELOCATE (yyls_alloc, yyls);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+      yylsp = yyls + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+  *++yylsp = yylloc;
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+  /* Default location. */
+  YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+  yyerror_range[1] = yyloc;
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* program: toplevel_stmt_ls  */
+#line 218 "chapel.ypp"
+                                       { (void)(yylsp[0]).first_line; yyblock = (yyval.pblockstmt); }
+#line 4008 "chapel.tab.cpp"
+    break;
+
+  case 3: /* toplevel_stmt_ls: %empty  */
+#line 223 "chapel.ypp"
+                                       { (yyval.pblockstmt) = new BlockStmt();     resetTempID(); }
+#line 4014 "chapel.tab.cpp"
+    break;
+
+  case 4: /* toplevel_stmt_ls: toplevel_stmt_ls toplevel_stmt  */
+#line 224 "chapel.ypp"
+                                       { (yyvsp[-1].pblockstmt)->appendChapelStmt((yyvsp[0].pblockstmt)); resetTempID(); }
+#line 4020 "chapel.tab.cpp"
+    break;
+
+  case 6: /* toplevel_stmt: pragma_ls stmt  */
+#line 231 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildPragmaStmt( (yyvsp[-1].vpch), (yyvsp[0].pblockstmt) ); }
+#line 4026 "chapel.tab.cpp"
+    break;
+
+  case 7: /* pragma_ls: TPRAGMA STRINGLITERAL  */
+#line 236 "chapel.ypp"
+                                       { (yyval.vpch) = new Vec<const char*>(); (yyval.vpch)->add(astr((yyvsp[0].pch))); }
+#line 4032 "chapel.tab.cpp"
+    break;
+
+  case 8: /* pragma_ls: pragma_ls TPRAGMA STRINGLITERAL  */
+#line 237 "chapel.ypp"
+                                       { (yyvsp[-2].vpch)->add(astr((yyvsp[0].pch))); }
+#line 4038 "chapel.tab.cpp"
+    break;
+
+  case 20: /* stmt: stmt_level_expr TSEMI  */
+#line 253 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildChapelStmt((yyvsp[-1].pexpr)); }
+#line 4044 "chapel.tab.cpp"
+    break;
+
+  case 21: /* stmt: TATOMIC stmt  */
+#line 254 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAtomicStmt((yyvsp[0].pblockstmt)); }
+#line 4050 "chapel.tab.cpp"
+    break;
+
+  case 22: /* stmt: TBEGIN opt_task_intent_ls stmt  */
+#line 255 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildBeginStmt((yyvsp[-1].pcallexpr), (yyvsp[0].pblockstmt)); }
+#line 4056 "chapel.tab.cpp"
+    break;
+
+  case 23: /* stmt: TBREAK opt_ident TSEMI  */
+#line 256 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildGotoStmt(GOTO_BREAK, (yyvsp[-1].pch)); }
+#line 4062 "chapel.tab.cpp"
+    break;
+
+  case 24: /* stmt: TCOBEGIN opt_task_intent_ls block_stmt  */
+#line 257 "chapel.ypp"
+                                         { (yyval.pblockstmt) = buildCobeginStmt((yyvsp[-1].pcallexpr), (yyvsp[0].pblockstmt));  }
+#line 4068 "chapel.tab.cpp"
+    break;
+
+  case 25: /* stmt: TCONTINUE opt_ident TSEMI  */
+#line 258 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildGotoStmt(GOTO_CONTINUE, (yyvsp[-1].pch)); }
+#line 4074 "chapel.tab.cpp"
+    break;
+
+  case 26: /* stmt: TDELETE expr TSEMI  */
+#line 259 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildPrimitiveStmt(PRIM_DELETE, (yyvsp[-1].pexpr)); }
+#line 4080 "chapel.tab.cpp"
+    break;
+
+  case 27: /* stmt: TLABEL ident stmt  */
+#line 260 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildLabelStmt((yyvsp[-1].pch), (yyvsp[0].pblockstmt)); }
+#line 4086 "chapel.tab.cpp"
+    break;
+
+  case 28: /* stmt: TLOCAL stmt  */
+#line 261 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildLocalStmt((yyvsp[0].pblockstmt)); }
+#line 4092 "chapel.tab.cpp"
+    break;
+
+  case 29: /* stmt: TON expr do_stmt  */
+#line 262 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildOnStmt((yyvsp[-1].pexpr), (yyvsp[0].pblockstmt)); }
+#line 4098 "chapel.tab.cpp"
+    break;
+
+  case 30: /* stmt: TSERIAL expr do_stmt  */
+#line 263 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildSerialStmt((yyvsp[-1].pexpr), (yyvsp[0].pblockstmt)); }
+#line 4104 "chapel.tab.cpp"
+    break;
+
+  case 31: /* stmt: TSERIAL do_stmt  */
+#line 264 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildSerialStmt(new SymExpr(gTrue), (yyvsp[0].pblockstmt)); }
+#line 4110 "chapel.tab.cpp"
+    break;
+
+  case 32: /* stmt: TSYNC stmt  */
+#line 265 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildSyncStmt((yyvsp[0].pblockstmt)); }
+#line 4116 "chapel.tab.cpp"
+    break;
+
+  case 33: /* stmt: TYIELD expr TSEMI  */
+#line 266 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildPrimitiveStmt(PRIM_YIELD, (yyvsp[-1].pexpr)); }
+#line 4122 "chapel.tab.cpp"
+    break;
+
+  case 34: /* stmt: error  */
+#line 267 "chapel.ypp"
+                                       { printf("syntax error"); clean_exit(1); }
+#line 4128 "chapel.tab.cpp"
+    break;
+
+  case 35: /* module_decl_stmt: module ident TLCBR TRCBR  */
+#line 272 "chapel.ypp"
+    { (yyval.pblockstmt) = buildChapelStmt(new DefExpr(buildModule((yyvsp[-2].pch), new BlockStmt(), yyfilename, (yylsp[-3]).comment))); }
+#line 4134 "chapel.tab.cpp"
+    break;
+
+  case 36: /* module_decl_stmt: module ident TLCBR stmt_ls TRCBR  */
+#line 274 "chapel.ypp"
+    { (yyval.pblockstmt) = buildChapelStmt(new DefExpr(buildModule((yyvsp[-3].pch), (yyvsp[-1].pblockstmt), yyfilename, (yylsp[-4]).comment))); }
+#line 4140 "chapel.tab.cpp"
+    break;
+
+  case 37: /* module: TMODULE  */
+#line 278 "chapel.ypp"
+                                       { (yyloc).comment = yylloc.comment; yylloc.comment = NULL;}
+#line 4146 "chapel.tab.cpp"
+    break;
+
+  case 38: /* block_stmt: TLCBR TRCBR  */
+#line 293 "chapel.ypp"
+                                       { (yyval.pblockstmt) = new BlockStmt(); }
+#line 4152 "chapel.tab.cpp"
+    break;
+
+  case 39: /* block_stmt: TLCBR stmt_ls TRCBR  */
+#line 294 "chapel.ypp"
+                                       { (yyval.pblockstmt) = (yyvsp[-1].pblockstmt);              }
+#line 4158 "chapel.tab.cpp"
+    break;
+
+  case 40: /* stmt_ls: toplevel_stmt  */
+#line 299 "chapel.ypp"
+                                       { (yyval.pblockstmt) = new BlockStmt(); (yyval.pblockstmt)->appendChapelStmt((yyvsp[0].pblockstmt)); }
+#line 4164 "chapel.tab.cpp"
+    break;
+
+  case 41: /* stmt_ls: stmt_ls toplevel_stmt  */
+#line 300 "chapel.ypp"
+                                       { (yyvsp[-1].pblockstmt)->appendChapelStmt((yyvsp[0].pblockstmt)); }
+#line 4170 "chapel.tab.cpp"
+    break;
+
+  case 42: /* use_stmt: TUSE expr_ls TSEMI  */
+#line 305 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildUseStmt((yyvsp[-1].pcallexpr)); }
+#line 4176 "chapel.tab.cpp"
+    break;
+
+  case 43: /* assignment_stmt: lhs_expr TASSIGN expr TSEMI  */
+#line 309 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), "=");   }
+#line 4182 "chapel.tab.cpp"
+    break;
+
+  case 44: /* assignment_stmt: lhs_expr TASSIGNPLUS expr TSEMI  */
+#line 310 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), "+=");  }
+#line 4188 "chapel.tab.cpp"
+    break;
+
+  case 45: /* assignment_stmt: lhs_expr TASSIGNMINUS expr TSEMI  */
+#line 311 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), "-=");  }
+#line 4194 "chapel.tab.cpp"
+    break;
+
+  case 46: /* assignment_stmt: lhs_expr TASSIGNMULTIPLY expr TSEMI  */
+#line 312 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), "*=");  }
+#line 4200 "chapel.tab.cpp"
+    break;
+
+  case 47: /* assignment_stmt: lhs_expr TASSIGNDIVIDE expr TSEMI  */
+#line 313 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), "/=");  }
+#line 4206 "chapel.tab.cpp"
+    break;
+
+  case 48: /* assignment_stmt: lhs_expr TASSIGNMOD expr TSEMI  */
+#line 314 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), "%=");  }
+#line 4212 "chapel.tab.cpp"
+    break;
+
+  case 49: /* assignment_stmt: lhs_expr TASSIGNEXP expr TSEMI  */
+#line 315 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), "**="); }
+#line 4218 "chapel.tab.cpp"
+    break;
+
+  case 50: /* assignment_stmt: lhs_expr TASSIGNBAND expr TSEMI  */
+#line 316 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), "&=");  }
+#line 4224 "chapel.tab.cpp"
+    break;
+
+  case 51: /* assignment_stmt: lhs_expr TASSIGNBOR expr TSEMI  */
+#line 317 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), "|=");  }
+#line 4230 "chapel.tab.cpp"
+    break;
+
+  case 52: /* assignment_stmt: lhs_expr TASSIGNBXOR expr TSEMI  */
+#line 318 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), "^=");  }
+#line 4236 "chapel.tab.cpp"
+    break;
+
+  case 53: /* assignment_stmt: lhs_expr TASSIGNSR expr TSEMI  */
+#line 319 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), ">>="); }
+#line 4242 "chapel.tab.cpp"
+    break;
+
+  case 54: /* assignment_stmt: lhs_expr TASSIGNSL expr TSEMI  */
+#line 320 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), "<<="); }
+#line 4248 "chapel.tab.cpp"
+    break;
+
+  case 55: /* assignment_stmt: lhs_expr TSWAP expr TSEMI  */
+#line 321 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), "<=>"); }
+#line 4254 "chapel.tab.cpp"
+    break;
+
+  case 56: /* assignment_stmt: lhs_expr TASSIGNLAND expr TSEMI  */
+#line 322 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildLAndAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr));    }
+#line 4260 "chapel.tab.cpp"
+    break;
+
+  case 57: /* assignment_stmt: lhs_expr TASSIGNLOR expr TSEMI  */
+#line 323 "chapel.ypp"
+                                       { (yyval.pblockstmt) = buildLOrAssignment((yyvsp[-3].pexpr), (yyvsp[-1].pexpr));     }
+#line 4266 "chapel.tab.cpp"
+    break;
+
+  case 58: /* opt_ident: %empty  */
+#line 327 "chapel.ypp"
+         { (yyval.pch) = NULL; }
+#line 4272 "chapel.tab.cpp"
+    break;
+
+  case 60: /* ident: TIDENT  */
+#line 332 "chapel.ypp"
+          { (yyval.pch) = astr(yytext); }
+#line 4278 "chapel.tab.cpp"
+    break;
+
+  case 61: /* do_stmt: TDO stmt  */
+#line 336 "chapel.ypp"
+              { (yyval.pblockstmt) = (yyvsp[0].pblockstmt); }
+#line 4284 "chapel.tab.cpp"
+    break;
+
+  case 62: /* do_stmt: block_stmt  */
+#line 337 "chapel.ypp"
+              { (yyval.pblockstmt) = (yyvsp[0].pblockstmt); }
+#line 4290 "chapel.tab.cpp"
+    break;
+
+  case 63: /* return_stmt: TRETURN TSEMI  */
+#line 341 "chapel.ypp"
+                      { (yyval.pblockstmt) = buildPrimitiveStmt(PRIM_RETURN, new SymExpr(gVoid)); }
+#line 4296 "chapel.tab.cpp"
+    break;
+
+  case 64: /* return_stmt: TRETURN expr TSEMI  */
+#line 342 "chapel.ypp"
+                      { (yyval.pblockstmt) = buildPrimitiveStmt(PRIM_RETURN, (yyvsp[-1].pexpr)); }
+#line 4302 "chapel.tab.cpp"
+    break;
+
+  case 65: /* class_level_stmt: TSEMI  */
+#line 346 "chapel.ypp"
+                        { (yyval.pblockstmt) = buildChapelStmt(new BlockStmt()); }
+#line 4308 "chapel.tab.cpp"
+    break;
+
+  case 71: /* extern_block_stmt: TEXTERN EXTERNCODE  */
+#line 356 "chapel.ypp"
+    {
+#ifdef HAVE_LLVM
+      if (externC) {
+        (yyval.pblockstmt) = buildExternBlockStmt(astr((yyvsp[0].pch)));
+      } else {
+        USR_FATAL(new BlockStmt(), "extern block syntax is turned off. Use --extern-c flag to turn on.");
+      }
+#else
+      USR_FATAL(new BlockStmt(), "Chapel must be built with llvm in order to use the extern block syntax");
+#endif
+    }
+#line 4324 "chapel.tab.cpp"
+    break;
+
+  case 72: /* loop_stmt: TDO stmt TWHILE expr TSEMI  */
+#line 370 "chapel.ypp"
+                                                { (yyval.pblockstmt) = DoWhileStmt::build((yyvsp[-1].pexpr), (yyvsp[-3].pblockstmt)); }
+#line 4330 "chapel.tab.cpp"
+    break;
+
+  case 73: /* loop_stmt: TWHILE expr do_stmt  */
+#line 371 "chapel.ypp"
+                                                { (yyval.pblockstmt) = WhileDoStmt::build((yyvsp[-1].pexpr), (yyvsp[0].pblockstmt)); }
+#line 4336 "chapel.tab.cpp"
+    break;
+
+  case 74: /* loop_stmt: TCOFORALL expr TIN expr opt_task_intent_ls do_stmt  */
+#line 372 "chapel.ypp"
+                                                     { (yyval.pblockstmt) = buildCoforallLoopStmt((yyvsp[-4].pexpr), (yyvsp[-2].pexpr), (yyvsp[-1].pcallexpr), (yyvsp[0].pblockstmt)); }
+#line 4342 "chapel.tab.cpp"
+    break;
+
+  case 75: /* loop_stmt: TCOFORALL expr TIN zippered_iterator opt_task_intent_ls do_stmt  */
+#line 373 "chapel.ypp"
+                                                                  { (yyval.pblockstmt) = buildCoforallLoopStmt((yyvsp[-4].pexpr), (yyvsp[-2].pexpr), (yyvsp[-1].pcallexpr), (yyvsp[0].pblockstmt), true); }
+#line 4348 "chapel.tab.cpp"
+    break;
+
+  case 76: /* loop_stmt: TCOFORALL expr opt_task_intent_ls do_stmt  */
+#line 374 "chapel.ypp"
+                                                { (yyval.pblockstmt) = buildCoforallLoopStmt(NULL, (yyvsp[-2].pexpr), (yyvsp[-1].pcallexpr), (yyvsp[0].pblockstmt)); }
+#line 4354 "chapel.tab.cpp"
+    break;
+
+  case 77: /* loop_stmt: TFOR expr TIN expr do_stmt  */
+#line 375 "chapel.ypp"
+                                                { (yyval.pblockstmt) = ForLoop::buildForLoop(  (yyvsp[-3].pexpr), (yyvsp[-1].pexpr), (yyvsp[0].pblockstmt), false, false); }
+#line 4360 "chapel.tab.cpp"
+    break;
+
+  case 78: /* loop_stmt: TFOR expr TIN zippered_iterator do_stmt  */
+#line 376 "chapel.ypp"
+                                                { (yyval.pblockstmt) = ForLoop::buildForLoop(  (yyvsp[-3].pexpr), (yyvsp[-1].pexpr), (yyvsp[0].pblockstmt), false,  true); }
+#line 4366 "chapel.tab.cpp"
+    break;
+
+  case 79: /* loop_stmt: TFOR expr do_stmt  */
+#line 377 "chapel.ypp"
+                                                { (yyval.pblockstmt) = ForLoop::buildForLoop(NULL, (yyvsp[-1].pexpr), (yyvsp[0].pblockstmt), false, false); }
+#line 4372 "chapel.tab.cpp"
+    break;
+
+  case 80: /* loop_stmt: TFOR zippered_iterator do_stmt  */
+#line 378 "chapel.ypp"
+                                                { (yyval.pblockstmt) = ForLoop::buildForLoop(NULL, (yyvsp[-1].pexpr), (yyvsp[0].pblockstmt), false,  true); }
+#line 4378 "chapel.tab.cpp"
+    break;
+
+  case 81: /* loop_stmt: TFOR TPARAM ident TIN expr do_stmt  */
+#line 379 "chapel.ypp"
+                                                { (yyval.pblockstmt) = buildParamForLoopStmt((yyvsp[-3].pch), (yyvsp[-1].pexpr), (yyvsp[0].pblockstmt)); }
+#line 4384 "chapel.tab.cpp"
+    break;
+
+  case 82: /* loop_stmt: TFORALL expr TIN expr do_stmt  */
+#line 380 "chapel.ypp"
+                                                                   { (yyval.pblockstmt) = buildForallLoopStmt((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), NULL, (yyvsp[0].pblockstmt)); }
+#line 4390 "chapel.tab.cpp"
+    break;
+
+  case 83: /* loop_stmt: TFORALL expr TIN expr task_intent_clause do_stmt  */
+#line 381 "chapel.ypp"
+                                                                   { (yyval.pblockstmt) = buildForallLoopStmt((yyvsp[-4].pexpr), (yyvsp[-2].pexpr), (yyvsp[-1].pcallexpr),   (yyvsp[0].pblockstmt)); }
+#line 4396 "chapel.tab.cpp"
+    break;
+
+  case 84: /* loop_stmt: TFORALL expr TIN zippered_iterator do_stmt  */
+#line 382 "chapel.ypp"
+                                                                   { (yyval.pblockstmt) = buildForallLoopStmt((yyvsp[-3].pexpr), (yyvsp[-1].pexpr), NULL, (yyvsp[0].pblockstmt), true); }
+#line 4402 "chapel.tab.cpp"
+    break;
+
+  case 85: /* loop_stmt: TFORALL expr TIN zippered_iterator task_intent_clause do_stmt  */
+#line 383 "chapel.ypp"
+                                                                   { (yyval.pblockstmt) = buildForallLoopStmt((yyvsp[-4].pexpr), (yyvsp[-2].pexpr), (yyvsp[-1].pcallexpr),   (yyvsp[0].pblockstmt), true); }
+#line 4408 "chapel.tab.cpp"
+    break;
+
+  case 86: /* loop_stmt: TFORALL expr do_stmt  */
+#line 384 "chapel.ypp"
+                                                                   { (yyval.pblockstmt) = buildForallLoopStmt(NULL, (yyvsp[-1].pexpr), NULL, (yyvsp[0].pblockstmt)); }
+#line 4414 "chapel.tab.cpp"
+    break;
+
+  case 87: /* loop_stmt: TFORALL expr task_intent_clause do_stmt  */
+#line 385 "chapel.ypp"
+                                                                   { (yyval.pblockstmt) = buildForallLoopStmt(NULL, (yyvsp[-2].pexpr), (yyvsp[-1].pcallexpr),   (yyvsp[0].pblockstmt)); }
+#line 4420 "chapel.tab.cpp"
+    break;
+
+  case 88: /* loop_stmt: TLSBR expr_ls TIN expr TRSBR stmt  */
+#line 387 "chapel.ypp"
+    {
+      if ((yyvsp[-4].pcallexpr)->argList.length != 1)
+        USR_FATAL((yyvsp[-2].pexpr), "invalid index expression");
+      (yyval.pblockstmt) = buildForallLoopStmt((yyvsp[-4].pcallexpr)->get(1)->remove(), (yyvsp[-2].pexpr), NULL, new BlockStmt((yyvsp[0].pblockstmt)));
+    }
+#line 4430 "chapel.tab.cpp"
+    break;
+
+  case 89: /* loop_stmt: TLSBR expr_ls TIN expr task_intent_clause TRSBR stmt  */
+#line 393 "chapel.ypp"
+    {
+      if ((yyvsp[-5].pcallexpr)->argList.length != 1)
+        USR_FATAL((yyvsp[-3].pexpr), "invalid index expression");
+      (yyval.pblockstmt) = buildForallLoopStmt((yyvsp[-5].pcallexpr)->get(1)->remove(), (yyvsp[-3].pexpr), (yyvsp[-2].pcallexpr),   new BlockStmt((yyvsp[0].pblockstmt)));
+    }
+#line 4440 "chapel.tab.cpp"
+    break;
+
+  case 90: /* loop_stmt: TLSBR expr_ls TIN zippered_iterator TRSBR stmt  */
+#line 399 "chapel.ypp"
+    {
+      if ((yyvsp[-4].pcallexpr)->argList.length != 1)
+        USR_FATAL((yyvsp[-2].pexpr), "invalid index expression");
+      (yyval.pblockstmt) = buildForallLoopStmt((yyvsp[-4].pcallexpr)->get(1)->remove(), (yyvsp[-2].pexpr), NULL, new BlockStmt((yyvsp[0].pblockstmt)), true);
+    }
+#line 4450 "chapel.tab.cpp"
+    break;
+
+  case 91: /* loop_stmt: TLSBR expr_ls TIN zippered_iterator task_intent_clause TRSBR stmt  */
+#line 405 "chapel.ypp"
+    {
+      if ((yyvsp[-5].pcallexpr)->argList.length != 1)
+        USR_FATAL((yyvsp[-3].pexpr), "invalid index expression");
+      (yyval.pblockstmt) = buildForallLoopStmt((yyvsp[-5].pcallexpr)->get(1)->remove(), (yyvsp[-3].pexpr), (yyvsp[-2].pcallexpr),   new BlockStmt((yyvsp[0].pblockstmt)), true);
+    }
+#line 4460 "chapel.tab.cpp"
+    break;
+
+  case 92: /* loop_stmt: TLSBR expr_ls TRSBR stmt  */
+#line 411 "chapel.ypp"
+    {
+      if ((yyvsp[-2].pcallexpr)->argList.length > 1)
+        (yyval.pblockstmt) = buildForallLoopStmt(NULL, new CallExpr("chpl__ensureDomainExpr", (yyvsp[-2].pcallexpr)), NULL, new BlockStmt((yyvsp[0].pblockstmt)));
+      else
+        (yyval.pblockstmt) = buildForallLoopStmt(NULL, (yyvsp[-2].pcallexpr)->get(1)->remove(), NULL, new BlockStmt((yyvsp[0].pblockstmt)));
+    }
+#line 4471 "chapel.tab.cpp"
+    break;
+
+  case 93: /* loop_stmt: TLSBR expr_ls task_intent_clause TRSBR stmt  */
+#line 418 "chapel.ypp"
+    {
+      if ((yyvsp[-3].pcallexpr)->argList.length > 1)
+        (yyval.pblockstmt) = buildForallLoopStmt(NULL, new CallExpr("chpl__ensureDomainExpr", (yyvsp[-3].pcallexpr)), (yyvsp[-2].pcallexpr),   new BlockStmt((yyvsp[0].pblockstmt)));
+      else
+        (yyval.pblockstmt) = buildForallLoopStmt(NULL, (yyvsp[-3].pcallexpr)->get(1)->remove(), (yyvsp[-2].pcallexpr),   new BlockStmt((yyvsp[0].pblockstmt)));
+    }
+#line 4482 "chapel.tab.cpp"
+    break;
+
+  case 94: /* zippered_iterator: TZIP TLP expr_ls TRP  */
+#line 427 "chapel.ypp"
+                            { (yyval.pexpr) = new CallExpr("_build_tuple", (yyvsp[-1].pcallexpr)); }
+#line 4488 "chapel.tab.cpp"
+    break;
+
+  case 95: /* if_stmt: TIF expr TTHEN stmt  */
+#line 431 "chapel.ypp"
+                                     { (yyval.pblockstmt) = buildIfStmt((yyvsp[-2].pexpr), (yyvsp[0].pblockstmt)); }
+#line 4494 "chapel.tab.cpp"
+    break;
+
+  case 96: /* if_stmt: TIF expr block_stmt  */
+#line 432 "chapel.ypp"
+                                     { (yyval.pblockstmt) = buildIfStmt((yyvsp[-1].pexpr), (yyvsp[0].pblockstmt)); }
+#line 4500 "chapel.tab.cpp"
+    break;
+
+  case 97: /* if_stmt: TIF expr TTHEN stmt TELSE stmt  */
+#line 433 "chapel.ypp"
+                                     { (yyval.pblockstmt) = buildIfStmt((yyvsp[-4].pexpr), (yyvsp[-2].pblockstmt), (yyvsp[0].pblockstmt)); }
+#line 4506 "chapel.tab.cpp"
+    break;
+
+  case 98: /* if_stmt: TIF expr block_stmt TELSE stmt  */
+#line 434 "chapel.ypp"
+                                     { (yyval.pblockstmt) = buildIfStmt((yyvsp[-3].pexpr), (yyvsp[-2].pblockstmt), (yyvsp[0].pblockstmt)); }
+#line 4512 "chapel.tab.cpp"
+    break;
+
+  case 99: /* select_stmt: TSELECT expr TLCBR when_stmt_ls TRCBR  */
+#line 439 "chapel.ypp"
+    { (yyval.pblockstmt) = buildChapelStmt(buildSelectStmt((yyvsp[-3].pexpr), (yyvsp[-1].pblockstmt))); }
+#line 4518 "chapel.tab.cpp"
+    break;
+
+  case 100: /* when_stmt_ls: %empty  */
+#line 443 "chapel.ypp"
+                          { (yyval.pblockstmt) = buildChapelStmt(); }
+#line 4524 "chapel.tab.cpp"
+    break;
+
+  case 101: /* when_stmt_ls: when_stmt_ls when_stmt  */
+#line 444 "chapel.ypp"
+                          { (yyvsp[-1].pblockstmt)->insertAtTail((yyvsp[0].pexpr)); }
+#line 4530 "chapel.tab.cpp"
+    break;
+
+  case 102: /* when_stmt: TWHEN expr_ls do_stmt  */
+#line 449 "chapel.ypp"
+    { (yyval.pexpr) = new CondStmt(new CallExpr(PRIM_WHEN, (yyvsp[-1].pcallexpr)), (yyvsp[0].pblockstmt)); }
+#line 4536 "chapel.tab.cpp"
+    break;
+
+  case 103: /* when_stmt: TOTHERWISE stmt  */
+#line 451 "chapel.ypp"
+    { (yyval.pexpr) = new CondStmt(new CallExpr(PRIM_WHEN), (yyvsp[0].pblockstmt)); }
+#line 4542 "chapel.tab.cpp"
+    break;
+
+  case 104: /* type_select_stmt: TTYPE TSELECT expr_ls TLCBR when_stmt_ls TRCBR  */
+#line 456 "chapel.ypp"
+    { (yyval.pblockstmt) = buildTypeSelectStmt((yyvsp[-3].pcallexpr), (yyvsp[-1].pblockstmt)); }
+#line 4548 "chapel.tab.cpp"
+    break;
+
+  case 105: /* class_decl_stmt: opt_extern class_tag ident opt_inherit TLCBR class_level_stmt_ls TRCBR  */
+#line 463 "chapel.ypp"
+    { (yyval.pblockstmt) = buildChapelStmt(buildClassDefExpr((yyvsp[-4].pch), (yyvsp[-5].ptype), (yyvsp[-3].pcallexpr), (yyvsp[-1].pblockstmt), (yyvsp[-6].flag), (yylsp[-6]).comment));
+      yylloc.comment = NULL; }
+#line 4555 "chapel.tab.cpp"
+    break;
+
+  case 106: /* opt_extern: %empty  */
+#line 468 "chapel.ypp"
+           { (yyval.flag) = FLAG_UNKNOWN; }
+#line 4561 "chapel.tab.cpp"
+    break;
+
+  case 107: /* opt_extern: TEXTERN  */
+#line 469 "chapel.ypp"
+           { (yyval.flag) = FLAG_EXTERN; (yyloc).comment = yylloc.comment; yylloc.comment = NULL;}
+#line 4567 "chapel.tab.cpp"
+    break;
+
+  case 108: /* class_tag: TCLASS  */
+#line 473 "chapel.ypp"
+           { (yyval.ptype) = new AggregateType(AGGREGATE_CLASS); (yyloc).comment = yylloc.comment; 
+             yylloc.comment = NULL;}
+#line 4574 "chapel.tab.cpp"
+    break;
+
+  case 109: /* class_tag: TRECORD  */
+#line 475 "chapel.ypp"
+           { (yyval.ptype) = new AggregateType(AGGREGATE_RECORD); (yyloc).comment = yylloc.comment; 
+             yylloc.comment = NULL;}
+#line 4581 "chapel.tab.cpp"
+    break;
+
+  case 110: /* class_tag: TUNION  */
+#line 477 "chapel.ypp"
+           { (yyval.ptype) = new AggregateType(AGGREGATE_UNION); (yyloc).comment = yylloc.comment;
+             yylloc.comment = NULL;}
+#line 4588 "chapel.tab.cpp"
+    break;
+
+  case 111: /* opt_inherit: %empty  */
+#line 482 "chapel.ypp"
+                  { (yyval.pcallexpr) = NULL; }
+#line 4594 "chapel.tab.cpp"
+    break;
+
+  case 112: /* opt_inherit: TCOLON expr_ls  */
+#line 483 "chapel.ypp"
+                  { (yyval.pcallexpr) = (yyvsp[0].pcallexpr); }
+#line 4600 "chapel.tab.cpp"
+    break;
+
+  case 113: /* class_level_stmt_ls: %empty  */
+#line 488 "chapel.ypp"
+    { (yyval.pblockstmt) = new BlockStmt(); }
+#line 4606 "chapel.tab.cpp"
+    break;
+
+  case 114: /* class_level_stmt_ls: class_level_stmt_ls class_level_stmt  */
+#line 490 "chapel.ypp"
+    { (yyvsp[-1].pblockstmt)->insertAtTail((yyvsp[0].pblockstmt)); }
+#line 4612 "chapel.tab.cpp"
+    break;
+
+  case 115: /* class_level_stmt_ls: class_level_stmt_ls pragma_ls class_level_stmt  */
+#line 492 "chapel.ypp"
+    { (yyvsp[-2].pblockstmt)->insertAtTail(buildPragmaStmt((yyvsp[-1].vpch), (yyvsp[0].pblockstmt))); }
+#line 4618 "chapel.tab.cpp"
+    break;
+
+  case 116: /* enum_decl_stmt: TENUM ident TLCBR enum_ls TRCBR  */
+#line 497 "chapel.ypp"
+    {
+      EnumType* pdt = (yyvsp[-1].penumtype);
+      TypeSymbol* pst = new TypeSymbol((yyvsp[-3].pch), pdt);
+      (yyvsp[-1].penumtype)->symbol = pst;
+      (yyval.pblockstmt) = buildChapelStmt(new DefExpr(pst));
+    }
+#line 4629 "chapel.tab.cpp"
+    break;
+
+  case 117: /* enum_ls: enum_item  */
+#line 507 "chapel.ypp"
+    {
+      (yyval.penumtype) = new EnumType();
+      (yyvsp[0].pdefexpr)->sym->type = (yyval.penumtype);
+      (yyval.penumtype)->constants.insertAtTail((yyvsp[0].pdefexpr));
+      (yyval.penumtype)->defaultValue = (yyvsp[0].pdefexpr)->sym;
+    }
+#line 4640 "chapel.tab.cpp"
+    break;
+
+  case 118: /* enum_ls: enum_ls TCOMMA  */
+#line 514 "chapel.ypp"
+    {
+      (yyval.penumtype) = (yyvsp[-1].penumtype);
+    }
+#line 4648 "chapel.tab.cpp"
+    break;
+
+  case 119: /* enum_ls: enum_ls TCOMMA enum_item  */
+#line 518 "chapel.ypp"
+    {
+      (yyvsp[-2].penumtype)->constants.insertAtTail((yyvsp[0].pdefexpr));
+      (yyvsp[0].pdefexpr)->sym->type = (yyvsp[-2].penumtype);
+    }
+#line 4657 "chapel.tab.cpp"
+    break;
+
+  case 120: /* enum_item: ident  */
+#line 525 "chapel.ypp"
+                      { (yyval.pdefexpr) = new DefExpr(new EnumSymbol((yyvsp[0].pch))); }
+#line 4663 "chapel.tab.cpp"
+    break;
+
+  case 121: /* enum_item: ident TASSIGN expr  */
+#line 526 "chapel.ypp"
+                      { (yyval.pdefexpr) = new DefExpr(new EnumSymbol((yyvsp[-2].pch)), (yyvsp[0].pexpr)); }
+#line 4669 "chapel.tab.cpp"
+    break;
+
+  case 122: /* $@1: %empty  */
+#line 531 "chapel.ypp"
+    {
+      captureTokens = 1;
+      captureString[0] = '\0';
+    }
+#line 4678 "chapel.tab.cpp"
+    break;
+
+  case 123: /* $@2: %empty  */
+#line 536 "chapel.ypp"
+    {
+      captureTokens = 0;
+      (yyvsp[0].pfnsymbol)->userString = astr(captureString);
+    }
+#line 4687 "chapel.tab.cpp"
+    break;
+
+  case 124: /* lambda_decl_expr: TLAMBDA $@1 req_formal_ls $@2 opt_ret_tag opt_type opt_where_part function_body_stmt  */
+#line 541 "chapel.ypp"
+    {
+      (yyvsp[-5].pfnsymbol)->retTag = (yyvsp[-3].retTag);
+      if ((yyvsp[-3].retTag) == RET_REF)
+        USR_FATAL("'ref' return types are not allowed in lambdas");
+      if ((yyvsp[-3].retTag) == RET_PARAM)
+        USR_FATAL("'param' return types are not allowed in lambdas");
+      if ((yyvsp[-3].retTag) == RET_TYPE)
+        USR_FATAL("'type' return types are not allowed in lambdas");
+      if ((yyvsp[-2].pexpr))
+        (yyvsp[-5].pfnsymbol)->retExprType = new BlockStmt((yyvsp[-2].pexpr), BLOCK_SCOPELESS);
+      if ((yyvsp[-1].pexpr))
+        (yyvsp[-5].pfnsymbol)->where = new BlockStmt((yyvsp[-1].pexpr));
+      (yyvsp[-5].pfnsymbol)->insertAtTail((yyvsp[0].pblockstmt));
+      (yyval.pexpr) = new DefExpr(buildLambda((yyvsp[-5].pfnsymbol)));
+    }
+#line 4707 "chapel.tab.cpp"
+    break;
+
+  case 125: /* linkage_spec: %empty  */
+#line 561 "chapel.ypp"
+                { (yyval.pfnsymbol) = new FnSymbol(""); }
+#line 4713 "chapel.tab.cpp"
+    break;
+
+  case 126: /* linkage_spec: TINLINE  */
+#line 562 "chapel.ypp"
+                { (yyval.pfnsymbol) = new FnSymbol(""); (yyval.pfnsymbol)->addFlag(FLAG_INLINE); 
+                  (yyloc).comment = yylloc.comment; yylloc.comment = NULL;}
+#line 4720 "chapel.tab.cpp"
+    break;
+
+  case 127: /* linkage_spec: TEXPORT  */
+#line 564 "chapel.ypp"
+                { (yyval.pfnsymbol) = new FnSymbol(""); (yyval.pfnsymbol)->addFlag(FLAG_EXPORT);  
+                  (yyval.pfnsymbol)->addFlag(FLAG_LOCAL_ARGS);
+                  (yyloc).comment = yylloc.comment; yylloc.comment = NULL;}
+#line 4728 "chapel.tab.cpp"
+    break;
+
+  case 128: /* linkage_spec: TEXPORT ident  */
+#line 567 "chapel.ypp"
+                { (yyval.pfnsymbol) = new FnSymbol((yyvsp[0].pch)); (yyval.pfnsymbol)->addFlag(FLAG_EXPORT);  
+                  (yyval.pfnsymbol)->addFlag(FLAG_LOCAL_ARGS);
+                  (yyloc).comment = yylloc.comment; yylloc.comment = NULL;}
+#line 4736 "chapel.tab.cpp"
+    break;
+
+  case 129: /* linkage_spec: TEXTERN  */
+#line 570 "chapel.ypp"
+                { (yyval.pfnsymbol) = new FnSymbol(""); (yyval.pfnsymbol)->addFlag(FLAG_EXTERN);
+                  (yyval.pfnsymbol)->addFlag(FLAG_LOCAL_ARGS);
+                  (yyloc).comment = yylloc.comment; yylloc.comment = NULL;}
+#line 4744 "chapel.tab.cpp"
+    break;
+
+  case 130: /* linkage_spec: TEXTERN ident  */
+#line 573 "chapel.ypp"
+                { (yyval.pfnsymbol) = new FnSymbol((yyvsp[0].pch)); (yyval.pfnsymbol)->addFlag(FLAG_EXTERN);  
+                  (yyval.pfnsymbol)->addFlag(FLAG_LOCAL_ARGS);
+                  (yyloc).comment = yylloc.comment; yylloc.comment = NULL;}
+#line 4752 "chapel.tab.cpp"
+    break;
+
+  case 131: /* $@3: %empty  */
+#line 579 "chapel.ypp"
+    {
+      // Sets up to capture tokens while parsing the next grammar nonterminal.
+      captureTokens = 1;
+      captureString[0] = '\0';
+    }
+#line 4762 "chapel.tab.cpp"
+    break;
+
+  case 132: /* $@4: %empty  */
+#line 585 "chapel.ypp"
+    {
+      // Stop capturing and save the result.
+      captureTokens = 0;
+
+      (yyvsp[0].pfnsymbol)->userString = astr(captureString);
+    }
+#line 4773 "chapel.tab.cpp"
+    break;
+
+  case 133: /* fn_decl_stmt: linkage_spec proc_or_iter $@3 fn_decl_stmt_inner $@4 opt_ret_tag opt_type opt_where_part opt_function_body_stmt  */
+#line 592 "chapel.ypp"
+    {
+      FnSymbol* fn = (yyvsp[-5].pfnsymbol);
+
+      fn->copyFlags((yyvsp[-8].pfnsymbol));
+      // The user explicitly named this function (controls mangling).
+      if ((yyvsp[-8].pfnsymbol)->hasFlag(FLAG_EXPORT) || (yyvsp[-8].pfnsymbol)->hasFlag(FLAG_EXTERN))
+        fn->addFlag(FLAG_USER_NAMED);
+      if (*(yyvsp[-8].pfnsymbol)->name)
+        fn->cname = (yyvsp[-8].pfnsymbol)->name;
+
+      if ((yyvsp[-7].procIter) == ProcIter_ITER)
+      {
+        if (fn->hasFlag(FLAG_EXTERN))
+          USR_FATAL_CONT(fn, "'iter' is not legal with 'extern'");
+        fn->addFlag(FLAG_ITERATOR_FN);
+      }
+
+      (yyval.pblockstmt) = buildFunctionDecl((yyvsp[-5].pfnsymbol), (yyvsp[-3].retTag), (yyvsp[-2].pexpr), (yyvsp[-1].pexpr), (yyvsp[0].pblockstmt), (yylsp[-8]).comment);
+      yylloc.comment = NULL;
+    }
+#line 4798 "chapel.tab.cpp"
+    break;
+
+  case 134: /* fn_decl_stmt_inner: opt_this_intent_tag fn_ident opt_formal_ls  */
+#line 616 "chapel.ypp"
+    {
+      (yyval.pfnsymbol) = buildFunctionSymbol((yyvsp[0].pfnsymbol), (yyvsp[-1].pch), (yyvsp[-2].pt), NULL);
+    }
+#line 4806 "chapel.tab.cpp"
+    break;
+
+  case 135: /* fn_decl_stmt_inner: opt_this_intent_tag assignop_ident opt_formal_ls  */
+#line 620 "chapel.ypp"
+    {
+      (yyval.pfnsymbol) = buildFunctionSymbol((yyvsp[0].pfnsymbol), (yyvsp[-1].pch), (yyvsp[-2].pt), NULL);
+      (yyval.pfnsymbol)->addFlag(FLAG_ASSIGNOP);
+    }
+#line 4815 "chapel.tab.cpp"
+    break;
+
+  case 136: /* fn_decl_stmt_inner: opt_this_intent_tag ident TDOT fn_ident opt_formal_ls  */
+#line 625 "chapel.ypp"
+    {
+      (yyval.pfnsymbol) = buildFunctionSymbol((yyvsp[0].pfnsymbol), (yyvsp[-1].pch), (yyvsp[-4].pt), (yyvsp[-3].pch));
+    }
+#line 4823 "chapel.tab.cpp"
+    break;
+
+  case 137: /* fn_decl_stmt_inner: opt_this_intent_tag ident TDOT assignop_ident opt_formal_ls  */
+#line 629 "chapel.ypp"
+    {
+      (yyval.pfnsymbol) = buildFunctionSymbol((yyvsp[0].pfnsymbol), (yyvsp[-1].pch), (yyvsp[-4].pt), (yyvsp[-3].pch));
+      (yyval.pfnsymbol)->addFlag(FLAG_ASSIGNOP);
+    }
+#line 4832 "chapel.tab.cpp"
+    break;
+
+  case 139: /* fn_ident: TBNOT ident  */
+#line 637 "chapel.ypp"
+                 { (yyval.pch) = astr("~", (yyvsp[0].pch)); }
+#line 4838 "chapel.tab.cpp"
+    break;
+
+  case 140: /* fn_ident: TBAND  */
+#line 638 "chapel.ypp"
+                 { (yyval.pch) = "&"; }
+#line 4844 "chapel.tab.cpp"
+    break;
+
+  case 141: /* fn_ident: TBOR  */
+#line 639 "chapel.ypp"
+                 { (yyval.pch) = "|"; }
+#line 4850 "chapel.tab.cpp"
+    break;
+
+  case 142: /* fn_ident: TBXOR  */
+#line 640 "chapel.ypp"
+                 { (yyval.pch) = "^"; }
+#line 4856 "chapel.tab.cpp"
+    break;
+
+  case 143: /* fn_ident: TBNOT  */
+#line 641 "chapel.ypp"
+                 { (yyval.pch) = "~"; }
+#line 4862 "chapel.tab.cpp"
+    break;
+
+  case 144: /* fn_ident: TEQUAL  */
+#line 642 "chapel.ypp"
+                 { (yyval.pch) = "=="; }
+#line 4868 "chapel.tab.cpp"
+    break;
+
+  case 145: /* fn_ident: TNOTEQUAL  */
+#line 643 "chapel.ypp"
+                 { (yyval.pch) = "!="; }
+#line 4874 "chapel.tab.cpp"
+    break;
+
+  case 146: /* fn_ident: TLESSEQUAL  */
+#line 644 "chapel.ypp"
+                 { (yyval.pch) = "<="; }
+#line 4880 "chapel.tab.cpp"
+    break;
+
+  case 147: /* fn_ident: TGREATEREQUAL  */
+#line 645 "chapel.ypp"
+                 { (yyval.pch) = ">="; }
+#line 4886 "chapel.tab.cpp"
+    break;
+
+  case 148: /* fn_ident: TLESS  */
+#line 646 "chapel.ypp"
+                 { (yyval.pch) = "<"; }
+#line 4892 "chapel.tab.cpp"
+    break;
+
+  case 149: /* fn_ident: TGREATER  */
+#line 647 "chapel.ypp"
+                 { (yyval.pch) = ">"; }
+#line 4898 "chapel.tab.cpp"
+    break;
+
+  case 150: /* fn_ident: TPLUS  */
+#line 648 "chapel.ypp"
+                 { (yyval.pch) = "+"; }
+#line 4904 "chapel.tab.cpp"
+    break;
+
+  case 151: /* fn_ident: TMINUS  */
+#line 649 "chapel.ypp"
+                 { (yyval.pch) = "-"; }
+#line 4910 "chapel.tab.cpp"
+    break;
+
+  case 152: /* fn_ident: TSTAR  */
+#line 650 "chapel.ypp"
+                 { (yyval.pch) = "*"; }
+#line 4916 "chapel.tab.cpp"
+    break;
+
+  case 153: /* fn_ident: TDIVIDE  */
+#line 651 "chapel.ypp"
+                 { (yyval.pch) = "/"; }
+#line 4922 "chapel.tab.cpp"
+    break;
+
+  case 154: /* fn_ident: TSHIFTLEFT  */
+#line 652 "chapel.ypp"
+                 { (yyval.pch) = "<<"; }
+#line 4928 "chapel.tab.cpp"
+    break;
+
+  case 155: /* fn_ident: TSHIFTRIGHT  */
+#line 653 "chapel.ypp"
+                 { (yyval.pch) = ">>"; }
+#line 4934 "chapel.tab.cpp"
+    break;
+
+  case 156: /* fn_ident: TMOD  */
+#line 654 "chapel.ypp"
+                 { (yyval.pch) = "%"; }
+#line 4940 "chapel.tab.cpp"
+    break;
+
+  case 157: /* fn_ident: TEXP  */
+#line 655 "chapel.ypp"
+                 { (yyval.pch) = "**"; }
+#line 4946 "chapel.tab.cpp"
+    break;
+
+  case 158: /* fn_ident: TNOT  */
+#line 656 "chapel.ypp"
+                 { (yyval.pch) = "!"; }
+#line 4952 "chapel.tab.cpp"
+    break;
+
+  case 159: /* fn_ident: TBY  */
+#line 657 "chapel.ypp"
+                 { (yyval.pch) = "by"; }
+#line 4958 "chapel.tab.cpp"
+    break;
+
+  case 160: /* fn_ident: THASH  */
+#line 658 "chapel.ypp"
+                 { (yyval.pch) = "#"; }
+#line 4964 "chapel.tab.cpp"
+    break;
+
+  case 161: /* fn_ident: TALIGN  */
+#line 659 "chapel.ypp"
+                 { (yyval.pch) = "align"; }
+#line 4970 "chapel.tab.cpp"
+    break;
+
+  case 162: /* fn_ident: TSWAP  */
+#line 660 "chapel.ypp"
+                 { (yyval.pch) = "<=>"; }
+#line 4976 "chapel.tab.cpp"
+    break;
+
+  case 163: /* fn_ident: TIO  */
+#line 661 "chapel.ypp"
+                 { (yyval.pch) = "<~>"; }
+#line 4982 "chapel.tab.cpp"
+    break;
+
+  case 164: /* assignop_ident: TASSIGN  */
+#line 665 "chapel.ypp"
+                 { (yyval.pch) = "="; }
+#line 4988 "chapel.tab.cpp"
+    break;
+
+  case 165: /* assignop_ident: TASSIGNPLUS  */
+#line 666 "chapel.ypp"
+                 { (yyval.pch) = "+="; }
+#line 4994 "chapel.tab.cpp"
+    break;
+
+  case 166: /* assignop_ident: TASSIGNMINUS  */
+#line 667 "chapel.ypp"
+                 { (yyval.pch) = "-="; }
+#line 5000 "chapel.tab.cpp"
+    break;
+
+  case 167: /* assignop_ident: TASSIGNMULTIPLY  */
+#line 668 "chapel.ypp"
+                  { (yyval.pch) = "*="; }
+#line 5006 "chapel.tab.cpp"
+    break;
+
+  case 168: /* assignop_ident: TASSIGNDIVIDE  */
+#line 669 "chapel.ypp"
+                 { (yyval.pch) = "/="; }
+#line 5012 "chapel.tab.cpp"
+    break;
+
+  case 169: /* assignop_ident: TASSIGNMOD  */
+#line 670 "chapel.ypp"
+                 { (yyval.pch) = "%="; }
+#line 5018 "chapel.tab.cpp"
+    break;
+
+  case 170: /* assignop_ident: TASSIGNEXP  */
+#line 671 "chapel.ypp"
+                 { (yyval.pch) = "**="; }
+#line 5024 "chapel.tab.cpp"
+    break;
+
+  case 171: /* assignop_ident: TASSIGNBAND  */
+#line 672 "chapel.ypp"
+                 { (yyval.pch) = "&="; }
+#line 5030 "chapel.tab.cpp"
+    break;
+
+  case 172: /* assignop_ident: TASSIGNBOR  */
+#line 673 "chapel.ypp"
+                 { (yyval.pch) = "|="; }
+#line 5036 "chapel.tab.cpp"
+    break;
+
+  case 173: /* assignop_ident: TASSIGNBXOR  */
+#line 674 "chapel.ypp"
+                 { (yyval.pch) = "^="; }
+#line 5042 "chapel.tab.cpp"
+    break;
+
+  case 174: /* assignop_ident: TASSIGNSR  */
+#line 675 "chapel.ypp"
+                 { (yyval.pch) = ">>="; }
+#line 5048 "chapel.tab.cpp"
+    break;
+
+  case 175: /* assignop_ident: TASSIGNSL  */
+#line 676 "chapel.ypp"
+                 { (yyval.pch) = "<<="; }
+#line 5054 "chapel.tab.cpp"
+    break;
+
+  case 176: /* opt_formal_ls: %empty  */
+#line 680 "chapel.ypp"
+                     { (yyval.pfnsymbol) = new FnSymbol("_"); (yyval.pfnsymbol)->addFlag(FLAG_NO_PARENS); }
+#line 5060 "chapel.tab.cpp"
+    break;
+
+  case 177: /* opt_formal_ls: TLP formal_ls TRP  */
+#line 681 "chapel.ypp"
+                     { (yyval.pfnsymbol) = (yyvsp[-1].pfnsymbol); }
+#line 5066 "chapel.tab.cpp"
+    break;
+
+  case 178: /* req_formal_ls: TLP formal_ls TRP  */
+#line 685 "chapel.ypp"
+                     { (yyval.pfnsymbol) = (yyvsp[-1].pfnsymbol); }
+#line 5072 "chapel.tab.cpp"
+    break;
+
+  case 179: /* formal_ls: %empty  */
+#line 689 "chapel.ypp"
+                           { (yyval.pfnsymbol) = buildFunctionFormal(NULL, NULL); }
+#line 5078 "chapel.tab.cpp"
+    break;
+
+  case 180: /* formal_ls: formal  */
+#line 690 "chapel.ypp"
+                           { (yyval.pfnsymbol) = buildFunctionFormal(NULL, (yyvsp[0].pdefexpr)); }
+#line 5084 "chapel.tab.cpp"
+    break;
+
+  case 181: /* formal_ls: formal_ls TCOMMA formal  */
+#line 691 "chapel.ypp"
+                           { (yyval.pfnsymbol) = buildFunctionFormal((yyvsp[-2].pfnsymbol), (yyvsp[0].pdefexpr)); }
+#line 5090 "chapel.tab.cpp"
+    break;
+
+  case 182: /* formal: opt_intent_tag ident opt_formal_type opt_init_expr  */
+#line 696 "chapel.ypp"
+    { (yyval.pdefexpr) = buildArgDefExpr((yyvsp[-3].pt), (yyvsp[-2].pch), (yyvsp[-1].pexpr), (yyvsp[0].pexpr), NULL); }
+#line 5096 "chapel.tab.cpp"
+    break;
+
+  case 183: /* formal: opt_intent_tag ident opt_formal_type var_arg_expr  */
+#line 698 "chapel.ypp"
+    { (yyval.pdefexpr) = buildArgDefExpr((yyvsp[-3].pt), (yyvsp[-2].pch), (yyvsp[-1].pexpr), NULL, (yyvsp[0].pexpr)); }
+#line 5102 "chapel.tab.cpp"
+    break;
+
+  case 184: /* formal: opt_intent_tag TLP tuple_var_decl_stmt_inner_ls TRP opt_formal_type opt_init_expr  */
+#line 700 "chapel.ypp"
+    { (yyval.pdefexpr) = buildTupleArgDefExpr((yyvsp[-5].pt), (yyvsp[-3].pblockstmt), (yyvsp[-1].pexpr), (yyvsp[0].pexpr)); }
+#line 5108 "chapel.tab.cpp"
+    break;
+
+  case 185: /* formal: opt_intent_tag TLP tuple_var_decl_stmt_inner_ls TRP opt_formal_type var_arg_expr  */
+#line 702 "chapel.ypp"
+    { USR_FATAL("variable-length argument may not be grouped in a tuple"); }
+#line 5114 "chapel.tab.cpp"
+    break;
+
+  case 186: /* opt_intent_tag: %empty  */
+#line 706 "chapel.ypp"
+          { (yyval.pt) = INTENT_BLANK; }
+#line 5120 "chapel.tab.cpp"
+    break;
+
+  case 187: /* opt_intent_tag: TIN  */
+#line 707 "chapel.ypp"
+          { (yyval.pt) = INTENT_IN; }
+#line 5126 "chapel.tab.cpp"
+    break;
+
+  case 188: /* opt_intent_tag: TINOUT  */
+#line 708 "chapel.ypp"
+          { (yyval.pt) = INTENT_INOUT; }
+#line 5132 "chapel.tab.cpp"
+    break;
+
+  case 189: /* opt_intent_tag: TOUT  */
+#line 709 "chapel.ypp"
+          { (yyval.pt) = INTENT_OUT; }
+#line 5138 "chapel.tab.cpp"
+    break;
+
+  case 190: /* opt_intent_tag: TCONST  */
+#line 710 "chapel.ypp"
+          { (yyval.pt) = INTENT_CONST; }
+#line 5144 "chapel.tab.cpp"
+    break;
+
+  case 191: /* opt_intent_tag: TCONST TIN  */
+#line 711 "chapel.ypp"
+             { (yyval.pt) = INTENT_CONST_IN; }
+#line 5150 "chapel.tab.cpp"
+    break;
+
+  case 192: /* opt_intent_tag: TCONST TREF  */
+#line 712 "chapel.ypp"
+              { (yyval.pt) = INTENT_CONST_REF; }
+#line 5156 "chapel.tab.cpp"
+    break;
+
+  case 193: /* opt_intent_tag: TPARAM  */
+#line 713 "chapel.ypp"
+          { (yyval.pt) = INTENT_PARAM; }
+#line 5162 "chapel.tab.cpp"
+    break;
+
+  case 194: /* opt_intent_tag: TREF  */
+#line 714 "chapel.ypp"
+          { (yyval.pt) = INTENT_REF; }
+#line 5168 "chapel.tab.cpp"
+    break;
+
+  case 195: /* opt_intent_tag: TTYPE  */
+#line 715 "chapel.ypp"
+          { (yyval.pt) = INTENT_TYPE; }
+#line 5174 "chapel.tab.cpp"
+    break;
+
+  case 196: /* opt_this_intent_tag: %empty  */
+#line 719 "chapel.ypp"
+         { (yyval.pt) = INTENT_BLANK; }
+#line 5180 "chapel.tab.cpp"
+    break;
+
+  case 197: /* opt_this_intent_tag: TPARAM  */
+#line 720 "chapel.ypp"
+         { (yyval.pt) = INTENT_PARAM; }
+#line 5186 "chapel.tab.cpp"
+    break;
+
+  case 198: /* opt_this_intent_tag: TREF  */
+#line 721 "chapel.ypp"
+         { (yyval.pt) = INTENT_REF;   }
+#line 5192 "chapel.tab.cpp"
+    break;
+
+  case 199: /* proc_or_iter: TPROC  */
+#line 725 "chapel.ypp"
+         { (yyval.procIter) = ProcIter_PROC; }
+#line 5198 "chapel.tab.cpp"
+    break;
+
+  case 200: /* proc_or_iter: TITER  */
+#line 726 "chapel.ypp"
+         { (yyval.procIter) = ProcIter_ITER; }
+#line 5204 "chapel.tab.cpp"
+    break;
+
+  case 201: /* opt_ret_tag: %empty  */
+#line 730 "chapel.ypp"
+            { (yyval.retTag) = RET_VALUE; }
+#line 5210 "chapel.tab.cpp"
+    break;
+
+  case 202: /* opt_ret_tag: TCONST  */
+#line 731 "chapel.ypp"
+            { (yyval.retTag) = RET_VALUE; }
+#line 5216 "chapel.tab.cpp"
+    break;
+
+  case 203: /* opt_ret_tag: TREF  */
+#line 732 "chapel.ypp"
+            { (yyval.retTag) = RET_REF; }
+#line 5222 "chapel.tab.cpp"
+    break;
+
+  case 204: /* opt_ret_tag: TPARAM  */
+#line 733 "chapel.ypp"
+            { (yyval.retTag) = RET_PARAM; }
+#line 5228 "chapel.tab.cpp"
+    break;
+
+  case 205: /* opt_ret_tag: TTYPE  */
+#line 734 "chapel.ypp"
+            { (yyval.retTag) = RET_TYPE; }
+#line 5234 "chapel.tab.cpp"
+    break;
+
+  case 206: /* opt_function_body_stmt: TSEMI  */
+#line 738 "chapel.ypp"
+            { (yyval.pblockstmt) = NULL; }
+#line 5240 "chapel.tab.cpp"
+    break;
+
+  case 209: /* function_body_stmt: return_stmt  */
+#line 744 "chapel.ypp"
+               { (yyval.pblockstmt) = new BlockStmt((yyvsp[0].pblockstmt)); }
+#line 5246 "chapel.tab.cpp"
+    break;
+
+  case 210: /* query_expr: TQUESTION ident  */
+#line 749 "chapel.ypp"
+    { (yyval.pdefexpr) = new DefExpr(new VarSymbol((yyvsp[0].pch))); }
+#line 5252 "chapel.tab.cpp"
+    break;
+
+  case 211: /* query_expr: TQUESTION  */
+#line 751 "chapel.ypp"
+    { (yyval.pdefexpr) = new DefExpr(new VarSymbol(astr("chpl__query", istr(query_uid++)))); }
+#line 5258 "chapel.tab.cpp"
+    break;
+
+  case 212: /* opt_query_expr: %empty  */
+#line 755 "chapel.ypp"
+    { (yyval.pdefexpr) = new DefExpr(new VarSymbol(astr("chpl__query", istr(query_uid++)))); }
+#line 5264 "chapel.tab.cpp"
+    break;
+
+  case 214: /* var_arg_expr: TDOTDOTDOT expr  */
+#line 760 "chapel.ypp"
+                             { (yyval.pexpr) = (yyvsp[0].pexpr); }
+#line 5270 "chapel.tab.cpp"
+    break;
+
+  case 215: /* var_arg_expr: TDOTDOTDOT opt_query_expr  */
+#line 761 "chapel.ypp"
+                             { (yyvsp[0].pdefexpr)->sym->addFlag(FLAG_PARAM); (yyval.pexpr) = (yyvsp[0].pdefexpr); }
+#line 5276 "chapel.tab.cpp"
+    break;
+
+  case 216: /* opt_where_part: %empty  */
+#line 765 "chapel.ypp"
+               { (yyval.pexpr) = NULL; }
+#line 5282 "chapel.tab.cpp"
+    break;
+
+  case 217: /* opt_where_part: TWHERE expr  */
+#line 766 "chapel.ypp"
+               { (yyval.pexpr) = (yyvsp[0].pexpr); }
+#line 5288 "chapel.tab.cpp"
+    break;
+
+  case 218: /* type_alias_decl_stmt: TTYPE type_alias_decl_stmt_inner TSEMI  */
+#line 771 "chapel.ypp"
+    { (yyval.pblockstmt) = (yyvsp[-1].pblockstmt); }
+#line 5294 "chapel.tab.cpp"
+    break;
+
+  case 219: /* type_alias_decl_stmt: TCONFIG TTYPE type_alias_decl_stmt_inner TSEMI  */
+#line 773 "chapel.ypp"
+    { (yyval.pblockstmt) = handleConfigTypes((yyvsp[-1].pblockstmt)); }
+#line 5300 "chapel.tab.cpp"
+    break;
+
+  case 220: /* type_alias_decl_stmt: TEXTERN TTYPE type_alias_decl_stmt_inner TSEMI  */
+#line 775 "chapel.ypp"
+    { (yyval.pblockstmt) = convertTypesToExtern((yyvsp[-1].pblockstmt)); }
+#line 5306 "chapel.tab.cpp"
+    break;
+
+  case 221: /* type_alias_decl_stmt_inner: ident opt_init_type  */
+#line 780 "chapel.ypp"
+    {
+      VarSymbol* var = new VarSymbol((yyvsp[-1].pch));
+      var->addFlag(FLAG_TYPE_VARIABLE);
+      DefExpr* def = new DefExpr(var, (yyvsp[0].pexpr));
+      (yyval.pblockstmt) = buildChapelStmt(def);
+    }
+#line 5317 "chapel.tab.cpp"
+    break;
+
+  case 222: /* type_alias_decl_stmt_inner: ident opt_init_type TCOMMA type_alias_decl_stmt_inner  */
+#line 787 "chapel.ypp"
+    {
+      VarSymbol* var = new VarSymbol((yyvsp[-3].pch));
+      var->addFlag(FLAG_TYPE_VARIABLE);
+      DefExpr* def = new DefExpr(var, (yyvsp[-2].pexpr));
+      (yyvsp[0].pblockstmt)->insertAtHead(def);
+      (yyval.pblockstmt) = buildChapelStmt((yyvsp[0].pblockstmt));
+    }
+#line 5329 "chapel.tab.cpp"
+    break;
+
+  case 223: /* opt_init_type: %empty  */
+#line 797 "chapel.ypp"
+    { (yyval.pexpr) = NULL; }
+#line 5335 "chapel.tab.cpp"
+    break;
+
+  case 224: /* opt_init_type: TASSIGN type_level_expr  */
+#line 799 "chapel.ypp"
+    { (yyval.pexpr) = (yyvsp[0].pexpr); }
+#line 5341 "chapel.tab.cpp"
+    break;
+
+  case 225: /* opt_init_type: TASSIGN array_type  */
+#line 801 "chapel.ypp"
+    { (yyval.pexpr) = buildForallLoopExprFromArrayType((yyvsp[0].pcallexpr)); }
+#line 5347 "chapel.tab.cpp"
+    break;
+
+  case 226: /* var_decl_stmt: opt_config TPARAM var_decl_stmt_inner_ls TSEMI  */
+#line 806 "chapel.ypp"
+    {
+      std::set<Flag> flags;
+      flags.insert((yyvsp[-3].flag));
+      flags.insert(FLAG_PARAM);
+      (yyval.pblockstmt) = buildVarDecls((yyvsp[-1].pblockstmt), flags, (yylsp[-3]).comment);
+    }
+#line 5358 "chapel.tab.cpp"
+    break;
+
+  case 227: /* var_decl_stmt: opt_config TCONST var_decl_stmt_inner_ls TSEMI  */
+#line 813 "chapel.ypp"
+    {
+      std::set<Flag> flags;
+      flags.insert((yyvsp[-3].flag));
+      flags.insert(FLAG_CONST);
+      (yyval.pblockstmt) = buildVarDecls((yyvsp[-1].pblockstmt), flags, (yylsp[-3]).comment);
+    }
+#line 5369 "chapel.tab.cpp"
+    break;
+
+  case 228: /* var_decl_stmt: opt_config TREF var_decl_stmt_inner_ls TSEMI  */
+#line 820 "chapel.ypp"
+    {
+      std::set<Flag> flags;
+      flags.insert((yyvsp[-3].flag));
+      flags.insert(FLAG_REF_VAR);
+      (yyval.pblockstmt) = buildVarDecls((yyvsp[-1].pblockstmt), flags, (yylsp[-3]).comment);
+    }
+#line 5380 "chapel.tab.cpp"
+    break;
+
+  case 229: /* var_decl_stmt: opt_config TCONST TREF var_decl_stmt_inner_ls TSEMI  */
+#line 827 "chapel.ypp"
+    {
+      std::set<Flag> flags;
+      flags.insert((yyvsp[-4].flag));
+      flags.insert(FLAG_CONST);
+      flags.insert(FLAG_REF_VAR);
+      (yyval.pblockstmt) = buildVarDecls((yyvsp[-1].pblockstmt), flags, (yylsp[-4]).comment);
+    }
+#line 5392 "chapel.tab.cpp"
+    break;
+
+  case 230: /* var_decl_stmt: opt_config TVAR var_decl_stmt_inner_ls TSEMI  */
+#line 835 "chapel.ypp"
+    {
+      std::set<Flag> flags;
+      flags.insert((yyvsp[-3].flag));
+      (yyval.pblockstmt) = buildVarDecls((yyvsp[-1].pblockstmt), flags, (yylsp[-3]).comment);
+    }
+#line 5402 "chapel.tab.cpp"
+    break;
+
+  case 231: /* opt_config: %empty  */
+#line 843 "chapel.ypp"
+            { (yyval.flag) = FLAG_UNKNOWN; (yyloc).comment = yylloc.comment; yylloc.comment = NULL;}
+#line 5408 "chapel.tab.cpp"
+    break;
+
+  case 232: /* opt_config: TCONFIG  */
+#line 844 "chapel.ypp"
+            { (yyval.flag) = FLAG_CONFIG; (yyloc).comment = yylloc.comment; yylloc.comment = NULL;}
+#line 5414 "chapel.tab.cpp"
+    break;
+
+  case 233: /* opt_config: TEXTERN  */
+#line 845 "chapel.ypp"
+            { (yyval.flag) = FLAG_EXTERN; (yyloc).comment = yylloc.comment; yylloc.comment = NULL;}
+#line 5420 "chapel.tab.cpp"
+    break;
+
+  case 235: /* var_decl_stmt_inner_ls: var_decl_stmt_inner_ls TCOMMA var_decl_stmt_inner  */
+#line 851 "chapel.ypp"
+    {
+      for_alist(expr, (yyvsp[0].pblockstmt)->body)
+        (yyvsp[-2].pblockstmt)->insertAtTail(expr->remove());
+    }
+#line 5429 "chapel.tab.cpp"
+    break;
+
+  case 236: /* var_decl_stmt_inner: ident opt_type opt_init_expr  */
+#line 859 "chapel.ypp"
+    { (yyval.pblockstmt) = buildChapelStmt(new DefExpr(new VarSymbol((yyvsp[-2].pch)), (yyvsp[0].pexpr), (yyvsp[-1].pexpr))); }
+#line 5435 "chapel.tab.cpp"
+    break;
+
+  case 237: /* var_decl_stmt_inner: ident opt_reindex_expr TALIAS expr  */
+#line 861 "chapel.ypp"
+    {
+      VarSymbol* var = new VarSymbol((yyvsp[-3].pch));
+      var->addFlag(FLAG_ARRAY_ALIAS);
+      (yyval.pblockstmt) = buildChapelStmt(new DefExpr(var, (yyvsp[0].pexpr), (yyvsp[-2].pexpr)));
+    }
+#line 5445 "chapel.tab.cpp"
+    break;
+
+  case 238: /* var_decl_stmt_inner: TLP tuple_var_decl_stmt_inner_ls TRP opt_type opt_init_expr  */
+#line 867 "chapel.ypp"
+    { (yyval.pblockstmt) = buildTupleVarDeclStmt((yyvsp[-3].pblockstmt), (yyvsp[-1].pexpr), (yyvsp[0].pexpr)); }
+#line 5451 "chapel.tab.cpp"
+    break;
+
+  case 239: /* tuple_var_decl_component: TUNDERSCORE  */
+#line 872 "chapel.ypp"
+    { (yyval.pexpr) = new DefExpr(new VarSymbol("chpl__tuple_blank")); }
+#line 5457 "chapel.tab.cpp"
+    break;
+
+  case 240: /* tuple_var_decl_component: ident  */
+#line 874 "chapel.ypp"
+    { (yyval.pexpr) = new DefExpr(new VarSymbol((yyvsp[0].pch))); }
+#line 5463 "chapel.tab.cpp"
+    break;
+
+  case 241: /* tuple_var_decl_component: TLP tuple_var_decl_stmt_inner_ls TRP  */
+#line 876 "chapel.ypp"
+    { (yyval.pexpr) = (yyvsp[-1].pblockstmt); }
+#line 5469 "chapel.tab.cpp"
+    break;
+
+  case 242: /* tuple_var_decl_stmt_inner_ls: tuple_var_decl_component  */
+#line 881 "chapel.ypp"
+    { (yyval.pblockstmt) = buildChapelStmt((yyvsp[0].pexpr)); }
+#line 5475 "chapel.tab.cpp"
+    break;
+
+  case 243: /* tuple_var_decl_stmt_inner_ls: tuple_var_decl_component TCOMMA  */
+#line 883 "chapel.ypp"
+    { (yyval.pblockstmt) = buildChapelStmt((yyvsp[-1].pexpr)); }
+#line 5481 "chapel.tab.cpp"
+    break;
+
+  case 244: /* tuple_var_decl_stmt_inner_ls: tuple_var_decl_component TCOMMA tuple_var_decl_stmt_inner_ls  */
+#line 885 "chapel.ypp"
+    { (yyval.pblockstmt) = ((yyvsp[0].pblockstmt)->insertAtHead((yyvsp[-2].pexpr)), (yyvsp[0].pblockstmt)); }
+#line 5487 "chapel.tab.cpp"
+    break;
+
+  case 245: /* opt_init_expr: %empty  */
+#line 891 "chapel.ypp"
+                { (yyval.pexpr) = NULL; }
+#line 5493 "chapel.tab.cpp"
+    break;
+
+  case 246: /* opt_init_expr: TASSIGN TNOINIT  */
+#line 892 "chapel.ypp"
+                  { (yyval.pexpr) = new SymExpr(gNoInit); }
+#line 5499 "chapel.tab.cpp"
+    break;
+
+  case 247: /* opt_init_expr: TASSIGN expr  */
+#line 893 "chapel.ypp"
+                { (yyval.pexpr) = (yyvsp[0].pexpr); }
+#line 5505 "chapel.tab.cpp"
+    break;
+
+  case 248: /* opt_reindex_expr: %empty  */
+#line 897 "chapel.ypp"
+    { (yyval.pexpr) = NULL; }
+#line 5511 "chapel.tab.cpp"
+    break;
+
+  case 249: /* opt_reindex_expr: TCOLON TLSBR expr_ls TRSBR  */
+#line 899 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("chpl__ensureDomainExpr", (yyvsp[-1].pcallexpr)); }
+#line 5517 "chapel.tab.cpp"
+    break;
+
+  case 250: /* opt_type: %empty  */
+#line 903 "chapel.ypp"
+                          { (yyval.pexpr) = NULL; }
+#line 5523 "chapel.tab.cpp"
+    break;
+
+  case 251: /* opt_type: TCOLON type_level_expr  */
+#line 904 "chapel.ypp"
+                          { (yyval.pexpr) = (yyvsp[0].pexpr); }
+#line 5529 "chapel.tab.cpp"
+    break;
+
+  case 252: /* opt_type: TCOLON array_type  */
+#line 905 "chapel.ypp"
+                          { (yyval.pexpr) = (yyvsp[0].pcallexpr); }
+#line 5535 "chapel.tab.cpp"
+    break;
+
+  case 253: /* opt_type: error  */
+#line 906 "chapel.ypp"
+        {printf("bad type specification"); }
+#line 5541 "chapel.tab.cpp"
+    break;
+
+  case 254: /* array_type: TLSBR expr_ls TRSBR type_level_expr  */
+#line 927 "chapel.ypp"
+    { (yyval.pcallexpr) = new CallExpr("chpl__buildArrayRuntimeType",
+             new CallExpr("chpl__ensureDomainExpr", (yyvsp[-2].pcallexpr)), (yyvsp[0].pexpr)); 
+    }
+#line 5549 "chapel.tab.cpp"
+    break;
+
+  case 255: /* array_type: TLSBR expr_ls TRSBR array_type  */
+#line 931 "chapel.ypp"
+    { (yyval.pcallexpr) = new CallExpr("chpl__buildArrayRuntimeType",
+             new CallExpr("chpl__ensureDomainExpr", (yyvsp[-2].pcallexpr)), (yyvsp[0].pcallexpr)); 
+    }
+#line 5557 "chapel.tab.cpp"
+    break;
+
+  case 256: /* array_type: TLSBR expr_ls TIN expr TRSBR type_level_expr  */
+#line 935 "chapel.ypp"
+    { 
+      if ((yyvsp[-4].pcallexpr)->argList.length != 1)
+        USR_FATAL((yyvsp[-2].pexpr), "invalid index expression");
+      (yyval.pcallexpr) = new CallExpr("chpl__buildArrayRuntimeType",
+             new CallExpr("chpl__ensureDomainExpr", (yyvsp[-2].pexpr)), (yyvsp[0].pexpr), (yyvsp[-4].pcallexpr)->get(1)->remove(),
+             new CallExpr("chpl__ensureDomainExpr", (yyvsp[-2].pexpr)->copy()));
+    }
+#line 5569 "chapel.tab.cpp"
+    break;
+
+  case 257: /* array_type: error  */
+#line 942 "chapel.ypp"
+         {printf("bad array type specification"); clean_exit(1); }
+#line 5575 "chapel.tab.cpp"
+    break;
+
+  case 258: /* opt_formal_array_elt_type: %empty  */
+#line 946 "chapel.ypp"
+                        { (yyval.pexpr) = NULL; }
+#line 5581 "chapel.tab.cpp"
+    break;
+
+  case 259: /* opt_formal_array_elt_type: type_level_expr  */
+#line 947 "chapel.ypp"
+                        { (yyval.pexpr) = (yyvsp[0].pexpr); }
+#line 5587 "chapel.tab.cpp"
+    break;
+
+  case 260: /* opt_formal_array_elt_type: query_expr  */
+#line 948 "chapel.ypp"
+                        { (yyval.pexpr) = (yyvsp[0].pdefexpr); }
+#line 5593 "chapel.tab.cpp"
+    break;
+
+  case 261: /* formal_array_type: TLSBR TRSBR opt_formal_array_elt_type  */
+#line 953 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("chpl__buildArrayRuntimeType", gNil, (yyvsp[0].pexpr)); }
+#line 5599 "chapel.tab.cpp"
+    break;
+
+  case 262: /* formal_array_type: TLSBR expr_ls TRSBR opt_formal_array_elt_type  */
+#line 955 "chapel.ypp"
+    { (yyval.pexpr) = buildFormalArrayType((yyvsp[-2].pcallexpr), (yyvsp[0].pexpr)); }
+#line 5605 "chapel.tab.cpp"
+    break;
+
+  case 263: /* formal_array_type: TLSBR TRSBR formal_array_type  */
+#line 961 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("chpl__buildArrayRuntimeType", gNil, (yyvsp[0].pexpr)); }
+#line 5611 "chapel.tab.cpp"
+    break;
+
+  case 264: /* formal_array_type: TLSBR expr_ls TRSBR formal_array_type  */
+#line 963 "chapel.ypp"
+    { (yyval.pexpr) = buildFormalArrayType((yyvsp[-2].pcallexpr), (yyvsp[0].pexpr)); }
+#line 5617 "chapel.tab.cpp"
+    break;
+
+  case 265: /* formal_array_type: TLSBR expr_ls TIN expr TRSBR opt_formal_array_elt_type  */
+#line 965 "chapel.ypp"
+    { (yyval.pexpr) = buildFormalArrayType((yyvsp[-2].pexpr), (yyvsp[0].pexpr), (yyvsp[-4].pcallexpr)); }
+#line 5623 "chapel.tab.cpp"
+    break;
+
+  case 266: /* opt_formal_type: %empty  */
+#line 969 "chapel.ypp"
+                            { (yyval.pexpr) = NULL; }
+#line 5629 "chapel.tab.cpp"
+    break;
+
+  case 267: /* opt_formal_type: TCOLON type_level_expr  */
+#line 970 "chapel.ypp"
+                            { (yyval.pexpr) = (yyvsp[0].pexpr); }
+#line 5635 "chapel.tab.cpp"
+    break;
+
+  case 268: /* opt_formal_type: TCOLON query_expr  */
+#line 971 "chapel.ypp"
+                            { (yyval.pexpr) = (yyvsp[0].pdefexpr); }
+#line 5641 "chapel.tab.cpp"
+    break;
+
+  case 269: /* opt_formal_type: TCOLON TDOMAIN  */
+#line 972 "chapel.ypp"
+                            { (yyval.pexpr) = new UnresolvedSymExpr("_domain"); }
+#line 5647 "chapel.tab.cpp"
+    break;
+
+  case 270: /* opt_formal_type: TCOLON TSINGLE  */
+#line 973 "chapel.ypp"
+                            { (yyval.pexpr) = new UnresolvedSymExpr( "_singlevar"); }
+#line 5653 "chapel.tab.cpp"
+    break;
+
+  case 271: /* opt_formal_type: TCOLON TSYNC  */
+#line 974 "chapel.ypp"
+                            { (yyval.pexpr) = new UnresolvedSymExpr( "_syncvar"); }
+#line 5659 "chapel.tab.cpp"
+    break;
+
+  case 272: /* opt_formal_type: TCOLON formal_array_type  */
+#line 975 "chapel.ypp"
+                            { (yyval.pexpr) = (yyvsp[0].pexpr); }
+#line 5665 "chapel.tab.cpp"
+    break;
+
+  case 273: /* expr_ls: expr  */
+#line 981 "chapel.ypp"
+                             { (yyval.pcallexpr) = new CallExpr(PRIM_ACTUALS_LIST, (yyvsp[0].pexpr)); }
+#line 5671 "chapel.tab.cpp"
+    break;
+
+  case 274: /* expr_ls: query_expr  */
+#line 982 "chapel.ypp"
+                             { (yyval.pcallexpr) = new CallExpr(PRIM_ACTUALS_LIST, (yyvsp[0].pdefexpr)); }
+#line 5677 "chapel.tab.cpp"
+    break;
+
+  case 275: /* expr_ls: expr_ls TCOMMA expr  */
+#line 983 "chapel.ypp"
+                             { (yyvsp[-2].pcallexpr)->insertAtTail((yyvsp[0].pexpr)); }
+#line 5683 "chapel.tab.cpp"
+    break;
+
+  case 276: /* expr_ls: expr_ls TCOMMA query_expr  */
+#line 984 "chapel.ypp"
+                             { (yyvsp[-2].pcallexpr)->insertAtTail((yyvsp[0].pdefexpr)); }
+#line 5689 "chapel.tab.cpp"
+    break;
+
+  case 277: /* tuple_component: TUNDERSCORE  */
+#line 988 "chapel.ypp"
+                { (yyval.pexpr) = new UnresolvedSymExpr("chpl__tuple_blank"); }
+#line 5695 "chapel.tab.cpp"
+    break;
+
+  case 278: /* tuple_component: expr  */
+#line 989 "chapel.ypp"
+                { (yyval.pexpr) = (yyvsp[0].pexpr); }
+#line 5701 "chapel.tab.cpp"
+    break;
+
+  case 279: /* tuple_component: query_expr  */
+#line 990 "chapel.ypp"
+                { (yyval.pexpr) = (yyvsp[0].pdefexpr); }
+#line 5707 "chapel.tab.cpp"
+    break;
+
+  case 280: /* tuple_expr_ls: tuple_component TCOMMA tuple_component  */
+#line 994 "chapel.ypp"
+                                         { (yyval.pcallexpr) = new CallExpr(PRIM_ACTUALS_LIST, (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 5713 "chapel.tab.cpp"
+    break;
+
+  case 281: /* tuple_expr_ls: tuple_expr_ls TCOMMA tuple_component  */
+#line 995 "chapel.ypp"
+                                       { (yyvsp[-2].pcallexpr)->insertAtTail((yyvsp[0].pexpr)); }
+#line 5719 "chapel.tab.cpp"
+    break;
+
+  case 282: /* opt_actual_ls: %empty  */
+#line 999 "chapel.ypp"
+             { (yyval.pcallexpr) = new CallExpr(PRIM_ACTUALS_LIST); }
+#line 5725 "chapel.tab.cpp"
+    break;
+
+  case 284: /* actual_ls: actual_expr  */
+#line 1004 "chapel.ypp"
+                                { (yyval.pcallexpr) = new CallExpr(PRIM_ACTUALS_LIST, (yyvsp[0].pexpr)); }
+#line 5731 "chapel.tab.cpp"
+    break;
+
+  case 285: /* actual_ls: actual_ls TCOMMA actual_expr  */
+#line 1005 "chapel.ypp"
+                                { (yyvsp[-2].pcallexpr)->insertAtTail((yyvsp[0].pexpr)); }
+#line 5737 "chapel.tab.cpp"
+    break;
+
+  case 286: /* actual_expr: ident TASSIGN query_expr  */
+#line 1009 "chapel.ypp"
+                            { (yyval.pexpr) = buildNamedActual((yyvsp[-2].pch), (yyvsp[0].pdefexpr)); }
+#line 5743 "chapel.tab.cpp"
+    break;
+
+  case 287: /* actual_expr: ident TASSIGN expr  */
+#line 1010 "chapel.ypp"
+                            { (yyval.pexpr) = buildNamedActual((yyvsp[-2].pch), (yyvsp[0].pexpr)); }
+#line 5749 "chapel.tab.cpp"
+    break;
+
+  case 288: /* actual_expr: ident TALIAS expr  */
+#line 1011 "chapel.ypp"
+                            { (yyval.pexpr) = buildNamedAliasActual((yyvsp[-2].pch), (yyvsp[0].pexpr)); }
+#line 5755 "chapel.tab.cpp"
+    break;
+
+  case 289: /* actual_expr: query_expr  */
+#line 1012 "chapel.ypp"
+                            { (yyval.pexpr) = (yyvsp[0].pdefexpr); }
+#line 5761 "chapel.tab.cpp"
+    break;
+
+  case 291: /* ident_expr: ident  */
+#line 1017 "chapel.ypp"
+            { (yyval.pexpr) = new UnresolvedSymExpr((yyvsp[0].pch)); }
+#line 5767 "chapel.tab.cpp"
+    break;
+
+  case 297: /* type_level_expr: TSINGLE expr  */
+#line 1034 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr( "_singlevar", (yyvsp[0].pexpr)); }
+#line 5773 "chapel.tab.cpp"
+    break;
+
+  case 298: /* type_level_expr: TINDEX TLP opt_actual_ls TRP  */
+#line 1036 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("chpl__buildIndexType", (yyvsp[-1].pcallexpr)); }
+#line 5779 "chapel.tab.cpp"
+    break;
+
+  case 299: /* type_level_expr: TDOMAIN TLP opt_actual_ls TRP  */
+#line 1038 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("chpl__buildDomainRuntimeType", new UnresolvedSymExpr("defaultDist"), (yyvsp[-1].pcallexpr)); }
+#line 5785 "chapel.tab.cpp"
+    break;
+
+  case 300: /* type_level_expr: TSUBDOMAIN TLP opt_actual_ls TRP  */
+#line 1040 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("chpl__buildSubDomainType", (yyvsp[-1].pcallexpr)); }
+#line 5791 "chapel.tab.cpp"
+    break;
+
+  case 301: /* type_level_expr: TSPARSE TSUBDOMAIN TLP opt_actual_ls TRP  */
+#line 1042 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("chpl__buildSparseDomainRuntimeType", new UnresolvedSymExpr("defaultDist"), (yyvsp[-1].pcallexpr)); }
+#line 5797 "chapel.tab.cpp"
+    break;
+
+  case 302: /* type_level_expr: TATOMIC expr  */
+#line 1044 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("chpl__atomicType", (yyvsp[0].pexpr)); }
+#line 5803 "chapel.tab.cpp"
+    break;
+
+  case 303: /* type_level_expr: TSYNC expr  */
+#line 1046 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr( "_syncvar", (yyvsp[0].pexpr)); }
+#line 5809 "chapel.tab.cpp"
+    break;
+
+  case 304: /* for_expr: TFOR expr TIN expr TDO expr  */
+#line 1051 "chapel.ypp"
+    { (yyval.pexpr) = buildForLoopExpr((yyvsp[-4].pexpr), (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 5815 "chapel.tab.cpp"
+    break;
+
+  case 305: /* for_expr: TFOR expr TIN zippered_iterator TDO expr  */
+#line 1053 "chapel.ypp"
+    { (yyval.pexpr) = buildForLoopExpr((yyvsp[-4].pexpr), (yyvsp[-2].pexpr), (yyvsp[0].pexpr), NULL, false, true); }
+#line 5821 "chapel.tab.cpp"
+    break;
+
+  case 306: /* for_expr: TFOR expr TDO expr  */
+#line 1055 "chapel.ypp"
+    { (yyval.pexpr) = buildForLoopExpr(NULL, (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 5827 "chapel.tab.cpp"
+    break;
+
+  case 307: /* for_expr: TFOR expr TIN expr TDO TIF expr TTHEN expr  */
+#line 1057 "chapel.ypp"
+    { (yyval.pexpr) = buildForLoopExpr((yyvsp[-7].pexpr), (yyvsp[-5].pexpr), (yyvsp[0].pexpr), (yyvsp[-2].pexpr)); }
+#line 5833 "chapel.tab.cpp"
+    break;
+
+  case 308: /* for_expr: TFOR expr TIN zippered_iterator TDO TIF expr TTHEN expr  */
+#line 1059 "chapel.ypp"
+    { (yyval.pexpr) = buildForLoopExpr((yyvsp[-7].pexpr), (yyvsp[-5].pexpr), (yyvsp[0].pexpr), (yyvsp[-2].pexpr), false, true); }
+#line 5839 "chapel.tab.cpp"
+    break;
+
+  case 309: /* for_expr: TFOR expr TDO TIF expr TTHEN expr  */
+#line 1061 "chapel.ypp"
+    { (yyval.pexpr) = buildForLoopExpr(NULL, (yyvsp[-5].pexpr), (yyvsp[0].pexpr), (yyvsp[-2].pexpr)); }
+#line 5845 "chapel.tab.cpp"
+    break;
+
+  case 310: /* for_expr: TFORALL expr TIN expr TDO expr  */
+#line 1063 "chapel.ypp"
+    { (yyval.pexpr) = buildForallLoopExpr((yyvsp[-4].pexpr), (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 5851 "chapel.tab.cpp"
+    break;
+
+  case 311: /* for_expr: TFORALL expr TIN zippered_iterator TDO expr  */
+#line 1065 "chapel.ypp"
+    { (yyval.pexpr) = buildForallLoopExpr((yyvsp[-4].pexpr), (yyvsp[-2].pexpr), (yyvsp[0].pexpr), NULL, false, true); }
+#line 5857 "chapel.tab.cpp"
+    break;
+
+  case 312: /* for_expr: TFORALL expr TDO expr  */
+#line 1067 "chapel.ypp"
+    { (yyval.pexpr) = buildForallLoopExpr(NULL, (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 5863 "chapel.tab.cpp"
+    break;
+
+  case 313: /* for_expr: TFORALL expr TIN expr TDO TIF expr TTHEN expr  */
+#line 1069 "chapel.ypp"
+    { (yyval.pexpr) = buildForallLoopExpr((yyvsp[-7].pexpr), (yyvsp[-5].pexpr), (yyvsp[0].pexpr), (yyvsp[-2].pexpr)); }
+#line 5869 "chapel.tab.cpp"
+    break;
+
+  case 314: /* for_expr: TFORALL expr TIN zippered_iterator TDO TIF expr TTHEN expr  */
+#line 1071 "chapel.ypp"
+    { (yyval.pexpr) = buildForallLoopExpr((yyvsp[-7].pexpr), (yyvsp[-5].pexpr), (yyvsp[0].pexpr), (yyvsp[-2].pexpr), false, true); }
+#line 5875 "chapel.tab.cpp"
+    break;
+
+  case 315: /* for_expr: TFORALL expr TDO TIF expr TTHEN expr  */
+#line 1073 "chapel.ypp"
+    { (yyval.pexpr) = buildForallLoopExpr(NULL, (yyvsp[-5].pexpr), (yyvsp[0].pexpr), (yyvsp[-2].pexpr)); }
+#line 5881 "chapel.tab.cpp"
+    break;
+
+  case 316: /* for_expr: TLSBR expr_ls TRSBR expr  */
+#line 1075 "chapel.ypp"
+    {
+      if ((yyvsp[-2].pcallexpr)->argList.length > 1)
+        (yyval.pexpr) = buildForallLoopExpr(NULL, new CallExpr("chpl__ensureDomainExpr", (yyvsp[-2].pcallexpr)), (yyvsp[0].pexpr), NULL, true);
+      else
+        (yyval.pexpr) = buildForallLoopExpr(NULL, (yyvsp[-2].pcallexpr)->get(1)->remove(), (yyvsp[0].pexpr), NULL, true);
+    }
+#line 5892 "chapel.tab.cpp"
+    break;
+
+  case 317: /* for_expr: TLSBR expr_ls TIN expr TRSBR expr  */
+#line 1082 "chapel.ypp"
+    {
+      if ((yyvsp[-4].pcallexpr)->argList.length != 1)
+        USR_FATAL((yyvsp[-2].pexpr), "invalid index expression");
+      (yyval.pexpr) = buildForallLoopExpr((yyvsp[-4].pcallexpr)->get(1)->remove(), (yyvsp[-2].pexpr), (yyvsp[0].pexpr), NULL, true);
+    }
+#line 5902 "chapel.tab.cpp"
+    break;
+
+  case 318: /* for_expr: TLSBR expr_ls TIN zippered_iterator TRSBR expr  */
+#line 1088 "chapel.ypp"
+    {
+      if ((yyvsp[-4].pcallexpr)->argList.length != 1)
+        USR_FATAL((yyvsp[-2].pexpr), "invalid index expression");
+      (yyval.pexpr) = buildForallLoopExpr((yyvsp[-4].pcallexpr)->get(1)->remove(), (yyvsp[-2].pexpr), (yyvsp[0].pexpr), NULL, false, true);
+    }
+#line 5912 "chapel.tab.cpp"
+    break;
+
+  case 319: /* for_expr: TLSBR expr_ls TIN expr TRSBR TIF expr TTHEN expr  */
+#line 1094 "chapel.ypp"
+    {
+      if ((yyvsp[-7].pcallexpr)->argList.length != 1)
+        USR_FATAL((yyvsp[-5].pexpr), "invalid index expression");
+      (yyval.pexpr) = buildForallLoopExpr((yyvsp[-7].pcallexpr)->get(1)->remove(), (yyvsp[-5].pexpr), (yyvsp[0].pexpr), (yyvsp[-2].pexpr));
+    }
+#line 5922 "chapel.tab.cpp"
+    break;
+
+  case 320: /* for_expr: TLSBR expr_ls TIN zippered_iterator TRSBR TIF expr TTHEN expr  */
+#line 1100 "chapel.ypp"
+    {
+      if ((yyvsp[-7].pcallexpr)->argList.length != 1)
+        USR_FATAL((yyvsp[-5].pexpr), "invalid index expression");
+      (yyval.pexpr) = buildForallLoopExpr((yyvsp[-7].pcallexpr)->get(1)->remove(), (yyvsp[-5].pexpr), (yyvsp[0].pexpr), (yyvsp[-2].pexpr), false, true);
+    }
+#line 5932 "chapel.tab.cpp"
+    break;
+
+  case 321: /* cond_expr: TIF expr TTHEN expr TELSE expr  */
+#line 1109 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr(new DefExpr(buildIfExpr((yyvsp[-4].pexpr), (yyvsp[-2].pexpr), (yyvsp[0].pexpr)))); }
+#line 5938 "chapel.tab.cpp"
+    break;
+
+  case 322: /* nil_expr: TNIL  */
+#line 1113 "chapel.ypp"
+            { (yyval.pexpr) = new SymExpr(gNil); }
+#line 5944 "chapel.tab.cpp"
+    break;
+
+  case 330: /* stmt_level_expr: io_expr TIO expr  */
+#line 1129 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("<~>", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 5950 "chapel.tab.cpp"
+    break;
+
+  case 331: /* opt_task_intent_ls: %empty  */
+#line 1133 "chapel.ypp"
+                                { (yyval.pcallexpr) = NULL; }
+#line 5956 "chapel.tab.cpp"
+    break;
+
+  case 333: /* task_intent_clause: TWITH TLP task_intent_ls TRP  */
+#line 1138 "chapel.ypp"
+                                { (yyval.pcallexpr) = (yyvsp[-1].pcallexpr); }
+#line 5962 "chapel.tab.cpp"
+    break;
+
+  case 334: /* task_intent_ls: intent_expr  */
+#line 1142 "chapel.ypp"
+                                    { (yyval.pcallexpr) = new CallExpr(PRIM_ACTUALS_LIST, (yyvsp[0].pexpr)); }
+#line 5968 "chapel.tab.cpp"
+    break;
+
+  case 335: /* task_intent_ls: task_intent_ls TCOMMA intent_expr  */
+#line 1143 "chapel.ypp"
+                                    { (yyvsp[-2].pcallexpr)->insertAtTail((yyvsp[0].pexpr)); }
+#line 5974 "chapel.tab.cpp"
+    break;
+
+  case 336: /* intent_expr: opt_intent_tag ident_expr  */
+#line 1148 "chapel.ypp"
+    {
+      if ((yyvsp[-1].pt) != INTENT_REF) {
+        USR_FATAL((yyvsp[0].pexpr), "Only 'ref' intents are currently supported in with clauses");
+      } else {
+        (yyval.pexpr) = (yyvsp[0].pexpr);
+      }
+    }
+#line 5986 "chapel.tab.cpp"
+    break;
+
+  case 338: /* io_expr: io_expr TIO expr  */
+#line 1160 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("<~>", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 5992 "chapel.tab.cpp"
+    break;
+
+  case 339: /* new_expr: TNEW expr  */
+#line 1165 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr(PRIM_NEW, (yyvsp[0].pexpr)); }
+#line 5998 "chapel.tab.cpp"
+    break;
+
+  case 340: /* let_expr: TLET var_decl_stmt_inner_ls TIN expr  */
+#line 1170 "chapel.ypp"
+    { (yyval.pexpr) = buildLetExpr((yyvsp[-2].pblockstmt), (yyvsp[0].pexpr)); }
+#line 6004 "chapel.tab.cpp"
+    break;
+
+  case 349: /* expr: TLP TDOTDOTDOT expr TRP  */
+#line 1186 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr(PRIM_TUPLE_EXPAND, (yyvsp[-1].pexpr)); }
+#line 6010 "chapel.tab.cpp"
+    break;
+
+  case 350: /* expr: expr TCOLON expr  */
+#line 1188 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("_cast", (yyvsp[0].pexpr), (yyvsp[-2].pexpr)); }
+#line 6016 "chapel.tab.cpp"
+    break;
+
+  case 351: /* expr: expr TDOTDOT expr  */
+#line 1190 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("_build_range", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6022 "chapel.tab.cpp"
+    break;
+
+  case 352: /* expr: expr TDOTDOT  */
+#line 1192 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("_build_range", buildDotExpr("BoundedRangeType", "boundedLow"), (yyvsp[-1].pexpr)); }
+#line 6028 "chapel.tab.cpp"
+    break;
+
+  case 353: /* expr: TDOTDOT expr  */
+#line 1194 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("_build_range", buildDotExpr("BoundedRangeType", "boundedHigh"), (yyvsp[0].pexpr)); }
+#line 6034 "chapel.tab.cpp"
+    break;
+
+  case 354: /* expr: TDOTDOT  */
+#line 1196 "chapel.ypp"
+    { (yyval.pexpr) = new CallExpr("_build_range", buildDotExpr("BoundedRangeType", "boundedNone")); }
+#line 6040 "chapel.tab.cpp"
+    break;
+
+  case 361: /* call_expr: fun_expr TLP opt_actual_ls TRP  */
+#line 1219 "chapel.ypp"
+                                        { (yyval.pexpr) = new CallExpr((yyvsp[-3].pexpr), (yyvsp[-1].pcallexpr)); }
+#line 6046 "chapel.tab.cpp"
+    break;
+
+  case 362: /* call_expr: fun_expr TLSBR opt_actual_ls TRSBR  */
+#line 1220 "chapel.ypp"
+                                        { (yyval.pexpr) = buildSquareCallExpr((yyvsp[-3].pexpr), (yyvsp[-1].pcallexpr)); }
+#line 6052 "chapel.tab.cpp"
+    break;
+
+  case 363: /* call_expr: TPRIMITIVE TLP opt_actual_ls TRP  */
+#line 1221 "chapel.ypp"
+                                        { (yyval.pexpr) = buildPrimitiveExpr((yyvsp[-1].pcallexpr)); }
+#line 6058 "chapel.tab.cpp"
+    break;
+
+  case 364: /* dot_expr: expr TDOT ident  */
+#line 1225 "chapel.ypp"
+                     { (yyval.pexpr) = buildDotExpr((yyvsp[-2].pexpr), (yyvsp[0].pch)); }
+#line 6064 "chapel.tab.cpp"
+    break;
+
+  case 365: /* dot_expr: expr TDOT TTYPE  */
+#line 1226 "chapel.ypp"
+                     { (yyval.pexpr) = new CallExpr(PRIM_TYPEOF, (yyvsp[-2].pexpr)); }
+#line 6070 "chapel.tab.cpp"
+    break;
+
+  case 366: /* dot_expr: expr TDOT TDOMAIN  */
+#line 1227 "chapel.ypp"
+                     { (yyval.pexpr) = buildDotExpr((yyvsp[-2].pexpr), "_dom"); }
+#line 6076 "chapel.tab.cpp"
+    break;
+
+  case 367: /* parenthesized_expr: TLP tuple_component TRP  */
+#line 1235 "chapel.ypp"
+                                    { (yyval.pexpr) = (yyvsp[-1].pexpr); }
+#line 6082 "chapel.tab.cpp"
+    break;
+
+  case 368: /* parenthesized_expr: TLP tuple_component TCOMMA TRP  */
+#line 1236 "chapel.ypp"
+                                    { (yyval.pexpr) = buildOneTuple((yyvsp[-2].pexpr)); }
+#line 6088 "chapel.tab.cpp"
+    break;
+
+  case 369: /* parenthesized_expr: TLP tuple_expr_ls TRP  */
+#line 1237 "chapel.ypp"
+                                    { (yyval.pexpr) = buildTuple((yyvsp[-1].pcallexpr)); }
+#line 6094 "chapel.tab.cpp"
+    break;
+
+  case 370: /* literal_expr: INTLITERAL  */
+#line 1241 "chapel.ypp"
+                        { (yyval.pexpr) = buildIntLiteral(yytext); }
+#line 6100 "chapel.tab.cpp"
+    break;
+
+  case 371: /* literal_expr: REALLITERAL  */
+#line 1242 "chapel.ypp"
+                        { (yyval.pexpr) = buildRealLiteral(yytext); }
+#line 6106 "chapel.tab.cpp"
+    break;
+
+  case 372: /* literal_expr: IMAGLITERAL  */
+#line 1243 "chapel.ypp"
+                        { (yyval.pexpr) = buildImagLiteral(yytext); }
+#line 6112 "chapel.tab.cpp"
+    break;
+
+  case 373: /* literal_expr: STRINGLITERAL  */
+#line 1244 "chapel.ypp"
+                        { (yyval.pexpr) = buildStringLiteral((yyvsp[0].pch)); }
+#line 6118 "chapel.tab.cpp"
+    break;
+
+  case 374: /* literal_expr: TLCBR expr_ls TRCBR  */
+#line 1245 "chapel.ypp"
+                        { (yyval.pexpr) = new CallExpr("chpl__buildDomainExpr", (yyvsp[-1].pcallexpr)); }
+#line 6124 "chapel.tab.cpp"
+    break;
+
+  case 375: /* literal_expr: TLSBR expr_ls TRSBR  */
+#line 1246 "chapel.ypp"
+                        { (yyval.pexpr) = new CallExpr("chpl__buildArrayExpr", (yyvsp[-1].pcallexpr)); }
+#line 6130 "chapel.tab.cpp"
+    break;
+
+  case 376: /* literal_expr: TLSBR assoc_expr_ls TRSBR  */
+#line 1248 "chapel.ypp"
+    {
+      (yyval.pexpr) = new CallExpr("chpl__buildAssociativeArrayExpr", (yyvsp[-1].pcallexpr));
+    }
+#line 6138 "chapel.tab.cpp"
+    break;
+
+  case 377: /* assoc_expr_ls: expr TALIAS expr  */
+#line 1254 "chapel.ypp"
+                                        { (yyval.pcallexpr) = new CallExpr(PRIM_ACTUALS_LIST, (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6144 "chapel.tab.cpp"
+    break;
+
+  case 378: /* assoc_expr_ls: assoc_expr_ls TCOMMA expr TALIAS expr  */
+#line 1255 "chapel.ypp"
+                                        { (yyvsp[-4].pcallexpr)->insertAtTail((yyvsp[-2].pexpr)); (yyvsp[-4].pcallexpr)->insertAtTail((yyvsp[0].pexpr)); }
+#line 6150 "chapel.tab.cpp"
+    break;
+
+  case 379: /* binary_op_expr: expr TPLUS expr  */
+#line 1259 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("+", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6156 "chapel.tab.cpp"
+    break;
+
+  case 380: /* binary_op_expr: expr TMINUS expr  */
+#line 1260 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("-", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6162 "chapel.tab.cpp"
+    break;
+
+  case 381: /* binary_op_expr: expr TSTAR expr  */
+#line 1261 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("*", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6168 "chapel.tab.cpp"
+    break;
+
+  case 382: /* binary_op_expr: expr TDIVIDE expr  */
+#line 1262 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("/", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6174 "chapel.tab.cpp"
+    break;
+
+  case 383: /* binary_op_expr: expr TSHIFTLEFT expr  */
+#line 1263 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("<<", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6180 "chapel.tab.cpp"
+    break;
+
+  case 384: /* binary_op_expr: expr TSHIFTRIGHT expr  */
+#line 1264 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr(">>", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6186 "chapel.tab.cpp"
+    break;
+
+  case 385: /* binary_op_expr: expr TMOD expr  */
+#line 1265 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("%", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6192 "chapel.tab.cpp"
+    break;
+
+  case 386: /* binary_op_expr: expr TEQUAL expr  */
+#line 1266 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("==", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6198 "chapel.tab.cpp"
+    break;
+
+  case 387: /* binary_op_expr: expr TNOTEQUAL expr  */
+#line 1267 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("!=", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6204 "chapel.tab.cpp"
+    break;
+
+  case 388: /* binary_op_expr: expr TLESSEQUAL expr  */
+#line 1268 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("<=", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6210 "chapel.tab.cpp"
+    break;
+
+  case 389: /* binary_op_expr: expr TGREATEREQUAL expr  */
+#line 1269 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr(">=", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6216 "chapel.tab.cpp"
+    break;
+
+  case 390: /* binary_op_expr: expr TLESS expr  */
+#line 1270 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("<", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6222 "chapel.tab.cpp"
+    break;
+
+  case 391: /* binary_op_expr: expr TGREATER expr  */
+#line 1271 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr(">", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6228 "chapel.tab.cpp"
+    break;
+
+  case 392: /* binary_op_expr: expr TBAND expr  */
+#line 1272 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("&", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6234 "chapel.tab.cpp"
+    break;
+
+  case 393: /* binary_op_expr: expr TBOR expr  */
+#line 1273 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("|", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6240 "chapel.tab.cpp"
+    break;
+
+  case 394: /* binary_op_expr: expr TBXOR expr  */
+#line 1274 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("^", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6246 "chapel.tab.cpp"
+    break;
+
+  case 395: /* binary_op_expr: expr TAND expr  */
+#line 1275 "chapel.ypp"
+                           { (yyval.pexpr) = buildLogicalAndExpr((yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6252 "chapel.tab.cpp"
+    break;
+
+  case 396: /* binary_op_expr: expr TOR expr  */
+#line 1276 "chapel.ypp"
+                           { (yyval.pexpr) = buildLogicalOrExpr((yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6258 "chapel.tab.cpp"
+    break;
+
+  case 397: /* binary_op_expr: expr TEXP expr  */
+#line 1277 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("**", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6264 "chapel.tab.cpp"
+    break;
+
+  case 398: /* binary_op_expr: expr TBY expr  */
+#line 1278 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("by", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6270 "chapel.tab.cpp"
+    break;
+
+  case 399: /* binary_op_expr: expr TALIGN expr  */
+#line 1279 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("align", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6276 "chapel.tab.cpp"
+    break;
+
+  case 400: /* binary_op_expr: expr THASH expr  */
+#line 1280 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("#", (yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6282 "chapel.tab.cpp"
+    break;
+
+  case 401: /* binary_op_expr: expr TDMAPPED expr  */
+#line 1281 "chapel.ypp"
+                           { (yyval.pexpr) = new CallExpr("chpl__distributed", (yyvsp[0].pexpr), (yyvsp[-2].pexpr)); }
+#line 6288 "chapel.tab.cpp"
+    break;
+
+  case 402: /* unary_op_expr: TPLUS expr  */
+#line 1285 "chapel.ypp"
+                                  { (yyval.pexpr) = new CallExpr("+", (yyvsp[0].pexpr)); }
+#line 6294 "chapel.tab.cpp"
+    break;
+
+  case 403: /* unary_op_expr: TMINUS expr  */
+#line 1286 "chapel.ypp"
+                                  { (yyval.pexpr) = new CallExpr("-", (yyvsp[0].pexpr)); }
+#line 6300 "chapel.tab.cpp"
+    break;
+
+  case 404: /* unary_op_expr: TMINUSMINUS expr  */
+#line 1287 "chapel.ypp"
+                                  { (yyval.pexpr) = buildPreDecIncWarning((yyvsp[0].pexpr), '-'); }
+#line 6306 "chapel.tab.cpp"
+    break;
+
+  case 405: /* unary_op_expr: TPLUSPLUS expr  */
+#line 1288 "chapel.ypp"
+                                  { (yyval.pexpr) = buildPreDecIncWarning((yyvsp[0].pexpr), '+'); }
+#line 6312 "chapel.tab.cpp"
+    break;
+
+  case 406: /* unary_op_expr: TNOT expr  */
+#line 1289 "chapel.ypp"
+                                  { (yyval.pexpr) = new CallExpr("!", (yyvsp[0].pexpr)); }
+#line 6318 "chapel.tab.cpp"
+    break;
+
+  case 407: /* unary_op_expr: TBNOT expr  */
+#line 1290 "chapel.ypp"
+                                  { (yyval.pexpr) = new CallExpr("~", (yyvsp[0].pexpr)); }
+#line 6324 "chapel.tab.cpp"
+    break;
+
+  case 408: /* reduce_expr: expr TREDUCE expr  */
+#line 1294 "chapel.ypp"
+                                                 { (yyval.pexpr) = buildReduceExpr((yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6330 "chapel.tab.cpp"
+    break;
+
+  case 409: /* reduce_expr: expr TREDUCE zippered_iterator  */
+#line 1295 "chapel.ypp"
+                                                 { (yyval.pexpr) = buildReduceExpr((yyvsp[-2].pexpr), (yyvsp[0].pexpr), true); }
+#line 6336 "chapel.tab.cpp"
+    break;
+
+  case 410: /* reduce_expr: reduce_scan_op_expr TREDUCE expr  */
+#line 1296 "chapel.ypp"
+                                                 { (yyval.pexpr) = buildReduceExpr((yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6342 "chapel.tab.cpp"
+    break;
+
+  case 411: /* reduce_expr: reduce_scan_op_expr TREDUCE zippered_iterator  */
+#line 1297 "chapel.ypp"
+                                                 { (yyval.pexpr) = buildReduceExpr((yyvsp[-2].pexpr), (yyvsp[0].pexpr), true); }
+#line 6348 "chapel.tab.cpp"
+    break;
+
+  case 412: /* scan_expr: expr TSCAN expr  */
+#line 1301 "chapel.ypp"
+                                               { (yyval.pexpr) = buildScanExpr((yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6354 "chapel.tab.cpp"
+    break;
+
+  case 413: /* scan_expr: expr TSCAN zippered_iterator  */
+#line 1302 "chapel.ypp"
+                                               { (yyval.pexpr) = buildScanExpr((yyvsp[-2].pexpr), (yyvsp[0].pexpr), true); }
+#line 6360 "chapel.tab.cpp"
+    break;
+
+  case 414: /* scan_expr: reduce_scan_op_expr TSCAN expr  */
+#line 1303 "chapel.ypp"
+                                               { (yyval.pexpr) = buildScanExpr((yyvsp[-2].pexpr), (yyvsp[0].pexpr)); }
+#line 6366 "chapel.tab.cpp"
+    break;
+
+  case 415: /* scan_expr: reduce_scan_op_expr TSCAN zippered_iterator  */
+#line 1304 "chapel.ypp"
+                                               { (yyval.pexpr) = buildScanExpr((yyvsp[-2].pexpr), (yyvsp[0].pexpr), true); }
+#line 6372 "chapel.tab.cpp"
+    break;
+
+  case 416: /* reduce_scan_op_expr: TPLUS  */
+#line 1309 "chapel.ypp"
+         { (yyval.pexpr) = new UnresolvedSymExpr("SumReduceScanOp"); }
+#line 6378 "chapel.tab.cpp"
+    break;
+
+  case 417: /* reduce_scan_op_expr: TSTAR  */
+#line 1310 "chapel.ypp"
+         { (yyval.pexpr) = new UnresolvedSymExpr("ProductReduceScanOp"); }
+#line 6384 "chapel.tab.cpp"
+    break;
+
+  case 418: /* reduce_scan_op_expr: TAND  */
+#line 1311 "chapel.ypp"
+         { (yyval.pexpr) = new UnresolvedSymExpr("LogicalAndReduceScanOp"); }
+#line 6390 "chapel.tab.cpp"
+    break;
+
+  case 419: /* reduce_scan_op_expr: TOR  */
+#line 1312 "chapel.ypp"
+         { (yyval.pexpr) = new UnresolvedSymExpr("LogicalOrReduceScanOp"); }
+#line 6396 "chapel.tab.cpp"
+    break;
+
+  case 420: /* reduce_scan_op_expr: TBAND  */
+#line 1313 "chapel.ypp"
+         { (yyval.pexpr) = new UnresolvedSymExpr("BitwiseAndReduceScanOp"); }
+#line 6402 "chapel.tab.cpp"
+    break;
+
+  case 421: /* reduce_scan_op_expr: TBOR  */
+#line 1314 "chapel.ypp"
+         { (yyval.pexpr) = new UnresolvedSymExpr("BitwiseOrReduceScanOp"); }
+#line 6408 "chapel.tab.cpp"
+    break;
+
+  case 422: /* reduce_scan_op_expr: TBXOR  */
+#line 1315 "chapel.ypp"
+         { (yyval.pexpr) = new UnresolvedSymExpr("BitwiseXorReduceScanOp"); }
+#line 6414 "chapel.tab.cpp"
+    break;
+
+
+#line 6418 "chapel.tab.cpp"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+  *++yylsp = yyloc;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (YY_("syntax error"));
+    }
+
+  yyerror_range[1] = yylloc;
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, &yylloc);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+      yyerror_range[1] = *yylsp;
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  yyerror_range[2] = yylloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, &yylloc);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
+#line 1318 "chapel.ypp"
+
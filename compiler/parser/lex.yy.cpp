@@ -0,0 +1,345 @@
+// Hand-written stand-in for the flex-generated lexer (development only).
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+#include <cstdio>
+#include "lexyacc.h"
+#include "chapel.tab.h"
+
+#ifndef processToken
+#define processToken(t)                         \
+  countToken(yytext);                           \
+  if (captureTokens) {                          \
+    if (t == TASSIGN ||                         \
+        t == TDOTDOTDOT)                        \
+      strcat(captureString, " ");               \
+    if (t != TLCBR)                             \
+      strcat(captureString, yytext);            \
+    if (t == TCOMMA ||                          \
+        t == TPARAM ||                          \
+        t == TZIP  ||                           \
+        t == TTYPE ||                           \
+        t == TCONST ||                          \
+        t == TIN ||                             \
+        t == TINOUT ||                          \
+        t == TOUT ||                            \
+        t == TREF ||                            \
+        t == TCOLON ||                          \
+        t == TASSIGN ||                         \
+        t == TRSBR)                             \
+      strcat(captureString, " ");               \
+  }                                             \
+  /* processToken means we are parsing Chapel */\
+  BEGIN(INITIAL);                               \
+  return(t)
+#endif
+
+#define processStringLiteral(q)            \
+  yylval.pch = eatStringLiteral(q);        \
+  countToken(astr(q, yylval.pch, q)); \
+  if (captureTokens) {                     \
+    strcat(captureString, yytext);         \
+    strcat(captureString, yylval.pch);     \
+    strcat(captureString, yytext);         \
+  }                                        \
+  /* string literals only in Chapel */     \
+  BEGIN(INITIAL);                          \
+  return(STRINGLITERAL)
+
+#define processExtern()                    \
+  countToken(yytext);                      \
+  if (captureTokens) {                     \
+    strcat(captureString, yytext);         \
+  }                                        \
+  BEGIN(externmode);                       \
+  return TEXTERN;
+
+#define processExternCode()                \
+  yylval.pch = eatExternCode();            \
+  countToken(astr(yylval.pch));            \
+  if (captureTokens) {                     \
+    strcat(captureString, yylval.pch);     \
+  }                                        \
+  /* only one { } block is special */      \
+  BEGIN(INITIAL);                          \
+  return(EXTERNCODE)
+
+
+
+
+#define INITIAL 0
+#define externmode 1
+static int yy_start_state = INITIAL;
+#define BEGIN(s) (yy_start_state = (s))
+
+FILE* yyin = NULL;
+char* yytext = NULL;
+static std::vector<char> yytextbuf(16);
+static std::string yybuf;
+static size_t yypos = 0;
+static bool yyneedinput = true;
+
+struct KW { const char* s; int t; };
+static KW kwtab[] = {
+  {"align", TALIGN},
+  {"atomic", TATOMIC},
+  {"begin", TBEGIN},
+  {"break", TBREAK},
+  {"by", TBY},
+  {"class", TCLASS},
+  {"cobegin", TCOBEGIN},
+  {"coforall", TCOFORALL},
+  {"config", TCONFIG},
+  {"const", TCONST},
+  {"continue", TCONTINUE},
+  {"delete", TDELETE},
+  {"dmapped", TDMAPPED},
+  {"do", TDO},
+  {"domain", TDOMAIN},
+  {"else", TELSE},
+  {"enum", TENUM},
+  {"export", TEXPORT},
+  {"for", TFOR},
+  {"forall", TFORALL},
+  {"if", TIF},
+  {"in", TIN},
+  {"index", TINDEX},
+  {"inline", TINLINE},
+  {"inout", TINOUT},
+  {"iter", TITER},
+  {"label", TLABEL},
+  {"lambda", TLAMBDA},
+  {"let", TLET},
+  {"local", TLOCAL},
+  {"module", TMODULE},
+  {"new", TNEW},
+  {"nil", TNIL},
+  {"noinit", TNOINIT},
+  {"on", TON},
+  {"otherwise", TOTHERWISE},
+  {"out", TOUT},
+  {"param", TPARAM},
+  {"zip", TZIP},
+  {"pragma", TPRAGMA},
+  {"__primitive", TPRIMITIVE},
+  {"proc", TPROC},
+  {"record", TRECORD},
+  {"reduce", TREDUCE},
+  {"ref", TREF},
+  {"return", TRETURN},
+  {"scan", TSCAN},
+  {"select", TSELECT},
+  {"serial", TSERIAL},
+  {"single", TSINGLE},
+  {"sparse", TSPARSE},
+  {"subdomain", TSUBDOMAIN},
+  {"sync", TSYNC},
+  {"then", TTHEN},
+  {"type", TTYPE},
+  {"union", TUNION},
+  {"use", TUSE},
+  {"var", TVAR},
+  {"when", TWHEN},
+  {"where", TWHERE},
+  {"while", TWHILE},
+  {"with", TWITH},
+  {"yield", TYIELD},
+  {NULL, 0}
+};
+static KW optab[] = {
+  {"=", TASSIGN},
+  {"+=", TASSIGNPLUS},
+  {"-=", TASSIGNMINUS},
+  {"*=", TASSIGNMULTIPLY},
+  {"/=", TASSIGNDIVIDE},
+  {"**=", TASSIGNEXP},
+  {"%=", TASSIGNMOD},
+  {"&=", TASSIGNBAND},
+  {"|=", TASSIGNBOR},
+  {"^=", TASSIGNBXOR},
+  {"&&=", TASSIGNLAND},
+  {"||=", TASSIGNLOR},
+  {"<<=", TASSIGNSL},
+  {">>=", TASSIGNSR},
+  {"=>", TALIAS},
+  {"<=>", TSWAP},
+  {"#", THASH},
+  {"..", TDOTDOT},
+  {"...", TDOTDOTDOT},
+  {"&&", TAND},
+  {"||", TOR},
+  {"!", TNOT},
+  {"&", TBAND},
+  {"|", TBOR},
+  {"^", TBXOR},
+  {"~", TBNOT},
+  {"<<", TSHIFTLEFT},
+  {">>", TSHIFTRIGHT},
+  {"==", TEQUAL},
+  {"!=", TNOTEQUAL},
+  {"<=", TLESSEQUAL},
+  {">=", TGREATEREQUAL},
+  {"<", TLESS},
+  {">", TGREATER},
+  {"+", TPLUS},
+  {"-", TMINUS},
+  {"*", TSTAR},
+  {"/", TDIVIDE},
+  {"%", TMOD},
+  {"--", TMINUSMINUS},
+  {"++", TPLUSPLUS},
+  {"**", TEXP},
+  {":", TCOLON},
+  {";", TSEMI},
+  {",", TCOMMA},
+  {".", TDOT},
+  {"(", TLP},
+  {")", TRP},
+  {"[", TLSBR},
+  {"]", TRSBR},
+  {"}", TRCBR},
+  {"<~>", TIO},
+  {"?", TQUESTION},
+  {NULL, 0}
+};
+
+static void yyfill() {
+  if (!yyneedinput) return;
+  yyneedinput = false;
+  yybuf.clear(); yypos = 0;
+  if (!yyin) return;
+  char b[65536]; size_t n;
+  while ((n = fread(b, 1, sizeof(b), yyin)) > 0) yybuf.append(b, n);
+}
+
+static int yyinput() {
+  yyfill();
+  if (yypos >= yybuf.size()) return EOF;
+  return (unsigned char)yybuf[yypos++];
+}
+
+static void settext(size_t len) {
+  if (yytextbuf.size() < len+1) yytextbuf.resize(len+1);
+  memcpy(&yytextbuf[0], yybuf.data()+yypos, len);
+  yytextbuf[len] = 0;
+  yytext = &yytextbuf[0];
+  yypos += len;
+}
+
+static inline bool isLetter(int c) { return c == '_' || (c>='a'&&c<='z') || (c>='A'&&c<='Z'); }
+static inline bool isDig(int c) { return c>='0'&&c<='9'; }
+static inline int at(size_t p) { return p < yybuf.size() ? (unsigned char)yybuf[p] : -1; }
+
+static size_t matchExp(size_t p) {
+  if (at(p)!='e' && at(p)!='E') return 0;
+  size_t q = p+1;
+  if (at(q)=='+'||at(q)=='-') q++;
+  if (!isDig(at(q))) return 0;
+  while (isDig(at(q))) q++;
+  return q-p;
+}
+static size_t matchFloat(size_t p) {
+  size_t best = 0;
+  // digit* "." digit+ exp?
+  { size_t q=p; while (isDig(at(q))) q++;
+    if (at(q)=='.' && isDig(at(q+1))) { q++; while (isDig(at(q))) q++; q += matchExp(q); if (q-p>best) best=q-p; } }
+  // digit+ "." exp
+  { size_t q=p; while (isDig(at(q))) q++;
+    if (q>p && at(q)=='.') { size_t e = matchExp(q+1); if (e && q+1+e-p>best) best=q+1+e-p; } }
+  // digit+ exp
+  { size_t q=p; while (isDig(at(q))) q++;
+    if (q>p) { size_t e = matchExp(q); if (e && q+e-p>best) best=q+e-p; } }
+  return best;
+}
+static bool inRange(int c, char b) {
+  if (b=='b') return c=='0'||c=='1';
+  if (b=='o') return c>='0'&&c<='7';
+  return isDig(c)||(c>='a'&&c<='f')||(c>='A'&&c<='F');
+}
+static size_t matchInt(size_t p) {
+  size_t best = 0;
+  { size_t q=p; while (isDig(at(q))) q++; best=q-p; }
+  if (at(p)=='0') {
+    int c = at(p+1);
+    char k = (c=='b'||c=='B')?'b':(c=='o'||c=='O')?'o':(c=='x'||c=='X')?'x':0;
+    if (k) { size_t q=p+2; while (inRange(at(q),k)) q++; if (q>p+2 && q-p>best) best=q-p; }
+  }
+  return best;
+}
+
+int yylex(void) {
+  yyfill();
+  while (1) {
+    if (yypos >= yybuf.size()) { yyneedinput = true; yytext = (char*)""; return 0; }
+    int c = at(yypos);
+    if (c==' '||c=='\t'||c=='\r') { settext(1); processWhitespace(yytext); continue; }
+    if (c=='\n') { settext(1); processNewline(); continue; }
+    if (c=='/' && at(yypos+1)=='/') { settext(2); processSingleLineComment(); continue; }
+    if (c=='/' && at(yypos+1)=='*') { settext(2); processMultiLineComment(); continue; }
+    if (c=='"') { settext(1); processStringLiteral("\""); }
+    if (c=='\'') { settext(1); processStringLiteral("\'"); }
+    if (c=='{') {
+      settext(1);
+      if (yy_start_state == externmode) { processExternCode(); }
+      processToken(TLCBR);
+    }
+    if (isLetter(c)) {
+      size_t q = yypos+1;
+      while (isLetter(at(q))||isDig(at(q))||at(q)=='$') q++;
+      settext(q-yypos);
+      if (!strcmp(yytext, "_")) { processToken(TUNDERSCORE); }
+      if (!strcmp(yytext, "extern")) { processExtern(); }
+      for (KW* k = kwtab; k->s; k++)
+        if (!strcmp(k->s, yytext)) { processToken(k->t); }
+      processToken(TIDENT);
+    }
+    if (isDig(c) || (c=='.' && isDig(at(yypos+1)))) {
+      size_t f = matchFloat(yypos), n = matchInt(yypos);
+      if (f >= n && f > 0) {
+        if (at(yypos+f)=='i') { settext(f+1); processToken(IMAGLITERAL); }
+        settext(f); processToken(REALLITERAL);
+      }
+      if (n > 0) {
+        if (at(yypos+n)=='i') { settext(n+1); processToken(IMAGLITERAL); }
+        settext(n); processToken(INTLITERAL);
+      }
+    }
+    size_t bestLen = 0; int bestTok = 0;
+    for (KW* k = optab; k->s; k++) {
+      size_t l = strlen(k->s);
+      if (l > bestLen && yybuf.compare(yypos, l, k->s) == 0) { bestLen = l; bestTok = k->t; }
+    }
+    if (bestLen) { settext(bestLen); processToken(bestTok); }
+    settext(1);
+    processInvalidToken();
+  }
+}
+
+int getNextYYChar() {
+  int retval = yyinput();
+  if (retval == EOF) {
+    retval = 0;
+  }
+  return retval;
+}
+
+bool chplParseString;
+const char *chplParseStringMsg = NULL;
+BlockStmt*
+parseString(const char* string, const char* filename, const char* msg) {
+  std::string savebuf = yybuf; size_t savepos = yypos; bool saveneed = yyneedinput;
+  yyblock = NULL;
+  yyfilename = filename;
+  chplParseString = true;
+  chplParseStringMsg = msg;
+  yybuf = string; yypos = 0; yyneedinput = false;
+  yyparse();
+  chplParseString = false;
+  chplParseStringMsg = NULL;
+  yybuf = savebuf; yypos = savepos; yyneedinput = saveneed;
+  if (yypos >= yybuf.size()) yyneedinput = true;
+  return yyblock;
+}
@@ -0,0 +1,2090 @@
+/*
+ * Copyright 2004-2014 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// The module cache.
+//
+// When a cache directory is given, the AST that yyparse() builds for an
+// internal or standard module file is written to a cache file, and later
+// compilations restore it from there instead of lexing and parsing the
+// file.  Everything after yyparse() in ParseFile() runs as usual on the
+// restored block.
+//
+// A cache file is only used if it was written by the same compiler
+// binary with the same parse-affecting settings for the same source text.
+// A file is not cached if parsing it issued any diagnostics, or if its AST
+// refers to something other than its own nodes, well-known symbols and
+// types of the root module, and literals.  Configs that the file declares
+// are recorded along with the value (if any) that the command line gave
+// them, and the file is only restored if those values are unchanged.
+//
+// The nodes are written in the order they were created (by id) and are
+// re-created in that order, so the global node vectors and everything
+// that iterates over them see the same order as after a real parse.
+//
+
+#include "moduleCache.h"
+
+#include "astutil.h"
+#include "build.h"
+#include "CForLoop.h"
+#include "config.h"
+#include "DoWhileStmt.h"
+#include "driver.h"
+#include "expr.h"
+#include "files.h"
+#include "ForLoop.h"
+#include "misc.h"
+#include "ParamForLoop.h"
+#include "parser.h"
+#include "primitive.h"
+#include "stmt.h"
+#include "stringutil.h"
+#include "type.h"
+#include "version.h"
+#include "WhileDoStmt.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+char moduleCacheDir[FILENAME_MAX+1] = "";
+
+// Change this whenever the layout of a cache file changes.
+static const uint32_t cacheFormatVersion = 2;
+static const char     cacheMagic[]       = "chplast";
+
+/************************************ | *************************************
+*                                                                           *
+* Keys                                                                      *
+*                                                                           *
+************************************* | ************************************/
+
+static const uint64_t hashSeed = 14695981039346656037ULL;
+
+static uint64_t hashBytes(uint64_t h, const void* data, size_t len) {
+  const unsigned char* p = (const unsigned char*) data;
+
+  for (size_t i = 0; i < len; i++) {
+    h ^= p[i];
+    h *= 1099511628211ULL;
+  }
+
+  return h;
+}
+
+static uint64_t hashString(uint64_t h, const char* str) {
+  return hashBytes(h, str, strlen(str) + 1);
+}
+
+//
+// Identifies the compiler and the settings that change what the parser
+// builds.  The binary's own size and time stamp stand in for everything
+// else (grammar, builders, AST layout) that could change between builds
+// that report the same version.
+//
+static uint64_t compilerKey() {
+  static uint64_t key = 0;
+
+  if (key == 0) {
+    char     version[128];
+    uint64_t h = hashSeed;
+
+    get_version(version);
+
+    h = hashBytes(h, &cacheFormatVersion, sizeof(cacheFormatVersion));
+    h = hashString(h, version);
+
+#define symbolFlag(NAME, PRAGMA, MAPNAME, COMMENT) h = hashString(h, #NAME);
+#include "flags_list.h"
+#undef symbolFlag
+
+    for (int i = 0; i < NUM_KNOWN_PRIMS; i++)
+      h = hashString(h, primitives[i] ? primitives[i]->name : "");
+
+#ifdef __linux__
+    struct stat exe;
+
+    if (stat("/proc/self/exe", &exe) == 0) {
+      int64_t mtime = exe.st_mtime;
+      int64_t size  = exe.st_size;
+
+      h = hashBytes(h, &mtime, sizeof(mtime));
+      h = hashBytes(h, &size,  sizeof(size));
+    }
+#endif
+
+    h = hashBytes(h, &fLocal,           sizeof(fLocal));
+    h = hashBytes(h, &fNoFastFollowers, sizeof(fNoFastFollowers));
+
+    key = (h != 0) ? h : 1;
+  }
+
+  return key;
+}
+
+static bool hashSourceFile(const char* filename, uint64_t* hash) {
+  FILE* fp = fopen(filename, "rb");
+  bool  ok = false;
+
+  if (fp != NULL) {
+    uint64_t h = hashSeed;
+    char     buf[65536];
+    size_t   n;
+
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+      h = hashBytes(h, buf, n);
+
+    ok    = ferror(fp) == 0;
+    *hash = h;
+
+    fclose(fp);
+  }
+
+  return ok;
+}
+
+static const char* cacheFilename(const char* filename, ModTag modType) {
+  uint64_t    h    = hashString(compilerKey(), filename);
+  const char* base = strrchr(filename, '/');
+  char        hex[32];
+
+  h = hashBytes(h, &modType, sizeof(modType));
+
+  snprintf(hex, sizeof(hex), "%016llx", (unsigned long long) h);
+
+  return astr(moduleCacheDir, "/", (base != NULL) ? base + 1 : filename,
+              ".", hex);
+}
+
+bool moduleCacheEnabled(ModTag modType) {
+  return moduleCacheDir[0] != '\0'                               &&
+         (modType == MOD_INTERNAL || modType == MOD_STANDARD)     &&
+         fDocs == false;
+}
+
+/************************************ | *************************************
+*                                                                           *
+* Compiler-generated function names                                         *
+*                                                                           *
+* The functions the parser generates for if-expressions and the like are   *
+* numbered by the counters in genFnCounters.  A cache file records the     *
+* range of numbers its file used.  If that range has been handed out to    *
+* other files by the time the file is restored, its names are moved past   *
+* the current counters so that they stay unique.                           *
+*                                                                           *
+************************************* | ************************************/
+
+struct GenFnName {
+  const char*  prefix;
+  GenFnCounter counter;
+};
+
+static const GenFnName genFnNames[] = {
+  { "_if_fn",                 GEN_FN_IF       },
+  { "_let_fn",                GEN_FN_LET      },
+  { "_seqloopexpr",           GEN_FN_LOOPEXPR },
+  { "_parloopexpr",           GEN_FN_LOOPEXPR },
+  { "_iterator_for_loopexpr", GEN_FN_LOOPEXPR },
+  { "chpl__reduce",           GEN_FN_REDUCE   },
+  { "chpl__scan",             GEN_FN_SCAN     },
+  { "_chpl_lambda_",          GEN_FN_LAMBDA   }
+};
+
+struct GenFnRenumbering {
+  bool any;
+  int  start [NUM_GEN_FN_COUNTERS];
+  int  end   [NUM_GEN_FN_COUNTERS];
+  int  offset[NUM_GEN_FN_COUNTERS];
+};
+
+static const char* renumberGenFnName(const char*             name,
+                                     const GenFnRenumbering& rn) {
+  const int numNames = sizeof(genFnNames) / sizeof(genFnNames[0]);
+
+  for (int i = 0; i < numNames; i++) {
+    const char* prefix = genFnNames[i].prefix;
+    size_t      len    = strlen(prefix);
+
+    if (strncmp(name, prefix, len) == 0 && name[len] != '\0') {
+      const char* digits = name + len;
+      bool        number = digits[0] != '0' || digits[1] == '\0';
+
+      for (const char* p = digits; *p != '\0' && number; p++)
+        number = *p >= '0' && *p <= '9';
+
+      if (number && strlen(digits) < 10) {
+        int k = genFnNames[i].counter;
+        int n = atoi(digits);
+
+        if (rn.offset[k] != 0 && rn.start[k] <= n && n < rn.end[k])
+          return astr(prefix, istr(n + rn.offset[k]));
+      }
+    }
+  }
+
+  return name;
+}
+
+/************************************ | *************************************
+*                                                                           *
+* Encoding                                                                  *
+*                                                                           *
+* Every node is written as a generic record of integers, strings,          *
+* references and reference lists; the meaning of each slot depends on the  *
+* node's tag (see makeRecord() and linkNode()) and so does the number of   *
+* slots of each kind (see recordShape()).  Strings are indices into a      *
+* table at the start of the file.  A reference is 0 for NULL, i > 0 for    *
+* the node with index i - 1 and i < 0 for the external with index -i - 1.  *
+*                                                                           *
+************************************* | ************************************/
+
+enum BlockKind {
+  BLOCK_KIND_PLAIN,
+  BLOCK_KIND_WHILE_DO,
+  BLOCK_KIND_DO_WHILE,
+  BLOCK_KIND_FOR,
+  BLOCK_KIND_C_FOR,
+  BLOCK_KIND_PARAM_FOR
+};
+
+enum ExternalKind {
+  EXTERNAL_SYMBOL,   // a symbol of the root module, by name
+  EXTERNAL_TYPE,     // the type of such a symbol
+  EXTERNAL_LITERAL   // a literal, by value
+};
+
+static const int maxRecordLists = 3;
+
+//
+// The number of ints, strings, references and lists each kind of record
+// carries, or false if the tag is not one the cache knows about.
+//
+static bool recordShape(int tag, int kind,
+                        size_t* ints, size_t* strs,
+                        size_t* refs, size_t* lists) {
+  *ints  = 0;
+  *strs  = 0;
+  *refs  = 0;
+  *lists = 0;
+
+  switch (tag) {
+  case E_SymExpr:           *refs = 1;                           break;
+  case E_UnresolvedSymExpr: *strs = 1;                           break;
+  case E_DefExpr:           *refs = 3;                           break;
+  case E_CallExpr:
+    *ints  = 3;
+    *strs  = 1;
+    *refs  = 1;
+    *lists = 1;
+    break;
+  case E_NamedExpr:         *strs = 1; *refs = 1;                break;
+  case E_CondStmt:          *refs = 3;                           break;
+  case E_GotoStmt:          *ints = 1; *refs = 1;                break;
+  case E_ExternBlockStmt:   *strs = 1;                           break;
+
+  case E_BlockStmt:
+    *ints  = 1;
+    *strs  = 1;
+    *lists = 1;
+
+    switch (kind) {
+    case BLOCK_KIND_PLAIN:     *refs = 3; break;
+    case BLOCK_KIND_WHILE_DO:  *refs = 3; break;
+    case BLOCK_KIND_DO_WHILE:  *refs = 3; break;
+    case BLOCK_KIND_FOR:       *refs = 4; break;
+    case BLOCK_KIND_C_FOR:     *refs = 5; break;
+    case BLOCK_KIND_PARAM_FOR: *refs = 7; break;
+    default:                   return false;
+    }
+
+    // Loops also record whether they are order independent
+    if (kind != BLOCK_KIND_PLAIN)
+      *ints = 2;
+    break;
+
+  case E_ModuleSymbol:      *ints = 1; *strs = 4; *refs = 3;     break;
+  case E_VarSymbol:         *strs = 3; *refs = 2;                break;
+  case E_ArgSymbol:         *ints = 1; *strs = 2; *refs = 5;     break;
+  case E_TypeSymbol:        *strs = 2; *refs = 2;                break;
+  case E_FnSymbol:
+    *ints  = 2;
+    *strs  = 4;
+    *refs  = 8;
+    *lists = 1;
+    break;
+  case E_EnumSymbol:        *strs = 2; *refs = 2;                break;
+  case E_LabelSymbol:       *strs = 2; *refs = 2;                break;
+
+  case E_PrimitiveType:     *ints = 2; *refs = 1; *lists = 1;    break;
+  case E_EnumType:          *ints = 2; *refs = 2; *lists = 2;    break;
+  case E_AggregateType:
+    *ints  = 3;
+    *strs  = 1;
+    *refs  = 2;
+    *lists = 3;
+    break;
+
+  default:
+    return false;
+  }
+
+  return true;
+}
+
+// A record as the writer builds it.
+struct NodeRecord {
+  int                            tag;
+  int                            kind;
+  int                            lineno;
+  const char*                    filename;
+  std::vector<int>               ints;
+  std::vector<const char*>       strs;
+  std::vector<int>               refs;
+  std::vector<std::vector<int> > lists;
+  std::vector<int>               flags;
+  bool                           hasImmediate;
+  Immediate                      immediate;
+};
+
+// A run of integers in the loader's pool.
+struct IntSpan {
+  const int* data;
+  int        length;
+
+  int size()                const { return length;  }
+  int operator[](int i)     const { return data[i]; }
+};
+
+//
+// A record as the loader reads it.  The variable-length parts live in one
+// pool of integers so that reading a file takes a handful of allocations
+// rather than several per node.
+//
+struct LoadedRecord {
+  int         tag;
+  int         kind;
+  int         lineno;
+  const char* filename;
+  IntSpan     ints;
+  IntSpan     strs;                      // string table indices, -1 for NULL
+  IntSpan     refs;
+  IntSpan     lists[maxRecordLists];
+  int         numLists;
+  IntSpan     flags;
+  int         immediate;                 // index into the immediates, or -1
+};
+
+class ByteWriter {
+public:
+  std::vector<unsigned char> bytes;
+
+  void u8(unsigned int v) {
+    bytes.push_back((unsigned char) v);
+  }
+
+  void u32(uint32_t v) {
+    for (int i = 0; i < 4; i++)
+      u8((v >> (8 * i)) & 0xff);
+  }
+
+  void i32(int v) {
+    u32((uint32_t) v);
+  }
+
+  void u64(uint64_t v) {
+    u32((uint32_t) v);
+    u32((uint32_t) (v >> 32));
+  }
+
+  void str(const char* s) {
+    if (s == NULL) {
+      i32(-1);
+    } else {
+      size_t len = strlen(s);
+
+      i32((int) len);
+      bytes.insert(bytes.end(), s, s + len);
+    }
+  }
+
+  void immediate(const Immediate& imm) {
+    u32(imm.const_kind);
+    u32(imm.num_index);
+
+    if (imm.const_kind == CONST_KIND_STRING) {
+      str(imm.v_string);
+    } else {
+      const unsigned char* p = (const unsigned char*) &imm.v_complex128;
+
+      bytes.insert(bytes.end(), p, p + sizeof(imm.v_complex128));
+    }
+  }
+};
+
+class ByteReader {
+public:
+  ByteReader(const std::vector<unsigned char>& data) :
+    cur(data.empty() ? NULL : &data[0]),
+    end(data.empty() ? NULL : &data[0] + data.size()),
+    ok(true) { }
+
+  const unsigned char* cur;
+  const unsigned char* end;
+  bool                 ok;
+
+  unsigned int u8() {
+    if (cur >= end) {
+      ok = false;
+      return 0;
+    }
+
+    return *cur++;
+  }
+
+  uint32_t u32() {
+    if (end - cur < 4) {
+      ok  = false;
+      cur = end;
+      return 0;
+    }
+
+    uint32_t v = (uint32_t) cur[0]         | (uint32_t) cur[1] << 8 |
+                 (uint32_t) cur[2] << 16   | (uint32_t) cur[3] << 24;
+
+    cur += 4;
+
+    return v;
+  }
+
+  int i32() {
+    return (int) u32();
+  }
+
+  uint64_t u64() {
+    uint64_t lo = u32();
+    uint64_t hi = u32();
+
+    return lo | hi << 32;
+  }
+
+  // Counts read from the file are bounded by what is left of it.
+  int count() {
+    uint32_t n = u32();
+
+    if (n > (uint32_t) (end - cur)) {
+      ok = false;
+      n  = 0;
+    }
+
+    return (int) n;
+  }
+
+  const char* str() {
+    int         len    = i32();
+    const char* retval = NULL;
+
+    if (len < -1 || len > end - cur) {
+      ok = false;
+
+    } else if (len >= 0) {
+      retval  = astr(std::string((const char*) cur, len).c_str());
+      cur    += len;
+    }
+
+    return retval;
+  }
+
+  void immediate(Immediate* imm) {
+    *imm = Immediate();
+
+    imm->const_kind = u32();
+    imm->num_index  = u32();
+
+    if (imm->const_kind == CONST_KIND_STRING) {
+      imm->v_string = str();
+
+      if (imm->v_string == NULL)
+        ok = false;
+
+    } else if (end - cur < (long) sizeof(imm->v_complex128)) {
+      ok = false;
+
+    } else {
+      memcpy(&imm->v_complex128, cur, sizeof(imm->v_complex128));
+      cur += sizeof(imm->v_complex128);
+    }
+  }
+};
+
+/************************************ | *************************************
+*                                                                           *
+* Root module symbols                                                       *
+*                                                                           *
+************************************* | ************************************/
+
+typedef std::map<std::string, Symbol*> RootSymbolMap;
+
+//
+// The named symbols of the root module: primitive types and well-known
+// values such as nil.  Names defined more than once map to NULL.
+//
+static RootSymbolMap& rootSymbols() {
+  static RootSymbolMap symbols;
+  static bool          built = false;
+
+  if (built == false) {
+    for_alist(stmt, rootModule->block->body) {
+      if (DefExpr* def = toDefExpr(stmt)) {
+        VarSymbol* var = toVarSymbol(def->sym);
+
+        if (var == NULL || var->immediate == NULL) {
+          RootSymbolMap::iterator it = symbols.find(def->sym->name);
+
+          if (it == symbols.end())
+            symbols[def->sym->name] = def->sym;
+          else
+            it->second = NULL;
+        }
+      }
+    }
+
+    built = true;
+  }
+
+  return symbols;
+}
+
+static Symbol* findRootSymbol(const char* name) {
+  RootSymbolMap&          symbols = rootSymbols();
+  RootSymbolMap::iterator it      = symbols.find(name);
+
+  return (it != symbols.end()) ? it->second : NULL;
+}
+
+/************************************ | *************************************
+*                                                                           *
+* Writing                                                                   *
+*                                                                           *
+************************************* | ************************************/
+
+// A lookup of a config in the command line settings during a parse.
+struct ConfigLookup {
+  const char* name;
+  const char* text;     // the value given on the command line, or NULL
+  bool        used;     // whether an earlier module had already used it
+};
+
+static bool                     recording         = false;
+static const char*              recordFilename    = NULL;
+static ModTag                   recordModType     = MOD_INTERNAL;
+static uint64_t                 recordSourceHash  = 0;
+static int                      recordDiagnostics = 0;
+static bool                     recordCacheable   = false;
+static int                      recordCounters[NUM_GEN_FN_COUNTERS];
+static std::vector<const char*> recordUseNames;
+static std::vector<CallExpr*>   recordUseExprs;
+static std::vector<ConfigLookup> recordConfigs;
+
+class CacheWriter {
+public:
+                  CacheWriter();
+
+  bool            build(BlockStmt* block);
+  bool            save(const char* path);
+
+private:
+  int             ref(BaseAST* ast);
+  int             typeRef(Type* type);
+  int             external(BaseAST* ast);
+  int             claim(Expr* expr, BaseAST* owner);
+  int             strIndex(const char* str);
+
+  void            makeRecord(BaseAST* ast, NodeRecord& rec);
+  void            makeSymbolRecord(Symbol* sym, NodeRecord& rec);
+  void            makeTypeRecord(Type* type, NodeRecord& rec);
+  void            makeBlockRecord(BlockStmt* block, NodeRecord& rec);
+  void            writeRecord(const NodeRecord& rec);
+
+  void            refuse()                     { cacheable = false; }
+
+  bool                       cacheable;
+  std::map<BaseAST*, int>    index;
+  std::map<BaseAST*, int>    externals;
+  std::map<std::string, int> stringIndex;
+  std::vector<const char*>   strings;
+  ByteWriter                 externalBytes;
+  ByteWriter                 nodeBytes;
+  ByteWriter                 trailerBytes;
+};
+
+CacheWriter::CacheWriter() : cacheable(true) {
+
+}
+
+int CacheWriter::ref(BaseAST* ast) {
+  int retval = 0;
+
+  if (ast != NULL) {
+    std::map<BaseAST*, int>::iterator it = index.find(ast);
+
+    retval = (it != index.end()) ? it->second + 1 : external(ast);
+  }
+
+  return retval;
+}
+
+int CacheWriter::typeRef(Type* type) {
+  return (type == NULL || index.count(type) > 0) ? ref(type) : external(type);
+}
+
+int CacheWriter::external(BaseAST* ast) {
+  std::map<BaseAST*, int>::iterator it = externals.find(ast);
+
+  if (it != externals.end())
+    return -it->second - 1;
+
+  VarSymbol*  var   = toVarSymbol(ast);
+  Symbol*     sym   = toSymbol(ast);
+  Type*       type  = toType(ast);
+  int         which = externals.size();
+
+  if (var != NULL                                    &&
+      var->immediate != NULL                         &&
+      uniqueConstantsHash.get(var->immediate) == var &&
+      var->type != NULL                              &&
+      var->type->symbol != NULL                      &&
+      findRootSymbol(var->type->symbol->name) == var->type->symbol) {
+    externalBytes.u8(EXTERNAL_LITERAL);
+    externalBytes.immediate(*var->immediate);
+    externalBytes.str((var->cname != var->name) ? var->cname : NULL);
+    externalBytes.str(var->type->symbol->name);
+
+  } else if (sym != NULL && findRootSymbol(sym->name) == sym) {
+    externalBytes.u8(EXTERNAL_SYMBOL);
+    externalBytes.str(sym->name);
+
+  } else if (type != NULL           &&
+             type->symbol != NULL   &&
+             findRootSymbol(type->symbol->name) == type->symbol) {
+    externalBytes.u8(EXTERNAL_TYPE);
+    externalBytes.str(type->symbol->name);
+
+  } else {
+    refuse();
+    return 0;
+  }
+
+  externals[ast] = which;
+
+  return -which - 1;
+}
+
+int CacheWriter::strIndex(const char* str) {
+  int retval = -1;
+
+  if (str != NULL) {
+    std::map<std::string, int>::iterator it = stringIndex.find(str);
+
+    if (it != stringIndex.end()) {
+      retval = it->second;
+    } else {
+      retval           = strings.size();
+      stringIndex[str] = retval;
+      strings.push_back(str);
+    }
+  }
+
+  return retval;
+}
+
+//
+// Some loop statements create their children in their constructors.  The
+// loader re-creates those children through the constructor as well, so
+// they must have been created after their owner.
+//
+int CacheWriter::claim(Expr* expr, BaseAST* owner) {
+  if (expr == NULL || index.count(expr) == 0 || expr->id <= owner->id)
+    refuse();
+
+  return ref(expr);
+}
+
+void CacheWriter::makeRecord(BaseAST* ast, NodeRecord& rec) {
+  rec.tag          = ast->astTag;
+  rec.kind         = 0;
+  rec.lineno       = ast->astloc.lineno;
+  rec.filename     = ast->astloc.filename;
+  rec.hasImmediate = false;
+
+  if (Symbol* sym = toSymbol(ast)) {
+    makeSymbolRecord(sym, rec);
+
+  } else if (Type* type = toType(ast)) {
+    makeTypeRecord(type, rec);
+
+  } else if (BlockStmt* block = toBlockStmt(ast)) {
+    makeBlockRecord(block, rec);
+
+  } else if (SymExpr* se = toSymExpr(ast)) {
+    rec.refs.push_back(ref(se->var));
+
+  } else if (UnresolvedSymExpr* use = toUnresolvedSymExpr(ast)) {
+    rec.strs.push_back(use->unresolved);
+
+  } else if (DefExpr* def = toDefExpr(ast)) {
+    rec.refs.push_back(ref(def->sym));
+    rec.refs.push_back(ref(def->init));
+    rec.refs.push_back(ref(def->exprType));
+
+  } else if (CallExpr* call = toCallExpr(ast)) {
+    PrimitiveOp* prim = call->primitive;
+
+    // Primitives are identified by name; __primitive() looks them up the
+    // same way.
+    if (prim != NULL && primitives_map.get(prim->name) != prim)
+      refuse();
+
+    rec.strs.push_back((prim != NULL) ? prim->name : NULL);
+    rec.ints.push_back(call->partialTag);
+    rec.ints.push_back(call->methodTag);
+    rec.ints.push_back(call->square);
+    rec.refs.push_back(ref(call->baseExpr));
+    rec.lists.resize(1);
+
+    for_alist(actual, call->argList)
+      rec.lists[0].push_back(ref(actual));
+
+  } else if (NamedExpr* named = toNamedExpr(ast)) {
+    rec.strs.push_back(named->name);
+    rec.refs.push_back(ref(named->actual));
+
+  } else if (CondStmt* cond = toCondStmt(ast)) {
+    rec.refs.push_back(ref(cond->condExpr));
+    rec.refs.push_back(ref(cond->thenStmt));
+    rec.refs.push_back(ref(cond->elseStmt));
+
+  } else if (GotoStmt* gs = toGotoStmt(ast)) {
+    rec.ints.push_back(gs->gotoTag);
+    rec.refs.push_back(ref(gs->label));
+
+  } else if (ExternBlockStmt* ebs = toExternBlockStmt(ast)) {
+    rec.strs.push_back(ebs->c_code);
+
+  } else {
+    refuse();
+  }
+}
+
+void CacheWriter::makeSymbolRecord(Symbol* sym, NodeRecord& rec) {
+  rec.strs.push_back(sym->name);
+  rec.strs.push_back(sym->cname);
+  rec.refs.push_back(typeRef(sym->type));
+  rec.refs.push_back(ref(sym->defPoint));
+
+  for (int flag = 1; flag < NUM_FLAGS; flag++)
+    if (sym->flags[flag])
+      rec.flags.push_back(flag);
+
+  if (ModuleSymbol* mod = toModuleSymbol(sym)) {
+    if (mod->initFn != NULL || mod->extern_info != NULL ||
+        mod->modUseList.n != 0)
+      refuse();
+
+    rec.ints.push_back(mod->modTag);
+    rec.strs.push_back(mod->filename);
+    rec.strs.push_back(mod->doc);
+    rec.refs.push_back(ref(mod->block));
+
+  } else if (VarSymbol* var = toVarSymbol(sym)) {
+    rec.strs.push_back(var->doc);
+
+    if (var->immediate != NULL) {
+      rec.hasImmediate = true;
+      rec.immediate    = *var->immediate;
+    }
+
+  } else if (ArgSymbol* arg = toArgSymbol(sym)) {
+    if (arg->instantiatedFrom != NULL)
+      refuse();
+
+    rec.ints.push_back(arg->intent);
+    rec.refs.push_back(ref(arg->typeExpr));
+    rec.refs.push_back(ref(arg->defaultExpr));
+    rec.refs.push_back(ref(arg->variableExpr));
+
+  } else if (FnSymbol* fn = toFnSymbol(sym)) {
+    if (fn->iteratorInfo       != NULL ||
+        fn->_outer             != NULL ||
+        fn->instantiatedFrom   != NULL ||
+        fn->instantiationPoint != NULL ||
+        fn->basicBlocks        != NULL ||
+        fn->calledBy           != NULL ||
+        fn->valueFunction      != NULL ||
+        (fn->partialCopySource != NULL &&
+         fn->hasFlag(FLAG_PARTIAL_COPY))      ||
+        fn->retSymbol          != NULL ||
+        fn->substitutions.n    != 0    ||
+        fn->partialCopyMap.n   != 0    ||
+        fn->codegenUniqueNum   != 1)
+      refuse();
+
+    rec.ints.push_back(fn->thisTag);
+    rec.ints.push_back(fn->retTag);
+    rec.strs.push_back(fn->userString);
+    rec.strs.push_back(fn->doc);
+    rec.refs.push_back(ref(fn->setter));
+    rec.refs.push_back(typeRef(fn->retType));
+    rec.refs.push_back(ref(fn->where));
+    rec.refs.push_back(ref(fn->retExprType));
+    rec.refs.push_back(ref(fn->body));
+    rec.refs.push_back(ref(fn->_this));
+    rec.lists.resize(1);
+
+    for_alist(formal, fn->formals)
+      rec.lists[0].push_back(ref(formal));
+
+  } else if (TypeSymbol* ts = toTypeSymbol(sym)) {
+    // The type has to exist before the symbol can be created.
+    if (ts->type == NULL || ts->type->symbol != ts ||
+        (index.count(ts->type) > 0 && ts->type->id >= ts->id))
+      refuse();
+
+  } else if (LabelSymbol* label = toLabelSymbol(sym)) {
+    if (label->iterResumeGoto != NULL)
+      refuse();
+
+  } else if (isEnumSymbol(sym) == false) {
+    refuse();
+  }
+}
+
+void CacheWriter::makeTypeRecord(Type* type, NodeRecord& rec) {
+  if (type->refType                != NULL ||
+      type->defaultInitializer     != NULL ||
+      type->defaultTypeConstructor != NULL ||
+      type->destructor             != NULL ||
+      type->instantiatedFrom       != NULL ||
+      type->scalarPromotionType    != NULL ||
+      type->substitutions.n        != 0    ||
+      type->dispatchChildren.n     != 0    ||
+      type->dispatchParents.n      != 0    ||
+      type->symbol                 == NULL ||
+      index.count(type->symbol)    == 0)
+    refuse();
+
+  rec.ints.push_back(type->hasGenericDefaults);
+  rec.ints.push_back(type->isInternalType);
+  rec.refs.push_back(ref(type->defaultValue));
+  rec.lists.resize(1);
+
+  forv_Vec(FnSymbol, method, type->methods)
+    rec.lists[0].push_back(ref(method));
+
+  if (EnumType* et = toEnumType(type)) {
+    rec.refs.push_back(typeRef(et->integerType));
+    rec.lists.resize(2);
+
+    for_alist(constant, et->constants)
+      rec.lists[1].push_back(ref(constant));
+
+  } else if (AggregateType* at = toAggregateType(type)) {
+    rec.ints.push_back(at->aggregateTag);
+    rec.strs.push_back(at->doc);
+    rec.refs.push_back(ref(at->outer));
+    rec.lists.resize(3);
+
+    for_alist(field, at->fields)
+      rec.lists[1].push_back(ref(field));
+
+    for_alist(inherit, at->inherits)
+      rec.lists[2].push_back(ref(inherit));
+  }
+}
+
+void CacheWriter::makeBlockRecord(BlockStmt* block, NodeRecord& rec) {
+  rec.ints.push_back(block->blockTag);
+  rec.strs.push_back(block->userLabel);
+  rec.lists.resize(1);
+
+  for_alist(stmt, block->body)
+    rec.lists[0].push_back(ref(stmt));
+
+  if (block->isLoopStmt() == false) {
+    rec.kind = BLOCK_KIND_PLAIN;
+    rec.refs.push_back(ref(block->modUses));
+    rec.refs.push_back(ref(block->byrefVars));
+    rec.refs.push_back(ref(block->blockInfoGet()));
+    return;
+  }
+
+  LoopStmt* loop = (LoopStmt*) block;
+
+  if (block->modUses != NULL || block->byrefVars != NULL)
+    refuse();
+
+  rec.ints.push_back(loop->isOrderIndependent() ? 1 : 0);
+  rec.refs.push_back(ref(loop->breakLabelGet()));
+  rec.refs.push_back(ref(loop->continueLabelGet()));
+
+  if (block->isWhileDoStmt() == true || block->isDoWhileStmt() == true) {
+    WhileStmt* ws = (WhileStmt*) block;
+
+    rec.kind = block->isWhileDoStmt() ? BLOCK_KIND_WHILE_DO
+                                      : BLOCK_KIND_DO_WHILE;
+
+    if (ws->condExprGet() != NULL)
+      rec.refs.push_back(claim(ws->condExprGet(), block));
+    else
+      rec.refs.push_back(0);
+
+  } else if (ForLoop* fl = toForLoop(block)) {
+    rec.kind = BLOCK_KIND_FOR;
+    rec.refs.push_back(claim(fl->indexGet(),    block));
+    rec.refs.push_back(claim(fl->iteratorGet(), block));
+
+  } else if (CForLoop* cfl = toCForLoop(block)) {
+    rec.kind = BLOCK_KIND_C_FOR;
+    rec.refs.push_back(ref(cfl->initBlockGet()));
+    rec.refs.push_back(ref(cfl->testBlockGet()));
+    rec.refs.push_back(ref(cfl->incrBlockGet()));
+
+  } else if (ParamForLoop* pfl = toParamForLoop(block)) {
+    CallExpr* info = pfl->resolveInfo();
+
+    rec.kind = BLOCK_KIND_PARAM_FOR;
+    rec.refs.push_back(claim(info, block));
+
+    if (info == NULL || info->numActuals() != 4) {
+      refuse();
+    } else {
+      for_actuals(actual, info) {
+        if (isSymExpr(actual) == false)
+          refuse();
+
+        rec.refs.push_back(claim(actual, block));
+      }
+    }
+
+  } else {
+    refuse();
+  }
+}
+
+void CacheWriter::writeRecord(const NodeRecord& rec) {
+  ByteWriter& w = nodeBytes;
+  size_t      ints, strs, refs, lists;
+
+  // The loader derives the number of slots from the tag.
+  if (recordShape(rec.tag, rec.kind, &ints, &strs, &refs, &lists) == false ||
+      rec.ints.size()  != ints                                           ||
+      rec.strs.size()  != strs                                           ||
+      rec.refs.size()  != refs                                           ||
+      rec.lists.size() != lists) {
+    refuse();
+    return;
+  }
+
+  w.u8(rec.tag);
+  w.u8(rec.kind);
+  w.i32(rec.lineno);
+  w.i32(strIndex(rec.filename));
+
+  for (size_t i = 0; i < rec.ints.size(); i++)
+    w.i32(rec.ints[i]);
+
+  for (size_t i = 0; i < rec.strs.size(); i++)
+    w.i32(strIndex(rec.strs[i]));
+
+  for (size_t i = 0; i < rec.refs.size(); i++)
+    w.i32(rec.refs[i]);
+
+  for (size_t i = 0; i < rec.lists.size(); i++) {
+    w.u32(rec.lists[i].size());
+
+    for (size_t j = 0; j < rec.lists[i].size(); j++)
+      w.i32(rec.lists[i][j]);
+  }
+
+  w.u32(rec.flags.size());
+  for (size_t i = 0; i < rec.flags.size(); i++)
+    w.u32(rec.flags[i]);
+
+  w.u8(rec.hasImmediate);
+  if (rec.hasImmediate)
+    w.immediate(rec.immediate);
+}
+
+static bool idLessThan(BaseAST* a, BaseAST* b) {
+  return a->id < b->id;
+}
+
+bool CacheWriter::build(BlockStmt* block) {
+  std::vector<BaseAST*> asts;
+  std::vector<BaseAST*> sorted;
+
+  collect_asts_STL(block, asts);
+
+  for (size_t i = 0; i < asts.size(); i++) {
+    if (index.count(asts[i]) > 0)
+      return false;
+
+    index[asts[i]] = 0;
+    sorted.push_back(asts[i]);
+  }
+
+  std::sort(sorted.begin(), sorted.end(), idLessThan);
+
+  for (size_t i = 0; i < sorted.size(); i++)
+    index[sorted[i]] = i;
+
+  nodeBytes.u32(sorted.size());
+
+  for (size_t i = 0; i < sorted.size() && cacheable; i++) {
+    NodeRecord rec;
+
+    makeRecord(sorted[i], rec);
+    writeRecord(rec);
+  }
+
+  trailerBytes.i32(ref(block));
+  trailerBytes.u32(recordUseNames.size());
+
+  for (size_t i = 0; i < recordUseNames.size(); i++) {
+    if (index.count(recordUseExprs[i]) == 0)
+      refuse();
+
+    trailerBytes.str(recordUseNames[i]);
+    trailerBytes.i32(ref(recordUseExprs[i]));
+  }
+
+  return cacheable;
+}
+
+bool CacheWriter::save(const char* path) {
+  ByteWriter header;
+
+  header.str(cacheMagic);
+  header.u32(cacheFormatVersion);
+  header.u64(compilerKey());
+  header.str(recordFilename);
+  header.u32(recordModType);
+  header.u64(recordSourceHash);
+
+  header.u32(NUM_GEN_FN_COUNTERS);
+  for (int i = 0; i < NUM_GEN_FN_COUNTERS; i++) {
+    header.i32(recordCounters[i]);
+    header.i32(genFnCounters[i]);
+  }
+
+  header.u32(recordConfigs.size());
+  for (size_t i = 0; i < recordConfigs.size(); i++) {
+    header.str(recordConfigs[i].name);
+    header.str(recordConfigs[i].text);
+    header.u8(recordConfigs[i].used);
+  }
+
+  header.u32(strings.size());
+  for (size_t i = 0; i < strings.size(); i++)
+    header.str(strings[i]);
+
+  header.u32(externals.size());
+
+  //
+  // Write to a temporary file and rename it into place so that concurrent
+  // compilations never see a partial file.
+  //
+  const char* tmpPath = astr(path, ".tmp", istr((int) getpid()));
+  FILE*       fp      = fopen(tmpPath, "wb");
+  bool        ok      = fp != NULL;
+
+  if (ok) {
+    ByteWriter* parts[] = { &header, &externalBytes, &nodeBytes,
+                            &trailerBytes };
+
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+      std::vector<unsigned char>& bytes = parts[i]->bytes;
+
+      if (bytes.size() > 0 &&
+          fwrite(&bytes[0], 1, bytes.size(), fp) != bytes.size())
+        ok = false;
+    }
+
+    if (fclose(fp) != 0)
+      ok = false;
+
+    if (ok && rename(tmpPath, path) != 0)
+      ok = false;
+
+    if (ok == false)
+      unlink(tmpPath);
+  }
+
+  return ok;
+}
+
+void startCachingParse(const char* filename, ModTag modType) {
+  recording         = true;
+  recordFilename    = filename;
+  recordModType     = modType;
+  recordDiagnostics = numUserDiagnostics();
+  recordCacheable   = hashSourceFile(filename, &recordSourceHash);
+
+  for (int i = 0; i < NUM_GEN_FN_COUNTERS; i++)
+    recordCounters[i] = genFnCounters[i];
+
+  recordUseNames.clear();
+  recordUseExprs.clear();
+  recordConfigs.clear();
+}
+
+void finishCachingParse(BlockStmt* block) {
+  static bool madeDir = false;
+
+  if (recording == false)
+    return;
+
+  recording = false;
+
+  if (recordCacheable                           == true &&
+      block                                     != NULL &&
+      numUserDiagnostics() == recordDiagnostics) {
+    CacheWriter writer;
+
+    if (writer.build(block) == true) {
+      if (madeDir == false) {
+        ensureDirExists(moduleCacheDir, "creating module cache directory");
+        madeDir = true;
+      }
+
+      writer.save(cacheFilename(recordFilename, recordModType));
+    }
+  }
+}
+
+void noteModuleUseForCache(const char* name, CallExpr* useExpr) {
+  if (recording == true) {
+    recordUseNames.push_back(astr(name));
+    recordUseExprs.push_back(useExpr);
+  }
+}
+
+void noteConfigLookupForCache(const char* name) {
+  if (recording == true) {
+    ConfigLookup lookup;
+
+    lookup.name = astr(name);
+    lookup.text = getCmdLineConfigText(name);
+    lookup.used = isUsedCmdLineConfig(lookup.name);
+
+    recordConfigs.push_back(lookup);
+  }
+}
+
+/************************************ | *************************************
+*                                                                           *
+* Loading                                                                   *
+*                                                                           *
+************************************* | ************************************/
+
+class CacheLoader {
+public:
+                          CacheLoader(const char* iFilename, ModTag iModType);
+
+  BlockStmt*              load();
+
+private:
+  bool                    readHeader(ByteReader& r);
+  bool                    readStrings(ByteReader& r);
+  bool                    readExternals(ByteReader& r);
+  bool                    readNodes(ByteReader& r);
+  bool                    readRecord(ByteReader& r, LoadedRecord& rec);
+  bool                    readSpan(ByteReader& r, int length, IntSpan& span);
+  bool                    readTrailer(ByteReader& r);
+  bool                    validRef(int ref)                          const;
+  const char*             str(const LoadedRecord& rec, int i)        const;
+
+  void                    createNode(int i);
+  void                    linkNode(int i);
+
+  BaseAST*                get(int ref)                               const;
+  Expr*                   getExpr(int ref)                           const;
+  Symbol*                 getSymbol(int ref)                         const;
+  Type*                   getType(int ref)                           const;
+  BlockStmt*              getBlock(int ref)                          const;
+  void                    setList(AList& list, const IntSpan& refs);
+  void                    corrupt()                                  const;
+
+  const char*             filename;
+  ModTag                  modType;
+  const char*             path;
+  GenFnRenumbering        renumbering;
+  std::vector<const char*> strings;
+  std::vector<BaseAST*>   externals;
+  std::vector<int>        pool;
+  std::vector<Immediate>  immediates;
+  std::vector<LoadedRecord> records;
+  std::vector<BaseAST*>   nodes;
+  int                     rootRef;
+  std::vector<const char*> useNames;
+  std::vector<int>        useRefs;
+  std::vector<const char*> usedConfigs;
+};
+
+CacheLoader::CacheLoader(const char* iFilename, ModTag iModType) :
+  filename(iFilename),
+  modType(iModType),
+  path(cacheFilename(iFilename, iModType)),
+  rootRef(0) {
+  memset(&renumbering, 0, sizeof(renumbering));
+}
+
+bool CacheLoader::readHeader(ByteReader& r) {
+  uint64_t sourceHash = 0;
+
+  const char* magic = r.str();
+
+  if (r.ok == false || magic == NULL || strcmp(magic, cacheMagic) != 0)
+    return false;
+
+  if (r.u32() != cacheFormatVersion || r.u64() != compilerKey())
+    return false;
+
+  const char* recorded = r.str();
+
+  if (recorded == NULL || strcmp(recorded, filename) != 0)
+    return false;
+
+  if (r.u32() != (uint32_t) modType)
+    return false;
+
+  if (hashSourceFile(filename, &sourceHash) == false ||
+      r.u64() != sourceHash)
+    return false;
+
+  if (r.u32() != NUM_GEN_FN_COUNTERS)
+    return false;
+
+  for (int i = 0; i < NUM_GEN_FN_COUNTERS; i++) {
+    int start   = r.i32();
+    int end     = r.i32();
+    int current = genFnCounters[i];
+
+    if (end < start)
+      return false;
+
+    renumbering.start[i]  = start;
+    renumbering.end[i]    = end;
+    renumbering.offset[i] = (end > start && current > start) ?
+                            current - start : 0;
+
+    if (renumbering.offset[i] != 0)
+      renumbering.any = true;
+  }
+
+  // The configs the file declares have to be set on the command line
+  // just as they were when the file was parsed.
+  int numConfigs = r.count();
+
+  for (int i = 0; i < numConfigs && r.ok; i++) {
+    const char* name = r.str();
+    const char* text = r.str();
+    bool        used = r.u8() != 0;
+
+    if (name == NULL)
+      return false;
+
+    const char* current = getCmdLineConfigText(name);
+
+    if ((current == NULL) != (text == NULL)                ||
+        (text != NULL && strcmp(current, text) != 0)       ||
+        isUsedCmdLineConfig(name) != used)
+      return false;
+
+    if (text != NULL && used == false)
+      usedConfigs.push_back(name);
+  }
+
+  return r.ok;
+}
+
+//
+// Read the string table, moving the names of compiler-generated functions
+// out of the way of the ones that have been handed out since the file was
+// written.
+//
+bool CacheLoader::readStrings(ByteReader& r) {
+  int n = r.count();
+
+  strings.reserve(n);
+
+  for (int i = 0; i < n && r.ok; i++) {
+    const char* str = r.str();
+
+    if (str == NULL)
+      return false;
+
+    if (renumbering.any)
+      str = renumberGenFnName(str, renumbering);
+
+    strings.push_back(str);
+  }
+
+  return r.ok;
+}
+
+bool CacheLoader::readExternals(ByteReader& r) {
+  int n = r.count();
+
+  for (int i = 0; i < n && r.ok; i++) {
+    BaseAST* ast = NULL;
+
+    switch (r.u8()) {
+    case EXTERNAL_SYMBOL: {
+      const char* name = r.str();
+
+      ast = (name != NULL) ? findRootSymbol(name) : NULL;
+      break;
+    }
+
+    case EXTERNAL_TYPE: {
+      const char* name = r.str();
+      Symbol*     sym  = (name != NULL) ? findRootSymbol(name) : NULL;
+
+      ast = (sym != NULL) ? sym->type : NULL;
+      break;
+    }
+
+    case EXTERNAL_LITERAL: {
+      Immediate   imm;
+      r.immediate(&imm);
+      const char* cname    = r.str();
+      const char* typeName = r.str();
+      Symbol*     typeSym  = (typeName != NULL) ? findRootSymbol(typeName)
+                                                : NULL;
+
+      if (r.ok == false || typeSym == NULL || isTypeSymbol(typeSym) == false)
+        return false;
+
+      VarSymbol* var = uniqueConstantsHash.get(&imm);
+
+      if (var == NULL) {
+        // Create it the way the literal builders would have.
+        var        = new_ImmediateSymbol(&imm);
+        var->type  = typeSym->type;
+        var->cname = (cname != NULL) ? cname : var->name;
+      }
+
+      ast = var;
+      break;
+    }
+
+    default:
+      return false;
+    }
+
+    if (ast == NULL)
+      return false;
+
+    externals.push_back(ast);
+  }
+
+  return r.ok;
+}
+
+bool CacheLoader::validRef(int ref) const {
+  return (ref >= 0) ? ref <= (int) records.size()
+                    : -ref - 1 < (int) externals.size();
+}
+
+bool CacheLoader::readSpan(ByteReader& r, int length, IntSpan& span) {
+  // Every integer takes four bytes in the file, so a pool sized for the
+  // file never has to grow and the spans into it stay valid.
+  if (length < 0 || (size_t) length > pool.capacity() - pool.size())
+    return false;
+
+  span.data   = pool.data() + pool.size();
+  span.length = length;
+
+  for (int i = 0; i < length; i++)
+    pool.push_back(r.i32());
+
+  return r.ok;
+}
+
+bool CacheLoader::readRecord(ByteReader& r, LoadedRecord& rec) {
+  size_t ints, strs, refs, lists;
+
+  rec.tag      = r.u8();
+  rec.kind     = r.u8();
+  rec.lineno   = r.i32();
+
+  int filenameIndex = r.i32();
+
+  if (filenameIndex < -1 || filenameIndex >= (int) strings.size())
+    return false;
+
+  rec.filename = (filenameIndex >= 0) ? strings[filenameIndex] : NULL;
+
+  if (recordShape(rec.tag, rec.kind, &ints, &strs, &refs, &lists) == false)
+    return false;
+
+  if (readSpan(r, ints, rec.ints) == false ||
+      readSpan(r, strs, rec.strs) == false ||
+      readSpan(r, refs, rec.refs) == false)
+    return false;
+
+  rec.numLists = lists;
+
+  for (size_t i = 0; i < lists; i++)
+    if (readSpan(r, r.count(), rec.lists[i]) == false)
+      return false;
+
+  if (readSpan(r, r.count(), rec.flags) == false)
+    return false;
+
+  rec.immediate = -1;
+
+  if (r.u8() != 0) {
+    Immediate imm;
+
+    r.immediate(&imm);
+
+    rec.immediate = immediates.size();
+    immediates.push_back(imm);
+  }
+
+  return r.ok;
+}
+
+bool CacheLoader::readNodes(ByteReader& r) {
+  int n = r.count();
+
+  records.resize(n);
+  pool.reserve((r.end - r.cur) / 4);
+
+  for (int i = 0; i < n; i++)
+    if (readRecord(r, records[i]) == false)
+      return false;
+
+  for (int i = 0; i < n; i++) {
+    LoadedRecord& rec = records[i];
+
+    for (int j = 0; j < rec.strs.size(); j++)
+      if (rec.strs[j] < -1 || rec.strs[j] >= (int) strings.size())
+        return false;
+
+    for (int j = 0; j < rec.refs.size(); j++)
+      if (validRef(rec.refs[j]) == false)
+        return false;
+
+    for (int j = 0; j < rec.numLists; j++)
+      for (int k = 0; k < rec.lists[j].size(); k++)
+        if (validRef(rec.lists[j][k]) == false)
+          return false;
+
+    for (int j = 0; j < rec.flags.size(); j++)
+      if (rec.flags[j] <= FLAG_UNKNOWN || rec.flags[j] >= NUM_FLAGS)
+        return false;
+
+    if (rec.tag == E_CallExpr && str(rec, 0) != NULL &&
+        primitives_map.get(str(rec, 0)) == NULL)
+      return false;
+
+    // A type symbol's type has to exist before the symbol does.
+    if (rec.tag == E_TypeSymbol) {
+      int typeRef = rec.refs[0];
+
+      if (typeRef > 0) {
+        if (typeRef - 1 >= i ||
+            isType((AstTag) records[typeRef-1].tag) == false)
+          return false;
+
+      } else if (typeRef == 0 || toType(externals[-typeRef-1]) == NULL) {
+        return false;
+      }
+    }
+
+    // Children that loop constructors create come after the loop.
+    if (rec.tag == E_BlockStmt && rec.kind != BLOCK_KIND_PLAIN &&
+        rec.kind != BLOCK_KIND_C_FOR) {
+      for (int j = 2; j < rec.refs.size(); j++) {
+        int child = rec.refs[j];
+
+        if (child < 0 || (child > 0 && child - 1 <= i))
+          return false;
+
+        if (child == 0 && rec.kind != BLOCK_KIND_WHILE_DO &&
+            rec.kind != BLOCK_KIND_DO_WHILE)
+          return false;
+      }
+    }
+  }
+
+  return r.ok;
+}
+
+bool CacheLoader::readTrailer(ByteReader& r) {
+  rootRef = r.i32();
+
+  if (r.ok == false || rootRef <= 0 || validRef(rootRef) == false ||
+      records[rootRef-1].tag != E_BlockStmt)
+    return false;
+
+  int n = r.count();
+
+  for (int i = 0; i < n && r.ok; i++) {
+    const char* name = r.str();
+    int         ref  = r.i32();
+
+    if (name == NULL || ref <= 0 || validRef(ref) == false ||
+        records[ref-1].tag != E_CallExpr)
+      return false;
+
+    useNames.push_back(name);
+    useRefs.push_back(ref);
+  }
+
+  return r.ok && r.cur == r.end;
+}
+
+const char* CacheLoader::str(const LoadedRecord& rec, int i) const {
+  int index = rec.strs[i];
+
+  return (index >= 0) ? strings[index] : NULL;
+}
+
+void CacheLoader::corrupt() const {
+  USR_FATAL("module cache file '%s' is corrupt; remove it and try again",
+            path);
+}
+
+BaseAST* CacheLoader::get(int ref) const {
+  if (ref > 0)
+    return nodes[ref-1];
+  else if (ref < 0)
+    return externals[-ref-1];
+  else
+    return NULL;
+}
+
+Expr* CacheLoader::getExpr(int ref) const {
+  BaseAST* ast  = get(ref);
+  Expr*    expr = toExpr(ast);
+
+  if (ast != NULL && expr == NULL)
+    corrupt();
+
+  return expr;
+}
+
+Symbol* CacheLoader::getSymbol(int ref) const {
+  BaseAST* ast = get(ref);
+  Symbol*  sym = toSymbol(ast);
+
+  if (ast != NULL && sym == NULL)
+    corrupt();
+
+  return sym;
+}
+
+Type* CacheLoader::getType(int ref) const {
+  BaseAST* ast  = get(ref);
+  Type*    type = toType(ast);
+
+  if (ast != NULL && type == NULL)
+    corrupt();
+
+  return type;
+}
+
+BlockStmt* CacheLoader::getBlock(int ref) const {
+  BaseAST*   ast   = get(ref);
+  BlockStmt* block = toBlockStmt(ast);
+
+  if (ast != NULL && block == NULL)
+    corrupt();
+
+  return block;
+}
+
+//
+// Relink a list from scratch.  This bypasses AList::insertAtTail(), which
+// would splice in the actuals of a PRIM_ACTUALS_LIST call.
+//
+void CacheLoader::setList(AList& list, const IntSpan& refs) {
+  for (Expr* expr = list.head; expr != NULL; ) {
+    Expr* next = expr->next;
+
+    expr->list = NULL;
+    expr->prev = NULL;
+    expr->next = NULL;
+    expr       = next;
+  }
+
+  list.head   = NULL;
+  list.tail   = NULL;
+  list.length = 0;
+
+  for (int i = 0; i < refs.size(); i++) {
+    Expr* expr = getExpr(refs[i]);
+
+    if (expr == NULL || expr->list != NULL)
+      corrupt();
+
+    expr->list = &list;
+    expr->prev = list.tail;
+
+    if (list.tail != NULL)
+      list.tail->next = expr;
+    else
+      list.head       = expr;
+
+    list.tail = expr;
+    list.length++;
+  }
+}
+
+void CacheLoader::createNode(int i) {
+  LoadedRecord& rec       = records[i];
+  VarSymbol*  placeholder = toVarSymbol(gNil);
+  BaseAST*    ast         = NULL;
+
+  if (nodes[i] != NULL)        // created by its loop's constructor
+    return;
+
+  switch (rec.tag) {
+  case E_SymExpr:
+    ast = new SymExpr(gNil);
+    break;
+
+  case E_UnresolvedSymExpr:
+    ast = new UnresolvedSymExpr(str(rec, 0) != NULL ? str(rec, 0) : "");
+    break;
+
+  case E_DefExpr:
+    ast = new DefExpr(NULL);
+    break;
+
+  case E_CallExpr:
+    ast = new CallExpr((PrimitiveOp*) NULL);
+    break;
+
+  case E_NamedExpr:
+    ast = new NamedExpr(str(rec, 0), NULL);
+    break;
+
+  case E_CondStmt:
+    ast = new CondStmt(NULL, new BlockStmt());
+    break;
+
+  case E_GotoStmt:
+    ast = new GotoStmt((GotoTag) rec.ints[0], (const char*) NULL);
+    break;
+
+  case E_ExternBlockStmt:
+    ast = new ExternBlockStmt(str(rec, 0));
+    break;
+
+  case E_BlockStmt:
+    switch (rec.kind) {
+    case BLOCK_KIND_PLAIN:
+      ast = new BlockStmt();
+      break;
+
+    case BLOCK_KIND_WHILE_DO:
+    case BLOCK_KIND_DO_WHILE: {
+      VarSymbol* cond   = (rec.refs[2] != 0) ? placeholder : NULL;
+      WhileStmt* ws     = NULL;
+
+      if (rec.kind == BLOCK_KIND_WHILE_DO)
+        ws = new WhileDoStmt(cond, NULL);
+      else
+        ws = new DoWhileStmt(cond, NULL);
+
+      if (rec.refs[2] != 0)
+        nodes[rec.refs[2]-1] = ws->condExprGet();
+
+      ast = ws;
+      break;
+    }
+
+    case BLOCK_KIND_FOR: {
+      ForLoop* fl = new ForLoop(placeholder, placeholder, NULL);
+
+      nodes[rec.refs[2]-1] = fl->indexGet();
+      nodes[rec.refs[3]-1] = fl->iteratorGet();
+
+      ast = fl;
+      break;
+    }
+
+    case BLOCK_KIND_C_FOR:
+      ast = new CForLoop(NULL);
+      break;
+
+    case BLOCK_KIND_PARAM_FOR: {
+      ParamForLoop* pfl  = new ParamForLoop(placeholder, placeholder,
+                                            placeholder, placeholder,
+                                            NULL, NULL);
+      CallExpr*     info = pfl->resolveInfo();
+
+      nodes[rec.refs[2]-1] = info;
+
+      for (int j = 1; j <= 4; j++)
+        nodes[rec.refs[2+j]-1] = info->get(j);
+
+      ast = pfl;
+      break;
+    }
+    }
+    break;
+
+  case E_ModuleSymbol: {
+    // The parser creates a module's block before the module.
+    int        blockRef = rec.refs[2];
+    BlockStmt* block    = NULL;
+
+    if (blockRef > 0 && blockRef - 1 < i)
+      block = toBlockStmt(nodes[blockRef-1]);
+
+    ast = new ModuleSymbol(str(rec, 0), (ModTag) rec.ints[0],
+                           (block != NULL) ? block : new BlockStmt());
+    break;
+  }
+
+  case E_VarSymbol:
+    ast = new VarSymbol(str(rec, 0));
+    break;
+
+  case E_ArgSymbol:
+    ast = new ArgSymbol((IntentTag) rec.ints[0], str(rec, 0), dtUnknown);
+    break;
+
+  case E_TypeSymbol:
+    ast = new TypeSymbol(str(rec, 0), getType(rec.refs[0]));
+    break;
+
+  case E_FnSymbol:
+    ast = new FnSymbol(str(rec, 0));
+    break;
+
+  case E_EnumSymbol:
+    ast = new EnumSymbol(str(rec, 0));
+    break;
+
+  case E_LabelSymbol:
+    ast = new LabelSymbol(str(rec, 0));
+    break;
+
+  case E_PrimitiveType:
+    ast = new PrimitiveType(NULL, rec.ints[1] != 0);
+    break;
+
+  case E_EnumType:
+    ast = new EnumType();
+    break;
+
+  case E_AggregateType:
+    ast = new AggregateType((AggregateTag) rec.ints[2]);
+    break;
+  }
+
+  nodes[i] = ast;
+}
+
+void CacheLoader::linkNode(int i) {
+  LoadedRecord& rec = records[i];
+  BaseAST*      ast = nodes[i];
+
+  ast->astloc = makeAstloc(rec.lineno, rec.filename);
+
+  if (Symbol* sym = toSymbol(ast)) {
+    sym->name     = str(rec, 0);
+    sym->cname    = str(rec, 1);
+    sym->type     = getType(rec.refs[0]);
+    sym->defPoint = toDefExpr(getExpr(rec.refs[1]));
+
+    sym->flags.reset();
+
+    for (int j = 0; j < rec.flags.size(); j++)
+      sym->flags.set(rec.flags[j]);
+
+    if (rec.refs[1] != 0 && sym->defPoint == NULL)
+      corrupt();
+  }
+
+  switch (rec.tag) {
+  case E_SymExpr: {
+    Symbol* var = getSymbol(rec.refs[0]);
+
+    if (var == NULL)
+      corrupt();
+
+    toSymExpr(ast)->var = var;
+    break;
+  }
+
+  case E_UnresolvedSymExpr:
+  case E_ExternBlockStmt:
+    break;
+
+  case E_DefExpr: {
+    DefExpr* def = toDefExpr(ast);
+
+    def->sym      = getSymbol(rec.refs[0]);
+    def->init     = getExpr(rec.refs[1]);
+    def->exprType = getExpr(rec.refs[2]);
+    break;
+  }
+
+  case E_CallExpr: {
+    CallExpr* call = toCallExpr(ast);
+
+    if (str(rec, 0) != NULL)
+      call->primitive = primitives_map.get(str(rec, 0));
+
+    call->partialTag = rec.ints[0] != 0;
+    call->methodTag  = rec.ints[1] != 0;
+    call->square     = rec.ints[2] != 0;
+    call->baseExpr   = getExpr(rec.refs[0]);
+
+    setList(call->argList, rec.lists[0]);
+    break;
+  }
+
+  case E_NamedExpr:
+    toNamedExpr(ast)->actual = getExpr(rec.refs[0]);
+    break;
+
+  case E_CondStmt: {
+    CondStmt* cond = toCondStmt(ast);
+
+    cond->condExpr = getExpr(rec.refs[0]);
+    cond->thenStmt = getBlock(rec.refs[1]);
+    cond->elseStmt = getBlock(rec.refs[2]);
+    break;
+  }
+
+  case E_GotoStmt:
+    toGotoStmt(ast)->label = getExpr(rec.refs[0]);
+    break;
+
+  case E_BlockStmt: {
+    BlockStmt* block = toBlockStmt(ast);
+
+    block->blockTag  = (BlockTag) rec.ints[0];
+    block->userLabel = str(rec, 0);
+
+    setList(block->body, rec.lists[0]);
+
+    if (rec.kind == BLOCK_KIND_PLAIN) {
+      block->modUses   = toCallExpr(getExpr(rec.refs[0]));
+      block->byrefVars = toCallExpr(getExpr(rec.refs[1]));
+      block->blockInfoSet(toCallExpr(getExpr(rec.refs[2])));
+
+    } else {
+      LoopStmt* loop = (LoopStmt*) block;
+
+      loop->breakLabelSet(toLabelSymbol(getSymbol(rec.refs[0])));
+      loop->continueLabelSet(toLabelSymbol(getSymbol(rec.refs[1])));
+      loop->orderIndependentSet(rec.ints[1] != 0);
+
+      if (rec.kind == BLOCK_KIND_C_FOR)
+        ((CForLoop*) block)->loopHeaderSet(getBlock(rec.refs[2]),
+                                           getBlock(rec.refs[3]),
+                                           getBlock(rec.refs[4]));
+    }
+    break;
+  }
+
+  case E_ModuleSymbol: {
+    ModuleSymbol* mod = toModuleSymbol(ast);
+
+    BlockStmt*    block = getBlock(rec.refs[2]);
+
+    if (block == NULL)
+      corrupt();
+
+    if (mod->block != block)
+      mod->block->parentSymbol = NULL;
+
+    mod->filename = str(rec, 2);
+    mod->doc      = str(rec, 3);
+    mod->block    = block;
+
+    mod->block->parentSymbol = mod;
+    break;
+  }
+
+  case E_VarSymbol: {
+    VarSymbol* var = toVarSymbol(ast);
+
+    var->doc = str(rec, 2);
+
+    if (rec.immediate >= 0) {
+      var->immediate  = new Immediate;
+      *var->immediate = immediates[rec.immediate];
+    }
+
+    // The parser makes the variable with this pragma the default value
+    // of strings.
+    if (var->hasFlag(FLAG_DEFAULT_STRING_VALUE))
+      dtString->defaultValue = var;
+    break;
+  }
+
+  case E_ArgSymbol: {
+    ArgSymbol* arg = toArgSymbol(ast);
+
+    arg->typeExpr     = getBlock(rec.refs[2]);
+    arg->defaultExpr  = getBlock(rec.refs[3]);
+    arg->variableExpr = getBlock(rec.refs[4]);
+    break;
+  }
+
+  case E_FnSymbol: {
+    FnSymbol* fn = toFnSymbol(ast);
+
+    fn->thisTag     = (IntentTag) rec.ints[0];
+    fn->retTag      = (RetTag) rec.ints[1];
+    fn->userString  = str(rec, 2);
+    fn->doc         = str(rec, 3);
+    fn->setter      = toDefExpr(getExpr(rec.refs[2]));
+    fn->retType     = getType(rec.refs[3]);
+    fn->where       = getBlock(rec.refs[4]);
+    fn->retExprType = getBlock(rec.refs[5]);
+    fn->body        = getBlock(rec.refs[6]);
+    fn->_this       = getSymbol(rec.refs[7]);
+
+    if (fn->body == NULL)
+      corrupt();
+
+    setList(fn->formals, rec.lists[0]);
+    break;
+  }
+
+  case E_TypeSymbol:
+  case E_EnumSymbol:
+  case E_LabelSymbol:
+    break;
+
+  case E_PrimitiveType:
+  case E_EnumType:
+  case E_AggregateType: {
+    Type* type = toType(ast);
+
+    type->hasGenericDefaults = rec.ints[0] != 0;
+    type->isInternalType     = rec.ints[1] != 0;
+    type->defaultValue       = getSymbol(rec.refs[0]);
+
+    type->methods.clear();
+
+    for (int j = 0; j < rec.lists[0].size(); j++) {
+      FnSymbol* method = toFnSymbol(getSymbol(rec.lists[0][j]));
+
+      if (method == NULL)
+        corrupt();
+
+      type->methods.add(method);
+    }
+
+    if (EnumType* et = toEnumType(type)) {
+      et->integerType = toPrimitiveType(getType(rec.refs[1]));
+      setList(et->constants, rec.lists[1]);
+
+    } else if (AggregateType* at = toAggregateType(type)) {
+      at->doc   = str(rec, 0);
+      at->outer = getSymbol(rec.refs[1]);
+
+      setList(at->fields,   rec.lists[1]);
+      setList(at->inherits, rec.lists[2]);
+    }
+    break;
+  }
+  }
+}
+
+BlockStmt* CacheLoader::load() {
+  std::vector<unsigned char> data;
+  FILE*                      fp = fopen(path, "rb");
+
+  if (fp == NULL)
+    return NULL;
+
+  unsigned char buf[65536];
+  size_t        n;
+
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+    data.insert(data.end(), buf, buf + n);
+
+  bool readError = ferror(fp) != 0;
+
+  fclose(fp);
+
+  if (readError)
+    return NULL;
+
+  ByteReader r(data);
+
+  if (readHeader(r)    == false ||
+      readStrings(r)   == false ||
+      readExternals(r) == false ||
+      readNodes(r)     == false ||
+      readTrailer(r)   == false)
+    return NULL;
+
+  //
+  // Nothing below can fail short of a corrupt file.  Create all nodes in
+  // their original order, then fill in their fields.
+  //
+  nodes.resize(records.size(), NULL);
+
+  for (size_t i = 0; i < records.size(); i++)
+    createNode(i);
+
+  for (size_t i = 0; i < records.size(); i++)
+    linkNode(i);
+
+  for (size_t i = 0; i < useNames.size(); i++)
+    addModuleToParseList(useNames[i], toCallExpr(get(useRefs[i])));
+
+  for (size_t i = 0; i < usedConfigs.size(); i++)
+    useCmdLineConfig(usedConfigs[i]);
+
+  for (int i = 0; i < NUM_GEN_FN_COUNTERS; i++)
+    if (renumbering.end[i] > renumbering.start[i])
+      genFnCounters[i] = std::max(genFnCounters[i],
+                                  renumbering.end[i] + renumbering.offset[i]);
+
+  return toBlockStmt(get(rootRef));
+}
+
+BlockStmt* loadCachedParse(const char* filename, ModTag modType) {
+  CacheLoader loader(filename, modType);
+
+  return loader.load();
+}
@@ -21,6 +21,7 @@
 #include "build.h"
 #include "countTokens.h"
 #include "files.h"
+#include "moduleCache.h"
 #include "parser.h"
 #include "stringutil.h"
 #include "symbol.h"
@@ -43,6 +44,7 @@ static bool handlingInternalModulesNow = false;
 
 void addModuleToParseList(const char* name, CallExpr* useExpr) {
   const char* modName = astr(name);
+  noteModuleUseForCache(modName, useExpr);
   if (modDoneSet.set_in(modName) || modNameSet.set_in(modName)) {
     //    printf("We've already seen %s\n", modName);
   } else {
@@ -118,7 +120,6 @@ ModuleSymbol* ParseFile(const char* filename, ModTag modType) {
   yylloc.first_column = yylloc.last_column = 0;
   yylloc.first_line = yylloc.last_line = yystartlineno = chplLineno = 1;
   yylloc.comment = NULL;
-  yyin = openInputFile(filename);
 
   if (printModuleFiles && (modType != MOD_INTERNAL || developer)) {
     if (firstFile) {
@@ -129,15 +130,28 @@ ModuleSymbol* ParseFile(const char* filename, ModTag modType) {
   }
   
   yyblock = NULL;
-  if (modType == MOD_MAIN) {
-    startCountingFileTokens(filename);
-  }
-  yyparse();
-  if (modType == MOD_MAIN) {
-    stopCountingFileTokens();
+  bool useCache = moduleCacheEnabled(modType);
+  if (useCache) {
+    yyblock = loadCachedParse(filename, modType);
   }
+  if (yyblock == NULL) {
+    yyin = openInputFile(filename);
+    if (modType == MOD_MAIN) {
+      startCountingFileTokens(filename);
+    }
+    if (useCache) {
+      startCachingParse(filename, modType);
+    }
+    yyparse();
+    if (useCache) {
+      finishCachingParse(yyblock);
+    }
+    if (modType == MOD_MAIN) {
+      stopCountingFileTokens();
+    }
 
-  closeInputFile(yyin);
+    closeInputFile(yyin);
+  }
 
   if (!yyblock->body.head || !containsOnlyModules(yyblock, filename)) {
     const char* modulename = filenameToModulename(filename);
@@ -36,6 +36,7 @@
 
 #include <inttypes.h>
 
+#include <algorithm>
 #include <cctype>
 #include <cstring>
 #include <cstdio>
@@ -47,6 +48,27 @@ GenInfo* gGenInfo   =  0;
 int      gMaxVMT    = -1;
 int      gStmtCount =  0;
 
+// When the generated C is split into several translation units, each
+// of them includes chpl__header.h, so the header may only declare
+// things.  The definitions it would otherwise hold are written to
+// _main.c instead.  These are only set while generating in that mode.
+static FILE* splitHdrFile  = NULL;
+static FILE* splitDefsFile = NULL;
+
+bool codegenSeparateUnits(void) {
+  return !llvmCodegen && !fHeterogeneous && fCodegenJobs > 1;
+}
+
+//
+// Return the file that a definition should be written to when code
+// is being generated into outfile.
+//
+static FILE* defsFileFor(FILE* outfile) {
+  if (splitHdrFile && outfile == splitHdrFile)
+    return splitDefsFile;
+  return outfile;
+}
+
 
 static const char*
 subChar(Symbol* sym, const char* ch, const char* x) {
@@ -132,7 +154,10 @@ genGlobalDefClassId(const char* cname, int id) {
   name += cname;
   
   if( info->cfile ) {
-    fprintf(info->cfile, "const %s %s = %d;\n", 
+    // Every translation unit gets its own copy of the class ids so
+    // that the backend can still fold them.
+    fprintf(info->cfile, "%sconst %s %s = %d;\n",
+                      (splitHdrFile ? "static " : ""),
                       id_type_name, name.c_str(), id);
   } else {
 #ifdef HAVE_LLVM
@@ -150,7 +175,10 @@ static void
 genGlobalString(const char* cname, const char* value) {
   GenInfo* info = gGenInfo;
   if( info->cfile ) {
-    fprintf(info->cfile, "const char* %s = \"%s\";\n", cname, value);
+    FILE* defsfile = defsFileFor(info->cfile);
+    if (defsfile != info->cfile)
+      fprintf(info->cfile, "extern const char* %s;\n", cname);
+    fprintf(defsfile, "const char* %s = \"%s\";\n", cname, value);
   } else {
 #ifdef HAVE_LLVM
     llvm::GlobalVariable *globalString = llvm::cast<llvm::GlobalVariable>(
@@ -167,7 +195,10 @@ static void
 genGlobalInt(const char* cname, int value) {
   GenInfo* info = gGenInfo;
   if( info->cfile ) {
-    fprintf(info->cfile, "const int %s = %d;\n", cname, value);
+    FILE* defsfile = defsFileFor(info->cfile);
+    if (defsfile != info->cfile)
+      fprintf(info->cfile, "extern const int %s;\n", cname);
+    fprintf(defsfile, "const int %s = %d;\n", cname, value);
   } else {
 #ifdef HAVE_LLVM
     llvm::GlobalVariable *globalInt = llvm::cast<llvm::GlobalVariable>(
@@ -199,18 +230,21 @@ genFtable(Vec<FnSymbol*> & fSymbols) {
   const char* ftable_name = "chpl_ftable";
   if( info->cfile ) {
     FILE* hdrfile = info->cfile;
-    fprintf(hdrfile, "chpl_fn_p %s[] = {\n", ftable_name);
+    FILE* defsfile = defsFileFor(hdrfile);
+    if (defsfile != hdrfile)
+      fprintf(hdrfile, "extern chpl_fn_p %s[];\n", ftable_name);
+    fprintf(defsfile, "chpl_fn_p %s[] = {\n", ftable_name);
     bool first = true;
     forv_Vec(FnSymbol, fn, fSymbols) {
       if (!first)
-        fprintf(hdrfile, ",\n");
-      fprintf(hdrfile, "(chpl_fn_p)%s", fn->cname);
+        fprintf(defsfile, ",\n");
+      fprintf(defsfile, "(chpl_fn_p)%s", fn->cname);
       first = false;
     }
 
     if (fSymbols.n == 0)
-      fprintf(hdrfile, "(chpl_fn_p)0");
-    fprintf(hdrfile, "\n};\n");
+      fprintf(defsfile, "(chpl_fn_p)0");
+    fprintf(defsfile, "\n};\n");
   } else {
 #ifdef HAVE_LLVM
     std::vector<llvm::Constant *> table ((fSymbols.n == 0) ? 1 : fSymbols.n);
@@ -257,29 +291,32 @@ genVirtualMethodTable(Vec<TypeSymbol*>& types) {
   const char* vmt = "chpl_vmtable";
   if( info->cfile ) {
     FILE* hdrfile = info->cfile;
+    FILE* defsfile = defsFileFor(hdrfile);
     // MPF - in order to simplify code generation, making
     // chpl_vmtable a 1D array.
-    fprintf(hdrfile, "chpl_fn_p %s[] = {\n", vmt);
+    if (defsfile != hdrfile)
+      fprintf(hdrfile, "extern chpl_fn_p %s[];\n", vmt);
+    fprintf(defsfile, "chpl_fn_p %s[] = {\n", vmt);
     bool comma = false;
     forv_Vec(TypeSymbol, ts, types) {
       if (AggregateType* ct = toAggregateType(ts->type)) {
         if (!isReferenceType(ct) && isClass(ct)) {
           if (comma)
-            fprintf(hdrfile, ",\n");
-          fprintf(hdrfile, " /* %s */\n", ct->symbol->cname);
+            fprintf(defsfile, ",\n");
+          fprintf(defsfile, " /* %s */\n", ct->symbol->cname);
           int n = 0;
           if (Vec<FnSymbol*>* vfns = virtualMethodTable.get(ct)) {
             forv_Vec(FnSymbol, vfn, *vfns) {
               if (n > 0)
-                fprintf(hdrfile, ",\n");
-              fprintf(hdrfile, "(chpl_fn_p)%s", vfn->cname);
+                fprintf(defsfile, ",\n");
+              fprintf(defsfile, "(chpl_fn_p)%s", vfn->cname);
               n++;
             }
           }
           for (int i = n; i < maxVMT; i++) {
             if (n > 0)
-              fprintf(hdrfile, ",\n");
-            fprintf(hdrfile, "(chpl_fn_p)NULL");
+              fprintf(defsfile, ",\n");
+            fprintf(defsfile, "(chpl_fn_p)NULL");
             n++;
           }
           comma = true;
@@ -287,8 +324,8 @@ genVirtualMethodTable(Vec<TypeSymbol*>& types) {
       }
     }
     if (types.n == 0 || maxVMT == 0)
-      fprintf(hdrfile, "(chpl_fn_p)0");
-    fprintf(hdrfile, "\n};\n");
+      fprintf(defsfile, "(chpl_fn_p)0");
+    fprintf(defsfile, "\n};\n");
   } else {
 #ifdef HAVE_LLVM
     const char* vmtData = "chpl_vmtable_data";
@@ -699,7 +736,7 @@ static void codegen_header() {
     fprintf(hdrfile, "#include \"stdchpl.h\"\n");
 
     // Include the compilation config file
-    fprintf(hdrfile, "#include \"%s.c\"\n", sCfgFname);
+    fprintf(defsFileFor(hdrfile), "#include \"%s.c\"\n", sCfgFname);
 
 #ifdef HAVE_LLVM
     //include generated extern C header file
@@ -799,15 +836,26 @@ static void codegen_header() {
 
   genComment("Global Variables");
   forv_Vec(VarSymbol, varSymbol, globals) {
-    varSymbol->codegenGlobalDef();
+    varSymbol->codegenGlobalDef(/*isHeader=*/splitHdrFile != NULL);
   }
   flushStatements();
+  if (splitHdrFile) {
+    info->cfile = splitDefsFile;
+    forv_Vec(VarSymbol, varSymbol, globals) {
+      varSymbol->codegenGlobalDef();
+    }
+    flushStatements();
+    info->cfile = hdrfile;
+  }
 
   genGlobalInt("chpl_numGlobalsOnHeap", numGlobalsOnHeap);
   int globals_registry_static_size = (numGlobalsOnHeap ? numGlobalsOnHeap : 1);
   if( hdrfile ) {
-    fprintf(hdrfile, "\nptr_wide_ptr_t chpl_globals_registry[%d];\n",
-                     globals_registry_static_size);
+    FILE* defsfile = defsFileFor(hdrfile);
+    if (defsfile != hdrfile)
+      fprintf(hdrfile, "\nextern ptr_wide_ptr_t chpl_globals_registry[];\n");
+    fprintf(defsfile, "\nptr_wide_ptr_t chpl_globals_registry[%d];\n",
+                      globals_registry_static_size);
   } else {
 #ifdef HAVE_LLVM
     llvm::Type* ptr_wide_ptr_t = info->lvt->getType("ptr_wide_ptr_t");
@@ -832,15 +880,18 @@ static void codegen_header() {
   }
   genGlobalInt("chpl_heterogeneous", fHeterogeneous?1:0);
   if( hdrfile ) {
-    fprintf(hdrfile, "\nconst char* chpl_mem_descs[] = {\n");
+    FILE* defsfile = defsFileFor(hdrfile);
+    if (defsfile != hdrfile)
+      fprintf(hdrfile, "\nextern const char* chpl_mem_descs[];\n");
+    fprintf(defsfile, "\nconst char* chpl_mem_descs[] = {\n");
     bool first = true;
     forv_Vec(const char*, memDesc, memDescsVec) {
       if (!first)
-        fprintf(hdrfile, ",\n");
-      fprintf(hdrfile, "\"%s\"", memDesc);
+        fprintf(defsfile, ",\n");
+      fprintf(defsfile, "\"%s\"", memDesc);
       first = false;
     }
-    fprintf(hdrfile, "\n};\n");
+    fprintf(defsfile, "\n};\n");
   } else {
 #ifdef HAVE_LLVM
     std::vector<llvm::Constant *> memDescTable;
@@ -872,17 +923,20 @@ static void codegen_header() {
   // add table of private-broadcast constants
   //
   if( hdrfile ) {
-    fprintf(hdrfile, "\nvoid* const chpl_private_broadcast_table[] = {\n");
-    fprintf(hdrfile, "&chpl_verbose_comm");
-    fprintf(hdrfile, ",\n&chpl_comm_diagnostics");
-    fprintf(hdrfile, ",\n&chpl_verbose_mem");
+    FILE* defsfile = defsFileFor(hdrfile);
+    if (defsfile != hdrfile)
+      fprintf(hdrfile, "\nextern void* const chpl_private_broadcast_table[];\n");
+    fprintf(defsfile, "\nvoid* const chpl_private_broadcast_table[] = {\n");
+    fprintf(defsfile, "&chpl_verbose_comm");
+    fprintf(defsfile, ",\n&chpl_comm_diagnostics");
+    fprintf(defsfile, ",\n&chpl_verbose_mem");
     int i = 3;
     forv_Vec(CallExpr, call, gCallExprs) {
       if (call->isPrimitive(PRIM_PRIVATE_BROADCAST)) {
         SymExpr* se = toSymExpr(call->get(1));
         INT_ASSERT(se);
         SET_LINENO(call);
-        fprintf(hdrfile, ",\n&%s", se->var->cname);
+        fprintf(defsfile, ",\n&%s", se->var->cname);
         // To preserve operand order, this should be insertAtTail.
         // The change must also be made below (for LLVM) and in the signature
         // of chpl_comm_broadcast_private().
@@ -890,7 +944,7 @@ static void codegen_header() {
         i++;
       }
     }
-    fprintf(hdrfile, "\n};\n");
+    fprintf(defsfile, "\n};\n");
   } else {
 #ifdef HAVE_LLVM
     llvm::Type *private_broadcastTableEntryType =
@@ -1076,6 +1130,52 @@ codegen_config() {
 }
 
 
+//
+// Bundle the generated module files into fCodegenJobs translation
+// units of roughly equal size so that the backend can compile them in
+// parallel.  Each module goes into the currently smallest unit,
+// largest modules first; within a unit the modules keep their
+// original order.
+//
+static void
+codegen_units(std::vector<const char*>& moduleFilenames,
+              std::vector<long>& moduleSizes,
+              std::vector<const char*>& unitFilenames) {
+  int numModules = moduleFilenames.size();
+  int numUnits = std::min(fCodegenJobs, numModules);
+
+  std::vector<std::pair<long, int> > bySize;
+  for (int i = 0; i < numModules; i++)
+    bySize.push_back(std::make_pair(-moduleSizes[i], i));
+  std::sort(bySize.begin(), bySize.end());
+
+  std::vector<long> unitSizes(numUnits, 0);
+  std::vector<int> unitOf(numModules, 0);
+  for (int i = 0; i < numModules; i++) {
+    int m = bySize[i].second;
+    int smallest = 0;
+    for (int u = 1; u < numUnits; u++) {
+      if (unitSizes[u] < unitSizes[smallest])
+        smallest = u;
+    }
+    unitOf[m] = smallest;
+    unitSizes[smallest] += moduleSizes[m];
+  }
+
+  for (int u = 0; u < numUnits; u++) {
+    fileinfo unitfile;
+    openCFile(&unitfile, astr("chpl__unit", istr(u)), "c");
+    fprintf(unitfile.fptr, "#include \"chpl__header.h\"\n");
+    for (int i = 0; i < numModules; i++) {
+      if (unitOf[i] == u)
+        fprintf(unitfile.fptr, "#include \"%s\"\n", moduleFilenames[i]);
+    }
+    closeCFile(&unitfile, false);
+    unitFilenames.push_back(unitfile.pathname);
+  }
+}
+
+
 void codegen(void) {
   if (no_codegen)
     return;
@@ -1144,7 +1244,10 @@ void codegen(void) {
 
     fprintf(mainfile.fptr, "#include \"chpl__header.h\"\n");
 
-    codegen_makefile(&mainfile);
+    if (codegenSeparateUnits()) {
+      splitHdrFile  = hdrfile.fptr;
+      splitDefsFile = mainfile.fptr;
+    }
   }
 
   // This dumps the generated sources into the build directory.
@@ -1181,6 +1284,8 @@ void codegen(void) {
   }
 
   ChainHashMap<char*, StringHashFns, int> filenames;
+  std::vector<const char*> moduleFilenames;
+  std::vector<long> moduleSizes;
   forv_Vec(ModuleSymbol, currentModule, allModules) {
     mysystem(astr("# codegen-ing module", currentModule->name),
              "generating comment for --print-commands option");
@@ -1221,19 +1326,33 @@ void codegen(void) {
     info->cfile = modulefile.fptr;
     
     currentModule->codegenDef();
+    if (splitHdrFile) {
+      moduleFilenames.push_back(astr(filename, ".c"));
+      moduleSizes.push_back(ftell(modulefile.fptr));
+    } else {
+      fprintf(mainfile.fptr, "#include \"%s%s\"\n", filename, ".c");
+    }
     closeCFile(&modulefile);
-    fprintf(mainfile.fptr, "#include \"%s%s\"\n", filename, ".c");
   }
 
+  std::vector<const char*> unitFilenames;
+  if (splitHdrFile)
+    codegen_units(moduleFilenames, moduleSizes, unitFilenames);
+
   if (fHeterogeneous) 
     codegenTypeStructures(hdrfile.fptr);
 
   info->cfile = hdrfile.fptr;
   codegen_header_addons();
 
+  splitHdrFile  = NULL;
+  splitDefsFile = NULL;
+
   closeCFile(&hdrfile);
   closeCFile(&mainfile);
 
+  codegen_makefile(&mainfile, NULL, false, unitFilenames);
+
   if (fPrintEmittedCodeSize)
   {
     fprintf(stderr, "Statements emitted: %d\n", gStmtCount);
@@ -1250,6 +1369,8 @@ void makeBinary(void) {
 #endif
   } else {
     const char* makeflags = printSystemCommands ? "-f " : "-s -f ";
+    if (codegenSeparateUnits())
+      makeflags = astr("-j", istr(fCodegenJobs), " ", makeflags);
     const char* command = astr(astr(CHPL_MAKE, " "),
                                makeflags,
                                getIntermediateDirName(), "/Makefile");
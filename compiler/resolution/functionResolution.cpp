@@ -1601,7 +1601,8 @@ expandVarArgs(FnSymbol* origFn, int numActuals) {
     if (DefExpr* def = toDefExpr(formal->variableExpr->body.tail)) {
       int numCopies = numActuals - workingFn->numFormals() + 1;
       if (numCopies <= 0) {
-        if (workingFn != origFn) delete workingFn;
+        // the partial expansion is reclaimed by cleanAst
+        if (workingFn != origFn) workingFn->defPoint->remove();
         return NULL;
       }
 
@@ -2591,6 +2592,46 @@ static int nVisibleFunctions = 0; // for incremental build
 static Map<BlockStmt*,BlockStmt*> visibilityBlockCache;
 static Vec<BlockStmt*> standardModuleSet;
 
+//
+// The part of a call that determines which visible function it resolves
+// to: where the search starts, the kind of call, and for each actual its
+// name, type, type-ness, and, if it is a param, the param itself.
+//
+class CallSignature {
+ public:
+  struct Actual {
+    const char* name;
+    Type*       type;
+    Symbol*     param;
+    bool        isType;
+  };
+
+  BlockStmt*          scope;
+  bool                methodTag;
+  bool                partialTag;
+  std::vector<Actual> actuals;
+
+  CallSignature(BlockStmt* iscope, CallInfo& info);
+  bool operator<(const CallSignature& other) const;
+};
+
+//
+// Per-name caches in front of getVisibleFunctions and candidate
+// selection.  visibleFns holds the flattened result of searching for the
+// name from a visibility block; bestFns maps call signatures to the
+// candidate that was chosen for them.  Both are discarded when a new
+// function with the name becomes visible.
+//
+class VisibleNameCache {
+ public:
+  Map<BlockStmt*,Vec<FnSymbol*>*> visibleFns;
+  std::map<CallSignature,FnSymbol*> bestFns;
+  VisibleNameCache() { }
+  void clear();
+};
+
+static Map<const char*,VisibleNameCache*> visibleNameCacheMap;
+
 //
 // return true if expr is a CondStmt with chpl__tryToken as its condition 
 //
@@ -2663,6 +2704,8 @@ static void buildVisibleFunctionMap() {
         vfb->visibleFunctions.put(fn->name, fns);
       }
       fns->add(fn);
+      if (VisibleNameCache* vnc = visibleNameCacheMap.get(fn->name))
+        vnc->clear();
     }
   }
   nVisibleFunctions = gFnSymbols.n;
@@ -2729,6 +2772,126 @@ getVisibleFunctions(BlockStmt* block,
   return NULL;
 }
 
+
+CallSignature::CallSignature(BlockStmt* iscope, CallInfo& info) :
+  scope(iscope),
+  methodTag(info.call->methodTag),
+  partialTag(info.call->partialTag),
+  actuals(info.actuals.n) {
+  for (int i = 0; i < info.actuals.n; i++) {
+    Symbol* actual = info.actuals.v[i];
+    actuals[i].name = info.actualNames.v[i];
+    actuals[i].type = actual->type;
+    actuals[i].param =
+      (actual->isParameter() || isEnumSymbol(actual)) ? actual : NULL;
+    actuals[i].isType = actual->hasFlag(FLAG_TYPE_VARIABLE);
+  }
+}
+
+
+bool CallSignature::operator<(const CallSignature& other) const {
+  if (scope != other.scope)
+    return scope < other.scope;
+  if (methodTag != other.methodTag)
+    return methodTag < other.methodTag;
+  if (partialTag != other.partialTag)
+    return partialTag < other.partialTag;
+  if (actuals.size() != other.actuals.size())
+    return actuals.size() < other.actuals.size();
+  for (size_t i = 0; i < actuals.size(); i++) {
+    const Actual& a1 = actuals[i];
+    const Actual& a2 = other.actuals[i];
+    if (a1.name != a2.name)
+      return a1.name < a2.name;
+    if (a1.type != a2.type)
+      return a1.type < a2.type;
+    if (a1.param != a2.param)
+      return a1.param < a2.param;
+    if (a1.isType != a2.isType)
+      return a1.isType < a2.isType;
+  }
+  return false;
+}
+
+
+void VisibleNameCache::clear() {
+  Vec<Vec<FnSymbol*>*> fnVecs;
+  visibleFns.get_values(fnVecs);
+  forv_Vec(Vec<FnSymbol*>, fns, fnVecs) {
+    delete fns;
+  }
+  visibleFns.clear();
+  bestFns.clear();
+}
+
+
+static VisibleNameCache* getVisibleNameCache(const char* name) {
+  VisibleNameCache* vnc = visibleNameCacheMap.get(name);
+  if (!vnc) {
+    vnc = new VisibleNameCache();
+    visibleNameCacheMap.put(name, vnc);
+  }
+  return vnc;
+}
+
+
+//
+// return the outermost block from which calls resolve the same way as
+// from 'block'; a block is skipped if it neither defines visible
+// functions nor uses modules and its visibility block is its parent
+//
+static BlockStmt*
+getCallSignatureScope(BlockStmt* block) {
+  while (block != rootModule->block &&
+         !standardModuleSet.set_in(block) &&
+         !block->modUses &&
+         !visibleFunctionMap.get(block) &&
+         !(block->parentExpr && isTryTokenCond(block->parentExpr))) {
+    BlockStmt* next = getVisibilityBlock(block);
+    if (getParentBlock(block) != next)
+      break;
+    block = next;
+  }
+  return block;
+}
+
+
+//
+// return the functions named 'name' that are visible from 'block'; this
+// is getVisibleFunctions with the result saved per block and name
+//
+static Vec<FnSymbol*>*
+getCachedVisibleFunctions(BlockStmt* block, const char* name) {
+  VisibleNameCache* vnc = getVisibleNameCache(name);
+  Vec<FnSymbol*>* fns = vnc->visibleFns.get(block);
+  if (!fns) {
+    Vec<BlockStmt*> visited;
+    fns = new Vec<FnSymbol*>();
+    getVisibleFunctions(block, name, *fns, visited);
+    vnc->visibleFns.put(block, fns);
+  }
+  return fns;
+}
+
+
+//
+// return the function chosen by an earlier call with the same signature,
+// provided it is still in the tree
+//
+static FnSymbol*
+getCachedBestFunction(const char* name, const CallSignature& sig) {
+  VisibleNameCache* vnc = getVisibleNameCache(name);
+  std::map<CallSignature,FnSymbol*>::iterator it = vnc->bestFns.find(sig);
+  if (it == vnc->bestFns.end())
+    return NULL;
+  FnSymbol* fn = it->second;
+  if (!fn->defPoint || !fn->defPoint->parentSymbol) {
+    vnc->bestFns.erase(it);
+    return NULL;
+  }
+  return fn;
+}
+
 static void replaceActualWithDeref(CallExpr* call, Type* derefType,
                                    SymExpr* actualExpr, Symbol* actualSym,
                                    CallInfo* info, int argNum)
@@ -3122,10 +3285,31 @@ void resolveNormalCall(CallExpr* call) {
     buildVisibleFunctionMap();
   }
 
+  bool explainCall = (explainCallLine && explainCallMatch(call)) ||
+                     call->id == explainCallID;
+
+  Expr* scope = (info.scope) ? info.scope : getVisibilityBlock(call);
+
+  //
+  // A call with the same signature as one resolved earlier from the same
+  // scope resolves to the same function, so only that function needs to
+  // be considered.  Calls being explained go the long way so that all of
+  // the visible functions and candidates are reported, and calls that
+  // name a module scope are not cached.
+  //
+  bool useCache = !call->isResolved() && !info.scope && !explainCall;
+  BlockStmt* sigScope = (info.scope) ? info.scope :
+                        getCallSignatureScope(toBlockStmt(scope));
+  CallSignature sig(sigScope, info);
+  FnSymbol* cachedFn = NULL;
+
   if (!call->isResolved()) {
-    if (!info.scope) {
-      Vec<BlockStmt*> visited;
-      getVisibleFunctions(getVisibilityBlock(call), info.name, visibleFns, visited);
+    if (useCache)
+      cachedFn = getCachedBestFunction(info.name, sig);
+    if (cachedFn) {
+      visibleFns.add(cachedFn);
+    } else if (!info.scope) {
+      visibleFns.append(*getCachedVisibleFunctions(sigScope, info.name));
     } else {
       if (VisibleFunctionBlock* vfb = visibleFunctionMap.get(info.scope)) {
         if (Vec<FnSymbol*>* fns = vfb->visibleFunctions.get(info.name)) {
@@ -3138,8 +3322,7 @@ void resolveNormalCall(CallExpr* call) {
     handleCaptureArgs(call, call->isResolved(), &info);
   }
 
-  if ((explainCallLine && explainCallMatch(call)) ||
-      call->id == explainCallID)
+  if (explainCall)
   {
     USR_PRINT(call, "call: %s", toString(&info));
     if (visibleFns.n == 0)
@@ -3156,8 +3339,22 @@ void resolveNormalCall(CallExpr* call) {
   Vec<ResolutionCandidate*> candidates;
   gatherCandidates(candidates, visibleFns, info);
 
-  if ((explainCallLine && explainCallMatch(info.call)) ||
-      call->id == explainCallID)
+  //
+  // If the cached function is somehow no longer a candidate, fall back
+  // to considering all of the visible functions.
+  //
+  if (cachedFn && candidates.n != 1) {
+    forv_Vec(ResolutionCandidate*, candidate, candidates) {
+      delete candidate;
+    }
+    candidates.clear();
+    visibleFns.clear();
+    cachedFn = NULL;
+    visibleFns.append(*getCachedVisibleFunctions(sigScope, info.name));
+    gatherCandidates(candidates, visibleFns, info);
+  }
+
+  if (explainCall)
   {
     if (candidates.n == 0) {
       USR_PRINT(info.call, "no candidates found");
@@ -3173,14 +3370,15 @@ void resolveNormalCall(CallExpr* call) {
     }
   }
 
-  Expr* scope = (info.scope) ? info.scope : getVisibilityBlock(call);
-  bool explain = fExplainVerbose &&
-    ((explainCallLine && explainCallMatch(call)) ||
-     info.call->id == explainCallID);
+  bool explain = fExplainVerbose && explainCall;
   DisambiguationContext DC(&info.actuals, scope, explain);
 
   ResolutionCandidate* best = disambiguateByMatch(candidates, DC);
 
+  if (useCache && best && best->fn && !cachedFn) {
+    getVisibleNameCache(info.name)->bestFns[sig] = best->fn;
+  }
+
   if (best && best->fn) {
     /*
      * Finish instantiating the body.  This is a noop if the function wasn't
@@ -6712,6 +6910,14 @@ resolve() {
   visibleFunctionMap.clear();
   visibilityBlockCache.clear();
 
+  Vec<VisibleNameCache*> vncs;
+  visibleNameCacheMap.get_values(vncs);
+  forv_Vec(VisibleNameCache, vnc, vncs) {
+    vnc->clear();
+    delete vnc;
+  }
+  visibleNameCacheMap.clear();
+
   forv_Vec(BlockStmt, stmt, gBlockStmts) {
     stmt->moduleUseClear();
   }
@@ -6814,6 +7020,13 @@ static void resolveEnumTypes() {
   }
 }
 
+static int compareFnIds(const void* v1, const void* v2) {
+  FnSymbol* fn1 = *(FnSymbol* const*) v1;
+  FnSymbol* fn2 = *(FnSymbol* const*) v2;
+
+  return (fn1->id > fn2->id) - (fn1->id < fn2->id);
+}
+
 static void resolveDynamicDispatches() {
   inDynamicDispatchResolution = true;
   int num_types;
@@ -6838,12 +7051,23 @@ static void resolveDynamicDispatches() {
     buildVirtualMaps();
   } while (num_types != gTypeSymbols.n);
 
-  for (int i = 0; i < virtualRootsMap.n; i++) {
-    if (virtualRootsMap.v[i].key) {
-      for (int j = 0; j < virtualRootsMap.v[i].value->n; j++) {
-        FnSymbol* root = virtualRootsMap.v[i].value->v[j];
-        addVirtualMethodTableEntry(root->_this->type, root, true);
-      }
+  //
+  // Visit the roots in id order rather than in the map's, which follows
+  // their addresses, so that the slots a type's methods get don't change
+  // from one compilation to the next.
+  //
+  Vec<FnSymbol*> virtualFns;
+
+  virtualRootsMap.get_keys(virtualFns);
+
+  qsort(virtualFns.v, virtualFns.n, sizeof(virtualFns.v[0]), compareFnIds);
+
+  forv_Vec(FnSymbol, fn, virtualFns) {
+    Vec<FnSymbol*>* roots = virtualRootsMap.get(fn);
+
+    for (int j = 0; j < roots->n; j++) {
+      FnSymbol* root = roots->v[j];
+      addVirtualMethodTableEntry(root->_this->type, root, true);
     }
   }
 
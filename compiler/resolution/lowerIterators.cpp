@@ -1196,6 +1196,45 @@ expandIteratorInline(ForLoop* forLoop) {
   }
 }
 
+//
+// The loop in an inlined iterator that encloses a yield runs once per
+// iteration of the loop that invoked the iterator.  The body of the
+// invoking loop is order independent, but the rest of the iterator's
+// loop may not be: a user's iterator can carry a dependence from one
+// iteration to the next, e.g. buf[i] = buf[i-k] + i.  So the loop is
+// only marked when the iterator comes from an internal module, whose
+// iterators do nothing between yields but step through their indices.
+//
+static bool
+canMarkYieldLoops(ForLoop* forLoop) {
+  bool retval = false;
+
+  if (forLoop->isOrderIndependent() == true) {
+    Symbol*   ic       = forLoop->iteratorGet()->var;
+    FnSymbol* iterator = ic->type->defaultInitializer->getFormal(1)->type->defaultInitializer;
+
+    retval = iterator->getModule()->modTag == MOD_INTERNAL;
+  }
+
+  return retval;
+}
+
+//
+// Mark the loop that encloses a yield, if there is one inside the
+// inlined iterator body 'ibody'.
+//
+static void
+markYieldLoopOrderIndependent(CallExpr* yield, BlockStmt* ibody) {
+  for (Expr* expr = yield->parentExpr;
+       expr != NULL && expr != ibody;
+       expr = expr->parentExpr) {
+    if (LoopStmt* loop = toLoopStmt(expr)) {
+      loop->orderIndependentSet(true);
+      break;
+    }
+  }
+}
+
 static void
 expandBodyForIteratorInline(ForLoop*       forLoop,
                             BlockStmt*     ibody,
@@ -1212,6 +1251,7 @@ expandBodyForIteratorInline(ForLoop*       forLoop,
                             bool           removeReturn,
                             TaskFnCopyMap& taskFnCopies) {
   Vec<BaseAST*> asts;
+  bool          markYieldLoops = canMarkYieldLoops(forLoop);
 
   collect_asts(ibody, asts);
 
@@ -1252,6 +1292,9 @@ expandBodyForIteratorInline(ForLoop*       forLoop,
           }
         }
 
+        if (markYieldLoops == true)
+          markYieldLoopOrderIndependent(call, ibody);
+
         call->replace(bodyCopy);
 
         if (inserted == false) {
@@ -1748,6 +1791,11 @@ expandForLoop(ForLoop* forLoop) {
     // scope to another if done in mid-transformation.
     CForLoop* cforLoop = CForLoop::buildWithBodyFrom(forLoop);
 
+    // The iterator's own code now runs in the advance calls between
+    // iterations, where it may carry a dependence from one to the next,
+    // so the loop as a whole is no longer order independent.
+    cforLoop->orderIndependentSet(false);
+
     cforLoop->loopHeaderSet(initBlock, testBlock, incrBlock);
 
     forLoop->replace(cforLoop);
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2004-2014 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compilerThreads.h"
+
+#include "baseAST.h"
+#include "driver.h"
+#include "misc.h"
+
+#include <pthread.h>
+
+#include <vector>
+
+// The compiler recurses deeply over large functions, so give the
+// helper threads more stack than the pthreads default.
+static const size_t compilerThreadStackSize = 64 * 1024 * 1024;
+
+bool            compilerThreadsActive = false;
+pthread_mutex_t compilerThreadsMutex  = PTHREAD_MUTEX_INITIALIZER;
+
+
+#ifdef HAVE_COMPILER_THREADS
+struct ParallelLoop {
+  int     n;
+  int     next;
+  void  (*body)(int i, void* arg);
+  void*   arg;
+  astlocT astloc;
+};
+
+static void* runParallelLoop(void* arg) {
+  ParallelLoop* loop = (ParallelLoop*)arg;
+
+  // Start out where the thread that called parallelFor is.
+  currentAstLoc = loop->astloc;
+
+  for (int i = __sync_fetch_and_add(&loop->next, 1);
+       i < loop->n;
+       i = __sync_fetch_and_add(&loop->next, 1)) {
+    startAstTask(i);
+    loop->body(i, loop->arg);
+  }
+
+  startAstTask(-1);
+
+  return NULL;
+}
+#endif
+
+void parallelFor(int n, void (*body)(int i, void* arg), void* arg) {
+#ifdef HAVE_COMPILER_THREADS
+  int numThreads = (fCompilerThreads < n) ? fCompilerThreads : n;
+#else
+  int numThreads = 1;
+#endif
+
+  if (numThreads <= 1 || compilerThreadsActive) {
+    for (int i = 0; i < n; i++)
+      body(i, arg);
+
+    return;
+  }
+
+#ifdef HAVE_COMPILER_THREADS
+  ParallelLoop           loop = { n, 0, body, arg, currentAstLoc };
+  std::vector<pthread_t> threads(numThreads - 1);
+  pthread_attr_t         attr;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, compilerThreadStackSize);
+
+  startAstThreads(n);
+  compilerThreadsActive = true;
+
+  for (size_t t = 0; t < threads.size(); t++) {
+    if (pthread_create(&threads[t], &attr, runParallelLoop, &loop) != 0)
+      INT_FATAL("unable to create compiler thread");
+  }
+
+  runParallelLoop(&loop);
+
+  for (size_t t = 0; t < threads.size(); t++)
+    pthread_join(threads[t], NULL);
+
+  compilerThreadsActive = false;
+  finishAstThreads();
+
+  pthread_attr_destroy(&attr);
+#endif
+}
+
+
+struct FunctionLoop {
+  Vec<FnSymbol*>* fns;
+  void          (*body)(FnSymbol* fn);
+};
+
+static void callFunctionBody(int i, void* arg) {
+  FunctionLoop* loop = (FunctionLoop*)arg;
+
+  loop->body(loop->fns->v[i]);
+}
+
+void forEachFunction(Vec<FnSymbol*>& fns, void (*body)(FnSymbol* fn)) {
+  FunctionLoop loop = { &fns, body };
+
+  parallelFor(fns.n, callFunctionBody, &loop);
+}
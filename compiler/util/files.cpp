@@ -462,6 +462,34 @@ static void genObjFiles(FILE* makefile) {
 }
 
 
+//
+// The generated code may be split into several translation units in
+// addition to _main.c (see --codegen-jobs); each gets its own object
+// so that they can be compiled in parallel.
+//
+static void genUnitObjFiles(FILE* makefile,
+                            const std::vector<const char*>& unitFilenames) {
+  if (unitFilenames.size() == 0)
+    return;
+  fprintf(makefile, "CHPL_GEN_OBJS = \\\n");
+  for (size_t i = 0; i < unitFilenames.size(); i++) {
+    fprintf(makefile, "\t%s.o \\\n", unitFilenames[i]);
+  }
+  fprintf(makefile, "\n");
+}
+
+static void genUnitBuildRules(FILE* makefile,
+                              const std::vector<const char*>& unitFilenames) {
+  for (size_t i = 0; i < unitFilenames.size(); i++) {
+    fprintf(makefile, "%s.o: %s FORCE\n", unitFilenames[i], unitFilenames[i]);
+    fprintf(makefile,
+            "\t$(CC) $(GEN_CFLAGS) $(COMP_GEN_CFLAGS) -c -o $@ "
+            "$(CHPL_RT_INC_DIR) $<\n");
+    fprintf(makefile, "\n");
+  }
+}
+
+
 void genIncludeCommandLineHeaders(FILE* outfile) {
   int filenum = 0;
   while (const char* inputFilename = nthFilename(filenum++)) {
@@ -472,7 +500,8 @@ void genIncludeCommandLineHeaders(FILE* outfile) {
 }
 
 
-void codegen_makefile(fileinfo* mainfile, const char** tmpbinname, bool skip_compile_link) {
+void codegen_makefile(fileinfo* mainfile, const char** tmpbinname, bool skip_compile_link,
+                      const std::vector<const char*>& unitFilenames) {
   fileinfo makefile;
   openCFile(&makefile, "Makefile");
   const char* tmpDirName = intDirName;
@@ -561,6 +590,7 @@ void codegen_makefile(fileinfo* mainfile, const char** tmpbinname, bool skip_com
 
   fprintf(makefile.fptr, "CHPLSRC = \\\n");
   fprintf(makefile.fptr, "\t%s \\\n\n", mainfile->pathname);
+  genUnitObjFiles(makefile.fptr, unitFilenames);
   genCFiles(makefile.fptr);
   genObjFiles(makefile.fptr);
   fprintf(makefile.fptr, "\nLIBS =");
@@ -591,6 +621,7 @@ void codegen_makefile(fileinfo* mainfile, const char** tmpbinname, bool skip_com
               "include $(CHPL_MAKE_HOME)/runtime/etc/Makefile.static\n");
   }
   fprintf(makefile.fptr, "\n");
+  genUnitBuildRules(makefile.fptr, unitFilenames);
   genCFileBuildRules(makefile.fptr);
   closeCFile(&makefile, false);
 }
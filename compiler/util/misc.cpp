@@ -56,6 +56,7 @@ static int err_fatal;
 static int err_user;
 static int err_print;
 static int err_ignore;
+static int err_count = 0; // user errors, warnings and messages so far
 static FnSymbol* err_fn = NULL;
 
 bool forceWidePtrs() {
@@ -157,6 +158,13 @@ setupError(const char *filename, int lineno, int tag) {
   err_ignore = ignore_warnings && tag == 4;
   exit_immediately = tag == 1 || tag == 2;
   exit_eventually |= tag == 3;
+  if (err_user)
+    err_count++;
+}
+
+
+int numUserDiagnostics(void) {
+  return err_count;
 }
 
 
@@ -23,6 +23,7 @@
 
 #include "stringutil.h"
 
+#include "compilerThreads.h"
 #include "misc.h"
 
 #include <inttypes.h>
@@ -31,11 +32,13 @@ static ChainHashMap<const char*, StringHashFns, const char*> chapelStringsTable;
 
 static const char*
 canonicalize_string(const char *s) {
+  lockCompilerThreads();
   const char* ss = chapelStringsTable.get(s);
   if (!ss) {
     chapelStringsTable.put(s, s);
-    return s;
+    ss = s;
   }
+  unlockCompilerThreads();
   return ss;
 }
 
@@ -822,6 +822,12 @@ module ChapelBase {
   // fork (on) if needed.
   pragma "dont disable remote value forwarding"
   proc _downEndCount(e: _EndCount) {
+    // Make sure PUTs the comm layer is still holding on to are done
+    // before the waiting task can see this one finish.  With
+    // --cache-remote the compiler puts a release fence at the start of
+    // sub() below, which does this, but otherwise the sub is a plain
+    // atomic operation and is often local, so nothing else would.
+    if !CHPL_CACHE_REMOTE then chpl_rmem_consist_release();
     e.i.sub(1, memory_order_release);
   }
   
@@ -849,6 +855,19 @@ module ChapelBase {
     __primitive("free task list", e.taskList);
   }
   
+  // These are called by the initiating task before and after a coforall
+  // loop whose body is only an on statement, so that the comm layer can
+  // send the remote tasks together instead of one at a time.
+  inline proc _startForkBatch() {
+    extern proc chpl_comm_fork_nb_batch_start();
+    chpl_comm_fork_nb_batch_start();
+  }
+  
+  inline proc _finishForkBatch() {
+    extern proc chpl_comm_fork_nb_batch_finish();
+    chpl_comm_fork_nb_batch_finish();
+  }
+  
   proc _upEndCount() {
     var e = __primitive("get end count");
     _upEndCount(e);
@@ -284,6 +284,9 @@ module ChapelLocale {
         var f = new localesSignal();
         // expose my flag to locale 0
         flags[locIdx] = f;
+        // Locale 0 only ever reads the flags locally, so make sure
+        // this write is not left sitting in an aggregation buffer.
+        chpl_rmem_consist_release();
         // wait (locally) for locale 0 to set my flag
         f.s.waitFor(true);
         // clean up
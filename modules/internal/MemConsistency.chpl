@@ -31,7 +31,8 @@ module MemConsistency {
   extern const memory_order_seq_cst:memory_order;
 
   // These functions are memory consistency fences (ie acquire or
-  // release fences) for the remote data cache.
+  // release fences) for the remote data cache and for the comm layer's
+  // PUT aggregation.
   pragma "insert line file info"
   extern proc chpl_rmem_consist_release();
   pragma "insert line file info"
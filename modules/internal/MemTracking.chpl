@@ -29,7 +29,9 @@ module MemTracking
     memLeaksTable: bool = false,
     memMax: size_t = 0,
     memThreshold: size_t = 0,
-    memLog: c_string = "";
+    memLog: c_string = "",
+    memProfile: bool = false,
+    memProfileRate: size_t = 524288;
 
   pragma "no auto destroy"
   config const
@@ -60,13 +62,17 @@ module MemTracking
                                          ref ret_memMax: size_t,
                                          ref ret_memThreshold: size_t,
                                          ref ret_memLog: c_string,
-                                         ref ret_memLeaksLog: c_string) {
+                                         ref ret_memLeaksLog: c_string,
+                                         ref ret_memProfile: bool,
+                                         ref ret_memProfileRate: size_t) {
     ret_memTrack = memTrack;
     ret_memStats = memStats;
     ret_memLeaks = memLeaks;
     ret_memLeaksTable = memLeaksTable;
     ret_memMax = memMax;
     ret_memThreshold = memThreshold;
+    ret_memProfile = memProfile;
+    ret_memProfileRate = memProfileRate;
 
     if (here.id != 0) {
       // These c_strings are going to be leaked
@@ -173,7 +173,8 @@ module LocaleModel {
       var comm, spawnfn : c_string;
       extern proc chpl_nodeName() : c_string;
       // sys_getenv returns zero on success.
-      if sys_getenv("CHPL_COMM".c_str(), comm) == 0 && comm == "gasnet" &&
+      if CHPL_COMM == "shm" ||
+        sys_getenv("CHPL_COMM".c_str(), comm) == 0 && comm == "gasnet" &&
         sys_getenv("GASNET_SPAWNFN".c_str(), spawnfn) == 0 && spawnfn == "L"
       then local_name = toString(chpl_nodeName()) + "-" + _node_id : string;
       else local_name = toString(chpl_nodeName());
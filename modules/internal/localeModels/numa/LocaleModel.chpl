@@ -225,7 +225,8 @@ module LocaleModel {
       var comm, spawnfn : c_string;
       extern proc chpl_nodeName() : c_string;
       // sys_getenv returns zero on success.
-      if sys_getenv("CHPL_COMM".c_str(), comm) == 0 && comm == "gasnet" &&
+      if CHPL_COMM == "shm" ||
+        sys_getenv("CHPL_COMM".c_str(), comm) == 0 && comm == "gasnet" &&
         sys_getenv("GASNET_SPAWNFN".c_str(), spawnfn) == 0 && spawnfn == "L"
       then local_name = toString(chpl_nodeName()) + "-" + _node_id : string;
       else local_name = toString(chpl_nodeName());
@@ -239,9 +240,9 @@ module LocaleModel {
       extern proc chpl_task_getNumSublocales(): int(32);
       numSublocales = chpl_task_getNumSublocales();
 
+      // The data-parallel leaders divide this among the sublocales.
       extern proc chpl_task_getMaxPar(): uint(32);
-      maxTaskPar = if numSublocales==0 then chpl_task_getMaxPar()
-                                       else numSublocales;
+      maxTaskPar = chpl_task_getMaxPar();
 
       if numSublocales >= 1 {
         childSpace = {0..#numSublocales};
@@ -121,5 +121,49 @@ module CommDiagnostics
     cd.get_nb_wait = chpl_numCommWaitNBGets();
     return cd;
   }
+
+  //
+  // communication profile: counts and bytes for each call site that
+  // does remote gets, puts, or forks, and for each destination locale
+  //
+  extern proc chpl_startCommProfileHere();
+  extern proc chpl_stopCommProfileHere();
+  extern proc chpl_resetCommProfileHere();
+  extern proc chpl_printCommProfileHere();
+
+  // The other locales are started before this one and stopped after
+  // it, so the forks doing that aren't in the profile.
+  proc startCommProfile() {
+    for loc in Locales do
+      if loc.id != here.id then
+        on loc do startCommProfileHere();
+    startCommProfileHere();
+  }
+  proc stopCommProfile() {
+    stopCommProfileHere();
+    for loc in Locales do
+      if loc.id != here.id then
+        on loc do stopCommProfileHere();
+  }
+  proc startCommProfileHere() { chpl_startCommProfileHere(); }
+  proc stopCommProfileHere() { chpl_stopCommProfileHere(); }
+
+  proc resetCommProfile() {
+    for loc in Locales do on loc do
+      resetCommProfileHere();
+  }
+
+  inline proc resetCommProfileHere() {
+    chpl_resetCommProfileHere();
+  }
+
+  proc printCommProfile() {
+    for loc in Locales do on loc do
+      printCommProfileHere();
+  }
+
+  proc printCommProfileHere() {
+    chpl_printCommProfileHere();
+  }
   
 }
@@ -137,6 +137,7 @@ extern const QIO_METHOD_READWRITE:c_int;
 extern const QIO_METHOD_PREADPWRITE:c_int;
 extern const QIO_METHOD_FREADFWRITE:c_int;
 extern const QIO_METHOD_MMAP:c_int;
+extern const QIO_METHOD_ASYNC:c_int;
 extern const QIO_METHODMASK:c_int;
 extern const QIO_HINT_RANDOM:c_int;
 extern const QIO_HINT_SEQUENTIAL:c_int;
@@ -174,6 +175,19 @@ const IOHINT_CACHED = QIO_HINT_CACHED;
  */
 const IOHINT_PARALLEL = QIO_HINT_PARALLEL;
 
+/** ASYNC means that reads and writes should be submitted
+    to the kernel asynchronously (with io_uring where the
+    kernel supports it, or a pool of I/O threads otherwise)
+    so that large transfers are split into batched requests
+    that are all in flight at once.  The calling task yields
+    briefly while it waits and then waits the way it would
+    for a sync variable: with CHPL_RT_LIGHTWEIGHT_TASKS its
+    thread runs other tasks meanwhile, and otherwise the
+    thread blocks.  Files that are not seekable use
+    read/write instead.
+ */
+const IOHINT_ASYNC = QIO_METHOD_ASYNC;
+
 extern type qio_file_ptr_t;
 extern const QIO_FILE_PTR_NULL:qio_file_ptr_t;
 
@@ -310,6 +324,8 @@ extern proc qio_channel_read_amt(threadsafe:c_int, ch:qio_channel_ptr_t, ref ptr
 // A specialization is needed for _ddata as the value is the pointer its memory
 extern proc qio_channel_read_amt(threadsafe:c_int, ch:qio_channel_ptr_t, ptr:_ddata, len:ssize_t):syserr;
 extern proc qio_channel_read_byte(threadsafe:c_int, ch:qio_channel_ptr_t):int(32);
+// bytes_out is always c_nil here; the channel keeps each view alive.
+extern proc qio_channel_read_view(threadsafe:c_int, ch:qio_channel_ptr_t, maxlen:int(64), bytes_out:c_void_ptr, ref ptr_out:c_void_ptr, ref len_out:int(64)):syserr;
 
 extern proc qio_channel_write(threadsafe:c_int, ch:qio_channel_ptr_t, const ref ptr, len:ssize_t, ref amt_written:ssize_t):syserr;
 extern proc qio_channel_write_amt(threadsafe:c_int, ch:qio_channel_ptr_t, const ref ptr, len:ssize_t):syserr;
@@ -514,6 +530,7 @@ extern type fdflag_t = c_int;
   QIO_METHOD_READWRITE,
   QIO_METHOD_P_READWRITE,
   QIO_METHOD_MMAP,
+  QIO_METHOD_ASYNC,
   QIO_HINT_RANDOM,
   QIO_HINT_SEQUENTIAL,
   QIO_HINT_LATENCY,
@@ -2001,6 +2018,57 @@ proc channel.itemReader(type ItemType, param kind:iokind=iokind.dynamic) {
   return new ItemReader(ItemType, kind, locking, this);
 }
 
+/* A read-only view of bytes in a channel, as yielded by channel.views().
+   The view covers channel offsets offset..#len; v[i] is the byte
+   at offset+i, and iterating over a view yields each byte.
+ */
+record ioview {
+  var offset:int(64);
+  var len:int(64);
+  var ptr:c_ptr(uint(8));
+}
+
+inline proc ioview.this(i:integral):uint(8) {
+  return ptr[i];
+}
+
+iter ioview.these():uint(8) {
+  for i in 0..#len do yield ptr[i];
+}
+
+/* Read the rest of the channel without copying it. Each ioview points
+   directly at the channel's buffer -- for a file read with the mmap
+   method (the default for most read-only files) that is the file
+   mapping itself -- so the data is not copied into a user buffer.
+   A view is only valid until the next iteration and must not be
+   written to. maxlen limits the size of each view; views can also be
+   shorter because they never span two buffer chunks, and it must be
+   positive.
+   Since views are local pointers, the channel must be on this locale.
+ */
+iter channel.views(maxlen:int(64) = max(int(64))):ioview {
+  if writing then compilerError(".views on write-only channel");
+  if this.home != here then
+    this._ch_ioerror("channel is not local", "in channel.views");
+
+  var error:syserr = ENOERR;
+  while true {
+    var view:ioview;
+    var ptr:c_void_ptr;
+    this.lock();
+    view.offset = qio_channel_offset_unlocked(_channel_internal);
+    error = qio_channel_read_view(false, _channel_internal, maxlen,
+                                  c_nil, ptr, view.len);
+    this.unlock();
+    if error then break;
+    view.ptr = ptr:c_ptr(uint(8));
+    yield view;
+  }
+  // Reaching the end of the channel is not an error.
+  if error == EEOF then error = ENOERR;
+  if error then this._ch_ioerror(error, "in channel.views");
+}
+
 record ItemWriter {
   type ItemType;
   param kind:iokind;
@@ -62,6 +62,13 @@ proc printMemStat() {
   chpl_printMemStat();
 }
 
+proc printMemProfile() {
+  pragma "insert line file info"
+  extern proc chpl_printMemProfile();
+
+  chpl_printMemProfile();
+}
+
 proc startVerboseMem() { 
   extern proc chpl_startVerboseMem();
   chpl_startVerboseMem();
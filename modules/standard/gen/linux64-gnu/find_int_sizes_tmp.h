@@ -0,0 +1,19 @@
+#include "sys_basic.h"
+#include <limits.h>
+#include <stdint.h>
+#include <math.h>
+
+FIND_INT_SIZES_START
+INT_MAX
+UINT_MAX
+LONG_MAX
+ULONG_MAX
+LLONG_MAX
+ULLONG_MAX
+CHAR_MAX
+SCHAR_MAX
+UCHAR_MAX
+SHRT_MAX
+USHRT_MAX
+SSIZE_MAX
+SIZE_MAX
@@ -23,6 +23,7 @@
 // This is the type of the task private data used by the cache
 typedef struct {
   int64_t last_acquire; // cache acquire barrier sets this
+  int64_t last_shared_acquire; // ... and this, if the shared tier is enabled
 } chpl_cache_taskPrvData_t;
 
 #endif
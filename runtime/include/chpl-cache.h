@@ -81,10 +81,35 @@ void  chpl_cache_comm_put_strd(
                       void *srcstr, void *count, int32_t strlevels,
                       int32_t elemSize, int32_t typeIndex,
                       int ln, c_string fn);
+// Indexed gather/scatter: element i of the local buffer addr is
+// copied from/to raddrs[i] on node.
+void chpl_cache_comm_get_idx(void* addr, c_nodeid_t node, void** raddrs,
+                             int32_t elemSize, int32_t typeIndex, int32_t len,
+                             int ln, c_string fn);
+void chpl_cache_comm_put_idx(void* addr, c_nodeid_t node, void** raddrs,
+                             int32_t elemSize, int32_t typeIndex, int32_t len,
+                             int ln, c_string fn);
 
 // For debugging.
 void chpl_cache_print(void);
 
+// Counts of cache activity on this locale, summed over all of the
+// per-pthread caches. Hits and misses are counted per cache page.
+typedef struct {
+  uint64_t get_hits;      // GETs satisfied by a pthread's own cache
+  uint64_t get_misses;    // GETs that were not
+  uint64_t shared_hits;   // misses satisfied by the shared read-only tier
+  uint64_t shared_misses; // misses that the shared tier could not satisfy
+  uint64_t ghost_hits;    // misses on pages the policy had recently evicted
+  uint64_t evictions;     // pages evicted from a pthread's cache
+  uint64_t remote_gets;   // GETs issued by the cache (including prefetches)
+  uint64_t remote_puts;   // PUTs issued by the cache
+} chpl_cache_stats_t;
+
+void chpl_cache_get_stats(chpl_cache_stats_t* stats);
+void chpl_cache_reset_stats(void);
+void chpl_cache_print_stats(void);
+
 #endif
 // ifdef HAS_CHPL_CACHE_FNS
 
@@ -149,6 +149,58 @@ void chpl_gen_comm_put_strd(void *addr, void *dststr, c_nodeid_t node, void *rad
   }
 }
 
+// Indexed gather: element i of addr is read from raddrs[i] on node.
+static ___always_inline
+void chpl_gen_comm_get_idx(void* addr, c_nodeid_t node, void** raddrs,
+                           int32_t elemSize, int32_t typeIndex, int32_t len,
+                           int ln, c_string fn)
+{
+  int32_t i;
+
+  if (chpl_nodeID == node) {
+    for (i = 0; i < len; i++)
+      chpl_memcpy((unsigned char*)addr + i*elemSize, raddrs[i], elemSize);
+#ifdef HAS_CHPL_CACHE_FNS
+  } else if( chpl_cache_enabled() ) {
+    chpl_cache_comm_get_idx(addr, node, raddrs, elemSize, typeIndex, len, ln, fn);
+#endif
+  } else {
+    for (i = 0; i < len; i++) {
+#ifdef CHPL_TASK_COMM_GET
+      chpl_task_comm_get((unsigned char*)addr + i*elemSize, node, raddrs[i], elemSize, typeIndex, 1, ln, fn);
+#else
+      chpl_comm_get((unsigned char*)addr + i*elemSize, node, raddrs[i], elemSize, typeIndex, 1, ln, fn);
+#endif
+    }
+  }
+}
+
+// Indexed scatter: element i of addr is written to raddrs[i] on node.
+static ___always_inline
+void chpl_gen_comm_put_idx(void* addr, c_nodeid_t node, void** raddrs,
+                           int32_t elemSize, int32_t typeIndex, int32_t len,
+                           int ln, c_string fn)
+{
+  int32_t i;
+
+  if (chpl_nodeID == node) {
+    for (i = 0; i < len; i++)
+      chpl_memcpy(raddrs[i], (unsigned char*)addr + i*elemSize, elemSize);
+#ifdef HAS_CHPL_CACHE_FNS
+  } else if( chpl_cache_enabled() ) {
+    chpl_cache_comm_put_idx(addr, node, raddrs, elemSize, typeIndex, len, ln, fn);
+#endif
+  } else {
+    for (i = 0; i < len; i++) {
+#ifdef CHPL_TASK_COMM_PUT
+      chpl_task_comm_put((unsigned char*)addr + i*elemSize, node, raddrs[i], elemSize, typeIndex, 1, ln, fn);
+#else
+      chpl_comm_put((unsigned char*)addr + i*elemSize, node, raddrs[i], elemSize, typeIndex, 1, ln, fn);
+#endif
+    }
+  }
+}
+
 // Returns true if the given node ID matches the ID of the currently node,
 // false otherwise.
 static ___always_inline
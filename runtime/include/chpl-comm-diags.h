@@ -0,0 +1,106 @@
+/*
+ * Copyright 2004-2014 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_comm_diags_h_
+#define _chpl_comm_diags_h_
+
+#ifndef LAUNCHER
+
+#include "chpltypes.h"
+#include "chpl-comm.h"
+
+#include <stdio.h>
+
+//
+// Support shared by the comm layers for communication diagnostics
+// (the counts returned by getCommDiagnostics()) and for the per call
+// site communication profile.
+//
+// Both are kept per pthread, so that counting an operation does not
+// serialize it with the operations other pthreads are doing.  The
+// counters are summed when they are read.  Resetting the counters
+// records a baseline that later reads subtract, since only the owning
+// pthread ever writes its counters.
+//
+
+chpl_commDiagnostics* chpl_comm_diags_thread_counters(void);
+
+#define chpl_comm_diags_incr(_ctr) \
+  (chpl_comm_diags_thread_counters()->_ctr++)
+
+void chpl_comm_diags_reset(void);
+void chpl_comm_diags_copy(chpl_commDiagnostics* cd);
+
+//
+// The profile counts operations and bytes for each (operation, file,
+// line) and destination locale.  Forks don't get a source location
+// from the generated code, so they are all reported at line 0 of an
+// unknown file.
+//
+typedef enum {
+  CHPL_COMM_PROFILE_GET,
+  CHPL_COMM_PROFILE_GET_NB,
+  CHPL_COMM_PROFILE_GET_STRD,
+  CHPL_COMM_PROFILE_PUT,
+  CHPL_COMM_PROFILE_PUT_NB,
+  CHPL_COMM_PROFILE_PUT_STRD,
+  CHPL_COMM_PROFILE_FORK,
+  CHPL_COMM_PROFILE_FORK_FAST,
+  CHPL_COMM_PROFILE_FORK_NB,
+  CHPL_COMM_PROFILE_NUM_OPS
+} chpl_comm_profile_op_t;
+
+extern int chpl_comm_profile;     // set via startCommProfile
+
+void chpl_comm_profile_record(chpl_comm_profile_op_t op, c_nodeid_t node,
+                              size_t bytes, int ln, c_string fn);
+
+// The number of bytes moved by a strided GET or PUT.
+static inline
+size_t chpl_comm_profile_strd_bytes(void* count, int32_t stridelevels,
+                                    int32_t elemSize) {
+  size_t bytes = elemSize;
+  int    i;
+
+  for (i = 0; i <= stridelevels; i++)
+    bytes *= ((int32_t*) count)[i];
+  return bytes;
+}
+
+void chpl_startCommProfileHere(void);
+void chpl_stopCommProfileHere(void);
+void chpl_resetCommProfileHere(void);
+void chpl_printCommProfileHere(void);
+
+// Writes the profile as CSV, one line per call site and destination.
+void chpl_comm_profile_write_csv(FILE* f);
+
+// CHPL_RT_COMM_PROFILE=<file> turns the profile on at startup and
+// writes it to <file> (<file>.<locale> with several locales) at exit.
+void chpl_comm_diags_init(void);
+void chpl_comm_diags_exit(void);
+
+#else // LAUNCHER
+
+#define chpl_comm_diags_init()
+#define chpl_comm_diags_exit()
+
+#endif // LAUNCHER
+
+#endif
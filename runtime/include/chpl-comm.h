@@ -112,6 +112,16 @@ void chpl_comm_nb_wait_some(chpl_comm_nb_handle_t* h, size_t nhandles);
 // the communicable memory region is totally unknown).
 int chpl_comm_is_in_segment(c_nodeid_t node, void* start, size_t len);
 
+#ifdef HAS_CHPL_COMM_AGGREGATE_FNS
+// Set at startup if CHPL_RT_COMM_AGGREGATE asked the comm layer to
+// collect small PUTs into per-destination buffers.  The buffered PUTs
+// are only guaranteed to be visible on the remote locale after
+// chpl_comm_aggregate_flush() returns, so this is called from the
+// release fence (chpl_rmem_consist_release).
+extern int chpl_comm_aggregate;
+void chpl_comm_aggregate_flush(void);
+#endif
+
 //
 // returns the maximum number of threads that can be handled
 // by this communication layer (used to ensure numThreadsPerLocale is
@@ -321,6 +331,18 @@ void chpl_comm_fork(c_nodeid_t node, c_sublocid_t subloc,
 void chpl_comm_fork_nb(c_nodeid_t node, c_sublocid_t subloc,
                        chpl_fn_int_t fid, void *arg, int32_t arg_size);
 
+//
+// batched non-blocking forks
+//   Between these calls, the comm layer may hold back the calling
+//   task's non-blocking forks to other locales and send them together
+//   when the batch finishes, for example down a tree of locales.  The
+//   compiler uses them around a coforall loop whose body is just an
+//   on-statement, so nothing in the loop waits for the forked tasks.
+//   Batches may be nested; only the outermost finish sends them.
+//
+void chpl_comm_fork_nb_batch_start(void);
+void chpl_comm_fork_nb_batch_finish(void);
+
 //
 // fast (non-forking) fork (i.e., run in handler)
 //
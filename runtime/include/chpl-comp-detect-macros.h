@@ -41,4 +41,25 @@
 #define RT_COMP_CC RT_COMP_UNKNOWN
 #endif
 
+//
+// CHPL_PRAGMA_IVDEP tells the compiler that the iterations of the loop
+// that follows do not depend on each other, so that it may vectorize
+// the loop without proving that itself.  The compiler emits it before
+// order-independent loops when --vectorize is in effect.
+//
+#if RT_COMP_CC == RT_COMP_CRAY
+#define CHPL_PRAGMA_IVDEP _Pragma("_CRI ivdep")
+#elif RT_COMP_CC == RT_COMP_INTEL
+#define CHPL_PRAGMA_IVDEP _Pragma("ivdep")
+#elif RT_COMP_CC == RT_COMP_CLANG && \
+      (defined(__apple_build_version__) ? (__clang_major__ >= 7) : \
+       (__clang_major__ > 3 || (__clang_major__ == 3 && __clang_minor__ >= 7)))
+#define CHPL_PRAGMA_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif RT_COMP_CC == RT_COMP_GCC && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define CHPL_PRAGMA_IVDEP _Pragma("GCC ivdep")
+#else
+#define CHPL_PRAGMA_IVDEP
+#endif
+
 #endif // _chpl_rt_comp_detect_h_
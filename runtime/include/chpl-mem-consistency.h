@@ -25,8 +25,8 @@
 #include "chpl-cache.h" // for chpl_cache_release, chpl_cache_acquire
 
 // These functions support memory consistency with the remote
-// data cache. They do not need to do anything if the cache is
-// not enabled.
+// data cache and with PUT aggregation in the comm layer. They do
+// not need to do anything if neither is enabled.
 
 // When do these fences need to be called?
 
@@ -63,6 +63,10 @@ void chpl_rmem_consist_release(int ln, c_string fn)
 #ifdef HAS_CHPL_CACHE_FNS
   chpl_cache_release(ln, fn);
 #endif
+#ifdef HAS_CHPL_COMM_AGGREGATE_FNS
+  if (chpl_comm_aggregate)
+    chpl_comm_aggregate_flush();
+#endif
 }
 
 static ___always_inline
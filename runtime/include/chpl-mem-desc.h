@@ -80,12 +80,20 @@
           "comm layer received non-blocking remote fork large fncall arg "),\
         m(COMM_FORK_DONE_FLAG,                                          \
           "comm layer remote fork done flag(s)"),                       \
+        m(COMM_FORK_BATCH_BUFFER,                                       \
+          "comm layer batched non-blocking remote fork buffer"),        \
+        m(COMM_FORK_TREE_INFO,                                          \
+          "comm layer received tree of non-blocking remote forks"),     \
         m(COMM_PER_LOCALE_INFO,                                         \
           "comm layer per-locale information"),                         \
         m(COMM_PRIVATE_OBJECTS_ARRAY,                                   \
           "comm layer private objects array"),                          \
         m(COMM_PRIVATE_BROADCAST_DATA,                                  \
           "comm layer private broadcast data"),                         \
+        m(COMM_PUT_AGGREGATION_BUFFER,                                  \
+          "comm layer PUT aggregation buffer"),                         \
+        m(COMM_DIAGNOSTICS_DATA,                                        \
+          "comm layer diagnostics data"),                               \
         m(GLOM_STRINGS_DATA,                                            \
           "glom strings data"),                                         \
         m(STRING_COPY_DATA,                                             \
@@ -118,10 +126,16 @@
           "task pool descriptor"),                                      \
         m(TASK_LIST_DESCRIPTOR,                                         \
           "task list descriptor"),                                      \
+        m(TASK_DEQUE,                                                   \
+          "task deque"),                                                \
+        m(TASK_CONTEXT,                                                 \
+          "lightweight task context"),                                  \
         m(THREAD_PRIVATE_DATA,                                          \
           "thread private data"),                                       \
         m(THREAD_LIST_DESCRIPTOR,                                       \
           "thread list descriptor"),                                    \
+        m(TOPOLOGY_DATA,                                                \
+          "node topology data"),                                        \
         m(IO_BUFFER,                                                    \
           "io buffer or bytes"),                                        \
         m(GMP,                                                          \
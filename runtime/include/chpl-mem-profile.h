@@ -0,0 +1,60 @@
+/*
+ * Copyright 2004-2014 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_mem_profile_H_
+#define _chpl_mem_profile_H_
+
+#ifndef LAUNCHER
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "chpltypes.h"
+#include "chpl-mem-desc.h"
+
+//
+// Memory profile
+//
+// A cheaper alternative to full memory tracking (--memTrack), meant to
+// be left on in long-running programs.  Each thread counts the
+// allocations it makes and the bytes they request, both by memory
+// description and by call site, without any locking shared with other
+// threads.  In addition, about one allocation for every `rate' bytes
+// allocated is sampled: the sample is remembered, with its call site,
+// until the memory is freed, and stands in for `rate' bytes (or the
+// allocation's own size, if that is larger).  The live bytes and the
+// high-water mark of each description and call site are estimated from
+// the samples.  With a rate of 1, every allocation is sampled and the
+// estimates are exact.  A rate of 0 turns sampling off.
+//
+
+// Memory profiling activated?
+extern chpl_bool chpl_memProfile;
+
+void chpl_mem_profile_init(size_t rate);
+void chpl_mem_profile_alloc(void* memAlloc, size_t size,
+                            chpl_mem_descInt_t description,
+                            int32_t lineno, c_string filename);
+void chpl_mem_profile_free(void* memAlloc);
+void chpl_mem_profile_print(FILE* f);
+
+#endif // LAUNCHER
+
+#endif // _chpl_mem_profile_H_
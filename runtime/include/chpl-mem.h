@@ -30,6 +30,7 @@
 #include "chpl-mem-hook.h"
 #include "chpltypes.h"
 #include "chpl-tasks.h"
+#include "chpl-topo.h"
 #include "error.h"
 
 // runtime/include/mem/*/chpl-mem-impl.h defines
@@ -45,6 +46,25 @@ void chpl_mem_exit(void);
 int chpl_mem_inited(void);
 
 
+//
+// Under a locale model with sublocales, the pages of big allocations
+// are placed in the memory of the NUMA domain of the sublocale the
+// allocating task is running on, or spread over all the domains for a
+// task that isn't on any particular sublocale.  Locale models without
+// sublocales define CHPL_LOCALE_MODEL_NUM_SUBLOCALES as 0, and for
+// them this does nothing.
+//
+#define CHPL_MEM_LOCALIZE_MIN_SIZE (1024 * 1024)
+
+static ___always_inline
+void chpl_mem_localize(void* memAlloc, size_t size) {
+#ifndef CHPL_LOCALE_MODEL_NUM_SUBLOCALES
+  if (size >= CHPL_MEM_LOCALIZE_MIN_SIZE && memAlloc != NULL)
+    chpl_topo_setMemLocality(memAlloc, size, chpl_task_getRequestedSubloc());
+#endif
+}
+
+
 static ___always_inline
 void* chpl_mem_allocMany(size_t number, size_t size,
                          chpl_mem_descInt_t description,
@@ -52,6 +72,7 @@ void* chpl_mem_allocMany(size_t number, size_t size,
   void* memAlloc;
   chpl_memhook_malloc_pre(number, size, description, lineno, filename);
   memAlloc = chpl_malloc(number*size);
+  chpl_mem_localize(memAlloc, number*size);
   chpl_memhook_malloc_post(memAlloc, number, size, description,
                            lineno, filename);
   return memAlloc;
@@ -70,6 +91,7 @@ void* chpl_mem_allocManyZero(size_t number, size_t size,
   void* memAlloc;
   chpl_memhook_malloc_pre(number, size, description, lineno, filename);
   memAlloc = chpl_calloc(number, size);
+  chpl_mem_localize(memAlloc, number*size);
   chpl_memhook_malloc_post(memAlloc, number, size, description,
                            lineno, filename);
   return memAlloc;
@@ -95,6 +117,8 @@ void* chpl_mem_realloc(void* memAlloc, size_t size,
     return NULL;
   }
   moreMemAlloc = chpl_realloc(memAlloc, size);
+  if (moreMemAlloc != memAlloc)
+    chpl_mem_localize(moreMemAlloc, size);
   chpl_memhook_realloc_post(moreMemAlloc, memAlloc, size, description,
                             lineno, filename);
   return moreMemAlloc;
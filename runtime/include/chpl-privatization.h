@@ -22,13 +22,35 @@
 #ifndef LAUNCHER
 #include <stdint.h>
 #include "chpltypes.h"
+#include "chpl-bitops.h"
 
-extern void** chpl_privateObjects; // privatized array and domain objects
+//
+// Privatized array, domain and distribution objects are kept in a
+// table of segments.  Segment k holds 2**(k+CHPL_PRIVATIZATION_SEG0_BITS)
+// entries, so the table grows by adding a segment rather than by
+// copying, and a lookup is a couple of shifts and two loads.
+//
+#define CHPL_PRIVATIZATION_SEG0_BITS 3
+#define CHPL_PRIVATIZATION_NUM_SEGS  (64 - CHPL_PRIVATIZATION_SEG0_BITS)
+
+extern void** chpl_privateObjects[CHPL_PRIVATIZATION_NUM_SEGS];
 
 extern void chpl_privatization_init(void);
 
 extern void chpl_newPrivatizedClass(void*, int64_t);
-extern void* chpl_getPrivatizedClass(int64_t);
+
+static inline
+int chpl_privatization_seg(uint64_t i) {
+  return 63 - (int) chpl_bitops_clz_64(i) - CHPL_PRIVATIZATION_SEG0_BITS;
+}
+
+static inline
+void* chpl_getPrivatizedClass(int64_t pid) {
+  uint64_t i = (uint64_t) pid + (1 << CHPL_PRIVATIZATION_SEG0_BITS);
+  int seg = chpl_privatization_seg(i);
+  void** segment = __atomic_load_n(&chpl_privateObjects[seg], __ATOMIC_ACQUIRE);
+  return segment[i - ((uint64_t) 1 << (seg + CHPL_PRIVATIZATION_SEG0_BITS))];
+}
 
 #endif // LAUNCHER
 #endif // _chpl_privatization_h_
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2004-2014 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_topo_h_
+#define _chpl_topo_h_
+
+#include <stddef.h>
+
+#include "chpltypes.h"
+
+//
+// Node topology: the NUMA domains of this node, and the placement of
+// threads and memory on them.
+//
+// Each NUMA domain that has cpus we may run on becomes one sublocale,
+// numbered densely from 0.  On Linux the domains are found by reading
+// /sys/devices/system/node; elsewhere the whole node is one domain.
+// The environment variable CHPL_RT_NUM_SUBLOCALES overrides the number
+// found.  If it asks for a different number than the hardware has, the
+// accessible cpus are dealt out evenly among the requested sublocales
+// and memory is not placed, which is mostly useful for testing.
+//
+
+void chpl_topo_init(void);
+
+//
+// The number of NUMA domains (sublocales), at least 1.
+//
+int chpl_topo_getNumNumaDomains(void);
+
+//
+// Restrict the calling thread to the cpus of the given sublocale's
+// NUMA domain, or if subloc is c_sublocid_any, to all the cpus we had
+// at startup.
+//
+void chpl_topo_setThreadLocality(c_sublocid_t subloc);
+
+//
+// Place the pages of [p, p+size) in the memory of the given sublocale.
+// If subloc is c_sublocid_any, split the pages into as many equal
+// contiguous pieces as there are sublocales and place each piece on
+// the corresponding sublocale, to match the way data-parallel loops
+// divide their iterations among sublocales.  Only pages entirely
+// within the range are placed, and pages already placed are moved.
+//
+void chpl_topo_setMemLocality(void* p, size_t size, c_sublocid_t subloc);
+
+#endif // _chpl_topo_h_
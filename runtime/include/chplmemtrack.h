@@ -37,6 +37,7 @@ uint64_t chpl_memoryUsed(int32_t lineno, c_string filename);
 void chpl_printMemStat(int32_t lineno, c_string filename);
 void chpl_printLeakedMemTable(void);
 void chpl_printMemTable(int64_t threshold, int32_t lineno, c_string filename);
+void chpl_printMemProfile(int32_t lineno, c_string filename);
 void chpl_reportMemInfo(void);
 void chpl_track_malloc(void* memAlloc, size_t number, size_t size,
                        chpl_mem_descInt_t description,
@@ -27,8 +27,14 @@ typedef void* chpl_comm_nb_handle_t;
 #include "chpl-cache-task-decls.h"
 #define HAS_CHPL_CACHE_FNS
 
+// This comm layer can aggregate small PUTs (see chpl-comm.h).
+#define HAS_CHPL_COMM_AGGREGATE_FNS
+
+struct fork_batch_s;
+
 typedef struct {
     chpl_cache_taskPrvData_t cache_data;
+    struct fork_batch_s*     fork_batch; // see chpl_comm_fork_nb_batch_start
 } chpl_comm_taskPrvData_t;
 
 #endif
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2004-2014 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _comm_heap_macros_h_
+#define _comm_heap_macros_h_
+
+
+void chpl_comm_shm_help_register_global_var(int i, wide_ptr_t wide);
+
+#define CHPL_HEAP_REGISTER_GLOBAL_VAR_EXTRA(i, wide) \
+  chpl_comm_shm_help_register_global_var(i, wide);
+
+#endif
+
@@ -23,19 +23,27 @@
 
 extern mspace chpl_dlmalloc_heap;
 
+//
+// These put per-thread caches of small blocks in front of the heap.
+// See mem-dlmalloc.c.
+//
+void* chpl_dlmalloc_calloc(size_t n, size_t size);
+void* chpl_dlmalloc_malloc(size_t size);
+void* chpl_dlmalloc_realloc(void* ptr, size_t size);
+void chpl_dlmalloc_free(void* ptr);
+
 static ___always_inline void* chpl_calloc(size_t n, size_t size) {
-  return mspace_calloc(chpl_dlmalloc_heap,n,size);
+  return chpl_dlmalloc_calloc(n, size);
 }
 
 static ___always_inline void* chpl_malloc(size_t size) {
-  return mspace_malloc(chpl_dlmalloc_heap, size);
+  return chpl_dlmalloc_malloc(size);
 }
 
 static ___always_inline void* chpl_realloc(void* ptr, size_t size) {
-  return mspace_realloc(chpl_dlmalloc_heap, ptr, size);
+  return chpl_dlmalloc_realloc(ptr, size);
 }
 
 static ___always_inline void chpl_free(void* ptr) {
-  mspace_free(chpl_dlmalloc_heap, ptr);
+  chpl_dlmalloc_free(ptr);
 }
-
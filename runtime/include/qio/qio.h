@@ -326,13 +326,16 @@ typedef enum {
   QIO_METHOD_FREADFWRITE = 3*QIO_HINT_AFTERCHTYPE,
   QIO_METHOD_MMAP = 4*QIO_HINT_AFTERCHTYPE,
   QIO_METHOD_MEMORY = 5*QIO_HINT_AFTERCHTYPE,
+  // preadv/pwritev submitted to an asynchronous engine (see qio_async.c);
+  // the task waits for them as it would for a sync variable.
+  QIO_METHOD_ASYNC = 6*QIO_HINT_AFTERCHTYPE,
   //QIO_METHOD_LIBEVENT,
 } qio_method_t;
 #define QIO_METHODMASK 0x00f0
 #define QIO_HINT_AFTERMETHOD 0x0100
 #define QIO_METHOD_DEFAULT 0
 #define QIO_MIN_METHOD QIO_METHOD_READWRITE
-#define QIO_MAX_METHOD QIO_METHOD_MEMORY
+#define QIO_MAX_METHOD QIO_METHOD_ASYNC
 
 enum {
   QIO_HINT_RANDOM       = QIO_HINT_AFTERMETHOD,
@@ -427,6 +430,9 @@ char* qio_hints_to_string(qio_hint_t hint)
       case QIO_METHOD_MEMORY:
         strcat(buf, " memory"); ok = 1;
         break;
+      case QIO_METHOD_ASYNC:
+        strcat(buf, " async"); ok = 1;
+        break;
       // no default to get warned if any are added.
     }
   }
@@ -524,6 +530,13 @@ qioerr qio_writev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffe
 qioerr qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read);
 qioerr qio_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written);
 
+// These are in qio_async.c. They are like qio_preadv/qio_pwritev
+// but keep many requests in flight, and wait for them as a task would
+// for a sync variable.
+qioerr qio_async_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read);
+qioerr qio_async_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written);
+err_t qio_async_iov(fd_t fd, int writing, const struct iovec* iov, int iovcnt, int64_t offset, ssize_t* num_out);
+
 // if fp is not null, fd is ignored; if fp is null, we use fd.
 // the QIO file takes ownership of fp or fd, closing it when the QIO file is closed.
 qioerr qio_file_init(qio_file_t** file_out, FILE* fp, fd_t fd, qio_hint_t iohints, const qio_style_t* style, int usefilestar);
@@ -802,6 +815,10 @@ typedef struct qio_channel_s {
   // for the common case of very few marks.
   int64_t mark_space[MARK_INITIAL_STACK_SZ];
 
+  // The bytes behind the last view returned by qio_channel_read_view
+  // when the caller asked the channel to keep them alive (or NULL).
+  qbytes_t* view_bytes;
+
   qio_style_t style;
 } qio_channel_t;
 
@@ -1238,6 +1255,20 @@ qioerr qio_channel_begin_peek_buffer(const int threadsafe, qio_channel_t* ch, in
 
 qioerr qio_channel_end_peek_buffer(const int threadsafe, qio_channel_t* ch, int64_t advance);
 
+// Zero-copy read. Returns a read-only view of up to maxlen bytes at the
+// channel's current position and advances the channel past them. The
+// view is *len_out bytes at *ptr_out, which point into *bytes_out; the
+// bytes are retained for the caller, who must qbytes_release them when
+// done with the view. If bytes_out is NULL, the channel holds that
+// reference instead and drops it at the next call or when the channel is
+// destroyed. For QIO_METHOD_MMAP channels the view points into the file
+// mapping itself, which stays mapped as long as a view is held (even
+// after the file is closed). A view never spans two buffer parts, so it
+// may be shorter than maxlen even when more data is available.
+// Returns EEOF (with no view) at the end of the channel, and EINVAL
+// (without moving the channel) if maxlen is not positive.
+qioerr qio_channel_read_view(const int threadsafe, qio_channel_t* ch, int64_t maxlen, qbytes_t** bytes_out /* can be NULL */, void** ptr_out, int64_t* len_out);
+
 static inline
 qioerr qio_channel_isbuffered(const int threadsafe, qio_channel_t* ch, char* isbuffered)
 {
@@ -47,30 +47,38 @@ void chpl_task_stdModulesInitialized(void);
 typedef uint64_t chpl_taskID_t;
 #define chpl_nullTaskID 0
 
-//
-// Condition variables
-//
-typedef pthread_cond_t chpl_thread_condvar_t;
-
-
 //
 // Sync variables
 //
+// The lock, the full/empty state, and a count of the threads sleeping
+// on the variable are packed into one state word.  See tasks-fifo.c.
+//
+struct task_ctx;                      // lightweight task (see tasks-fifo.c)
+
 typedef struct {
-  volatile chpl_bool  is_full;
-  chpl_thread_mutex_t lock;
-  chpl_thread_condvar_t signal_full;  // wait for full; signal this when full
-  chpl_thread_condvar_t signal_empty; // wait for empty; signal this when empty
-  //  threadlayer_sync_aux_t tl_aux;
+  volatile uint32_t   state;          // locked, full, and sleeper count
+  int32_t             spin;           // recent spins needed to lock it
+  struct task_ctx*    waiters;        // suspended lightweight tasks
 } chpl_sync_aux_t;
 
 
 //
-// The fifo tasking layer doesn't really support sublocales.
+// In lightweight-task mode a task waiting for a remote fork to finish
+// has to yield, so that its thread can run other tasks meanwhile.
 //
-// Putting these interface function definitions here and marking them
-// for inlining makes them cost-free at execution time.
+#define CHPL_COMM_YIELD_TASK_WHILE_POLLING
+
+
+//
+// Under a locale model with sublocales (numa), each NUMA domain is a
+// sublocale and tasks run on the cpus of the one they ask for; see
+// tasks-fifo.c.  Locale models without sublocales define
+// CHPL_LOCALE_MODEL_NUM_SUBLOCALES as 0, and for them, putting these
+// interface function definitions here and marking them for inlining
+// makes them cost-free at execution time.
 //
+#ifdef CHPL_LOCALE_MODEL_NUM_SUBLOCALES
+
 #ifdef CHPL_TASK_GETSUBLOC_IMPL_DECL
 #error "CHPL_TASK_GETSUBLOC_IMPL_DECL is already defined!"
 #else
@@ -103,4 +111,6 @@ c_sublocid_t chpl_task_getRequestedSubloc(void) {
   return c_sublocid_any;
 }
 
+#endif // CHPL_LOCALE_MODEL_NUM_SUBLOCALES
+
 #endif
@@ -254,6 +254,61 @@ would be to only move tasks between threads in situations that create full
 barriers anyway; notably a full barrier occurs on task start and sync variable
 use.
 
+== Replacement Policy and Sharing ==
+
+Two optional features can be selected at program start with environment
+variables:
+
+  CHPL_RT_CACHE_POLICY=arc
+    Use an ARC-style adaptive replacement policy instead of 2Q. See
+    "ARC: A Self-Tuning, Low Overhead Replacement Cache" by Nimrod Megiddo
+    and Dharmendra S. Modha, FAST 2003. ARC reuses the 2Q queues: Ain is T1
+    (pages seen once), Aout is B1 (its ghost list), Am is T2 (pages seen at
+    least twice), and Amout is the additional ghost list B2. Instead of a
+    fixed Kin, the target size of Ain moves towards whichever ghost list is
+    getting hits, so a large streaming sweep stays in Ain and does not push
+    the re-used working set out of Am.
+
+  CHPL_RT_CACHE_SHARED=yes
+    Add a per-locale read-only tier shared by all of the per-pthread caches.
+    When a GET misses in a pthread's cache and that cache holds nothing
+    usable for the page, the shared tier is consulted before a GET is
+    issued. Pages that are fetched this way are fetched whole and then
+    published to the shared tier, and a pthread that wants a page another
+    pthread is already fetching waits for it. So when many tasks on a
+    locale read the same remote data (e.g. the vector in a distributed
+    matrix-vector multiply) that data is fetched about once per locale
+    rather than once per pthread.
+
+    The shared tier never holds dirty data and never defers a GET. Its
+    consistency with acquire barriers is handled with a locale-wide clock:
+    each shared page records the clock epoch in which its GET started,
+    an acquire barrier moves the clock past any GET started before it, and
+    a task only uses shared pages whose GET started after its last acquire
+    barrier. A task must also see its own writes. A page it has written
+    stays in its pthread's cache (which is consulted first) until eviction,
+    and eviction waits for the PUTs. At that point the page is dropped from
+    the shared tier and any GET for it that was already in flight is not
+    published.
+
+Hit, miss, eviction and GET/PUT counts are kept per pthread and can be read,
+summed over the locale, with chpl_cache_get_stats().
+
+== Strided and Indexed Transfers ==
+
+Strided transfers (chpl_comm_get_strd/chpl_comm_put_strd, used by bulk
+array assignment) and indexed gather/scatter transfers (a list of remote
+element addresses) also go through the cache. Each transfer is broken
+into runs of contiguous bytes - adjacent pieces are merged - and each run
+is an ordinary cache GET or PUT. So pieces that fall on the same cache
+lines share one GET or one write-behind PUT, and lines that are already
+valid in the cache are not fetched again. For a GET, the cache keeps
+prefetches for the next several pages in flight ahead of the run it is
+waiting for, so that the GETs for different lines overlap. A transfer
+that is larger than a quarter of the cache would only evict everything
+else; such transfers do a full fence and go straight to the
+communication layer as before.
+
  */
 
 // ASSUMES THAT TASKS DO NOT MIGRATE BETWEEN PTHREADS
@@ -282,6 +337,9 @@ use.
 #include "sys.h" // sys_page_size()
 #include "chpl-comm-no-warning-macros.h" // No warnings for chpl_comm_get etc.
 #include <string.h> // memcpy, memset, etc.
+#include <stdlib.h> // getenv
+#include <pthread.h>
+#include <sched.h> // sched_yield
 #include <assert.h>
 
 
@@ -477,6 +535,24 @@ struct dirty_entry_s {
 #define QUEUE_AIN 1
 #define QUEUE_AOUT 2
 #define QUEUE_AM 3
+#define QUEUE_AMOUT 4 // only used by the ARC policy
+
+// Which replacement policy do the per-pthread caches use?
+#define CACHE_POLICY_2Q 0
+#define CACHE_POLICY_ARC 1
+static int cache_policy = CACHE_POLICY_2Q;
+
+// With ARC, a hit on a page in Ain only counts as a second reference
+// (moving the page to Am) if at least this many other pages have entered
+// Ain since it did. Closer hits are treated as one correlated reference,
+// as in the 2Q paper; otherwise a sweep that reads each page a few bytes
+// at a time would move every page it touches into Am.
+#define ARC_CORRELATED_PAGES 32
+
+// Is the shared per-locale read-only tier enabled?
+static int cache_shared_enabled = 0;
+
+#define NO_SHARED_FILL (-1)
 
 // Storing a remote address (node number is separate).
 typedef uintptr_t raddr_t;
@@ -524,6 +600,14 @@ struct cache_entry_s {
   // If there are dirty bits in this page, what sequence number did
   // we promise to use in order to complete them?
   //cache_seqn_t dirty_sequence_number;
+  // Value of the cache's ain_inserts when this entry entered Ain (for ARC).
+  unsigned int ain_stamp;
+  // Has this page been written since it was given its page?
+  int written;
+  // If the whole page was fetched by a GET that may be published to the
+  // shared tier once it completes, the shared clock epoch in which that GET
+  // started. Otherwise NO_SHARED_FILL.
+  int64_t shared_fill_time;
 };
 
 // Note skip/len are in line numbers, NOT byte offsets!
@@ -647,6 +731,17 @@ struct rdcache_s {
   struct cache_entry_s* am_lru_head;
   struct cache_entry_s* am_lru_tail;
 
+  // Amout is only used by the ARC policy. It is the ghost list (B2) for
+  // entries that have fallen off of Am. Like Aout, it has no pages.
+  // arc_target is ARC's adaptive target size for Ain (called p in the paper).
+  unsigned int amout_current; // current length of amout list
+  struct cache_entry_s *amout_head;
+  struct cache_entry_s *amout_tail;
+  unsigned int arc_target;
+  // How many entries have entered Ain? Used by ARC to tell a
+  // re-reference from accesses to the same page close together.
+  unsigned int ain_inserts;
+
   // List of dirty pages (for write-combining)
   int num_dirty_pages;
   struct dirty_entry_s *dirty_lru_head;
@@ -664,10 +759,272 @@ struct rdcache_s {
   int max_top_entries;
   struct cache_entry_base_s* free_top_nodes_head; // a linked list.
 
+  // Usage counters, and links in the list of all caches on this locale
+  // (so that chpl_cache_get_stats() can sum the counters).
+  chpl_cache_stats_t stats;
+  struct rdcache_s* all_caches_next;
+  struct rdcache_s* all_caches_prev;
+
   // The entry into the 'pointer tree' hashtable structure.
   struct top_entry_s* top_index_list[TOP_SIZE];
 };
 
+// How many pages should a cache have?
+static
+int cache_num_pages(void)
+{
+  int cache_pages;
+
+  cache_pages = CACHE_PAGES_PER_NODE * chpl_numNodes;
+  if( cache_pages < MIN_CACHE_DATA_SIZE/CACHEPAGE_SIZE )
+    cache_pages = MIN_CACHE_DATA_SIZE/CACHEPAGE_SIZE;
+  if( cache_pages > MAX_CACHE_DATA_SIZE/CACHEPAGE_SIZE )
+    cache_pages = MAX_CACHE_DATA_SIZE/CACHEPAGE_SIZE;
+
+  return cache_pages;
+}
+
+
+//////////////// SHARED READ-ONLY TIER ////////////////////
+
+// The shared tier is a direct-mapped table of whole cache pages that all
+// of the pthreads on a locale can read. Each slot is guarded by a
+// sequence lock: a writer makes 'seq' odd while it changes the slot, and
+// a reader that sees 'seq' odd, or changed while it was copying the page
+// out, treats the lookup as a miss.
+//
+// A pthread that misses in the shared tier claims the slot for the page
+// before starting its GET, so that other pthreads that want the same
+// page at the same time can wait for it (or, for prefetches, leave it)
+// rather than issuing GETs of their own.
+struct shared_page_s {
+  atomic_int_least64_t seq;
+  c_nodeid_t node;
+  raddr_t raddr; // 0 if the slot is empty
+  int filling; // is a GET for this page in flight?
+  // shared clock epoch in which the GET that filled (or is filling) this
+  // slot started
+  int64_t fill_time;
+  // shared clock epoch of the last invalidation of a page in this slot
+  int64_t invalidate_time;
+  unsigned char* page;
+};
+
+static struct shared_page_s* shared_pages = NULL;
+static uintptr_t shared_num_pages = 0; // a power of 2
+
+// The locale-wide clock. Its value is twice the current epoch, plus one
+// once a GET for the shared tier has started in that epoch. Acquire
+// barriers and invalidations need every later GET to be in a later epoch
+// than every earlier one, but they only have to start a new epoch if a
+// GET has started in the current one. So the tasks of a coforall, which
+// all do an acquire as they start, usually end up in the same epoch.
+static atomic_int_least64_t shared_clock;
+
+// Returns the epoch for a GET that is about to start.
+static
+int64_t shared_fill_epoch(void)
+{
+  int_least64_t c = atomic_load_int_least64_t(&shared_clock);
+
+  while( ! (c & 1) ) {
+    if( atomic_compare_exchange_strong_int_least64_t(&shared_clock, c, c+1) )
+      return c >> 1;
+    c = atomic_load_int_least64_t(&shared_clock);
+  }
+  return c >> 1;
+}
+
+// Returns an epoch in which no GET has started before this call.
+static
+int64_t shared_new_epoch(void)
+{
+  int_least64_t c = atomic_load_int_least64_t(&shared_clock);
+
+  while( c & 1 ) {
+    if( atomic_compare_exchange_strong_int_least64_t(&shared_clock, c, c+1) )
+      return (c+1) >> 1;
+    c = atomic_load_int_least64_t(&shared_clock);
+  }
+  return c >> 1;
+}
+
+static
+void shared_create(void)
+{
+  unsigned char* buffer;
+  unsigned char* pages;
+  uintptr_t offset;
+  uintptr_t i;
+
+  shared_num_pages = 1;
+  while( shared_num_pages < (uintptr_t) cache_num_pages() )
+    shared_num_pages *= 2;
+
+  // As in cache_create, allocate it all in one go with an extra page
+  // for alignment.
+  buffer = chpl_malloc(sizeof(struct shared_page_s) * shared_num_pages +
+                       CACHEPAGE_SIZE + CACHEPAGE_SIZE * shared_num_pages);
+  shared_pages = (struct shared_page_s*) buffer;
+  pages = buffer + sizeof(struct shared_page_s) * shared_num_pages;
+  offset = ((uintptr_t) pages) % CACHEPAGE_SIZE;
+  if( offset != 0 ) pages += CACHEPAGE_SIZE - offset;
+
+  for( i = 0; i < shared_num_pages; i++ ) {
+    atomic_init_int_least64_t(&shared_pages[i].seq, 0);
+    shared_pages[i].node = -1;
+    shared_pages[i].raddr = 0;
+    shared_pages[i].filling = 0;
+    shared_pages[i].fill_time = 0;
+    shared_pages[i].invalidate_time = 0;
+    shared_pages[i].page = pages + i * CACHEPAGE_SIZE;
+  }
+
+  atomic_init_int_least64_t(&shared_clock, 0);
+}
+
+static inline
+struct shared_page_s* shared_slot(c_nodeid_t node, raddr_t raddr)
+{
+  uintptr_t h = (raddr >> CACHEPAGE_BITS) ^ ((uintptr_t) node * 0x9e3779b1);
+  return &shared_pages[h & (shared_num_pages - 1)];
+}
+
+static inline
+int shared_trylock(struct shared_page_s* s, int_least64_t* seq)
+{
+  *seq = atomic_load_int_least64_t(&s->seq);
+  return ! (*seq & 1) &&
+         atomic_compare_exchange_strong_int_least64_t(&s->seq, *seq, *seq+1);
+}
+
+static inline
+void shared_unlock(struct shared_page_s* s, int_least64_t seq)
+{
+  atomic_thread_fence(memory_order_release);
+  atomic_store_int_least64_t(&s->seq, seq + 2);
+}
+
+#define SHARED_MISS 0
+#define SHARED_HIT 1
+#define SHARED_FILLING 2
+
+// How many times should a GET look again for a page that another pthread
+// is fetching before giving up and issuing its own GET? We give up the
+// processor between looks, so that the pthread doing the GET (or other
+// work) can run. That is a sched_yield() rather than a chpl_task_yield(),
+// since a task switch here could run another task on this pthread's
+// cache while we are in the middle of using it.
+#define SHARED_FILL_SPINS 64
+
+// Copies node:raddr from the shared tier into page, if the shared tier
+// has it and its GET started no earlier than not_before. Returns
+// SHARED_HIT if it did so, SHARED_FILLING if such a GET is in flight,
+// and SHARED_MISS otherwise.
+static
+int shared_lookup(c_nodeid_t node, raddr_t raddr, int64_t not_before,
+                  unsigned char* page)
+{
+  struct shared_page_s* s = shared_slot(node, raddr);
+  int_least64_t seq;
+
+  seq = atomic_load_int_least64_t(&s->seq);
+  if( seq & 1 ) return SHARED_MISS;
+  if( s->node != node || s->raddr != raddr || s->fill_time < not_before )
+    return SHARED_MISS;
+  if( s->filling ) return SHARED_FILLING;
+  chpl_memcpy(page, s->page, CACHEPAGE_SIZE);
+  atomic_thread_fence(memory_order_acquire);
+  if( atomic_load_int_least64_t(&s->seq) != seq ) return SHARED_MISS;
+  return SHARED_HIT;
+}
+
+// Records that a GET for node:raddr started in epoch fill_time. This replaces whatever the slot held before.
+static
+void shared_claim(c_nodeid_t node, raddr_t raddr, int64_t fill_time)
+{
+  struct shared_page_s* s = shared_slot(node, raddr);
+  int_least64_t seq;
+
+  // Don't wait if another pthread is using the slot.
+  if( ! shared_trylock(s, &seq) ) return;
+
+  if( fill_time >= s->invalidate_time ) {
+    s->node = node;
+    s->raddr = raddr;
+    s->filling = 1;
+    s->fill_time = fill_time;
+  }
+
+  shared_unlock(s, seq);
+}
+
+// Stores a copy of node:raddr, fetched by a GET that started in epoch
+// fill_time, in the shared tier.
+static
+void shared_publish(c_nodeid_t node, raddr_t raddr, int64_t fill_time,
+                    unsigned char* page)
+{
+  struct shared_page_s* s = shared_slot(node, raddr);
+  int_least64_t seq;
+  int same_page;
+
+  // Don't wait if another pthread is using the slot.
+  if( ! shared_trylock(s, &seq) ) return;
+
+  same_page = ( s->node == node && s->raddr == raddr );
+
+  // If the slot was invalidated after the GET started, that GET might
+  // have missed a write. Otherwise, fill in our own claim, or replace
+  // anything but another pthread's claim or a newer copy of the page.
+  if( fill_time >= s->invalidate_time &&
+      ( same_page ? s->fill_time <= fill_time : ! s->filling ) ) {
+    s->node = node;
+    s->raddr = raddr;
+    s->filling = 0;
+    s->fill_time = fill_time;
+    chpl_memcpy(s->page, page, CACHEPAGE_SIZE);
+  }
+
+  shared_unlock(s, seq);
+}
+
+// Removes node:raddr from the shared tier. This is called once a page
+// written by this pthread has been evicted, which waits for its PUTs.
+static
+void shared_invalidate(c_nodeid_t node, raddr_t raddr)
+{
+  struct shared_page_s* s = shared_slot(node, raddr);
+  int64_t now;
+  int_least64_t seq;
+
+  now = shared_new_epoch();
+
+  // Publishers only hold the lock while they copy one page in.
+  while( ! shared_trylock(s, &seq) ) ;
+
+  if( now > s->invalidate_time ) s->invalidate_time = now;
+  if( s->node == node && s->raddr == raddr ) {
+    s->raddr = 0;
+    s->filling = 0;
+  }
+
+  shared_unlock(s, seq);
+}
+
+// Publishes an entry's page if it was fetched whole for the shared tier
+// and has not been written since.
+static
+void shared_publish_entry(struct cache_entry_s* entry)
+{
+  if( entry->shared_fill_time != NO_SHARED_FILL && ! entry->written ) {
+    shared_publish(entry->base.node, entry->raddr,
+                   entry->shared_fill_time, entry->page);
+  }
+  entry->shared_fill_time = NO_SHARED_FILL;
+}
+
+
 static void validate_cache(struct rdcache_s* tree);
 
 
@@ -692,11 +1049,7 @@ struct rdcache_s* cache_create(void) {
   unsigned char* buffer;
   unsigned char* pages;
 
-  cache_pages = CACHE_PAGES_PER_NODE * chpl_numNodes;
-  if( cache_pages < MIN_CACHE_DATA_SIZE/CACHEPAGE_SIZE )
-    cache_pages = MIN_CACHE_DATA_SIZE/CACHEPAGE_SIZE;
-  if( cache_pages > MAX_CACHE_DATA_SIZE/CACHEPAGE_SIZE )
-    cache_pages = MAX_CACHE_DATA_SIZE/CACHEPAGE_SIZE;
+  cache_pages = cache_num_pages();
 
   ain_pages = cache_pages / 4; // 2Q: "Kin should be 25% of page slots"
   aout_pages = cache_pages / 2; // 2Q: "Kout should hold identifiers for as
@@ -708,6 +1061,8 @@ struct rdcache_s* cache_create(void) {
   top_entries = cache_pages / 16;
   // How many cache entries do we need? 
   n_entries = cache_pages + aout_pages;
+  // ARC remembers up to cache_pages evicted pages in its two ghost lists.
+  if( cache_policy == CACHE_POLICY_ARC ) n_entries = 2 * cache_pages;
 
   total_size += sizeof(struct rdcache_s);
   total_size += sizeof(struct page_list_s) * cache_pages;
@@ -807,6 +1162,12 @@ struct rdcache_s* cache_create(void) {
   c->am_lru_head = NULL;
   c->am_lru_tail = NULL;
 
+  c->amout_current = 0;
+  c->amout_head = NULL;
+  c->amout_tail = NULL;
+  c->arc_target = 0;
+  c->ain_inserts = 0;
+
   c->num_dirty_pages = 0;
   c->dirty_lru_head = NULL;
   c->dirty_lru_tail = NULL;
@@ -842,6 +1203,10 @@ struct rdcache_s* cache_create(void) {
     top_nodes[i].base.next = next;
   }
 
+  memset(&c->stats, 0, sizeof(chpl_cache_stats_t));
+  c->all_caches_next = NULL;
+  c->all_caches_prev = NULL;
+
   // clear top_index_list.
   memset(&c->top_index_list[0], 0, sizeof(struct top_entry_s*) * TOP_SIZE);
 
@@ -935,6 +1300,12 @@ void rdcache_print(struct rdcache_s* cache) {
   for( entry = cache->am_lru_head; entry; entry = entry->next ) {
     cache_entry_print(entry, "     am ", 1);
   }
+  if( cache_policy == CACHE_POLICY_ARC ) {
+    printf("  Amout (arc target %u):\n", cache->arc_target);
+    for( entry = cache->amout_head; entry; entry = entry->next ) {
+      cache_entry_print(entry, "  amout ", 1);
+    }
+  }
 
   fflush(stdout);
 }
@@ -1113,11 +1484,27 @@ static
 void flush_entry(struct rdcache_s* cache, struct cache_entry_s* entry, int op,
                  raddr_t raddr, int32_t len_in);
 
+// Removes a ghost entry (one in Aout or Amout, with no page) from the tree
+// and stores it on the free list.
+static
+void ghost_free(struct rdcache_s* cache, struct cache_entry_s* z)
+{
+  struct cache_entry_base_s* entry;
+
+  // Remove entry (which we are kicking off of its ghost list) from the tree
+  tree_remove(cache, z);
+
+  z->queue = QUEUE_FREE;
+
+  // and store it on the free list.
+  entry = &z->base;
+  SINGLE_PUSH_HEAD(cache, entry, free_entries);
+}
+
 static
 void aout_evict(struct rdcache_s* cache)
 {
   struct cache_entry_s* z;
-  struct cache_entry_base_s* entry;
 
   z = cache->aout_tail;
 
@@ -1127,14 +1514,63 @@ void aout_evict(struct rdcache_s* cache)
   DOUBLE_REMOVE_TAIL(cache, aout);
   cache->aout_current--;
 
-  // Remove entry (which we are kicking off of Aout) from the tree
-  tree_remove(cache, z);
+  ghost_free(cache, z);
+}
 
-  z->queue = QUEUE_FREE;
+static
+void amout_evict(struct rdcache_s* cache)
+{
+  struct cache_entry_s* z;
 
-  // and store it on the free list.
-  entry = &z->base;
-  SINGLE_PUSH_HEAD(cache, entry, free_entries);
+  z = cache->amout_tail;
+
+  if( !z ) return;
+
+  // Remove the tail element from Amout
+  DOUBLE_REMOVE_TAIL(cache, amout);
+  cache->amout_current--;
+
+  ghost_free(cache, z);
+}
+
+// ARC keeps at most max_pages entries in Ain and Aout together,
+// and at most 2*max_pages entries in all four queues.
+static
+void arc_trim_ghosts(struct rdcache_s* cache)
+{
+  unsigned int c = cache->max_pages;
+
+  while( cache->aout_current > 0 &&
+         cache->ain_current + cache->aout_current > c ) {
+    aout_evict(cache);
+  }
+  while( cache->amout_current > 0 &&
+         cache->ain_current + cache->aout_current +
+         cache->am_current + cache->amout_current > 2 * c ) {
+    amout_evict(cache);
+  }
+}
+
+// ARC's adaptation step. A miss that hits in Aout means Ain would have
+// kept the page if it were larger, and a miss that hits in Amout means
+// the same for Am. Move the target size of Ain accordingly.
+static
+void arc_adapt(struct rdcache_s* cache, int hit_in_aout)
+{
+  unsigned int delta = 1;
+
+  if( hit_in_aout ) {
+    if( cache->amout_current > cache->aout_current )
+      delta = cache->amout_current / cache->aout_current;
+    cache->arc_target += delta;
+    if( cache->arc_target > cache->max_pages )
+      cache->arc_target = cache->max_pages;
+  } else {
+    if( cache->aout_current > cache->amout_current )
+      delta = cache->aout_current / cache->amout_current;
+    if( cache->arc_target > delta ) cache->arc_target -= delta;
+    else cache->arc_target = 0;
+  }
 }
 
 static
@@ -1152,6 +1588,7 @@ void ain_evict(struct rdcache_s* cache, struct cache_entry_s* dont_evict_me)
     ain_evict(cache, NULL);
     // Put dont_evict_me back on the tail.
     DOUBLE_PUSH_TAIL(cache, dont_evict_me, ain);
+    return;
   }
 
 #ifdef DEBUG
@@ -1164,6 +1601,7 @@ void ain_evict(struct rdcache_s* cache, struct cache_entry_s* dont_evict_me)
   // immediately wait for them to complete, before we modify the contents
   // of Ain in any way (or reuse the associated page).
   flush_entry(cache, y, FLUSH_EVICT, 0, CACHEPAGE_SIZE);
+  cache->stats.evictions++;
 
   DOUBLE_REMOVE_TAIL(cache, ain);
   cache->ain_current--;
@@ -1174,7 +1612,9 @@ void ain_evict(struct rdcache_s* cache, struct cache_entry_s* dont_evict_me)
   DOUBLE_PUSH_HEAD(cache, y, aout);
   cache->aout_current++;
 
-  if( cache->aout_current > cache->aout_max ) {
+  if( cache_policy == CACHE_POLICY_ARC ) {
+    arc_trim_ghosts(cache);
+  } else if( cache->aout_current > cache->aout_max ) {
     // Remove the tail element from aout.
     aout_evict(cache);
   }
@@ -1196,16 +1636,27 @@ void am_evict(struct rdcache_s *cache, struct cache_entry_s* dont_evict_me) {
     am_evict(cache, NULL);
     // Put dont_evict_me back on the tail.
     DOUBLE_PUSH_TAIL(cache, dont_evict_me, am_lru);
+    return;
   }
 
   // If the entry in Am has any pending/dirty requests, we must
   // immediately wait for them to complete, before we modify the contents
   // of Ain in any way (or reuse the associated page).
   flush_entry(cache, y, FLUSH_EVICT, 0, CACHEPAGE_SIZE);
+  cache->stats.evictions++;
 
   DOUBLE_REMOVE_TAIL(cache, am_lru);
   cache->am_current--;
 
+  if( cache_policy == CACHE_POLICY_ARC ) {
+    // ARC remembers pages evicted from Am in Amout.
+    y->queue = QUEUE_AMOUT;
+    DOUBLE_PUSH_HEAD(cache, y, amout);
+    cache->amout_current++;
+    arc_trim_ghosts(cache);
+    return;
+  }
+
   // Remove this entry in Am from the pointer tree.
   tree_remove(cache, y);
 
@@ -1225,7 +1676,11 @@ struct top_entry_s* top_entry_allocate(struct rdcache_s* tree)
   while( ! tree->free_top_nodes_head ) {
     // If there's nothing in our free list, we have to evict something
     // from the cache.
-    // Take turns evicting from Aout, Ain, and Am.
+    // Take turns evicting from Amout, Aout, Ain, and Am.
+
+    // Evict from Amout (only used by ARC)
+    amout_evict(tree);
+    if( tree->free_top_nodes_head ) break; 
 
     // Evict from Aout 2x (since evicting Ain adds to Aout)
     aout_evict(tree);
@@ -1253,6 +1708,27 @@ struct top_entry_s* top_entry_allocate(struct rdcache_s* tree)
 static
 void reclaim(struct rdcache_s* cache, struct cache_entry_s* dont_evict_me)
 {
+  int from_ain;
+
+  if( cache_policy == CACHE_POLICY_ARC ) {
+    // This is REPLACE in the ARC paper: page out the tail of Ain if
+    // Ain is larger than its target size, and the tail of Am otherwise.
+    from_ain = ( cache->ain_current > 0 &&
+                 ( cache->ain_current > cache->arc_target ||
+                   cache->am_current == 0 ) );
+    // Don't pick a queue whose only entry is the one we must keep.
+    if( from_ain && cache->ain_current == 1 &&
+        cache->ain_tail == dont_evict_me )
+      from_ain = 0;
+    else if( ! from_ain && cache->am_current == 1 &&
+             cache->am_lru_tail == dont_evict_me )
+      from_ain = 1;
+
+    if( from_ain ) ain_evict(cache, dont_evict_me);
+    else am_evict(cache, dont_evict_me);
+    return;
+  }
+
   // This is like 'reclaimfor' in the 2Q paper
   // if the number of elements in Ain > max
   if( cache->ain_current > cache->ain_max ) {
@@ -1276,7 +1752,13 @@ struct cache_entry_s* allocate_entry(struct rdcache_s* cache)
   //       cache->ain_current, cache->aout_current, cache->am_current);
 
   // Make sure we have a free entry..
-  if( ! cache->free_entries_head ) reclaim(cache, NULL);
+  if( ! cache->free_entries_head ) {
+    // ARC first forgets a ghost entry, preferring Amout.
+    if( cache->amout_current ) amout_evict(cache);
+    else if( cache_policy == CACHE_POLICY_ARC && cache->aout_current )
+      aout_evict(cache);
+    else reclaim(cache, NULL);
+  }
 
   ret = (struct cache_entry_s*) cache->free_entries_head;
 
@@ -1320,6 +1802,18 @@ unsigned char* allocate_page(struct rdcache_s* cache)
   return ret;
 }
 
+// Puts a page that is not in use back on the free list.
+static
+void free_page(struct rdcache_s* cache, unsigned char* page)
+{
+  struct page_list_s* page_list_entry;
+
+  page_list_entry = cache->free_page_list_entries_head;
+  page_list_entry->page = page;
+  SINGLE_POP_HEAD(cache, free_page_list_entries);
+  SINGLE_PUSH_HEAD(cache, page_list_entry, free_pages);
+}
+
 static
 void ensure_free_dirty(struct rdcache_s* cache)
 {
@@ -1508,11 +2002,12 @@ void validate_cache(struct rdcache_s* tree)
   int in_ain;
   int in_aout;
   int in_am;
+  int in_amout;
   int num_used_pages = 0;
   int num_used_top_nodes = 0;
   int num_dirty = 0;
 
-  // 0: All tree entries must be in either Ain, Aout, or Am,
+  // 0: All tree entries must be in either Ain, Aout, Am, or Amout,
   //    and num_entries is correct for each top entry.
   for(top = 0; top < TOP_SIZE; top++) {
     top_cur = tree->top_index_list[top];
@@ -1526,10 +2021,12 @@ void validate_cache(struct rdcache_s* tree)
           in_ain = find_in_queue(tree->ain_head, bottom_cur);
           in_aout = find_in_queue(tree->aout_head, bottom_cur);
           in_am = find_in_queue(tree->am_lru_head, bottom_cur);
-          assert( in_ain || in_aout || in_am );
+          in_amout = find_in_queue(tree->amout_head, bottom_cur);
+          assert( in_ain || in_aout || in_am || in_amout );
           if( in_ain ) assert( bottom_cur->queue == QUEUE_AIN );
           if( in_aout ) assert( bottom_cur->queue == QUEUE_AOUT );
           if( in_am ) assert( bottom_cur->queue == QUEUE_AM );
+          if( in_amout ) assert( bottom_cur->queue == QUEUE_AMOUT );
           if( bottom_cur->page ) num_used_pages++;
           if( bottom_cur->dirty ) num_dirty++;
           bottom_cur = (struct cache_entry_s*)bottom_cur->base.next;
@@ -1551,6 +2048,9 @@ void validate_cache(struct rdcache_s* tree)
   // 3: Entries in Am must be in the tree
   in_am = validate_queue(tree, tree->am_lru_head, tree->am_lru_tail, QUEUE_AM);
   assert( in_am == tree->am_current );
+  // 3b: Entries in Amout must be in the tree
+  in_amout = validate_queue(tree, tree->amout_head, tree->amout_tail, QUEUE_AMOUT);
+  assert( in_amout == tree->amout_current );
 
   // 4: dirty list must be well-formed
   {
@@ -1585,7 +2085,7 @@ void validate_cache(struct rdcache_s* tree)
     for( cur = tree->free_entries_head; cur; cur = cur->next ) {
       num_free_entries++;
     }
-    assert( in_ain + in_aout + in_am + num_free_entries == tree->max_entries );
+    assert( in_ain + in_aout + in_am + in_amout + num_free_entries == tree->max_entries );
   }
 
   // 6: must not lose pages
@@ -1669,7 +2169,6 @@ static
 void flush_entry(struct rdcache_s* cache, struct cache_entry_s* entry, int op,
                  raddr_t raddr, int32_t len_in)
 {
-  struct page_list_s* free_page_list_entry;
   unsigned char* page;
   uintptr_t start;
   struct dirty_entry_s* dirty;
@@ -1729,6 +2228,8 @@ void flush_entry(struct rdcache_s* cache, struct cache_entry_s* entry, int op,
                              got_len /*len*/,
                              -1, NULL);
 
+          cache->stats.remote_puts++;
+
           // Save the handle in the list of pending requests.
           entry->max_put_sequence_number = pending_push(cache, handle);
 
@@ -1769,6 +2270,7 @@ void flush_entry(struct rdcache_s* cache, struct cache_entry_s* entry, int op,
       entry->min_sequence_number = NO_SEQUENCE_NUMBER;
       entry->max_put_sequence_number = NO_SEQUENCE_NUMBER;
       entry->max_prefetch_sequence_number = NO_SEQUENCE_NUMBER;
+      entry->shared_fill_time = NO_SHARED_FILL;
       memset(entry->valid_lines, 0, CACHE_LINES_PER_PAGE_BITMASK_WORDS*sizeof(uint64_t));
     } else {
       unset_valid_lines(entry->valid_lines, skip_lines, num_lines);
@@ -1777,13 +2279,19 @@ void flush_entry(struct rdcache_s* cache, struct cache_entry_s* entry, int op,
 
   // If evicting, remove the page from the cache and put it on a free list.
   if( op & FLUSH_DO_EVICT ) {
+    if( cache_shared_enabled ) {
+      // A prefetch for the shared tier that nobody read is complete now.
+      if( entry->shared_fill_time != NO_SHARED_FILL )
+        shared_publish_entry(entry);
+      // Our writes to this page are complete now, so a copy in the shared
+      // tier (or a GET for one in flight) might not include them.
+      if( entry->written )
+        shared_invalidate(entry->base.node, entry->raddr);
+    }
     // But, our entry no longer can have a page associated with it.
     page = entry->page;
     entry->page = NULL;
-    free_page_list_entry = cache->free_page_list_entries_head;
-    free_page_list_entry->page = page;
-    SINGLE_POP_HEAD(cache, free_page_list_entries);
-    SINGLE_PUSH_HEAD(cache, free_page_list_entry, free_pages);
+    free_page(cache, page);
   }
 
 #ifdef DUMP
@@ -1804,7 +2312,16 @@ void use_entry(struct rdcache_s* cache, struct cache_entry_s* entry)
   if( entry->queue == QUEUE_AM ) {
     DOUBLE_REMOVE(cache, entry, am_lru);
     DOUBLE_PUSH_HEAD(cache, entry, am_lru);
-  } 
+  } else if( cache_policy == CACHE_POLICY_ARC &&
+             entry->queue == QUEUE_AIN &&
+             cache->ain_inserts - entry->ain_stamp > ARC_CORRELATED_PAGES ) {
+    // With ARC, a page in Ain that is referenced again moves to Am.
+    DOUBLE_REMOVE(cache, entry, ain);
+    cache->ain_current--;
+    DOUBLE_PUSH_HEAD(cache, entry, am_lru);
+    cache->am_current++;
+    entry->queue = QUEUE_AM;
+  }
   // Otherwise, leave it where it is.
   // Else If X is in A1in then do nothing
 }
@@ -1858,12 +2375,21 @@ struct cache_entry_s* make_entry(struct rdcache_s* tree,
     assert( bottom_match->raddr == raddr );
     queue = bottom_match->queue;
     // We shouldn't be replacing something in Ain or Am; use use_entry instead
-    assert(queue == QUEUE_AOUT);
+    assert(queue == QUEUE_AOUT || queue == QUEUE_AMOUT);
 
-    DEBUG_PRINT(("%d: Found %p in Aout\n", chpl_nodeID, (void*) raddr));
+    tree->stats.ghost_hits++;
+    if( cache_policy == CACHE_POLICY_ARC ) arc_adapt(tree, queue == QUEUE_AOUT);
+
+    if( queue == QUEUE_AOUT ) {
+      DEBUG_PRINT(("%d: Found %p in Aout\n", chpl_nodeID, (void*) raddr));
+      DOUBLE_REMOVE(tree, bottom_match, aout);
+      tree->aout_current--;
+    } else {
+      DEBUG_PRINT(("%d: Found %p in Amout\n", chpl_nodeID, (void*) raddr));
+      DOUBLE_REMOVE(tree, bottom_match, amout);
+      tree->amout_current--;
+    }
     // add X to the head of Am
-    DOUBLE_REMOVE(tree, bottom_match, aout);
-    tree->aout_current--;
     DOUBLE_PUSH_HEAD(tree, bottom_match, am_lru);
     tree->am_current++;
 
@@ -1879,6 +2405,8 @@ struct cache_entry_s* make_entry(struct rdcache_s* tree,
     bottom_match->min_sequence_number = NO_SEQUENCE_NUMBER;
     bottom_match->max_put_sequence_number = NO_SEQUENCE_NUMBER;
     bottom_match->max_prefetch_sequence_number = NO_SEQUENCE_NUMBER;
+    bottom_match->written = 0;
+    bottom_match->shared_fill_time = NO_SHARED_FILL;
   } else {
   // Else If X is in no queue then find space for X and add it to A1in
     queue = QUEUE_FREE;
@@ -1907,10 +2435,13 @@ struct cache_entry_s* make_entry(struct rdcache_s* tree,
     bottom_tmp->min_sequence_number = NO_SEQUENCE_NUMBER;
     bottom_tmp->max_put_sequence_number = NO_SEQUENCE_NUMBER;
     bottom_tmp->max_prefetch_sequence_number = NO_SEQUENCE_NUMBER;
+    bottom_tmp->written = 0;
+    bottom_tmp->shared_fill_time = NO_SHARED_FILL;
 
     // Add it to the AIN queue.
     DOUBLE_PUSH_HEAD(tree, bottom_tmp, ain);
     tree->ain_current++;
+    bottom_tmp->ain_stamp = tree->ain_inserts++;
 
     // Put it as the first element in the appropriate hashtable bucket.
     *bottom = bottom_tmp;
@@ -2014,6 +2545,8 @@ void cache_put(struct rdcache_s* cache,
       use_dirty(cache, entry->dirty);
     }
 
+    entry->written = 1;
+
     // Now, set the dirty bits.
     set_valids_for_skip_len(entry->dirty->dirty,
                             requested_start & CACHEPAGE_MASK, requested_size,
@@ -2087,6 +2620,7 @@ void cache_get(struct rdcache_s* cache,
                 unsigned char * addr,
                 c_nodeid_t node, raddr_t raddr, int32_t size,
                 cache_seqn_t last_acquire,
+                int64_t last_shared_acquire,
                 int sequential_readahead_length,
                 int ln, c_string fn);
 
@@ -2099,6 +2633,7 @@ void cache_get_trigger_readahead(struct rdcache_s* cache,
                                  readahead_distance_t skip,
                                  readahead_distance_t len,
                                  cache_seqn_t last_acquire,
+                                 int64_t last_shared_acquire,
                                  int ln, c_string fn)
 {
   int next_ra_length;
@@ -2180,6 +2715,7 @@ void cache_get_trigger_readahead(struct rdcache_s* cache,
                 node,
                 prefetch_start, prefetch_end - prefetch_start,
                 last_acquire,
+                last_shared_acquire,
                 next_ra_length,
                 ln, fn);
     } else {
@@ -2229,6 +2765,7 @@ void cache_get(struct rdcache_s* cache,
                 unsigned char * addr,
                 c_nodeid_t node, raddr_t raddr, int32_t size,
                 cache_seqn_t last_acquire,
+                int64_t last_shared_acquire,
                 int sequential_readahead_length,
                 int ln, c_string fn)
 {
@@ -2247,7 +2784,11 @@ void cache_get(struct rdcache_s* cache,
   cache_seqn_t sn = NO_SEQUENCE_NUMBER;
   int isprefetch = (addr == NULL);
   int entry_after_acquire;
-  chpl_comm_nb_handle_t handle;
+  chpl_comm_nb_handle_t handle = NULL;
+  int from_shared;
+  int64_t shared_fill_time;
+  int shared_got;
+  int spins;
   uintptr_t readahead_len, readahead_skip;
   int ra;
 #ifdef TIME
@@ -2400,10 +2941,14 @@ void cache_get(struct rdcache_s* cache,
             printf("%li ns waiting for %p\n", time_duration(&wait1, &wait2), (void*) ra_page);
 #endif
           }
+          // A prefetched page is complete now, so it can be shared.
+          if( entry->shared_fill_time != NO_SHARED_FILL )
+            shared_publish_entry(entry);
         }
         // If the cache line is in Am, move it to the front of Am.
         use_entry(cache, entry);
         if( ! isprefetch ) {
+          cache->stats.get_hits++;
       
           //printf("cache hit on page %i:%p %p ra_len %i\n", 
           //       node, (void*) ra_page, (void*) requested_start,
@@ -2428,6 +2973,7 @@ void cache_get(struct rdcache_s* cache,
                                         readahead_skip,
                                         readahead_len,
                                         last_acquire,
+                                        last_shared_acquire,
                                         ln, fn);
             entry = NULL; // note trigger readahead could evict entry...
           }
@@ -2455,11 +3001,44 @@ void cache_get(struct rdcache_s* cache,
 
     // Otherwise -- start a get !
 
+    if( ! isprefetch ) cache->stats.get_misses++;
+
     if( ! page ) {
       // get a page from the free list.
       page = allocate_page(cache);
     }
 
+    // If this pthread's cache has nothing usable for the page (and has
+    // not written to it), see if the shared tier has it. If not, get the
+    // whole page so that it can be published to the shared tier.
+    from_shared = 0;
+    shared_fill_time = NO_SHARED_FILL;
+    if( cache_shared_enabled &&
+        ( ! entry || ( ! entry_after_acquire && ! entry->written ) ) ) {
+      ra_line = ra_page;
+      ra_line_end = ra_page + CACHEPAGE_SIZE;
+      shared_got = shared_lookup(node, ra_page, last_shared_acquire, page);
+      for( spins = 0;
+           shared_got == SHARED_FILLING && ! isprefetch &&
+           spins < SHARED_FILL_SPINS;
+           spins++ ) {
+        sched_yield();
+        shared_got = shared_lookup(node, ra_page, last_shared_acquire, page);
+      }
+      if( shared_got == SHARED_HIT ) {
+        cache->stats.shared_hits++;
+        from_shared = 1;
+      } else if( shared_got == SHARED_FILLING && isprefetch ) {
+        // Another pthread is already getting this page.
+        if( ! entry ) free_page(cache, page);
+        continue;
+      } else {
+        cache->stats.shared_misses++;
+        shared_fill_time = shared_fill_epoch();
+        shared_claim(node, ra_page, shared_fill_time);
+      }
+    }
+
     // Now we need to start a get into page.
     // If we don't have entry set, we will also need to plumb
     // it into the tree while we are awaiting our get.
@@ -2471,11 +3050,14 @@ void cache_get(struct rdcache_s* cache,
 #ifdef TIME
     clock_gettime(CLOCK_REALTIME, &start_get1);
 #endif
-    handle = 
-      chpl_comm_get_nb(page+(ra_line-ra_page), /*local addr*/
-                       node, (void*) ra_line, 1 /*elmsize*/, -1/*typei*/,
-                       ra_line_end - ra_line /*len*/,
-                       ln, fn);
+    if( ! from_shared ) {
+      handle = 
+        chpl_comm_get_nb(page+(ra_line-ra_page), /*local addr*/
+                         node, (void*) ra_line, 1 /*elmsize*/, -1/*typei*/,
+                         ra_line_end - ra_line /*len*/,
+                         ln, fn);
+      cache->stats.remote_gets++;
+    }
 #ifdef TIME
     clock_gettime(CLOCK_REALTIME, &start_get2);
 #endif
@@ -2487,13 +3069,14 @@ void cache_get(struct rdcache_s* cache,
     } else {
       entry = make_entry(cache, node, ra_page, page);
     }
+    entry->shared_fill_time = shared_fill_time;
 
     // Set the valid lines
     set_valid_lines(entry->valid_lines,
                     (ra_line - ra_page) >> CACHELINE_BITS,
                     (ra_line_end - ra_line) >> CACHELINE_BITS);
 
-    if( ! isprefetch ) {
+    if( ! isprefetch || from_shared ) {
       // This will increment next request number so cache events are recorded.
       sn = cache->next_request_number;
       cache->next_request_number++;
@@ -2556,7 +3139,11 @@ void cache_get(struct rdcache_s* cache,
       clock_gettime(CLOCK_REALTIME, &wait1);
 #endif
 
-      chpl_comm_nb_wait_some(&handle, 1);
+      if( ! from_shared ) {
+        chpl_comm_nb_wait_some(&handle, 1);
+        if( entry->shared_fill_time != NO_SHARED_FILL )
+          shared_publish_entry(entry);
+      }
 
 #ifdef TIME
       clock_gettime(CLOCK_REALTIME, &wait2);
@@ -2672,6 +3259,12 @@ static struct rdcache_s* cache_create(void);
 CHPL_TLS_DECL(struct rdcache_s*,cache_remote_data);
 static pthread_key_t pthread_cache_info_key; // stores struct rdcache_s*
 
+// All of the caches on this locale, so that their counters can be summed,
+// along with the summed counters of caches whose pthreads have exited.
+static pthread_mutex_t all_caches_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct rdcache_s* all_caches_head = NULL;
+static chpl_cache_stats_t exited_caches_stats;
+
 static
 struct rdcache_s* tls_cache_remote_data(void) {
   struct rdcache_s *cache = CHPL_TLS_GET(cache_remote_data);
@@ -2679,6 +3272,12 @@ struct rdcache_s* tls_cache_remote_data(void) {
     cache = cache_create();
     CHPL_TLS_SET(cache_remote_data, cache);
     pthread_setspecific(pthread_cache_info_key, cache);
+
+    pthread_mutex_lock(&all_caches_lock);
+    cache->all_caches_next = all_caches_head;
+    if( all_caches_head ) all_caches_head->all_caches_prev = cache;
+    all_caches_head = cache;
+    pthread_mutex_unlock(&all_caches_lock);
   }
   return cache;
 }
@@ -2690,10 +3289,31 @@ chpl_cache_taskPrvData_t* task_private_cache_data(void)
   return &task_local->comm_data.cache_data;
 }
 
+static
+void stats_add(chpl_cache_stats_t* sum, const chpl_cache_stats_t* x)
+{
+  sum->get_hits += x->get_hits;
+  sum->get_misses += x->get_misses;
+  sum->shared_hits += x->shared_hits;
+  sum->shared_misses += x->shared_misses;
+  sum->ghost_hits += x->ghost_hits;
+  sum->evictions += x->evictions;
+  sum->remote_gets += x->remote_gets;
+  sum->remote_puts += x->remote_puts;
+}
+
 static
 void destroy_pthread_local_cache(void* arg)
 {
   struct rdcache_s* s = (struct rdcache_s*) arg;
+
+  pthread_mutex_lock(&all_caches_lock);
+  stats_add(&exited_caches_stats, &s->stats);
+  if( s->all_caches_prev ) s->all_caches_prev->all_caches_next = s->all_caches_next;
+  else all_caches_head = s->all_caches_next;
+  if( s->all_caches_next ) s->all_caches_next->all_caches_prev = s->all_caches_prev;
+  pthread_mutex_unlock(&all_caches_lock);
+
   cache_destroy(s);
 }
 
@@ -2716,6 +3336,8 @@ void chpl_cache_do_init(void)
     // The second key we never read but create so that we
     // can free the cache when the thread exits.
     pthread_key_create(&pthread_cache_info_key, &destroy_pthread_local_cache);
+
+    if( cache_shared_enabled ) shared_create();
     inited = 1;
   }
 }
@@ -2723,6 +3345,7 @@ void chpl_cache_do_init(void)
 // The implementation of functions in chpl-cache.h
 
 void chpl_cache_init(void) {
+  char* p;
 
   // Take default CHPL_CACHE_REMOTE value from the environment if it is set.
   /*char* p;
@@ -2742,6 +3365,22 @@ void chpl_cache_init(void) {
     return;
   }
 
+  if ((p = getenv("CHPL_RT_CACHE_POLICY")) != NULL) {
+    if( strcmp(p, "arc") == 0 || strcmp(p, "ARC") == 0 )
+      cache_policy = CACHE_POLICY_ARC;
+    else if( strcmp(p, "2q") == 0 || strcmp(p, "2Q") == 0 )
+      cache_policy = CACHE_POLICY_2Q;
+    else
+      chpl_warning("unknown setting for CHPL_RT_CACHE_POLICY, try 2q or arc",
+                   0, NULL);
+  }
+
+  if ((p = getenv("CHPL_RT_CACHE_SHARED")) != NULL) {
+    cache_shared_enabled = (strcmp(p, "0") != 0
+                            && strcmp(p, "no") != 0
+                            && strcmp(p, "false") != 0);
+  }
+
   //printf("CACHE IS ENABLED\n");
   chpl_cache_do_init();
 }
@@ -2772,6 +3411,9 @@ void chpl_cache_fence(int acquire, int release, int ln, c_string fn)
     if( acquire ) {
       task_local->last_acquire = cache->next_request_number;
       cache->next_request_number++;
+      if( cache_shared_enabled ) {
+        task_local->last_shared_acquire = shared_new_epoch();
+      }
     }
 
     if( release ) {
@@ -2825,7 +3467,7 @@ void chpl_cache_comm_get(void *addr, c_nodeid_t node, void* raddr,
 #endif
 
   //saturating_increment(&info->get_since_acquire);
-  cache_get(cache, addr, node, (raddr_t) raddr, size, task_local->last_acquire, 0, ln, fn);
+  cache_get(cache, addr, node, (raddr_t) raddr, size, task_local->last_acquire, task_local->last_shared_acquire, 0, ln, fn);
   return;
 }
 
@@ -2841,21 +3483,251 @@ void chpl_cache_comm_prefetch(c_nodeid_t node, void* raddr,
     printf("%d: %s:%d: remote prefetch from %d\n", chpl_nodeID, fn?fn:"", ln, node);
   // Always use the cache for prefetches.
   //saturating_increment(&info->prefetch_since_acquire);
-  cache_get(cache, NULL, node, (raddr_t) raddr, size, task_local->last_acquire, 0, ln, fn);
+  cache_get(cache, NULL, node, (raddr_t) raddr, size, task_local->last_acquire, task_local->last_shared_acquire, 0, ln, fn);
+}
+
+// Strided and indexed transfers are walked one run of contiguous bytes
+// at a time. The remote side of a run is always node:remote, and the
+// local side is local. Adjacent pieces are merged into one run.
+struct xfer_iter_s {
+  // For a strided transfer, the strides and counts as for
+  // chpl_comm_get_strd, but all in bytes. idx[1..levels] is the next piece.
+  int levels;
+  const size_t* local_str;
+  const size_t* remote_str;
+  const size_t* cnt;
+  size_t* idx;
+  // For an indexed transfer, the remote address of each element.
+  void** remote_addrs;
+  size_t elem_size;
+  size_t num_elems;
+  size_t elem; // the next element
+  unsigned char* local_base;
+  raddr_t remote_base;
+  // The next piece, which did not fit in the current run.
+  int has_next;
+  unsigned char* next_local;
+  raddr_t next_remote;
+  size_t next_len;
+  // The current run
+  int done;
+  unsigned char* local;
+  raddr_t remote;
+  size_t len;
+};
+
+// Stores the next piece in it->next_*. Returns 0 if there is none.
+static
+int xfer_piece(struct xfer_iter_s* it)
+{
+  size_t local_off, remote_off;
+  int i;
+
+  if( it->remote_addrs ) {
+    if( it->elem >= it->num_elems ) return 0;
+    it->next_local = it->local_base + it->elem * it->elem_size;
+    it->next_remote = (raddr_t) it->remote_addrs[it->elem];
+    it->next_len = it->elem_size;
+    it->elem++;
+    return 1;
+  }
+
+  // idx[0] is set once the last piece has been returned.
+  if( it->idx[0] ) return 0;
+
+  local_off = 0;
+  remote_off = 0;
+  for( i = 1; i <= it->levels; i++ ) {
+    local_off += it->idx[i] * it->local_str[i-1];
+    remote_off += it->idx[i] * it->remote_str[i-1];
+  }
+  it->next_local = it->local_base + local_off;
+  it->next_remote = it->remote_base + remote_off;
+  it->next_len = it->cnt[0];
+
+  for( i = 1; i <= it->levels; i++ ) {
+    if( ++it->idx[i] < it->cnt[i] ) break;
+    it->idx[i] = 0;
+  }
+  if( i > it->levels ) it->idx[0] = 1;
+  return 1;
+}
+
+// Moves on to the next run, or sets it->done if there are no more.
+static
+void xfer_next(struct xfer_iter_s* it)
+{
+  if( ! it->has_next ) {
+    it->done = 1;
+    return;
+  }
+
+  it->local = it->next_local;
+  it->remote = it->next_remote;
+  it->len = it->next_len;
+
+  while( (it->has_next = xfer_piece(it)) ) {
+    if( it->next_local != it->local + it->len ||
+        it->next_remote != it->remote + it->len ) break;
+    it->len += it->next_len;
+  }
+}
+
+static
+void xfer_start(struct xfer_iter_s* it)
+{
+  it->done = 0;
+  it->elem = 0;
+  if( ! it->remote_addrs ) memset(it->idx, 0, (it->levels+1)*sizeof(size_t));
+  it->has_next = xfer_piece(it);
+  xfer_next(it);
+}
+
+// How many cache pages does a run touch?
+static inline
+int xfer_run_pages(struct xfer_iter_s* it)
+{
+  return ((it->remote + it->len - 1) >> CACHEPAGE_BITS) -
+         (it->remote >> CACHEPAGE_BITS) + 1;
+}
+
+// Returns the number of bytes a transfer moves, or 0 if it should not go
+// through the cache because it moves nothing or would push out most of it.
+static
+size_t xfer_cached_size(struct xfer_iter_s* it)
+{
+  size_t total;
+  int i;
+
+  if( it->remote_addrs ) {
+    total = it->elem_size * it->num_elems;
+  } else {
+    total = it->cnt[0];
+    for( i = 1; i <= it->levels; i++ ) total *= it->cnt[i];
+  }
+
+  if( total > (size_t) cache_num_pages() * CACHEPAGE_SIZE / 4 ) return 0;
+  return total;
 }
+
+// How many pages of a GET transfer should be prefetched ahead of
+// the run we are waiting for?
+#define XFER_PREFETCH_PAGES MAX_PENDING
+
+static
+void cache_get_xfer(struct rdcache_s* cache,
+                    chpl_cache_taskPrvData_t* task_local,
+                    c_nodeid_t node, struct xfer_iter_s* it,
+                    struct xfer_iter_s* ahead,
+                    int ln, c_string fn)
+{
+  int ahead_pages = 0;
+
+  xfer_start(it);
+  xfer_start(ahead);
+
+  while( ! it->done ) {
+    // Keep prefetches for the next few pages in flight.
+    while( ! ahead->done && ahead_pages < XFER_PREFETCH_PAGES ) {
+      cache_get(cache, NULL, node, ahead->remote, (int32_t) ahead->len,
+                task_local->last_acquire, task_local->last_shared_acquire,
+                0, ln, fn);
+      ahead_pages += xfer_run_pages(ahead);
+      xfer_next(ahead);
+    }
+
+    cache_get(cache, it->local, node, it->remote, (int32_t) it->len,
+              task_local->last_acquire, task_local->last_shared_acquire,
+              0, ln, fn);
+    ahead_pages -= xfer_run_pages(it);
+    xfer_next(it);
+  }
+}
+
+static
+void cache_put_xfer(struct rdcache_s* cache,
+                    chpl_cache_taskPrvData_t* task_local,
+                    c_nodeid_t node, struct xfer_iter_s* it,
+                    int ln, c_string fn)
+{
+  for( xfer_start(it); ! it->done; xfer_next(it) ) {
+    cache_put(cache, it->local, node, it->remote, (int32_t) it->len,
+              task_local->last_acquire, ln, fn);
+  }
+}
+
+// Fills in the parts of it for a strided transfer described as for
+// chpl_comm_get_strd. The arrays must have room for strlevels (+1) entries.
+static
+void xfer_init_strd(struct xfer_iter_s* it,
+                    void* local, void* local_strides,
+                    void* remote, void* remote_strides,
+                    void* count, int32_t strlevels, int32_t elemSize,
+                    size_t* local_str, size_t* remote_str, size_t* cnt,
+                    size_t* idx)
+{
+  int i;
+
+  // Only count[0] and strides are measured in number of bytes.
+  cnt[0] = ((int32_t*)count)[0] * (size_t) elemSize;
+  for( i = 0; i < strlevels; i++ ) {
+    local_str[i] = ((int32_t*)local_strides)[i] * (size_t) elemSize;
+    remote_str[i] = ((int32_t*)remote_strides)[i] * (size_t) elemSize;
+    cnt[i+1] = ((int32_t*)count)[i+1];
+  }
+
+  it->levels = strlevels;
+  it->local_str = local_str;
+  it->remote_str = remote_str;
+  it->cnt = cnt;
+  it->idx = idx;
+  it->remote_addrs = NULL;
+  it->local_base = (unsigned char*) local;
+  it->remote_base = (raddr_t) remote;
+}
+
+static
+void xfer_init_idx(struct xfer_iter_s* it, void* local, void** raddrs,
+                   int32_t elemSize, int32_t len)
+{
+  it->levels = 0;
+  it->remote_addrs = raddrs;
+  it->elem_size = elemSize;
+  it->num_elems = len;
+  it->local_base = (unsigned char*) local;
+  it->remote_base = 0;
+}
+
 void  chpl_cache_comm_get_strd(
                    void *addr, void *dststr, c_nodeid_t node, void *raddr,
                    void *srcstr, void *count, int32_t strlevels, 
                    int32_t elemSize, int32_t typeIndex,
                    int ln, c_string fn) {
+  struct rdcache_s* cache = tls_cache_remote_data();
+  chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
+  struct xfer_iter_s it, ahead;
+  size_t local_str[strlevels+1], remote_str[strlevels+1], cnt[strlevels+1];
+  size_t idx[strlevels+1], ahead_idx[strlevels+1];
   TRACE_PRINT(("%d: in chpl_cache_comm_get_strd\n", chpl_nodeID));
+
+  xfer_init_strd(&it, addr, dststr, raddr, srcstr, count, strlevels,
+                 elemSize, local_str, remote_str, cnt, idx);
+
+  if( node != chpl_nodeID && xfer_cached_size(&it) ) {
+    if (chpl_verbose_comm)
+      printf("%d: %s:%d: remote strided get from %d\n", chpl_nodeID, fn?fn:"", ln, node);
+    ahead = it;
+    ahead.idx = ahead_idx;
+    cache_get_xfer(cache, task_local, node, &it, &ahead, ln, fn);
+    return;
+  }
+
+  // This transfer is too large to go through the cache.
   // do a full fence - so that:
   // 1) any pending writes are completed (in case they were to the
   //    same location handled by the strided get)
   // 2) the cache does not have older values than what we're getting now
   // Alternatively, we could invalidate the requested regions.
-  // Alternatively, the strided get could be done through the cache
-  // system. This is just the current (possibly temporary) solution.
   chpl_cache_fence(1, 1, ln, fn);
   // do the strided get.
 #ifdef CHPL_TASK_COMM_GET_STRD
@@ -2869,14 +3741,30 @@ void  chpl_cache_comm_put_strd(
                       void *srcstr, void *count, int32_t strlevels, 
                       int32_t elemSize, int32_t typeIndex,
                       int ln, c_string fn) {
+  struct rdcache_s* cache = tls_cache_remote_data();
+  chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
+  struct xfer_iter_s it;
+  size_t local_str[strlevels+1], remote_str[strlevels+1], cnt[strlevels+1];
+  size_t idx[strlevels+1];
   TRACE_PRINT(("%d: in chpl_cache_comm_put_strd\n", chpl_nodeID));
+
+  // Note that for a put, addr/dststr is the remote side.
+  xfer_init_strd(&it, raddr, srcstr, addr, dststr, count, strlevels,
+                 elemSize, local_str, remote_str, cnt, idx);
+
+  if( node != chpl_nodeID && xfer_cached_size(&it) ) {
+    if (chpl_verbose_comm)
+      printf("%d: %s:%d: remote strided put to %d\n", chpl_nodeID, fn?fn:"", ln, node);
+    cache_put_xfer(cache, task_local, node, &it, ln, fn);
+    return;
+  }
+
+  // This transfer is too large to go through the cache.
   // do a full fence - so that:
   // 1) any pending writes are completed (in case they were to the
   //    same location handled by the strided put and would
   //    complete in the wrong order)
   // 2) the cache does not keep older values from before the put.
-  // Alternatively, the strided put could be done through the cache
-  // system. This is just the current (possibly temporary) solution.
   chpl_cache_fence(1, 1, ln, fn);
   // do the strided put.
 #ifdef CHPL_TASK_COMM_PUT_STRD
@@ -2886,6 +3774,67 @@ void  chpl_cache_comm_put_strd(
 #endif
 }
 
+void chpl_cache_comm_get_idx(void* addr, c_nodeid_t node, void** raddrs,
+                             int32_t elemSize, int32_t typeIndex, int32_t len,
+                             int ln, c_string fn)
+{
+  struct rdcache_s* cache = tls_cache_remote_data();
+  chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
+  struct xfer_iter_s it, ahead;
+  int32_t i;
+  TRACE_PRINT(("%d: in chpl_cache_comm_get_idx\n", chpl_nodeID));
+
+  xfer_init_idx(&it, addr, raddrs, elemSize, len);
+
+  if( xfer_cached_size(&it) ) {
+    if (chpl_verbose_comm)
+      printf("%d: %s:%d: remote indexed get from %d\n", chpl_nodeID, fn?fn:"", ln, node);
+    ahead = it;
+    cache_get_xfer(cache, task_local, node, &it, &ahead, ln, fn);
+    return;
+  }
+
+  // This transfer is too large to go through the cache.
+  chpl_cache_fence(1, 1, ln, fn);
+  for( i = 0; i < len; i++ ) {
+#ifdef CHPL_TASK_COMM_GET
+    chpl_task_comm_get((unsigned char*) addr + i * elemSize, node, raddrs[i], elemSize, typeIndex, 1, ln, fn);
+#else
+    chpl_comm_get((unsigned char*) addr + i * elemSize, node, raddrs[i], elemSize, typeIndex, 1, ln, fn);
+#endif
+  }
+}
+
+void chpl_cache_comm_put_idx(void* addr, c_nodeid_t node, void** raddrs,
+                             int32_t elemSize, int32_t typeIndex, int32_t len,
+                             int ln, c_string fn)
+{
+  struct rdcache_s* cache = tls_cache_remote_data();
+  chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
+  struct xfer_iter_s it;
+  int32_t i;
+  TRACE_PRINT(("%d: in chpl_cache_comm_put_idx\n", chpl_nodeID));
+
+  xfer_init_idx(&it, addr, raddrs, elemSize, len);
+
+  if( xfer_cached_size(&it) ) {
+    if (chpl_verbose_comm)
+      printf("%d: %s:%d: remote indexed put to %d\n", chpl_nodeID, fn?fn:"", ln, node);
+    cache_put_xfer(cache, task_local, node, &it, ln, fn);
+    return;
+  }
+
+  // This transfer is too large to go through the cache.
+  chpl_cache_fence(1, 1, ln, fn);
+  for( i = 0; i < len; i++ ) {
+#ifdef CHPL_TASK_COMM_PUT
+    chpl_task_comm_put((unsigned char*) addr + i * elemSize, node, raddrs[i], elemSize, typeIndex, 1, ln, fn);
+#else
+    chpl_comm_put((unsigned char*) addr + i * elemSize, node, raddrs[i], elemSize, typeIndex, 1, ln, fn);
+#endif
+  }
+}
+
 void chpl_cache_print(void)
 {
   struct rdcache_s* cache = tls_cache_remote_data();
@@ -2894,6 +3843,56 @@ void chpl_cache_print(void)
   rdcache_print(cache);
 }
 
+void chpl_cache_get_stats(chpl_cache_stats_t* stats)
+{
+  struct rdcache_s* cache;
+
+  memset(stats, 0, sizeof(chpl_cache_stats_t));
+  if( ! CHPL_CACHE_REMOTE ) return;
+
+  // The counters of running pthreads are read without synchronization,
+  // so the sums are only approximate while other tasks use the cache.
+  pthread_mutex_lock(&all_caches_lock);
+  stats_add(stats, &exited_caches_stats);
+  for( cache = all_caches_head; cache; cache = cache->all_caches_next ) {
+    stats_add(stats, &cache->stats);
+  }
+  pthread_mutex_unlock(&all_caches_lock);
+}
+
+void chpl_cache_reset_stats(void)
+{
+  struct rdcache_s* cache;
+
+  if( ! CHPL_CACHE_REMOTE ) return;
+
+  pthread_mutex_lock(&all_caches_lock);
+  memset(&exited_caches_stats, 0, sizeof(chpl_cache_stats_t));
+  for( cache = all_caches_head; cache; cache = cache->all_caches_next ) {
+    memset(&cache->stats, 0, sizeof(chpl_cache_stats_t));
+  }
+  pthread_mutex_unlock(&all_caches_lock);
+}
+
+void chpl_cache_print_stats(void)
+{
+  chpl_cache_stats_t stats;
+
+  chpl_cache_get_stats(&stats);
+  printf("%d: cache (%s%s) get hits %" PRIu64 " misses %" PRIu64
+         " shared hits %" PRIu64 " shared misses %" PRIu64
+         " ghost hits %" PRIu64 " evictions %" PRIu64
+         " remote gets %" PRIu64 " remote puts %" PRIu64 "\n",
+         chpl_nodeID,
+         cache_policy == CACHE_POLICY_ARC ? "arc" : "2q",
+         cache_shared_enabled ? ", shared" : "",
+         stats.get_hits, stats.get_misses,
+         stats.shared_hits, stats.shared_misses,
+         stats.ghost_hits, stats.evictions,
+         stats.remote_gets, stats.remote_puts);
+  fflush(stdout);
+}
+
 /*
 // Turn the cache on or off for debug purposes.
 void chpl_cache_set_enabled(int enabled)
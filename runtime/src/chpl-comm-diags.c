@@ -0,0 +1,468 @@
+/*
+ * Copyright 2004-2014 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Communication diagnostics and the call site profile, shared by the
+// comm layers.  See chpl-comm-diags.h.
+//
+#include "chplrt.h"
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-comm-diags.h"
+#include "chpl-mem.h"
+#include "chpl-thread-local-storage.h"
+#include "error.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int chpl_comm_profile = 0;
+
+static c_string profile_file = NULL;   // from CHPL_RT_COMM_PROFILE
+
+static const char* profile_op_names[CHPL_COMM_PROFILE_NUM_OPS] = {
+  "get", "get_nb", "get_strd",
+  "put", "put_nb", "put_strd",
+  "fork", "fork_fast", "fork_nb"
+};
+
+// One call site.  The destination histogram has a count and a byte
+// total for each locale.
+typedef struct {
+  c_string  fn;             // NULL for an unused slot
+  int       ln;
+  int       op;
+  uint64_t* dest;           // 2 * chpl_numNodes: count, bytes, ...
+} site_t;
+
+typedef struct diags_thread_s {
+  chpl_commDiagnostics   counters;
+  atomic_flag            lock;       // guards the sites
+  site_t*                sites;      // open addressing, power of 2
+  int                    size;
+  int                    used;
+  struct diags_thread_s* next;       // on the list of all of them
+} diags_thread_t;
+
+CHPL_TLS_DECL(diags_thread_t*, diags_thread);
+
+// Every pthread's state.  Entries are only ever added at the head,
+// and are never removed.
+static pthread_mutex_t diags_threads_lock = PTHREAD_MUTEX_INITIALIZER;
+static diags_thread_t* diags_threads = NULL;
+
+// The counts at the last reset, guarded by diags_threads_lock.
+static chpl_commDiagnostics diags_base;
+
+static const char unknown_fn[] = "<unknown>";
+
+
+static diags_thread_t* diags_this_thread(void) {
+  diags_thread_t* t = CHPL_TLS_GET(diags_thread);
+
+  if (t == NULL) {
+    t = (diags_thread_t*) chpl_mem_calloc(sizeof(*t),
+                                          CHPL_RT_MD_COMM_DIAGNOSTICS_DATA,
+                                          0, 0);
+    atomic_flag_clear(&t->lock);
+
+    pthread_mutex_lock(&diags_threads_lock);
+    t->next = diags_threads;
+    diags_threads = t;
+    pthread_mutex_unlock(&diags_threads_lock);
+
+    CHPL_TLS_SET(diags_thread, t);
+  }
+
+  return t;
+}
+
+static diags_thread_t* diags_all_threads(void) {
+  diags_thread_t* t;
+
+  pthread_mutex_lock(&diags_threads_lock);
+  t = diags_threads;
+  pthread_mutex_unlock(&diags_threads_lock);
+  return t;
+}
+
+static void diags_lock(diags_thread_t* t) {
+  while (atomic_flag_test_and_set(&t->lock))
+    ;
+}
+
+static void diags_unlock(diags_thread_t* t) {
+  atomic_flag_clear(&t->lock);
+}
+
+
+chpl_commDiagnostics* chpl_comm_diags_thread_counters(void) {
+  return &diags_this_thread()->counters;
+}
+
+#define DIAGS_FIELDS(m)                                                 \
+  m(get) m(get_nb) m(get_nb_test) m(get_nb_wait)                        \
+  m(put) m(put_nb) m(fork) m(fork_fast) m(fork_nb)
+
+static void diags_sum(chpl_commDiagnostics* cd) {
+  diags_thread_t* t;
+
+  memset(cd, 0, sizeof(*cd));
+  for (t = diags_all_threads(); t != NULL; t = t->next) {
+#define DIAGS_ADD(f) cd->f += t->counters.f;
+    DIAGS_FIELDS(DIAGS_ADD)
+#undef DIAGS_ADD
+  }
+}
+
+void chpl_comm_diags_reset(void) {
+  chpl_commDiagnostics cd;
+
+  diags_sum(&cd);
+  pthread_mutex_lock(&diags_threads_lock);
+  diags_base = cd;
+  pthread_mutex_unlock(&diags_threads_lock);
+}
+
+void chpl_comm_diags_copy(chpl_commDiagnostics* cd) {
+  diags_sum(cd);
+  pthread_mutex_lock(&diags_threads_lock);
+#define DIAGS_SUB(f) cd->f -= diags_base.f;
+  DIAGS_FIELDS(DIAGS_SUB)
+#undef DIAGS_SUB
+  pthread_mutex_unlock(&diags_threads_lock);
+}
+
+
+//
+// Call site profile
+//
+
+static unsigned int site_hash(int op, int ln, c_string fn) {
+  uintptr_t h = (uintptr_t) fn;
+
+  h ^= h >> 17;
+  h += (uintptr_t) ln * 2654435761u;
+  h += (uintptr_t) op * 40503u;
+  return (unsigned int) (h ^ (h >> 15));
+}
+
+// Returns the slot for the site in sites[size], which may be unused.
+static site_t* site_find(site_t* sites, int size,
+                         int op, int ln, c_string fn) {
+  unsigned int i = site_hash(op, ln, fn) & (size - 1);
+
+  while (sites[i].fn != NULL
+         && (sites[i].fn != fn || sites[i].ln != ln || sites[i].op != op))
+    i = (i + 1) & (size - 1);
+  return &sites[i];
+}
+
+static void sites_grow(diags_thread_t* t) {
+  int     new_size = (t->size == 0) ? 64 : 2 * t->size;
+  site_t* new_sites;
+  int     i;
+
+  new_sites = (site_t*) chpl_mem_allocManyZero(new_size, sizeof(site_t),
+                                               CHPL_RT_MD_COMM_DIAGNOSTICS_DATA,
+                                               0, 0);
+  for (i = 0; i < t->size; i++) {
+    site_t* s = &t->sites[i];
+    if (s->fn != NULL)
+      *site_find(new_sites, new_size, s->op, s->ln, s->fn) = *s;
+  }
+  if (t->sites != NULL)
+    chpl_mem_free(t->sites, 0, 0);
+  t->sites = new_sites;
+  t->size = new_size;
+}
+
+void chpl_comm_profile_record(chpl_comm_profile_op_t op, c_nodeid_t node,
+                              size_t bytes, int ln, c_string fn) {
+  diags_thread_t* t = diags_this_thread();
+  site_t*         s;
+
+  if (fn == NULL || fn[0] == '\0') {
+    fn = unknown_fn;
+    ln = 0;
+  }
+
+  diags_lock(t);
+  if (2 * (t->used + 1) > t->size)
+    sites_grow(t);
+  s = site_find(t->sites, t->size, op, ln, fn);
+  if (s->fn == NULL) {
+    s->fn = fn;
+    s->ln = ln;
+    s->op = op;
+    s->dest = (uint64_t*) chpl_mem_allocManyZero(2 * chpl_numNodes,
+                                                 sizeof(uint64_t),
+                                              CHPL_RT_MD_COMM_DIAGNOSTICS_DATA,
+                                                 0, 0);
+    t->used++;
+  }
+  s->dest[2 * node]++;
+  s->dest[2 * node + 1] += bytes;
+  diags_unlock(t);
+}
+
+void chpl_startCommProfileHere(void) {
+  chpl_comm_profile = 1;
+}
+
+void chpl_stopCommProfileHere(void) {
+  chpl_comm_profile = 0;
+}
+
+void chpl_resetCommProfileHere(void) {
+  diags_thread_t* t;
+  int             i;
+
+  for (t = diags_all_threads(); t != NULL; t = t->next) {
+    diags_lock(t);
+    for (i = 0; i < t->size; i++) {
+      if (t->sites[i].fn != NULL)
+        memset(t->sites[i].dest, 0, 2 * chpl_numNodes * sizeof(uint64_t));
+    }
+    diags_unlock(t);
+  }
+}
+
+//
+// A call site merged across pthreads.  The same file name may be at
+// different addresses in different generated files, so sites are
+// merged by name.
+//
+typedef struct {
+  c_string  fn;
+  int       ln;
+  int       op;
+  uint64_t  count;
+  uint64_t  bytes;
+  uint64_t* dest;
+} merged_site_t;
+
+static int merged_site_cmp_loc(const void* v1, const void* v2) {
+  const merged_site_t* s1 = (const merged_site_t*) v1;
+  const merged_site_t* s2 = (const merged_site_t*) v2;
+  int                  c  = strcmp(s1->fn, s2->fn);
+
+  if (c != 0)
+    return c;
+  if (s1->ln != s2->ln)
+    return (s1->ln < s2->ln) ? -1 : 1;
+  return s1->op - s2->op;
+}
+
+static int merged_site_cmp_count(const void* v1, const void* v2) {
+  const merged_site_t* s1 = (const merged_site_t*) v1;
+  const merged_site_t* s2 = (const merged_site_t*) v2;
+
+  if (s1->count != s2->count)
+    return (s1->count > s2->count) ? -1 : 1;
+  return merged_site_cmp_loc(v1, v2);
+}
+
+// Returns the number of sites with a nonzero count, in *sites_p.
+// The caller frees *sites_p and each site's dest.
+static int profile_merge(merged_site_t** sites_p) {
+  diags_thread_t* t;
+  merged_site_t*  sites;
+  int             n = 0;
+  int             m;
+  int             i;
+  c_nodeid_t      node;
+
+  for (t = diags_all_threads(); t != NULL; t = t->next) {
+    diags_lock(t);
+    n += t->used;
+    diags_unlock(t);
+  }
+
+  // A pthread may add sites while we're copying; those just get
+  // left out.
+  sites = (merged_site_t*) chpl_mem_allocManyZero(n + 1, sizeof(*sites),
+                                              CHPL_RT_MD_COMM_DIAGNOSTICS_DATA,
+                                                  0, 0);
+  m = 0;
+  for (t = diags_all_threads(); t != NULL; t = t->next) {
+    diags_lock(t);
+    for (i = 0; i < t->size && m < n; i++) {
+      site_t* s = &t->sites[i];
+      if (s->fn == NULL)
+        continue;
+      sites[m].fn = s->fn;
+      sites[m].ln = s->ln;
+      sites[m].op = s->op;
+      sites[m].dest = (uint64_t*)
+                      chpl_mem_allocMany(2 * chpl_numNodes, sizeof(uint64_t),
+                                         CHPL_RT_MD_COMM_DIAGNOSTICS_DATA,
+                                         0, 0);
+      chpl_memcpy(sites[m].dest, s->dest,
+                  2 * chpl_numNodes * sizeof(uint64_t));
+      m++;
+    }
+    diags_unlock(t);
+  }
+
+  if (m > 0)
+    qsort(sites, m, sizeof(*sites), merged_site_cmp_loc);
+
+  n = 0;
+  for (i = 0; i < m; i++) {
+    if (n > 0 && merged_site_cmp_loc(&sites[n - 1], &sites[i]) == 0) {
+      for (node = 0; node < 2 * chpl_numNodes; node++)
+        sites[n - 1].dest[node] += sites[i].dest[node];
+      chpl_mem_free(sites[i].dest, 0, 0);
+    } else {
+      sites[n++] = sites[i];
+    }
+  }
+
+  m = n;
+  n = 0;
+  for (i = 0; i < m; i++) {
+    sites[i].count = sites[i].bytes = 0;
+    for (node = 0; node < chpl_numNodes; node++) {
+      sites[i].count += sites[i].dest[2 * node];
+      sites[i].bytes += sites[i].dest[2 * node + 1];
+    }
+    if (sites[i].count == 0)
+      chpl_mem_free(sites[i].dest, 0, 0);
+    else
+      sites[n++] = sites[i];
+  }
+
+  if (n > 0)
+    qsort(sites, n, sizeof(*sites), merged_site_cmp_count);
+
+  *sites_p = sites;
+  return n;
+}
+
+static void profile_free(merged_site_t* sites, int n) {
+  int i;
+
+  for (i = 0; i < n; i++)
+    chpl_mem_free(sites[i].dest, 0, 0);
+  chpl_mem_free(sites, 0, 0);
+}
+
+void chpl_printCommProfileHere(void) {
+  merged_site_t* sites;
+  int            n = profile_merge(&sites);
+  int            i;
+  c_nodeid_t     node;
+
+  printf("==============================================================\n");
+  printf("Communication profile for locale %" FORMAT_c_nodeid_t "\n",
+         chpl_nodeID);
+  printf("==============================================================\n");
+  printf("%-9s  %-12s  %-14s  %s\n", "operation", "count", "bytes",
+         "location and destinations (locale:count)");
+  printf("==============================================================\n");
+  for (i = 0; i < n; i++) {
+    printf("%-9s  %-12" PRIu64 "  %-14" PRIu64 "  %s:%d ",
+           profile_op_names[sites[i].op], sites[i].count, sites[i].bytes,
+           sites[i].fn, sites[i].ln);
+    for (node = 0; node < chpl_numNodes; node++) {
+      if (sites[i].dest[2 * node] != 0)
+        printf(" %" FORMAT_c_nodeid_t ":%" PRIu64,
+               node, sites[i].dest[2 * node]);
+    }
+    printf("\n");
+  }
+  printf("==============================================================\n");
+  fflush(stdout);
+
+  profile_free(sites, n);
+}
+
+void chpl_comm_profile_write_csv(FILE* f) {
+  merged_site_t* sites;
+  int            n = profile_merge(&sites);
+  int            i;
+  c_nodeid_t     node;
+
+  fprintf(f, "locale,operation,file,line,destination,count,bytes\n");
+  for (i = 0; i < n; i++) {
+    for (node = 0; node < chpl_numNodes; node++) {
+      const char* p;
+
+      if (sites[i].dest[2 * node] == 0)
+        continue;
+      fprintf(f, "%" FORMAT_c_nodeid_t ",%s,\"", chpl_nodeID,
+              profile_op_names[sites[i].op]);
+      for (p = sites[i].fn; *p != '\0'; p++) {
+        if (*p == '"')
+          fputc('"', f);
+        fputc(*p, f);
+      }
+      fprintf(f, "\",%d,%" FORMAT_c_nodeid_t ",%" PRIu64 ",%" PRIu64 "\n",
+              sites[i].ln, node,
+              sites[i].dest[2 * node], sites[i].dest[2 * node + 1]);
+    }
+  }
+
+  profile_free(sites, n);
+}
+
+
+void chpl_comm_diags_init(void) {
+  CHPL_TLS_INIT(diags_thread);
+
+  if ((profile_file = getenv("CHPL_RT_COMM_PROFILE")) != NULL
+      && profile_file[0] != '\0')
+    chpl_comm_profile = 1;
+}
+
+void chpl_comm_diags_exit(void) {
+  char* filename;
+  FILE* f;
+
+  if (profile_file == NULL || profile_file[0] == '\0')
+    return;
+
+  chpl_comm_profile = 0;
+
+  filename = (char*) chpl_mem_allocMany(strlen(profile_file) + 16,
+                                        sizeof(char),
+                                        CHPL_RT_MD_COMM_DIAGNOSTICS_DATA,
+                                        0, 0);
+  if (chpl_numNodes == 1)
+    strcpy(filename, profile_file);
+  else
+    sprintf(filename, "%s.%" FORMAT_c_nodeid_t, profile_file, chpl_nodeID);
+
+  if ((f = fopen(filename, "w")) == NULL) {
+    char msg[256];
+    snprintf(msg, sizeof(msg),
+             "cannot open %s to write the communication profile", filename);
+    chpl_warning(msg, 0, NULL);
+  } else {
+    chpl_comm_profile_write_csv(f);
+    fclose(f);
+  }
+
+  chpl_mem_free(filename, 0, 0);
+}
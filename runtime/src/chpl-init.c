@@ -24,6 +24,7 @@
 #include "chplcast.h"
 #include "chplcgfns.h"
 #include "chpl-comm.h"
+#include "chpl-comm-diags.h"
 #include "chplexit.h"
 #include "chplio.h"
 #include "chpl-init.h"
@@ -31,6 +32,7 @@
 #include "chplmemtrack.h"
 #include "chpl-privatization.h"
 #include "chpl-tasks.h"
+#include "chpl-topo.h"
 #include "chplsys.h"
 #include "config.h"
 #include "error.h"
@@ -152,6 +154,7 @@ void chpl_rt_init(int argc, char* argv[]) {
   chpl_comm_init(&argc, &argv);
   chpl_mem_init();
   chpl_comm_post_mem_init();
+  chpl_comm_diags_init();
 
   chpl_comm_barrier("about to leave comm init code");
 
@@ -180,6 +183,11 @@ void chpl_rt_init(int argc, char* argv[]) {
     }
   }
 
+  //
+  // Find the NUMA domains, which the tasking layer needs to know about.
+  //
+  chpl_topo_init();
+
   //
   // Initialize the task management layer.
   //
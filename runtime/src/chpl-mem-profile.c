@@ -0,0 +1,602 @@
+/*
+ * Copyright 2004-2014 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Memory profile.  See chpl-mem-profile.h.
+//
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-mem-desc.h"
+#include "chpl-mem-profile.h"
+#include "chpl-thread-local-storage.h"
+#include "chpltypes.h"
+#include "error.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Like the memory tracking table, our own data comes straight from the
+// system allocator, so that it isn't itself profiled.
+//
+#undef malloc
+#undef calloc
+#undef free
+
+chpl_bool chpl_memProfile = false;
+
+static size_t sample_rate = 0;         // 0 means don't sample
+static int    num_descs;
+
+static const char unknown_fn[] = "--";
+
+// One call site in one thread.
+typedef struct {
+  c_string           fn;               // NULL for an unused slot
+  int32_t            ln;
+  chpl_mem_descInt_t desc;
+  uint64_t           count;
+  uint64_t           bytes;
+} site_t;
+
+typedef struct prof_thread_s {
+  uint64_t*             descs;         // count, bytes for each description
+  atomic_flag           lock;          // guards the sites
+  site_t*               sites;         // open addressing, power of 2
+  int                   size;
+  int                   used;
+  size_t                until_sample;  // bytes to go before the next sample
+  uint64_t              rand;          // for choosing the sample points
+  struct prof_thread_s* next;          // on the list of all of them
+} prof_thread_t;
+
+CHPL_TLS_DECL(prof_thread_t*, prof_thread);
+
+// Every pthread's counters.  Entries are only ever added at the head,
+// and are never removed.
+static pthread_mutex_t prof_threads_lock = PTHREAD_MUTEX_INITIALIZER;
+static prof_thread_t*  prof_threads = NULL;
+static uint64_t        prof_num_threads = 0;
+
+
+//
+// Samples are few, so everything about them is kept under one lock.
+// The sampled call sites are kept by name, and the samples themselves
+// by address.  A bitmap, small enough to stay in cache, says which
+// address buckets have anything in them.  Frees look at it without
+// the lock first; almost always the bucket is empty and there is
+// nothing more to do.  Nothing can be added to the bucket for the
+// block being freed while that block is still allocated, so this is
+// safe.
+//
+typedef struct sampled_site_s {
+  c_string               fn;
+  int32_t                ln;
+  chpl_mem_descInt_t     desc;
+  size_t                 live;         // estimated bytes now allocated
+  size_t                 high;         // most that has ever been
+  struct sampled_site_s* next;         // in its hash bucket
+} sampled_site_t;
+
+typedef struct sample_s {
+  void*            addr;
+  size_t           weight;             // bytes this sample stands for
+  sampled_site_t*  site;
+  struct sample_s* next;               // in its hash bucket, or unused
+} sample_t;
+
+#define NUM_SAMPLE_BUCKETS        65536
+#define NUM_SAMPLED_SITE_BUCKETS  1024
+
+static pthread_mutex_t   sample_lock = PTHREAD_MUTEX_INITIALIZER;
+static sample_t**        samples = NULL;
+static volatile uint64_t* sample_bits = NULL;
+static sample_t*         free_samples = NULL;
+static sampled_site_t*   sampled_sites[NUM_SAMPLED_SITE_BUCKETS];
+static size_t*           desc_live;    // live, high for each description
+static size_t            total_live = 0;
+static size_t            total_high = 0;
+
+
+static prof_thread_t* prof_this_thread(void) {
+  prof_thread_t* t = CHPL_TLS_GET(prof_thread);
+
+  if (t == NULL) {
+    if ((t = (prof_thread_t*) calloc(1, sizeof(*t))) == NULL)
+      return NULL;
+    if ((t->descs = (uint64_t*) calloc(2 * num_descs, sizeof(uint64_t)))
+        == NULL) {
+      free(t);
+      return NULL;
+    }
+    atomic_flag_clear(&t->lock);
+
+    pthread_mutex_lock(&prof_threads_lock);
+    t->rand = UINT64_C(0x9E3779B97F4A7C15) * ++prof_num_threads;
+    t->next = prof_threads;
+    prof_threads = t;
+    pthread_mutex_unlock(&prof_threads_lock);
+
+    CHPL_TLS_SET(prof_thread, t);
+  }
+
+  return t;
+}
+
+static prof_thread_t* prof_all_threads(void) {
+  prof_thread_t* t;
+
+  pthread_mutex_lock(&prof_threads_lock);
+  t = prof_threads;
+  pthread_mutex_unlock(&prof_threads_lock);
+  return t;
+}
+
+static void prof_lock(prof_thread_t* t) {
+  while (atomic_flag_test_and_set(&t->lock))
+    ;
+}
+
+static void prof_unlock(prof_thread_t* t) {
+  atomic_flag_clear(&t->lock);
+}
+
+
+static unsigned int site_hash(chpl_mem_descInt_t desc, int32_t ln,
+                              c_string fn) {
+  uintptr_t h = (uintptr_t) fn;
+
+  h ^= h >> 17;
+  h += (uintptr_t) ln * 2654435761u;
+  h += (uintptr_t) desc * 40503u;
+  return (unsigned int) (h ^ (h >> 15));
+}
+
+// Returns the slot for the site in sites[size], which may be unused.
+static site_t* site_find(site_t* sites, int size,
+                         chpl_mem_descInt_t desc, int32_t ln, c_string fn) {
+  unsigned int i = site_hash(desc, ln, fn) & (size - 1);
+
+  while (sites[i].fn != NULL
+         && (sites[i].fn != fn || sites[i].ln != ln || sites[i].desc != desc))
+    i = (i + 1) & (size - 1);
+  return &sites[i];
+}
+
+static chpl_bool sites_grow(prof_thread_t* t) {
+  int     new_size = (t->size == 0) ? 64 : 2 * t->size;
+  site_t* new_sites;
+  int     i;
+
+  if ((new_sites = (site_t*) calloc(new_size, sizeof(site_t))) == NULL)
+    return false;
+  for (i = 0; i < t->size; i++) {
+    site_t* s = &t->sites[i];
+    if (s->fn != NULL)
+      *site_find(new_sites, new_size, s->desc, s->ln, s->fn) = *s;
+  }
+  free(t->sites);
+  t->sites = new_sites;
+  t->size = new_size;
+  return true;
+}
+
+
+//
+// The distance to the next sample point is uniformly distributed
+// around the rate, so that allocation patterns that repeat with some
+// period aren't always sampled at the same place.
+//
+static size_t next_sample_interval(prof_thread_t* t) {
+  uint64_t x = t->rand;
+
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  t->rand = x;
+  return sample_rate / 2 + (size_t) (x % (sample_rate + 1));
+}
+
+static unsigned int sample_hash(void* addr) {
+  uint64_t key = ((uint64_t) (uintptr_t) addr) >> 4;
+  return (unsigned int) ((key * UINT64_C(0x9E3779B97F4A7C15)) >> 48);
+}
+
+// Call with sample_lock held.
+static sampled_site_t* sampled_site_get(chpl_mem_descInt_t desc, int32_t ln,
+                                        c_string fn) {
+  unsigned int    h = 2166136261u;
+  const char*     p;
+  sampled_site_t* ss;
+
+  for (p = fn; *p != '\0'; p++)
+    h = (h ^ (unsigned char) *p) * 16777619u;
+  h = (h ^ (unsigned int) ln * 2654435761u ^ (unsigned int) desc * 40503u)
+      % NUM_SAMPLED_SITE_BUCKETS;
+
+  for (ss = sampled_sites[h]; ss != NULL; ss = ss->next)
+    if (ss->ln == ln && ss->desc == desc && strcmp(ss->fn, fn) == 0)
+      return ss;
+
+  if ((ss = (sampled_site_t*) calloc(1, sizeof(*ss))) == NULL)
+    return NULL;
+  ss->fn = fn;
+  ss->ln = ln;
+  ss->desc = desc;
+  ss->next = sampled_sites[h];
+  sampled_sites[h] = ss;
+  return ss;
+}
+
+static void take_sample(void* addr, size_t size,
+                        chpl_mem_descInt_t desc, int32_t ln, c_string fn) {
+  size_t          weight = (size > sample_rate) ? size : sample_rate;
+  unsigned int    b = sample_hash(addr);
+  sample_t*       s;
+  sampled_site_t* ss;
+
+  pthread_mutex_lock(&sample_lock);
+
+  if ((ss = sampled_site_get(desc, ln, fn)) == NULL) {
+    pthread_mutex_unlock(&sample_lock);
+    return;
+  }
+  if ((s = free_samples) != NULL)
+    free_samples = s->next;
+  else if ((s = (sample_t*) malloc(sizeof(*s))) == NULL) {
+    pthread_mutex_unlock(&sample_lock);
+    return;
+  }
+
+  s->addr = addr;
+  s->weight = weight;
+  s->site = ss;
+  s->next = samples[b];
+  samples[b] = s;
+  sample_bits[b / 64] |= UINT64_C(1) << (b % 64);
+
+  if ((ss->live += weight) > ss->high)
+    ss->high = ss->live;
+  if ((desc_live[2 * desc] += weight) > desc_live[2 * desc + 1])
+    desc_live[2 * desc + 1] = desc_live[2 * desc];
+  if ((total_live += weight) > total_high)
+    total_high = total_live;
+
+  pthread_mutex_unlock(&sample_lock);
+}
+
+
+void chpl_mem_profile_init(size_t rate) {
+  num_descs = CHPL_RT_MD_NUM + chpl_mem_numDescs;
+  CHPL_TLS_INIT(prof_thread);
+
+  if (rate > 0) {
+    samples = (sample_t**) calloc(NUM_SAMPLE_BUCKETS, sizeof(sample_t*));
+    sample_bits = (volatile uint64_t*) calloc(NUM_SAMPLE_BUCKETS / 64,
+                                              sizeof(uint64_t));
+    desc_live = (size_t*) calloc(2 * num_descs, sizeof(size_t));
+    if (samples == NULL || sample_bits == NULL || desc_live == NULL)
+      chpl_error("out of memory starting the memory profile", 0, 0);
+    sample_rate = rate;
+  }
+
+  chpl_memProfile = true;
+}
+
+
+void chpl_mem_profile_alloc(void* memAlloc, size_t size,
+                            chpl_mem_descInt_t description,
+                            int32_t lineno, c_string filename) {
+  prof_thread_t* t;
+  site_t*        s;
+
+  if (memAlloc == NULL || (t = prof_this_thread()) == NULL)
+    return;
+
+  if (description < 0 || description >= num_descs)
+    description = CHPL_RT_MD_UNKNOWN;
+  if (filename == NULL || filename[0] == '\0') {
+    filename = unknown_fn;
+    lineno = 0;
+  }
+
+  t->descs[2 * description]++;
+  t->descs[2 * description + 1] += size;
+
+  prof_lock(t);
+  if (2 * (t->used + 1) <= t->size || sites_grow(t)) {
+    s = site_find(t->sites, t->size, description, lineno, filename);
+    if (s->fn == NULL) {
+      s->fn = filename;
+      s->ln = lineno;
+      s->desc = description;
+      t->used++;
+    }
+    s->count++;
+    s->bytes += size;
+  }
+  prof_unlock(t);
+
+  //
+  // A zero-length allocation has no bytes to stand for; sampling it
+  // would only skew the estimates.
+  //
+  if (sample_rate > 0 && size > 0) {
+    if (size >= t->until_sample) {
+      t->until_sample = next_sample_interval(t);
+      take_sample(memAlloc, size, description, lineno, filename);
+    } else {
+      t->until_sample -= size;
+    }
+  }
+}
+
+
+void chpl_mem_profile_free(void* memAlloc) {
+  unsigned int b;
+  sample_t**   sp;
+  sample_t*    s;
+
+  if (sample_bits == NULL || memAlloc == NULL)
+    return;
+
+  b = sample_hash(memAlloc);
+  if ((sample_bits[b / 64] & (UINT64_C(1) << (b % 64))) == 0)
+    return;
+
+  pthread_mutex_lock(&sample_lock);
+  for (sp = &samples[b]; (s = *sp) != NULL; sp = &s->next) {
+    if (s->addr == memAlloc) {
+      *sp = s->next;
+      s->site->live -= s->weight;
+      desc_live[2 * s->site->desc] -= s->weight;
+      total_live -= s->weight;
+      s->next = free_samples;
+      free_samples = s;
+      break;
+    }
+  }
+  if (samples[b] == NULL)
+    sample_bits[b / 64] &= ~(UINT64_C(1) << (b % 64));
+  pthread_mutex_unlock(&sample_lock);
+}
+
+
+//
+// A call site merged across pthreads, with its sample estimates.  The
+// same file name may be at different addresses in different generated
+// files, so sites are merged by name.
+//
+typedef struct {
+  c_string           fn;
+  int32_t            ln;
+  chpl_mem_descInt_t desc;
+  uint64_t           count;
+  uint64_t           bytes;
+  size_t             live;
+  size_t             high;
+} merged_site_t;
+
+static int merged_site_cmp_loc(const void* v1, const void* v2) {
+  const merged_site_t* s1 = (const merged_site_t*) v1;
+  const merged_site_t* s2 = (const merged_site_t*) v2;
+  int                  c  = strcmp(s1->fn, s2->fn);
+
+  if (c != 0)
+    return c;
+  if (s1->ln != s2->ln)
+    return (s1->ln < s2->ln) ? -1 : 1;
+  return s1->desc - s2->desc;
+}
+
+static int merged_site_cmp_bytes(const void* v1, const void* v2) {
+  const merged_site_t* s1 = (const merged_site_t*) v1;
+  const merged_site_t* s2 = (const merged_site_t*) v2;
+
+  if (s1->bytes != s2->bytes)
+    return (s1->bytes > s2->bytes) ? -1 : 1;
+  return merged_site_cmp_loc(v1, v2);
+}
+
+// Returns the number of sites, in *sites_p, which the caller frees.
+static int profile_merge(merged_site_t** sites_p) {
+  prof_thread_t*  t;
+  merged_site_t*  sites;
+  int             n = 0;
+  int             m;
+  int             i;
+
+  for (t = prof_all_threads(); t != NULL; t = t->next) {
+    prof_lock(t);
+    n += t->used;
+    prof_unlock(t);
+  }
+
+  // A pthread may add sites while we're copying; those just get
+  // left out.
+  if ((sites = (merged_site_t*) calloc(n + 1, sizeof(*sites))) == NULL) {
+    *sites_p = NULL;
+    return 0;
+  }
+  m = 0;
+  for (t = prof_all_threads(); t != NULL; t = t->next) {
+    prof_lock(t);
+    for (i = 0; i < t->size && m < n; i++) {
+      site_t* s = &t->sites[i];
+      if (s->fn == NULL)
+        continue;
+      sites[m].fn = s->fn;
+      sites[m].ln = s->ln;
+      sites[m].desc = s->desc;
+      sites[m].count = s->count;
+      sites[m].bytes = s->bytes;
+      m++;
+    }
+    prof_unlock(t);
+  }
+
+  if (m > 0)
+    qsort(sites, m, sizeof(*sites), merged_site_cmp_loc);
+
+  n = 0;
+  for (i = 0; i < m; i++) {
+    if (n > 0 && merged_site_cmp_loc(&sites[n - 1], &sites[i]) == 0) {
+      sites[n - 1].count += sites[i].count;
+      sites[n - 1].bytes += sites[i].bytes;
+    } else {
+      sites[n++] = sites[i];
+    }
+  }
+
+  if (samples != NULL && n > 0) {
+    pthread_mutex_lock(&sample_lock);
+    for (i = 0; i < NUM_SAMPLED_SITE_BUCKETS; i++) {
+      sampled_site_t* ss;
+      for (ss = sampled_sites[i]; ss != NULL; ss = ss->next) {
+        merged_site_t  key;
+        merged_site_t* ms;
+
+        key.fn = ss->fn;
+        key.ln = ss->ln;
+        key.desc = ss->desc;
+        ms = (merged_site_t*) bsearch(&key, sites, n, sizeof(*sites),
+                                      merged_site_cmp_loc);
+        if (ms != NULL) {
+          ms->live = ss->live;
+          ms->high = ss->high;
+        }
+      }
+    }
+    pthread_mutex_unlock(&sample_lock);
+  }
+
+  if (n > 0)
+    qsort(sites, n, sizeof(*sites), merged_site_cmp_bytes);
+
+  *sites_p = sites;
+  return n;
+}
+
+
+static int desc_cmp_bytes(const void* v1, const void* v2) {
+  const uint64_t* d1 = (const uint64_t*) v1;
+  const uint64_t* d2 = (const uint64_t*) v2;
+
+  if (d1[1] != d2[1])
+    return (d1[1] > d2[1]) ? -1 : 1;
+  return (d1[4] < d2[4]) ? -1 : (d1[4] > d2[4]);
+}
+
+static void print_estimates(FILE* f, size_t live, size_t high) {
+  if (sample_rate > 0)
+    fprintf(f, "%-14zu  %-14zu  ", live, high);
+  else
+    fprintf(f, "%-14s  %-14s  ", "-", "-");
+}
+
+void chpl_mem_profile_print(FILE* f) {
+  prof_thread_t* t;
+  uint64_t*      descs;                // count, bytes, live, high, desc
+  merged_site_t* sites;
+  uint64_t       total_count = 0, total_bytes = 0;
+  size_t         live, high;
+  int            n, d, i;
+
+  if ((descs = (uint64_t*) calloc(5 * num_descs, sizeof(uint64_t))) == NULL)
+    return;
+  for (t = prof_all_threads(); t != NULL; t = t->next) {
+    for (d = 0; d < num_descs; d++) {
+      descs[5 * d] += t->descs[2 * d];
+      descs[5 * d + 1] += t->descs[2 * d + 1];
+    }
+  }
+  for (d = 0; d < num_descs; d++) {
+    descs[5 * d + 4] = d;
+    total_count += descs[5 * d];
+    total_bytes += descs[5 * d + 1];
+  }
+  if (sample_rate > 0) {
+    pthread_mutex_lock(&sample_lock);
+    for (d = 0; d < num_descs; d++) {
+      descs[5 * d + 2] = desc_live[2 * d];
+      descs[5 * d + 3] = desc_live[2 * d + 1];
+    }
+    live = total_live;
+    high = total_high;
+    pthread_mutex_unlock(&sample_lock);
+  } else {
+    live = high = 0;
+  }
+  qsort(descs, num_descs, 5 * sizeof(uint64_t), desc_cmp_bytes);
+
+  n = profile_merge(&sites);
+
+  fprintf(f, "==============\n");
+  if (chpl_numNodes == 1)
+    fprintf(f, "Memory Profile\n");
+  else
+    fprintf(f, "Memory Profile for locale %" FORMAT_c_nodeid_t "\n",
+            chpl_nodeID);
+  fprintf(f, "==============================================================\n");
+  if (sample_rate > 0)
+    fprintf(f, "Sampling one allocation per %zu bytes allocated\n",
+            sample_rate);
+  else
+    fprintf(f, "Not sampling; live and high-water bytes are unknown\n");
+  fprintf(f, "==============================================================\n");
+  fprintf(f, "%-12s  %-14s  %-14s  %-14s  %s\n",
+          "allocations", "bytes", "live bytes", "high-water", "description");
+  fprintf(f, "==============================================================\n");
+  for (d = 0; d < num_descs && descs[5 * d] > 0; d++) {
+    fprintf(f, "%-12" PRIu64 "  %-14" PRIu64 "  ",
+            descs[5 * d], descs[5 * d + 1]);
+    print_estimates(f, descs[5 * d + 2], descs[5 * d + 3]);
+    fprintf(f, "%s\n",
+            chpl_mem_descString((chpl_mem_descInt_t) descs[5 * d + 4]));
+  }
+  fprintf(f, "%-12" PRIu64 "  %-14" PRIu64 "  ", total_count, total_bytes);
+  print_estimates(f, live, high);
+  fprintf(f, "(total)\n");
+  fprintf(f, "==============================================================\n");
+  fprintf(f, "%-12s  %-14s  %-14s  %-14s  %s\n",
+          "allocations", "bytes", "live bytes", "high-water",
+          "location (description)");
+  fprintf(f, "==============================================================\n");
+  for (i = 0; i < n; i++) {
+    fprintf(f, "%-12" PRIu64 "  %-14" PRIu64 "  ",
+            sites[i].count, sites[i].bytes);
+    print_estimates(f, sites[i].live, sites[i].high);
+    if (strcmp(sites[i].fn, unknown_fn) == 0)
+      fprintf(f, "%s", unknown_fn);
+    else
+      fprintf(f, "%s:%" PRId32, sites[i].fn, sites[i].ln);
+    fprintf(f, " (%s)\n", chpl_mem_descString(sites[i].desc));
+  }
+  fprintf(f, "==============================================================\n");
+  fflush(f);
+
+  free(sites);
+  free(descs);
+}
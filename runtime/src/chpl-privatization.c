@@ -22,46 +22,42 @@
 #include "chpl-mem.h"
 #include "chpl-tasks.h"
 
-static int64_t chpl_capPrivateObjects = 0;
+#include <string.h>
+
 static chpl_sync_aux_t privatizationSync;
 
-void** chpl_privateObjects;
+void** chpl_privateObjects[CHPL_PRIVATIZATION_NUM_SEGS];
 
 void chpl_privatization_init(void) {
     chpl_sync_initAux(&privatizationSync);
 }
 
 void chpl_newPrivatizedClass(void* v, int64_t pid) {
-  // We need to lock around this operation so two calls in rapid succession
-  // that pass the chpl_capPrivateObjects limit don't both try to create a new
-  // array. If they do, one of the calls will be leaked and an invalid pointer
-  // to be placed in the table.
-  chpl_sync_lock(&privatizationSync);
-
-  pid += 1;
-  if (pid == 1) {
-    chpl_capPrivateObjects = 8;
-    // "private" means "node-private", so we can use the system allocator.
-    chpl_privateObjects = chpl_mem_allocMany(chpl_capPrivateObjects, sizeof(void*), CHPL_RT_MD_COMM_PRIVATE_OBJECTS_ARRAY, 0, "");
-  } else {
-    if (pid > chpl_capPrivateObjects) {
-      void** tmp;
-      chpl_capPrivateObjects *= 2;
-      tmp = chpl_mem_allocMany(chpl_capPrivateObjects, sizeof(void*), CHPL_RT_MD_COMM_PRIVATE_OBJECTS_ARRAY, 0, "");
-      chpl_memcpy((void*)tmp, (void*)chpl_privateObjects, (pid-1)*sizeof(void*));
-      chpl_privateObjects = tmp;
-      // purposely leak old copies of chpl_privateObject to avoid the need to
-      // lock chpl_getPrivatizedClass; TODO: fix with lock free data structure
+  uint64_t i = (uint64_t) pid + (1 << CHPL_PRIVATIZATION_SEG0_BITS);
+  int seg = chpl_privatization_seg(i);
+  uint64_t segSize = (uint64_t) 1 << (seg + CHPL_PRIVATIZATION_SEG0_BITS);
+
+  //
+  // Segments are never moved or freed once they exist, so storing into
+  // an existing one needs no lock, and readers never see a stale copy
+  // of the table.  Only adding a segment, which happens once per
+  // doubling of the number of objects, is serialized, so that two
+  // calls in rapid succession don't both create it.  A new segment is
+  // published with a release store, and read with acquire loads here
+  // and in chpl_getPrivatizedClass(), so that a task that sees the
+  // pointer also sees the cleared segment behind it.
+  //
+  void** segment = __atomic_load_n(&chpl_privateObjects[seg], __ATOMIC_ACQUIRE);
+  if (segment == NULL) {
+    chpl_sync_lock(&privatizationSync);
+    segment = __atomic_load_n(&chpl_privateObjects[seg], __ATOMIC_ACQUIRE);
+    if (segment == NULL) {
+      // "private" means "node-private", so we can use the system allocator.
+      segment = chpl_mem_allocMany(segSize, sizeof(void*), CHPL_RT_MD_COMM_PRIVATE_OBJECTS_ARRAY, 0, "");
+      memset(segment, 0, segSize * sizeof(void*));
+      __atomic_store_n(&chpl_privateObjects[seg], segment, __ATOMIC_RELEASE);
     }
+    chpl_sync_unlock(&privatizationSync);
   }
-  chpl_privateObjects[pid-1] = v;
-
-  chpl_sync_unlock(&privatizationSync);
-}
-
-
-extern void* chpl_getPrivatizedClass(int64_t i) {
-  return chpl_privateObjects[i];
+  segment[i - segSize] = v;
 }
-
-
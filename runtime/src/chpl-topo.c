@@ -0,0 +1,299 @@
+/*
+ * Copyright 2004-2014 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Node topology support.  See chpl-topo.h.
+//
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+#include "chplrt.h"
+
+#include "chpl-mem.h"
+#include "chpl-topo.h"
+#include "chpltypes.h"
+#include "error.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <errno.h>
+#include <sched.h>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#define TOPO_HAS_AFFINITY
+#if defined(SYS_mbind)
+#define TOPO_HAS_MBIND
+#endif
+#endif
+
+
+#define TOPO_MAX_NODES 1024            // highest kernel NUMA node id, + 1
+
+static int num_domains = 0;            // 0 until chpl_topo_init()
+
+#ifdef TOPO_HAS_AFFINITY
+typedef struct {
+  int       node;                      // kernel NUMA node id
+  cpu_set_t cpus;                      // the ones we may run on
+} topo_domain_t;
+
+static topo_domain_t* domains;
+static cpu_set_t      all_cpus;        // our affinity at startup
+#endif
+
+#ifdef TOPO_HAS_MBIND
+static chpl_bool      place_mem = false;
+static uintptr_t      page_size;
+#endif
+
+
+#ifdef TOPO_HAS_AFFINITY
+static int cmp_int(const void* a, const void* b) {
+  return *(const int*) a - *(const int*) b;
+}
+
+
+//
+// Parse a kernel cpu list such as "0-3,8,10-11" into a cpu set.
+//
+static void parse_cpulist(const char* s, cpu_set_t* set) {
+  CPU_ZERO(set);
+  while (*s != '\0' && *s != '\n') {
+    char* end;
+    long lo, hi;
+
+    lo = hi = strtol(s, &end, 10);
+    if (end == s)
+      return;
+    s = end;
+    if (*s == '-') {
+      hi = strtol(s + 1, &end, 10);
+      s = end;
+    }
+    for (; lo <= hi && lo < CPU_SETSIZE; lo++)
+      CPU_SET(lo, set);
+    if (*s == ',')
+      s++;
+  }
+}
+
+
+//
+// Find the NUMA nodes that have cpus we may use.  Returns how many
+// there are, filling in doms[] if it isn't NULL.
+//
+static int probe_numa_nodes(topo_domain_t* doms) {
+  int  ids[TOPO_MAX_NODES];
+  int  num_ids = 0, num_doms = 0, i;
+  DIR* dir;
+  struct dirent* de;
+
+  if ((dir = opendir("/sys/devices/system/node")) == NULL)
+    return 0;
+  while ((de = readdir(dir)) != NULL && num_ids < TOPO_MAX_NODES) {
+    int id;
+    if (sscanf(de->d_name, "node%d", &id) == 1
+        && id >= 0 && id < TOPO_MAX_NODES)
+      ids[num_ids++] = id;
+  }
+  closedir(dir);
+  qsort(ids, num_ids, sizeof(ids[0]), cmp_int);
+
+  for (i = 0; i < num_ids; i++) {
+    char      path[64], buf[4096];
+    FILE*     f;
+    cpu_set_t cpus;
+
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/node/node%d/cpulist", ids[i]);
+    if ((f = fopen(path, "r")) == NULL)
+      continue;
+    if (fgets(buf, sizeof(buf), f) == NULL)
+      buf[0] = '\0';
+    fclose(f);
+
+    parse_cpulist(buf, &cpus);
+    CPU_AND(&cpus, &cpus, &all_cpus);
+    if (CPU_COUNT(&cpus) == 0)
+      continue;
+
+    if (doms != NULL) {
+      doms[num_doms].node = ids[i];
+      doms[num_doms].cpus = cpus;
+    }
+    num_doms++;
+  }
+
+  return num_doms;
+}
+
+
+//
+// Deal our cpus out evenly among n made-up domains.  If there are
+// fewer cpus than domains, some domains share cpus.
+//
+static void make_fake_domains(topo_domain_t* doms, int n) {
+  int cpu_ids[CPU_SETSIZE];
+  int num_cpus = 0, c, d;
+
+  for (c = 0; c < CPU_SETSIZE; c++)
+    if (CPU_ISSET(c, &all_cpus))
+      cpu_ids[num_cpus++] = c;
+
+  for (d = 0; d < n; d++) {
+    int lo = (int) ((int64_t) num_cpus * d / n);
+    int hi = (int) ((int64_t) num_cpus * (d + 1) / n);
+
+    doms[d].node = -1;
+    CPU_ZERO(&doms[d].cpus);
+    if (hi == lo)
+      hi = lo + 1;
+    for (c = lo; c < hi; c++)
+      CPU_SET(cpu_ids[c], &doms[d].cpus);
+  }
+}
+#endif // TOPO_HAS_AFFINITY
+
+
+void chpl_topo_init(void) {
+  char* p;
+  int   num_requested = 0;
+
+  if ((p = getenv("CHPL_RT_NUM_SUBLOCALES")) != NULL) {
+    if (sscanf(p, "%d", &num_requested) != 1 || num_requested < 1) {
+      chpl_warning("CHPL_RT_NUM_SUBLOCALES must be a number >= 1; ignored",
+                   0, NULL);
+      num_requested = 0;
+    }
+  }
+
+#ifdef TOPO_HAS_AFFINITY
+  {
+    int num_nodes;
+
+    if (sched_getaffinity(0, sizeof(all_cpus), &all_cpus) != 0
+        || CPU_COUNT(&all_cpus) == 0) {
+      num_domains = 1;
+      return;
+    }
+
+    num_nodes = probe_numa_nodes(NULL);
+    num_domains = (num_requested > 0) ? num_requested
+                  : (num_nodes > 0) ? num_nodes : 1;
+    domains = (topo_domain_t*) chpl_mem_allocMany(num_domains,
+                                                  sizeof(domains[0]),
+                                                  CHPL_RT_MD_TOPOLOGY_DATA,
+                                                  0, 0);
+    if (num_domains == num_nodes)
+      (void) probe_numa_nodes(domains);
+    else
+      make_fake_domains(domains, num_domains);
+
+#ifdef TOPO_HAS_MBIND
+    page_size = (uintptr_t) sysconf(_SC_PAGESIZE);
+    place_mem = (num_domains > 1 && num_domains == num_nodes);
+#endif
+  }
+#else
+  num_domains = (num_requested > 0) ? num_requested : 1;
+#endif
+}
+
+
+int chpl_topo_getNumNumaDomains(void) {
+  return (num_domains > 0) ? num_domains : 1;
+}
+
+
+void chpl_topo_setThreadLocality(c_sublocid_t subloc) {
+#ifdef TOPO_HAS_AFFINITY
+  cpu_set_t* cpus;
+
+  if (num_domains <= 1)
+    return;
+
+  if (subloc >= 0 && subloc < num_domains)
+    cpus = &domains[subloc].cpus;
+  else
+    cpus = &all_cpus;
+
+  //
+  // The cpu sets came from our own affinity, so this can only fail if
+  // someone else has restricted us since.  Just run wherever we are.
+  //
+  (void) sched_setaffinity(0, sizeof(*cpus), cpus);
+#endif
+}
+
+
+#ifdef TOPO_HAS_MBIND
+//
+// Prefer the given node for the pages of [lo, hi), moving any that
+// are already elsewhere.
+//
+static void place_pages(uintptr_t lo, uintptr_t hi, int node) {
+  unsigned long mask[TOPO_MAX_NODES / (8 * sizeof(unsigned long))];
+  const int     bits = 8 * sizeof(mask[0]);
+
+  memset(mask, 0, sizeof(mask));
+  mask[node / bits] = 1UL << (node % bits);
+  if (syscall(SYS_mbind, (void*) lo, (unsigned long) (hi - lo),
+              MPOL_PREFERRED, mask, (unsigned long) TOPO_MAX_NODES + 1,
+              MPOL_MF_MOVE) != 0
+      && (errno == ENOSYS || errno == EPERM)) {
+    // We aren't allowed to do this here; don't keep trying.
+    place_mem = false;
+  }
+}
+#endif
+
+
+void chpl_topo_setMemLocality(void* p, size_t size, c_sublocid_t subloc) {
+#ifdef TOPO_HAS_MBIND
+  uintptr_t lo, hi;
+
+  if (!place_mem)
+    return;
+
+  lo = ((uintptr_t) p + page_size - 1) & ~(page_size - 1);
+  hi = ((uintptr_t) p + size) & ~(page_size - 1);
+  if (hi <= lo)
+    return;
+
+  if (subloc >= 0 && subloc < num_domains)
+    place_pages(lo, hi, domains[subloc].node);
+  else if (subloc == c_sublocid_any) {
+    uintptr_t num_pages = (hi - lo) / page_size;
+    int       d;
+
+    for (d = 0; d < num_domains && place_mem; d++) {
+      uintptr_t d_lo = lo + num_pages * d / num_domains * page_size;
+      uintptr_t d_hi = lo + num_pages * (d + 1) / num_domains * page_size;
+      if (d_hi > d_lo)
+        place_pages(d_lo, d_hi, domains[d].node);
+    }
+  }
+#endif
+}
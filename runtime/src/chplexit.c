@@ -21,6 +21,7 @@
 
 #include "chpl_rt_utils_static.h"
 #include "chpl-comm.h"
+#include "chpl-comm-diags.h"
 #include "chplexit.h"
 #include "chpl-mem.h"
 #include "chplmemtrack.h"
@@ -40,6 +41,7 @@ static void chpl_exit_common(int status, int all) {
   chpl_comm_pre_task_exit(all);
   if (all) {
     chpl_task_exit();
+    chpl_comm_diags_exit();
     chpl_reportMemInfo();
   }
   chpl_mem_exit();
@@ -20,8 +20,10 @@
 #include "chplrt.h"
 
 #include "chplmemtrack.h"
+#include "chpl-atomics.h"
 #include "chpl-mem.h"
 #include "chpl-mem-desc.h"
+#include "chpl-mem-profile.h"
 #include "chpl-tasks.h"
 #include "chpltypes.h"
 #include "chpl-comm.h"
@@ -49,7 +51,9 @@ extern void chpl_memTracking_returnConfigVals(chpl_bool*,
                                               size_t*,
                                               size_t*,
                                               c_string*,
-                                              c_string*);
+                                              c_string*,
+                                              chpl_bool*,
+                                              size_t*);
 
 chpl_bool chpl_memTrack = false;
 
@@ -67,16 +71,45 @@ typedef struct memTableEntry_struct { /* table entry */
   struct memTableEntry_struct* nextInBucket;
 } memTableEntry;
 
-#define NUM_HASH_SIZE_INDICES 20
+#define NUM_HASH_SIZE_INDICES 25
 
-static int hashSizes[NUM_HASH_SIZE_INDICES] = { 1543, 3079, 6151, 12289, 24593, 49157, 98317,
+static int hashSizes[NUM_HASH_SIZE_INDICES] = { 53, 97, 193, 389, 769,
+                                                1543, 3079, 6151, 12289, 24593, 49157, 98317,
                                                 196613, 393241, 786433, 1572869, 3145739,
                                                 6291469, 12582917, 25165843, 50331653,
                                                 100663319, 201326611, 402653189, 805306457 };
-static int hashSizeIndex = 0;
-static int hashSize = 0;
 
-static memTableEntry** memTable = NULL;
+//
+// The memory table is split into shards, chosen by address, each with
+// its own lock, hash table and statistics, so that tasks allocating
+// and freeing memory concurrently seldom contend with one another.
+// Each shard resizes on its own.  The per-shard statistics are only
+// combined when they are reported.  The total memory in use is also
+// kept in one atomic counter, so that --memMax can be enforced and
+// the high water mark tracked without a global lock; each shard
+// records the highest total reached by its own updates, and the
+// overall maximum is the largest of those.
+//
+#define NUM_MEM_TABLE_SHARDS 64
+
+#define MEM_TABLE_ENTRY_CHUNK 64
+
+typedef struct {
+  chpl_sync_aux_t sync;
+  memTableEntry** table;
+  int hashSizeIndex;
+  int hashSize;
+  size_t totalEntries;      /* number of entries in this shard */
+  size_t totalMem;          /* memory currently allocated, this shard */
+  size_t maxMem;            /* highest overall total reached here */
+  size_t totalAllocated;    /* memory allocated, this shard */
+  size_t totalFreed;        /* memory freed, this shard */
+  memTableEntry* freeEntries; /* unused entries, for reuse */
+} memTableShard;
+
+static memTableShard memTableShards[NUM_MEM_TABLE_SHARDS];
+
+static atomic_uint_least64_t memInUse; /* total memory currently allocated */
 
 static _Bool memLeaks = false;
 static _Bool memLeaksTable = false;
@@ -86,18 +119,12 @@ static size_t memThreshold = 0;
 static c_string memLog = "";
 static FILE* memLogFile = NULL;
 static c_string memLeaksLog = "";
-
-static size_t totalMem = 0;       /* total memory currently allocated */
-static size_t maxMem = 0;         /* maximum total memory during run  */
-static size_t totalAllocated = 0; /* total memory allocated */
-static size_t totalFreed = 0;     /* total memory freed */
-static size_t totalEntries = 0;     /* number of entries in hash table */
-
-static chpl_sync_aux_t memTrack_sync;
+static size_t memProfileRate = 0;
 
 
 void chpl_setMemFlags(void) {
   chpl_bool local_memTrack = false;
+  chpl_bool local_memProfile = false;
 
   //
   // Get the values of the memTracking config consts from the module.
@@ -112,7 +139,8 @@ void chpl_setMemFlags(void) {
   // early.  In the first version of this code I passed &chpl_memTrack
   // itself, and for comm=gasnet we ended up tracking an extra 2 bytes
   // of space the comm layer allocated as a result of our own call to
-  // chpl_memTracking_returnConfigVals().
+  // chpl_memTracking_returnConfigVals().  The same goes for
+  // local_memProfile.
   //
   chpl_memTracking_returnConfigVals(&local_memTrack,
                                     &memStats,
@@ -121,7 +149,9 @@ void chpl_setMemFlags(void) {
                                     &memMax,
                                     &memThreshold,
                                     &memLog,
-                                    &memLeaksLog);
+                                    &memLeaksLog,
+                                    &local_memProfile,
+                                    &memProfileRate);
 
   if (local_memTrack
       || memStats
@@ -146,11 +176,25 @@ void chpl_setMemFlags(void) {
   }
 
   if (chpl_memTrack) {
-    chpl_sync_initAux(&memTrack_sync);
-    hashSizeIndex = 0;
-    hashSize = hashSizes[hashSizeIndex];
-    memTable = calloc(hashSize, sizeof(memTableEntry*));
+    int i;
+    atomic_init_uint_least64_t(&memInUse, 0);
+    for (i = 0; i < NUM_MEM_TABLE_SHARDS; i++) {
+      memTableShard* shard = &memTableShards[i];
+      chpl_sync_initAux(&shard->sync);
+      shard->hashSizeIndex = 0;
+      shard->hashSize = hashSizes[shard->hashSizeIndex];
+      shard->table = calloc(shard->hashSize, sizeof(memTableEntry*));
+      shard->totalEntries = 0;
+      shard->totalMem = 0;
+      shard->maxMem = 0;
+      shard->totalAllocated = 0;
+      shard->totalFreed = 0;
+      shard->freeEntries = NULL;
+    }
   }
+
+  if (local_memProfile)
+    chpl_mem_profile_init(memProfileRate);
 }
 
 
@@ -166,37 +210,73 @@ static unsigned hash(void* memAlloc, int hashSize) {
 }
 
 
-static void increaseMemStat(size_t chunk, int32_t lineno, c_string filename) {
-  totalMem += chunk;
-  totalAllocated += chunk;
-  if (memMax && (totalMem > memMax)) {
+//
+// Pick the shard for an address.  Allocations are aligned, so the low
+// bits carry no information; a multiplicative hash spreads the rest.
+//
+static memTableShard* getShard(void* memAlloc) {
+  uint64_t key = ((uint64_t) (uintptr_t) memAlloc) >> 4;
+  return &memTableShards[(key * UINT64_C(0x9E3779B97F4A7C15)) >> 58];
+}
+
+
+static void increaseMemStat(memTableShard* shard, size_t chunk,
+                            int32_t lineno, c_string filename) {
+  size_t newTotalMem;
+
+  newTotalMem = atomic_fetch_add_uint_least64_t(&memInUse, chunk) + chunk;
+  shard->totalMem += chunk;
+  shard->totalAllocated += chunk;
+  if (memMax && (newTotalMem > memMax)) {
     chpl_error("Exceeded memory limit", lineno, filename);
   }
-  if (totalMem > maxMem)
-    maxMem = totalMem;
+  if (newTotalMem > shard->maxMem)
+    shard->maxMem = newTotalMem;
 }
 
 
-static void decreaseMemStat(size_t chunk) {
-  totalMem -= chunk; // > totalMem ? 0 : totalMem - chunk;
-  totalFreed += chunk;
+static void decreaseMemStat(memTableShard* shard, size_t chunk) {
+  (void) atomic_fetch_sub_uint_least64_t(&memInUse, chunk);
+  shard->totalMem -= chunk; // > totalMem ? 0 : totalMem - chunk;
+  shard->totalFreed += chunk;
+}
+
+
+//
+// Combine the per-shard statistics.
+//
+static void getMemStats(size_t* totalMem, size_t* maxMem,
+                        size_t* totalAllocated, size_t* totalFreed) {
+  int i;
+
+  *totalMem = *maxMem = *totalAllocated = *totalFreed = 0;
+  for (i = 0; i < NUM_MEM_TABLE_SHARDS; i++) {
+    memTableShard* shard = &memTableShards[i];
+    chpl_sync_lock(&shard->sync);
+    *totalMem += shard->totalMem;
+    if (shard->maxMem > *maxMem)
+      *maxMem = shard->maxMem;
+    *totalAllocated += shard->totalAllocated;
+    *totalFreed += shard->totalFreed;
+    chpl_sync_unlock(&shard->sync);
+  }
 }
 
 
 static void
-resizeTable(int direction) {
+resizeTable(memTableShard* shard, int direction) {
   memTableEntry** newMemTable = NULL;
   int newHashSizeIndex, newHashSize, newHashValue;
   int i;
   memTableEntry* me;
   memTableEntry* next;
 
-  newHashSizeIndex = hashSizeIndex + direction;
+  newHashSizeIndex = shard->hashSizeIndex + direction;
   newHashSize = hashSizes[newHashSizeIndex];
   newMemTable = calloc(newHashSize, sizeof(memTableEntry*));
 
-  for (i = 0; i < hashSize; i++) {
-    for (me = memTable[i]; me != NULL; me = next) {
+  for (i = 0; i < shard->hashSize; i++) {
+    for (me = shard->table[i]; me != NULL; me = next) {
       next = me->nextInBucket;
       newHashValue = hash(me->memAlloc, newHashSize);
       me->nextInBucket = newMemTable[newHashValue];
@@ -204,53 +284,85 @@ resizeTable(int direction) {
     }
   }
 
-  free(memTable);
-  memTable = newMemTable;
-  hashSize = newHashSize;
-  hashSizeIndex = newHashSizeIndex;
+  free(shard->table);
+  shard->table = newMemTable;
+  shard->hashSize = newHashSize;
+  shard->hashSizeIndex = newHashSizeIndex;
 }
 
 
-static void addMemTableEntry(void* memAlloc, size_t number, size_t size, chpl_mem_descInt_t description, int32_t lineno, c_string filename) {
-  unsigned hashValue;
+//
+// Table entries are allocated in chunks and recycled within their
+// shard, rather than calloc()ed and free()d one at a time.
+//
+static memTableEntry* getMemTableEntry(memTableShard* shard,
+                                       int32_t lineno, c_string filename) {
   memTableEntry* memEntry;
 
-  if ((totalEntries+1)*2 > hashSize && hashSizeIndex < NUM_HASH_SIZE_INDICES-1)
-    resizeTable(1);
+  if (shard->freeEntries == NULL) {
+    int i;
 
-  memEntry = (memTableEntry*) calloc(1, sizeof(memTableEntry));
-  if (!memEntry) {
-    chpl_error("memtrack fault: out of memory allocating memtrack table",
-               lineno, filename);
+    memEntry = (memTableEntry*) calloc(MEM_TABLE_ENTRY_CHUNK,
+                                       sizeof(memTableEntry));
+    if (!memEntry) {
+      chpl_error("memtrack fault: out of memory allocating memtrack table",
+                 lineno, filename);
+    }
+    for (i = 0; i < MEM_TABLE_ENTRY_CHUNK; i++) {
+      memEntry[i].nextInBucket = shard->freeEntries;
+      shard->freeEntries = &memEntry[i];
+    }
   }
 
-  hashValue = hash(memAlloc, hashSize);
-  memEntry->nextInBucket = memTable[hashValue];
-  memTable[hashValue] = memEntry;
+  memEntry = shard->freeEntries;
+  shard->freeEntries = memEntry->nextInBucket;
+  return memEntry;
+}
+
+
+static void putMemTableEntry(memTableShard* shard, memTableEntry* memEntry) {
+  memEntry->nextInBucket = shard->freeEntries;
+  shard->freeEntries = memEntry;
+}
+
+
+static void addMemTableEntry(memTableShard* shard, void* memAlloc, size_t number, size_t size, chpl_mem_descInt_t description, int32_t lineno, c_string filename) {
+  unsigned hashValue;
+  memTableEntry* memEntry;
+
+  if ((shard->totalEntries+1)*2 > shard->hashSize
+      && shard->hashSizeIndex < NUM_HASH_SIZE_INDICES-1)
+    resizeTable(shard, 1);
+
+  memEntry = getMemTableEntry(shard, lineno, filename);
+
+  hashValue = hash(memAlloc, shard->hashSize);
+  memEntry->nextInBucket = shard->table[hashValue];
+  shard->table[hashValue] = memEntry;
   memEntry->description = description;
   memEntry->memAlloc = memAlloc;
   memEntry->lineno = lineno;
   memEntry->filename = filename; // do we want to copy this string?
   memEntry->number = number;
   memEntry->size = size;
-  increaseMemStat(number*size, lineno, filename);
-  totalEntries += 1;
+  increaseMemStat(shard, number*size, lineno, filename);
+  shard->totalEntries += 1;
 }
 
 
-static memTableEntry* removeMemTableEntry(void* address) {
-  unsigned hashValue = hash(address, hashSize);
-  memTableEntry* thisBucketEntry = memTable[hashValue];
+static memTableEntry* removeMemTableEntry(memTableShard* shard, void* address) {
+  unsigned hashValue = hash(address, shard->hashSize);
+  memTableEntry* thisBucketEntry = shard->table[hashValue];
   memTableEntry* deletedBucket = NULL;
 
   if (!thisBucketEntry)
     return NULL;
 
   if (thisBucketEntry->memAlloc == address) {
-    memTable[hashValue] = thisBucketEntry->nextInBucket;
+    shard->table[hashValue] = thisBucketEntry->nextInBucket;
     deletedBucket = thisBucketEntry;
   } else {
-    for (thisBucketEntry = memTable[hashValue];
+    for (thisBucketEntry = shard->table[hashValue];
          thisBucketEntry != NULL;
          thisBucketEntry = thisBucketEntry->nextInBucket) {
 
@@ -263,10 +375,10 @@ static memTableEntry* removeMemTableEntry(void* address) {
     }
   }
   if (deletedBucket) {
-    decreaseMemStat(deletedBucket->number * deletedBucket->size);
-    totalEntries -= 1;
-    if (totalEntries*8 < hashSize && hashSizeIndex > 0)
-      resizeTable(-1);
+    decreaseMemStat(shard, deletedBucket->number * deletedBucket->size);
+    shard->totalEntries -= 1;
+    if (shard->totalEntries*8 < shard->hashSize && shard->hashSizeIndex > 0)
+      resizeTable(shard, -1);
   }
   return deletedBucket;
 }
@@ -276,7 +388,7 @@ uint64_t chpl_memoryUsed(int32_t lineno, c_string filename) {
   if (!chpl_memTrack)
     chpl_error("invalid call to memoryUsed(); rerun with --memTrack",
                lineno, filename);
-  return (uint64_t)totalMem;
+  return (uint64_t)atomic_load_uint_least64_t(&memInUse);
 }
 
 
@@ -284,10 +396,11 @@ void chpl_printMemStat(int32_t lineno, c_string filename) {
   if (!chpl_memTrack)
     chpl_error("invalid call to printMemStat(); rerun with --memTrack",
                lineno, filename);
-  chpl_sync_lock(&memTrack_sync);
   fprintf(memLogFile, "=================\n");
   fprintf(memLogFile, "Memory Statistics\n");
   if (chpl_numNodes == 1) {
+    size_t totalMem, maxMem, totalAllocated, totalFreed;
+    getMemStats(&totalMem, &maxMem, &totalAllocated, &totalFreed);
     fprintf(memLogFile, "==============================================================\n");
     fprintf(memLogFile, "Current Allocated Memory               %zd\n", totalMem);
     fprintf(memLogFile, "Maximum Simultaneous Allocated Memory  %zd\n", maxMem);
@@ -304,16 +417,25 @@ void chpl_printMemStat(int32_t lineno, c_string filename) {
     fprintf(memLogFile, "                                            Total Freed Memory\n");
     fprintf(memLogFile, "==============================================================\n");
     for (i = 0; i < chpl_numNodes; i++) {
-      static size_t m1, m2, m3, m4;
-      chpl_gen_comm_get(&m1, i, &totalMem, sizeof(size_t), -1 /* broke for hetero */, 1, lineno, filename);
-      chpl_gen_comm_get(&m2, i, &maxMem, sizeof(size_t), -1 /* broke for hetero */, 1, lineno, filename);
-      chpl_gen_comm_get(&m3, i, &totalAllocated,  sizeof(size_t), -1 /* broke for hetero */, 1, lineno, filename);
-      chpl_gen_comm_get(&m4, i, &totalFreed, sizeof(size_t), -1 /*broke for hetero */, 1, lineno, filename);
+      static memTableShard remoteShard;
+      size_t m1 = 0, m2 = 0, m3 = 0, m4 = 0;
+      int j;
+      //
+      // Combine the remote locale's per-shard statistics here.  We
+      // copy whole shards but only look at the statistics fields.
+      //
+      for (j = 0; j < NUM_MEM_TABLE_SHARDS; j++) {
+        chpl_gen_comm_get(&remoteShard, i, &memTableShards[j], sizeof(memTableShard), -1 /* broke for hetero */, 1, lineno, filename);
+        m1 += remoteShard.totalMem;
+        if (remoteShard.maxMem > m2)
+          m2 = remoteShard.maxMem;
+        m3 += remoteShard.totalAllocated;
+        m4 += remoteShard.totalFreed;
+      }
       fprintf(memLogFile, "%-9d  %-9zu  %-9zu  %-9zu  %-9zu\n", i, m1, m2, m3, m4);
     }
     fprintf(memLogFile, "==============================================================\n");
   }
-  chpl_sync_unlock(&memTrack_sync);
 }
 
 
@@ -324,18 +446,23 @@ static int leakedMemTableEntryCmp(const void* p1, const void* p2) {
 void chpl_printLeakedMemTable(void) {
   size_t* table;
   memTableEntry* me;
-  int i;
+  int i, s;
   const int numberWidth   = 9;
   const int numEntries = CHPL_RT_MD_NUM+chpl_mem_numDescs;
 
   table = (size_t*)calloc(numEntries, 3*sizeof(size_t));
 
-  for (i = 0; i < hashSize; i++) {
-    for (me = memTable[i]; me != NULL; me = me->nextInBucket) {
-      table[3*me->description] += me->number*me->size;
-      table[3*me->description+1] += 1;
-      table[3*me->description+2] = me->description;
+  for (s = 0; s < NUM_MEM_TABLE_SHARDS; s++) {
+    memTableShard* shard = &memTableShards[s];
+    chpl_sync_lock(&shard->sync);
+    for (i = 0; i < shard->hashSize; i++) {
+      for (me = shard->table[i]; me != NULL; me = me->nextInBucket) {
+        table[3*me->description] += me->number*me->size;
+        table[3*me->description+1] += 1;
+        table[3*me->description+2] = me->description;
+      }
     }
+    chpl_sync_unlock(&shard->sync);
   }
 
   qsort(table, numEntries, 3*sizeof(size_t), leakedMemTableEntryCmp);
@@ -361,6 +488,14 @@ void chpl_printLeakedMemTable(void) {
 }
 
 
+void chpl_printMemProfile(int32_t lineno, c_string filename) {
+  if (!chpl_memProfile)
+    chpl_error("invalid call to printMemProfile(); rerun with --memProfile",
+               lineno, filename);
+  chpl_mem_profile_print(memLogFile);
+}
+
+
 void chpl_reportMemInfo() {
   if (memStats) {
     fprintf(memLogFile, "\n");
@@ -374,6 +509,10 @@ void chpl_reportMemInfo() {
     fprintf(memLogFile, "\n");
     chpl_printMemTable(0, 0, 0);
   }
+  if (chpl_memProfile) {
+    fprintf(memLogFile, "\n");
+    chpl_mem_profile_print(memLogFile);
+  }
   if (memLogFile && memLogFile != stdout)
     fclose(memLogFile);
   if (memLeaksLog && strcmp(memLeaksLog, "")) {
@@ -410,24 +549,34 @@ void chpl_printMemTable(int64_t threshold, int32_t lineno, c_string filename) {
   int totalWidth;
 
   memTableEntry* memEntry;
-  int n, i;
+  int n, i, s;
   char* loc;
   memTableEntry** table;
 
   if (!chpl_memTrack)
     chpl_error("The printMemTable function only works with the --memTrack flag", lineno, filename);
 
+  //
+  // Hold all the shards while we gather entries from them, so that the
+  // number we count and the number we collect are the same.
+  //
+  for (s = 0; s < NUM_MEM_TABLE_SHARDS; s++)
+    chpl_sync_lock(&memTableShards[s].sync);
+
   n = 0;
   filenameWidth = strlen("Allocated Memory (Bytes)");
-  for (i = 0; i < hashSize; i++) {
-    for (memEntry = memTable[i]; memEntry != NULL; memEntry = memEntry->nextInBucket) {
-      size_t chunk = memEntry->number * memEntry->size;
-      if (chunk >= threshold) {
-        n += 1;
-        if (memEntry->filename) {
-          int filenameLength = strlen(memEntry->filename);
-          if (filenameLength > filenameWidth)
-            filenameWidth = filenameLength;
+  for (s = 0; s < NUM_MEM_TABLE_SHARDS; s++) {
+    memTableShard* shard = &memTableShards[s];
+    for (i = 0; i < shard->hashSize; i++) {
+      for (memEntry = shard->table[i]; memEntry != NULL; memEntry = memEntry->nextInBucket) {
+        size_t chunk = memEntry->number * memEntry->size;
+        if (chunk >= threshold) {
+          n += 1;
+          if (memEntry->filename) {
+            int filenameLength = strlen(memEntry->filename);
+            if (filenameLength > filenameWidth)
+              filenameWidth = filenameLength;
+          }
         }
       }
     }
@@ -453,11 +602,14 @@ void chpl_printMemTable(int64_t threshold, int32_t lineno, c_string filename) {
     chpl_error("out of memory printing memory table", lineno, filename);
 
   n = 0;
-  for (i = 0; i < hashSize; i++) {
-    for (memEntry = memTable[i]; memEntry != NULL; memEntry = memEntry->nextInBucket) {
-      size_t chunk = memEntry->number * memEntry->size;
-      if (chunk >= threshold) {
-        table[n++] = memEntry;
+  for (s = 0; s < NUM_MEM_TABLE_SHARDS; s++) {
+    memTableShard* shard = &memTableShards[s];
+    for (i = 0; i < shard->hashSize; i++) {
+      for (memEntry = shard->table[i]; memEntry != NULL; memEntry = memEntry->nextInBucket) {
+        size_t chunk = memEntry->number * memEntry->size;
+        if (chunk >= threshold) {
+          table[n++] = memEntry;
+        }
       }
     }
   }
@@ -484,6 +636,9 @@ void chpl_printMemTable(int64_t threshold, int32_t lineno, c_string filename) {
   fprintf(memLogFile, "\n");
   putchar('\n');
 
+  for (s = NUM_MEM_TABLE_SHARDS - 1; s >= 0; s--)
+    chpl_sync_unlock(&memTableShards[s].sync);
+
   free(table);
   free(loc);
 }
@@ -492,11 +647,15 @@ void chpl_printMemTable(int64_t threshold, int32_t lineno, c_string filename) {
 void chpl_track_malloc(void* memAlloc, size_t number, size_t size,
                        chpl_mem_descInt_t description,
                        int32_t lineno, c_string filename) {
+  if (chpl_memProfile)
+    chpl_mem_profile_alloc(memAlloc, number*size, description,
+                           lineno, filename);
   if (number * size > memThreshold) {
     if (chpl_memTrack) {
-      chpl_sync_lock(&memTrack_sync);
-      addMemTableEntry(memAlloc, number, size, description, lineno, filename);
-      chpl_sync_unlock(&memTrack_sync);
+      memTableShard* shard = getShard(memAlloc);
+      chpl_sync_lock(&shard->sync);
+      addMemTableEntry(shard, memAlloc, number, size, description, lineno, filename);
+      chpl_sync_unlock(&shard->sync);
     }
     if (chpl_verbose_mem) {
       fprintf(memLogFile,
@@ -511,9 +670,12 @@ void chpl_track_malloc(void* memAlloc, size_t number, size_t size,
 
 void chpl_track_free(void* memAlloc, int32_t lineno, c_string filename) {
   memTableEntry* memEntry = NULL;
+  if (chpl_memProfile)
+    chpl_mem_profile_free(memAlloc);
   if (chpl_memTrack) {
-    chpl_sync_lock(&memTrack_sync);
-    memEntry = removeMemTableEntry(memAlloc);
+    memTableShard* shard = getShard(memAlloc);
+    chpl_sync_lock(&shard->sync);
+    memEntry = removeMemTableEntry(shard, memAlloc);
     if (memEntry) {
       if (chpl_verbose_mem) {
         fprintf(memLogFile,
@@ -523,9 +685,9 @@ void chpl_track_free(void* memAlloc, int32_t lineno, c_string filename) {
                 memEntry->number*memEntry->size,
                 chpl_mem_descString(memEntry->description), memAlloc);
       }
-      free(memEntry);
+      putMemTableEntry(shard, memEntry);
     }
-    chpl_sync_unlock(&memTrack_sync);
+    chpl_sync_unlock(&shard->sync);
   } else if (chpl_verbose_mem && !memEntry) {
     fprintf(memLogFile,
             "%" FORMAT_c_nodeid_t ": %s:%" PRId32 ": free at %p\n",
@@ -539,14 +701,15 @@ void chpl_track_realloc_pre(void* memAlloc, size_t size,
                          int32_t lineno, c_string filename) {
   memTableEntry* memEntry = NULL;
 
-  if (chpl_memTrack && size > memThreshold) {
-    chpl_sync_lock(&memTrack_sync);
-    if (memAlloc) {
-      memEntry = removeMemTableEntry(memAlloc);
-      if (memEntry)
-        free(memEntry);
-    }
-    chpl_sync_unlock(&memTrack_sync);
+  if (chpl_memProfile)
+    chpl_mem_profile_free(memAlloc);
+  if (chpl_memTrack && size > memThreshold && memAlloc) {
+    memTableShard* shard = getShard(memAlloc);
+    chpl_sync_lock(&shard->sync);
+    memEntry = removeMemTableEntry(shard, memAlloc);
+    if (memEntry)
+      putMemTableEntry(shard, memEntry);
+    chpl_sync_unlock(&shard->sync);
   }
 }
 
@@ -555,11 +718,15 @@ void chpl_track_realloc_post(void* moreMemAlloc,
                          void* memAlloc, size_t size,
                          chpl_mem_descInt_t description,
                          int32_t lineno, c_string filename) {
+  if (chpl_memProfile)
+    chpl_mem_profile_alloc(moreMemAlloc, size, description,
+                           lineno, filename);
   if (size > memThreshold) {
     if (chpl_memTrack) {
-      chpl_sync_lock(&memTrack_sync);
-      addMemTableEntry(moreMemAlloc, 1, size, description, lineno, filename);
-      chpl_sync_unlock(&memTrack_sync);
+      memTableShard* shard = getShard(moreMemAlloc);
+      chpl_sync_lock(&shard->sync);
+      addMemTableEntry(shard, moreMemAlloc, 1, size, description, lineno, filename);
+      chpl_sync_unlock(&shard->sync);
     }
     if (chpl_verbose_mem) {
       fprintf(memLogFile,
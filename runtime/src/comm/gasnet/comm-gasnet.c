@@ -24,6 +24,7 @@
 #include "gasnet_coll.h"
 #include "gasnet_tools.h"
 #include "chpl-comm.h"
+#include "chpl-comm-diags.h"
 #include "chpl-mem.h"
 #include "chplsys.h"
 #include "chpl-tasks.h"
@@ -32,10 +33,12 @@
 #include "chpl-atomics.h"
 #include "error.h"
 #include "chpl-cache.h" // to call chpl_cache_init()
+#include "chpl-thread-local-storage.h"
 
 // Don't get warning macros for chpl_comm_get etc
 #include "chpl-comm-no-warning-macros.h"
 
+#include <pthread.h>
 #include <signal.h>
 #include <sched.h>
 #include <stdint.h>
@@ -44,8 +47,6 @@
 #include <assert.h>
 #include <time.h>
 
-static chpl_sync_aux_t chpl_comm_diagnostics_sync;
-static chpl_commDiagnostics chpl_comm_commDiagnostics;
 static int chpl_comm_no_debug_private = 0;
 static gasnet_seginfo_t* seginfo_table = NULL;
 
@@ -157,15 +158,403 @@ typedef struct {
 #define FREE          136 // free data at addr
 #define EXIT_ANY      137 // free data at addr
 #define BCAST_SEGINFO 138 // broadcast for segment info table
+#define AGG_PUT       139 // aggregated PUTs
+#define AGG_PUT_ACK   140 // ack of aggregated PUTs
+#define FORK_TREE     141 // batched non-blocking forks, forwarded in a tree
+
+//
+// Aggregation of small PUTs
+//
+// When CHPL_RT_COMM_AGGREGATE is set, each pthread collects the small
+// PUTs it does in a buffer per destination locale instead of doing
+// each one as a separate GASNet operation.  A buffer is sent to its
+// locale as one active message when it fills up, when its oldest PUT
+// has waited longer than the timeout, and whenever the PUTs have to
+// be complete:
+//
+//   - at remote memory fences (see chpl-mem-consistency.h), which
+//     include sync and single variable operations,
+//   - at the end of a task or an on statement, and when a lightweight
+//     task switches out, since it may resume on another pthread,
+//   - before any other transfer to the same locale, so that a task
+//     sees its own PUTs, and
+//   - before a fork to any locale, a barrier, or exit.
+//
+// Completing the PUTs to a locale means sending its buffer and waiting
+// for everything sent to it to be acknowledged.  A GET only has to see
+// the PUTs it overlaps, so it leaves the buffer alone unless one of
+// them does, and only waits if it may overlap PUTs that are in flight.
+// To tell cheaply, each buffer keeps a bit filter of the 64-byte lines
+// its PUTs touch, and another of the lines touched by its PUTs that
+// have been sent but not yet acknowledged.  That way a loop that reads
+// and then writes remote elements doesn't wait for a round trip on
+// every read.  The polling task sends the
+// buffers that have timed out, so each pthread's buffers are guarded
+// by a lock which is otherwise only taken by that pthread.
+//
+// The bodies of fast forks run inside the FORK_FAST handler, which
+// can't send requests or wait for replies, so it must not flush or
+// send a buffer.  PUTs done while a pthread is running one are not
+// aggregated, and flushes are skipped.
+//
+int chpl_comm_aggregate = 0;
+
+#define AGG_MAX_PUT_SIZE        256    // larger PUTs aren't aggregated
+#define AGG_DEFAULT_BUFFER_SIZE 8192   // bytes
+#define AGG_DEFAULT_TIMEOUT     500    // microseconds
+
+// Each PUT is a header followed by the data, padded to 8 bytes.
+typedef struct {
+  void*   raddr;
+  int64_t size;
+} agg_put_t;
+
+#define AGG_PAD(size) (((size) + 7) & ~(size_t) 7)
+
+// Bit filters of the remote lines PUTs touch.
+#define AGG_LINE_SHIFT  6
+#define AGG_FILTER_BITS 8192
+#define AGG_FILTER_WORDS (AGG_FILTER_BITS / 64)
+
+typedef struct {
+  char*                 data;   // allocated on first use
+  size_t                used;   // bytes of data in use
+  gasnett_tick_t        oldest; // when the first PUT was added
+  uint_least64_t        sent;   // messages sent to this locale, and
+  atomic_uint_least64_t acked;  //   acknowledged
+  uint_least64_t        settled; // sent, when in_flight was last cleared
+  uint64_t              buffered[AGG_FILTER_WORDS]; // lines in data
+  uint64_t              in_flight[AGG_FILTER_WORDS]; // lines sent, unacked
+} agg_buf_t;
+
+typedef struct agg_thread_s {
+  atomic_flag           lock;
+  agg_buf_t*            bufs;   // one per locale
+  struct agg_thread_s*  next;   // on the list of all of them
+} agg_thread_t;
+
+static size_t   agg_buf_size;
+static uint64_t agg_timeout_ns;
+
+CHPL_TLS_DECL(agg_thread_t*, agg_thread);
+CHPL_TLS_DECL(intptr_t, agg_in_handler);
+
+// Every pthread's state, for the polling task.  Entries are only
+// ever added at the head, and are never removed.
+static pthread_mutex_t agg_threads_lock = PTHREAD_MUTEX_INITIALIZER;
+static agg_thread_t*   agg_threads = NULL;
+
+static void AM_agg_put(gasnet_token_t token, void* buf, size_t nbytes,
+                       gasnet_handlerarg_t a0, gasnet_handlerarg_t a1) {
+  char* p = buf;
+  char* end = p + nbytes;
+
+  while (p < end) {
+    agg_put_t put;
+
+    chpl_memcpy(&put, p, sizeof(put));
+    p += sizeof(put);
+    chpl_memcpy(put.raddr, p, put.size);
+    p += AGG_PAD(put.size);
+  }
+
+  GASNET_Safe(gasnet_AMReplyShort3(token, AGG_PUT_ACK, a0, a1,
+                                   (gasnet_handlerarg_t) chpl_nodeID));
+}
+
+static void AM_agg_put_ack(gasnet_token_t token,
+                           gasnet_handlerarg_t a0, gasnet_handlerarg_t a1,
+                           gasnet_handlerarg_t node) {
+  agg_thread_t* t = (agg_thread_t*) (intptr_t)
+                    (((uint64_t) (uint32_t) a0)
+                     | (((uint64_t) (uint32_t) a1) << 32UL));
+  (void) atomic_fetch_add_uint_least64_t(&t->bufs[node].acked, 1);
+}
+
+static void agg_lock(agg_thread_t* t) {
+  while (atomic_flag_test_and_set(&t->lock))
+    ;
+}
+
+static void agg_unlock(agg_thread_t* t) {
+  atomic_flag_clear(&t->lock);
+}
+
+//
+// Mark the lines [raddr, raddr+size) touches in a filter, or find
+// whether any of them are marked.  Ranges wider than the filter are
+// taken to hit it.
+//
+static void agg_filter_mark(uint64_t* filter, void* raddr, size_t size) {
+  uintptr_t line = (uintptr_t) raddr >> AGG_LINE_SHIFT;
+  uintptr_t last = ((uintptr_t) raddr + size - 1) >> AGG_LINE_SHIFT;
+
+  for ( ; line <= last; line++)
+    filter[(line % AGG_FILTER_BITS) / 64] |= (uint64_t) 1 << (line % 64);
+}
+
+static chpl_bool agg_filter_hits(uint64_t* filter, void* raddr, size_t size) {
+  uintptr_t line = (uintptr_t) raddr >> AGG_LINE_SHIFT;
+  uintptr_t last = ((uintptr_t) raddr + size - 1) >> AGG_LINE_SHIFT;
+
+  if (last - line >= AGG_FILTER_BITS)
+    return true;
+  for ( ; line <= last; line++)
+    if (filter[(line % AGG_FILTER_BITS) / 64] & ((uint64_t) 1 << (line % 64)))
+      return true;
+  return false;
+}
+
+//
+// Forget the in-flight lines for a locale once everything sent to it
+// has been acknowledged.  The caller holds t's lock.
+//
+static void agg_settle(agg_thread_t* t, c_nodeid_t node) {
+  agg_buf_t* b = &t->bufs[node];
+
+  if (b->settled != b->sent
+      && atomic_load_uint_least64_t(&b->acked) == b->sent) {
+    memset(b->in_flight, 0, sizeof(b->in_flight));
+    b->settled = b->sent;
+  }
+}
+
+static agg_thread_t* agg_this_thread(void) {
+  agg_thread_t* t = CHPL_TLS_GET(agg_thread);
+  c_nodeid_t    node;
+
+  if (t == NULL) {
+    t = (agg_thread_t*) chpl_mem_alloc(sizeof(*t),
+                                       CHPL_RT_MD_COMM_PUT_AGGREGATION_BUFFER,
+                                       0, 0);
+    atomic_flag_clear(&t->lock);
+    t->bufs = (agg_buf_t*) chpl_mem_allocManyZero(chpl_numNodes,
+                                                  sizeof(agg_buf_t),
+                                         CHPL_RT_MD_COMM_PUT_AGGREGATION_BUFFER,
+                                                  0, 0);
+    for (node = 0; node < chpl_numNodes; node++)
+      atomic_init_uint_least64_t(&t->bufs[node].acked, 0);
+
+    pthread_mutex_lock(&agg_threads_lock);
+    t->next = agg_threads;
+    agg_threads = t;
+    pthread_mutex_unlock(&agg_threads_lock);
+
+    CHPL_TLS_SET(agg_thread, t);
+  }
+
+  return t;
+}
+
+//
+// Send the PUTs buffered for a locale.  The caller holds t's lock.
+//
+static void agg_send(agg_thread_t* t, c_nodeid_t node) {
+  agg_buf_t* b = &t->bufs[node];
+  int        i;
+
+  if (b->used == 0)
+    return;
+  b->sent++;
+  GASNET_Safe(gasnet_AMRequestMedium2(node, AGG_PUT, b->data, b->used,
+                                      AckArg0(t), AckArg1(t)));
+  b->used = 0;
+  for (i = 0; i < AGG_FILTER_WORDS; i++) {
+    b->in_flight[i] |= b->buffered[i];
+    b->buffered[i] = 0;
+  }
+}
+
+static void agg_put(void* addr, c_nodeid_t node, void* raddr, size_t size) {
+  agg_thread_t*  t = agg_this_thread();
+  agg_buf_t*     b = &t->bufs[node];
+  gasnett_tick_t now = gasnett_ticks_now();
+  agg_put_t      put;
+
+  agg_lock(t);
+
+  if (b->data == NULL)
+    b->data = chpl_mem_alloc(agg_buf_size,
+                             CHPL_RT_MD_COMM_PUT_AGGREGATION_BUFFER, 0, 0);
+  if (b->used > 0
+      && (b->used + sizeof(put) + AGG_PAD(size) > agg_buf_size
+          || gasnett_ticks_to_ns(now - b->oldest) >= agg_timeout_ns))
+    agg_send(t, node);
+  if (b->used == 0)
+    b->oldest = now;
+
+  put.raddr = raddr;
+  put.size = size;
+  chpl_memcpy(b->data + b->used, &put, sizeof(put));
+  chpl_memcpy(b->data + b->used + sizeof(put), addr, size);
+  b->used += sizeof(put) + AGG_PAD(size);
+  agg_filter_mark(b->buffered, raddr, size);
+
+  agg_unlock(t);
+}
+
+//
+// Wait until everything sent to a locale is acknowledged.
+//
+static void agg_wait(agg_thread_t* t, c_nodeid_t node, uint_least64_t sent) {
+  if (atomic_load_uint_least64_t(&t->bufs[node].acked) < sent)
+    GASNET_BLOCKUNTIL(atomic_load_uint_least64_t(&t->bufs[node].acked)
+                      >= sent);
+}
+
+//
+// Complete this pthread's buffered PUTs to a locale, or to all of them
+// if node is -1.  This does nothing inside the FORK_FAST handler, which
+// can't send the buffers, and mustn't wait on a lock its pthread may
+// already hold.
+//
+static void agg_flush(c_nodeid_t node) {
+  agg_thread_t*  t = CHPL_TLS_GET(agg_thread);
+  c_nodeid_t     first, last, i;
+  uint_least64_t sent;
+
+  if (t == NULL || (intptr_t) CHPL_TLS_GET(agg_in_handler))
+    return;
+
+  first = (node >= 0) ? node : 0;
+  last = (node >= 0) ? node : chpl_numNodes - 1;
+
+  agg_lock(t);
+  for (i = first; i <= last; i++)
+    agg_send(t, i);
+  agg_unlock(t);
+
+  for (i = first; i <= last; i++) {
+    agg_lock(t);
+    sent = t->bufs[i].sent;
+    agg_unlock(t);
+    agg_wait(t, i, sent);
+    agg_lock(t);
+    agg_settle(t, i);
+    agg_unlock(t);
+  }
+}
+
+//
+// Complete whatever a GET of [raddr, raddr+size) on a locale has to
+// see: the buffer is sent only if it may hold a PUT overlapping that
+// range, and we wait only if such a PUT may be in flight.
+//
+static void agg_flush_for_get(c_nodeid_t node, void* raddr, size_t size) {
+  agg_thread_t*  t = CHPL_TLS_GET(agg_thread);
+  agg_buf_t*     b;
+  uint_least64_t sent = 0;
+
+  if (t == NULL || (intptr_t) CHPL_TLS_GET(agg_in_handler) || size == 0)
+    return;
+
+  b = &t->bufs[node];
+  agg_lock(t);
+  if (b->used > 0 && agg_filter_hits(b->buffered, raddr, size))
+    agg_send(t, node);
+  agg_settle(t, node);
+  if (agg_filter_hits(b->in_flight, raddr, size))
+    sent = b->sent;
+  agg_unlock(t);
+
+  if (sent > 0) {
+    agg_wait(t, node, sent);
+    agg_lock(t);
+    agg_settle(t, node);
+    agg_unlock(t);
+  }
+}
+
+void chpl_comm_aggregate_flush(void) {
+  agg_flush(-1);
+}
+
+//
+// Send every buffer whose oldest PUT has timed out.  Only the polling
+// task calls this.  It skips pthreads that are using their buffers at
+// the moment, since they will check the timeout themselves.
+//
+static void agg_send_stale(void) {
+  static gasnett_tick_t last_check = 0;
+  gasnett_tick_t now = gasnett_ticks_now();
+  agg_thread_t*  t;
+  c_nodeid_t     node;
+
+  if (gasnett_ticks_to_ns(now - last_check) < agg_timeout_ns / 2)
+    return;
+  last_check = now;
+
+  pthread_mutex_lock(&agg_threads_lock);
+  t = agg_threads;
+  pthread_mutex_unlock(&agg_threads_lock);
+
+  for ( ; t != NULL; t = t->next) {
+    if (atomic_flag_test_and_set(&t->lock))
+      continue;
+    for (node = 0; node < chpl_numNodes; node++) {
+      if (t->bufs[node].used > 0
+          && gasnett_ticks_to_ns(now - t->bufs[node].oldest) >= agg_timeout_ns)
+        agg_send(t, node);
+    }
+    agg_unlock(t);
+  }
+}
+
+static void agg_init(void) {
+  char* p;
+
+  if (chpl_numNodes == 1)
+    return;
+  if ((p = getenv("CHPL_RT_COMM_AGGREGATE")) == NULL
+      || strcmp(p, "0") == 0
+      || strcmp(p, "no") == 0
+      || strcmp(p, "false") == 0)
+    return;
+
+  agg_buf_size = AGG_DEFAULT_BUFFER_SIZE;
+  if ((p = getenv("CHPL_RT_COMM_AGGREGATE_BUFFER_SIZE")) != NULL) {
+    long size = atol(p);
+    if (size < (long) (sizeof(agg_put_t) + AGG_MAX_PUT_SIZE))
+      chpl_warning("CHPL_RT_COMM_AGGREGATE_BUFFER_SIZE is too small, "
+                   "using the default", 0, NULL);
+    else
+      agg_buf_size = size;
+  }
+  if (agg_buf_size > gasnet_AMMaxMedium())
+    agg_buf_size = gasnet_AMMaxMedium();
+
+  agg_timeout_ns = AGG_DEFAULT_TIMEOUT * 1000;
+  if ((p = getenv("CHPL_RT_COMM_AGGREGATE_TIMEOUT")) != NULL) {
+    long usecs = atol(p);
+    if (usecs <= 0)
+      chpl_warning("CHPL_RT_COMM_AGGREGATE_TIMEOUT must be a positive "
+                   "number of microseconds, using the default", 0, NULL);
+    else
+      agg_timeout_ns = (uint64_t) usecs * 1000;
+  }
+
+  CHPL_TLS_INIT(agg_thread);
+  CHPL_TLS_INIT(agg_in_handler);
+  chpl_comm_aggregate = 1;
+}
 
 static void AM_fork_fast(gasnet_token_t token, void* buf, size_t nbytes) {
   fork_t *f = buf;
+  intptr_t in_handler = 0;
+
+  if (chpl_comm_aggregate) {
+    in_handler = (intptr_t) CHPL_TLS_GET(agg_in_handler);
+    CHPL_TLS_SET(agg_in_handler, 1);
+  }
 
   if (f->arg_size)
     chpl_ftable_call(f->fid, &f->arg);
   else
     chpl_ftable_call(f->fid, NULL);
 
+  if (chpl_comm_aggregate)
+    CHPL_TLS_SET(agg_in_handler, in_handler);
+
   // Signal that the handler has completed
   GASNET_Safe(gasnet_AMReplyShort2(token, SIGNAL,
                                    AckArg0(f->ack), AckArg1(f->ack)));
@@ -176,6 +565,8 @@ static void fork_wrapper(fork_t *f) {
     chpl_ftable_call(f->fid, &f->arg);
   else
     chpl_ftable_call(f->fid, NULL);
+  if (chpl_comm_aggregate)
+    agg_flush(-1);
   GASNET_Safe(gasnet_AMRequestShort2(f->caller, SIGNAL,
                                      AckArg0(f->ack), AckArg1(f->ack)));
 
@@ -207,6 +598,8 @@ static void fork_large_wrapper(fork_t* f) {
   chpl_comm_get(arg, f->caller, f_arg,
                 f->arg_size, -1 /*typeIndex: unused*/, 1, 0, "fork large");
   chpl_ftable_call(f->fid, arg);
+  if (chpl_comm_aggregate)
+    agg_flush(-1);
   GASNET_Safe(gasnet_AMRequestShort2(f->caller, SIGNAL,
                                      AckArg0(f->ack), AckArg1(f->ack)));
 
@@ -232,12 +625,12 @@ static void fork_nb_wrapper(fork_t *f) {
     chpl_ftable_call(f->fid, &f->arg);
   else
     chpl_ftable_call(f->fid, NULL);
+  if (chpl_comm_aggregate)
+    agg_flush(-1);
   chpl_mem_free(f, 0, 0);
 }
 
-static void AM_fork_nb(gasnet_token_t  token,
-                        void           *buf,
-                        size_t          nbytes) {
+static void fork_nb_start(void* buf, size_t nbytes) {
   fork_t *f = (fork_t*)chpl_mem_allocMany(nbytes, sizeof(char),
                                           CHPL_RT_MD_COMM_FORK_RECV_NB_INFO,
                                           0, 0);
@@ -247,6 +640,12 @@ static void AM_fork_nb(gasnet_token_t  token,
                            f->serial_state);
 }
 
+static void AM_fork_nb(gasnet_token_t  token,
+                        void           *buf,
+                        size_t          nbytes) {
+  fork_nb_start(buf, nbytes);
+}
+
 static void fork_nb_large_wrapper(fork_t* f) {
   void* arg = chpl_mem_allocMany(1, f->arg_size,
                                  CHPL_RT_MD_COMM_FORK_RECV_NB_LARGE_ARG, 0, 0);
@@ -262,6 +661,8 @@ static void fork_nb_large_wrapper(fork_t* f) {
                                       &(f->ack),
                                       sizeof(f->ack)));
   chpl_ftable_call(f->fid, arg);
+  if (chpl_comm_aggregate)
+    agg_flush(-1);
   chpl_mem_free(f, 0, 0);
   chpl_mem_free(arg, 0, 0);
 }
@@ -276,6 +677,279 @@ static void AM_fork_nb_large(gasnet_token_t token, void* buf, size_t nbytes) {
                            f->serial_state);
 }
 
+//
+// Batched non-blocking forks
+//
+// While a task has a batch open (see chpl_comm_fork_nb_batch_start()),
+// its non-blocking forks to other locales whose arguments fit in a
+// medium AM are collected in a buffer instead of being sent one at a
+// time.  When the batch is finished the forks are sorted by locale and
+// sent down a tree.  The sender divides the locales into
+// FORK_TREE_FANOUT ranges and sends the forks for each range to the
+// first locale in it as one FORK_TREE message.  That locale starts its
+// own forks and sends the rest of its range on the same way, so a
+// coforall over N locales is started in about log4(N) steps rather
+// than by N messages from one locale, and forks to the same locale
+// share a message.
+//
+// A FORK_TREE handler can't send AMs itself, so it queues the message
+// for the polling task, which does the forwarding.  That way a subtree
+// doesn't have to wait for a task to become free on its root locale.
+//
+#define FORK_TREE_FANOUT 4
+
+// In the buffer, each fork is a header followed by the fork_t, padded
+// to 8 bytes.  A header with a negative size ends a received message.
+typedef struct {
+  c_nodeid_t node;
+  int32_t    size;      // of the fork_t
+} fork_tree_hdr_t;
+
+#define FORK_TREE_PAD(size) (((size) + 7) & ~(size_t) 7)
+#define FORK_TREE_ENTRY_SIZE(size) (sizeof(fork_tree_hdr_t) + FORK_TREE_PAD(size))
+
+struct fork_batch_s {
+  int    depth;         // of nested batches
+  char*  buf;
+  size_t used;
+  size_t size;
+};
+
+typedef struct fork_tree_msg_s {
+  struct fork_tree_msg_s* next;
+  char                    data[0];  // forks, then an end header
+} fork_tree_msg_t;
+
+static atomic_flag      fork_tree_lock;     // guards the queue below
+static fork_tree_msg_t* volatile fork_tree_head = NULL;
+static fork_tree_msg_t* fork_tree_tail = NULL;
+
+//
+// Returns space for a fork_t of the given size to the given node at the
+// end of the batch.  The space is only good until the next call.
+//
+static fork_t* fork_batch_add(struct fork_batch_s* b,
+                              c_nodeid_t node, int info_size) {
+  size_t           need = FORK_TREE_ENTRY_SIZE(info_size);
+  fork_tree_hdr_t* hdr;
+
+  if (b->used + need > b->size) {
+    size_t size = (b->size == 0) ? 4096 : 2 * b->size;
+    while (size < b->used + need)
+      size *= 2;
+    b->buf = chpl_mem_realloc(b->buf, size,
+                              CHPL_RT_MD_COMM_FORK_BATCH_BUFFER, 0, 0);
+    b->size = size;
+  }
+  hdr = (fork_tree_hdr_t*) (b->buf + b->used);
+  hdr->node = node;
+  hdr->size = info_size;
+  b->used += need;
+  return (fork_t*) (hdr + 1);
+}
+
+// Order by node, and keep the forks to each node in the order made.
+static int fork_tree_hdr_cmp(const void* v1, const void* v2) {
+  const fork_tree_hdr_t* h1 = *(fork_tree_hdr_t* const*) v1;
+  const fork_tree_hdr_t* h2 = *(fork_tree_hdr_t* const*) v2;
+
+  if (h1->node != h2->node)
+    return (h1->node < h2->node) ? -1 : 1;
+  return (h1 < h2) ? -1 : (h1 > h2);
+}
+
+static void fork_tree_send(fork_tree_hdr_t** ents, int n);
+
+//
+// Send the forks in ents[0..n), which are all for one node, as a
+// FORK_TREE message to that node.
+//
+static void fork_tree_send_msg(fork_tree_hdr_t** ents, int n, size_t nbytes) {
+  char* msg = chpl_mem_allocMany(nbytes, sizeof(char),
+                                 CHPL_RT_MD_COMM_FORK_SEND_NB_INFO, 0, 0);
+  char* p = msg;
+  int   i;
+
+  for (i = 0; i < n; i++) {
+    size_t size = FORK_TREE_ENTRY_SIZE(ents[i]->size);
+    chpl_memcpy(p, ents[i], size);
+    p += size;
+  }
+  GASNET_Safe(gasnet_AMRequestMedium0(ents[0]->node, FORK_TREE, msg, nbytes));
+  chpl_mem_free(msg, 0, 0);
+}
+
+//
+// Send the forks in ents[0..n), which cover ngroups nodes, to the first
+// of those nodes, which will pass them on.
+//
+static void fork_tree_send_part(fork_tree_hdr_t** ents, int n, int ngroups) {
+  size_t max = gasnet_AMMaxMedium();
+  size_t nbytes = 0;
+  int    i, lo;
+
+  for (i = 0; i < n; i++)
+    nbytes += FORK_TREE_ENTRY_SIZE(ents[i]->size);
+  if (nbytes <= max) {
+    fork_tree_send_msg(ents, n, nbytes);
+  } else if (ngroups > 1) {
+    // too much for one message; spread it out from here instead
+    fork_tree_send(ents, n);
+  } else {
+    // all for one node; send as many messages as it takes
+    nbytes = 0;
+    for (lo = i = 0; i < n; i++) {
+      size_t size = FORK_TREE_ENTRY_SIZE(ents[i]->size);
+      if (nbytes + size > max) {
+        fork_tree_send_msg(ents + lo, i - lo, nbytes);
+        lo = i;
+        nbytes = 0;
+      }
+      nbytes += size;
+    }
+    fork_tree_send_msg(ents + lo, n - lo, nbytes);
+  }
+}
+
+//
+// Send the forks in ents[0..n), which are sorted by node and are all
+// for other nodes, down the tree.
+//
+static void fork_tree_send(fork_tree_hdr_t** ents, int n) {
+  int* groups;          // index in ents of the first fork to each node
+  int  ngroups = 0;
+  int  i, part;
+
+  groups = chpl_mem_allocMany(n, sizeof(int),
+                              CHPL_RT_MD_COMM_FORK_SEND_NB_INFO, 0, 0);
+  for (i = 0; i < n; i++) {
+    if (i == 0 || ents[i]->node != ents[i - 1]->node)
+      groups[ngroups++] = i;
+  }
+
+  for (part = 0; part < FORK_TREE_FANOUT; part++) {
+    int g_lo = (int) ((int64_t) ngroups * part / FORK_TREE_FANOUT);
+    int g_hi = (int) ((int64_t) ngroups * (part + 1) / FORK_TREE_FANOUT);
+    int lo, hi;
+
+    if (g_lo == g_hi)
+      continue;
+    lo = groups[g_lo];
+    hi = (g_hi == ngroups) ? n : groups[g_hi];
+    fork_tree_send_part(ents + lo, hi - lo, g_hi - g_lo);
+  }
+
+  chpl_mem_free(groups, 0, 0);
+}
+
+static void AM_fork_tree(gasnet_token_t token, void* buf, size_t nbytes) {
+  fork_tree_msg_t* m;
+  fork_tree_hdr_t* end;
+
+  m = chpl_mem_allocMany(1, sizeof(*m) + nbytes + sizeof(*end),
+                         CHPL_RT_MD_COMM_FORK_TREE_INFO, 0, 0);
+  m->next = NULL;
+  chpl_memcpy(m->data, buf, nbytes);
+  end = (fork_tree_hdr_t*) (m->data + nbytes);
+  end->node = chpl_nodeID;
+  end->size = -1;
+
+  while (atomic_flag_test_and_set(&fork_tree_lock))
+    ;
+  if (fork_tree_tail == NULL)
+    fork_tree_head = m;
+  else
+    fork_tree_tail->next = m;
+  fork_tree_tail = m;
+  atomic_flag_clear(&fork_tree_lock);
+}
+
+//
+// Called by the polling task to handle the FORK_TREE messages that
+// have arrived: pass on the forks for other nodes, then start ours.
+//
+static void fork_tree_run(void) {
+  fork_tree_msg_t* m;
+
+  while (atomic_flag_test_and_set(&fork_tree_lock))
+    ;
+  m = fork_tree_head;
+  fork_tree_head = fork_tree_tail = NULL;
+  atomic_flag_clear(&fork_tree_lock);
+
+  while (m != NULL) {
+    fork_tree_msg_t*  next = m->next;
+    fork_tree_hdr_t*  hdr;
+    fork_tree_hdr_t** ents;
+    int               n = 0, own = 0, i;
+
+    for (hdr = (fork_tree_hdr_t*) m->data; hdr->size >= 0;
+         hdr = (fork_tree_hdr_t*) ((char*) hdr + FORK_TREE_ENTRY_SIZE(hdr->size)))
+      n++;
+    ents = chpl_mem_allocMany(n, sizeof(ents[0]),
+                              CHPL_RT_MD_COMM_FORK_TREE_INFO, 0, 0);
+    hdr = (fork_tree_hdr_t*) m->data;
+    for (i = 0; i < n; i++) {
+      ents[i] = hdr;
+      if (hdr->node == chpl_nodeID)
+        own++;
+      hdr = (fork_tree_hdr_t*) ((char*) hdr + FORK_TREE_ENTRY_SIZE(hdr->size));
+    }
+
+    // Our own forks come first, since the sender sorted them by node.
+    if (own < n)
+      fork_tree_send(ents + own, n - own);
+    for (i = 0; i < own; i++)
+      fork_nb_start(ents[i] + 1, ents[i]->size);
+
+    chpl_mem_free(ents, 0, 0);
+    chpl_mem_free(m, 0, 0);
+    m = next;
+  }
+}
+
+void chpl_comm_fork_nb_batch_start(void) {
+  struct fork_batch_s** bp = &chpl_task_getPrvData()->comm_data.fork_batch;
+
+  if (*bp == NULL)
+    *bp = chpl_mem_allocManyZero(1, sizeof(**bp),
+                                 CHPL_RT_MD_COMM_FORK_BATCH_BUFFER, 0, 0);
+  (*bp)->depth++;
+}
+
+void chpl_comm_fork_nb_batch_finish(void) {
+  struct fork_batch_s** bp = &chpl_task_getPrvData()->comm_data.fork_batch;
+  struct fork_batch_s*  b = *bp;
+
+  if (--b->depth > 0)
+    return;
+  *bp = NULL;
+
+  if (b->used > 0) {
+    fork_tree_hdr_t** ents;
+    fork_tree_hdr_t*  hdr;
+    int               n = 0, i;
+
+    for (hdr = (fork_tree_hdr_t*) b->buf; (char*) hdr < b->buf + b->used;
+         hdr = (fork_tree_hdr_t*) ((char*) hdr + FORK_TREE_ENTRY_SIZE(hdr->size)))
+      n++;
+    ents = chpl_mem_allocMany(n, sizeof(ents[0]),
+                              CHPL_RT_MD_COMM_FORK_SEND_NB_INFO, 0, 0);
+    hdr = (fork_tree_hdr_t*) b->buf;
+    for (i = 0; i < n; i++) {
+      ents[i] = hdr;
+      hdr = (fork_tree_hdr_t*) ((char*) hdr + FORK_TREE_ENTRY_SIZE(hdr->size));
+    }
+    qsort(ents, n, sizeof(ents[0]), fork_tree_hdr_cmp);
+    fork_tree_send(ents, n);
+    chpl_mem_free(ents, 0, 0);
+  }
+
+  if (b->buf != NULL)
+    chpl_mem_free(b->buf, 0, 0);
+  chpl_mem_free(b, 0, 0);
+}
+
 static void AM_signal(gasnet_token_t token, gasnet_handlerarg_t a0, gasnet_handlerarg_t a1) {
   done_t* done = (done_t*) (intptr_t)
                  (((uint64_t) (uint32_t) a0)
@@ -351,7 +1025,10 @@ static gasnet_handlerentry_t ftable[] = {
   {PRIV_BCAST_LARGE, AM_priv_bcast_large},
   {FREE,          AM_free},
   {EXIT_ANY,      AM_exit_any},
-  {BCAST_SEGINFO, AM_bcast_seginfo}
+  {BCAST_SEGINFO, AM_bcast_seginfo},
+  {AGG_PUT,       AM_agg_put},
+  {AGG_PUT_ACK,   AM_agg_put_ack},
+  {FORK_TREE,     AM_fork_tree}
 };
 
 //
@@ -365,13 +1042,15 @@ chpl_comm_nb_handle_t chpl_comm_put_nb(void *addr, c_nodeid_t node, void* raddr,
   size_t nbytes = elemSize*len;
   gasnet_handle_t ret;
 
+  if (chpl_comm_aggregate)
+    agg_flush(node);
   ret = gasnet_put_nb_bulk(node, raddr, addr, nbytes);
 
-  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-    chpl_sync_lock(&chpl_comm_diagnostics_sync);
-    chpl_comm_commDiagnostics.put_nb++;
-    chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-  }
+  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+    chpl_comm_diags_incr(put_nb);
+  if (chpl_comm_profile && !chpl_comm_no_debug_private)
+    chpl_comm_profile_record(CHPL_COMM_PROFILE_PUT_NB, node,
+                             (size_t) elemSize * len, ln, fn);
 
   return (chpl_comm_nb_handle_t) ret;
 }
@@ -384,13 +1063,15 @@ chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node, void* raddr,
   size_t nbytes = elemSize*len;
   gasnet_handle_t ret;
 
+  if (chpl_comm_aggregate)
+    agg_flush_for_get(node, raddr, nbytes);
   ret = gasnet_get_nb_bulk(addr, node, raddr, nbytes);
 
-  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-    chpl_sync_lock(&chpl_comm_diagnostics_sync);
-    chpl_comm_commDiagnostics.get_nb++;
-    chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-  }
+  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+    chpl_comm_diags_incr(get_nb);
+  if (chpl_comm_profile && !chpl_comm_no_debug_private)
+    chpl_comm_profile_record(CHPL_COMM_PROFILE_GET_NB, node,
+                             (size_t) elemSize * len, ln, fn);
 
   return (chpl_comm_nb_handle_t) ret;
 }
@@ -451,6 +1132,10 @@ static void polling(void* x) {
   pollingRunning = 1;
   while (!pollingQuit) {
     (void) gasnet_AMPoll();
+    if (chpl_comm_aggregate)
+      agg_send_stale();
+    if (fork_tree_head != NULL)
+      fork_tree_run();
     chpl_task_yield();
   }
   pollingRunning = 0;
@@ -594,21 +1279,21 @@ void chpl_comm_post_task_init(void) {
   //
   pollingRunning = 0;
   pollingQuit = 0;
+  atomic_flag_clear(&fork_tree_lock);
   if (chpl_task_createCommTask(polling, NULL))
     chpl_internal_error("unable to start polling task for gasnet");
   while (!pollingRunning) {
     sched_yield();
   }
 
-  // clear diags
-  memset(&chpl_comm_commDiagnostics, 0, sizeof(chpl_commDiagnostics));
+  // Set up PUT aggregation, if it was asked for.
+  agg_init();
 
   // Initialize the caching layer, if it is active.
   chpl_cache_init();
 }
 
 void chpl_comm_rollcall(void) {
-  chpl_sync_initAux(&chpl_comm_diagnostics_sync);
   chpl_msg(2, "executing on node %d of %d node(s): %s\n", chpl_nodeID, 
            chpl_numNodes, chpl_nodeName());
 }
@@ -697,6 +1382,9 @@ void chpl_comm_barrier(const char *msg) {
   int id = (int) msg[0];
   int retval;
 
+  if (chpl_comm_aggregate)
+    agg_flush(-1);
+
 #ifdef CHPL_COMM_DEBUG
   chpl_msg(2, "%d: enter barrier for '%s'\n", chpl_nodeID, msg);
 #endif
@@ -802,10 +1490,16 @@ void  chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
   } else {
     if (chpl_verbose_comm && !chpl_comm_no_debug_private)
       printf("%d: %s:%d: remote put to %d\n", chpl_nodeID, fn, ln, node);
-    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-      chpl_sync_lock(&chpl_comm_diagnostics_sync);
-      chpl_comm_commDiagnostics.put++;
-      chpl_sync_unlock(&chpl_comm_diagnostics_sync);
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      chpl_comm_diags_incr(put);
+    if (chpl_comm_profile && !chpl_comm_no_debug_private)
+      chpl_comm_profile_record(CHPL_COMM_PROFILE_PUT, node, size, ln, fn);
+    if (chpl_comm_aggregate && !(intptr_t) CHPL_TLS_GET(agg_in_handler)) {
+      if (size <= AGG_MAX_PUT_SIZE) {
+        agg_put(addr, node, raddr, size);
+        return;
+      }
+      agg_flush(node);
     }
     gasnet_put(node, raddr, addr, size); // node, dest, src, size
   }
@@ -823,11 +1517,12 @@ void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
   } else {
     if (chpl_verbose_comm && !chpl_comm_no_debug_private)
       printf("%d: %s:%d: remote get from %d\n", chpl_nodeID, fn, ln, node);
-    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-      chpl_sync_lock(&chpl_comm_diagnostics_sync);
-      chpl_comm_commDiagnostics.get++;
-      chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-    }
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      chpl_comm_diags_incr(get);
+    if (chpl_comm_profile && !chpl_comm_no_debug_private)
+      chpl_comm_profile_record(CHPL_COMM_PROFILE_GET, node, size, ln, fn);
+    if (chpl_comm_aggregate)
+      agg_flush_for_get(node, raddr, size);
     gasnet_get(addr, node, raddr, size); // dest, node, src, size
   }
 }
@@ -881,11 +1576,15 @@ void  chpl_comm_get_strd(void* dstaddr, void* dststrides, c_nodeid_t srcnode_id,
   // the case (chpl_nodeID == srcnode) is internally managed inside gasnet
   if (chpl_verbose_comm && !chpl_comm_no_debug_private)
     printf("%d: %s:%d: remote get from %d\n", chpl_nodeID, fn, ln, srcnode);
-  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-    chpl_sync_lock(&chpl_comm_diagnostics_sync);
-    chpl_comm_commDiagnostics.get++;
-    chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-  }
+  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+    chpl_comm_diags_incr(get);
+  if (chpl_comm_profile && !chpl_comm_no_debug_private)
+    chpl_comm_profile_record(CHPL_COMM_PROFILE_GET_STRD, srcnode_id,
+                             chpl_comm_profile_strd_bytes(count, stridelevels,
+                                                          elemSize),
+                             ln, fn);
+  if (chpl_comm_aggregate)
+    agg_flush(srcnode);
   gasnet_gets_bulk(dstaddr, dststr, srcnode, srcaddr, srcstr, cnt, strlvls); 
 }
 
@@ -931,11 +1630,15 @@ void  chpl_comm_put_strd(void* dstaddr, void* dststrides, c_nodeid_t dstnode_id,
   // the case (chpl_nodeID == dstnode) is internally managed inside gasnet
   if (chpl_verbose_comm && !chpl_comm_no_debug_private)
     printf("%d: %s:%d: remote get from %d\n", chpl_nodeID, fn, ln, dstnode);
-  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-    chpl_sync_lock(&chpl_comm_diagnostics_sync);
-    chpl_comm_commDiagnostics.put++;
-    chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-  }
+  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+    chpl_comm_diags_incr(put);
+  if (chpl_comm_profile && !chpl_comm_no_debug_private)
+    chpl_comm_profile_record(CHPL_COMM_PROFILE_PUT_STRD, dstnode_id,
+                             chpl_comm_profile_strd_bytes(count, stridelevels,
+                                                          elemSize),
+                             ln, fn);
+  if (chpl_comm_aggregate)
+    agg_flush(dstnode);
   gasnet_puts_bulk(dstnode, dstaddr, dststr, srcaddr, srcstr, cnt, strlvls); 
 }
 
@@ -944,8 +1647,11 @@ void  chpl_comm_put_strd(void* dstaddr, void* dststrides, c_nodeid_t dstnode_id,
 ////GASNET - is caller in fork_t redundant? active message can determine this.
 void  chpl_comm_fork(c_nodeid_t node, c_sublocid_t subloc,
                      chpl_fn_int_t fid, void *arg, int32_t arg_size) {
-  fork_t* info;
-  int     info_size;
+  // The fork_t only has to live until we're signalled, so keep it on
+  // the stack.  It always fits in a medium AM.
+  uint64_t infod[(gasnet_AMMaxMedium() + 7) / 8];
+  fork_t*  info = (fork_t*) infod;
+  int      info_size;
   done_t  done;
   int     passArg = sizeof(fork_t) + arg_size <= gasnet_AMMaxMedium();
 
@@ -954,19 +1660,18 @@ void  chpl_comm_fork(c_nodeid_t node, c_sublocid_t subloc,
   } else {
     if (chpl_verbose_comm && !chpl_comm_no_debug_private)
       printf("%d: remote task created on %d\n", chpl_nodeID, node);
-    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-      chpl_sync_lock(&chpl_comm_diagnostics_sync);
-      chpl_comm_commDiagnostics.fork++;
-      chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-    }
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      chpl_comm_diags_incr(fork);
+    if (chpl_comm_profile && !chpl_comm_no_debug_private)
+      chpl_comm_profile_record(CHPL_COMM_PROFILE_FORK, node, arg_size, 0, NULL);
+    if (chpl_comm_aggregate)
+      agg_flush(-1);
 
     if (passArg) {
       info_size = sizeof(fork_t) + arg_size;
     } else {
       info_size = sizeof(fork_t) + sizeof(void*);
     }
-    info = (fork_t*)chpl_mem_allocMany(1, info_size,
-                                       CHPL_RT_MD_COMM_FORK_SEND_INFO, 0, 0);
     info->caller = chpl_nodeID;
     info->subloc = subloc;
     info->ack = &done;
@@ -992,16 +1697,17 @@ void  chpl_comm_fork(c_nodeid_t node, c_sublocid_t subloc,
       chpl_task_yield();
     }
 #endif
-    chpl_mem_free(info, 0, 0);
   }
 }
 
 void  chpl_comm_fork_nb(c_nodeid_t node, c_sublocid_t subloc,
                         chpl_fn_int_t fid, void *arg, int32_t arg_size) {
+  uint64_t infod[(gasnet_AMMaxMedium() + 7) / 8];
   fork_t *info;
   int     info_size;
   int     passArg = (chpl_nodeID == node
                      || sizeof(fork_t) + arg_size <= gasnet_AMMaxMedium());
+  struct fork_batch_s* batch = NULL;
 
   void* argCopy = NULL;
 
@@ -1010,7 +1716,24 @@ void  chpl_comm_fork_nb(c_nodeid_t node, c_sublocid_t subloc,
   } else {
     info_size = sizeof(fork_t) + sizeof(void*);
   }
-  info = (fork_t*)chpl_mem_allocMany(info_size, sizeof(char), CHPL_RT_MD_COMM_FORK_SEND_NB_INFO, 0, 0);
+
+  //
+  // A small remote fork is either added to this task's batch, if it has
+  // one open, or sent from a buffer on the stack.  Otherwise the fork_t
+  // has to outlive this call, so it goes on the heap.
+  //
+  if (chpl_nodeID != node && passArg) {
+    batch = chpl_task_getPrvData()->comm_data.fork_batch;
+    if (batch != NULL
+        && FORK_TREE_ENTRY_SIZE(info_size) <= gasnet_AMMaxMedium())
+      info = fork_batch_add(batch, node, info_size);
+    else {
+      batch = NULL;
+      info = (fork_t*) infod;
+    }
+  } else {
+    info = (fork_t*)chpl_mem_allocMany(info_size, sizeof(char), CHPL_RT_MD_COMM_FORK_SEND_NB_INFO, 0, 0);
+  }
   info->caller = chpl_nodeID;
   info->subloc = subloc;
   info->ack = info; // pass address to free after get in large case
@@ -1039,16 +1762,19 @@ void  chpl_comm_fork_nb(c_nodeid_t node, c_sublocid_t subloc,
   } else {
     if (chpl_verbose_comm && !chpl_comm_no_debug_private)
       printf("%d: remote non-blocking task created on %d\n", chpl_nodeID, node);
-    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-      chpl_sync_lock(&chpl_comm_diagnostics_sync);
-      chpl_comm_commDiagnostics.fork_nb++;
-      chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-    }
-    if (passArg) {
-      GASNET_Safe(gasnet_AMRequestMedium0(node, FORK_NB, info, info_size));
-      chpl_mem_free(info, 0, 0);
-    } else {
-      GASNET_Safe(gasnet_AMRequestMedium0(node, FORK_NB_LARGE, info, info_size));
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      chpl_comm_diags_incr(fork_nb);
+    if (chpl_comm_profile && !chpl_comm_no_debug_private)
+      chpl_comm_profile_record(CHPL_COMM_PROFILE_FORK_NB, node,
+                               arg_size, 0, NULL);
+    if (chpl_comm_aggregate)
+      agg_flush(-1);
+    // (batched forks are sent by chpl_comm_fork_nb_batch_finish())
+    if (batch == NULL) {
+      if (passArg)
+        GASNET_Safe(gasnet_AMRequestMedium0(node, FORK_NB, info, info_size));
+      else
+        GASNET_Safe(gasnet_AMRequestMedium0(node, FORK_NB_LARGE, info, info_size));
     }
   }
 }
@@ -1069,11 +1795,13 @@ void  chpl_comm_fork_fast(c_nodeid_t node, c_sublocid_t subloc,
       if (chpl_verbose_comm && !chpl_comm_no_debug_private)
         printf("%d: remote (no-fork) task created on %d\n",
                chpl_nodeID, node);
-      if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-        chpl_sync_lock(&chpl_comm_diagnostics_sync);
-        chpl_comm_commDiagnostics.fork_fast++;
-        chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-      }
+      if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+        chpl_comm_diags_incr(fork_fast);
+      if (chpl_comm_profile && !chpl_comm_no_debug_private)
+        chpl_comm_profile_record(CHPL_COMM_PROFILE_FORK_FAST, node,
+                                 arg_size, 0, NULL);
+      if (chpl_comm_aggregate)
+        agg_flush(-1);
       info = (fork_t *) &infod;
 
       info->caller = chpl_nodeID;
@@ -1159,51 +1887,65 @@ void chpl_stopCommDiagnosticsHere() {
 }
 
 void chpl_resetCommDiagnosticsHere() {
-  chpl_sync_lock(&chpl_comm_diagnostics_sync);
-  memset(&chpl_comm_commDiagnostics, 0, sizeof(chpl_commDiagnostics));
-  chpl_sync_unlock(&chpl_comm_diagnostics_sync);
+  chpl_comm_diags_reset();
 }
 
 void chpl_getCommDiagnosticsHere(chpl_commDiagnostics *cd) {
-  chpl_sync_lock(&chpl_comm_diagnostics_sync);
-  chpl_memcpy(cd, &chpl_comm_commDiagnostics, sizeof(chpl_commDiagnostics));
-  chpl_sync_unlock(&chpl_comm_diagnostics_sync);
+  chpl_comm_diags_copy(cd);
 }
 
 uint64_t chpl_numCommGets(void) {
-  return chpl_comm_commDiagnostics.get;
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.get;
 }
 
 uint64_t chpl_numCommNBGets(void) {
-  return chpl_comm_commDiagnostics.get_nb;
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.get_nb;
 }
 
 uint64_t chpl_numCommTestNBGets(void) {
-  return chpl_comm_commDiagnostics.get_nb_test;
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.get_nb_test;
 }
 
 uint64_t chpl_numCommWaitNBGets(void) {
-  return chpl_comm_commDiagnostics.get_nb_wait;
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.get_nb_wait;
 }
 
 uint64_t chpl_numCommPuts(void) {
-  return chpl_comm_commDiagnostics.put;
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.put;
 }
 
 uint64_t chpl_numCommNBPuts(void) {
-  return chpl_comm_commDiagnostics.put_nb;
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.put_nb;
 }
 
 uint64_t chpl_numCommFastForks(void) {
-  return chpl_comm_commDiagnostics.fork_fast;
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.fork_fast;
 }
 
 uint64_t chpl_numCommForks(void) {
-  return chpl_comm_commDiagnostics.fork;
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.fork;
 }
 
 uint64_t chpl_numCommNBForks(void) {
-  return chpl_comm_commDiagnostics.fork_nb;
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.fork_nb;
 }
 
 
@@ -499,6 +499,9 @@ void chpl_comm_fork_nb(c_nodeid_t node, c_sublocid_t subloc,
                            subloc, chpl_nullTaskID, false);
 }
 
+void chpl_comm_fork_nb_batch_start(void) { }
+void chpl_comm_fork_nb_batch_finish(void) { }
+
 // Same as chpl_comm_fork()
 void chpl_comm_fork_fast(c_nodeid_t node, c_sublocid_t subloc,
                          chpl_fn_int_t fid, void *arg, int32_t arg_size) {
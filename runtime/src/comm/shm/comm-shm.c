@@ -0,0 +1,1264 @@
+/*
+ * Copyright 2004-2014 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Shared-memory comm layer.
+//
+// This runs each locale as its own process on a single shared-memory
+// machine.  chpl_comm_init() maps one shared segment and then forks a
+// process per locale, so the segment is at the same address in all of
+// them.  The segment holds a control area, a message queue per locale,
+// and a heap per locale that the memory layer allocates from.  Since
+// every locale can address every other locale's heap directly, PUTs
+// and GETs are just memory copies.  Forks and private broadcasts are
+// sent as messages through a lock-free queue belonging to the target
+// locale, and that locale's polling task takes them off and runs them.
+//
+// The process that called chpl_comm_init() doesn't become a locale
+// itself.  It waits for the locale processes, and if one of them exits
+// other than by a collective exit it kills the rest, so that the job
+// as a whole ends with that locale's status.
+//
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-comm-diags.h"
+#include "chpl-mem.h"
+#include "chplsys.h"
+#include "chpl-tasks.h"
+#include "chplcgfns.h"
+#include "chpl-gen-includes.h"
+#include "chpl-atomics.h"
+#include "error.h"
+
+// Don't get warning macros for chpl_comm_get etc
+#include "chpl-comm-no-warning-macros.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/prctl.h>
+#endif
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+static int chpl_comm_no_debug_private = 0;
+
+
+//
+// This is the type of object we use to wait for a message to be
+// handled.  It has to live in the shared segment, so the sender
+// allocates it on its heap.  Initialize the count to 0 and the target
+// to the number of acknowledgements you expect, send the messages,
+// then WAIT_DONE_OBJ() until they have all come back.
+//
+typedef struct {
+  atomic_uint_least32_t count;
+  uint_least32_t        target;
+} done_t;
+
+#define INIT_DONE_OBJ(done, _target) do {                               \
+    atomic_init_uint_least32_t(&(done).count, 0);                       \
+    (done).target = _target;                                            \
+  } while (0)
+
+#define SIGNAL_DONE_OBJ(done) \
+  (void) atomic_fetch_add_uint_least32_t(&(done)->count, 1)
+
+#define WAIT_DONE_OBJ(done) do {                                        \
+    while (atomic_load_uint_least32_t(&(done).count) < (done).target)   \
+      chpl_task_yield();                                                \
+  } while (0)
+
+typedef struct {
+  int           caller;
+  c_sublocid_t  subloc;
+  done_t*       ack;
+  chpl_bool     serial_state; // true if not allowed to spawn new threads
+  chpl_fn_int_t fid;
+  int           arg_size;
+  char          arg[0];       // variable-sized data here
+} fork_t;
+
+typedef struct {
+  done_t* ack;
+  int     id;       // private broadcast table entry to update
+  int     size;     // size of data
+  void*   data;     // data, on the sender's heap
+} priv_bcast_t;
+
+//
+// Message kinds
+//
+typedef enum {
+  AM_FORK,          // synchronous fork
+  AM_FORK_LARGE,    // synchronous fork with a huge argument
+  AM_FORK_NB,       // non-blocking fork
+  AM_FORK_NB_LARGE, // non-blocking fork with a huge argument
+  AM_FORK_FAST,     // run the function in the handler (use with care)
+  AM_PRIV_BCAST,    // put data at addr (used for private broadcast)
+  AM_FREE           // free data at addr
+} am_kind_t;
+
+//
+// Each locale has a bounded queue of message slots that any locale
+// may add to and only its own polling task removes from.  A slot's
+// sequence number says whose turn it is: a sender may fill the slot
+// for queue position pos when seq == pos, and the polling task may
+// handle it when seq == pos + 1.  Arguments too big to fit in a slot
+// are passed by address.
+//
+#define AM_QUEUE_LEN  1024
+#define AM_MAX_MEDIUM 512
+#define AM_POLL_BATCH 64
+#define CACHE_LINE    64
+
+typedef struct {
+  atomic_uint_least64_t seq;
+  am_kind_t             kind;
+  int                   nbytes;
+  union {
+    char    buf[AM_MAX_MEDIUM];
+    int64_t align;
+  } u;
+} am_slot_t;
+
+typedef struct {
+  atomic_uint_least64_t tail;   // next position a sender will claim
+  char                  pad0[CACHE_LINE - sizeof(atomic_uint_least64_t)];
+  uint_least64_t        head;   // next position the polling task takes
+  char                  pad1[CACHE_LINE - sizeof(uint_least64_t)];
+  am_slot_t             slots[AM_QUEUE_LEN];
+} am_queue_t;
+
+//
+// The control area at the start of the shared segment.  Since the
+// segment is at the same address in every locale, it can hold
+// pointers into itself.
+//
+typedef struct {
+  size_t                heapSize;       // bytes in each locale's heap
+  char*                 heaps;          // locale i's heap: heaps+i*heapSize
+  pid_t*                pids;           // locale processes
+  am_queue_t*           queues;         // message queue for each locale
+  wide_ptr_t*           globals;        // locale 0's global var registry
+  atomic_uint_least32_t barrierCount;
+  atomic_uint_least32_t barrierGeneration;
+  atomic_uint_least32_t exitingAll;     // set by a collective exit
+  atomic_uint_least32_t exitingAny;     // 1 + status of a single
+                                        //   locale's exit, if any
+} shm_ctl_t;
+
+static shm_ctl_t* ctl = NULL;
+
+
+//
+// Message queues
+//
+static void am_send(c_nodeid_t node, am_kind_t kind,
+                    void* payload, size_t nbytes) {
+  am_queue_t*    q = &ctl->queues[node];
+  am_slot_t*     slot;
+  uint_least64_t pos;
+
+  assert(nbytes <= AM_MAX_MEDIUM);
+
+  pos = atomic_load_uint_least64_t(&q->tail);
+  while (1) {
+    int_least64_t diff;
+
+    slot = &q->slots[pos % AM_QUEUE_LEN];
+    diff = (int_least64_t) (atomic_load_uint_least64_t(&slot->seq) - pos);
+    if (diff == 0) {
+      if (atomic_compare_exchange_strong_uint_least64_t(&q->tail,
+                                                        pos, pos + 1))
+        break;
+    } else if (diff < 0) {
+      // The queue is full; give its polling task a chance to catch up.
+      chpl_task_yield();
+    }
+    pos = atomic_load_uint_least64_t(&q->tail);
+  }
+
+  slot->kind = kind;
+  slot->nbytes = (int) nbytes;
+  chpl_memcpy(slot->u.buf, payload, nbytes);
+  atomic_store_uint_least64_t(&slot->seq, pos + 1);
+}
+
+static void fork_wrapper(fork_t *f) {
+  if (f->arg_size)
+    chpl_ftable_call(f->fid, &f->arg);
+  else
+    chpl_ftable_call(f->fid, NULL);
+  SIGNAL_DONE_OBJ(f->ack);
+
+  chpl_mem_free(f, 0, 0);
+}
+
+static void fork_large_wrapper(fork_t* f) {
+  void* arg;
+
+  // The caller is waiting for us, so its copy of the argument stays put
+  // and we can use it where it is.  See "A note on strict aliasing" in
+  // comm-gasnet.c for why we copy the pointer out this way.
+  chpl_memcpy(&arg, f->arg, sizeof(void*));
+
+  chpl_ftable_call(f->fid, arg);
+  SIGNAL_DONE_OBJ(f->ack);
+
+  chpl_mem_free(f, 0, 0);
+}
+
+static void fork_nb_wrapper(fork_t *f) {
+  if (f->arg_size)
+    chpl_ftable_call(f->fid, &f->arg);
+  else
+    chpl_ftable_call(f->fid, NULL);
+  chpl_mem_free(f, 0, 0);
+}
+
+static void fork_nb_large_wrapper(fork_t* f) {
+  void* arg = chpl_mem_allocMany(1, f->arg_size,
+                                 CHPL_RT_MD_COMM_FORK_RECV_NB_LARGE_ARG, 0, 0);
+  void* f_arg;
+
+  chpl_memcpy(&f_arg, f->arg, sizeof(void*));
+  chpl_memcpy(arg, f_arg, f->arg_size);
+
+  // Only the caller can free memory on its own heap.
+  am_send(f->caller, AM_FREE, &f_arg, sizeof(f_arg));
+
+  chpl_ftable_call(f->fid, arg);
+  chpl_mem_free(f, 0, 0);
+  chpl_mem_free(arg, 0, 0);
+}
+
+static void am_start_fork(fork_t* msg, size_t nbytes,
+                          chpl_mem_descInt_t description,
+                          void (*wrapper)(fork_t*)) {
+  fork_t* f = (fork_t*)chpl_mem_allocMany(1, nbytes, description, 0, 0);
+
+  chpl_memcpy(f, msg, nbytes);
+  chpl_task_startMovedTask((chpl_fn_p)wrapper, (void*)f,
+                           f->subloc, chpl_nullTaskID,
+                           f->serial_state);
+}
+
+static void am_handle(am_kind_t kind, void* buf, size_t nbytes) {
+  switch (kind) {
+  case AM_FORK:
+    am_start_fork(buf, nbytes, CHPL_RT_MD_COMM_FORK_RECV_INFO,
+                  fork_wrapper);
+    break;
+  case AM_FORK_LARGE:
+    am_start_fork(buf, nbytes, CHPL_RT_MD_COMM_FORK_RECV_LARGE_INFO,
+                  fork_large_wrapper);
+    break;
+  case AM_FORK_NB:
+    am_start_fork(buf, nbytes, CHPL_RT_MD_COMM_FORK_RECV_NB_INFO,
+                  fork_nb_wrapper);
+    break;
+  case AM_FORK_NB_LARGE:
+    am_start_fork(buf, nbytes, CHPL_RT_MD_COMM_FORK_RECV_NB_LARGE_INFO,
+                  fork_nb_large_wrapper);
+    break;
+  case AM_FORK_FAST:
+    {
+      fork_t* f = buf;
+
+      if (f->arg_size)
+        chpl_ftable_call(f->fid, &f->arg);
+      else
+        chpl_ftable_call(f->fid, NULL);
+      SIGNAL_DONE_OBJ(f->ack);
+    }
+    break;
+  case AM_PRIV_BCAST:
+    {
+      priv_bcast_t* pbp = buf;
+
+      chpl_memcpy(chpl_private_broadcast_table[pbp->id], pbp->data,
+                  pbp->size);
+      SIGNAL_DONE_OBJ(pbp->ack);
+    }
+    break;
+  case AM_FREE:
+    {
+      void* addr;
+
+      chpl_memcpy(&addr, buf, sizeof(void*));
+      chpl_mem_free(addr, 0, 0);
+    }
+    break;
+  default:
+    chpl_internal_error("unknown shm comm message");
+  }
+}
+
+//
+// Handle what is waiting on our queue, up to a batch of messages, and
+// return the number handled.  Only the polling task calls this.
+//
+static int am_poll(void) {
+  am_queue_t* q = &ctl->queues[chpl_nodeID];
+  int         handled = 0;
+
+  while (handled < AM_POLL_BATCH) {
+    am_slot_t* slot = &q->slots[q->head % AM_QUEUE_LEN];
+
+    if (atomic_load_uint_least64_t(&slot->seq) != q->head + 1)
+      break;
+    am_handle(slot->kind, slot->u.buf, slot->nbytes);
+    atomic_store_uint_least64_t(&slot->seq, q->head + AM_QUEUE_LEN);
+    q->head++;
+    handled++;
+  }
+
+  return handled;
+}
+
+
+//
+// Chapel interface starts here
+//
+chpl_comm_nb_handle_t chpl_comm_put_nb(void *addr, c_nodeid_t node, void* raddr,
+                                       int32_t elemSize, int32_t typeIndex,
+                                       int32_t len,
+                                       int ln, c_string fn)
+{
+  chpl_memcpy(raddr, addr, elemSize*len);
+
+  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+    chpl_comm_diags_incr(put_nb);
+  if (chpl_comm_profile && !chpl_comm_no_debug_private)
+    chpl_comm_profile_record(CHPL_COMM_PROFILE_PUT_NB, node,
+                             (size_t) elemSize * len, ln, fn);
+
+  return NULL;
+}
+
+chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node, void* raddr,
+                                       int32_t elemSize, int32_t typeIndex,
+                                       int32_t len,
+                                       int ln, c_string fn)
+{
+  chpl_memcpy(addr, raddr, elemSize*len);
+
+  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+    chpl_comm_diags_incr(get_nb);
+  if (chpl_comm_profile && !chpl_comm_no_debug_private)
+    chpl_comm_profile_record(CHPL_COMM_PROFILE_GET_NB, node,
+                             (size_t) elemSize * len, ln, fn);
+
+  return NULL;
+}
+
+int chpl_comm_nb_handle_is_complete(chpl_comm_nb_handle_t h)
+{
+  return ((void*)h) == NULL;
+}
+
+void chpl_comm_nb_wait_some(chpl_comm_nb_handle_t* h, size_t nhandles)
+{
+  size_t i;
+  for( i = 0; i < nhandles; i++ ) {
+    assert(h[i] == NULL);
+  }
+}
+
+int chpl_comm_is_in_segment(c_nodeid_t node, void* start, size_t len)
+{
+  uintptr_t segstart, segend;
+  uintptr_t reqstart, reqend;
+
+  segstart = (uintptr_t) (ctl->heaps + node * ctl->heapSize);
+  segend = segstart + ctl->heapSize;
+  reqstart = (uintptr_t) start;
+  reqend = reqstart + len;
+
+  return (segstart <= reqstart && reqend <= segend);
+}
+
+int32_t chpl_comm_getMaxThreads(void) {
+  return 0;
+}
+
+//
+// On all locales, we'll do the polling in a thread of control managed
+// by the tasking layer, as the GASNet comm layer does.
+//
+static volatile int pollingRunning;
+static volatile int pollingQuit;
+
+static void polling(void* x) {
+  pollingRunning = 1;
+  while (!pollingQuit) {
+    if (am_poll() == 0) {
+      //
+      // If another locale has exited on its own, follow it.  We can't
+      // run the normal exit code here, but we can at least make sure
+      // our buffered output isn't lost.
+      //
+      uint_least32_t exiting = atomic_load_uint_least32_t(&ctl->exitingAny);
+      if (exiting != 0) {
+        fflush(stdout);
+        fflush(stderr);
+        _exit((int) exiting - 1);
+      }
+      chpl_task_yield();
+    }
+  }
+  pollingRunning = 0;
+}
+
+//
+// The number of locales is needed before the arguments are parsed in
+// earnest, so look for -nl or --numLocales here.  parseArgs() checks
+// the value properly later on, and chpl_comm_verify_num_locales()
+// makes sure it agrees with the number of locales we started.
+//
+static int32_t get_num_locales_arg(int argc, char* argv[]) {
+  int i;
+
+  for (i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+
+    if (strcmp(arg, "--") == 0)
+      break;
+    if (strncmp(arg, "-nl", 3) == 0) {
+      if (arg[3] != '\0')
+        return atoi(&arg[3]);
+      if (i + 1 < argc)
+        return atoi(argv[i + 1]);
+    } else if (strncmp(arg, "--numLocales=", 13) == 0) {
+      return atoi(&arg[13]);
+    } else if (strcmp(arg, "--numLocales") == 0 && i + 1 < argc) {
+      return atoi(argv[i + 1]);
+    }
+  }
+
+  return 0;
+}
+
+static size_t round_up(size_t size, size_t align) {
+  return (size + align - 1) / align * align;
+}
+
+static void map_segment(void) {
+  size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+  size_t heapSize, ctlSize, queuesOffset, pidsOffset, globalsOffset;
+  char*  seg;
+
+  if ((heapSize = chpl_comm_getenvMaxHeapSize()) == 0)
+    heapSize = chpl_bytesPerLocale() / chpl_numNodes;
+  heapSize = heapSize / pageSize * pageSize;
+  if (heapSize == 0)
+    chpl_error("The shm comm layer heap size is too small", 0, NULL);
+
+  queuesOffset = round_up(sizeof(shm_ctl_t), CACHE_LINE);
+  pidsOffset = queuesOffset + chpl_numNodes * sizeof(am_queue_t);
+  globalsOffset = round_up(pidsOffset + chpl_numNodes * sizeof(pid_t),
+                           sizeof(wide_ptr_t));
+  ctlSize = round_up(globalsOffset
+                     + chpl_numGlobalsOnHeap * sizeof(wide_ptr_t),
+                     pageSize);
+
+  //
+  // The heaps are reserved but not backed until they are touched, and
+  // since each locale touches its own heap first its pages come from
+  // memory near where it runs.
+  //
+  seg = mmap(NULL, ctlSize + chpl_numNodes * heapSize,
+             PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (seg == MAP_FAILED) {
+    char msg[100];
+    snprintf(msg, sizeof(msg),
+             "Cannot map the shm comm layer segment: %s", strerror(errno));
+    chpl_error(msg, 0, NULL);
+  }
+
+  // A fresh anonymous mapping is zero-filled, which initializes the
+  // counters and sequence numbers that need to start at 0.
+  ctl = (shm_ctl_t*) seg;
+  ctl->heapSize = heapSize;
+  ctl->heaps = seg + ctlSize;
+  ctl->queues = (am_queue_t*) (seg + queuesOffset);
+  ctl->pids = (pid_t*) (seg + pidsOffset);
+  ctl->globals = (wide_ptr_t*) (seg + globalsOffset);
+
+  {
+    int node;
+    uint_least64_t pos;
+
+    for (node = 0; node < chpl_numNodes; node++) {
+      for (pos = 0; pos < AM_QUEUE_LEN; pos++)
+        atomic_init_uint_least64_t(&ctl->queues[node].slots[pos].seq, pos);
+    }
+  }
+}
+
+#ifdef __linux__
+static int read_cpulist(int numaNode, cpu_set_t* cpus) {
+  char  path[64];
+  FILE* f;
+  int   lo, hi, cpu;
+  char  sep;
+
+  snprintf(path, sizeof(path),
+           "/sys/devices/system/node/node%d/cpulist", numaNode);
+  if ((f = fopen(path, "r")) == NULL)
+    return 0;
+  while (fscanf(f, "%d", &lo) == 1) {
+    hi = lo;
+    if (fscanf(f, "%c", &sep) == 1 && sep == '-') {
+      if (fscanf(f, "%d", &hi) != 1)
+        break;
+      if (fscanf(f, "%c", &sep) != 1)
+        sep = '\n';
+    }
+    for (cpu = lo; cpu <= hi && cpu < CPU_SETSIZE; cpu++)
+      CPU_SET(cpu, cpus);
+    if (sep != ',')
+      break;
+  }
+  fclose(f);
+  return 1;
+}
+
+//
+// Give each locale its own share of the CPUs we may run on.  If the
+// NUMA nodes can be divided evenly among the locales, each locale gets
+// whole NUMA nodes; otherwise the CPUs are split into equal contiguous
+// ranges.  The tasking layer and the locale models see only the CPUs
+// a locale is bound to, so they size themselves to its share.  Setting
+// CHPL_RT_SHM_BIND_CPUS to "0", "no" or "false" turns this off.
+//
+static void bind_locale_cpus(void) {
+  char*     p;
+  cpu_set_t allowed, mine;
+  int       numNumaNodes, numCpus, cpu, i;
+
+  if ((p = getenv("CHPL_RT_SHM_BIND_CPUS")) != NULL
+      && (strcmp(p, "0") == 0
+          || strcmp(p, "no") == 0
+          || strcmp(p, "false") == 0))
+    return;
+
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    return;
+
+  CPU_ZERO(&mine);
+  for (numNumaNodes = 0; ; numNumaNodes++) {
+    cpu_set_t numaCpus;
+
+    CPU_ZERO(&numaCpus);
+    if (!read_cpulist(numNumaNodes, &numaCpus))
+      break;
+  }
+
+  if (numNumaNodes >= chpl_numNodes && numNumaNodes % chpl_numNodes == 0) {
+    int perLocale = numNumaNodes / chpl_numNodes;
+
+    for (i = chpl_nodeID * perLocale; i < (chpl_nodeID + 1) * perLocale; i++)
+      read_cpulist(i, &mine);
+    CPU_AND(&mine, &mine, &allowed);
+  }
+
+  if (CPU_COUNT(&mine) == 0) {
+    numCpus = CPU_COUNT(&allowed);
+    if (numCpus < chpl_numNodes)
+      return;
+    for (cpu = 0, i = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &allowed)) {
+        if (i * chpl_numNodes / numCpus == chpl_nodeID)
+          CPU_SET(cpu, &mine);
+        i++;
+      }
+    }
+  }
+
+  (void) sched_setaffinity(0, sizeof(mine), &mine);
+}
+#endif
+
+static void kill_locales(void) {
+  int node;
+
+  for (node = 0; node < chpl_numNodes; node++)
+    (void) kill(ctl->pids[node], SIGKILL);
+}
+
+//
+// Wait for the locale processes and return the job's exit status.  If
+// a locale exits other than by a collective exit, the job ends with
+// its status.  The other locales follow it on their own if it exited
+// through chpl_comm_exit(); otherwise, or if they take too long about
+// it, we kill them.
+//
+#define SHM_EXIT_GRACE_SECS 10
+
+static int supervise_locales(void) {
+  int numRunning = chpl_numNodes;
+  int status = 0;
+  int killSig = 0;
+  int stopping = 0;
+  int waited = 0;
+
+  while (numRunning > 0) {
+    int   wstatus, node, nodeStatus;
+    pid_t pid = waitpid(-1, &wstatus, stopping ? WNOHANG : 0);
+
+    if (pid == 0) {
+      if (++waited == SHM_EXIT_GRACE_SECS * 100)
+        kill_locales();
+      usleep(10000);
+      continue;
+    }
+    if (pid == -1) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    for (node = 0; node < chpl_numNodes && ctl->pids[node] != pid; node++)
+      ;
+    if (node == chpl_numNodes || !(WIFEXITED(wstatus)
+                                   || WIFSIGNALED(wstatus)))
+      continue;
+    numRunning--;
+
+    nodeStatus = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus)
+                                    : 128 + WTERMSIG(wstatus);
+    if (stopping)
+      continue;
+    if (atomic_load_uint_least32_t(&ctl->exitingAll)) {
+      if (node == 0)
+        status = nodeStatus;
+    } else {
+      status = nodeStatus;
+      if (WIFSIGNALED(wstatus))
+        killSig = WTERMSIG(wstatus);
+      if (!atomic_load_uint_least32_t(&ctl->exitingAny))
+        kill_locales();
+      stopping = 1;
+    }
+  }
+
+  if (killSig != 0) {
+    signal(killSig, SIG_DFL);
+    (void) kill(getpid(), killSig);
+  }
+
+  return status;
+}
+
+static void start_locales(void) {
+  int   node;
+  pid_t supervisor = getpid();
+
+  fflush(stdout);
+  fflush(stderr);
+
+  for (node = 0; node < chpl_numNodes; node++) {
+    pid_t pid = fork();
+
+    if (pid == -1) {
+      chpl_error("Cannot fork the shm comm layer locale processes", 0, NULL);
+    } else if (pid == 0) {
+#ifdef __linux__
+      // Go away if the supervisor does.
+      (void) prctl(PR_SET_PDEATHSIG, SIGKILL);
+      if (getppid() != supervisor)
+        _exit(1);
+#endif
+      chpl_nodeID = node;
+      return;
+    }
+    ctl->pids[node] = pid;
+  }
+
+  _exit(supervise_locales());
+}
+
+void chpl_comm_init(int *argc_p, char ***argv_p) {
+  int32_t numLocales = get_num_locales_arg(*argc_p, *argv_p);
+
+  chpl_numNodes = (numLocales > 1) ? numLocales : 1;
+  chpl_nodeID = 0;
+
+  map_segment();
+
+  if (chpl_numNodes > 1) {
+    start_locales();
+#ifdef __linux__
+    bind_locale_cpus();
+#endif
+  }
+}
+
+void chpl_comm_post_mem_init(void) { }
+
+//
+// No support for gdb for now
+//
+int chpl_comm_run_in_gdb(int argc, char* argv[], int gdbArgnum, int* status) {
+  return 0;
+}
+
+int chpl_comm_numPollingTasks(void) {
+  return (chpl_numNodes > 1) ? 1 : 0;
+}
+
+void chpl_comm_post_task_init(void) {
+  //
+  // Start a polling task on each locale.
+  //
+  if (chpl_numNodes > 1) {
+    pollingRunning = 0;
+    pollingQuit = 0;
+    if (chpl_task_createCommTask(polling, NULL))
+      chpl_internal_error("unable to start polling task for shm");
+    while (!pollingRunning) {
+      sched_yield();
+    }
+  }
+}
+
+void chpl_comm_rollcall(void) {
+  chpl_msg(2, "executing on node %d of %d node(s): %s\n", chpl_nodeID,
+           chpl_numNodes, chpl_nodeName());
+}
+
+void chpl_comm_desired_shared_heap(void** start_p, size_t* size_p) {
+  *start_p = ctl->heaps + chpl_nodeID * ctl->heapSize;
+  *size_p  = ctl->heapSize;
+}
+
+void chpl_comm_shm_help_register_global_var(int i, wide_ptr_t wide_addr) {
+  if (chpl_nodeID == 0) {
+    ctl->globals[i] = wide_addr;
+  }
+}
+
+void chpl_comm_broadcast_global_vars(int numGlobals) {
+  int i;
+  if (chpl_nodeID != 0) {
+    for (i = 0; i < numGlobals; i++) {
+      chpl_memcpy(chpl_globals_registry[i], &ctl->globals[i],
+                  sizeof(wide_ptr_t));
+    }
+  }
+}
+
+void chpl_comm_broadcast_private(int id, int32_t size, int32_t tid) {
+  int          node;
+  done_t*      done;
+  priv_bcast_t pb;
+
+  if (chpl_numNodes == 1)
+    return;
+
+  done = (done_t*) chpl_mem_alloc(sizeof(*done),
+                                  CHPL_RT_MD_COMM_FORK_DONE_FLAG, 0, 0);
+  INIT_DONE_OBJ(*done, chpl_numNodes - 1);
+  pb.ack = done;
+  pb.id = id;
+  pb.size = size;
+  pb.data = chpl_mem_allocMany(1, size,
+                               CHPL_RT_MD_COMM_PRIVATE_BROADCAST_DATA, 0, 0);
+  chpl_memcpy(pb.data, chpl_private_broadcast_table[id], size);
+
+  for (node = 0; node < chpl_numNodes; node++) {
+    if (node != chpl_nodeID)
+      am_send(node, AM_PRIV_BCAST, &pb, sizeof(pb));
+  }
+
+  // wait for the handlers to complete
+  WAIT_DONE_OBJ(*done);
+  chpl_mem_free(pb.data, 0, 0);
+  chpl_mem_free(done, 0, 0);
+}
+
+void chpl_comm_barrier(const char *msg) {
+  uint_least32_t generation;
+
+#ifdef CHPL_COMM_DEBUG
+  chpl_msg(2, "%d: enter barrier for '%s'\n", chpl_nodeID, msg);
+#endif
+
+  generation = atomic_load_uint_least32_t(&ctl->barrierGeneration);
+  if (atomic_fetch_add_uint_least32_t(&ctl->barrierCount, 1)
+      == chpl_numNodes - 1) {
+    atomic_store_uint_least32_t(&ctl->barrierCount, 0);
+    (void) atomic_fetch_add_uint_least32_t(&ctl->barrierGeneration, 1);
+  } else {
+    while (atomic_load_uint_least32_t(&ctl->barrierGeneration) == generation)
+      chpl_task_yield();
+  }
+}
+
+void chpl_comm_pre_task_exit(int all) {
+  if (all) {
+    chpl_comm_barrier("stop polling");
+
+    //
+    // Tell the polling task to halt, then wait for it to do so.
+    //
+    if (chpl_numNodes > 1) {
+      pollingQuit = 1;
+      while (pollingRunning) {
+        sched_yield();
+      }
+    }
+  }
+}
+
+void chpl_comm_exit(int all, int status) {
+  //
+  // For a collective exit, let the supervisor know that the locales
+  // are going away on purpose.  Otherwise, tell the other locales'
+  // polling tasks to exit too.  Only the first such exit counts.
+  //
+  if (all) {
+    atomic_store_uint_least32_t(&ctl->exitingAll, 1);
+    chpl_comm_barrier("chpl_comm_exit");
+  } else if (chpl_numNodes > 1) {
+    (void) atomic_compare_exchange_strong_uint_least32_t(&ctl->exitingAny, 0,
+                                                         1 + (status & 0xff));
+  }
+}
+
+void  chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
+                    int32_t elemSize, int32_t typeIndex, int32_t len,
+                    int ln, c_string fn) {
+  const int size = elemSize*len;
+  if (chpl_nodeID != node) {
+    if (chpl_verbose_comm && !chpl_comm_no_debug_private)
+      printf("%d: %s:%d: remote put to %d\n", chpl_nodeID, fn, ln, node);
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      chpl_comm_diags_incr(put);
+    if (chpl_comm_profile && !chpl_comm_no_debug_private)
+      chpl_comm_profile_record(CHPL_COMM_PROFILE_PUT, node, size, ln, fn);
+  }
+  memmove(raddr, addr, size);
+}
+
+void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
+                    int32_t elemSize, int32_t typeIndex, int32_t len,
+                    int ln, c_string fn) {
+  const int size = elemSize*len;
+  if (chpl_nodeID != node) {
+    if (chpl_verbose_comm && !chpl_comm_no_debug_private)
+      printf("%d: %s:%d: remote get from %d\n", chpl_nodeID, fn, ln, node);
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      chpl_comm_diags_incr(get);
+    if (chpl_comm_profile && !chpl_comm_no_debug_private)
+      chpl_comm_profile_record(CHPL_COMM_PROFILE_GET, node, size, ln, fn);
+  }
+  memmove(addr, raddr, size);
+}
+
+//
+// Copy a strided region.  Level 0 is a contiguous run of cnt[0] bytes;
+// level L repeats level L-1 cnt[L] times, strstr[L-1] bytes apart.
+//
+static void strd_copy(int8_t* dst, size_t* dststr,
+                      int8_t* src, size_t* srcstr,
+                      size_t* cnt, int level) {
+  size_t i;
+
+  if (level == 0) {
+    memmove(dst, src, cnt[0]);
+    return;
+  }
+
+  for (i = 0; i < cnt[level]; i++) {
+    strd_copy(dst + i * dststr[level-1], dststr,
+              src + i * srcstr[level-1], srcstr,
+              cnt, level - 1);
+  }
+}
+
+//
+// Convert count[0] and all of the strides from counts of elements to
+// counts of bytes, then copy.  Both ends are addressable from here, so
+// puts and gets are the same thing.
+//
+static void strd_transfer(void* dstaddr, void* dststrides,
+                          void* srcaddr, void* srcstrides, void* count,
+                          int32_t stridelevels, int32_t elemSize) {
+  int i;
+  const size_t strlvls = (size_t)stridelevels;
+
+  size_t dststr[strlvls];
+  size_t srcstr[strlvls];
+  size_t cnt[strlvls+1];
+
+  // Only count[0] and strides are measured in number of bytes.
+  cnt[0] = ((int32_t*)count)[0] * elemSize;
+  if (strlvls>0) {
+    srcstr[0] = ((int32_t*)srcstrides)[0] * elemSize;
+    dststr[0] = ((int32_t*)dststrides)[0] * elemSize;
+    for (i=1; i<strlvls; i++) {
+      srcstr[i] = ((int32_t*)srcstrides)[i] * elemSize;
+      dststr[i] = ((int32_t*)dststrides)[i] * elemSize;
+      cnt[i] = ((int32_t*)count)[i];
+    }
+    cnt[strlvls] = ((int32_t*)count)[strlvls];
+  }
+
+  strd_copy((int8_t*)dstaddr, dststr, (int8_t*)srcaddr, srcstr,
+            cnt, (int)strlvls);
+}
+
+void  chpl_comm_get_strd(void* dstaddr, void* dststrides, c_nodeid_t srcnode_id,
+                         void* srcaddr, void* srcstrides, void* count,
+                         int32_t stridelevels, int32_t elemSize, int32_t typeIndex,
+                         int ln, c_string fn) {
+  if (chpl_nodeID != srcnode_id) {
+    if (chpl_verbose_comm && !chpl_comm_no_debug_private)
+      printf("%d: %s:%d: remote get from %d\n", chpl_nodeID, fn, ln,
+             srcnode_id);
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      chpl_comm_diags_incr(get);
+    if (chpl_comm_profile && !chpl_comm_no_debug_private)
+      chpl_comm_profile_record(CHPL_COMM_PROFILE_GET_STRD, srcnode_id,
+                               chpl_comm_profile_strd_bytes(count, stridelevels,
+                                                            elemSize),
+                               ln, fn);
+  }
+  strd_transfer(dstaddr, dststrides, srcaddr, srcstrides, count,
+                stridelevels, elemSize);
+}
+
+void  chpl_comm_put_strd(void* dstaddr, void* dststrides, c_nodeid_t dstnode_id,
+                         void* srcaddr, void* srcstrides, void* count,
+                         int32_t stridelevels, int32_t elemSize, int32_t typeIndex,
+                         int ln, c_string fn) {
+  if (chpl_nodeID != dstnode_id) {
+    if (chpl_verbose_comm && !chpl_comm_no_debug_private)
+      printf("%d: %s:%d: remote put to %d\n", chpl_nodeID, fn, ln,
+             dstnode_id);
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      chpl_comm_diags_incr(put);
+    if (chpl_comm_profile && !chpl_comm_no_debug_private)
+      chpl_comm_profile_record(CHPL_COMM_PROFILE_PUT_STRD, dstnode_id,
+                               chpl_comm_profile_strd_bytes(count, stridelevels,
+                                                            elemSize),
+                               ln, fn);
+  }
+  strd_transfer(dstaddr, dststrides, srcaddr, srcstrides, count,
+                stridelevels, elemSize);
+}
+
+
+void  chpl_comm_fork(c_nodeid_t node, c_sublocid_t subloc,
+                     chpl_fn_int_t fid, void *arg, int32_t arg_size) {
+  char     infod[AM_MAX_MEDIUM];
+  fork_t*  info = (fork_t*) infod;
+  int      info_size;
+  done_t*  done;
+  void*    argCopy = NULL;
+  int      passArg = sizeof(fork_t) + arg_size <= AM_MAX_MEDIUM;
+
+  if (chpl_nodeID == node) {
+    chpl_ftable_call(fid, arg);
+  } else {
+    if (chpl_verbose_comm && !chpl_comm_no_debug_private)
+      printf("%d: remote task created on %d\n", chpl_nodeID, node);
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      chpl_comm_diags_incr(fork);
+    if (chpl_comm_profile && !chpl_comm_no_debug_private)
+      chpl_comm_profile_record(CHPL_COMM_PROFILE_FORK, node, arg_size, 0, NULL);
+
+    done = (done_t*) chpl_mem_alloc(sizeof(*done),
+                                    CHPL_RT_MD_COMM_FORK_DONE_FLAG, 0, 0);
+    INIT_DONE_OBJ(*done, 1);
+
+    info->caller = chpl_nodeID;
+    info->subloc = subloc;
+    info->ack = done;
+    info->serial_state = chpl_task_getSerial();
+    info->fid = fid;
+    info->arg_size = arg_size;
+
+    if (passArg) {
+      info_size = sizeof(fork_t) + arg_size;
+      if (arg_size)
+        chpl_memcpy(&(info->arg), arg, arg_size);
+      am_send(node, AM_FORK, info, info_size);
+    } else {
+      // The argument may be on our stack, which other locales can't
+      // see, so pass them a copy on our heap.
+      info_size = sizeof(fork_t) + sizeof(void*);
+      argCopy = chpl_mem_allocMany(1, arg_size,
+                                   CHPL_RT_MD_COMM_FORK_SEND_LARGE_ARG, 0, 0);
+      chpl_memcpy(argCopy, arg, arg_size);
+      chpl_memcpy(&(info->arg), &argCopy, sizeof(void*));
+      am_send(node, AM_FORK_LARGE, info, info_size);
+    }
+
+    WAIT_DONE_OBJ(*done);
+    chpl_mem_free(done, 0, 0);
+    if (argCopy != NULL)
+      chpl_mem_free(argCopy, 0, 0);
+  }
+}
+
+void  chpl_comm_fork_nb(c_nodeid_t node, c_sublocid_t subloc,
+                        chpl_fn_int_t fid, void *arg, int32_t arg_size) {
+  fork_t *info;
+  int     info_size;
+  int     passArg = (chpl_nodeID == node
+                     || sizeof(fork_t) + arg_size <= AM_MAX_MEDIUM);
+
+  void* argCopy = NULL;
+
+  if (passArg) {
+    info_size = sizeof(fork_t) + arg_size;
+  } else {
+    info_size = sizeof(fork_t) + sizeof(void*);
+  }
+  info = (fork_t*)chpl_mem_allocMany(info_size, sizeof(char), CHPL_RT_MD_COMM_FORK_SEND_NB_INFO, 0, 0);
+  info->caller = chpl_nodeID;
+  info->subloc = subloc;
+  info->ack = NULL;
+  info->serial_state = chpl_task_getSerial();
+  info->fid = fid;
+  info->arg_size = arg_size;
+  if (passArg) {
+    if (arg_size)
+      chpl_memcpy(&(info->arg), arg, arg_size);
+  } else {
+    // If the arg bundle is too large to fit in a message, copy the args
+    // to our heap and pass a pointer to them instead.  The target frees
+    // the copy once it has taken its own.
+    argCopy = chpl_mem_allocMany(1, arg_size,
+                                 CHPL_RT_MD_COMM_FORK_SEND_NB_LARGE_ARG, 0, 0);
+    chpl_memcpy(argCopy, arg, arg_size);
+    chpl_memcpy(&(info->arg), &argCopy, sizeof(void*));
+  }
+
+  if (chpl_nodeID == node) {
+    if (info->serial_state)
+      fork_nb_wrapper(info);
+    else
+      chpl_task_startMovedTask((chpl_fn_p)fork_nb_wrapper, (void*)info,
+                               subloc, chpl_nullTaskID,
+                               info->serial_state);
+  } else {
+    if (chpl_verbose_comm && !chpl_comm_no_debug_private)
+      printf("%d: remote non-blocking task created on %d\n", chpl_nodeID, node);
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      chpl_comm_diags_incr(fork_nb);
+    if (chpl_comm_profile && !chpl_comm_no_debug_private)
+      chpl_comm_profile_record(CHPL_COMM_PROFILE_FORK_NB, node,
+                               arg_size, 0, NULL);
+    am_send(node, passArg ? AM_FORK_NB : AM_FORK_NB_LARGE, info, info_size);
+    chpl_mem_free(info, 0, 0);
+  }
+}
+
+// Forks are already just queue operations here, so they aren't batched.
+void chpl_comm_fork_nb_batch_start(void) { }
+void chpl_comm_fork_nb_batch_finish(void) { }
+
+// should only be called for "small" functions
+void  chpl_comm_fork_fast(c_nodeid_t node, c_sublocid_t subloc,
+                          chpl_fn_int_t fid, void *arg, int32_t arg_size) {
+  char    infod[AM_MAX_MEDIUM];
+  fork_t* info;
+  int     info_size = sizeof(fork_t) + arg_size;
+  done_t* done;
+  int     passArg = info_size <= AM_MAX_MEDIUM;
+
+  if (chpl_nodeID == node) {
+    chpl_ftable_call(fid, arg);
+  } else {
+    if (passArg) {
+      if (chpl_verbose_comm && !chpl_comm_no_debug_private)
+        printf("%d: remote (no-fork) task created on %d\n",
+               chpl_nodeID, node);
+      if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+        chpl_comm_diags_incr(fork_fast);
+      if (chpl_comm_profile && !chpl_comm_no_debug_private)
+        chpl_comm_profile_record(CHPL_COMM_PROFILE_FORK_FAST, node,
+                                 arg_size, 0, NULL);
+
+      done = (done_t*) chpl_mem_alloc(sizeof(*done),
+                                      CHPL_RT_MD_COMM_FORK_DONE_FLAG, 0, 0);
+      INIT_DONE_OBJ(*done, 1);
+
+      info = (fork_t *) &infod;
+
+      info->caller = chpl_nodeID;
+      info->subloc = subloc;
+      info->ack = done;
+      info->serial_state = chpl_task_getSerial();
+      info->fid = fid;
+      info->arg_size = arg_size;
+
+      if (arg_size)
+        chpl_memcpy(&(info->arg), arg, arg_size);
+      am_send(node, AM_FORK_FAST, info, info_size);
+      // NOTE: We still have to wait for the handler to complete
+      WAIT_DONE_OBJ(*done);
+      chpl_mem_free(done, 0, 0);
+    } else {
+      // Call the normal chpl_comm_fork()
+      chpl_comm_fork(node, subloc, fid, arg, arg_size);
+    }
+  }
+}
+
+void chpl_comm_make_progress(void)
+{
+}
+
+
+void chpl_startVerboseComm() {
+  chpl_verbose_comm = 1;
+  chpl_comm_no_debug_private = 1;
+  chpl_comm_broadcast_private(0 /* &chpl_verbose_comm */, sizeof(int),
+                              -1 /*typeIndex: unused*/);
+  chpl_comm_no_debug_private = 0;
+}
+
+void chpl_stopVerboseComm() {
+  chpl_verbose_comm = 0;
+  chpl_comm_no_debug_private = 1;
+  chpl_comm_broadcast_private(0 /* &chpl_verbose_comm */, sizeof(int),
+                              -1 /*typeIndex: unused*/);
+  chpl_comm_no_debug_private = 0;
+}
+
+void chpl_startVerboseCommHere() {
+  chpl_verbose_comm = 1;
+}
+
+void chpl_stopVerboseCommHere() {
+  chpl_verbose_comm = 0;
+}
+
+void chpl_startCommDiagnostics() {
+  chpl_comm_diagnostics = 1;
+  chpl_comm_no_debug_private = 1;
+  chpl_comm_broadcast_private(1 /* &chpl_comm_diagnostics */, sizeof(int),
+                              -1 /*typeIndex: unused*/);
+  chpl_comm_no_debug_private = 0;
+}
+
+void chpl_stopCommDiagnostics() {
+  chpl_comm_diagnostics = 0;
+  chpl_comm_no_debug_private = 1;
+  chpl_comm_broadcast_private(1 /* &chpl_comm_diagnostics */, sizeof(int),
+                              -1 /*typeIndex: unused*/);
+  chpl_comm_no_debug_private = 0;
+}
+
+void chpl_startCommDiagnosticsHere() {
+  chpl_comm_diagnostics = 1;
+}
+
+void chpl_stopCommDiagnosticsHere() {
+  chpl_comm_diagnostics = 0;
+}
+
+void chpl_resetCommDiagnosticsHere() {
+  chpl_comm_diags_reset();
+}
+
+void chpl_getCommDiagnosticsHere(chpl_commDiagnostics *cd) {
+  chpl_comm_diags_copy(cd);
+}
+
+uint64_t chpl_numCommGets(void) {
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.get;
+}
+
+uint64_t chpl_numCommNBGets(void) {
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.get_nb;
+}
+
+uint64_t chpl_numCommTestNBGets(void) {
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.get_nb_test;
+}
+
+uint64_t chpl_numCommWaitNBGets(void) {
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.get_nb_wait;
+}
+
+uint64_t chpl_numCommPuts(void) {
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.put;
+}
+
+uint64_t chpl_numCommNBPuts(void) {
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.put_nb;
+}
+
+uint64_t chpl_numCommFastForks(void) {
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.fork_fast;
+}
+
+uint64_t chpl_numCommForks(void) {
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.fork;
+}
+
+uint64_t chpl_numCommNBForks(void) {
+  chpl_commDiagnostics cd;
+  chpl_comm_diags_copy(&cd);
+  return cd.fork_nb;
+}
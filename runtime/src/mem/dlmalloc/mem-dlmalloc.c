@@ -19,21 +19,287 @@
 
 #include "chplrt.h"
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 
+#include "chpl-bitops.h"
 #include "chpl-comm.h"
 #include "chpl-mem.h"
+#include "chpl-thread-local-storage.h"
 #include "chplmemtrack.h"
 #include "chpltypes.h"
 #include "error.h"
 #include "dlmalloc.h"
 
+// dlmalloc.h only defines this when the non-mspace interface is built.
+#ifndef M_MMAP_THRESHOLD
+#define M_MMAP_THRESHOLD (-3)
+#endif
+
+// Our dlmalloc.h predates these, but the dlmalloc.c we build has them.
+size_t mspace_usable_size(void* mem);
+size_t mspace_bulk_free(mspace msp, void* array[], size_t nelem);
+size_t mspace_set_footprint_limit(mspace msp, size_t bytes);
+
 mspace chpl_dlmalloc_heap;
 
 
+//
+// Thread caches
+//
+// Every allocation and free in the heap takes the heap's lock, so
+// tasks that allocate a lot of small things serialize on it.  To avoid
+// that, each thread keeps a cache of free small blocks, binned by size
+// class.  Small allocations are served from the calling thread's cache
+// without locking, and small frees go to the calling thread's cache,
+// whichever thread allocated the block.  A thread whose bin for some
+// class is empty takes half a bin's worth of blocks of that class from
+// the heap in a single locked call, and a thread whose bin is full
+// gives half of it back to the heap in a single locked call, so blocks
+// that are allocated by one thread and freed by another go back and
+// forth through the heap in batches.  The blocks in the caches are all
+// ordinary heap blocks, so we still never allocate outside the memory
+// the comm layer gave us.
+//
+// Size classes are multiples of 16 bytes up to 256 bytes, then four per
+// power of 2 up to TCACHE_MAX_SIZE.  A block's class on free is the
+// largest one its usable size can hold.
+//
+#define TCACHE_MAX_SIZE       32768
+#define TCACHE_NUM_CLASSES    44
+#define TCACHE_BIN_BYTES      (64 * 1024)    // the most a bin holds, ...
+#define TCACHE_BIN_MAX_BLOCKS 64             // ... and in any case this many
+
+typedef struct {
+  void*        head;          // free blocks, linked through their 1st word
+  int          count;
+} tcache_bin_t;
+
+typedef struct {
+  tcache_bin_t bins[TCACHE_NUM_CLASSES];
+} tcache_t;
+
+static chpl_bool tcache_enabled = false;
+static size_t    tcache_class_size[TCACHE_NUM_CLASSES];
+static int       tcache_bin_limit[TCACHE_NUM_CLASSES];
+
+// We get at this thread's cache through __thread where we can, but we
+// also need a pthread key, with a destructor, to flush the cache when
+// the thread exits.
+CHPL_TLS_DECL(tcache_t*, tcache);
+static pthread_key_t tcache_exit_key;
+
+
+//
+// The smallest size class that holds n bytes (0 < n <= TCACHE_MAX_SIZE).
+//
+static ___always_inline
+int tcache_class_of(size_t n) {
+  int    lg;
+  size_t step;
+
+  if (n <= 256)
+    return (n <= 16) ? 0 : (int) ((n + 15) >> 4) - 1;
+
+  lg = 63 - (int) chpl_bitops_clz_64((unsigned long long) (n - 1));
+  step = (size_t) 1 << (lg - 2);
+  return 16 + 4 * (lg - 8) + (int) ((n - 1 - ((size_t) 1 << lg)) / step);
+}
+
+
+//
+// The largest size class a block with u usable bytes can serve, or -1
+// if it is too big to tie up in a cache.  The heap's blocks have a few
+// bytes more than we ask for, so the largest class has to allow that.
+//
+static ___always_inline
+int tcache_class_of_usable(size_t u) {
+  if (u >= TCACHE_MAX_SIZE)
+    return (u < TCACHE_MAX_SIZE + 16) ? TCACHE_NUM_CLASSES - 1 : -1;
+  return tcache_class_of(u + 1) - 1;
+}
+
+
+static void tcache_flush_bin(tcache_bin_t* bin, int n) {
+  void* blocks[TCACHE_BIN_MAX_BLOCKS];
+  int   i;
+
+  for (i = 0; i < n; i++) {
+    blocks[i] = bin->head;
+    bin->head = *(void**) bin->head;
+  }
+  bin->count -= n;
+  (void) mspace_bulk_free(chpl_dlmalloc_heap, blocks, n);
+}
+
+
+static void tcache_destroy(void* arg) {
+  tcache_t* tc = (tcache_t*) arg;
+  int       c;
+
+  //
+  // Other thread exit destructors may free memory after this one runs.
+  // Forget the cache first, so that if they do they'll make a new one
+  // (and pthreads will call us again to get rid of that).
+  //
+  CHPL_TLS_SET(tcache, NULL);
+
+  for (c = 0; c < TCACHE_NUM_CLASSES; c++)
+    if (tc->bins[c].count > 0)
+      tcache_flush_bin(&tc->bins[c], tc->bins[c].count);
+  mspace_free(chpl_dlmalloc_heap, tc);
+}
+
+
+static tcache_t* tcache_create(void) {
+  tcache_t* tc;
+
+  //
+  // This is our own bookkeeping, like the heap's, so it comes straight
+  // from the heap rather than through the tracked interface.
+  //
+  if ((tc = (tcache_t*) mspace_calloc(chpl_dlmalloc_heap, 1, sizeof(*tc)))
+      == NULL)
+    return NULL;
+  CHPL_TLS_SET(tcache, tc);
+  (void) pthread_setspecific(tcache_exit_key, tc);
+  return tc;
+}
+
+
+static void* tcache_refill_and_alloc(tcache_bin_t* bin, int c) {
+  size_t sizes[TCACHE_BIN_MAX_BLOCKS];
+  void*  blocks[TCACHE_BIN_MAX_BLOCKS];
+  int    n = (tcache_bin_limit[c] + 1) / 2;
+  int    i;
+
+  for (i = 0; i < n; i++)
+    sizes[i] = tcache_class_size[c];
+  if (mspace_independent_comalloc(chpl_dlmalloc_heap, n, sizes, blocks)
+      == NULL)
+    return mspace_malloc(chpl_dlmalloc_heap, tcache_class_size[c]);
+
+  for (i = 1; i < n; i++) {
+    *(void**) blocks[i] = bin->head;
+    bin->head = blocks[i];
+  }
+  bin->count += n - 1;
+  return blocks[0];
+}
+
+
+static ___always_inline
+void* tcache_alloc(size_t size) {
+  tcache_t*     tc;
+  tcache_bin_t* bin;
+  void*         p;
+  int           c;
+
+  if ((tc = CHPL_TLS_GET(tcache)) == NULL
+      && (tc = tcache_create()) == NULL)
+    return mspace_malloc(chpl_dlmalloc_heap, size);
+
+  c = tcache_class_of(size);
+  bin = &tc->bins[c];
+  if ((p = bin->head) == NULL)
+    return tcache_refill_and_alloc(bin, c);
+  bin->head = *(void**) p;
+  bin->count--;
+  return p;
+}
+
+
+void* chpl_dlmalloc_malloc(size_t size) {
+  if (!tcache_enabled || size > TCACHE_MAX_SIZE)
+    return mspace_malloc(chpl_dlmalloc_heap, size);
+  return tcache_alloc(size);
+}
+
+
+void* chpl_dlmalloc_calloc(size_t n, size_t size) {
+  size_t total = n * size;
+  void*  p;
+
+  if (!tcache_enabled || total > TCACHE_MAX_SIZE
+      || (size != 0 && total / size != n))
+    return mspace_calloc(chpl_dlmalloc_heap, n, size);
+  if ((p = tcache_alloc(total)) != NULL)
+    memset(p, 0, total);
+  return p;
+}
+
+
+void* chpl_dlmalloc_realloc(void* ptr, size_t size) {
+  if (ptr == NULL)
+    return chpl_dlmalloc_malloc(size);
+  return mspace_realloc(chpl_dlmalloc_heap, ptr, size);
+}
+
+
+void chpl_dlmalloc_free(void* ptr) {
+  tcache_t*     tc;
+  tcache_bin_t* bin;
+  int           c;
+
+  if (ptr == NULL)
+    return;
+
+  if (!tcache_enabled
+      || (c = tcache_class_of_usable(mspace_usable_size(ptr))) < 0
+      || ((tc = CHPL_TLS_GET(tcache)) == NULL
+          && (tc = tcache_create()) == NULL)) {
+    mspace_free(chpl_dlmalloc_heap, ptr);
+    return;
+  }
+
+  bin = &tc->bins[c];
+  *(void**) ptr = bin->head;
+  bin->head = ptr;
+  if (++bin->count >= tcache_bin_limit[c])
+    tcache_flush_bin(bin, bin->count / 2);
+}
+
+
+static void tcache_init(void) {
+  char* p;
+  int   c;
+
+  if ((p = getenv("CHPL_RT_MEM_THREAD_CACHE")) != NULL
+      && (strcmp(p, "0") == 0
+          || strcmp(p, "no") == 0
+          || strcmp(p, "false") == 0))
+    return;
+
+  for (c = 0; c < TCACHE_NUM_CLASSES; c++) {
+    size_t sz;
+    int    lim;
+
+    if (c < 16)
+      sz = 16 * (c + 1);
+    else {
+      int lg = 8 + (c - 16) / 4;
+      sz = ((size_t) 1 << lg) + ((c - 16) % 4 + 1) * ((size_t) 1 << (lg - 2));
+    }
+    tcache_class_size[c] = sz;
+
+    lim = TCACHE_BIN_BYTES / (int) sz;
+    if (lim > TCACHE_BIN_MAX_BLOCKS)
+      lim = TCACHE_BIN_MAX_BLOCKS;
+    else if (lim < 2)
+      lim = 2;
+    tcache_bin_limit[c] = lim;
+  }
+
+  CHPL_TLS_INIT(tcache);
+  if (pthread_key_create(&tcache_exit_key, tcache_destroy) != 0)
+    return;
+  tcache_enabled = true;
+}
+
+
 void chpl_mem_layerInit(void) {
   void*  heap_base;
   size_t heap_size;
@@ -41,11 +307,24 @@ void chpl_mem_layerInit(void) {
   chpl_comm_desired_shared_heap(&heap_base, &heap_size);
   if (heap_base == NULL || heap_size == 0)
     chpl_dlmalloc_heap = create_mspace(0, 1);
-  else
+  else {
     chpl_dlmalloc_heap = create_mspace_with_base(heap_base, heap_size, 1);
-}
 
+    //
+    // Other locales may need to reach anything we allocate, so keep
+    // everything in the heap the comm layer gave us.  Turning off the
+    // mmap threshold keeps large allocations in it, and capping the
+    // footprint at its size keeps dlmalloc from mapping more memory
+    // when it fills up, so that running out is reported as an
+    // out-of-memory error instead.
+    //
+    (void) mspace_mallopt(M_MMAP_THRESHOLD, -1);
+    (void) mspace_set_footprint_limit(chpl_dlmalloc_heap,
+                                      mspace_footprint(chpl_dlmalloc_heap));
+  }
 
-void chpl_mem_layerExit(void) { }
+  tcache_init();
+}
 
 
+void chpl_mem_layerExit(void) { }
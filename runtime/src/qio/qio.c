@@ -561,6 +561,11 @@ qio_hint_t choose_io_method(qio_file_t* file, qio_hint_t hints, qio_hint_t defau
     } else {
       // method already chosen in hints.
     }
+
+    // Like pread/pwrite, asynchronous I/O needs to be able to seek.
+    if( method == QIO_METHOD_ASYNC && !(fdflags & QIO_FDFLAG_SEEKABLE) ) {
+      method = QIO_METHOD_READWRITE;
+    }
   }
 
   // Always use fread/fwrite with FILE*
@@ -1830,6 +1835,9 @@ void _qio_channel_destroy(qio_channel_t* ch)
 
   qio_lock_destroy(&ch->lock);
 
+  qbytes_release(ch->view_bytes); // Does nothing if null.
+  ch->view_bytes = NULL;
+
   qio_file_release(ch->file);
   ch->file = NULL;
 
@@ -2240,6 +2248,9 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
       case QIO_METHOD_PREADPWRITE:
         err = qio_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
         break;
+      case QIO_METHOD_ASYNC:
+        err = qio_async_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
+        break;
       case QIO_METHOD_FREADFWRITE:
         err = qio_freadv(ch->file->fp, &ch->buf, read_start, read_end, &num_read);
         break;
@@ -2466,6 +2477,9 @@ qioerr _qio_buffered_behind(qio_channel_t* ch, int flushall)
         case QIO_METHOD_PREADPWRITE:
           err = qio_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
           break;
+        case QIO_METHOD_ASYNC:
+          err = qio_async_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
+          break;
         case QIO_METHOD_FREADFWRITE:
           err = qio_fwritev(ch->file->fp, &ch->buf, write_start, write_end, &num_written);
           break;
@@ -2654,6 +2668,7 @@ qioerr _qio_unbuffered_write(qio_channel_t* ch, const void* ptr, ssize_t len_in,
 {
   ssize_t num_written;
   size_t num_written_u;
+  struct iovec iov;
   ssize_t len;
   qioerr err;
   qio_method_t method = (qio_method_t) (ch->hints & QIO_METHODMASK);
@@ -2689,6 +2704,11 @@ qioerr _qio_unbuffered_write(qio_channel_t* ch, const void* ptr, ssize_t len_in,
         case QIO_METHOD_PREADPWRITE:
           err = qio_int_to_err(sys_pwrite(ch->file->fd, ptr, len, _right_mark_start(ch), &num_written));
           break;
+        case QIO_METHOD_ASYNC:
+          iov.iov_base = (void*) ptr;
+          iov.iov_len = len;
+          err = qio_int_to_err(qio_async_iov(ch->file->fd, 1, &iov, 1, _right_mark_start(ch), &num_written));
+          break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
             num_written_u = fwrite(ptr, 1, len, ch->file->fp);
@@ -2743,6 +2763,7 @@ qioerr _qio_unbuffered_read(qio_channel_t* ch, void* ptr, ssize_t len_in, ssize_
 {
   ssize_t num_read;
   size_t num_read_u;
+  struct iovec iov;
   ssize_t len;
   qioerr err;
   qio_method_t method = (qio_method_t) (ch->hints & QIO_METHODMASK);
@@ -2779,6 +2800,11 @@ qioerr _qio_unbuffered_read(qio_channel_t* ch, void* ptr, ssize_t len_in, ssize_
         case QIO_METHOD_PREADPWRITE:
           err = qio_int_to_err(sys_pread(ch->file->fd, ptr, len, _right_mark_start(ch), &num_read));
           break;
+        case QIO_METHOD_ASYNC:
+          iov.iov_base = ptr;
+          iov.iov_len = len;
+          err = qio_int_to_err(qio_async_iov(ch->file->fd, 0, &iov, 1, _right_mark_start(ch), &num_read));
+          break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
             num_read_u = fread(ptr, 1, len, ch->file->fp);
@@ -3340,6 +3366,86 @@ error:
   return err;
 }
 
+qioerr qio_channel_read_view(const int threadsafe, qio_channel_t* ch, int64_t maxlen, qbytes_t** bytes_out /* can be NULL */, void** ptr_out, int64_t* len_out)
+{
+  qioerr err;
+  qbuffer_iter_t start;
+  qbuffer_iter_t end;
+  qbytes_t* bytes = NULL;
+  int64_t skip = 0;
+  int64_t len = 0;
+
+  if( bytes_out ) *bytes_out = NULL;
+  *ptr_out = NULL;
+  *len_out = 0;
+
+  if( ! (ch->flags & QIO_FDFLAG_READABLE) )
+    QIO_RETURN_CONSTANT_ERROR(EBADF, "not readable");
+
+  if( maxlen <= 0 )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "view length must be positive");
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  // The caller is done with the previous view the channel kept alive.
+  qbytes_release(ch->view_bytes); // Does nothing if null.
+  ch->view_bytes = NULL;
+
+  // require calls needbuffer_unlocked and advance_cached.
+  // For mmap channels this puts the mapping itself in ch->buf;
+  // otherwise it reads at least one byte into an iobuf.
+  err = _qio_channel_require_unlocked(ch, 1, false);
+  if( qio_err_to_int(err) == EEOF ) {
+    // The read stopped at the channel's end, but it might
+    // have gotten some data first.
+    if( ch->av_end > _right_mark_start(ch) ) err = 0;
+  }
+  if( err ) goto error;
+
+  start = _right_mark_start_iter(ch);
+  end = _av_end_iter(ch);
+  qbuffer_iter_get(start, end, &bytes, &skip, &len);
+
+  if( len <= 0 ) {
+    err = QIO_EEOF;
+    goto error;
+  }
+  if( len > maxlen ) len = maxlen;
+
+  // The channel drops its reference to this part once we move past it,
+  // but the caller's reference keeps the data (or the mapping) alive.
+  // Buffer parts are never refilled in place, so the view can't change.
+  qbytes_retain(bytes);
+
+  if( bytes_out ) *bytes_out = bytes;
+  else ch->view_bytes = bytes;
+  *ptr_out = VOID_PTR_ADD(bytes->data, skip);
+  *len_out = len;
+
+  _add_right_mark_start(ch, len);
+
+  // Release the parts we've moved past. The view has already been
+  // handed out, so a write-behind error (only possible for a channel
+  // that is also writeable) is left in ch->error for flush or close.
+  _qio_channel_set_error_unlocked(ch, _qio_buffered_behind(ch, false));
+  err = 0;
+
+error:
+  if( qio_err_to_int(err) == EEOF ) {
+    // Make EOF sticky, as _qio_slow_read does.
+    ch->end_pos = ch->av_end;
+  }
+  _qio_channel_set_error_unlocked(ch, err);
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  return err;
+}
+
 qioerr qio_channel_mark_maybe_flush_bits(const int threadsafe, qio_channel_t* ch, int flushbits)
 {
   qioerr err;
@@ -0,0 +1,683 @@
+/*
+ * Copyright 2004-2014 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Asynchronous I/O for QIO_METHOD_ASYNC.
+ *
+ * A preadv or pwritev is split into requests of at most
+ * qio_async_request_size bytes, all of which are submitted before any of
+ * them is waited for, so a locale can keep many requests in flight. The
+ * task that issued them looks for their completion a few times, yielding
+ * in between, and then waits for each one as it would for a sync
+ * variable to become full. With CHPL_RT_LIGHTWEIGHT_TASKS that switches
+ * the task out and leaves its thread free for other tasks; otherwise it
+ * blocks the thread. (The standalone SIMPLE_TEST build has no tasks, and
+ * blocks the thread on a condition variable instead.)
+ *
+ * Requests go to one of two engines, chosen when the first request is made:
+ *
+ *   - io_uring (Linux 5.1 or later). One submission/completion ring pair is
+ *     shared by all of the threads. A reaper pthread waits in the kernel
+ *     for completions, and waiting tasks also reap whatever completions
+ *     are there while they are yielding. (In the SIMPLE_TEST build there
+ *     is no reaper; whichever waiter gets to the completion ring first
+ *     waits in the kernel, and the others wait for it to finish.)
+ *
+ *   - a pool of qio_async_threads pthreads that do the preadv/pwritev
+ *     calls. This is used if io_uring is not available when the runtime
+ *     is built or run, or if CHPL_RT_QIO_ASYNC_ENGINE=threads.
+ *
+ * CHPL_RT_QIO_ASYNC_THREADS sets the number of pool threads.
+ */
+
+#ifndef _GNU_SOURCE
+// get preadv, pwritev
+#define _GNU_SOURCE
+#endif
+
+#include "sys_basic.h"
+
+#ifndef SIMPLE_TEST
+#include "chplrt.h"
+#include "chpl-tasks.h"
+#endif
+
+#include "qio.h"
+#include "qbuffer.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/uio.h>
+
+// Use io_uring if the kernel headers and the C library know about it.
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define QIO_ASYNC_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#ifndef IORING_FEAT_SINGLE_MMAP
+// older headers; such kernels just won't report it.
+#define IORING_FEAT_SINGLE_MMAP (1U << 0)
+#endif
+#endif
+#endif
+#endif
+
+// In the runtime, tasks wait for requests the way they wait for sync
+// variables.
+#ifdef _chplrt_H_
+#define QIO_ASYNC_TASK_WAIT
+#endif
+
+// Requests are at most this many bytes (but always at least one iovec).
+ssize_t qio_async_request_size = 1024*1024;
+// How many pthreads does the fallback engine use?
+int qio_async_threads = 4;
+
+typedef struct qio_async_req_s {
+  struct qio_async_req_s* next; // for the thread pool queue
+  fd_t fd;
+  int writing;
+  const struct iovec* iov;
+  int iovcnt;
+  int64_t offset;
+  int64_t len;
+  // set when done is
+  ssize_t nbytes;
+  err_t err;
+  atomic_int_least64_t done;
+#ifdef QIO_ASYNC_TASK_WAIT
+  chpl_sync_aux_t done_sync; // filled just before done is set
+#endif
+} qio_async_req_t;
+
+static void qio_async_yield(void)
+{
+#ifdef _chplrt_H_
+  chpl_task_yield();
+#else
+  sched_yield();
+#endif
+}
+
+// How many times does a waiting task look for its request to be done,
+// yielding in between, before it blocks?
+#define QIO_ASYNC_WAIT_SPINS 16
+
+#ifdef QIO_ASYNC_TASK_WAIT
+// Waiters wait on their own requests' done_sync.
+static void qio_async_notify(void) { }
+#else
+// Blocked waiters sleep on done_cond. done_gen changes, with a broadcast,
+// whenever requests may have finished: after a pool thread finishes one,
+// and after each pass over the io_uring completion ring.
+static pthread_mutex_t done_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+static uint64_t done_gen = 0;
+
+static void qio_async_notify(void)
+{
+  pthread_mutex_lock(&done_lock);
+  done_gen++;
+  pthread_cond_broadcast(&done_cond);
+  pthread_mutex_unlock(&done_lock);
+}
+#endif
+
+// Setting done must be the last thing done with req, since its waiter
+// may return (and req may go away) as soon as it sees it.
+static void qio_async_finish(qio_async_req_t* req, ssize_t nbytes, err_t err)
+{
+  if( err == 0 && nbytes == 0 && req->len > 0 && ! req->writing ) err = EEOF;
+  req->nbytes = nbytes;
+  req->err = err;
+#ifdef QIO_ASYNC_TASK_WAIT
+  chpl_sync_lock(&req->done_sync);
+  chpl_sync_markAndSignalFull(&req->done_sync);
+#endif
+  atomic_store_int_least64_t(&req->done, 1);
+}
+
+static void qio_async_run(qio_async_req_t* req)
+{
+  ssize_t nbytes = 0;
+  err_t err;
+
+  if( req->writing ) {
+    err = sys_pwritev(req->fd, req->iov, req->iovcnt, req->offset, &nbytes);
+  } else {
+    err = sys_preadv(req->fd, req->iov, req->iovcnt, req->offset, &nbytes);
+    if( err == EEOF ) err = 0; // qio_async_finish will decide.
+  }
+  qio_async_finish(req, nbytes, err);
+}
+
+
+// ---- thread pool engine ----
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_cond = PTHREAD_COND_INITIALIZER;
+static qio_async_req_t* pool_head = NULL;
+static qio_async_req_t* pool_tail = NULL;
+
+static void* pool_worker(void* arg)
+{
+  qio_async_req_t* req;
+
+  while( 1 ) {
+    pthread_mutex_lock(&pool_lock);
+    while( ! pool_head ) pthread_cond_wait(&pool_cond, &pool_lock);
+    req = pool_head;
+    pool_head = req->next;
+    if( ! pool_head ) pool_tail = NULL;
+    pthread_mutex_unlock(&pool_lock);
+
+    qio_async_run(req);
+    qio_async_notify();
+  }
+
+  return NULL;
+}
+
+static int pool_start(void)
+{
+  pthread_attr_t attr;
+  pthread_t thread;
+  int started = 0;
+  int i;
+
+  if( pthread_attr_init(&attr) ) return 0;
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  for( i = 0; i < qio_async_threads; i++ ) {
+    if( pthread_create(&thread, &attr, pool_worker, NULL) == 0 ) started++;
+  }
+  pthread_attr_destroy(&attr);
+
+  return started;
+}
+
+static void pool_submit(qio_async_req_t* req)
+{
+  req->next = NULL;
+  pthread_mutex_lock(&pool_lock);
+  if( pool_tail ) pool_tail->next = req;
+  else pool_head = req;
+  pool_tail = req;
+  pthread_cond_signal(&pool_cond);
+  pthread_mutex_unlock(&pool_lock);
+}
+
+
+// ---- io_uring engine ----
+
+#ifdef QIO_ASYNC_HAS_IO_URING
+
+#define URING_ENTRIES 256
+
+static int uring_fd = -1;
+static unsigned uring_sq_entries;
+static unsigned* uring_sq_tail;
+static unsigned* uring_sq_mask;
+static unsigned* uring_sq_array;
+static struct io_uring_sqe* uring_sqes;
+static unsigned* uring_cq_head;
+static unsigned* uring_cq_tail;
+static unsigned* uring_cq_mask;
+static struct io_uring_cqe* uring_cqes;
+
+// Submissions are serialized by uring_sq_lock; completions are reaped by
+// whoever holds uring_cq_lock.
+static pthread_mutex_t uring_sq_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t uring_cq_lock = PTHREAD_MUTEX_INITIALIZER;
+// Requests submitted and not yet reaped. Kept at or below uring_sq_entries
+// so that the completion ring (which is twice as large) never overflows.
+static atomic_int_least64_t uring_inflight;
+
+#ifdef QIO_ASYNC_TASK_WAIT
+static void* uring_reaper(void* arg);
+#endif
+
+static int uring_start(void)
+{
+  struct io_uring_params p;
+  size_t sq_size, cq_size;
+  unsigned char* sq_ptr;
+  unsigned char* cq_ptr;
+  void* sqes;
+  int fd;
+
+  memset(&p, 0, sizeof(p));
+  fd = (int) syscall(__NR_io_uring_setup, URING_ENTRIES, &p);
+  if( fd < 0 ) return 0;
+
+  sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if( p.features & IORING_FEAT_SINGLE_MMAP ) {
+    if( cq_size > sq_size ) sq_size = cq_size;
+  }
+
+  sq_ptr = mmap(NULL, sq_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                fd, IORING_OFF_SQ_RING);
+  if( sq_ptr == MAP_FAILED ) goto error;
+
+  if( p.features & IORING_FEAT_SINGLE_MMAP ) {
+    cq_ptr = sq_ptr;
+  } else {
+    cq_ptr = mmap(NULL, cq_size, PROT_READ|PROT_WRITE,
+                  MAP_SHARED|MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if( cq_ptr == MAP_FAILED ) goto error;
+  }
+
+  sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+              PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+              fd, IORING_OFF_SQES);
+  if( sqes == MAP_FAILED ) goto error;
+
+  uring_sq_entries = p.sq_entries;
+  uring_sq_tail = (unsigned*) (sq_ptr + p.sq_off.tail);
+  uring_sq_mask = (unsigned*) (sq_ptr + p.sq_off.ring_mask);
+  uring_sq_array = (unsigned*) (sq_ptr + p.sq_off.array);
+  uring_sqes = (struct io_uring_sqe*) sqes;
+  uring_cq_head = (unsigned*) (cq_ptr + p.cq_off.head);
+  uring_cq_tail = (unsigned*) (cq_ptr + p.cq_off.tail);
+  uring_cq_mask = (unsigned*) (cq_ptr + p.cq_off.ring_mask);
+  uring_cqes = (struct io_uring_cqe*) (cq_ptr + p.cq_off.cqes);
+  atomic_init_int_least64_t(&uring_inflight, 0);
+  uring_fd = fd;
+
+#ifdef QIO_ASYNC_TASK_WAIT
+  {
+    pthread_attr_t attr;
+    pthread_t thread;
+    int rc;
+
+    if( pthread_attr_init(&attr) ) rc = -1;
+    else {
+      pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+      rc = pthread_create(&thread, &attr, uring_reaper, NULL);
+      pthread_attr_destroy(&attr);
+    }
+    if( rc ) {
+      uring_fd = -1;
+      goto error;
+    }
+  }
+#endif
+
+  return 1;
+
+error:
+  // The mappings go away with the process; we just won't use them.
+  close(fd);
+  return 0;
+}
+
+// Reap the completions that are there. The caller holds uring_cq_lock.
+static void uring_drain(void)
+{
+  unsigned head, tail;
+  struct io_uring_cqe* cqe;
+  qio_async_req_t* req;
+
+  head = *uring_cq_head;
+  tail = __atomic_load_n(uring_cq_tail, __ATOMIC_ACQUIRE);
+  while( head != tail ) {
+    cqe = &uring_cqes[head & *uring_cq_mask];
+    req = (qio_async_req_t*) (uintptr_t) cqe->user_data;
+    if( cqe->res < 0 ) qio_async_finish(req, 0, -cqe->res);
+    else qio_async_finish(req, cqe->res, 0);
+    head++;
+    atomic_fetch_sub_int_least64_t(&uring_inflight, 1);
+  }
+  __atomic_store_n(uring_cq_head, head, __ATOMIC_RELEASE);
+}
+
+// Reap whatever completions are available. If wait_req is not NULL and
+// is not done yet, first wait in the kernel for a completion if there are
+// none. Returns immediately if another thread is already reaping.
+static void uring_reap(qio_async_req_t* wait_req)
+{
+  if( pthread_mutex_trylock(&uring_cq_lock) ) return;
+
+  // No one else can reap wait_req while we hold uring_cq_lock, so if it
+  // isn't done its completion is still to come.
+  if( wait_req && ! atomic_load_int_least64_t(&wait_req->done) &&
+      *uring_cq_head == __atomic_load_n(uring_cq_tail, __ATOMIC_ACQUIRE) ) {
+    (void) syscall(__NR_io_uring_enter, uring_fd, 0, 1,
+                   IORING_ENTER_GETEVENTS, NULL, 0);
+  }
+
+  uring_drain();
+
+  pthread_mutex_unlock(&uring_cq_lock);
+  qio_async_notify();
+}
+
+#ifdef QIO_ASYNC_TASK_WAIT
+// Waiting tasks don't wait in the kernel, so this pthread does.
+static void* uring_reaper(void* arg)
+{
+  while( 1 ) {
+    pthread_mutex_lock(&uring_cq_lock);
+    if( *uring_cq_head == __atomic_load_n(uring_cq_tail, __ATOMIC_ACQUIRE) ) {
+      (void) syscall(__NR_io_uring_enter, uring_fd, 0, 1,
+                     IORING_ENTER_GETEVENTS, NULL, 0);
+    }
+    uring_drain();
+    pthread_mutex_unlock(&uring_cq_lock);
+  }
+
+  return NULL;
+}
+#endif
+
+static void uring_submit(qio_async_req_t* req)
+{
+  struct io_uring_sqe* sqe;
+  unsigned tail, index;
+  int rc;
+
+  // Wait for room in the rings.
+  while( 1 ) {
+    int_least64_t n = atomic_load_int_least64_t(&uring_inflight);
+    if( n < (int_least64_t) uring_sq_entries &&
+        atomic_compare_exchange_strong_int_least64_t(&uring_inflight, n, n+1) )
+      break;
+    uring_reap(NULL);
+    qio_async_yield();
+  }
+
+  pthread_mutex_lock(&uring_sq_lock);
+
+  tail = *uring_sq_tail;
+  index = tail & *uring_sq_mask;
+  sqe = &uring_sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = req->writing ? IORING_OP_WRITEV : IORING_OP_READV;
+  sqe->fd = req->fd;
+  sqe->addr = (uintptr_t) req->iov;
+  sqe->len = req->iovcnt;
+  sqe->off = req->offset;
+  sqe->user_data = (uintptr_t) req;
+  uring_sq_array[index] = index;
+  __atomic_store_n(uring_sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+  do {
+    rc = (int) syscall(__NR_io_uring_enter, uring_fd, 1, 0, 0, NULL, 0);
+  } while( rc < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY) );
+
+  if( rc < 1 ) {
+    // The kernel did not take the entry, so take it back and do the
+    // request here instead.
+    __atomic_store_n(uring_sq_tail, tail, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&uring_sq_lock);
+    atomic_fetch_sub_int_least64_t(&uring_inflight, 1);
+    qio_async_run(req);
+    return;
+  }
+
+  pthread_mutex_unlock(&uring_sq_lock);
+}
+
+#endif
+
+
+// ---- engine selection ----
+
+#define ENGINE_THREADS 1
+#define ENGINE_URING 2
+#define ENGINE_SYNC 3
+
+static int engine = 0;
+static pthread_once_t engine_once = PTHREAD_ONCE_INIT;
+
+static void engine_init(void)
+{
+  const char* p;
+  int want_uring = 1;
+
+  if( (p = getenv("CHPL_RT_QIO_ASYNC_THREADS")) != NULL ) {
+    int n = atoi(p);
+    if( n > 0 ) qio_async_threads = n;
+  }
+  if( (p = getenv("CHPL_RT_QIO_ASYNC_ENGINE")) != NULL ) {
+    if( 0 == strcmp(p, "threads") ) want_uring = 0;
+  }
+
+#ifdef QIO_ASYNC_HAS_IO_URING
+  if( want_uring && uring_start() ) {
+    engine = ENGINE_URING;
+    return;
+  }
+#else
+  (void) want_uring;
+#endif
+
+  if( pool_start() > 0 ) engine = ENGINE_THREADS;
+  else engine = ENGINE_SYNC; // no threads; just do the I/O in the caller.
+}
+
+static void qio_async_submit(qio_async_req_t* req)
+{
+  atomic_init_int_least64_t(&req->done, 0);
+#ifdef QIO_ASYNC_TASK_WAIT
+  chpl_sync_initAux(&req->done_sync);
+#endif
+
+  switch( engine ) {
+#ifdef QIO_ASYNC_HAS_IO_URING
+    case ENGINE_URING:
+      uring_submit(req);
+      break;
+#endif
+    case ENGINE_THREADS:
+      pool_submit(req);
+      break;
+    default:
+      qio_async_run(req);
+      break;
+  }
+}
+
+static void qio_async_wait(qio_async_req_t* req)
+{
+#ifndef QIO_ASYNC_TASK_WAIT
+  uint64_t gen;
+#endif
+  int i;
+
+  for( i = 0; i < QIO_ASYNC_WAIT_SPINS; i++ ) {
+    if( atomic_load_int_least64_t(&req->done) ) goto done;
+#ifdef QIO_ASYNC_HAS_IO_URING
+    if( engine == ENGINE_URING ) {
+      uring_reap(NULL);
+      if( atomic_load_int_least64_t(&req->done) ) goto done;
+    }
+#endif
+    qio_async_yield();
+  }
+
+#ifdef QIO_ASYNC_TASK_WAIT
+  // A lightweight task switches out here rather than blocking its thread.
+  chpl_sync_waitFullAndLock(&req->done_sync, __LINE__, __FILE__);
+  chpl_sync_unlock(&req->done_sync);
+  // done is set just after done_sync is filled.
+  while( ! atomic_load_int_least64_t(&req->done) ) sched_yield();
+#else
+  pthread_mutex_lock(&done_lock);
+  while( ! atomic_load_int_least64_t(&req->done) ) {
+    gen = done_gen;
+#ifdef QIO_ASYNC_HAS_IO_URING
+    if( engine == ENGINE_URING ) {
+      // Reap, waiting for a completion, unless someone else is reaping,
+      // in which case wait for them to finish.
+      pthread_mutex_unlock(&done_lock);
+      uring_reap(req);
+      pthread_mutex_lock(&done_lock);
+    }
+#endif
+    while( ! atomic_load_int_least64_t(&req->done) && gen == done_gen )
+      pthread_cond_wait(&done_cond, &done_lock);
+  }
+  pthread_mutex_unlock(&done_lock);
+#endif
+
+done:
+#ifdef QIO_ASYNC_TASK_WAIT
+  chpl_sync_destroyAux(&req->done_sync);
+#endif
+  return;
+}
+
+// Reads or writes iov at offset in fd, in requests that are all in flight
+// at once. Like sys_preadv/sys_pwritev, this returns the number of bytes
+// transferred before the first short or failed request, and EEOF if
+// a read got nothing at all.
+err_t qio_async_iov(fd_t fd, int writing, const struct iovec* iov, int iovcnt,
+                    int64_t offset, ssize_t* num_out)
+{
+  qio_async_req_t* reqs = NULL;
+  MAYBE_STACK_SPACE(qio_async_req_t, reqs_onstack);
+  int nreqs;
+  int i, j;
+  int64_t len;
+  ssize_t total;
+  err_t err;
+
+  pthread_once(&engine_once, engine_init);
+
+  // Count the requests.
+  nreqs = 0;
+  for( i = 0; i < iovcnt; i = j ) {
+    len = 0;
+    for( j = i; j < iovcnt && j - i < IOV_MAX &&
+                ( j == i || len + (int64_t) iov[j].iov_len <= qio_async_request_size );
+         j++ ) {
+      len += iov[j].iov_len;
+    }
+    nreqs++;
+  }
+
+  if( nreqs == 0 ) {
+    *num_out = 0;
+    return 0;
+  }
+
+  MAYBE_STACK_ALLOC(qio_async_req_t, nreqs, reqs, reqs_onstack);
+  if( ! reqs ) {
+    *num_out = 0;
+    return ENOMEM;
+  }
+
+  // Submit them all.
+  nreqs = 0;
+  for( i = 0; i < iovcnt; i = j ) {
+    len = 0;
+    for( j = i; j < iovcnt && j - i < IOV_MAX &&
+                ( j == i || len + (int64_t) iov[j].iov_len <= qio_async_request_size );
+         j++ ) {
+      len += iov[j].iov_len;
+    }
+    reqs[nreqs].fd = fd;
+    reqs[nreqs].writing = writing;
+    reqs[nreqs].iov = &iov[i];
+    reqs[nreqs].iovcnt = j - i;
+    reqs[nreqs].offset = offset;
+    reqs[nreqs].len = len;
+    qio_async_submit(&reqs[nreqs]);
+    offset += len;
+    nreqs++;
+  }
+
+  // Wait for all of them, even after a short one, since they all
+  // refer to iov.
+  total = 0;
+  err = 0;
+  for( i = 0; i < nreqs; i++ ) {
+    qio_async_wait(&reqs[i]);
+  }
+  for( i = 0; i < nreqs; i++ ) {
+    if( reqs[i].err ) {
+      // EEOF after some data is just a short read.
+      if( reqs[i].err != EEOF || total == 0 ) err = reqs[i].err;
+      break;
+    }
+    total += reqs[i].nbytes;
+    if( reqs[i].nbytes != reqs[i].len ) break;
+  }
+
+  MAYBE_STACK_FREE(reqs, reqs_onstack);
+
+  *num_out = total;
+  return err;
+}
+
+static
+qioerr qio_async_qbuffer(qio_file_t* file, int writing, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_out)
+{
+  ssize_t n = 0;
+  int64_t num_bytes = qbuffer_iter_num_bytes(start, end);
+  ssize_t num_parts = qbuffer_iter_num_parts(start, end);
+  struct iovec* iov = NULL;
+  size_t iovcnt;
+  MAYBE_STACK_SPACE(struct iovec, iov_onstack);
+  qioerr err;
+
+  if( num_bytes < 0 || num_parts < 0 || num_parts > INT_MAX ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "range outside of buffer");
+  }
+
+  MAYBE_STACK_ALLOC(struct iovec, num_parts, iov, iov_onstack);
+  if( ! iov ) {
+    err = QIO_ENOMEM;
+    goto error;
+  }
+
+  err = qbuffer_to_iov(buf, start, end, num_parts, iov, NULL, &iovcnt);
+  if( err ) goto error;
+
+  err = qio_int_to_err(qio_async_iov(file->fd, writing, iov, iovcnt, seek_to_offset, &n));
+
+error:
+  MAYBE_STACK_FREE(iov, iov_onstack);
+
+  *num_out = n;
+
+  return err;
+}
+
+qioerr qio_async_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read)
+{
+  // Plugin files don't have an fd to give the kernel.
+  if( file->fd == -1 )
+    return qio_preadv(file, buf, start, end, seek_to_offset, num_read);
+
+  return qio_async_qbuffer(file, 0, buf, start, end, seek_to_offset, num_read);
+}
+
+qioerr qio_async_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written)
+{
+  if( file->fd == -1 )
+    return qio_pwritev(file, buf, start, end, seek_to_offset, num_written);
+
+  return qio_async_qbuffer(file, 1, buf, start, end, seek_to_offset, num_written);
+}
@@ -18,6 +18,20 @@
  */
 
 
+#include "sys_basic.h"
+
+// The byte scanners below use SSE2 (always available on x86-64),
+// or AVX2 when the runtime is built for a target that has it.
+// These headers come before the runtime headers because they use malloc.
+#if defined(__GNUC__) && defined(__SSE2__)
+#define QIO_SCAN_SSE2 1
+#include <emmintrin.h>
+#if defined(__AVX2__)
+#define QIO_SCAN_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
 #ifndef SIMPLE_TEST
 #include "chplrt.h"
 #endif
@@ -25,6 +39,7 @@
 #include "qio_formatted.h"
 
 #include <limits.h>
+#include <float.h>
 #include <ctype.h>
 
 #ifdef HAS_WCTYPE_H
@@ -65,6 +80,139 @@ static int wcwidth(int wc) {
 }
 #endif
 
+/* BULK SCANNING ----------------------------
+ *
+ * Most text is ASCII, and most of the time in text input goes to
+ * skipping whitespace and finding the end of a token. Instead of
+ * decoding one character at a time, these routines scan the channel's
+ * cached region (ch->cached_cur .. ch->cached_end) 16 or 32 bytes at
+ * a time and advance cached_cur past the bytes they consume, just like
+ * the qio_channel_read_char fast path does.
+ *
+ * They only treat ASCII bytes specially and always stop at a byte
+ * >= 0x80, so anything else is left for the character-at-a-time code
+ * (which handles multibyte and non-ASCII whitespace). They are only
+ * used for UTF-8 and ASCII locales, where an ASCII byte is always a
+ * character by itself.
+ */
+
+static inline
+int _qio_isspace_ascii(uint8_t c)
+{
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Returns a pointer to the first byte in [p, end) that is not one of
+// the ASCII whitespace characters " \t\n\v\f\r" (or end).
+static inline
+const uint8_t* _qio_scan_space(const uint8_t* p, const uint8_t* end)
+{
+#ifdef QIO_SCAN_AVX2
+  {
+    const __m256i sp = _mm256_set1_epi8(' ');
+    const __m256i lo = _mm256_set1_epi8('\t' - 1);
+    const __m256i hi = _mm256_set1_epi8('\r' + 1);
+    while( end - p >= 32 ) {
+      __m256i v = _mm256_loadu_si256((const __m256i*) p);
+      // Signed compares, so bytes >= 0x80 are never in '\t'..'\r'
+      __m256i ctl = _mm256_and_si256(_mm256_cmpgt_epi8(v, lo),
+                                     _mm256_cmpgt_epi8(hi, v));
+      __m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(v, sp), ctl);
+      uint32_t stop = ~ (uint32_t) _mm256_movemask_epi8(ws);
+      if( stop ) return p + __builtin_ctz(stop);
+      p += 32;
+    }
+  }
+#endif
+#ifdef QIO_SCAN_SSE2
+  {
+    const __m128i sp = _mm_set1_epi8(' ');
+    const __m128i lo = _mm_set1_epi8('\t' - 1);
+    const __m128i hi = _mm_set1_epi8('\r' + 1);
+    while( end - p >= 16 ) {
+      __m128i v = _mm_loadu_si128((const __m128i*) p);
+      __m128i ctl = _mm_and_si128(_mm_cmpgt_epi8(v, lo),
+                                  _mm_cmplt_epi8(v, hi));
+      __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(v, sp), ctl);
+      uint32_t stop = 0xffff & ~ (uint32_t) _mm_movemask_epi8(ws);
+      if( stop ) return p + __builtin_ctz(stop);
+      p += 16;
+    }
+  }
+#endif
+  while( p < end && _qio_isspace_ascii(*p) ) p++;
+  return p;
+}
+
+// Returns a pointer to the first byte in [p, end) that is >= 0x80,
+// equal to stop_a or stop_b, or (if stop_space is set) <= ' '. Every
+// ASCII byte that iswspace might accept is <= ' ', so the bytes before
+// the returned pointer are plain characters for a whitespace-delimited
+// or quoted token.
+static inline
+const uint8_t* _qio_scan_plain(const uint8_t* p, const uint8_t* end, int stop_space, uint8_t stop_a, uint8_t stop_b)
+{
+#ifdef QIO_SCAN_AVX2
+  {
+    const __m256i a = _mm256_set1_epi8(stop_a);
+    const __m256i b = _mm256_set1_epi8(stop_b);
+    // With a signed compare, v < '!' also catches bytes >= 0x80.
+    const __m256i sp = _mm256_set1_epi8(stop_space ? '!' : -128);
+    while( end - p >= 32 ) {
+      __m256i v = _mm256_loadu_si256((const __m256i*) p);
+      __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(v, a),
+                                    _mm256_cmpeq_epi8(v, b));
+      uint32_t stop;
+      hit = _mm256_or_si256(hit, _mm256_cmpgt_epi8(sp, v));
+      stop = (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(hit, v));
+      if( stop ) return p + __builtin_ctz(stop);
+      p += 32;
+    }
+  }
+#endif
+#ifdef QIO_SCAN_SSE2
+  {
+    const __m128i a = _mm_set1_epi8(stop_a);
+    const __m128i b = _mm_set1_epi8(stop_b);
+    const __m128i sp = _mm_set1_epi8(stop_space ? '!' : -128);
+    while( end - p >= 16 ) {
+      __m128i v = _mm_loadu_si128((const __m128i*) p);
+      __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, a),
+                                 _mm_cmpeq_epi8(v, b));
+      uint32_t stop;
+      hit = _mm_or_si128(hit, _mm_cmplt_epi8(v, sp));
+      stop = (uint32_t) _mm_movemask_epi8(_mm_or_si128(hit, v));
+      if( stop ) return p + __builtin_ctz(stop);
+      p += 16;
+    }
+  }
+#endif
+  while( p < end && *p < 0x80 && *p != stop_a && *p != stop_b &&
+         !(stop_space && *p <= ' ') ) {
+    p++;
+  }
+  return p;
+}
+
+static inline
+int _qio_can_scan_bytes(void)
+{
+  return qio_glocale_utf8 == QIO_GLOCALE_UTF8 ||
+         qio_glocale_utf8 == QIO_GLOCALE_ASCII;
+}
+
+// Skip any ASCII whitespace in the cached region. Reading continues
+// one character at a time after this (in case the region ran out
+// or there's some non-ASCII whitespace).
+static inline
+void _qio_skip_space_cached(qio_channel_t* restrict ch)
+{
+  if( _qio_can_scan_bytes() && ch->cached_cur < ch->cached_end ) {
+    ch->cached_cur = (void*) _qio_scan_space((const uint8_t*) ch->cached_cur,
+                                             (const uint8_t*) ch->cached_end);
+  }
+}
+
 qioerr qio_channel_read_uvarint(const int threadsafe, qio_channel_t* restrict ch, uint64_t* restrict ptr) {
   qioerr err = 0;
   uint8_t byte;
@@ -171,6 +319,17 @@ qioerr _peek_until_byte(qio_channel_t* restrict ch, uint8_t term_byte, int64_t*
   if( err ) return err;
 
   while( 1 ) {
+    // Search whatever is in the cached region all at once.
+    if( ch->cached_cur < ch->cached_end ) {
+      void* found = memchr(ch->cached_cur, term_byte,
+                           VOID_PTR_DIFF(ch->cached_end, ch->cached_cur));
+      if( found ) {
+        ch->cached_cur = VOID_PTR_ADD(found, 1);
+        byte = term_byte;
+        break;
+      }
+      ch->cached_cur = ch->cached_end;
+    }
     err = qio_channel_read_uint8(false, ch, &byte);
     if( err ) break;
     if( byte == term_byte ) break;
@@ -227,6 +386,8 @@ qioerr _getc_after_whitespace(qio_channel_t* restrict ch, int32_t* restrict got_
   qioerr err = 0;
   int32_t chr = 0;
 
+  _qio_skip_space_cached(ch);
+
   while( 1 ) {
     err = qio_channel_read_char(false, ch, &chr);
     if( ! iswspace(chr) ) break;
@@ -321,6 +482,43 @@ qioerr _append_char(char* restrict * restrict buf, size_t* restrict buf_len, siz
   return 0;
 }
 
+// Like _append_char, but for len bytes that are already encoded.
+static
+qioerr _append_bytes(char* restrict * restrict buf, size_t* restrict buf_len, size_t* restrict buf_max, const void* restrict ptr, size_t len)
+{
+  char* buf_in = *buf;
+  size_t len_in = *buf_len;
+  size_t max_in = *buf_max;
+  char* newbuf;
+  size_t newsz;
+  size_t need;
+
+  need = len_in + len + 1;
+  if( need < len_in || need > (SSIZE_MAX-1) ) {
+    // Too big.
+    QIO_RETURN_CONSTANT_ERROR(EOVERFLOW, "");
+  }
+  if( need >= max_in ) {
+    // Reallocate buffer.
+    newsz = 2 * max_in;
+    if( newsz < 16  ) newsz = 16;
+    if( newsz < need  ) newsz = need;
+    newbuf = qio_realloc(buf_in, newsz);
+    if( ! newbuf ) return QIO_ENOMEM;
+    buf_in = newbuf;
+    max_in = newsz;
+  }
+
+  qio_memcpy(&buf_in[len_in], ptr, len);
+  len_in += len;
+
+  *buf = buf_in;
+  *buf_len = len_in;
+  *buf_max = max_in;
+
+  return 0;
+}
+
 // string binary style:
 // QIO_BINARY_STRING_STYLE_LEN1B_DATA -1 -- 1 byte of length before
 // QIO_BINARY_STRING_STYLE_LEN2B_DATA -2 -- 2 bytes of length before
@@ -483,6 +681,8 @@ qioerr qio_channel_scan_string(const int threadsafe, qio_channel_t* restrict ch,
   ssize_t nread = 0;
   int64_t mark_offset;
   int64_t end_offset;
+  int scan_bytes;
+  uint8_t stop_a, stop_b;
 
   if( qio_glocale_utf8 == 0 ) {
     qio_set_glocale();
@@ -551,13 +751,41 @@ qioerr qio_channel_scan_string(const int threadsafe, qio_channel_t* restrict ch,
     stop_space = 0;
   }
 
+  // Runs of ASCII that aren't the terminator (or whitespace, for
+  // FORMAT_WORD) or a backslash can be copied to the result directly.
+  // A terminator that isn't ASCII is found by the slow path, since
+  // the scan stops at every non-ASCII byte anyway.
+  scan_bytes = _qio_can_scan_bytes();
+  stop_a = (0 <= term_chr && term_chr < 0x80) ? term_chr : 0x80;
+  stop_b = handle_back ? '\\' : stop_a;
+
   err = 0;
   for( nread = 0; nread < maxlen && !err; nread++ ) {
+    if( nread > 0 && scan_bytes && ch->cached_cur < ch->cached_end ) {
+      const uint8_t* start = (const uint8_t*) ch->cached_cur;
+      const uint8_t* end = (const uint8_t*) ch->cached_end;
+      const uint8_t* stop;
+      if( end - start > maxlen - nread ) end = start + (maxlen - nread);
+      stop = _qio_scan_plain(start, end, stop_space, stop_a, stop_b);
+      if( stop > start ) {
+        err = _append_bytes(&ret, &ret_len, &ret_max, start, stop - start);
+        if( err ) break;
+        ch->cached_cur = (void*) stop;
+        nread += stop - start;
+        if( nread >= maxlen ) break;
+      }
+    }
+
     err = qio_channel_read_char(false, ch, &chr);
     if( err ) break;
 
     // If we're using FORMAT_WORD, skip any whitespace at the beginning
     if( nread == 0 ) {
+      if( !(style->string_format == QIO_STRING_FORMAT_TOEND ||
+            style->string_format == QIO_STRING_FORMAT_TOEOF) &&
+          iswspace(chr) ) {
+        _qio_skip_space_cached(ch);
+      }
       while( !(style->string_format == QIO_STRING_FORMAT_TOEND ||
                style->string_format == QIO_STRING_FORMAT_TOEOF) &&
              iswspace(chr) ) {
@@ -800,6 +1028,7 @@ qioerr qio_channel_scan_literal(const int threadsafe, qio_channel_t* restrict ch
     err = qio_channel_mark(false, ch);
     if( err ) goto revert;
 
+    _qio_skip_space_cached(ch);
     while( 1 ) {
       lastwspos = qio_channel_offset_unlocked(ch);
       err = qio_channel_read_char(false, ch, &wchr);
@@ -842,6 +1071,7 @@ qioerr qio_channel_scan_literal(const int threadsafe, qio_channel_t* restrict ch
     err = qio_channel_mark(false, ch);
     if( err ) goto revert;
 
+    _qio_skip_space_cached(ch);
     while( 1 ) {
       lastwspos = qio_channel_offset_unlocked(ch);
       err = qio_channel_read_char(false, ch, &wchr);
@@ -1584,6 +1814,7 @@ qioerr _peek_number_unlocked(qio_channel_t* restrict ch, number_reading_state_t*
   if( err ) return err;
 
   // First, skip any whitespace.
+  _qio_skip_space_cached(ch);
   do {
     NEXT_CHR;
   } while( iswspace(chr) );
@@ -1739,6 +1970,206 @@ error:
 }
 
 
+/* DECIMAL FAST PATHS ----------------------
+ *
+ * Numbers written in the default decimal style (no base prefix, the
+ * usual sign and point characters) are by far the most common, so
+ * qio_channel_scan_int and qio_channel_scan_float first try to convert
+ * them directly from the cached region. These only handle numbers
+ * that are entirely in the cached region and are followed by an ASCII
+ * character that can't continue a number; anything else (0x prefixes,
+ * inf and nan, very long numbers, the end of the buffer, unusual
+ * styles) is left to _peek_number_unlocked and the C library.
+ * The channel is only modified when the fast path succeeds.
+ */
+
+// Can the character after a number be left for the next read?
+// Letters could be base prefixes, exponents, or the rest of inf/nan.
+static inline
+int _qio_ends_number(uint8_t c)
+{
+  return c < 0x80 && c != '.' &&
+         !('0' <= c && c <= '9') &&
+         !('a' <= c && c <= 'z') &&
+         !('A' <= c && c <= 'Z');
+}
+
+static inline
+bool _qio_decimal_style(const qio_style_t* restrict style)
+{
+  return (style->base == 0 || style->base == 10) &&
+         style->positive_char == '+' &&
+         style->negative_char == '-';
+}
+
+// Reads [whitespace][sign]digits. On success, sets *num_out and *sign_out
+// the way qio_channel_scan_int expects them and advances cached_cur.
+static inline
+bool _qio_scan_int_fast(qio_channel_t* restrict ch, int issigned, unsigned long long int* restrict num_out, int* restrict sign_out)
+{
+  const uint8_t* p = (const uint8_t*) ch->cached_cur;
+  const uint8_t* end = (const uint8_t*) ch->cached_end;
+  const uint8_t* digits;
+  uint64_t num = 0;
+  int sign = 1;
+
+  if( ! _qio_can_scan_bytes() ) return false;
+  if( ! _qio_decimal_style(&ch->style) ) return false;
+
+  p = _qio_scan_space(p, end);
+  if( p == end ) return false;
+
+  if( issigned && *p == '-' ) {
+    sign = -1;
+    p++;
+  } else if( ch->style.showplus == 1 && *p == '+' ) {
+    p++;
+  }
+
+  // 19 decimal digits always fit in a uint64_t; longer numbers
+  // stop here on a digit and are handled by the general code.
+  digits = p;
+  while( p < end && p - digits < 19 && '0' <= *p && *p <= '9' ) {
+    num = 10*num + (*p - '0');
+    p++;
+  }
+
+  if( p == digits || p == end || ! _qio_ends_number(*p) ) return false;
+
+  ch->cached_cur = (void*) p;
+  *num_out = num;
+  *sign_out = sign;
+  return true;
+}
+
+// Powers of 10 that are exactly representable as a double.
+static const double _qio_exact_pow10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+  1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+  1e21, 1e22
+};
+
+// Reads [whitespace][sign]digits[.digits][e[sign]digits] and converts
+// it exactly, using the observation (Clinger 1990) that when the
+// digits and the power of 10 are both exactly representable, one
+// correctly rounded multiply or divide gives the correctly rounded
+// result. Numbers with more than 19 significant digits, or that need
+// a larger power of 10, go to strtod.
+static inline
+bool _qio_scan_float_fast(qio_channel_t* restrict ch, double* restrict out)
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+  const uint8_t* p = (const uint8_t*) ch->cached_cur;
+  const uint8_t* end = (const uint8_t*) ch->cached_end;
+  const qio_style_t* style = &ch->style;
+  uint64_t mant = 0;
+  int ndigits = 0;
+  int any = 0;
+  int64_t exp10 = 0;
+  int negative = 0;
+  double num;
+
+  if( ! _qio_can_scan_bytes() ) return false;
+  if( ! _qio_decimal_style(style) ) return false;
+  if( style->point_char != '.' || tolower(style->exponent_char) != 'e' ) {
+    return false;
+  }
+
+  p = _qio_scan_space(p, end);
+  if( p == end ) return false;
+
+  if( *p == '-' ) {
+    negative = 1;
+    p++;
+  } else if( *p == '+' ) {
+    p++;
+  }
+
+  // Integer part. Leading zeros are not significant.
+  while( p < end && '0' <= *p && *p <= '9' ) {
+    any = 1;
+    if( mant != 0 || *p != '0' ) {
+      if( ndigits == 19 ) return false;
+      mant = 10*mant + (*p - '0');
+      ndigits++;
+    }
+    p++;
+  }
+
+  // Fractional part.
+  if( p < end && *p == '.' ) {
+    p++;
+    while( p < end && '0' <= *p && *p <= '9' ) {
+      any = 1;
+      if( mant != 0 || *p != '0' ) {
+        if( ndigits == 19 ) return false;
+        mant = 10*mant + (*p - '0');
+        ndigits++;
+      }
+      exp10--;
+      p++;
+    }
+  }
+
+  if( ! any ) return false;
+
+  // Exponent.
+  if( p < end && (*p == 'e' || *p == 'E') ) {
+    const uint8_t* exp_digits;
+    int64_t e = 0;
+    int exp_negative = 0;
+    p++;
+    if( p < end && (*p == '-' || *p == '+') ) {
+      exp_negative = (*p == '-');
+      p++;
+    }
+    exp_digits = p;
+    while( p < end && '0' <= *p && *p <= '9' ) {
+      if( p - exp_digits == 9 ) return false;
+      e = 10*e + (*p - '0');
+      p++;
+    }
+    if( p == exp_digits ) return false;
+    exp10 += exp_negative ? -e : e;
+  }
+
+  if( p == end || ! _qio_ends_number(*p) ) return false;
+
+  if( mant == 0 ) {
+    num = 0.0;
+  } else {
+    if( mant > (UINT64_C(1) << DBL_MANT_DIG) ) return false;
+    num = (double) mant;
+    if( exp10 < -22 ) {
+      return false;
+    } else if( exp10 < 0 ) {
+      num /= _qio_exact_pow10[-exp10];
+    } else if( exp10 <= 22 ) {
+      num *= _qio_exact_pow10[exp10];
+    } else if( exp10 <= 22 + 15 ) {
+      // e.g. 12e30: move some of the power of 10 into the mantissa
+      // as long as that is still exact.
+      uint64_t scaled = mant;
+      int64_t i;
+      for( i = 22; i < exp10; i++ ) {
+        scaled *= 10;
+        if( scaled > (UINT64_C(1) << DBL_MANT_DIG) ) return false;
+      }
+      num = (double) scaled * _qio_exact_pow10[22];
+    } else {
+      return false;
+    }
+  }
+
+  ch->cached_cur = (void*) p;
+  *out = negative ? -num : num;
+  return true;
+#else
+  // Intermediate results might be rounded to extended precision.
+  return false;
+#endif
+}
+
 qioerr qio_channel_scan_int(const int threadsafe, qio_channel_t* restrict ch, void* restrict out, size_t len, int issigned)
 {
   unsigned long long int num = 0;
@@ -1764,6 +2195,11 @@ qioerr qio_channel_scan_int(const int threadsafe, qio_channel_t* restrict ch, vo
 
   style = &ch->style;
 
+  if( _qio_scan_int_fast(ch, issigned, &num, &sign) ) {
+    err = 0;
+    goto error;
+  }
+
   memset(&st, 0, sizeof(number_reading_state_t));
 
   st.base = style->base;
@@ -1911,6 +2347,11 @@ qioerr qio_channel_scan_float_or_imag(const int threadsafe, qio_channel_t* restr
 
   needs_i = imag && style->complex_style == QIO_COMPLEX_FORMAT_ABI;
 
+  if( ! needs_i && _qio_scan_float_fast(ch, &num) ) {
+    err = 0;
+    goto error;
+  }
+
   memset(&st, 0, sizeof(number_reading_state_t));
 
   st.base = style->base;
@@ -2092,6 +2533,41 @@ static inline int _ltoa_convert(char *tmp, int tmplen, uint64_t num, int base, i
   return at;
 }
 
+static const char _qio_digit_pairs[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+// _ltoa_convert for base 10, producing two digits per division.
+// tmplen must be at least 21.
+static inline int _ltoa_convert10(char *tmp, int tmplen, uint64_t num)
+{
+  int at = tmplen - 1;
+  int pair;
+  tmp[at] = '\0';
+  while( num >= 100 ) {
+    pair = 2 * (num % 100);
+    num /= 100;
+    tmp[--at] = _qio_digit_pairs[pair + 1];
+    tmp[--at] = _qio_digit_pairs[pair];
+  }
+  if( num >= 10 ) {
+    pair = 2 * num;
+    tmp[--at] = _qio_digit_pairs[pair + 1];
+    tmp[--at] = _qio_digit_pairs[pair];
+  } else {
+    tmp[--at] = '0' + num;
+  }
+  return at;
+}
+
 // dst must have room (at most 65 bytes for binary + '\0')
 // Returns the number of characters written (not including '\0')
 // or >= size if there wasn't room in the buffer (returns amt needed)
@@ -2115,7 +2591,7 @@ int _ltoa(char* restrict dst, size_t size, uint64_t num, int isnegative,
   else if( base == 8 )
     tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 8, 0);
   else if( base == 10 )
-    tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 10, 0);
+    tmp_skip = _ltoa_convert10(tmp, sizeof(tmp), num);
   else if( base == 16 )
     tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 16, style->uppercase);
   else
@@ -2187,6 +2663,185 @@ int _ltoa(char* restrict dst, size_t size, uint64_t num, int isnegative,
   return i;
 }
 
+#ifdef __SIZEOF_INT128__
+static const uint64_t _qio_pow10_u64[] = {
+  UINT64_C(1), UINT64_C(10), UINT64_C(100), UINT64_C(1000),
+  UINT64_C(10000), UINT64_C(100000), UINT64_C(1000000),
+  UINT64_C(10000000), UINT64_C(100000000), UINT64_C(1000000000),
+  UINT64_C(10000000000), UINT64_C(100000000000),
+  UINT64_C(1000000000000), UINT64_C(10000000000000),
+  UINT64_C(100000000000000), UINT64_C(1000000000000000),
+  UINT64_C(10000000000000000), UINT64_C(100000000000000000),
+  UINT64_C(1000000000000000000), UINT64_C(10000000000000000000)
+};
+
+// Rounds num (finite and > 0) to prec significant decimal digits
+// exactly the way printf does (round half to even on the exact binary
+// value), using 128-bit integer arithmetic. On success, num is about
+// *digits_out * 10^(*exp10_out - prec + 1), with *digits_out having
+// exactly prec digits. Returns false if num is out of the range this
+// handles (very large or small, or subnormal).
+static
+bool _qio_round_decimal(double num, int prec, uint64_t* restrict digits_out, int* restrict exp10_out)
+{
+  typedef unsigned __int128 u128;
+  uint64_t bits;
+  uint64_t mant;
+  int binexp;
+  int x10;
+  int tries;
+  uint64_t lo = _qio_pow10_u64[prec-1];
+  uint64_t hi = _qio_pow10_u64[prec];
+
+  memcpy(&bits, &num, sizeof(bits));
+  binexp = (int) ((bits >> 52) & 0x7ff);
+  if( binexp == 0 || binexp == 0x7ff ) return false;
+  mant = (bits & ((UINT64_C(1) << 52) - 1)) | (UINT64_C(1) << 52);
+  binexp -= 1075; // num == mant * 2^binexp
+
+  // This estimate can be off by one; the loop fixes it.
+  x10 = (int) floor(log10(num));
+
+  for( tries = 0; tries < 3; tries++ ) {
+    int p = prec - 1 - x10;
+    u128 q, r, half;
+    int up;
+
+    // q = floor(num * 10^p), and compare the rest with 1/2.
+    if( p >= 0 ) {
+      u128 n;
+      if( p > 19 ) return false;
+      n = (u128) mant * _qio_pow10_u64[p]; // < 2^117
+      if( binexp >= 0 ) {
+        if( binexp > 10 ) return false;
+        q = n << binexp;
+        up = 0;
+      } else {
+        int s = -binexp;
+        if( s > 127 ) return false;
+        q = n >> s;
+        r = n & ((((u128) 1) << s) - 1);
+        half = ((u128) 1) << (s - 1);
+        up = r > half || (r == half && (q & 1));
+      }
+    } else {
+      u128 n, den;
+      if( -p > 19 ) return false;
+      if( binexp >= 0 ) {
+        if( binexp > 74 ) return false;
+        n = ((u128) mant) << binexp;
+        den = _qio_pow10_u64[-p];
+      } else {
+        if( -binexp > 63 ) return false;
+        n = mant;
+        den = ((u128) _qio_pow10_u64[-p]) << (-binexp);
+      }
+      q = n / den;
+      r = n % den;
+      half = den - r; // compare r with den - r instead of 2*r with den
+      up = r > half || (r == half && (q & 1));
+    }
+
+    if( q < lo ) {
+      x10--;
+    } else if( q >= hi ) {
+      x10++;
+    } else {
+      if( up ) q++;
+      if( q == hi ) {
+        q = lo;
+        x10++;
+      }
+      *digits_out = (uint64_t) q;
+      *exp10_out = x10;
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
+// Formats num (which must not be negative) the way snprintf's %g
+// (%G if uppercase) or %.*g would, for the default 6 or up to 17
+// significant digits. Returns the snprintf-style length, or -1 if
+// this number or precision should go through snprintf instead.
+static
+int _qio_format_g(char* restrict dst, size_t size, double num, int precision, int uppercase)
+{
+#ifdef __SIZEOF_INT128__
+  char tmp[40];
+  char digits[20];
+  uint64_t q;
+  int x10;
+  int prec;
+  int ndigits;
+  int len;
+  int i;
+
+  prec = precision;
+  if( prec < 0 ) prec = 6;
+  if( prec == 0 ) prec = 1;
+  if( prec > 17 ) return -1;
+
+  if( num == 0.0 ) {
+    tmp[0] = '0';
+    len = 1;
+  } else {
+    if( ! _qio_round_decimal(num, prec, &q, &x10) ) return -1;
+
+    for( i = prec - 1; i >= 0; i-- ) {
+      digits[i] = '0' + q % 10;
+      q /= 10;
+    }
+    // %g removes trailing zeros from the fraction.
+    ndigits = prec;
+    while( ndigits > 1 && digits[ndigits-1] == '0' ) ndigits--;
+
+    len = 0;
+    if( x10 < -4 || x10 >= prec ) {
+      // d.ddde+XX
+      tmp[len++] = digits[0];
+      if( ndigits > 1 ) {
+        tmp[len++] = '.';
+        memcpy(tmp + len, digits + 1, ndigits - 1);
+        len += ndigits - 1;
+      }
+      tmp[len++] = uppercase ? 'E' : 'e';
+      tmp[len++] = (x10 < 0) ? '-' : '+';
+      if( x10 < 0 ) x10 = -x10;
+      if( x10 >= 100 ) tmp[len++] = '0' + x10 / 100;
+      tmp[len++] = '0' + (x10 / 10) % 10;
+      tmp[len++] = '0' + x10 % 10;
+    } else if( x10 >= 0 ) {
+      // ddd.ddd
+      memcpy(tmp, digits, x10 + 1);
+      len = x10 + 1;
+      if( ndigits > x10 + 1 ) {
+        tmp[len++] = '.';
+        memcpy(tmp + len, digits + x10 + 1, ndigits - x10 - 1);
+        len += ndigits - x10 - 1;
+      }
+    } else {
+      // 0.000ddd
+      tmp[len++] = '0';
+      tmp[len++] = '.';
+      for( i = -1; i > x10; i-- ) tmp[len++] = '0';
+      memcpy(tmp + len, digits, ndigits);
+      len += ndigits;
+    }
+  }
+
+  if( size > 0 ) {
+    size_t n = ((size_t) len < size) ? len : size - 1;
+    memcpy(dst, tmp, n);
+    dst[n] = '\0';
+  }
+  return len;
+#else
+  return -1;
+#endif
+}
+
 // error codes:
 //  -1 for out of memory
 //  -2 for error in conversion
@@ -2265,6 +2920,10 @@ int _ftoa(char* restrict dst, size_t size, double num, int base, bool needs_i, c
             got = snprintf(buf, buf_sz, "%.*a", precision, num);
         }
       }
+    } else if( style->realfmt == 0 && ! style->showpoint &&
+               (got = _qio_format_g(buf, buf_sz, num, precision,
+                                    style->uppercase)) >= 0 ) {
+      // Printed by the fast path; same output as below.
     } else if( style->realfmt == 0 ) {
       if( precision < 0 ) {
         if( style->uppercase ) {
@@ -2896,6 +3555,19 @@ qioerr qio_channel_skip_past_newline(const int threadsafe, qio_channel_t* restri
   }
 
   while( 1 ) {
+    // '\n' is never part of a multibyte character in UTF-8 or ASCII,
+    // so when we don't need to look at the rest, search for it directly.
+    if( !skipOnlyWs && _qio_can_scan_bytes() &&
+        ch->cached_cur < ch->cached_end ) {
+      void* found = memchr(ch->cached_cur, '\n',
+                           VOID_PTR_DIFF(ch->cached_end, ch->cached_cur));
+      if( found ) {
+        ch->cached_cur = VOID_PTR_ADD(found, 1);
+        err = 0;
+        break;
+      }
+      ch->cached_cur = ch->cached_end;
+    }
     lastpos = qio_channel_offset_unlocked(ch);
     err = qio_channel_read_char(threadsafe, ch, &c);
     if( err  || c == '\n' ) break;
@@ -28,12 +28,15 @@
 
 #include "chplrt.h"
 #include "chpl_rt_utils_static.h"
+#include "chpl-atomics.h"
 #include "chplcgfns.h"
 #include "chpl-comm.h"
 #include "chplexit.h"
 #include "chpl-locale-model.h"
 #include "chpl-mem.h"
+#include "chpl-mem-consistency.h"
 #include "chpl-tasks.h"
+#include "chpl-topo.h"
 #include "chplsys.h"
 #include "error.h"
 #include <stdio.h>
@@ -42,9 +45,20 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <stdlib.h>
+#include <sys/mman.h>
 #include <sys/time.h>
+#include <ucontext.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#if defined(SYS_futex) && defined(FUTEX_WAIT_BITSET)
+#define SYNC_HAS_FUTEX
+#endif
+#endif
+
 
 //
 // task pool: linked list of tasks
@@ -53,6 +67,7 @@ typedef struct task_pool_struct* task_pool_p;
 
 typedef struct {
   chpl_task_prvData_t prvdata;
+  c_sublocid_t        requestedSubloc;  // where the task wants to run
 } chpl_task_prvDataImpl_t;
 
 typedef struct task_pool_struct {
@@ -61,6 +76,7 @@ typedef struct task_pool_struct {
   void*            arg;          // argument to the function
   chpl_bool        begun;        // whether execution of this task has begun
   chpl_task_list_p ltask;        // points to the task list entry, if there is one
+  chpl_task_list_p task_list;    // the task list it was spawned from, if any
   c_string         filename;
   int              lineno;
   chpl_task_prvDataImpl_t chpl_data;
@@ -105,10 +121,72 @@ typedef struct lockReport {
 } lockReport_t;
 
 
+//
+// Work-stealing task deques.
+//
+// In work-stealing mode (CHPL_RT_WORK_STEALING) runnable tasks are not
+// kept in the global task pool.  Instead each thread owns a Chase-Lev
+// deque.  The owner pushes and pops tasks at the bottom without any
+// locking, and threads that run out of work steal from the top of
+// other threads' deques.  Tasks thus tend to run on the thread that
+// created them.  The element array grows by doubling; a thief may
+// still be reading an old array, so those are retired rather than
+// freed.
+//
+typedef struct task_deque_array {
+  int64_t                  size;       // capacity, always a power of 2
+  struct task_deque_array* retired;    // the array this one replaced
+  volatile task_pool_p     elems[];
+} task_deque_array_t;
+
+typedef struct {
+  atomic_int_least64_t top;            // thieves take from here
+  atomic_int_least64_t bottom;         // owner pushes and pops here
+  atomic_uintptr_t     array;          // current task_deque_array_t*
+} task_deque_t;
+
+#define TASK_DEQUE_INITIAL_SIZE 64
+
+
+//
+// Lightweight tasks.
+//
+// In lightweight-task mode (CHPL_RT_LIGHTWEIGHT_TASKS) each task begun
+// by a pool thread runs on a stack of its own, in a user-level context.
+// When such a task has to wait for a sync or single variable, or
+// yields, it switches back to its thread's scheduling loop rather than
+// blocking the thread.  A task waiting on a sync variable is put on
+// that variable's waiter list, and moved to the ready list when the
+// variable is signaled.  Yielding tasks go straight to the ready list.
+// Any pool thread may resume a ready task, so tasks can move from one
+// thread to another.  The main task, the comm task, and tasks run
+// nested inside one of those still wait by blocking their thread.
+//
+typedef struct task_ctx {
+  ucontext_t       uc;                 // saved state while switched out
+  void*            stack;              // base of the stack mapping
+  task_pool_p      ptask;              // the task this context was begun for
+  task_pool_p      curr_ptask;         // task running here when switched out
+  chpl_bool        want_full;          // what it is waiting for, on a sync
+  struct task_ctx* next;               // waiter, ready, and free lists
+} task_ctx_t;
+
+#define LW_STACK_CACHE_MAX 256         // stacks kept for reuse, at most
+#define LW_GUARDED_MAX     16384       // stacks with guard pages, at most
+#define LW_STACK_SLAB_CNT  64          // stacks per unguarded mapping
+
+
 // This is the data that is private to each thread.
 typedef struct {
   task_pool_p   ptask;
   lockReport_t* lockRprt;
+  task_deque_t* deque;                 // work-stealing mode only
+  uint32_t      steal_seed;            // picks the first steal victim
+  ucontext_t*   sched_uc;              // lightweight mode: scheduling loop
+  task_ctx_t*   ctx;                   // lightweight mode: running context
+  task_ctx_t*   lw_requeue;            // make ready once switched out
+  chpl_sync_aux_t* lw_unlock;          // unlock once switched out
+  c_sublocid_t  subloc;                // NUMA domain we're restricted to
 } thread_private_data_t;
 
 
@@ -149,6 +227,40 @@ static c_string idleTaskName = "|idle|";
 
 static chpl_fn_p comm_task_fn;
 
+static chpl_bool thread_create_failed = false;
+
+static chpl_bool work_stealing = false;      // per-thread deques?
+
+static atomic_int_least64_t ws_queued_task_cnt; // tasks in all deques
+static atomic_int_least64_t ws_idle_thread_cnt; // threads looking for work,
+                                               //   including new ones
+
+static chpl_thread_mutex_t deque_registry_lock; // protects registration
+static task_deque_t** volatile deque_registry;  // all threads' deques
+static volatile int        deque_registry_cnt;
+static int                 deque_registry_size;
+
+static chpl_bool lightweight_tasks = false;  // tasks on their own stacks?
+static uint32_t            lw_max_threads;     // pool threads, plus main
+static size_t              lw_stack_size;      // not counting guard page
+static size_t              lw_page_size;
+static chpl_thread_mutex_t lw_ready_lock;      // protects the ready list
+static task_ctx_t*         lw_ready_head;      // resumable tasks, oldest
+static task_ctx_t*         lw_ready_tail;      //   first
+static atomic_int_least64_t lw_ready_cnt;      // tasks in the ready list
+static chpl_thread_mutex_t lw_stack_lock;      // protects the stack cache
+static task_ctx_t*         lw_stack_cache;     // contexts with free stacks
+static int                 lw_stack_cache_cnt;
+static atomic_int_least64_t lw_guarded_cnt;    // stacks with guard pages
+static chpl_bool           lw_guard_failed = false;
+static char*               lw_slab_next;       // unguarded stacks, carved
+static int                 lw_slab_left;       //   out of bigger mappings
+
+static c_sublocid_t num_sublocales;          // NUMA domains, or 0 if flat
+
+#define SUBLOC_SCAN_MAX 16                   // queued tasks an idle thread
+                                             //   checks for its sublocale
+
 static void                    comm_task_wrapper(void*);
 static void                    movedTaskWrapper(void* a);
 static chpl_taskID_t           get_next_task_id(void);
@@ -164,6 +276,12 @@ static void                    unset_block_loc(void);
 static void                    check_for_deadlock(void);
 static void                    thread_begin(void*);
 static void                    thread_end(void);
+static task_pool_p             take_task_from_pool(task_pool_p);
+static task_pool_p             pick_task_for_thread(thread_private_data_t*);
+static void                    set_thread_ptask(thread_private_data_t*,
+                                                task_pool_p);
+static void                    move_thread_to_subloc(thread_private_data_t*,
+                                                     c_sublocid_t);
 static void                    begin_task(chpl_fn_p, void*,
                                           chpl_task_prvDataImpl_t,
                                           chpl_task_list_p);
@@ -172,87 +290,253 @@ static void                    schedule_next_task(int);
 static task_pool_p             add_to_task_pool(chpl_fn_p,
                                                 void*,
                                                 chpl_task_prvDataImpl_t,
+                                                chpl_task_list_p,
                                                 chpl_task_list_p);
+static void                    execute_nested_task(task_pool_p);
+static void                    warn_thread_create_failed(void);
+static void                    ws_thread_loop(thread_private_data_t*);
+static void                    ws_schedule_tasks(int);
+static task_pool_p             ws_find_task(thread_private_data_t*);
+static task_deque_t*           task_deque_create(void);
+static void                    task_deque_push(task_deque_t*, task_pool_p);
+static task_pool_p             task_deque_pop(task_deque_t*);
+static task_pool_p             task_deque_steal(task_deque_t*);
+static task_deque_t*           get_current_deque(void);
+static chpl_bool               can_create_thread(void);
+static void                    lw_thread_loop(thread_private_data_t*,
+                                              task_pool_p);
+static chpl_bool               lw_find_work(thread_private_data_t*, chpl_bool,
+                                            task_pool_p*, task_ctx_t**);
+static chpl_bool               lw_work_available(void);
+static void*                   lw_stack_alloc(void);
+static task_ctx_t*             lw_ctx_create(task_pool_p);
+static void                    lw_ctx_destroy(task_ctx_t*);
+static task_ctx_t*             get_current_ctx(void);
+static void                    lw_task_entry(void);
+static chpl_bool               lw_run(thread_private_data_t*, task_ctx_t*,
+                                      chpl_bool*);
+static void                    lw_switch_out(void);
+static void                    lw_make_ready(task_ctx_t*);
+static void                    lw_sync_suspend(chpl_sync_aux_t*, chpl_bool);
+static void                    lw_sync_awaken(chpl_sync_aux_t*, chpl_bool);
+
+// Sync variables
+
+//
+// A sync variable's lock, its full/empty state, and the number of
+// threads sleeping until they can lock it are all kept in one 32-bit
+// state word.  Locking it is a compare-and-swap when it is available.
+// Otherwise we spin a while, with exponential backoff, and then sleep
+// on the state word (a futex, on Linux).  How long we spin adapts to
+// how long it has taken to get each variable in the past.  Unlocking is
+// one atomic add, plus a futex wake if there are sleepers.  Sleepers
+// are woken only by unlocks that leave the variable in the state they
+// want, using the futex bitset operations.
+//
+#define SYNC_LOCKED       0x1u          // state word: locked
+#define SYNC_FULL         0x2u          //   full
+#define SYNC_WAITER       0x4u          //   sleepers are counted in these
+
+#define SYNC_WAIT_LOCK    0x1u          // futex bitset: waiting to lock
+#define SYNC_WAIT_FULL    0x2u          //   waiting for full
+#define SYNC_WAIT_EMPTY   0x4u          //   waiting for empty
+
+#define SYNC_SPIN_MAX     100           // spins before sleeping, at most
+#define SYNC_BACKOFF_MAX  64            // pauses between spins, at most
+
+static int32_t  sync_spin_max;          // SYNC_SPIN_MAX, or 0 on 1 cpu
+static uint32_t sync_num_cpus;          // logical cpus we may spin on
+
+static inline void sync_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __asm__ __volatile__ ("pause" ::: "memory");
+#else
+  __asm__ __volatile__ ("" ::: "memory");
+#endif
+}
+
+static inline uint32_t sync_load(chpl_sync_aux_t *s) {
+  return __atomic_load_n(&s->state, __ATOMIC_RELAXED);
+}
 
 //
-// Condition variable methods
+// Lock the variable if, in *pst, it is unlocked and its full bit masked
+// by want_mask is want_bits.  On failure *pst is the latest state.
 //
-static void chpl_thread_condvar_init(chpl_thread_condvar_t* cv);
+static inline chpl_bool sync_try_lock(chpl_sync_aux_t *s, uint32_t *pst,
+                                      uint32_t want_mask, uint32_t want_bits) {
+  while ((*pst & (SYNC_LOCKED | want_mask)) == want_bits) {
+    if (__atomic_compare_exchange_n(&s->state, pst, *pst | SYNC_LOCKED, 1,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+      return true;
+  }
+  return false;
+}
 
 //
-// Sync variable methods
+// Sleep until the state word may no longer be st, or a while has passed
+// if timed is set.  Returns true if we gave up because time passed.
 //
-static chpl_bool chpl_thread_sync_suspend(chpl_sync_aux_t *s,
-                                   struct timeval *deadline);
-static void chpl_thread_sync_awaken(chpl_sync_aux_t *s);
+static chpl_bool sync_sleep(chpl_sync_aux_t *s, uint32_t st,
+                            uint32_t bitset, chpl_bool timed) {
+#ifdef SYNC_HAS_FUTEX
+  struct timespec deadline;
+
+  if (timed) {
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += 1;
+  }
+  return (syscall(SYS_futex, &s->state,
+                  FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG, st,
+                  timed ? &deadline : NULL, NULL, bitset) == -1
+          && errno == ETIMEDOUT);
+#else
+  struct timeval deadline, now;
 
-// Sync variables
+  if (!timed) {
+    chpl_thread_yield();
+    return false;
+  }
 
-static void sync_wait_and_lock(chpl_sync_aux_t *s,
-                               chpl_bool want_full,
-                               int32_t lineno, c_string filename) {
-  chpl_bool suspend_using_cond;
+  gettimeofday(&deadline, NULL);
+  deadline.tv_sec += 1;
+  do {
+    chpl_thread_yield();
+    if (sync_load(s) != st)
+      return false;
+    gettimeofday(&now, NULL);
+  } while (now.tv_sec < deadline.tv_sec
+           || (now.tv_sec == deadline.tv_sec
+               && now.tv_usec < deadline.tv_usec));
+  return true;
+#endif
+}
 
-  chpl_thread_mutexLock(&s->lock);
+//
+// Wake one thread sleeping in sync_sleep() for any of the bitset reasons.
+//
+static inline void sync_wake(chpl_sync_aux_t *s, uint32_t bitset) {
+#ifdef SYNC_HAS_FUTEX
+  (void) syscall(SYS_futex, &s->state,
+                 FUTEX_WAKE_BITSET | FUTEX_PRIVATE_FLAG, 1,
+                 NULL, NULL, bitset);
+#endif
+}
 
-  // If we're oversubscribing the hardware, we wait using conditionals
-  // in order to ensure fairness and thus progress.  If we're not, we
-  // can spin-wait.
-  suspend_using_cond = (chpl_thread_getNumThreads() >=
-                        chpl_getNumLogicalCpus(true));
+//
+// Lock the variable once its full bit masked by want_mask is want_bits.
+// This is the thread-level wait; lightweight tasks wait in
+// sync_wait_and_lock() instead.  Blocking on the full/empty state counts
+// for deadlock detection, but waiting just for the lock doesn't, since
+// locks are only held briefly.
+//
+static void sync_lock_when(chpl_sync_aux_t *s,
+                           uint32_t want_mask, uint32_t want_bits,
+                           int32_t lineno, c_string filename) {
+  uint32_t  st = sync_load(s);
+  uint32_t  bitset;
+  int32_t   spin_limit, cnt, backoff, i;
+  chpl_bool maybe_deadlock;
+
+  if (sync_try_lock(s, &st, want_mask, want_bits))
+    return;
 
-  while (s->is_full != want_full) {
-    if (!suspend_using_cond) {
-      chpl_thread_mutexUnlock(&s->lock);
+  //
+  // Spin, backing off exponentially, for about as long as it has taken
+  // to get this variable lately.  If spinning doesn't work we spin less
+  // next time.  There's no point in it at all if we have more threads
+  // than cpus, since the holder may well not be running.
+  //
+  if (sync_spin_max > 0 && chpl_thread_getNumThreads() <= sync_num_cpus) {
+    spin_limit = 2 * s->spin + 10;
+    if (spin_limit > sync_spin_max)
+      spin_limit = sync_spin_max;
+    for (cnt = 0, backoff = 1; cnt < spin_limit; cnt++) {
+      for (i = 0; i < backoff; i++)
+        sync_cpu_relax();
+      if (backoff < SYNC_BACKOFF_MAX)
+        backoff *= 2;
+      st = sync_load(s);
+      if (sync_try_lock(s, &st, want_mask, want_bits))
+        break;
     }
-    if (set_block_loc(lineno, filename)) {
-      // all other tasks appear to be blocked
-      struct timeval deadline, now;
-      chpl_bool timed_out = false;
-      // default value so that always allows condition to be true if not
-      // using conditionals
+    if (cnt < spin_limit) {
+      s->spin += (cnt - s->spin) / 8;
+      return;
+    }
+    s->spin -= s->spin / 4;
+  }
 
-      gettimeofday(&deadline, NULL);
-      deadline.tv_sec += 1;
-      do {
-        if (suspend_using_cond)
-          timed_out = chpl_thread_sync_suspend(s, &deadline);
-        else
-          chpl_thread_yield();
-        
-        if (s->is_full != want_full && !timed_out)
-          gettimeofday(&now, NULL);
-      } while (s->is_full != want_full
-               && !timed_out
-               && (now.tv_sec < deadline.tv_sec
-                   || (now.tv_sec == deadline.tv_sec
-                       && now.tv_usec < deadline.tv_usec)));
-      if (s->is_full != want_full)
-        check_for_deadlock();
+  //
+  // Sleep.  We count ourselves as a sleeper first, so that whoever
+  // unlocks the variable knows to wake someone.
+  //
+  bitset = (want_mask == 0) ? SYNC_WAIT_LOCK
+           : (want_bits & SYNC_FULL) ? SYNC_WAIT_FULL : SYNC_WAIT_EMPTY;
+  maybe_deadlock = (want_mask != 0 && set_block_loc(lineno, filename));
+  st = __atomic_add_fetch(&s->state, SYNC_WAITER, __ATOMIC_RELAXED);
+  while (true) {
+    if ((st & (SYNC_LOCKED | want_mask)) == want_bits) {
+      if (__atomic_compare_exchange_n(&s->state, &st,
+                                      (st | SYNC_LOCKED) - SYNC_WAITER, 1,
+                                      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        break;
+      continue;
     }
-    else {
-      do {
-        if (suspend_using_cond)
-          (void) chpl_thread_sync_suspend(s, NULL);
-        else
-          chpl_thread_yield();
-      } while (s->is_full != want_full);
+    if (sync_sleep(s, st, bitset, maybe_deadlock)) {
+      // all other tasks appear to be blocked
+      check_for_deadlock();
+      unset_block_loc();
+      maybe_deadlock = set_block_loc(lineno, filename);
     }
+    st = sync_load(s);
+  }
+  if (want_mask != 0)
     unset_block_loc();
-    if (!suspend_using_cond)
-      chpl_thread_mutexLock(&s->lock);
+}
+
+//
+// Unlock the variable, leaving it full or empty as full_bit says, and
+// wake a sleeper who wants it that way, if there is one.  We hold the
+// lock, so no one else can change the full bit meanwhile.
+//
+static inline void sync_unlock_as(chpl_sync_aux_t *s, uint32_t full_bit) {
+  uint32_t st = sync_load(s);
+  uint32_t delta = full_bit - (st & SYNC_FULL) - SYNC_LOCKED;
+
+  st = __atomic_add_fetch(&s->state, delta, __ATOMIC_RELEASE);
+  if (st >= SYNC_WAITER)
+    sync_wake(s, SYNC_WAIT_LOCK
+                 | (full_bit ? SYNC_WAIT_FULL : SYNC_WAIT_EMPTY));
+}
+
+static void sync_wait_and_lock(chpl_sync_aux_t *s,
+                               chpl_bool want_full,
+                               int32_t lineno, c_string filename) {
+  uint32_t want_bits = want_full ? SYNC_FULL : 0;
+
+  //
+  // A lightweight task waits by switching out, leaving its thread free
+  // to run other tasks.
+  //
+  if (lightweight_tasks && get_current_ctx() != NULL) {
+    sync_lock_when(s, 0, 0, lineno, filename);
+    while ((sync_load(s) & SYNC_FULL) != want_bits)
+      lw_sync_suspend(s, want_full);
   }
+  else
+    sync_lock_when(s, SYNC_FULL, want_bits, lineno, filename);
 
   if (blockreport)
     progress_cnt++;
 }
 
 void chpl_sync_lock(chpl_sync_aux_t *s) {
-  chpl_thread_mutexLock(&s->lock);
+  sync_lock_when(s, 0, 0, 0, NULL);
 }
 
 void chpl_sync_unlock(chpl_sync_aux_t *s) {
-  chpl_thread_mutexUnlock(&s->lock);
+  sync_unlock_as(s, sync_load(s) & SYNC_FULL);
 }
 
 void chpl_sync_waitFullAndLock(chpl_sync_aux_t *s,
@@ -265,57 +549,27 @@ void chpl_sync_waitEmptyAndLock(chpl_sync_aux_t *s,
   sync_wait_and_lock(s, false, lineno, filename);
 }
 
-static chpl_bool chpl_thread_sync_suspend(chpl_sync_aux_t *s,
-                                   struct timeval *deadline) {
-  chpl_thread_condvar_t* cond;
-  cond = s->is_full ? &s->signal_empty : &s->signal_full;
-
-  if (deadline == NULL) {
-    (void) pthread_cond_wait(cond, (pthread_mutex_t*) &s->lock);
-    return false;
-  }
-  else {
-    struct timespec ts;
-    ts.tv_sec  = deadline->tv_sec;
-    ts.tv_nsec = deadline->tv_usec * 1000UL;
-    return (pthread_cond_timedwait(cond, (pthread_mutex_t*) &s->lock, &ts)
-            == ETIMEDOUT);
-  }
-}
-
-static void chpl_thread_sync_awaken(chpl_sync_aux_t *s) {
-  if (pthread_cond_signal(s->is_full ?
-                          &s->signal_full : &s->signal_empty))
-    chpl_internal_error("pthread_cond_signal() failed");
-}
-
 void chpl_sync_markAndSignalFull(chpl_sync_aux_t *s) {
-  s->is_full = true;
-  chpl_thread_sync_awaken(s);
-  chpl_sync_unlock(s);
+  if (s->waiters != NULL)
+    lw_sync_awaken(s, true);
+  sync_unlock_as(s, SYNC_FULL);
 }
 
 void chpl_sync_markAndSignalEmpty(chpl_sync_aux_t *s) {
-  s->is_full = false;
-  chpl_thread_sync_awaken(s);
-  chpl_sync_unlock(s);
+  if (s->waiters != NULL)
+    lw_sync_awaken(s, false);
+  sync_unlock_as(s, 0);
 }
 
 chpl_bool chpl_sync_isFull(void *val_ptr,
                             chpl_sync_aux_t *s) {
-  return s->is_full;
-}
-
-static void chpl_thread_condvar_init(chpl_thread_condvar_t* cv) {
-  if (pthread_cond_init((pthread_cond_t*) cv, NULL))
-    chpl_internal_error("pthread_cond_init() failed");
+  return (sync_load(s) & SYNC_FULL) != 0;
 }
 
 void chpl_sync_initAux(chpl_sync_aux_t *s) {
-  s->is_full = false;
-  chpl_thread_mutexInit(&s->lock);
-  chpl_thread_condvar_init(&s->signal_full);
-  chpl_thread_condvar_init(&s->signal_empty);
+  s->state = 0;
+  s->spin = 0;
+  s->waiters = NULL;
 }
 
 void chpl_sync_destroyAux(chpl_sync_aux_t *s) { }
@@ -323,6 +577,8 @@ void chpl_sync_destroyAux(chpl_sync_aux_t *s) { }
 // Tasks
 
 void chpl_task_init(void) {
+  char* p;
+
   chpl_thread_mutexInit(&threading_lock);
   chpl_thread_mutexInit(&extra_task_lock);
   chpl_thread_mutexInit(&task_id_lock);
@@ -335,8 +591,68 @@ void chpl_task_init(void) {
   extra_task_cnt = 0;
   task_pool_head = task_pool_tail = NULL;
 
+  //
+  // Work-stealing mode is selected at execution time.  Any value other
+  // than "0", "no" or "false" turns it on.
+  //
+  if ((p = getenv("CHPL_RT_WORK_STEALING")) != NULL)
+    work_stealing = (strcmp(p, "0") != 0
+                     && strcmp(p, "no") != 0
+                     && strcmp(p, "false") != 0);
+
+  //
+  // So is lightweight-task mode.  It works with either scheduler.  We
+  // only want one pool thread per core, since blocked tasks no longer
+  // tie up their threads.
+  //
+  if ((p = getenv("CHPL_RT_LIGHTWEIGHT_TASKS")) != NULL)
+    lightweight_tasks = (strcmp(p, "0") != 0
+                         && strcmp(p, "no") != 0
+                         && strcmp(p, "false") != 0);
+
+  if (work_stealing) {
+    atomic_init_int_least64_t(&ws_queued_task_cnt, 0);
+    atomic_init_int_least64_t(&ws_idle_thread_cnt, 0);
+    chpl_thread_mutexInit(&deque_registry_lock);
+    deque_registry = NULL;
+    deque_registry_cnt = 0;
+    deque_registry_size = 0;
+  }
+
   chpl_thread_init(thread_begin, thread_end);
 
+  //
+  // Under a locale model with sublocales, each NUMA domain is one.
+  //
+#ifdef CHPL_LOCALE_MODEL_NUM_SUBLOCALES
+  num_sublocales = CHPL_LOCALE_MODEL_NUM_SUBLOCALES;
+#else
+  num_sublocales = (c_sublocid_t) chpl_topo_getNumNumaDomains();
+#endif
+
+  //
+  // Spinning on a sync variable is pointless if the holder can't be
+  // running at the same time.
+  //
+  sync_num_cpus = (uint32_t) chpl_getNumLogicalCpus(true);
+  sync_spin_max = (sync_num_cpus > 1) ? SYNC_SPIN_MAX : 0;
+
+  if (lightweight_tasks) {
+    lw_max_threads = chpl_task_getMaxPar() + 1;
+    lw_page_size = (size_t) sysconf(_SC_PAGESIZE);
+    lw_stack_size = ((chpl_thread_getCallStackSize() + lw_page_size - 1)
+                     / lw_page_size) * lw_page_size;
+    chpl_thread_mutexInit(&lw_ready_lock);
+    lw_ready_head = lw_ready_tail = NULL;
+    atomic_init_int_least64_t(&lw_ready_cnt, 0);
+    chpl_thread_mutexInit(&lw_stack_lock);
+    lw_stack_cache = NULL;
+    lw_stack_cache_cnt = 0;
+    atomic_init_int_least64_t(&lw_guarded_cnt, 0);
+    lw_slab_next = NULL;
+    lw_slab_left = 0;
+  }
+
   //
   // Set main thread private data, so that things that require access
   // to it, like chpl_task_getID() and chpl_task_setSerial(), can be
@@ -364,11 +680,20 @@ void chpl_task_init(void) {
     tp->ptask->begun        = true;
     tp->ptask->filename     = "main program";
     tp->ptask->lineno       = 0;
+    tp->ptask->task_list    = NULL;
     tp->ptask->next         = NULL;
     tp->lockRprt            = NULL;
+    tp->deque               = NULL;
+    tp->steal_seed          = 0;
+    tp->sched_uc            = NULL;
+    tp->ctx                 = NULL;
+    tp->lw_requeue          = NULL;
+    tp->lw_unlock           = NULL;
+    tp->subloc              = c_sublocid_any;
 
     // Set up task-private data for locale (architectural) support.
     tp->ptask->chpl_data.prvdata.serial_state = true;     // Set to false in chpl_task_callMain().
+    tp->ptask->chpl_data.requestedSubloc = c_sublocid_any;
 
     chpl_thread_setPrivateData(tp);
   }
@@ -458,6 +783,7 @@ static void comm_task_wrapper(void* arg) {
   tp->ptask->fun          = comm_task_fn;
   tp->ptask->arg          = arg;
   tp->ptask->ltask        = NULL;
+  tp->ptask->task_list    = NULL;
   tp->ptask->begun        = true;
   tp->ptask->filename     = "communication task";
   tp->ptask->lineno       = 0;
@@ -467,8 +793,16 @@ static void comm_task_wrapper(void* arg) {
   // The comm (polling) task shouldn't really need this information.
   //
   tp->ptask->chpl_data.prvdata.serial_state = true;
+  tp->ptask->chpl_data.requestedSubloc = c_sublocid_any;
 
   tp->lockRprt = NULL;
+  tp->deque = NULL;
+  tp->steal_seed = 0;
+  tp->sched_uc = NULL;
+  tp->ctx = NULL;
+  tp->lw_requeue = NULL;
+  tp->lw_unlock = NULL;
+  tp->subloc = c_sublocid_any;
 
   chpl_thread_setPrivateData(tp);
 
@@ -484,9 +818,14 @@ void chpl_task_addToTaskList(chpl_fn_int_t fid, void* arg,
                              int lineno,
                              c_string filename) {
   chpl_task_prvDataImpl_t chpl_data = {
-    .prvdata = { .serial_state = chpl_task_getSerial() } };
+    .prvdata = { .serial_state = chpl_task_getSerial() },
+    .requestedSubloc = subloc };
 
-  assert(subloc == 0 || subloc == c_sublocid_any);
+  //
+  // A task that can run on any sublocale stays on its creator's.
+  //
+  if (subloc == c_sublocid_any)
+    chpl_data.requestedSubloc = chpl_task_getRequestedSubloc();
 
   if (task_list_locale == chpl_nodeID) {
     chpl_task_list_p ltask;
@@ -558,7 +897,24 @@ void chpl_task_processTaskList(chpl_task_list_p task_list) {
     chpl_task_list_p first_task = next_task;
     next_task = next_task->next;
 
-    if (first_task != task_list) {
+    if (first_task != task_list && work_stealing) {
+      // there are at least two tasks in task_list
+
+      //
+      // Push the tasks onto our own deque.  Once a task is pushed it
+      // may be stolen and run, so we don't touch it afterward.
+      //
+      do {
+        ltask = next_task;
+        next_task = ltask->next;
+        (void) add_to_task_pool(ltask->fun, ltask->arg,
+                                ltask->chpl_data, ltask, task_list);
+        task_cnt++;
+      } while (ltask != task_list);
+
+      ws_schedule_tasks(task_cnt);
+    }
+    else if (first_task != task_list) {
       // there are at least two tasks in task_list
 
       // begin critical section
@@ -567,7 +923,7 @@ void chpl_task_processTaskList(chpl_task_list_p task_list) {
       do {
         ltask = next_task;
         ltask->ptask = add_to_task_pool(ltask->fun, ltask->arg,
-                                        ltask->chpl_data, ltask);
+                                        ltask->chpl_data, ltask, task_list);
         assert(ltask->ptask == NULL
                || ltask->ptask->ltask == ltask);
         next_task = ltask->next;
@@ -650,99 +1006,110 @@ void chpl_task_executeTasksInList(chpl_task_list_p task_list) {
 
   // If the serial state is true, the tasks in task_list have already been
   // executed.
-  if (!chpl_task_getSerial()) do {
+  if (chpl_task_getSerial())
+    return;
+
+  if (work_stealing) {
+    //
+    // The tasks processTaskList() created for this list are at the
+    // bottom of our own deque, except for any that other threads have
+    // stolen.  Run the ones that are left.  Anything else we find there
+    // goes back where it was and is left for the idle threads.
+    //
+    task_deque_t* deque = get_current_deque();
+    task_pool_p   nested_ptask;
+
+    while ((nested_ptask = task_deque_pop(deque)) != NULL) {
+      if (nested_ptask->task_list != task_list) {
+        task_deque_push(deque, nested_ptask);
+        break;
+      }
+      (void) atomic_fetch_sub_int_least64_t(&ws_queued_task_cnt, 1);
+      if (nested_ptask->ltask) {
+        nested_ptask->ltask->ptask = NULL;
+        nested_ptask->ltask = NULL;
+      }
+      nested_ptask->begun = true;
+      execute_nested_task(nested_ptask);
+    }
+    return;
+  }
+
+  do {
     ltask = next_task;
     next_task = ltask->next;
 
     // don't lock unless it looks like we will find a task to execute
     // if we do so
     if (ltask->ptask) {
-      task_pool_p  curr_ptask;
       task_pool_p  nested_ptask = NULL;
-      chpl_fn_p    task_to_run_fun = NULL;
-      void*        task_to_run_arg = NULL;
 
       // begin critical section
       chpl_thread_mutexLock(&threading_lock);
 
       if (ltask->ptask) {
         assert(!ltask->ptask->begun);
-        task_to_run_fun = ltask->ptask->fun;
-        task_to_run_arg = ltask->ptask->arg;
-        ltask->ptask->begun = true;
-        ltask->ptask->ltask = NULL;
-        // there is no longer any need to access the corresponding task
-        // pool entry so avoid any potential of accessing a node that
-        // will eventually be freed
-        nested_ptask = ltask->ptask;
-        ltask->ptask = NULL;
-        if (waking_thread_cnt > 0)
-          waking_thread_cnt--;
-        assert(queued_task_cnt > 0);
-        queued_task_cnt--;
-        if (nested_ptask->prev == NULL) {
-          if ((task_pool_head = nested_ptask->next) == NULL)
-            task_pool_tail = NULL;
-          else
-            task_pool_head->prev = NULL;
-        }
-        else {
-          nested_ptask->prev->next = nested_ptask->next;
-          if (nested_ptask->next == NULL)
-            task_pool_tail = nested_ptask->prev;
-          else
-            nested_ptask->next->prev = nested_ptask->prev;
-        }
+        nested_ptask = take_task_from_pool(ltask->ptask);
       }
 
       // end critical section
       chpl_thread_mutexUnlock(&threading_lock);
 
-      if (task_to_run_fun) {
-        curr_ptask = get_current_ptask();
-        set_current_ptask(nested_ptask);
+      if (nested_ptask)
+        execute_nested_task(nested_ptask);
+    }
 
-        // begin critical section
-        chpl_thread_mutexLock(&extra_task_lock);
+  } while (ltask != task_list);
+}
 
-        extra_task_cnt++;
 
-        // end critical section
-        chpl_thread_mutexUnlock(&extra_task_lock);
+//
+// Run a task from a task list on the current thread, nested inside
+// the task that created the list, and then free its descriptor.
+//
+static void execute_nested_task(task_pool_p nested_ptask) {
+  task_pool_p curr_ptask;
 
-        if (do_taskReport) {
-          chpl_thread_mutexLock(&taskTable_lock);
-          chpldev_taskTable_set_suspended(curr_ptask->id);
-          chpldev_taskTable_set_active(nested_ptask->id);
-          chpl_thread_mutexUnlock(&taskTable_lock);
-        }
+  curr_ptask = get_current_ptask();
+  set_current_ptask(nested_ptask);
 
-        if (blockreport)
-          initializeLockReportForThread();
+  // begin critical section
+  chpl_thread_mutexLock(&extra_task_lock);
 
-        (*task_to_run_fun)(task_to_run_arg);
+  extra_task_cnt++;
 
-        if (do_taskReport) {
-          chpl_thread_mutexLock(&taskTable_lock);
-          chpldev_taskTable_set_active(curr_ptask->id);
-          chpldev_taskTable_remove(nested_ptask->id);
-          chpl_thread_mutexUnlock(&taskTable_lock);
-        }
+  // end critical section
+  chpl_thread_mutexUnlock(&extra_task_lock);
 
-        // begin critical section
-        chpl_thread_mutexLock(&extra_task_lock);
+  if (do_taskReport) {
+    chpl_thread_mutexLock(&taskTable_lock);
+    chpldev_taskTable_set_suspended(curr_ptask->id);
+    chpldev_taskTable_set_active(nested_ptask->id);
+    chpl_thread_mutexUnlock(&taskTable_lock);
+  }
 
-        extra_task_cnt--;
+  if (blockreport)
+    initializeLockReportForThread();
 
-        // end critical section
-        chpl_thread_mutexUnlock(&extra_task_lock);
+  (*nested_ptask->fun)(nested_ptask->arg);
 
-        set_current_ptask(curr_ptask);
-        chpl_mem_free(nested_ptask, 0, 0);
-      }
-    }
+  if (do_taskReport) {
+    chpl_thread_mutexLock(&taskTable_lock);
+    chpldev_taskTable_set_active(curr_ptask->id);
+    chpldev_taskTable_remove(nested_ptask->id);
+    chpl_thread_mutexUnlock(&taskTable_lock);
+  }
 
-  } while (ltask != task_list);
+  // begin critical section
+  chpl_thread_mutexLock(&extra_task_lock);
+
+  extra_task_cnt--;
+
+  // end critical section
+  chpl_thread_mutexUnlock(&extra_task_lock);
+
+  set_current_ptask(curr_ptask);
+  chpl_mem_free(nested_ptask, 0, 0);
 }
 
 
@@ -773,9 +1140,9 @@ void chpl_task_startMovedTask(chpl_fn_p fp,
                               chpl_bool serial_state) {
   movedTaskWrapperDesc_t* pmtwd;
   chpl_task_prvDataImpl_t private = {
-    .prvdata = { .serial_state = serial_state } };
+    .prvdata = { .serial_state = serial_state },
+    .requestedSubloc = subloc };
 
-  assert(subloc == 0 || subloc == c_sublocid_any);
   assert(id == chpl_nullTaskID);
 
   pmtwd = (movedTaskWrapperDesc_t*)
@@ -786,10 +1153,18 @@ void chpl_task_startMovedTask(chpl_fn_p fp,
            { fp, a, canCountRunningTasks,
              private };
 
+  if (work_stealing) {
+    (void) add_to_task_pool(movedTaskWrapper, pmtwd, pmtwd->chpl_data,
+                            NULL, NULL);
+    ws_schedule_tasks(1);
+    return;
+  }
+
   // begin critical section
   chpl_thread_mutexLock(&threading_lock);
 
-  (void) add_to_task_pool(movedTaskWrapper, pmtwd, pmtwd->chpl_data, NULL);
+  (void) add_to_task_pool(movedTaskWrapper, pmtwd, pmtwd->chpl_data,
+                          NULL, NULL);
   schedule_next_task(1);
 
   // end critical section
@@ -808,19 +1183,56 @@ static void movedTaskWrapper(void* a) {
 }
 
 
-//
-// chpl_task_getSubloc() is in tasks-fifo.h.
-//
+#ifndef CHPL_TASK_GETSUBLOC_IMPL_DECL
+c_sublocid_t chpl_task_getSubloc(void) {
+  thread_private_data_t* tp =
+    (thread_private_data_t*) chpl_thread_getPrivateData();
+
+  if (tp == NULL || tp->subloc == c_sublocid_any)
+    return 0;
+  return tp->subloc;
+}
+#endif
 
 
+#ifndef CHPL_TASK_SETSUBLOC_IMPL_DECL
 //
-// chpl_task_setSubloc() is in tasks-fifo.h.
+// Moving a task to a sublocale moves its thread to the cpus of that
+// sublocale's NUMA domain.  Moving it to "any" sublocale lets the
+// thread run on all of our cpus again.
 //
+void chpl_task_setSubloc(c_sublocid_t subloc) {
+  thread_private_data_t* tp =
+    (thread_private_data_t*) chpl_thread_getPrivateData();
+
+  if (subloc != c_sublocid_any
+      && (subloc < 0 || subloc >= num_sublocales))
+    chpl_internal_error("chpl_task_setSubloc(): no such sublocale");
+
+  // Code run directly by the comm layer's threads has nowhere to go.
+  if (tp == NULL || tp->ptask == NULL)
+    return;
+
+  tp->ptask->chpl_data.requestedSubloc = subloc;
+  move_thread_to_subloc(tp, subloc);
+}
+#endif
 
 
+#ifndef CHPL_TASK_GETREQUESTEDSUBLOC_IMPL_DECL
 //
-// chpl_task_getRequestedSubloc() is in tasks-fifo.h.
+// This can be called from memory allocation, so it mustn't assume
+// that the calling thread is running a task.
 //
+c_sublocid_t chpl_task_getRequestedSubloc(void) {
+  thread_private_data_t* tp =
+    (thread_private_data_t*) chpl_thread_getPrivateData();
+
+  if (tp == NULL || tp->ptask == NULL)
+    return c_sublocid_any;
+  return tp->ptask->chpl_data.requestedSubloc;
+}
+#endif
 
 
 chpl_taskID_t chpl_task_getId(void) {
@@ -829,12 +1241,45 @@ chpl_taskID_t chpl_task_getId(void) {
 
 
 void chpl_task_yield(void) {
-  chpl_thread_yield();
+  task_ctx_t* ctx;
+
+  //
+  // A lightweight task yields by going to the back of the ready list,
+  // but there's no point in that unless something else could run.
+  //
+  if (lightweight_tasks
+      && (ctx = get_current_ctx()) != NULL
+      && lw_work_available()) {
+    get_thread_private_data()->lw_requeue = ctx;
+    lw_switch_out();
+  }
+  else
+    chpl_thread_yield();
 }
 
 
 void chpl_task_sleep(int secs) {
-  sleep(secs);
+  //
+  // A lightweight task mustn't keep its thread while it sleeps, since
+  // the tasks it is waiting for may need that thread to run.
+  //
+  if (lightweight_tasks && get_current_ctx() != NULL) {
+    struct timeval deadline, now;
+
+    gettimeofday(&deadline, NULL);
+    deadline.tv_sec += secs;
+    do {
+      if (lw_work_available())
+        chpl_task_yield();
+      else
+        usleep(1000);
+      gettimeofday(&now, NULL);
+    } while (now.tv_sec < deadline.tv_sec
+             || (now.tv_sec == deadline.tv_sec
+                 && now.tv_usec < deadline.tv_usec));
+  }
+  else
+    sleep(secs);
 }
 
 chpl_bool chpl_task_getSerial(void) {
@@ -864,11 +1309,7 @@ uint32_t chpl_task_getMaxPar(void) {
 }
 
 c_sublocid_t chpl_task_getNumSublocales(void) {
-#ifdef CHPL_LOCALE_MODEL_NUM_SUBLOCALES
-  return CHPL_LOCALE_MODEL_NUM_SUBLOCALES;
-#else
-  return 0;
-#endif
+  return num_sublocales;
 }
 
 chpl_task_prvData_t* chpl_task_getPrvData(void) {
@@ -879,7 +1320,11 @@ size_t chpl_task_getCallStackSize(void) {
   return chpl_thread_getCallStackSize();
 }
 
-uint32_t chpl_task_getNumQueuedTasks(void) { return queued_task_cnt; }
+uint32_t chpl_task_getNumQueuedTasks(void) {
+  if (work_stealing)
+    return (uint32_t) atomic_load_int_least64_t(&ws_queued_task_cnt);
+  return queued_task_cnt;
+}
 
 uint32_t chpl_task_getNumRunningTasks(void) {
   chpl_internal_error("chpl_task_getNumRunningTasks() called");
@@ -890,6 +1335,19 @@ int32_t  chpl_task_getNumBlockedTasks(void) {
   if (blockreport) {
     int numBlockedTasks;
 
+    if (work_stealing) {
+      //
+      // Newly created threads count as idle before they get around to
+      // saying they are waiting for work, so this can briefly dip
+      // below zero.
+      //
+      chpl_thread_mutexLock(&block_report_lock);
+      numBlockedTasks = blocked_thread_cnt
+                        - (int) atomic_load_int_least64_t(&ws_idle_thread_cnt);
+      chpl_thread_mutexUnlock(&block_report_lock);
+      return (numBlockedTasks < 0) ? 0 : numBlockedTasks;
+    }
+
     // begin critical section
     chpl_thread_mutexLock(&threading_lock);
     chpl_thread_mutexLock(&block_report_lock);
@@ -929,6 +1387,13 @@ static chpl_taskID_t get_next_task_id(void) {
 //
 // Get the the thread private data pointer for my thread.
 //
+// A lightweight task can switch out on one thread and be resumed on
+// another, so this is kept out of line.  Inlined, the compiler could
+// reuse a thread-local address it computed before the switch.
+//
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
 static thread_private_data_t* get_thread_private_data(void) {
   thread_private_data_t* tp;
 
@@ -953,7 +1418,34 @@ static task_pool_p get_current_ptask(void) {
 // Set the descriptor for the task now running on my thread.
 //
 static void set_current_ptask(task_pool_p ptask) {
-  get_thread_private_data()->ptask = ptask;
+  set_thread_ptask(get_thread_private_data(), ptask);
+}
+
+
+//
+// Make ptask the task running on thread tp, and move the thread to the
+// sublocale that task wants.  A task that can run anywhere lets the
+// thread run on all of our cpus again, rather than staying on those of
+// whatever sublocale the thread's last task wanted.
+//
+static void set_thread_ptask(thread_private_data_t* tp, task_pool_p ptask) {
+  tp->ptask = ptask;
+  if (ptask != NULL)
+    move_thread_to_subloc(tp, ptask->chpl_data.requestedSubloc);
+}
+
+
+//
+// Restrict thread tp to the cpus of a sublocale (or none in particular,
+// for c_sublocid_any).  This costs a system call, so we remember where
+// each thread is and only do it when that changes.
+//
+static void move_thread_to_subloc(thread_private_data_t* tp,
+                                  c_sublocid_t subloc) {
+  if (num_sublocales > 1 && subloc != tp->subloc) {
+    chpl_topo_setThreadLocality(subloc);
+    tp->subloc = subloc;
+  }
 }
 
 
@@ -994,6 +1486,22 @@ static void report_all_tasks(void) {
 
     // print out pending tasks
     printf("Pending tasks:\n");
+    if (work_stealing) {
+        int i;
+        for (i = 0; i < deque_registry_cnt; i++) {
+            task_deque_t* deque = deque_registry[i];
+            task_deque_array_t* a = (task_deque_array_t*)
+                atomic_load_uintptr_t(&deque->array);
+            int64_t t = atomic_load_int_least64_t(&deque->top);
+            int64_t b = atomic_load_int_least64_t(&deque->bottom);
+            for (; t < b; t++) {
+                pendingTask = a->elems[t & (a->size - 1)];
+                printf("- %s:%d\n", pendingTask->filename,
+                       (int)pendingTask->lineno);
+            }
+        }
+        pendingTask = NULL;
+    }
     while(pendingTask != NULL) {
         if(! pendingTask->begun) {
             printf("- %s:%d\n", pendingTask->filename,
@@ -1158,13 +1666,31 @@ thread_begin(void* ptask_void) {
   tp = (thread_private_data_t*) chpl_mem_alloc(sizeof(thread_private_data_t),
                                                CHPL_RT_MD_THREAD_PRIVATE_DATA,
                                                0, 0);
-  tp->ptask    = ptask;
+  tp->ptask    = NULL;
   tp->lockRprt = NULL;
+  tp->deque    = NULL;
+  tp->steal_seed = chpl_thread_getNumThreads();
+  tp->sched_uc = NULL;
+  tp->ctx      = NULL;
+  tp->lw_requeue = NULL;
+  tp->lw_unlock  = NULL;
+  tp->subloc     = c_sublocid_any;
   chpl_thread_setPrivateData(tp);
+  set_thread_ptask(tp, ptask);
 
   if (blockreport)
     initializeLockReportForThread();
 
+  if (lightweight_tasks) {
+    lw_thread_loop(tp, ptask);
+    return;
+  }
+
+  if (work_stealing) {
+    ws_thread_loop(tp);
+    return;
+  }
+
   while (true) {
     if (do_taskReport) {
       chpl_thread_mutexLock(&taskTable_lock);
@@ -1254,48 +1780,91 @@ thread_begin(void* ptask_void) {
 
     assert(task_pool_head && !task_pool_head->begun);
 
-    if (waking_thread_cnt > 0)
-      waking_thread_cnt--;
-
     //
     // start new task; increment running count and remove task from pool
     // also add to task to task-table (structure in ChapelRuntime that keeps
     // track of currently running tasks for task-reports on deadlock or
     // Ctrl+C).
     //
-    assert(queued_task_cnt > 0);
-    queued_task_cnt--;
     idle_thread_cnt--;
     running_task_cnt++;
-    ptask = task_pool_head;
-    if (ptask->ltask) {
-      ptask->ltask->ptask = NULL;
-      // there is no longer any need to access the corresponding task
-      // list entry so avoid any potential of accessing a node that
-      // will eventually be freed
-      ptask->ltask = NULL;
-    }
-    tp->ptask = ptask;
-    ptask->begun = true;
-    task_pool_head = task_pool_head->next;
-    if (task_pool_head == NULL)  // task pool is now empty
-      task_pool_tail = NULL;
-    else {
-      task_pool_head->prev = NULL;
-    }
+    ptask = take_task_from_pool(pick_task_for_thread(tp));
 
     // end critical section
     chpl_thread_mutexUnlock(&threading_lock);
+
+    set_thread_ptask(tp, ptask);
   }
 }
 
 
 //
-// When a thread is destroyed it calls this ending function.
+// Choose a task from the (non-empty) task pool for thread tp to run
+// next.  A thread that has been moved to a sublocale prefers the oldest
+// of the first few tasks that want that same sublocale, so that threads
+// tend to stay put; otherwise we take the head of the pool.
+// assumes threading_lock has already been acquired!
 //
-static void thread_end(void)
-{
-  thread_private_data_t* tp;
+static task_pool_p pick_task_for_thread(thread_private_data_t* tp) {
+  task_pool_p ptask;
+  int         i;
+
+  if (num_sublocales > 1 && tp->subloc != c_sublocid_any) {
+    for (ptask = task_pool_head, i = 0;
+         ptask != NULL && i < SUBLOC_SCAN_MAX;
+         ptask = ptask->next, i++) {
+      if (ptask->chpl_data.requestedSubloc == tp->subloc)
+        return ptask;
+    }
+  }
+
+  return task_pool_head;
+}
+
+
+//
+// Take a task out of the task pool, to begin running it.
+// assumes threading_lock has already been acquired!
+//
+static task_pool_p take_task_from_pool(task_pool_p ptask) {
+  if (waking_thread_cnt > 0)
+    waking_thread_cnt--;
+
+  assert(queued_task_cnt > 0);
+  queued_task_cnt--;
+  if (ptask->ltask) {
+    ptask->ltask->ptask = NULL;
+    // there is no longer any need to access the corresponding task
+    // list entry so avoid any potential of accessing a node that
+    // will eventually be freed
+    ptask->ltask = NULL;
+  }
+  ptask->begun = true;
+
+  if (ptask->prev == NULL) {
+    if ((task_pool_head = ptask->next) == NULL)  // task pool is now empty
+      task_pool_tail = NULL;
+    else
+      task_pool_head->prev = NULL;
+  }
+  else {
+    ptask->prev->next = ptask->next;
+    if (ptask->next == NULL)
+      task_pool_tail = ptask->prev;
+    else
+      ptask->next->prev = ptask->prev;
+  }
+
+  return ptask;
+}
+
+
+//
+// When a thread is destroyed it calls this ending function.
+//
+static void thread_end(void)
+{
+  thread_private_data_t* tp;
 
   tp = (thread_private_data_t*) chpl_thread_getPrivateData();
   if (tp != NULL) {
@@ -1319,28 +1888,18 @@ void begin_task(chpl_fn_p fp, void* a, chpl_task_prvDataImpl_t chpl_data,
                 chpl_task_list_p ltask) {
   if (chpl_data.prvdata.serial_state)
     (*fp)(a);
+  else if (work_stealing) {
+    (void) add_to_task_pool(fp, a, chpl_data, ltask, NULL);
+    ws_schedule_tasks(1);
+  }
   else {
-    task_pool_p ptask = NULL;
-
     // begin critical section
     chpl_thread_mutexLock(&threading_lock);
 
-    ptask = add_to_task_pool(fp, a, chpl_data, ltask);
-
-    //
-    // This task may begin executing before returning from this function,
-    // so the task list node needs to be updated before there is any
-    // possibility of launching this task (inside the critical section).
-    //
-    if (ltask)
-      ltask->ptask = ptask;
+    (void) add_to_task_pool(fp, a, chpl_data, ltask, NULL);
 
     schedule_next_task(1);
 
-    assert(ptask->ltask == NULL
-           || (ptask->ltask == ltask
-               && ltask->ptask == ptask));
-
     // end critical section
     chpl_thread_mutexUnlock(&threading_lock);
   }
@@ -1355,28 +1914,13 @@ void begin_task(chpl_fn_p fp, void* a, chpl_task_prvDataImpl_t chpl_data,
 static void
 launch_next_task_in_new_thread(void) {
   task_pool_p       ptask;
-  static chpl_bool  warning_issued = false;
 
-  if (warning_issued)  // If thread creation failed previously, don't try again
+  if (thread_create_failed)  // If thread creation failed previously, don't try again
     return;
 
   if ((ptask = task_pool_head)) {
     if (chpl_thread_create(ptask)) {
-      int32_t max_threads = chpl_thread_getMaxThreads();
-      uint32_t num_threads = chpl_thread_getNumThreads();
-      char msg[256];
-      if (max_threads)
-        sprintf(msg,
-                "max threads per locale is %" PRId32
-                ", but unable to create more than %d threads",
-                max_threads, num_threads);
-      else
-        sprintf(msg,
-                "max threads per locale is unbounded"
-                ", but unable to create more than %d threads",
-                num_threads);
-      chpl_warning(msg, 0, 0);
-      warning_issued = true;
+      warn_thread_create_failed();
     } else {
       assert(queued_task_cnt > 0);
       queued_task_cnt--;
@@ -1399,6 +1943,28 @@ launch_next_task_in_new_thread(void) {
 }
 
 
+//
+// Warn (once) that we could not create a thread we wanted.
+//
+static void warn_thread_create_failed(void) {
+  int32_t max_threads = chpl_thread_getMaxThreads();
+  uint32_t num_threads = chpl_thread_getNumThreads();
+  char msg[256];
+  if (max_threads)
+    sprintf(msg,
+            "max threads per locale is %" PRId32
+            ", but unable to create more than %d threads",
+            max_threads, num_threads);
+  else
+    sprintf(msg,
+            "max threads per locale is unbounded"
+            ", but unable to create more than %d threads",
+            num_threads);
+  chpl_warning(msg, 0, 0);
+  thread_create_failed = true;
+}
+
+
 // Schedule one or more tasks either by signaling an existing thread or by
 // launching new threads if available
 static void schedule_next_task(int howMany) {
@@ -1419,18 +1985,20 @@ static void schedule_next_task(int howMany) {
     }
   }
 
-  for (; howMany && chpl_thread_canCreate(); howMany--)
+  for (; howMany && can_create_thread(); howMany--)
     launch_next_task_in_new_thread();
 }
 
 
 // create a task from the given function pointer and arguments
-// and append it to the end of the task pool
-// assumes threading_lock has already been acquired!
+// and append it to the end of the task pool, or in work-stealing mode
+// push it onto the current thread's deque
+// assumes threading_lock has already been acquired, if not work stealing!
 static task_pool_p add_to_task_pool(chpl_fn_p fp,
                                     void* a,
                                     chpl_task_prvDataImpl_t chpl_data,
-                                    chpl_task_list_p ltask) {
+                                    chpl_task_list_p ltask,
+                                    chpl_task_list_p task_list) {
   task_pool_p ptask =
     (task_pool_p) chpl_mem_alloc(sizeof(task_pool_t),
                                         CHPL_RT_MD_TASK_POOL_DESCRIPTOR,
@@ -1439,6 +2007,7 @@ static task_pool_p add_to_task_pool(chpl_fn_p fp,
   ptask->fun          = fp;
   ptask->arg          = a;
   ptask->ltask        = ltask;
+  ptask->task_list    = task_list;
   ptask->begun        = false;
   ptask->chpl_data    = chpl_data;
 
@@ -1451,6 +2020,33 @@ static task_pool_p add_to_task_pool(chpl_fn_p fp,
   }
 
   ptask->next = NULL;
+  ptask->prev = NULL;
+
+  if (do_taskReport) {
+    chpl_thread_mutexLock(&taskTable_lock);
+    chpldev_taskTable_add(ptask->id,
+                          ptask->lineno, ptask->filename,
+                          (uint64_t) (intptr_t) ptask);
+    chpl_thread_mutexUnlock(&taskTable_lock);
+  }
+
+  //
+  // This task may begin executing before returning from this function,
+  // so the task list node needs to be updated before there is any
+  // possibility of launching this task.
+  //
+  if (ltask)
+    ltask->ptask = ptask;
+
+  if (work_stealing) {
+    //
+    // Count the task before pushing it, so that a thread which pops
+    // or steals it right away never sees the count go negative.
+    //
+    (void) atomic_fetch_add_int_least64_t(&ws_queued_task_cnt, 1);
+    task_deque_push(get_current_deque(), ptask);
+    return ptask;
+  }
 
   if (task_pool_tail)
     task_pool_tail->next = ptask;
@@ -1461,15 +2057,829 @@ static task_pool_p add_to_task_pool(chpl_fn_p fp,
 
   queued_task_cnt++;
 
+  return ptask;
+}
+
+
+// Work-stealing scheduling
+
+//
+// Make sure enough threads are looking for the tasks just pushed onto
+// the deques.  Idle threads find new work on their own, so we only
+// create threads while there are fewer idle threads than queued tasks.
+// In steady state that is rare, so thread creation is serialized using
+// the threading lock but the common path takes no lock at all.
+//
+static void ws_schedule_tasks(int howMany) {
+  for (; howMany > 0; howMany--) {
+    if (thread_create_failed
+        || !can_create_thread()
+        || (atomic_load_int_least64_t(&ws_idle_thread_cnt)
+            >= atomic_load_int_least64_t(&ws_queued_task_cnt)))
+      return;
+
+    // begin critical section
+    chpl_thread_mutexLock(&threading_lock);
+
+    if (can_create_thread() && !thread_create_failed) {
+      //
+      // The new thread counts as idle from now on, so that subsequent
+      // calls don't create more threads than there are tasks.
+      //
+      (void) atomic_fetch_add_int_least64_t(&ws_idle_thread_cnt, 1);
+      if (chpl_thread_create(NULL)) {
+        (void) atomic_fetch_sub_int_least64_t(&ws_idle_thread_cnt, 1);
+        warn_thread_create_failed();
+      }
+    }
+
+    // end critical section
+    chpl_thread_mutexUnlock(&threading_lock);
+  }
+}
+
+
+//
+// This is the work-stealing counterpart of the task loop in
+// thread_begin(): find a task, run it, repeat.
+//
+static void ws_thread_loop(thread_private_data_t* tp) {
+  task_pool_p ptask;
+
+  while (true) {
+    //
+    // wait for a task to show up in our own deque or in one we can
+    // steal from
+    //
+    while ((ptask = ws_find_task(tp)) == NULL) {
+      if (set_block_loc(0, idleTaskName)) {
+        // all other tasks appear to be blocked
+        struct timeval deadline, now;
+        gettimeofday(&deadline, NULL);
+        deadline.tv_sec += 1;
+        do {
+          chpl_thread_yield();
+          if (atomic_load_int_least64_t(&ws_queued_task_cnt) == 0)
+            gettimeofday(&now, NULL);
+        } while (atomic_load_int_least64_t(&ws_queued_task_cnt) == 0
+                 && (now.tv_sec < deadline.tv_sec
+                     || (now.tv_sec == deadline.tv_sec
+                         && now.tv_usec < deadline.tv_usec)));
+        if (atomic_load_int_least64_t(&ws_queued_task_cnt) == 0) {
+          check_for_deadlock();
+        }
+      }
+      else {
+        do {
+          chpl_thread_yield();
+        } while (atomic_load_int_least64_t(&ws_queued_task_cnt) == 0);
+      }
+
+      unset_block_loc();
+    }
+
+    if (blockreport)
+      progress_cnt++;
+
+    (void) atomic_fetch_sub_int_least64_t(&ws_idle_thread_cnt, 1);
+    set_thread_ptask(tp, ptask);
+
+    if (do_taskReport) {
+      chpl_thread_mutexLock(&taskTable_lock);
+      chpldev_taskTable_set_active(ptask->id);
+      chpl_thread_mutexUnlock(&taskTable_lock);
+    }
+
+    (*ptask->fun)(ptask->arg);
+
+    if (do_taskReport) {
+      chpl_thread_mutexLock(&taskTable_lock);
+      chpldev_taskTable_remove(ptask->id);
+      chpl_thread_mutexUnlock(&taskTable_lock);
+    }
+
+    tp->ptask = NULL;
+    chpl_mem_free(ptask, 0, 0);
+    (void) atomic_fetch_add_int_least64_t(&ws_idle_thread_cnt, 1);
+  }
+}
+
+
+//
+// Get a task to run: the newest one in our own deque if there is one,
+// otherwise the oldest one in some other thread's deque.  Victims are
+// tried in turn, starting one further along each time so that thieves
+// spread out.  Returns NULL if nothing was found.
+//
+static task_pool_p ws_find_task(thread_private_data_t* tp) {
+  task_pool_p ptask = NULL;
+
+  if (tp->deque != NULL)
+    ptask = task_deque_pop(tp->deque);
+
+  if (ptask == NULL
+      && atomic_load_int_least64_t(&ws_queued_task_cnt) > 0) {
+    int            num_deques = deque_registry_cnt;
+    task_deque_t** deques;
+    int            i;
+
+    atomic_thread_fence(memory_order_acquire);
+    deques = deque_registry;
+    for (i = 0; i < num_deques && ptask == NULL; i++) {
+      task_deque_t* victim = deques[(tp->steal_seed + i) % num_deques];
+      if (victim != tp->deque)
+        ptask = task_deque_steal(victim);
+    }
+    tp->steal_seed++;
+  }
+
+  if (ptask != NULL) {
+    (void) atomic_fetch_sub_int_least64_t(&ws_queued_task_cnt, 1);
+    if (ptask->ltask) {
+      ptask->ltask->ptask = NULL;
+      // there is no longer any need to access the corresponding task
+      // list entry so avoid any potential of accessing a node that
+      // will eventually be freed
+      ptask->ltask = NULL;
+    }
+    ptask->begun = true;
+  }
+
+  return ptask;
+}
+
+
+//
+// Get the deque for my thread, creating it on first use.
+//
+static task_deque_t* get_current_deque(void) {
+  thread_private_data_t* tp = get_thread_private_data();
+
+  if (tp->deque == NULL)
+    tp->deque = task_deque_create();
+  return tp->deque;
+}
+
+
+//
+// Create a deque and add it to the registry thieves search.  The
+// registry grows by doubling.  Thieves may still be scanning an old
+// registry array after it is replaced, so those are never freed.
+//
+static task_deque_t* task_deque_create(void) {
+  task_deque_t*       deque;
+  task_deque_array_t* a;
+
+  a = (task_deque_array_t*)
+      chpl_mem_alloc(sizeof(task_deque_array_t)
+                     + TASK_DEQUE_INITIAL_SIZE * sizeof(task_pool_p),
+                     CHPL_RT_MD_TASK_DEQUE, 0, 0);
+  a->size    = TASK_DEQUE_INITIAL_SIZE;
+  a->retired = NULL;
+
+  deque = (task_deque_t*) chpl_mem_alloc(sizeof(task_deque_t),
+                                         CHPL_RT_MD_TASK_DEQUE, 0, 0);
+  atomic_init_int_least64_t(&deque->top, 0);
+  atomic_init_int_least64_t(&deque->bottom, 0);
+  atomic_init_uintptr_t(&deque->array, (uintptr_t) a);
+
+  // begin critical section
+  chpl_thread_mutexLock(&deque_registry_lock);
+
+  if (deque_registry_cnt == deque_registry_size) {
+    int            new_size = (deque_registry_size == 0)
+                              ? 16 : 2 * deque_registry_size;
+    task_deque_t** new_registry;
+
+    new_registry = (task_deque_t**)
+                   chpl_mem_allocMany(new_size, sizeof(task_deque_t*),
+                                      CHPL_RT_MD_TASK_DEQUE, 0, 0);
+    if (deque_registry_cnt > 0)
+      memcpy(new_registry, deque_registry,
+             deque_registry_cnt * sizeof(task_deque_t*));
+    deque_registry = new_registry;
+    deque_registry_size = new_size;
+  }
+
+  deque_registry[deque_registry_cnt] = deque;
+  atomic_thread_fence(memory_order_release);
+  deque_registry_cnt++;
+
+  // end critical section
+  chpl_thread_mutexUnlock(&deque_registry_lock);
+
+  return deque;
+}
+
+
+//
+// Double the size of a full deque array.  Only the owner calls this.
+//
+static task_deque_array_t* task_deque_grow(task_deque_t* deque,
+                                           task_deque_array_t* a,
+                                           int64_t top, int64_t bottom) {
+  task_deque_array_t* new_a;
+  int64_t             i;
+
+  new_a = (task_deque_array_t*)
+          chpl_mem_alloc(sizeof(task_deque_array_t)
+                         + 2 * a->size * sizeof(task_pool_p),
+                         CHPL_RT_MD_TASK_DEQUE, 0, 0);
+  new_a->size    = 2 * a->size;
+  new_a->retired = a;
+  for (i = top; i < bottom; i++)
+    new_a->elems[i & (new_a->size - 1)] = a->elems[i & (a->size - 1)];
+
+  atomic_store_uintptr_t(&deque->array, (uintptr_t) new_a);
+  return new_a;
+}
+
+
+//
+// Push a task onto the bottom of a deque.  Only the owner calls this.
+//
+static void task_deque_push(task_deque_t* deque, task_pool_p ptask) {
+  int64_t             b, t;
+  task_deque_array_t* a;
+
+  b = atomic_load_explicit_int_least64_t(&deque->bottom,
+                                         memory_order_relaxed);
+  t = atomic_load_explicit_int_least64_t(&deque->top, memory_order_acquire);
+  a = (task_deque_array_t*)
+      atomic_load_explicit_uintptr_t(&deque->array, memory_order_relaxed);
+  if (b - t > a->size - 1)
+    a = task_deque_grow(deque, a, t, b);
+  a->elems[b & (a->size - 1)] = ptask;
+  atomic_thread_fence(memory_order_release);
+  atomic_store_explicit_int_least64_t(&deque->bottom, b + 1,
+                                      memory_order_relaxed);
+}
+
+
+//
+// Pop the newest task from the bottom of a deque, or return NULL if it
+// is empty or a thief took the last task first.  Only the owner calls
+// this.
+//
+static task_pool_p task_deque_pop(task_deque_t* deque) {
+  int64_t             b, t;
+  task_deque_array_t* a;
+  task_pool_p         ptask = NULL;
+
+  b = atomic_load_explicit_int_least64_t(&deque->bottom,
+                                         memory_order_relaxed) - 1;
+  a = (task_deque_array_t*)
+      atomic_load_explicit_uintptr_t(&deque->array, memory_order_relaxed);
+  atomic_store_explicit_int_least64_t(&deque->bottom, b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  t = atomic_load_explicit_int_least64_t(&deque->top, memory_order_relaxed);
+
+  if (t <= b) {
+    ptask = a->elems[b & (a->size - 1)];
+    if (t == b) {
+      // last task: race any thieves for it
+      if (!atomic_compare_exchange_strong_int_least64_t(&deque->top,
+                                                        t, t + 1))
+        ptask = NULL;
+      atomic_store_explicit_int_least64_t(&deque->bottom, b + 1,
+                                          memory_order_relaxed);
+    }
+  }
+  else {
+    // deque was empty
+    atomic_store_explicit_int_least64_t(&deque->bottom, b + 1,
+                                        memory_order_relaxed);
+  }
+
+  return ptask;
+}
+
+
+//
+// Steal the oldest task from the top of a deque, or return NULL if it
+// is empty or we lost a race for the task.  Any thread may call this.
+//
+static task_pool_p task_deque_steal(task_deque_t* deque) {
+  int64_t             b, t;
+  task_deque_array_t* a;
+  task_pool_p         ptask;
+
+  t = atomic_load_explicit_int_least64_t(&deque->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  b = atomic_load_explicit_int_least64_t(&deque->bottom,
+                                         memory_order_acquire);
+  if (t >= b)
+    return NULL;
+
+  a = (task_deque_array_t*)
+      atomic_load_explicit_uintptr_t(&deque->array, memory_order_consume);
+  ptask = a->elems[t & (a->size - 1)];
+  if (!atomic_compare_exchange_strong_int_least64_t(&deque->top, t, t + 1))
+    return NULL;
+
+  return ptask;
+}
+
+
+// Lightweight tasks
+
+//
+// Whether we may start another pool thread.  In lightweight-task mode
+// we want no more than one per core, because a task that is waiting
+// doesn't hold on to its thread.
+//
+static chpl_bool can_create_thread(void) {
+  return (chpl_thread_canCreate()
+          && (!lightweight_tasks
+              || chpl_thread_getNumThreads() < lw_max_threads));
+}
+
+
+//
+// This is the lightweight-task counterpart of the task loops in
+// thread_begin() and ws_thread_loop().  Each task taken from the pool
+// (or the deques) is begun on a context of its own, and tasks that have
+// switched out are resumed from the ready list.  A thread created
+// without a task starts out counted as idle.
+//
+static void lw_thread_loop(thread_private_data_t* tp, task_pool_p ptask) {
+  ucontext_t  sched_uc;
+  task_ctx_t* ctx = NULL;
+  chpl_bool   yielded = false;
+
+  tp->sched_uc = &sched_uc;
+
+  while (true) {
+    if (ptask != NULL)
+      ctx = lw_ctx_create(ptask);
+
+    if (ctx != NULL) {
+      if (lw_run(tp, ctx, &yielded)) {
+        ptask = ctx->ptask;
+        lw_ctx_destroy(ctx);
+
+        if (do_taskReport) {
+          chpl_thread_mutexLock(&taskTable_lock);
+          chpldev_taskTable_remove(ptask->id);
+          chpl_thread_mutexUnlock(&taskTable_lock);
+        }
+      }
+      else {
+        // someone else is responsible for it now
+        ptask = NULL;
+      }
+
+      if (work_stealing) {
+        if (ptask != NULL)
+          chpl_mem_free(ptask, 0, 0);
+        (void) atomic_fetch_add_int_least64_t(&ws_idle_thread_cnt, 1);
+      }
+      else {
+        // begin critical section
+        chpl_thread_mutexLock(&threading_lock);
+
+        // see thread_begin() for why we free this while holding the lock
+        if (ptask != NULL)
+          chpl_mem_free(ptask, 0, 0);
+
+        assert(running_task_cnt > 0);
+        running_task_cnt--;
+        idle_thread_cnt++;
+
+        // end critical section
+        chpl_thread_mutexUnlock(&threading_lock);
+      }
+    }
+
+    //
+    // wait for a task to begin or resume
+    //
+    ptask = NULL;
+    ctx = NULL;
+    while (!lw_find_work(tp, yielded, &ptask, &ctx)) {
+      if (set_block_loc(0, idleTaskName)) {
+        // all other tasks appear to be blocked
+        struct timeval deadline, now;
+        gettimeofday(&deadline, NULL);
+        deadline.tv_sec += 1;
+        do {
+          chpl_thread_yield();
+          if (!lw_work_available())
+            gettimeofday(&now, NULL);
+        } while (!lw_work_available()
+                 && (now.tv_sec < deadline.tv_sec
+                     || (now.tv_sec == deadline.tv_sec
+                         && now.tv_usec < deadline.tv_usec)));
+        if (!lw_work_available()) {
+          check_for_deadlock();
+        }
+      }
+      else {
+        do {
+          chpl_thread_yield();
+        } while (!lw_work_available());
+      }
+
+      unset_block_loc();
+    }
+
+    if (blockreport)
+      progress_cnt++;
+  }
+}
+
+
+//
+// Find something for an idle thread to do: resume the oldest ready
+// task, or begin a new one.  Right after a task has yielded we look for
+// a new task first, so that a task spinning on a condition that some
+// not-yet-begun task will satisfy can't keep that task from running.
+// On success the thread is counted as busy again.
+//
+static chpl_bool lw_find_work(thread_private_data_t* tp, chpl_bool pool_first,
+                              task_pool_p* pptask, task_ctx_t** pctx) {
+  task_pool_p ptask = NULL;
+  task_ctx_t* ctx = NULL;
+  int         tries;
+
+  for (tries = 0; tries < 2 && ptask == NULL && ctx == NULL; tries++) {
+    if ((tries == 0) != pool_first) {
+      if (atomic_load_int_least64_t(&lw_ready_cnt) > 0) {
+        chpl_thread_mutexLock(&lw_ready_lock);
+        if ((ctx = lw_ready_head) != NULL) {
+          if ((lw_ready_head = ctx->next) == NULL)
+            lw_ready_tail = NULL;
+          (void) atomic_fetch_sub_int_least64_t(&lw_ready_cnt, 1);
+        }
+        chpl_thread_mutexUnlock(&lw_ready_lock);
+      }
+    }
+    else if (work_stealing)
+      ptask = ws_find_task(tp);
+    else if (task_pool_head != NULL) {
+      // begin critical section
+      chpl_thread_mutexLock(&threading_lock);
+
+      if (task_pool_head != NULL) {
+        idle_thread_cnt--;
+        running_task_cnt++;
+        ptask = take_task_from_pool(pick_task_for_thread(tp));
+      }
+
+      // end critical section
+      chpl_thread_mutexUnlock(&threading_lock);
+    }
+  }
+
+  if (ptask == NULL && ctx == NULL)
+    return false;
+
+  if (work_stealing)
+    (void) atomic_fetch_sub_int_least64_t(&ws_idle_thread_cnt, 1);
+  else if (ctx != NULL) {
+    // begin critical section
+    chpl_thread_mutexLock(&threading_lock);
+
+    idle_thread_cnt--;
+    running_task_cnt++;
+
+    // end critical section
+    chpl_thread_mutexUnlock(&threading_lock);
+  }
+
+  *pptask = ptask;
+  *pctx = ctx;
+  return true;
+}
+
+
+//
+// Is there a task that an idle thread could begin or resume?
+//
+static chpl_bool lw_work_available(void) {
+  if (atomic_load_int_least64_t(&lw_ready_cnt) > 0)
+    return true;
+  if (work_stealing)
+    return atomic_load_int_least64_t(&ws_queued_task_cnt) > 0;
+  return task_pool_head != NULL;
+}
+
+
+//
+// Get a new task stack, with room for a guard page below it.  Like the
+// threads' own stacks, each one gets a guard page so that overflow is
+// caught.  But each guard page costs a separate memory mapping and the
+// system limits how many of those we may have (vm.max_map_count on
+// Linux, 65530 by default), so past LW_GUARDED_MAX of them, or if we
+// can't get one, we warn and carve the remaining stacks, unguarded, out
+// of mappings big enough to hold several.
+//
+static void* lw_stack_alloc(void) {
+  size_t size = lw_stack_size + lw_page_size;
+  void*  stack;
+
+  if (!lw_guard_failed
+      && atomic_fetch_add_int_least64_t(&lw_guarded_cnt, 1)
+         < LW_GUARDED_MAX) {
+    stack = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (stack != MAP_FAILED) {
+      if (mprotect(stack, lw_page_size, PROT_NONE) == 0)
+        return stack;
+      (void) munmap(stack, size);
+    }
+  }
+
+  if (!lw_guard_failed) {
+    chpl_thread_mutexLock(&lw_stack_lock);
+    if (!lw_guard_failed) {
+      lw_guard_failed = true;
+      chpl_warning("unable to place guard pages on all task stacks; "
+                   "task stack overflow may go undetected", 0, 0);
+    }
+    chpl_thread_mutexUnlock(&lw_stack_lock);
+  }
+
+  chpl_thread_mutexLock(&lw_stack_lock);
+  if (lw_slab_left == 0) {
+    lw_slab_next = mmap(NULL, size * LW_STACK_SLAB_CNT,
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (lw_slab_next == MAP_FAILED)
+      chpl_error("Out of memory allocating a task stack", 0, 0);
+    lw_slab_left = LW_STACK_SLAB_CNT;
+  }
+  stack = lw_slab_next;
+  lw_slab_next += size;
+  lw_slab_left--;
+  chpl_thread_mutexUnlock(&lw_stack_lock);
+
+  return stack;
+}
+
+
+//
+// Make a context to begin a task on, reusing a cached stack if there is
+// one.
+//
+static task_ctx_t* lw_ctx_create(task_pool_p ptask) {
+  task_ctx_t* ctx = NULL;
+
+  if (lw_stack_cache != NULL) {
+    chpl_thread_mutexLock(&lw_stack_lock);
+    if ((ctx = lw_stack_cache) != NULL) {
+      lw_stack_cache = ctx->next;
+      lw_stack_cache_cnt--;
+    }
+    chpl_thread_mutexUnlock(&lw_stack_lock);
+  }
+
+  if (ctx == NULL) {
+    ctx = (task_ctx_t*) chpl_mem_alloc(sizeof(task_ctx_t),
+                                       CHPL_RT_MD_TASK_CONTEXT, 0, 0);
+    ctx->stack = lw_stack_alloc();
+  }
+
+  if (getcontext(&ctx->uc) != 0)
+    chpl_internal_error("getcontext() failed");
+  ctx->uc.uc_stack.ss_sp = (char*) ctx->stack + lw_page_size;
+  ctx->uc.uc_stack.ss_size = lw_stack_size;
+  ctx->uc.uc_link = NULL;
+  makecontext(&ctx->uc, lw_task_entry, 0);
+
+  ctx->ptask = ptask;
+  ctx->curr_ptask = ptask;
+  ctx->next = NULL;
+  return ctx;
+}
+
+
+//
+// Get rid of a context whose task has finished, keeping its stack for
+// reuse if we don't have plenty already.  Once we are out of guarded
+// stacks we keep them all, since unmapping one could need a mapping we
+// can't have.
+//
+static void lw_ctx_destroy(task_ctx_t* ctx) {
+  chpl_thread_mutexLock(&lw_stack_lock);
+  if (lw_stack_cache_cnt < LW_STACK_CACHE_MAX || lw_guard_failed) {
+    ctx->next = lw_stack_cache;
+    lw_stack_cache = ctx;
+    lw_stack_cache_cnt++;
+    ctx = NULL;
+  }
+  chpl_thread_mutexUnlock(&lw_stack_lock);
+
+  if (ctx != NULL) {
+    (void) munmap(ctx->stack, lw_stack_size + lw_page_size);
+    chpl_mem_free(ctx, 0, 0);
+  }
+}
+
+
+//
+// Get the lightweight task context now running on my thread, if any.
+// Threads the tasking layer didn't create (the comm layer's, say) have
+// no private data, and never run lightweight tasks.
+//
+static task_ctx_t* get_current_ctx(void) {
+  thread_private_data_t* tp;
+
+  tp = (thread_private_data_t*) chpl_thread_getPrivateData();
+  return (tp == NULL) ? NULL : tp->ctx;
+}
+
+
+//
+// Every context starts here.  The task may end on a different thread
+// than it began on, so we look up the scheduling loop to go back to
+// only once it has finished.
+//
+static void lw_task_entry(void) {
+  task_ctx_t* ctx = get_thread_private_data()->ctx;
+
+  (*ctx->ptask->fun)(ctx->ptask->arg);
+
+  ctx->curr_ptask = NULL;
+  setcontext(get_thread_private_data()->sched_uc);
+  chpl_internal_error("setcontext() failed");
+}
+
+
+//
+// Run a context on this thread until its task finishes or switches out.
+// Returns true if it finished, and sets *yielded if it switched out to
+// go straight back on the ready list.  A task that switches out may want
+// a lock released or itself made ready, which it couldn't safely do
+// while it was still running, so we do that for it here.
+//
+static chpl_bool lw_run(thread_private_data_t* tp, task_ctx_t* ctx,
+                        chpl_bool* yielded) {
+  task_ctx_t*          requeue;
+  chpl_sync_aux_t*     unlock;
+
   if (do_taskReport) {
     chpl_thread_mutexLock(&taskTable_lock);
-    chpldev_taskTable_add(ptask->id,
-                          ptask->lineno, ptask->filename,
-                          (uint64_t) (intptr_t) ptask);
+    chpldev_taskTable_set_active(ctx->curr_ptask->id);
     chpl_thread_mutexUnlock(&taskTable_lock);
   }
 
-  return ptask;
+  tp->ctx = ctx;
+  set_thread_ptask(tp, ctx->curr_ptask);
+
+  if (swapcontext(tp->sched_uc, &ctx->uc) != 0)
+    chpl_internal_error("swapcontext() failed");
+
+  tp->ctx = NULL;
+  tp->ptask = NULL;
+
+  *yielded = false;
+  if (ctx->curr_ptask == NULL)
+    return true;
+
+  if (do_taskReport) {
+    chpl_thread_mutexLock(&taskTable_lock);
+    chpldev_taskTable_set_suspended(ctx->curr_ptask->id);
+    chpl_thread_mutexUnlock(&taskTable_lock);
+  }
+
+  requeue = tp->lw_requeue;
+  unlock = tp->lw_unlock;
+  tp->lw_requeue = NULL;
+  tp->lw_unlock = NULL;
+  *yielded = (requeue != NULL);
+
+  // the context may be resumed elsewhere as soon as we do these
+  if (unlock != NULL)
+    chpl_sync_unlock(unlock);
+  if (requeue != NULL)
+    lw_make_ready(requeue);
+
+  return false;
+}
+
+
+//
+// Switch the running lightweight task out, back to its thread's
+// scheduling loop.  When this returns the task has been resumed, maybe
+// on another thread.  The remote cache and the comm layer's PUT buffers
+// belong to the thread, not the task, so the task completes its writes
+// before it goes and drops any cached values when it comes back.
+//
+static void lw_switch_out(void) {
+  thread_private_data_t* tp = get_thread_private_data();
+  task_ctx_t*            ctx = tp->ctx;
+
+  chpl_rmem_consist_release(__LINE__, __FILE__);
+  ctx->curr_ptask = tp->ptask;
+  if (swapcontext(&ctx->uc, tp->sched_uc) != 0)
+    chpl_internal_error("swapcontext() failed");
+  chpl_rmem_consist_acquire(__LINE__, __FILE__);
+}
+
+
+//
+// Put a context on the ready list.  If no thread is idle to pick it up
+// and we are allowed another pool thread, start one.
+//
+static void lw_make_ready(task_ctx_t* ctx) {
+  chpl_bool have_idle;
+
+  ctx->next = NULL;
+  chpl_thread_mutexLock(&lw_ready_lock);
+  if (lw_ready_tail == NULL)
+    lw_ready_head = ctx;
+  else
+    lw_ready_tail->next = ctx;
+  lw_ready_tail = ctx;
+  (void) atomic_fetch_add_int_least64_t(&lw_ready_cnt, 1);
+  chpl_thread_mutexUnlock(&lw_ready_lock);
+
+  have_idle = (work_stealing
+               ? atomic_load_int_least64_t(&ws_idle_thread_cnt) > 0
+               : idle_thread_cnt > 0);
+  if (have_idle || thread_create_failed || !can_create_thread())
+    return;
+
+  // begin critical section
+  chpl_thread_mutexLock(&threading_lock);
+
+  if (can_create_thread() && !thread_create_failed) {
+    //
+    // The new thread counts as idle from now on, as in
+    // ws_schedule_tasks().
+    //
+    if (work_stealing)
+      (void) atomic_fetch_add_int_least64_t(&ws_idle_thread_cnt, 1);
+    else
+      idle_thread_cnt++;
+    if (chpl_thread_create(NULL)) {
+      if (work_stealing)
+        (void) atomic_fetch_sub_int_least64_t(&ws_idle_thread_cnt, 1);
+      else
+        idle_thread_cnt--;
+      warn_thread_create_failed();
+    }
+  }
+
+  // end critical section
+  chpl_thread_mutexUnlock(&threading_lock);
+}
+
+
+//
+// Put the running lightweight task on a sync variable's waiter list and
+// switch out.  The scheduling loop unlocks the sync variable once we are
+// switched out, so we can't be made ready too early.  Returns with the
+// sync variable locked again.
+//
+static void lw_sync_suspend(chpl_sync_aux_t* s, chpl_bool want_full) {
+  thread_private_data_t* tp = get_thread_private_data();
+  task_ctx_t*            ctx = tp->ctx;
+
+  ctx->want_full = want_full;
+  if (s->waiters == NULL)
+    ctx->next = ctx;
+  else {
+    ctx->next = s->waiters->next;
+    s->waiters->next = ctx;
+  }
+  s->waiters = ctx;
+
+  tp->lw_unlock = s;
+  lw_switch_out();
+
+  sync_lock_when(s, 0, 0, 0, NULL);
+}
+
+
+//
+// Make ready the oldest lightweight task waiting for a sync variable to
+// become full (or empty).  Like sync_unlock_as() this wakes just one,
+// which will pass the signal on if it doesn't consume the value.  The
+// waiters form a circular list, and s->waiters points to the newest.
+// The sync variable is locked.
+//
+static void lw_sync_awaken(chpl_sync_aux_t* s, chpl_bool full) {
+  task_ctx_t* prev = s->waiters;
+  task_ctx_t* ctx = prev->next;
+
+  while (ctx->want_full != full) {
+    if (ctx == s->waiters)
+      return;
+    prev = ctx;
+    ctx = ctx->next;
+  }
+
+  if (ctx == prev)
+    s->waiters = NULL;
+  else {
+    prev->next = ctx->next;
+    if (s->waiters == ctx)
+      s->waiters = prev;
+  }
+
+  lw_make_ready(ctx);
 }
 
 
@@ -1482,6 +2892,9 @@ uint32_t chpl_task_getNumThreads(void) {
 uint32_t chpl_task_getNumIdleThreads(void) {
   int numIdleThreads;
 
+  if (work_stealing)
+    return (uint32_t) atomic_load_int_least64_t(&ws_idle_thread_cnt);
+
   // begin critical section
   chpl_thread_mutexLock(&threading_lock);
 
@@ -0,0 +1,26 @@
+module Shapes {
+  class Shape {
+    proc area(): real { halt("abstract"); return 0.0; }
+    proc name() return "shape";
+  }
+
+  class Square: Shape {
+    var side: real;
+    proc area(): real return side * side;
+    proc name() return "square";
+  }
+
+  class Circle: Shape {
+    var radius: real;
+    proc area(): real return 3.0 * radius * radius;
+    proc name() return "circle";
+  }
+
+  var shapesMade = 0;
+
+  proc makeShape(i: int): Shape {
+    shapesMade += 1;
+    if i % 2 == 0 then return new Square(i);
+    else return new Circle(i);
+  }
+}
@@ -0,0 +1,19 @@
+module Stats {
+  record summary {
+    var count: int;
+    var total: real;
+    var largest: real;
+  }
+
+  proc summarize(xs: [] ?t) {
+    var s: summary;
+    for x in xs {
+      s.count += 1;
+      s.total += x;
+      s.largest = max(s.largest, x: real);
+    }
+    return s;
+  }
+
+  proc mean(s: summary) return s.total / s.count;
+}
@@ -0,0 +1,23 @@
+// Splits the generated code into several translation units: classes
+// with dynamic dispatch, generic functions, records and module-level
+// variables used across modules must all still link and run.
+use Shapes, Stats;
+
+config const n = 10;
+
+var areas: [1..n] real;
+forall i in 1..n {
+  const s = makeShape(i);
+  areas[i] = s.area();
+  delete s;
+}
+writeln(shapesMade);
+
+const counts: [1..n] int = [i in 1..n] i;
+const sa = summarize(areas), si = summarize(counts);
+writeln(sa);
+writeln(mean(si));
+
+var s: Shape = new Square(3);
+writeln(s.name(), " ", s.area());
+delete s;
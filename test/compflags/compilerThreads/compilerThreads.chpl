@@ -0,0 +1,84 @@
+//
+// A program with enough functions, loops, and temporaries for the
+// per-function optimization passes to have work on several threads.
+//
+config const n = 64, steps = 10;
+
+record body {
+  var pos, vel: 3*real;
+  var mass: real;
+}
+
+class Histogram {
+  var lo, hi: real;
+  var counts: [0..#8] int;
+
+  proc add(x: real) {
+    const bin = min(7, max(0, ((x - lo) / (hi - lo) * 8): int));
+    counts[bin] += 1;
+  }
+}
+
+iter pairs(m: int) {
+  for i in 1..m do
+    for j in i+1..m do
+      yield (i, j);
+}
+
+proc energy(B: [] body) {
+  var e = 0.0;
+  for b in B do
+    e += 0.5 * b.mass * (b.vel(1)**2 + b.vel(2)**2 + b.vel(3)**2);
+  for (i, j) in pairs(B.size) {
+    const d = B[i].pos - B[j].pos;
+    e -= B[i].mass * B[j].mass / sqrt(d(1)**2 + d(2)**2 + d(3)**2);
+  }
+  return e;
+}
+
+proc advance(B: [] body, dt: real) {
+  for (i, j) in pairs(B.size) {
+    const d = B[i].pos - B[j].pos,
+          dist2 = d(1)**2 + d(2)**2 + d(3)**2,
+          mag = dt / (dist2 * sqrt(dist2));
+    B[i].vel -= d * B[j].mass * mag;
+    B[j].vel += d * B[i].mass * mag;
+  }
+  forall b in B do
+    b.pos += dt * b.vel;
+}
+
+proc matmul(A: [?D] real, X: [D] real) {
+  var C: [D] real;
+  forall (i, j) in D do
+    for k in D.dim(2) do
+      C[i, j] += A[i, k] * X[k, j];
+  return C;
+}
+
+proc main() {
+  var B: [1..5] body;
+  for i in 1..5 do
+    B[i] = new body((i: real, (i*i): real, 0.0), (0.0, 0.0, i / 10.0), i);
+
+  const e0 = energy(B);
+  for 1..steps do
+    advance(B, 0.01);
+  writeln(abs(energy(B) - e0) < 1.0);
+
+  const D = {1..n, 1..n};
+  var A, I: [D] real;
+  forall (i, j) in D {
+    A[i, j] = i + j;
+    I[i, j] = if i == j then 1.0 else 0.0;
+  }
+  const P = matmul(A, I);
+  writeln(&& reduce (P == A));
+
+  var h = new Histogram(0.0, 2.0 * n);
+  for a in A do
+    h.add(a);
+  writeln(h.counts);
+  writeln(+ reduce h.counts == n * n);
+  delete h;
+}
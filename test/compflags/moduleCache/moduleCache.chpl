@@ -0,0 +1,8 @@
+use Sort, Random;
+
+var A: [1..10] real;
+
+fillRandom(A, 314159265);
+QuickSort(A);
+writeln(A[1] <= A[5] && A[5] <= A[10]);
+writeln(+ reduce [i in 1..10] i**2);
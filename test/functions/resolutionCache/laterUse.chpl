@@ -0,0 +1,59 @@
+//
+// Calls with the same name and actuals that can see different functions.
+// Each must resolve to the best function visible from it, not the one an
+// earlier call with the same signature got.
+//
+module Extra {
+  proc f(x: int) return "Extra.f(int)";
+  proc f(x: real) return "Extra.f(real)";
+}
+
+module Other {
+  use Extra;
+
+  proc fromOther() return f(1);
+}
+
+module laterUse {
+  proc f(x) return "generic f";
+
+  proc plain() return f(1);
+
+  proc plainAgain() return f(1);
+
+  proc withUse() {
+    use Extra;
+    return f(1);
+  }
+
+  proc nestedUse() {
+    const before = f(1);
+    {
+      use Extra;
+      const inside = f(1);
+      return before + ", " + inside;
+    }
+  }
+
+  proc nestedOverload() {
+    proc f(x: int) return "nested f(int)";
+    return f(1);
+  }
+
+  proc otherTypes() return f(2.0) + ", " + f(true);
+
+  proc main() {
+    writeln(plain());
+    writeln(withUse());
+    writeln(plainAgain());
+    writeln(nestedUse());
+    writeln(Other.fromOther());
+    writeln(nestedOverload());
+    writeln(plain());
+    writeln(otherTypes());
+    {
+      use Extra;
+      writeln(f(2.0), ", ", f(true));
+    }
+  }
+}
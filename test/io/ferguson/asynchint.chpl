@@ -0,0 +1,35 @@
+config const n = 300000;
+
+var f = open("asynchint.bin", iomode.cwr, hints=IOHINT_ASYNC);
+
+var A:[1..n] int = [i in 1..n] i*i;
+{
+  var w = f.writer(kind=iobig);
+  w.write(A);
+  w.close();
+}
+
+{
+  var r = f.reader(kind=iobig, hints=IOHINT_ASYNC);
+  var B:[1..n] int;
+  r.read(B);
+  r.close();
+  assert(B == A);
+}
+
+{
+  // Write through an async channel on a file opened with the default method.
+  var g = open("asynchint.bin", iomode.rw);
+  var w = g.writer(kind=iobig, hints=IOHINT_ASYNC, start=8*n);
+  w.write(A);
+  w.close();
+  var r = g.reader(kind=iobig, start=8*n);
+  var B:[1..n] int;
+  r.read(B);
+  r.close();
+  assert(B == A);
+  g.close();
+}
+
+writeln("size ", f.length());
+f.close();
@@ -1416,6 +1416,345 @@ void test_quoted_string_maxlength(void)
   if( verbose ) printf("PASS: quoted max length\n");
 }
 
+// Read whitespace-delimited words and numbers from lines with long
+// whitespace runs and long words, so that the bulk scanners in
+// qio_formatted.c see runs that cross their vector widths and the
+// channel's buffer boundaries.
+void scan_text_test(void)
+{
+  qioerr err;
+  qio_file_t *f = NULL;
+  qio_channel_t *reading = NULL;
+  qio_channel_t *writing = NULL;
+  qio_style_t style;
+  char* codeset = nl_langinfo(CODESET);
+  int utf8 = (0 == strcmp(codeset, "UTF-8"));
+  char word[128];
+  char line[512];
+  const char *out = NULL;
+  int64_t out_len = 0;
+  int64_t num;
+  int nlines = 150;
+  int k, i, len;
+
+  if( verbose ) printf("Testing bulk text scanning\n");
+
+  qio_style_init_default(&style);
+  style.string_format = QIO_STRING_FORMAT_WORD;
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+
+  err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, &style);
+  assert(!err);
+
+  for( k = 0; k < nlines; k++ ) {
+    len = 0;
+    for( i = 0; i < k % 41; i++ ) line[len++] = " \t\r\v\f"[(i + k) % 5];
+    // Non-ASCII whitespace has to be found by the slow path.
+    if( utf8 && k % 7 == 3 ) len += sprintf(&line[len], "\xe2\x80\x83 ");
+    for( i = 0; i < (k * 7) % 70 + 1; i++ ) line[len++] = 'a' + (i + k) % 26;
+    // Non-ASCII characters within a word.
+    if( k % 5 == 2 ) len += sprintf(&line[len], "\xc3\xa9z");
+    len += sprintf(&line[len], " %i\t", k * 1000003);
+    // Some lines have trailing junk for skip_past_newline to pass over.
+    if( k % 3 == 1 ) len += sprintf(&line[len], "junk %i, more junk", k);
+    line[len++] = '\n';
+    err = qio_channel_write_amt(true, writing, line, len);
+    assert(!err);
+  }
+
+  qio_channel_release(writing);
+
+  err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, &style);
+  assert(!err);
+
+  for( k = 0; k < nlines; k++ ) {
+    len = 0;
+    for( i = 0; i < (k * 7) % 70 + 1; i++ ) word[len++] = 'a' + (i + k) % 26;
+    if( k % 5 == 2 ) len += sprintf(&word[len], "\xc3\xa9z");
+    word[len] = '\0';
+
+    err = qio_channel_scan_string(true, reading, &out, &out_len, -1);
+    assert(!err);
+    assert(out_len == len);
+    assert(0 == strcmp(out, word));
+    free((void*) out);
+
+    err = qio_channel_scan_int(true, reading, &num, sizeof(num), 1);
+    assert(!err);
+    assert(num == k * 1000003);
+
+    err = qio_channel_skip_past_newline(true, reading, k % 3 != 1);
+    assert(!err);
+  }
+
+  err = qio_channel_scan_literal(true, reading, "x", 1, 1);
+  assert(qio_err_to_int(err) == EEOF);
+
+  qio_channel_release(reading);
+
+  // maxlen stops a word part-way through a run.
+  err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, &style);
+  assert(!err);
+  err = qio_channel_scan_string(true, reading, &out, &out_len, 1);
+  assert(!err);
+  assert(out_len == 1 && out[0] == 'a');
+  free((void*) out);
+  qio_channel_release(reading);
+
+  qio_file_release(f);
+}
+
+// Quoted strings long enough to use the bulk path, with escapes
+// and non-ASCII characters at every position.
+void scan_quoted_test(void)
+{
+  qioerr err;
+  qio_file_t *f = NULL;
+  qio_channel_t *reading = NULL;
+  qio_channel_t *writing = NULL;
+  qio_style_t style;
+  char str[128];
+  const char *out = NULL;
+  int64_t out_len = 0;
+  int len, i, special;
+
+  if( verbose ) printf("Testing bulk quoted string scanning\n");
+
+  qio_style_init_default(&style);
+  style.string_format = QIO_STRING_FORMAT_JSON;
+
+  for( len = 0; len < 80; len += 3 ) {
+    for( special = 0; special < 3; special++ ) {
+      for( i = 0; i < len; i++ ) str[i] = 'A' + i % 26;
+      if( len > 4 ) {
+        if( special == 0 ) str[len/2] = '"';
+        if( special == 1 ) str[len/2] = '\\';
+        if( special == 2 ) memcpy(&str[len/2], "\xc3\xa9", 2);
+      }
+      str[len] = '\0';
+
+      err = qio_file_open_tmp(&f, 0, NULL);
+      assert(!err);
+      err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, &style);
+      assert(!err);
+      err = qio_channel_print_string(true, writing, str, len);
+      assert(!err);
+      qio_channel_release(writing);
+
+      err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, &style);
+      assert(!err);
+      err = qio_channel_scan_string(true, reading, &out, &out_len, -1);
+      assert(!err);
+      assert(out_len == len);
+      assert(0 == memcmp(out, str, len));
+      free((void*) out);
+      qio_channel_release(reading);
+      qio_file_release(f);
+    }
+  }
+}
+
+static uint64_t decimal_test_rand_state = 1;
+static uint64_t decimal_test_rand(void)
+{
+  // xorshift64
+  uint64_t x = decimal_test_rand_state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  decimal_test_rand_state = x;
+  return x;
+}
+
+// Print and scan numbers in the decimal style, comparing against
+// the C library. Covers the decimal fast paths and their fallbacks.
+void decimal_number_test(void)
+{
+#define NDECIMAL 2000
+  qioerr err;
+  qio_file_t *f = NULL;
+  qio_channel_t *reading = NULL;
+  qio_channel_t *writing = NULL;
+  qio_style_t style;
+  static double vals[NDECIMAL];
+  static int64_t ivals[NDECIMAL];
+  static char expect[NDECIMAL*32];
+  static char got[NDECIMAL*32];
+  const double special[] = { 0.5, 2.5, 1234565, 1234575, 999999.5, 9999995,
+                             0.00012345650000000001, 9.9999995e-5,
+                             0.1+0.2, 1e22, 1e23, 123e30, 1e-7, 1e-300,
+                             1e300, 4.9e-324, 1.7976931348623157e308,
+                             123456789012345678.0, 0.0, 5e-5 };
+  const int64_t ispecial[] = { 0, -1, 1, 99, 100, -100, INT64_MAX, INT64_MIN,
+                               1000000000000000000LL, -999999999999999999LL };
+  const int precisions[] = { -1, 1, 3, 10, 17 };
+  int nspecial = sizeof(special)/sizeof(special[0]);
+  int nispecial = sizeof(ispecial)/sizeof(ispecial[0]);
+  int i, p, len;
+  ssize_t amt;
+  char* s;
+
+  if( verbose ) printf("Testing decimal number printing and scanning\n");
+
+  decimal_test_rand_state = 1;
+  for( i = 0; i < NDECIMAL; i++ ) {
+    uint64_t r = decimal_test_rand();
+    if( i < nspecial ) {
+      vals[i] = special[i];
+    } else if( i % 3 == 0 ) {
+      // any bit pattern that is a number
+      memcpy(&vals[i], &r, sizeof(double));
+      if( isnan(vals[i]) ) vals[i] = 1.0;
+    } else {
+      // digits and a modest exponent
+      vals[i] = (double) (r >> (r % 60)) * pow(10, (int) (r % 41) - 30);
+    }
+    if( r & 1 ) vals[i] = -vals[i];
+
+    r = decimal_test_rand();
+    if( i < nispecial ) ivals[i] = ispecial[i];
+    else ivals[i] = (int64_t) (r >> (r % 64));
+  }
+
+  for( p = 0; p < sizeof(precisions)/sizeof(precisions[0]); p++ ) {
+    qio_style_init_default(&style);
+    style.showpointzero = 0; // so output should match %g
+    style.precision = precisions[p];
+    style.uppercase = (p == 2);
+
+    err = qio_file_open_tmp(&f, 0, NULL);
+    assert(!err);
+    err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, &style);
+    assert(!err);
+
+    s = expect;
+    for( i = 0; i < NDECIMAL; i++ ) {
+      err = qio_channel_print_float(true, writing, &vals[i], 8);
+      assert(!err);
+      err = qio_channel_write_byte(true, writing, ' ');
+      assert(!err);
+      if( style.precision < 0 ) {
+        s += sprintf(s, style.uppercase?"%G ":"%g ", vals[i]);
+      } else {
+        s += sprintf(s, style.uppercase?"%.*G ":"%.*g ", style.precision, vals[i]);
+      }
+    }
+    len = s - expect;
+    qio_channel_release(writing);
+
+    err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, &style);
+    assert(!err);
+    err = qio_channel_read(true, reading, got, sizeof(got), &amt);
+    assert(qio_err_to_int(err) == EEOF);
+    assert(amt == len);
+    assert(0 == memcmp(got, expect, len));
+    qio_channel_release(reading);
+
+    // Now read them back, comparing with strtod.
+    err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, &style);
+    assert(!err);
+    s = expect;
+    for( i = 0; i < NDECIMAL; i++ ) {
+      double x, y;
+      char* end;
+      int overflow;
+      errno = 0;
+      y = strtod(s, &end);
+      overflow = (errno == ERANGE);
+      s = end + 1;
+      err = qio_channel_scan_float(true, reading, &x, 8);
+      if( qio_err_to_int(err) == ERANGE ) {
+        assert(overflow);
+        continue;
+      }
+      assert(!err);
+      assert(x == y && signbit(x) == signbit(y));
+    }
+    qio_channel_release(reading);
+    qio_file_release(f);
+  }
+
+  // Integers, printed and read back in the default style.
+  qio_style_init_default(&style);
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, &style);
+  assert(!err);
+  s = expect;
+  for( i = 0; i < NDECIMAL; i++ ) {
+    err = qio_channel_print_int(true, writing, &ivals[i], 8, 1);
+    assert(!err);
+    err = qio_channel_write_byte(true, writing, (i % 2) ? '\n' : ',');
+    assert(!err);
+    s += sprintf(s, "%lld%c", (long long int) ivals[i], (i % 2) ? '\n' : ',');
+  }
+  len = s - expect;
+  qio_channel_release(writing);
+
+  err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, &style);
+  assert(!err);
+  err = qio_channel_read(true, reading, got, sizeof(got), &amt);
+  assert(qio_err_to_int(err) == EEOF);
+  assert(amt == len);
+  assert(0 == memcmp(got, expect, len));
+  qio_channel_release(reading);
+
+  err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, &style);
+  assert(!err);
+  for( i = 0; i < NDECIMAL; i++ ) {
+    int64_t x;
+    int32_t c;
+    err = qio_channel_scan_int(true, reading, &x, 8, 1);
+    assert(!err);
+    assert(x == ivals[i]);
+    c = qio_channel_read_byte(true, reading);
+    assert(c == ((i % 2) ? '\n' : ','));
+  }
+  qio_channel_release(reading);
+  qio_file_release(f);
+
+  // Base prefixes and numbers that continue past the fast path's
+  // 19 digits still work in the default style.
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, &style);
+  assert(!err);
+  s = "0x1F 0b101 12345678901234567890 -0o17 2e1.5 1.5e3x ";
+  err = qio_channel_write_amt(true, writing, s, strlen(s));
+  assert(!err);
+  qio_channel_release(writing);
+
+  err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, &style);
+  assert(!err);
+  {
+    int64_t x;
+    uint64_t ux;
+    double d;
+    err = qio_channel_scan_int(true, reading, &x, 8, 1);
+    assert(!err && x == 31);
+    err = qio_channel_scan_int(true, reading, &x, 8, 1);
+    assert(!err && x == 5);
+    err = qio_channel_scan_int(true, reading, &ux, 8, 0);
+    assert(!err && ux == 12345678901234567890ULL);
+    err = qio_channel_scan_int(true, reading, &x, 8, 1);
+    assert(!err && x == -15);
+    // _peek_number_unlocked accepts a point after the exponent
+    // (and strtod ignores it)
+    err = qio_channel_scan_float(true, reading, &d, 8);
+    assert(!err && d == 20.0);
+    assert(qio_channel_read_byte(true, reading) == ' ');
+    err = qio_channel_scan_float(true, reading, &d, 8);
+    assert(!err && d == 1500.0);
+    assert(qio_channel_read_byte(true, reading) == 'x');
+  }
+  qio_channel_release(reading);
+  qio_file_release(f);
+#undef NDECIMAL
+}
+
 int main(int argc, char** argv)
 {
   int sizes[] = {qbytes_iobuf_size, 1, 2, 0};
@@ -1457,6 +1796,11 @@ int main(int argc, char** argv)
     test_scanmatch();
 
     test_quoted_string_maxlength();
+
+    scan_text_test();
+    scan_quoted_test();
+
+    decimal_number_test();
   }
 
   printf("qio_formatted_test PASS\n");
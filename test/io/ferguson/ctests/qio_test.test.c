@@ -288,7 +288,7 @@ void check_channels(void)
   int nunbounded = sizeof(unboundedness)/sizeof(char);
   int unbounded;
   char reopen;
-  qio_hint_t hints[] = {QIO_METHOD_DEFAULT, QIO_METHOD_READWRITE, QIO_METHOD_PREADPWRITE, QIO_METHOD_FREADFWRITE, QIO_METHOD_MEMORY, QIO_METHOD_MMAP, QIO_METHOD_MMAP|QIO_HINT_PARALLEL, QIO_METHOD_PREADPWRITE | QIO_HINT_NOFAST};
+  qio_hint_t hints[] = {QIO_METHOD_DEFAULT, QIO_METHOD_READWRITE, QIO_METHOD_PREADPWRITE, QIO_METHOD_FREADFWRITE, QIO_METHOD_MEMORY, QIO_METHOD_MMAP, QIO_METHOD_MMAP|QIO_HINT_PARALLEL, QIO_METHOD_PREADPWRITE | QIO_HINT_NOFAST, QIO_METHOD_ASYNC};
   int nhints = sizeof(hints)/sizeof(qio_hint_t);
   int file_hint, ch_hint;
 
@@ -327,6 +327,125 @@ void check_channels(void)
   }*/
 }
 
+// Check that zero-copy views return the same data as qio_channel_read
+// and stay valid after the channel and file are released.
+void check_read_view(qio_hint_t hints, int64_t len, int64_t maxlen, char keep)
+{
+  qio_file_t* f;
+  qio_channel_t* writing;
+  qio_channel_t* reading;
+  qioerr err;
+  unsigned char* data;
+  qbytes_t* bytes;
+  qbytes_t* last_bytes = NULL;
+  void* ptr;
+  void* last_ptr = NULL;
+  int64_t got;
+  int64_t last_got = 0;
+  int64_t last_off = 0;
+  int64_t off;
+  int64_t k;
+
+  if( verbose ) {
+    char* hintstr = qio_hints_to_string(hints);
+    printf("check_read_view(hints=%s, len=%lli, maxlen=%lli, keep=%i)\n",
+           hintstr, (long long int) len, (long long int) maxlen, (int) keep);
+    free(hintstr);
+  }
+
+  data = malloc(len);
+  assert(data);
+  fill_testdata(0, len, data);
+
+  if( (hints & QIO_METHODMASK) == QIO_METHOD_MEMORY ) {
+    err = qio_file_open_mem_ext(&f, NULL, QIO_FDFLAG_READABLE|QIO_FDFLAG_WRITEABLE|QIO_FDFLAG_SEEKABLE, hints, NULL);
+  } else {
+    err = qio_file_open_tmp(&f, hints, NULL);
+  }
+  assert(!err);
+
+  err = qio_channel_create(&writing, f, hints, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_write_amt(false, writing, data, len);
+  assert(!err);
+  qio_channel_release(writing);
+
+  err = qio_channel_create(&reading, f, hints, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+
+  // A view must be allowed at least one byte.
+  err = qio_channel_read_view(true, reading, 0, &bytes, &ptr, &got);
+  assert(qio_err_to_int(err) == EINVAL);
+  assert(got == 0);
+  assert(qio_channel_offset_unlocked(reading) == 0);
+
+  off = 0;
+  while( 1 ) {
+    bytes = NULL;
+    // Sometimes let the channel keep the view alive instead.
+    err = qio_channel_read_view(true, reading, maxlen, keep ? NULL : &bytes, &ptr, &got);
+    if( qio_err_to_int(err) == EEOF ) {
+      assert(bytes == NULL);
+      break;
+    }
+    assert(!err);
+    assert(got > 0 && got <= maxlen);
+    assert(off + got <= len);
+    assert(0 == memcmp(ptr, data + off, got));
+    if( keep ) {
+      off += got;
+      continue;
+    }
+    // Hold on to the last view past the end of the channel and file.
+    if( last_bytes ) qbytes_release(last_bytes);
+    last_bytes = bytes;
+    last_ptr = ptr;
+    last_got = got;
+    last_off = off;
+    off += got;
+  }
+  assert(off == len);
+
+  // EOF is sticky and does not disturb the channel position.
+  err = qio_channel_read_view(true, reading, maxlen, &bytes, &ptr, &got);
+  assert(qio_err_to_int(err) == EEOF);
+  assert(qio_channel_offset_unlocked(reading) == len);
+
+  qio_channel_release(reading);
+  qio_file_release(f);
+
+  if( last_bytes ) {
+    for( k = 0; k < last_got; k++ ) {
+      assert(((unsigned char*) last_ptr)[k] == data[last_off + k]);
+    }
+    qbytes_release(last_bytes);
+  }
+
+  free(data);
+}
+
+void check_read_views(void)
+{
+  qio_hint_t hints[] = {QIO_METHOD_DEFAULT, QIO_METHOD_PREADPWRITE, QIO_METHOD_MEMORY, QIO_METHOD_MMAP, QIO_METHOD_ASYNC};
+  int nhints = sizeof(hints)/sizeof(qio_hint_t);
+  int64_t lens[] = {1, 13, qbytes_iobuf_size + 13, 4 * qbytes_iobuf_size};
+  int nlens = sizeof(lens)/sizeof(int64_t);
+  int64_t maxlens[] = {1, 7, qbytes_iobuf_size, INT64_MAX};
+  int nmaxlens = sizeof(maxlens)/sizeof(int64_t);
+  int h, i, j;
+  char keep;
+
+  for( h = 0; h < nhints; h++ ) {
+    for( i = 0; i < nlens; i++ ) {
+      for( j = 0; j < nmaxlens; j++ ) {
+        for( keep = 0; keep < 2; keep++ ) {
+          check_read_view(hints[h], lens[i], maxlens[j], keep);
+        }
+      }
+    }
+  }
+}
+
 // Check some path functions.
 void check_paths(void)
 {
@@ -381,6 +500,8 @@ int main(int argc, char** argv)
 
   check_channels();
 
+  check_read_views();
+
 
   printf("qio_test PASS\n");
 
@@ -0,0 +1,40 @@
+config const n = 100000;
+
+{
+  var w = openwriter("views.txt");
+  for i in 0..#n do w.write((i % 10):string);
+  w.close();
+}
+
+// Read-only files of this size are read with mmap by default.
+var f = open("views.txt", iomode.r);
+
+// Read the file back through views with a few different view sizes.
+for maxlen in (1, 7, 4096, max(int(64))) {
+  var r = f.reader();
+  var nbytes = 0;
+  var sum = 0;
+  var ok = true;
+  for v in r.views(maxlen) {
+    if v.len > maxlen || v.offset != nbytes then ok = false;
+    for b in v do sum += b - 0x30;
+    nbytes += v.len;
+  }
+  r.close();
+  writeln(ok, " ", nbytes, " ", sum);
+}
+
+// Stop partway through and check the channel position.
+{
+  var r = f.reader();
+  for v in r.views(1000) {
+    if v[0] != 0x30 then writeln("bad byte ", v[0]);
+    if v.offset >= 5000 then break;
+  }
+  var x:string;
+  r.readf("%s", x);
+  writeln(x.length + 6000 == n);
+  r.close();
+}
+
+f.close();
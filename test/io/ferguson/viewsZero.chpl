@@ -0,0 +1,16 @@
+// A view must be allowed at least one byte; asking for empty views is
+// an error rather than an endless stream of them.
+{
+  var w = openwriter("viewsZero.txt");
+  w.write("abc");
+  w.close();
+}
+
+var f = open("viewsZero.txt", iomode.r);
+var r = f.reader();
+var n = 0;
+for v in r.views(0) {
+  n += 1;
+  if n > 10 then break;
+}
+writeln(n);
@@ -0,0 +1,21 @@
+//
+// Tasks started on a sublocale without an 'on' of their own should
+// run on that same sublocale.
+//
+extern proc chpl_task_getSubloc(): chpl_sublocID_t;
+
+config const tasksPerSubloc = 4;
+
+coforall subloc in (here:LocaleModel).getChildren() do on subloc {
+  const want = chpl_task_getSubloc();
+  var wrong: sync int = 0;
+
+  coforall t in 1..tasksPerSubloc do
+    if chpl_task_getSubloc() != want then wrong += 1;
+
+  sync {
+    begin if chpl_task_getSubloc() != want then wrong += 1;
+  }
+
+  writeln(here, ": ", wrong.readFE(), " tasks on the wrong sublocale");
+}
@@ -0,0 +1,19 @@
+//
+// Sampling every allocation (--memProfileRate=1) makes the live and
+// high-water columns exact.  Only the array element rows for this
+// file are kept by the prediff; everything else depends on the
+// configuration.
+//
+use Memory;
+
+proc temp(n: int) {
+  var A: [1..n] real;
+  A = 1.0;
+  return + reduce A;
+}
+
+var keep: [1..1000] int;
+var sum = 0.0;
+for i in 1..100 do sum += temp(i);
+writeln(sum);
+printMemProfile();
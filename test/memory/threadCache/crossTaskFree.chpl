@@ -0,0 +1,29 @@
+//
+// Objects allocated by one task and deleted by another, over a range
+// of sizes that crosses all the small-block size classes.
+//
+config const n = 20000;
+
+class Block {
+  const k: int;
+  var   A: [1..k] int;
+}
+
+var box$: [0..#16] sync Block;
+var bad: sync int = 0;
+
+cobegin {
+  for i in 0..#n {
+    const b = new Block(1 + (i * 37) % 5000);
+    b.A = i;
+    box$[i % 16] = b;
+  }
+  for i in 0..#n {
+    const b = box$[i % 16];
+    if b.k != 1 + (i * 37) % 5000 || (|| reduce (b.A != i)) then bad += 1;
+    delete b;
+  }
+}
+
+writeln("blocks passed: ", n);
+writeln("blocks damaged: ", bad.readFF());
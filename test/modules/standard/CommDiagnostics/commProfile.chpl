@@ -0,0 +1,16 @@
+use CommDiagnostics;
+
+config const n = 10;
+
+var x: int;
+
+startCommProfile();
+on Locales[numLocales-1] {
+  for i in 1..n do
+    x = i;
+  var y = 0;
+  for i in 1..n do
+    y += x;
+}
+stopCommProfile();
+printCommProfile();
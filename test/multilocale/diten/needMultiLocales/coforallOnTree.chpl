@@ -0,0 +1,35 @@
+// Coforall loops whose bodies are only on statements start their remote
+// tasks as a batch.  Check that every task runs once, in the right
+// place, including many tasks to the same locale and nested loops.
+
+config const n = 100;
+
+var ids: [0..#numLocales] int;
+coforall loc in Locales do on loc {
+  ids[here.id] = here.id + 1;
+}
+writeln(+ reduce ids == numLocales * (numLocales + 1) / 2);
+
+var count: [0..#n] int;
+coforall i in 0..#n do on Locales[numLocales-1] {
+  count[i] = here.id;
+}
+writeln(&& reduce (count == numLocales-1));
+
+var pairs: [0..#numLocales, 0..#numLocales] int;
+coforall loc in Locales do on loc {
+  const outer = here.id;
+  coforall loc2 in Locales do on loc2 {
+    pairs[outer, here.id] += 1;
+  }
+}
+writeln(&& reduce (pairs == 1));
+
+var x: sync int = 0;
+coforall loc in Locales do on loc {
+  begin x += 1;
+}
+// the begins aren't waited for, so wait for them here
+var total = 0;
+while total != numLocales do total = x.readXX();
+writeln(total);
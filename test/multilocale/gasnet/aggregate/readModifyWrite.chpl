@@ -0,0 +1,47 @@
+// Remote read-modify-write loops with PUT aggregation.  A GET that
+// doesn't overlap a buffered or in-flight PUT may go ahead of it, but
+// every read must still see the task's own earlier writes, including
+// ones to other elements of the same cache line.
+
+config const n = 4096, iters = 100000;
+const sumT = + reduce [t in 0..#8] t;
+
+proc next(r: int) return (r * 1103515245 + 12345) % (1 << 31);
+
+on Locales[1] {
+  var A: [0..#n] int;
+  var B: [0..#n] int(8);
+
+  on Locales[0] {
+    var expect: [0..#n] int;
+    var r = 1;
+    var ok = true;
+    for 1..iters {
+      r = next(r);
+      const i = r % n;
+      A[i] += 1;
+      expect[i] += 1;
+      if A[i] != expect[i] then ok = false;
+    }
+    writeln("int increments ok: ", ok && && reduce (A == expect));
+
+    // Byte-sized elements, so neighbouring writes share a line.
+    ok = true;
+    for 1..iters {
+      r = next(r);
+      const i = r % (n-1);
+      B[i] = (B[i+1] + 1): int(8);
+      if B[i] != (B[i+1] + 1): int(8) then ok = false;
+    }
+    writeln("byte neighbours ok: ", ok);
+
+    // Several tasks each updating their own part of the array.
+    forall t in 0..#8 {
+      for k in 0..#(n/8) do
+        A[t*(n/8) + k] += t;
+    }
+  }
+
+  writeln("forall updates seen by owner: ",
+          + reduce A == iters + (n/8) * sumT);
+}
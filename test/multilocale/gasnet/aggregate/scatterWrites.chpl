@@ -0,0 +1,49 @@
+// Scattered single-element writes to a remote array.  With PUT
+// aggregation, the writes may sit in a buffer until something requires
+// them to complete.  They must all be visible after the writing tasks
+// are joined, after an on-statement returns, and to a task that has
+// been handed off to with a sync variable.
+
+config const n = 10000;
+
+// A permutation of 1..n, so consecutive writes go to scattered places.
+proc perm(i: int) return (i * 7919) % n + 1;
+
+proc check(const ref A: [] int, k: int) {
+  var ok = true;
+  for i in 1..n do
+    if A[perm(i)] != k*i then ok = false;
+  return ok;
+}
+
+on Locales[1] {
+  var A: [1..n] int;
+
+  // Writes from the tasks of a forall, joined on locale 0 and checked
+  // on locale 1.
+  on Locales[0] {
+    forall i in 1..n do A[perm(i)] = i;
+  }
+  writeln("after forall join: ", check(A, 1));
+
+  // Writes from the body of an on-statement, checked after it returns.
+  on Locales[0] {
+    for i in 1..n do A[perm(i)] = 2*i;
+  }
+  writeln("after on: ", check(A, 2));
+
+  // Writes from a task on locale 0, handed off to a task on locale 1
+  // through a sync variable.  Neither task waits for the other to end.
+  var done$: sync bool;
+  var ok$: sync bool;
+  begin on Locales[0] {
+    for i in 1..n do A[perm(i)] = 3*i;
+    done$ = true;
+  }
+  begin {
+    done$;
+    ok$ = check(A, 3);
+  }
+  const ok = ok$;
+  writeln("after sync handoff: ", ok);
+}
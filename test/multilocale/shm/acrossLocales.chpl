@@ -0,0 +1,49 @@
+// Basic multilocale operations under CHPL_COMM=shm, where each locale
+// is a separate process sharing one segment: on statements (fork),
+// remote reads and writes, coforall over the locales, and a forall
+// over a Block-distributed array.
+
+use BlockDist;
+
+config const n = 100000;
+
+// on statements, and reading and writing a variable on another locale
+var x = 0;
+for loc in Locales do
+  on loc do x += here.id + 1;
+writeln("x = ", x);
+
+// each locale allocates its own data and hands back results
+var ids: [LocaleSpace] int;
+var sums: [LocaleSpace] int;
+coforall loc in Locales do on loc {
+  var A: [1..n] int;
+  forall i in 1..n do A[i] = i;
+  ids[loc.id] = here.id;
+  sums[loc.id] = + reduce A;
+}
+writeln("ids = ", ids);
+writeln("sums ok: ", && reduce (sums == n * (n + 1) / 2));
+
+// data allocated on one locale and read and written from another
+on Locales[numLocales-1] {
+  var B: [1..n] real;
+  B = 2.0;
+  on Locales[0] {
+    B[1] = 1.0;
+    writeln("remote sum = ", + reduce B);
+  }
+  writeln("B[1] = ", B[1]);
+}
+
+// a forall over a Block-distributed array
+const D = {1..n} dmapped Block(boundingBox={1..n});
+var C: [D] int;
+forall i in D do C[i] = here.id;
+var perLocale: [LocaleSpace] int;
+for loc in Locales do
+  perLocale[loc.id] = + reduce [c in C] (c == loc.id);
+writeln("per locale ok: ", && reduce (perLocale > 0),
+        ", total = ", + reduce perLocale);
+forall c in C do c += 1;
+writeln("owners ok: ", && reduce [i in D] (C[i] == C.domain.dist.idxToLocale(i).id + 1));
@@ -0,0 +1,9 @@
+// Running out of a locale's shared heap must be reported as an
+// out-of-memory error, not satisfied with memory that other locales
+// cannot reach.
+
+on Locales[1] {
+  var A: [1..4*1024*1024] int;
+  A = 1;
+  on Locales[0] do writeln(+ reduce A);
+}
@@ -0,0 +1,86 @@
+// Indexed gather/scatter transfers through the remote cache: a list of
+// remote element addresses is read into, or written from, a local
+// buffer with chpl_gen_comm_get_idx/put_idx, mixed with ordinary
+// element reads and writes.
+
+extern proc chpl_gen_comm_get_idx(addr: c_void_ptr, node: int(32),
+                                  raddrs: c_ptr(c_void_ptr),
+                                  elemSize: int(32), typeIndex: int(32),
+                                  len: int(32), ln: c_int, fn: c_string);
+extern proc chpl_gen_comm_put_idx(addr: c_void_ptr, node: int(32),
+                                  raddrs: c_ptr(c_void_ptr),
+                                  elemSize: int(32), typeIndex: int(32),
+                                  len: int(32), ln: c_int, fn: c_string);
+
+config const n = 100000, m = 100;
+
+const elemSize = numBytes(int): int(32);
+
+// The element each list entry refers to: a scattered permutation, so
+// entries share cache lines out of order.
+proc pick(k: int, count: int) return (k * 7919) % count + 1;
+
+on Locales[1] {
+  var R: [1..n] int;
+  forall i in R.domain do R[i] = i * 10;
+
+  on Locales[0] {
+    var addrs: [0..#n] c_void_ptr;
+    var vals: [0..#n] int;
+
+    // Collect the remote addresses on their own locale.
+    on Locales[1] do
+      for k in 0..#n do
+        addrs[k] = c_ptrTo(R[pick(k, n)]): c_void_ptr;
+
+    // A gather must see an element written through the cache just
+    // before it.
+    R[pick(3, n)] = -1;
+    chpl_gen_comm_get_idx(c_ptrTo(vals): c_void_ptr, 1, c_ptrTo(addrs), elemSize, -1,
+                          m: int(32), 0, "gatherScatter.chpl");
+    var ok = true;
+    for k in 0..#m {
+      const j = pick(k, n);
+      if vals[k] != (if k == 3 then -1 else j * 10) then ok = false;
+    }
+    writeln("small gather ok: ", ok);
+
+    // A scatter, read back element by element and with another gather.
+    for k in 0..#m do vals[k] = -pick(k, n);
+    chpl_gen_comm_put_idx(c_ptrTo(vals): c_void_ptr, 1, c_ptrTo(addrs), elemSize, -1,
+                          m: int(32), 0, "gatherScatter.chpl");
+    ok = true;
+    for k in 0..#m do
+      if R[pick(k, n)] != -pick(k, n) then ok = false;
+    vals = 0;
+    chpl_gen_comm_get_idx(c_ptrTo(vals): c_void_ptr, 1, c_ptrTo(addrs), elemSize, -1,
+                          m: int(32), 0, "gatherScatter.chpl");
+    for k in 0..#m do
+      if vals[k] != -pick(k, n) then ok = false;
+    writeln("scatter ok: ", ok);
+
+    // Lists too large for the cache go around it, after a fence.
+    R[pick(n-1, n)] = -2;
+    vals = 0;
+    chpl_gen_comm_get_idx(c_ptrTo(vals): c_void_ptr, 1, c_ptrTo(addrs), elemSize, -1,
+                          n: int(32), 0, "gatherScatter.chpl");
+    ok = true;
+    for k in 0..#n {
+      const j = pick(k, n);
+      const expect = if k == n-1 then -2
+                     else if k < m then -j
+                     else j * 10;
+      if vals[k] != expect then ok = false;
+    }
+    writeln("large gather ok: ", ok);
+  }
+
+  // The owner sees every write once the on statement has returned.
+  var ok = true;
+  for k in 0..#n {
+    const j = pick(k, n);
+    const expect = if k == n-1 then -2 else if k < m then -j else j * 10;
+    if R[j] != expect then ok = false;
+  }
+  writeln("owner sees writes: ", ok);
+}
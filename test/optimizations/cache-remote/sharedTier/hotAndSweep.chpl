@@ -0,0 +1,58 @@
+// One task re-reads a small remote working set while streaming through
+// a remote array twice the size of its cache.  With the ARC policy, the
+// sweep must not push the working set out of the cache.  Every value
+// read must be right, with or without the shared tier.
+
+config const hotSize = 16*1024;         // ints in the working set (128K)
+config const sweepSize = 1024*1024;     // ints in the array swept (8M)
+config const rounds = 4;
+config const verbose = false;
+
+extern record chpl_cache_stats_t {
+  var shared_hits: uint(64);
+  var remote_gets: uint(64);
+}
+extern proc chpl_cache_get_stats(ref stats: chpl_cache_stats_t);
+extern proc chpl_cache_reset_stats();
+
+on Locales[1] {
+  var H: [1..hotSize] int;
+  var S: [1..sweepSize] int;
+  forall i in 1..hotSize do H[i] = i;
+  forall i in 1..sweepSize do S[i] = -i;
+
+  on Locales[0] {
+    const chunk = sweepSize / rounds;
+    var stats: chpl_cache_stats_t;
+    var hotFetches = 0;
+    var ok = true;
+
+    for r in 0..#rounds {
+      // Read the working set twice, so that it counts as re-used.
+      chpl_cache_reset_stats();
+      for 1..2 {
+        var hsum = 0;
+        for i in 1..hotSize do hsum += H[i];
+        if hsum != hotSize * (hotSize+1) / 2 then ok = false;
+      }
+      chpl_cache_get_stats(stats);
+      if r > 0 then
+        hotFetches += (stats.remote_gets + stats.shared_hits):int;
+
+      const lo = r*chunk+1, hi = (r+1)*chunk;
+      var ssum = 0;
+      for i in lo..hi do ssum += S[i];
+      if ssum != -(hi*(hi+1)/2 - (lo-1)*lo/2) then ok = false;
+    }
+
+    if verbose then writeln("working set pages fetched again: ", hotFetches);
+    writeln("values ok: ", ok);
+    // 2Q fetches all of the working set again every round.  ARC keeps
+    // most of it; only its last few pages have not been re-used by the
+    // time the sweep starts, since their second read is too close to
+    // their first to count.
+    const hotPages = hotSize * numBytes(int) / 1024;
+    writeln("working set mostly stayed cached: ",
+            hotFetches <= (rounds-1) * hotPages / 2);
+  }
+}
@@ -0,0 +1,56 @@
+// Many tasks on locale 0 read the same remote vector at the same time.
+// With the shared tier, each page should be fetched about once rather
+// than once per task.  Afterwards one task overwrites the vector and
+// the readers must see the new values, not stale shared pages.
+
+config const n = 100000;
+config const nTasks = 8;
+config const verbose = false;
+
+extern record chpl_cache_stats_t {
+  var shared_hits: uint(64);
+  var remote_gets: uint(64);
+}
+extern proc chpl_cache_get_stats(ref stats: chpl_cache_stats_t);
+extern proc chpl_cache_reset_stats();
+
+proc readAll(ref X: [] int, scale: int) {
+  var ready: sync bool;
+  var count: atomic int;
+  var ok: atomic bool;
+
+  ok.write(true);
+  coforall t in 1..nTasks {
+    // Make sure all of the readers are running (on their own threads,
+    // and so with their own caches) before any of them starts.
+    if count.fetchAdd(1) == nTasks-1 then ready = true;
+    else { ready; ready = true; }
+
+    var sum = 0;
+    for i in 1..n do sum += X[i];
+    if sum != scale * n * (n+1) / 2 then ok.write(false);
+  }
+  return ok.read();
+}
+
+on Locales[1] {
+  var X: [1..n] int;
+  forall i in 1..n do X[i] = i;
+
+  on Locales[0] {
+    var stats: chpl_cache_stats_t;
+    const pages = (n * numBytes(int)) / 1024;
+
+    chpl_cache_reset_stats();
+    writeln("first read ok: ", readAll(X, 1));
+    chpl_cache_get_stats(stats);
+    if verbose then writeln(stats);
+    // Without the shared tier each task fetches every page itself.
+    writeln("at most half the GETs of unshared caches: ",
+            stats.remote_gets:int <= nTasks * pages / 2);
+
+    for i in 1..n do X[i] = 2*i;
+
+    writeln("read after overwrite ok: ", readAll(X, 2));
+  }
+}
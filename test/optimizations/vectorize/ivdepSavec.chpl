@@ -0,0 +1,59 @@
+config const n = 1000, k = 3;
+
+var A, B, C: [1..n] real;
+var buf: [1..n] int;
+
+// A forall over a domain: its follower loop gets the pragma.  The data
+// pointers hoisted out of it are not declared restrict, since arrays
+// can share data (see aliased()).
+proc triad(A: [] real, B: [] real, C: [] real, alpha: real) {
+  forall i in A.domain do
+    A[i] = B[i] + alpha * C[i];
+}
+
+// B is a slice of A, so it reads what A's writes in the same iteration.
+proc aliased(A: [] real, C: [] real) {
+  ref B = A[2..n];
+  forall i in B.domain {
+    A[i] = A[i] + 1.0;
+    C[i] = B[i];
+  }
+}
+
+// A follower whose own loop carries a dependence from one iteration to
+// the next.  Its loop must not get the pragma.
+iter depIter(lo: int, hi: int) {
+  for i in lo..hi do yield i;
+}
+
+iter depIter(lo: int, hi: int, param tag: iterKind)
+    where tag == iterKind.leader {
+  yield (lo..hi,);
+}
+
+iter depIter(lo: int, hi: int, param tag: iterKind, followThis)
+    where tag == iterKind.follower {
+  for i in followThis(1) {
+    buf[i] = buf[i-k] + i;
+    yield i;
+  }
+}
+
+proc dependent() {
+  forall i in depIter(k+1, n) do
+    C[i] = i;
+}
+
+forall i in 1..n {
+  B[i] = i;
+  C[i] = 2 * i;
+}
+triad(A, B, C, 0.5);
+writeln(+ reduce A);
+aliased(A, C);
+writeln(+ reduce C);
+
+buf[1..k] = 1;
+dependent();
+writeln(+ reduce buf);
+writeln(+ reduce C);
@@ -0,0 +1,42 @@
+// Order-independent loops get vectorization hints with --vectorize, and
+// data pointers hoisted out of them may be declared restrict.  Check
+// that the usual forall kernels still compute the right answers.
+
+config const n = 1003;
+
+proc triad(A: [] real, B: [] real, C: [] real, alpha: real) {
+  forall i in A.domain do
+    A[i] = B[i] + alpha * C[i];
+}
+
+proc scale(A: [] real, B: [] real, alpha: real) {
+  forall (a, b) in zip(A, B) do
+    a = b * alpha;
+}
+
+proc increment(A: [] real) {
+  forall i in A.domain {
+    A[i] = 1.0;
+    A[i] = A[i] + i;
+  }
+}
+
+var A, B, C: [1..n] real;
+
+forall i in 1..n {
+  B[i] = i;
+  C[i] = 2 * i;
+}
+
+triad(A, B, C, 0.5);
+writeln(+ reduce A);
+
+scale(B, A, 2.0);
+writeln(+ reduce B);
+
+increment(C);
+writeln(+ reduce C);
+
+// The same array on both sides of a zippered forall.
+scale(A, A, 3.0);
+writeln(+ reduce A);
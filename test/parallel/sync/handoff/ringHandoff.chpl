@@ -0,0 +1,24 @@
+//
+// Pass a token around a ring of tasks through an array of sync
+// variables, one per task, so that every hand-off empties one element
+// and fills the next.
+//
+config const numTasks = 8;
+config const numRounds = 1000;
+
+var slots: [0..#numTasks] sync int;
+var total: sync int = 0;
+
+coforall t in 0..#numTasks {
+  var mine = 0;
+  if t == 0 then slots[0] = 0;
+  for r in 1..numRounds {
+    const tok = slots[t];
+    mine += 1;
+    slots[(t+1) % numTasks] = tok + 1;
+  }
+  total += mine;
+}
+
+writeln("token is ", slots[0].readFE());
+writeln("hand-offs: ", total.readFE());
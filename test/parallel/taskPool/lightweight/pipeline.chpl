@@ -0,0 +1,29 @@
+//
+// Every task but the last waits for the one begun after it, so all of
+// them are blocked at once.  With lightweight tasks this must finish
+// using a couple of threads.
+//
+config const numTasks = 10000;
+
+var links: [0..numTasks] sync int;
+
+sync {
+  for i in 1..numTasks do
+    begin links[i-1] = links[i] + 1;
+  links[numTasks] = 0;
+}
+
+writeln("pipeline result is ", links[0].readFF());
+
+//
+// A task that spins, yielding, must let the task it is waiting for run
+// on the same thread.
+//
+var flag: atomic bool;
+
+sync {
+  begin flag.waitFor(true);
+  begin flag.write(true);
+}
+
+writeln("flag is ", flag.read());
@@ -98,7 +98,7 @@ how they will show up in the usage and what order is used in interactive mode.
 Dimensions = [
     Dimension(
         'comm', 'CHPL_COMM',
-        values=['none', 'gasnet'],
+        values=['none', 'gasnet', 'shm'],
         default=chpl_comm.get(),
         help_text='Chapel communcation ({var_name}) value to build.',
     ),
@@ -27,6 +27,8 @@ def get(flag='host'):
                     mem_val = 'dlmalloc'
                 else:
                     mem_val = 'cstdlib'
+            elif comm_val == 'shm':
+                mem_val = 'dlmalloc'
             elif comm_val == 'ugni':
                 mem_val = 'tcmalloc'
             else: